@@ -44,7 +44,6 @@ if(WINDOWS)
         ssleay32.dll
         libeay32.dll
         nghttp2.dll
-        glod.dll
         libhunspell.dll
         )
 
@@ -181,7 +180,6 @@ elseif(DARWIN)
         libaprutil-1.dylib
         libexception_handler.dylib
         ${EXPAT_COPY}
-        libGLOD.dylib
         libndofdev.dylib
         libnghttp2.dylib
         libnghttp2.14.dylib
@@ -226,7 +224,6 @@ elseif(LINUX)
         ${EXPAT_COPY}
         libfreetype.so.6.6.2
         libfreetype.so.6
-        libGLOD.so
         libgmodule-2.0.so
         libgobject-2.0.so
         libhunspell-1.3.so.0.0.0
@@ -175,6 +175,7 @@ LLXmlTree LLAvatarAppearance::sXMLTree;
 LLXmlTree LLAvatarAppearance::sSkeletonXMLTree;
 LLAvatarSkeletonInfo* LLAvatarAppearance::sAvatarSkeletonInfo = NULL;
 LLAvatarAppearance::LLAvatarXmlInfo* LLAvatarAppearance::sAvatarXmlInfo = NULL;
+BOOL LLAvatarAppearance::sUseFlatSkeleton = TRUE;
 
 
 LLAvatarAppearance::LLAvatarAppearance(LLWearableData* wearable_data) :
@@ -757,6 +758,36 @@ void LLAvatarAppearance::clearSkeleton()
 	mSkeleton.clear();
 }
 
+//-----------------------------------------------------------------------------
+// updateWorldMatrices()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::updateWorldMatrices()
+{
+	if (!mRoot)
+	{
+		return;
+	}
+	if (sUseFlatSkeleton)
+	{
+		mFlatSkeleton.update(mRoot);
+	}
+	else
+	{
+		mRoot->updateWorldMatrixChildren();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// applyQueuedMorphs()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::applyQueuedMorphs()
+{
+	for (polymesh_map_t::iterator iter = mPolyMeshes.begin(); iter != mPolyMeshes.end(); ++iter)
+	{
+		iter->second->applyQueuedMorphs();
+	}
+}
+
 //------------------------------------------------------------------------
 // addPelvisFixup
 //------------------------------------------------------------------------
@@ -31,6 +31,7 @@
 #include "llavatarappearancedefines.h"
 #include "llavatarjointmesh.h"
 #include "lldriverparam.h"
+#include "llflatskeleton.h"
 #include "lltexlayer.h"
 #include "llviewervisualparam.h"
 #include "llxmltree.h"
@@ -154,6 +155,12 @@ public:
     typedef std::map<std::string, std::string> joint_alias_map_t;
     const joint_alias_map_t& getJointAliases();
 
+    // world matrices of every joint under mRoot, in one linear pass over
+    // mFlatSkeleton when sUseFlatSkeleton is set
+    void updateWorldMatrices();
+    const LLFlatSkeleton& getFlatSkeleton() const { return mFlatSkeleton; }
+    static BOOL sUseFlatSkeleton;
+
 
 protected:
 	static BOOL			parseSkeletonFile(const std::string& filename);
@@ -167,6 +174,7 @@ protected:
 	void				clearSkeleton();
 	BOOL				mIsBuilt; // state of deferred character building
 	avatar_joint_list_t	mSkeleton;
+	LLFlatSkeleton		mFlatSkeleton;
 	LLVector3OverrideMap	mPelvisFixups;
     joint_alias_map_t   mJointAliasMap;
 
@@ -255,6 +263,7 @@ public:
 public:
 	virtual void	updateMeshTextures() = 0;
 	virtual void	dirtyMesh() = 0; // Dirty the avatar mesh
+	void			applyQueuedMorphs(); // Apply the morph targets queued on each mesh
 protected:
 	virtual void	dirtyMesh(S32 priority) = 0; // Dirty the avatar mesh, with priority
 
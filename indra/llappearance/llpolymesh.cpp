@@ -59,6 +59,7 @@ LLPolyMorphData *clone_morph_param_cleavage(const LLPolyMorphData *src_data,
 // Global table of loaded LLPolyMeshes
 //-----------------------------------------------------------------------------
 LLPolyMesh::LLPolyMeshSharedDataTable LLPolyMesh::sGlobalSharedMeshList;
+BOOL LLPolyMesh::sBatchMorphs = TRUE;
 
 //-----------------------------------------------------------------------------
 // LLPolyMeshSharedData()
@@ -677,6 +678,12 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                                 }
                         }
 
+                        for (morphdata_list_t::iterator iter = mMorphData.begin();
+                             iter != mMorphData.end(); ++iter)
+                        {
+                                (*iter)->packDeltas();
+                        }
+
                         S32 numRemaps;
                         if (fread(&numRemaps, sizeof(S32), 1, fp) == 1)
                         {
@@ -917,6 +924,7 @@ void LLPolyMesh::dumpDiagInfo()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableCoords()
 {
+        applyQueuedMorphs();
         return mCoords;
 }
 
@@ -925,6 +933,7 @@ LLVector4a *LLPolyMesh::getWritableCoords()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableNormals()
 {
+        applyQueuedMorphs();
         return mNormals;
 }
 
@@ -933,6 +942,7 @@ LLVector4a *LLPolyMesh::getWritableNormals()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getWritableBinormals()
 {
+        applyQueuedMorphs();
         return mBinormals;
 }
 
@@ -942,6 +952,7 @@ LLVector4a *LLPolyMesh::getWritableBinormals()
 //-----------------------------------------------------------------------------
 LLVector4a       *LLPolyMesh::getWritableClothingWeights()
 {
+        applyQueuedMorphs();
         return mClothingWeights;
 }
 
@@ -950,6 +961,7 @@ LLVector4a       *LLPolyMesh::getWritableClothingWeights()
 //-----------------------------------------------------------------------------
 LLVector2       *LLPolyMesh::getWritableTexCoords()
 {
+        applyQueuedMorphs();
         return mTexCoords;
 }
 
@@ -958,6 +970,7 @@ LLVector2       *LLPolyMesh::getWritableTexCoords()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getScaledNormals()
 {
+        applyQueuedMorphs();
         return mScaledNormals;
 }
 
@@ -966,10 +979,32 @@ LLVector4a *LLPolyMesh::getScaledNormals()
 //-----------------------------------------------------------------------------
 LLVector4a *LLPolyMesh::getScaledBinormals()
 {
+        applyQueuedMorphs();
         return mScaledBinormals;
 }
 
 
+//-----------------------------------------------------------------------------
+// applyMorphBatch()
+//-----------------------------------------------------------------------------
+static LLTrace::BlockTimerStatHandle FTM_APPLY_MORPH_BATCH("Apply Morph Batch");
+
+void LLPolyMesh::applyMorphBatch() const
+{
+	LL_RECORD_BLOCK_TIME(FTM_APPLY_MORPH_BATCH);
+
+	LLPolyMorphBatch::Target target;
+	target.mNumVertices = mSharedData->mNumVertices;
+	target.mCoords = mCoords;
+	target.mScaledNormals = mScaledNormals;
+	target.mNormals = mNormals;
+	target.mScaledBinormals = mScaledBinormals;
+	target.mBinormals = mBinormals;
+	target.mClothingWeights = mClothingWeights;
+	target.mTexCoords = mTexCoords;
+	mMorphBatch.apply(target);
+}
+
 //-----------------------------------------------------------------------------
 // initializeForMorph()
 //-----------------------------------------------------------------------------
@@ -217,6 +217,7 @@ public:
 
 	// Get coords
 	const LLVector4a	*getCoords() const{
+		applyQueuedMorphs();
 		return mCoords;
 	}
 
@@ -225,11 +226,13 @@ public:
 
 	// Get normals
 	const LLVector4a	*getNormals() const{ 
+		applyQueuedMorphs();
 		return mNormals; 
 	}
 
 	// Get normals
 	const LLVector4a	*getBinormals() const{ 
+		applyQueuedMorphs();
 		return mBinormals; 
 	}
 
@@ -254,6 +257,7 @@ public:
 
 	// Get texCoords
 	const LLVector2	*getTexCoords() const { 
+		applyQueuedMorphs();
 		return mTexCoords; 
 	}
 
@@ -278,6 +282,7 @@ public:
 
 	const LLVector4a		*getClothingWeights()
 	{
+		applyQueuedMorphs();
 		return mClothingWeights;	
 	}
 
@@ -307,6 +312,23 @@ public:
 	}
 
 	LLPolyMorphData*	getMorphData(const std::string& morph_name);
+
+	// Morph targets applied while sBatchMorphs is set are queued here and
+	// applied together before the vertex data is next read, or by
+	// applyQueuedMorphs(). LOD meshes share the queue of their reference mesh.
+	void	queueMorph(const LLPolyMorphDeltas* deltas, F32 delta_weight, const F32* mask_weights, bool clothing)
+	{
+		mMorphBatch.add(deltas, delta_weight, mask_weights, clothing);
+	}
+	void	applyQueuedMorphs() const
+	{
+		const LLPolyMesh* mesh = (isLOD() && mReferenceMesh) ? mReferenceMesh : this;
+		if (!mesh->mMorphBatch.empty())
+		{
+			mesh->applyMorphBatch();
+		}
+	}
+	static BOOL sBatchMorphs;
 // 	void	removeMorphData(LLPolyMorphData *morph_target);
 // 	void	deleteAllMorphData();
 
@@ -316,7 +338,7 @@ public:
 	// Get indices
 	U32*	getIndices() { return mSharedData ? mSharedData->mTriangleIndices : NULL; }
 
-	BOOL	isLOD() { return mSharedData && mSharedData->isLOD(); }
+	BOOL	isLOD() const { return mSharedData && mSharedData->isLOD(); }
 
 	void setAvatar(LLAvatarAppearance* avatarp) { mAvatarp = avatarp; }
 	LLAvatarAppearance* getAvatar() { return mAvatarp; }
@@ -330,6 +352,7 @@ public:
 	U32				mCurVertexCount;
 private:
 	void initializeForMorph();
+	void applyMorphBatch() const;
 
 	// Dumps diagnostic information about the global mesh table
 	static void dumpDiagInfo();
@@ -356,6 +379,9 @@ protected:
 	
 	LLPolyMesh				*mReferenceMesh;
 
+	// morphs waiting to be applied, filled from const readers
+	mutable LLPolyMorphBatch	mMorphBatch;
+
 	// global mesh list
 	typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable; 
 	static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
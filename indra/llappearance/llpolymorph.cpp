@@ -39,8 +39,6 @@
 
 //#include "../tools/imdebug/imdebug.h"
 
-const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
-
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -214,6 +212,14 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 	return TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// packDeltas()
+//-----------------------------------------------------------------------------
+void LLPolyMorphData::packDeltas()
+{
+	mDeltas.pack(mNumIndices, mVertexIndices, mCoords, mNormals, mBinormals, mTexCoords);
+}
+
 //-----------------------------------------------------------------------------
 // freeData()
 //-----------------------------------------------------------------------------
@@ -570,74 +576,82 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 	if (delta_weight != 0.f)
 	{
 		llassert(!mMesh->isLOD());
-		LLVector4a *coords = mMesh->getWritableCoords();
-
-		LLVector4a *scaled_normals = mMesh->getScaledNormals();
-		LLVector4a *normals = mMesh->getWritableNormals();
+		F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
 
-		LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
-		LLVector4a *binormals = mMesh->getWritableBinormals();
+		if (LLPolyMesh::sBatchMorphs && mMorphData->mDeltas.getNumIndices() == mMorphData->mNumIndices)
+		{
+			// applied with the other morphs of the mesh before its vertices are next read
+			mMesh->queueMorph(&mMorphData->mDeltas, delta_weight, maskWeightArray, getInfo()->mIsClothingMorph);
+		}
+		else
+		{
+			LLVector4a *coords = mMesh->getWritableCoords();
 
-		LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
-		LLVector2 *tex_coords = mMesh->getWritableTexCoords();
+			LLVector4a *scaled_normals = mMesh->getScaledNormals();
+			LLVector4a *normals = mMesh->getWritableNormals();
 
-		F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
+			LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
+			LLVector4a *binormals = mMesh->getWritableBinormals();
 
-		for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
-		{
-			S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
+			LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
+			LLVector2 *tex_coords = mMesh->getWritableTexCoords();
 
-			F32 maskWeight = 1.f;
-			if (maskWeightArray)
+			for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
 			{
-				maskWeight = maskWeightArray[vert_index_morph];
-			}
+				S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
 
+				F32 maskWeight = 1.f;
+				if (maskWeightArray)
+				{
+					maskWeight = maskWeightArray[vert_index_morph];
+				}
 
-			LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-			pos.mul(delta_weight*maskWeight);
-			coords[vert_index_mesh].add(pos);
 
-			if (getInfo()->mIsClothingMorph && clothing_weights)
-			{
-				LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-				clothing_offset.mul(delta_weight * maskWeight);
-				LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-				clothing_weight->add(clothing_offset);
-				clothing_weight->getF32ptr()[VW] = maskWeight;
-			}
+				LLVector4a pos = mMorphData->mCoords[vert_index_morph];
+				pos.mul(delta_weight*maskWeight);
+				coords[vert_index_mesh].add(pos);
 
-			// calculate new normals based on half angles
-			LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-			norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_normals[vert_index_mesh].add(norm);
-			norm = scaled_normals[vert_index_mesh];
+				if (getInfo()->mIsClothingMorph && clothing_weights)
+				{
+					LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
+					clothing_offset.mul(delta_weight * maskWeight);
+					LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
+					clothing_weight->add(clothing_offset);
+					clothing_weight->getF32ptr()[VW] = maskWeight;
+				}
 
-			// guard against degenerate input data before we create NaNs below!
-			//
-			norm.normalize3fast();
-			normals[vert_index_mesh] = norm;
+				// calculate new normals based on half angles
+				LLVector4a norm = mMorphData->mNormals[vert_index_morph];
+				norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+				scaled_normals[vert_index_mesh].add(norm);
+				norm = scaled_normals[vert_index_mesh];
 
-			// calculate new binormals
-			LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
+				// guard against degenerate input data before we create NaNs below!
+				//
+				norm.normalize3fast();
+				normals[vert_index_mesh] = norm;
 
-			// guard against degenerate input data before we create NaNs below!
-			//
-			if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
-			{
-				binorm.set(1,0,0,1);
-			}
+				// calculate new binormals
+				LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
 
-			binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
-			scaled_binormals[vert_index_mesh].add(binorm);
-			LLVector4a tangent;
-			tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-			LLVector4a& normalized_binormal = binormals[vert_index_mesh];
+				// guard against degenerate input data before we create NaNs below!
+				//
+				if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+				{
+					binorm.set(1,0,0,1);
+				}
+
+				binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+				scaled_binormals[vert_index_mesh].add(binorm);
+				LLVector4a tangent;
+				tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
+				LLVector4a& normalized_binormal = binormals[vert_index_mesh];
 
-			normalized_binormal.setCross3(norm, tangent); 
-			normalized_binormal.normalize3fast();
+				normalized_binormal.setCross3(norm, tangent); 
+				normalized_binormal.normalize3fast();
 			
-			tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+				tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
+			}
 		}
 
 		// now apply volume changes
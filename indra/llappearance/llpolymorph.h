@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "llviewervisualparam.h"
+#include "llpolymorphbatch.h"
 
 class LLAvatarJointCollisionVolume;
 class LLPolyMeshSharedData;
@@ -60,6 +61,8 @@ public:
 	}
 
 	BOOL			loadBinary(LLFILE* fp, LLPolyMeshSharedData *mesh);
+	// fills mDeltas, once the morph data is final
+	void			packDeltas();
 	const std::string& getName() { return mName; }
 
 public:
@@ -79,6 +82,9 @@ public:
 	LL_ALIGN_16(LLVector4a			mAvgDistortion);		// average vertex distortion, to infer directionality of the morph
 	LLPolyMeshSharedData*	mMesh;
 
+	// the same morph packed for LLPolyMorphBatch
+	LLPolyMorphDeltas	mDeltas;
+
 private:
 	void freeData();
 } LL_ALIGN_POSTFIX(16);
@@ -0,0 +1,201 @@
+/**
+ * @file llpolymorphbatch.cpp
+ * @brief Implementation of LLPolyMorphDeltas and LLPolyMorphBatch classes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+//-----------------------------------------------------------------------------
+// Header Files
+//-----------------------------------------------------------------------------
+#include "linden_common.h"
+
+#include "llpolymorphbatch.h"
+
+//-----------------------------------------------------------------------------
+// LLPolyMorphDeltas()
+//-----------------------------------------------------------------------------
+LLPolyMorphDeltas::LLPolyMorphDeltas()
+{
+}
+
+//-----------------------------------------------------------------------------
+// pack()
+//-----------------------------------------------------------------------------
+void LLPolyMorphDeltas::pack(U32 num_indices, const U32* vertex_indices,
+							 const LLVector4a* coords, const LLVector4a* normals,
+							 const LLVector4a* binormals, const LLVector2* tex_coords)
+{
+	mVertexIndices.assign(vertex_indices, vertex_indices + num_indices);
+	mDeltas.resize(num_indices);
+	mTexCoords.clear();
+
+	bool has_tex_coords = false;
+	for (U32 i = 0; i < num_indices; ++i)
+	{
+		LLPolyMorphDelta& delta = mDeltas[i];
+		// morph files only have x, y and z, w is whatever was in memory
+		delta.mCoord.load3(coords[i].getF32ptr());
+		delta.mNormal.load3(normals[i].getF32ptr());
+		delta.mBinormal.load3(binormals[i].getF32ptr());
+
+		// guard against degenerate input data before we create NaNs when applying
+		if (!delta.mBinormal.isFinite3() || (delta.mBinormal.dot3(delta.mBinormal).getF32() <= F_APPROXIMATELY_ZERO))
+		{
+			delta.mBinormal.set(1, 0, 0, 0);
+		}
+
+		has_tex_coords = has_tex_coords || !tex_coords[i].isExactlyZero();
+	}
+
+	if (has_tex_coords)
+	{
+		mTexCoords.assign(tex_coords, tex_coords + num_indices);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// add()
+//-----------------------------------------------------------------------------
+void LLPolyMorphBatch::add(const LLPolyMorphDeltas* deltas, F32 delta_weight, const F32* mask_weights, bool clothing)
+{
+	if (!deltas->getNumIndices())
+	{
+		return;
+	}
+
+	for (std::vector<Entry>::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		if (iter->mDeltas == deltas && iter->mMaskWeights == mask_weights && iter->mClothing == clothing)
+		{
+			iter->mWeight += delta_weight;
+			return;
+		}
+	}
+
+	Entry entry;
+	entry.mDeltas = deltas;
+	entry.mMaskWeights = mask_weights;
+	entry.mWeight = delta_weight;
+	entry.mClothing = clothing;
+	mEntries.push_back(entry);
+}
+
+//-----------------------------------------------------------------------------
+// apply()
+//-----------------------------------------------------------------------------
+void LLPolyMorphBatch::apply(const Target& target)
+{
+	if (mTouched.size() < target.mNumVertices)
+	{
+		mTouched.resize(target.mNumVertices, 0);
+	}
+
+	U32 first_touched = target.mNumVertices;
+	U32 last_touched = 0;
+
+	// add up the deltas, the weights are computed as LLPolyMorphTarget::apply()
+	// did for a single morph so one morph in a batch gives the same result
+	for (std::vector<Entry>::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		const Entry& entry = *iter;
+		if (entry.mWeight == 0.f)
+		{
+			continue;
+		}
+
+		const LLPolyMorphDeltas& morph = *entry.mDeltas;
+		const U32 count = morph.getNumIndices();
+		const U32* indices = &morph.mVertexIndices[0];
+		const LLPolyMorphDelta* deltas = &morph.mDeltas[0];
+		const LLVector2* tex_coords = morph.hasTexCoords() ? &morph.mTexCoords[0] : NULL;
+		const F32* mask_weights = entry.mMaskWeights;
+		LLVector4a* clothing_weights = entry.mClothing ? target.mClothingWeights : NULL;
+		const F32 weight = entry.mWeight;
+
+		LLVector4a coord_weight;
+		LLVector4a normal_weight;
+		coord_weight.splat(weight);
+		normal_weight.splat(weight * NORMAL_SOFTEN_FACTOR);
+		F32 mask_weight = 1.f;
+
+		for (U32 i = 0; i < count; ++i)
+		{
+			const U32 vert = indices[i];
+			llassert(vert < target.mNumVertices);
+			const LLPolyMorphDelta& delta = deltas[i];
+
+			if (mask_weights)
+			{
+				mask_weight = mask_weights[i];
+				coord_weight.splat(weight * mask_weight);
+				normal_weight.splat(weight * mask_weight * NORMAL_SOFTEN_FACTOR);
+			}
+
+			LLVector4a t;
+			t.setMul(delta.mCoord, coord_weight);
+			target.mCoords[vert].add(t);
+
+			if (clothing_weights)
+			{
+				LLVector4a& clothing_weight = clothing_weights[vert];
+				clothing_weight.add(t);
+				clothing_weight.getF32ptr()[VW] = mask_weight;
+			}
+
+			t.setMul(delta.mNormal, normal_weight);
+			target.mScaledNormals[vert].add(t);
+			t.setMul(delta.mBinormal, normal_weight);
+			target.mScaledBinormals[vert].add(t);
+
+			if (tex_coords)
+			{
+				target.mTexCoords[vert] += tex_coords[i] * weight * mask_weight;
+			}
+
+			mTouched[vert] = 1;
+			first_touched = llmin(first_touched, vert);
+			last_touched = llmax(last_touched, vert);
+		}
+	}
+	mEntries.clear();
+
+	// then renormalize each vertex once, in memory order
+	for (U32 vert = first_touched; vert <= last_touched && vert < target.mNumVertices; ++vert)
+	{
+		if (!mTouched[vert])
+		{
+			continue;
+		}
+		mTouched[vert] = 0;
+
+		LLVector4a norm = target.mScaledNormals[vert];
+		norm.normalize3fast();
+		target.mNormals[vert] = norm;
+
+		LLVector4a tangent;
+		tangent.setCross3(target.mScaledBinormals[vert], norm);
+		LLVector4a& binormal = target.mBinormals[vert];
+		binormal.setCross3(norm, tangent);
+		binormal.normalize3fast();
+	}
+}
@@ -0,0 +1,124 @@
+/**
+ * @file llpolymorphbatch.h
+ * @brief Implementation of LLPolyMorphDeltas and LLPolyMorphBatch classes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPOLYMORPHBATCH_H
+#define LL_LLPOLYMORPHBATCH_H
+
+#include <vector>
+
+#include "llalignedarray.h"
+#include "llmath.h"
+#include "llvector4a.h"
+#include "v2math.h"
+
+// morphed normals and binormals only move part of the way towards the target
+const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
+
+//-----------------------------------------------------------------------------
+// LLPolyMorphDelta
+// One vertex of a morph target, interleaved so a morph is read as one stream
+//-----------------------------------------------------------------------------
+LL_ALIGN_PREFIX(16)
+struct LLPolyMorphDelta
+{
+	LLVector4a	mCoord;
+	LLVector4a	mNormal;
+	LLVector4a	mBinormal;	// degenerate input replaced by the x axis
+} LL_ALIGN_POSTFIX(16);
+
+//-----------------------------------------------------------------------------
+// LLPolyMorphDeltas
+// A morph target packed for LLPolyMorphBatch: vertex indices and interleaved
+// deltas with unused w lanes cleared, and no texture coordinates for the many
+// morphs that leave them alone.
+//-----------------------------------------------------------------------------
+class LLPolyMorphDeltas
+{
+public:
+	LLPolyMorphDeltas();
+
+	void pack(U32 num_indices, const U32* vertex_indices,
+			  const LLVector4a* coords, const LLVector4a* normals,
+			  const LLVector4a* binormals, const LLVector2* tex_coords);
+
+	U32 getNumIndices() const { return (U32)mVertexIndices.size(); }
+	bool hasTexCoords() const { return !mTexCoords.empty(); }
+
+	std::vector<U32>						mVertexIndices;
+	LLAlignedArray<LLPolyMorphDelta, 64>	mDeltas;
+	std::vector<LLVector2>					mTexCoords;	// empty if all zero
+};
+
+//-----------------------------------------------------------------------------
+// LLPolyMorphBatch
+// Morph targets applied to one mesh, gathered and applied together.
+//
+// Applying a morph on its own renormalizes the normal and binormal of each
+// vertex it moves, so a vertex under twenty face morphs is renormalized twenty
+// times when a shape changes. The batch adds the deltas of all its morphs into
+// the coordinates and the unnormalized normals first, then renormalizes the
+// vertices it touched once, in vertex order. A morph added more than once
+// applies the sum of its weight deltas, and skips the mesh when they cancel.
+//-----------------------------------------------------------------------------
+class LLPolyMorphBatch
+{
+public:
+	// the vertex arrays of a mesh, see LLPolyMesh
+	struct Target
+	{
+		U32				mNumVertices;
+		LLVector4a*		mCoords;
+		LLVector4a*		mScaledNormals;
+		LLVector4a*		mNormals;
+		LLVector4a*		mScaledBinormals;
+		LLVector4a*		mBinormals;
+		LLVector4a*		mClothingWeights;	// may be NULL
+		LLVector2*		mTexCoords;
+	};
+
+	// mask_weights, one per morph vertex or NULL, must stay valid until apply()
+	void add(const LLPolyMorphDeltas* deltas, F32 delta_weight, const F32* mask_weights, bool clothing);
+
+	bool empty() const { return mEntries.empty(); }
+	void clear() { mEntries.clear(); }
+
+	// applies the morphs added since the last apply and clears the batch
+	void apply(const Target& target);
+
+private:
+	struct Entry
+	{
+		const LLPolyMorphDeltas*	mDeltas;
+		const F32*					mMaskWeights;
+		F32							mWeight;
+		bool						mClothing;
+	};
+
+	std::vector<Entry>	mEntries;
+	std::vector<U8>		mTouched;	// per mesh vertex, reused between batches
+};
+
+#endif // LL_LLPOLYMORPHBATCH_H
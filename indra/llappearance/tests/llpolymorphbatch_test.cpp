@@ -0,0 +1,515 @@
+/**
+ * @file llpolymorphbatch_test.cpp
+ * @brief Batched morph targets against applying them one by one, and benchmark.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llpolymorphbatch.h"
+
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	F32 frand(U32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return (F32)((seed >> 8) & 0xffff) / 65535.f;
+	}
+
+	// a morph target as LLPolyMorphData keeps it
+	struct Morph
+	{
+		std::string				mName;
+		std::vector<U32>		mIndices;
+		std::vector<LLVector4a>	mCoords;
+		std::vector<LLVector4a>	mNormals;
+		std::vector<LLVector4a>	mBinormals;
+		std::vector<LLVector2>	mTexCoords;
+		LLPolyMorphDeltas		mDeltas;
+
+		void pack()
+		{
+			mDeltas.pack(mIndices.size(), &mIndices[0], &mCoords[0], &mNormals[0], &mBinormals[0], &mTexCoords[0]);
+		}
+	};
+
+	// the morphed vertex arrays of an LLPolyMesh
+	struct Mesh
+	{
+		Mesh() : mNumVertices(0) {}
+
+		~Mesh()
+		{
+			for (U32 i = 0; i < mMorphs.size(); ++i)
+			{
+				delete mMorphs[i];
+			}
+		}
+
+		void reset()
+		{
+			mCoords = mBaseCoords;
+			mNormals = mBaseNormals;
+			mScaledNormals = mBaseNormals;
+			mBinormals = mBaseNormals;
+			mScaledBinormals = mBaseNormals;
+			mTexCoords = mBaseTexCoords;
+			mClothingWeights.assign(mNumVertices, LLVector4a(0.f, 0.f, 0.f, 0.f));
+		}
+
+		LLPolyMorphBatch::Target getTarget()
+		{
+			LLPolyMorphBatch::Target target;
+			target.mNumVertices = mNumVertices;
+			target.mCoords = &mCoords[0];
+			target.mScaledNormals = &mScaledNormals[0];
+			target.mNormals = &mNormals[0];
+			target.mScaledBinormals = &mScaledBinormals[0];
+			target.mBinormals = &mBinormals[0];
+			target.mClothingWeights = &mClothingWeights[0];
+			target.mTexCoords = &mTexCoords[0];
+			return target;
+		}
+
+		// one morph at a time, as LLPolyMorphTarget::apply() without a batch
+		void applyMorph(const Morph& morph, F32 delta_weight, const F32* mask_weights, bool clothing)
+		{
+			for (U32 i = 0; i < morph.mIndices.size(); ++i)
+			{
+				U32 vert = morph.mIndices[i];
+				F32 mask_weight = mask_weights ? mask_weights[i] : 1.f;
+
+				LLVector4a pos = morph.mCoords[i];
+				pos.mul(delta_weight * mask_weight);
+				mCoords[vert].add(pos);
+
+				if (clothing)
+				{
+					mClothingWeights[vert].add(pos);
+					mClothingWeights[vert].getF32ptr()[VW] = mask_weight;
+				}
+
+				LLVector4a norm = morph.mNormals[i];
+				norm.mul(delta_weight * mask_weight * NORMAL_SOFTEN_FACTOR);
+				mScaledNormals[vert].add(norm);
+				norm = mScaledNormals[vert];
+				norm.normalize3fast();
+				mNormals[vert] = norm;
+
+				LLVector4a binorm = morph.mBinormals[i];
+				if (!binorm.isFinite3() || (binorm.dot3(binorm).getF32() <= F_APPROXIMATELY_ZERO))
+				{
+					binorm.set(1, 0, 0, 1);
+				}
+				binorm.mul(delta_weight * mask_weight * NORMAL_SOFTEN_FACTOR);
+				mScaledBinormals[vert].add(binorm);
+				LLVector4a tangent;
+				tangent.setCross3(mScaledBinormals[vert], norm);
+				mBinormals[vert].setCross3(norm, tangent);
+				mBinormals[vert].normalize3fast();
+
+				mTexCoords[vert] += morph.mTexCoords[i] * delta_weight * mask_weight;
+			}
+		}
+
+		std::string					mName;
+		U32							mNumVertices;
+		std::vector<LLVector4a>		mBaseCoords;
+		std::vector<LLVector4a>		mBaseNormals;
+		std::vector<LLVector2>		mBaseTexCoords;
+		std::vector<Morph*>			mMorphs;
+
+		std::vector<LLVector4a>		mCoords;
+		std::vector<LLVector4a>		mScaledNormals;
+		std::vector<LLVector4a>		mNormals;
+		std::vector<LLVector4a>		mScaledBinormals;
+		std::vector<LLVector4a>		mBinormals;
+		std::vector<LLVector4a>		mClothingWeights;
+		std::vector<LLVector2>		mTexCoords;
+	};
+
+	template<typename T>
+	bool read(LLFILE* fp, T* dst, size_t count = 1)
+	{
+		return fread(dst, sizeof(T), count, fp) == count;
+	}
+
+	bool read_vectors(LLFILE* fp, std::vector<LLVector4a>& dst, U32 count)
+	{
+		dst.resize(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			F32 v[3];
+			if (!read(fp, v, 3))
+			{
+				return false;
+			}
+			dst[i].load3(v);
+		}
+		return true;
+	}
+
+	// the parts of LLPolyMeshSharedData::loadMesh() morphing uses,
+	// little endian files only
+	bool load_mesh(const std::string& filename, Mesh& mesh)
+	{
+		LLFILE* fp = LLFile::fopen(filename, "rb");
+		if (!fp)
+		{
+			return false;
+		}
+
+		char header[24];
+		U8 has_weights = 0;
+		U8 has_detail_tex_coords = 0;
+		F32 transform[9];
+		U8 rotation_order;
+		U16 num_vertices = 0;
+		bool ok = read(fp, header, 24)
+			&& !strncmp(header, "Linden Binary Mesh 1.0", 22)
+			&& read(fp, &has_weights)
+			&& read(fp, &has_detail_tex_coords)
+			&& read(fp, transform, 6)
+			&& read(fp, &rotation_order)
+			&& read(fp, transform + 6, 3)
+			&& read(fp, &num_vertices);
+
+		std::vector<LLVector4a> binormals;
+		ok = ok && read_vectors(fp, mesh.mBaseCoords, num_vertices)
+			&& read_vectors(fp, mesh.mBaseNormals, num_vertices)
+			&& read_vectors(fp, binormals, num_vertices);
+		mesh.mBaseTexCoords.resize(num_vertices);
+		ok = ok && (!num_vertices || read(fp, &mesh.mBaseTexCoords[0], num_vertices));
+		mesh.mNumVertices = num_vertices;
+
+		// detail texture coordinates, weights, faces and joint names
+		U16 count = 0;
+		ok = ok && !fseek(fp, (has_detail_tex_coords ? 8 : 0) * num_vertices + (has_weights ? 4 : 0) * num_vertices, SEEK_CUR)
+			&& read(fp, &count)
+			&& !fseek(fp, 6 * count, SEEK_CUR);
+		count = 0;
+		ok = ok && (!has_weights || (read(fp, &count) && !fseek(fp, 64 * count, SEEK_CUR)));
+
+		char name[65];
+		name[64] = '\0';
+		while (ok && read(fp, name, 64) && strcmp(name, "End Morphs"))
+		{
+			S32 num_indices = 0;
+			ok = read(fp, &num_indices) && num_indices > 0;
+			Morph* morph = new Morph;
+			morph->mName = name;
+			for (S32 i = 0; ok && i < num_indices; ++i)
+			{
+				U32 index;
+				F32 v[11];
+				ok = read(fp, &index) && read(fp, v, 11) && index < num_vertices;
+				morph->mIndices.push_back(index);
+				morph->mCoords.push_back(LLVector4a(v[0], v[1], v[2]));
+				morph->mNormals.push_back(LLVector4a(v[3], v[4], v[5]));
+				morph->mBinormals.push_back(LLVector4a(v[6], v[7], v[8]));
+				morph->mTexCoords.push_back(LLVector2(v[9], v[10]));
+			}
+			if (!ok)
+			{
+				delete morph;
+				break;
+			}
+			morph->pack();
+			mesh.mMorphs.push_back(morph);
+		}
+		LLFile::close(fp);
+
+		return ok && num_vertices && !mesh.mMorphs.empty();
+	}
+
+	// about the size of the head, with face morphs piled on the same vertices
+	void make_mesh(U32 seed, Mesh& mesh)
+	{
+		mesh.mName = "synthetic";
+		mesh.mNumVertices = 2000;
+		for (U32 i = 0; i < mesh.mNumVertices; ++i)
+		{
+			LLVector4a normal(frand(seed) - 0.5f, frand(seed) - 0.5f, frand(seed) - 0.5f + 0.01f);
+			normal.normalize3fast();
+			mesh.mBaseCoords.push_back(LLVector4a(frand(seed), frand(seed), frand(seed)));
+			mesh.mBaseNormals.push_back(normal);
+			mesh.mBaseTexCoords.push_back(LLVector2(frand(seed), frand(seed)));
+		}
+		for (U32 m = 0; m < 60; ++m)
+		{
+			Morph* morph = new Morph;
+			morph->mName = llformat("morph%d", m);
+			U32 first = (U32)(frand(seed) * mesh.mNumVertices * 0.5f);
+			for (U32 v = first; v < mesh.mNumVertices; v += 1 + (U32)(frand(seed) * 3.f))
+			{
+				morph->mIndices.push_back(v);
+				morph->mCoords.push_back(LLVector4a(frand(seed) - 0.5f, frand(seed) - 0.5f, frand(seed) - 0.5f));
+				morph->mNormals.push_back(LLVector4a(frand(seed) - 0.5f, frand(seed) - 0.5f, frand(seed) - 0.5f));
+				// some degenerate binormals, as found in the real files
+				morph->mBinormals.push_back(frand(seed) < 0.1f ? LLVector4a(0.f, 0.f, 0.f) : LLVector4a(frand(seed) - 0.5f, frand(seed) - 0.5f, frand(seed) - 0.5f));
+				morph->mTexCoords.push_back(m % 8 ? LLVector2(0.f, 0.f) : LLVector2(frand(seed) * 0.01f, frand(seed) * 0.01f));
+			}
+			morph->pack();
+			mesh.mMorphs.push_back(morph);
+		}
+	}
+
+	std::string character_dir()
+	{
+		std::string file(__FILE__);
+		std::string::size_type slash = file.find_last_of("/\\");
+		return file.substr(0, slash == std::string::npos ? 0 : slash + 1) + "../../newview/character/";
+	}
+
+	// the avatar_lad meshes, or a synthetic one if they cannot be found
+	void load_meshes(std::vector<Mesh*>& meshes)
+	{
+		static const char* names[] = { "avatar_head.llm", "avatar_upper_body.llm", "avatar_lower_body.llm",
+									   "avatar_skirt.llm", "avatar_hair.llm", "avatar_eyelashes.llm" };
+		for (U32 i = 0; i < LL_ARRAY_SIZE(names); ++i)
+		{
+			Mesh* mesh = new Mesh;
+			if (load_mesh(character_dir() + names[i], *mesh))
+			{
+				mesh->mName = names[i];
+				meshes.push_back(mesh);
+			}
+			else
+			{
+				delete mesh;
+			}
+		}
+		if (meshes.empty())
+		{
+			Mesh* mesh = new Mesh;
+			make_mesh(1, *mesh);
+			meshes.push_back(mesh);
+		}
+	}
+
+	bool close_vectors(const std::vector<LLVector4a>& a, const std::vector<LLVector4a>& b)
+	{
+		for (U32 i = 0; i < a.size(); ++i)
+		{
+			for (U32 j = 0; j < 3; ++j)
+			{
+				if (fabsf(a[i][j] - b[i][j]) > 1.e-5f * llmax(1.f, fabsf(a[i][j])))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool close_tex_coords(const std::vector<LLVector2>& a, const std::vector<LLVector2>& b)
+	{
+		for (U32 i = 0; i < a.size(); ++i)
+		{
+			if (fabsf(a[i].mV[VX] - b[i].mV[VX]) > 1.e-5f || fabsf(a[i].mV[VY] - b[i].mV[VY]) > 1.e-5f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool same_mesh(const Mesh& a, const Mesh& b)
+	{
+		return close_vectors(a.mCoords, b.mCoords)
+			&& close_vectors(a.mScaledNormals, b.mScaledNormals)
+			&& close_vectors(a.mNormals, b.mNormals)
+			&& close_vectors(a.mScaledBinormals, b.mScaledBinormals)
+			&& close_vectors(a.mBinormals, b.mBinormals)
+			&& close_vectors(a.mClothingWeights, b.mClothingWeights)
+			&& close_tex_coords(a.mTexCoords, b.mTexCoords);
+	}
+}
+
+namespace tut
+{
+	struct poly_morph_batch
+	{
+	};
+
+	typedef test_group<poly_morph_batch> poly_morph_batch_test;
+	typedef poly_morph_batch_test::object poly_morph_batch_t;
+	poly_morph_batch_test tut_poly_morph_batch("LLPolyMorphBatch");
+
+	// a batch ends where applying its morphs one by one does
+	template<> template<>
+	void poly_morph_batch_t::test<1>()
+	{
+		std::vector<Mesh*> meshes;
+		load_meshes(meshes);
+
+		for (U32 m = 0; m < meshes.size(); ++m)
+		{
+			Mesh& mesh = *meshes[m];
+			Mesh reference;
+			reference.mNumVertices = mesh.mNumVertices;
+			reference.mBaseCoords = mesh.mBaseCoords;
+			reference.mBaseNormals = mesh.mBaseNormals;
+			reference.mBaseTexCoords = mesh.mBaseTexCoords;
+			reference.reset();
+			mesh.reset();
+
+			// masks for a third of the morphs, every fourth one morphs clothing
+			std::vector<std::vector<F32> > masks(mesh.mMorphs.size());
+			U32 seed = m + 1;
+			for (U32 i = 0; i < masks.size(); i += 3)
+			{
+				for (U32 j = 0; j < mesh.mMorphs[i]->mIndices.size(); ++j)
+				{
+					masks[i].push_back(frand(seed));
+				}
+			}
+
+			LLPolyMorphBatch batch;
+			for (U32 frame = 0; frame < 5; ++frame)
+			{
+				for (U32 i = 0; i < mesh.mMorphs.size(); ++i)
+				{
+					if (frand(seed) < 0.3f)
+					{
+						continue;
+					}
+					F32 delta_weight = frand(seed) * 2.f - 1.f;
+					const F32* mask = masks[i].empty() ? NULL : &masks[i][0];
+					reference.applyMorph(*mesh.mMorphs[i], delta_weight, mask, i % 4 == 0);
+					batch.add(&mesh.mMorphs[i]->mDeltas, delta_weight, mask, i % 4 == 0);
+				}
+				batch.apply(mesh.getTarget());
+				ensure("applied", batch.empty());
+				ensure(mesh.mName + llformat(" frame %d", frame), same_mesh(reference, mesh));
+			}
+		}
+
+		for (U32 m = 0; m < meshes.size(); ++m)
+		{
+			delete meshes[m];
+		}
+	}
+
+	// a morph moved and moved back in one batch leaves the mesh alone
+	template<> template<>
+	void poly_morph_batch_t::test<2>()
+	{
+		Mesh mesh;
+		make_mesh(2, mesh);
+		mesh.reset();
+
+		LLPolyMorphBatch batch;
+		batch.add(&mesh.mMorphs[0]->mDeltas, 0.5f, NULL, false);
+		batch.add(&mesh.mMorphs[0]->mDeltas, 0.25f, NULL, false);
+		batch.add(&mesh.mMorphs[0]->mDeltas, -0.75f, NULL, false);
+		batch.apply(mesh.getTarget());
+
+		ensure("coords", !memcmp(&mesh.mCoords[0], &mesh.mBaseCoords[0], sizeof(LLVector4a) * mesh.mNumVertices));
+		ensure("normals", !memcmp(&mesh.mNormals[0], &mesh.mBaseNormals[0], sizeof(LLVector4a) * mesh.mNumVertices));
+		ensure("tex coords", !memcmp(&mesh.mTexCoords[0], &mesh.mBaseTexCoords[0], sizeof(LLVector2) * mesh.mNumVertices));
+
+		// and nothing is left over for the next one
+		batch.add(&mesh.mMorphs[1]->mDeltas, 1.f, NULL, false);
+		batch.apply(mesh.getTarget());
+		Mesh reference;
+		make_mesh(2, reference);
+		reference.reset();
+		reference.applyMorph(*reference.mMorphs[1], 1.f, NULL, false);
+		ensure("next batch", same_mesh(reference, mesh));
+	}
+
+	// every morph of every mesh changing a little each frame, as while the
+	// appearance editor or a new outfit blends the shape in
+	template<> template<>
+	void poly_morph_batch_t::test<3>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 FRAMES = 50;
+
+		std::vector<Mesh*> meshes;
+		load_meshes(meshes);
+
+		U32 vertices = 0;
+		U32 morphs = 0;
+		U32 morph_vertices = 0;
+		F64 times[2];
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			LLPolyMorphBatch batch;
+			F64 elapsed = 0.0;
+			for (U32 m = 0; m < meshes.size(); ++m)
+			{
+				Mesh& mesh = *meshes[m];
+				mesh.reset();
+				if (!pass)
+				{
+					vertices += mesh.mNumVertices;
+					morphs += mesh.mMorphs.size();
+					for (U32 i = 0; i < mesh.mMorphs.size(); ++i)
+					{
+						morph_vertices += mesh.mMorphs[i]->mIndices.size();
+					}
+				}
+
+				LLTimer timer;
+				for (S32 frame = 0; frame < FRAMES; ++frame)
+				{
+					F32 delta_weight = frame % 2 ? -0.01f : 0.02f;
+					for (U32 i = 0; i < mesh.mMorphs.size(); ++i)
+					{
+						if (pass)
+						{
+							batch.add(&mesh.mMorphs[i]->mDeltas, delta_weight, NULL, false);
+						}
+						else
+						{
+							mesh.applyMorph(*mesh.mMorphs[i], delta_weight, NULL, false);
+						}
+					}
+					if (pass)
+					{
+						batch.apply(mesh.getTarget());
+					}
+				}
+				elapsed += timer.getElapsedTimeF64();
+			}
+			times[pass] = elapsed;
+		}
+
+		LL_INFOS() << llformat("LLPolyMorphBatch: %d meshes, %d vertices, %d morphs moving %d vertices, %.3f ms a frame one by one, %.3f ms batched (%.1fx)",
+							   (S32)meshes.size(), vertices, morphs, morph_vertices,
+							   times[0] * 1000.0 / FRAMES, times[1] * 1000.0 / FRAMES,
+							   times[0] / llmax(times[1], 0.000001)) << LL_ENDL;
+
+		for (U32 m = 0; m < meshes.size(); ++m)
+		{
+			delete meshes[m];
+		}
+	}
+}
@@ -28,12 +28,15 @@
 #include "llaudiodecodemgr.h"
 
 #include "llaudioengine.h"
+#include "llatomic.h"
 #include "lllfsthread.h"
 #include "llvfile.h"
 #include "llstring.h"
 #include "lldir.h"
 #include "llendianswizzle.h"
+#include "llfile.h"
 #include "llassetstorage.h"
+#include "lljobscheduler.h"
 #include "llrefcount.h"
 
 #include "llvorbisencode.h"
@@ -42,6 +45,9 @@
 #include "vorbis/vorbisfile.h"
 #include <iterator>
 #include <deque>
+#include <list>
+#include <map>
+#include <set>
 
 extern LLAudioEngine *gAudiop;
 
@@ -49,11 +55,17 @@ LLAudioDecodeMgr *gAudioDecodeMgrp = NULL;
 
 static const S32 WAV_HEADER_SIZE = 44;
 
+// Decoded sounds kept in memory by default, in bytes of WAV data
+static const S64 DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
 
 //////////////////////////////////////////////////////////////////////////////
 
 
-class LLVorbisDecodeState : public LLRefCount
+// Decodes one Ogg Vorbis sound into a WAV image in memory. The Ogg data is
+// handed over whole, so a decode touches nothing shared and can run on a
+// job scheduler worker, or a section at a time on the main thread.
+class LLVorbisDecodeState : public LLJob
 {
 public:
 	class WriteResponder : public LLLFSThread::Responder
@@ -63,119 +75,130 @@ public:
 		~WriteResponder() {}
 		void completed(S32 bytes)
 		{
+			if (bytes <= 0)
+			{
+				LL_WARNS("AudioEngine") << "Unable to write decoded file for " << mDecoder->getUUID() << LL_ENDL;
+			}
 			mDecoder->ioComplete(bytes);
 		}
 		LLPointer<LLVorbisDecodeState> mDecoder;
 	};
-	
-	LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename);
+
+	// Takes the content of ogg_data
+	LLVorbisDecodeState(const LLUUID &uuid, std::vector<U8>& ogg_data, bool from_vfs);
 
 	BOOL initDecode();
 	BOOL decodeSection(); // Return TRUE if done.
 	BOOL finishDecode();
 
+	// Writes the WAV image to filename, on the LFS thread
+	void writeFile(const std::string& filename);
 	void flushBadFile();
 
-	void ioComplete(S32 bytes)			{ mBytesRead = bytes; }
+	// Called on the LFS thread when the write is done
+	void ioComplete(S32 bytes);
+	bool isWriting()					{ return mWriting; }
+	bool isWritten() const				{ return mBytesWritten > 0; }
+
 	BOOL isValid() const				{ return mValid; }
 	BOOL isDone() const					{ return mDone; }
 	const LLUUID &getUUID() const		{ return mUUID; }
+	const std::vector<U8>& getWAVBuffer() const { return mWAVBuffer; }
+
+	// Ogg callbacks, reading from mOggData
+	static size_t oggRead(void *ptr, size_t size, size_t nmemb, void *datasource);
+	static S32 oggSeek(void *datasource, ogg_int64_t offset, S32 whence);
+	static long oggTell(void *datasource);
 
 protected:
 	virtual ~LLVorbisDecodeState();
 
+	// The whole decode, on a worker thread
+	/*virtual*/ void run();
+
+	void releaseOggData();
+
 	BOOL mValid;
 	BOOL mDone;
-	LLAtomicS32 mBytesRead;
+	bool mOpen;
+	bool mFromVFS;
 	LLUUID mUUID;
 
 	std::vector<U8> mWAVBuffer;
-#if !defined(USE_WAV_VFILE)
-	std::string mOutFilename;
-	LLLFSThread::handle_t mFileHandle;
-#endif
-	
-	LLVFile *mInFilep;
+	std::vector<U8> mOggData;
+	size_t mOggPos;
+
+	LLAtomicBool mWriting;
+	S32 mBytesWritten; // set before mWriting is cleared
+
 	OggVorbis_File mVF;
 	S32 mCurrentSection;
 };
 
-size_t vfs_read(void *ptr, size_t size, size_t nmemb, void *datasource)
+size_t LLVorbisDecodeState::oggRead(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
-	LLVFile *file = (LLVFile *)datasource;
-
-	if (file->read((U8*)ptr, (S32)(size * nmemb)))	/*Flawfinder: ignore*/
+	LLVorbisDecodeState *decoder = (LLVorbisDecodeState *)datasource;
+	if (!size)
 	{
-		S32 read = file->getLastBytesRead();
-		return  read / size;	/*Flawfinder: ignore*/
+		return 0;
 	}
-	else
+
+	size_t count = llmin(nmemb, (decoder->mOggData.size() - decoder->mOggPos) / size);
+	if (count)
 	{
-		return 0;
+		memcpy(ptr, &decoder->mOggData[decoder->mOggPos], count * size);	/*Flawfinder: ignore*/
+		decoder->mOggPos += count * size;
 	}
+	return count;
 }
 
-S32 vfs_seek(void *datasource, ogg_int64_t offset, S32 whence)
+S32 LLVorbisDecodeState::oggSeek(void *datasource, ogg_int64_t offset, S32 whence)
 {
-	LLVFile *file = (LLVFile *)datasource;
+	LLVorbisDecodeState *decoder = (LLVorbisDecodeState *)datasource;
 
-	// vfs has 31-bit files
-	if (offset > S32_MAX)
-	{
-		return -1;
-	}
-
-	S32 origin;
+	ogg_int64_t origin;
 	switch (whence) {
 	case SEEK_SET:
 		origin = 0;
 		break;
 	case SEEK_END:
-		origin = file->getSize();
+		origin = decoder->mOggData.size();
 		break;
 	case SEEK_CUR:
-		origin = -1;
+		origin = decoder->mOggPos;
 		break;
 	default:
-		LL_ERRS("AudioEngine") << "Invalid whence argument to vfs_seek" << LL_ENDL;
+		LL_ERRS("AudioEngine") << "Invalid whence argument to oggSeek" << LL_ENDL;
 		return -1;
 	}
 
-	if (file->seek((S32)offset, origin))
-	{
-		return 0;
-	}
-	else
+	ogg_int64_t pos = origin + offset;
+	if (pos < 0 || pos > (ogg_int64_t)decoder->mOggData.size())
 	{
 		return -1;
 	}
-}
-
-S32 vfs_close (void *datasource)
-{
-	LLVFile *file = (LLVFile *)datasource;
-	delete file;
+	decoder->mOggPos = (size_t)pos;
 	return 0;
 }
 
-long vfs_tell (void *datasource)
+long LLVorbisDecodeState::oggTell(void *datasource)
 {
-	LLVFile *file = (LLVFile *)datasource;
-	return file->tell();
+	LLVorbisDecodeState *decoder = (LLVorbisDecodeState *)datasource;
+	return (long)decoder->mOggPos;
 }
 
-LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename)
+LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, std::vector<U8>& ogg_data, bool from_vfs)
 {
 	mDone = FALSE;
 	mValid = FALSE;
-	mBytesRead = -1;
+	mOpen = false;
+	mFromVFS = from_vfs;
 	mUUID = uuid;
-	mInFilep = NULL;
+	mOggData.swap(ogg_data);
+	mOggPos = 0;
 	mCurrentSection = 0;
-#if !defined(USE_WAV_VFILE)
-	mOutFilename = out_filename;
-	mFileHandle = LLLFSThread::nullHandle();
-#endif
+	mWriting = false;
+	mBytesWritten = 0;
 	// No default value for mVF, it's an ogg structure?
 	// Hey, let's zero it anyway, for predictability.
 	memset(&mVF, 0, sizeof(mVF));
@@ -183,39 +206,56 @@ LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &
 
 LLVorbisDecodeState::~LLVorbisDecodeState()
 {
-	if (!mDone)
+	releaseOggData();
+}
+
+void LLVorbisDecodeState::releaseOggData()
+{
+	if (mOpen)
 	{
-		delete mInFilep;
-		mInFilep = NULL;
+		ov_clear(&mVF);
+		mOpen = false;
 	}
+	std::vector<U8>().swap(mOggData);
 }
 
+void LLVorbisDecodeState::run()
+{
+	if (initDecode())
+	{
+		while (!decodeSection())
+		{
+			// decodeSection does all of the work above
+		}
+		finishDecode();
+	}
+	mDone = TRUE;
+}
 
 BOOL LLVorbisDecodeState::initDecode()
 {
-	ov_callbacks vfs_callbacks;
-	vfs_callbacks.read_func = vfs_read;
-	vfs_callbacks.seek_func = vfs_seek;
-	vfs_callbacks.close_func = vfs_close;
-	vfs_callbacks.tell_func = vfs_tell;
+	ov_callbacks ogg_callbacks;
+	ogg_callbacks.read_func = oggRead;
+	ogg_callbacks.seek_func = oggSeek;
+	ogg_callbacks.close_func = NULL;
+	ogg_callbacks.tell_func = oggTell;
 
-	LL_DEBUGS("AudioEngine") << "Initing decode from vfile: " << mUUID << LL_ENDL;
+	LL_DEBUGS("AudioEngine") << "Initing decode of " << mUUID << LL_ENDL;
 
-	mInFilep = new LLVFile(gVFS, mUUID, LLAssetType::AT_SOUND);
-	if (!mInFilep || !mInFilep->getSize())
+	if (mOggData.empty())
 	{
-		LL_WARNS("AudioEngine") << "unable to open vorbis source vfile for reading" << LL_ENDL;
-		delete mInFilep;
-		mInFilep = NULL;
+		LL_WARNS("AudioEngine") << "No vorbis source data for " << mUUID << LL_ENDL;
 		return FALSE;
 	}
 
-	S32 r = ov_open_callbacks(mInFilep, &mVF, NULL, 0, vfs_callbacks);
+	S32 r = ov_open_callbacks(this, &mVF, NULL, 0, ogg_callbacks);
 	if(r < 0) 
 	{
 		LL_WARNS("AudioEngine") << r << " Input to vorbis decode does not appear to be an Ogg bitstream: " << mUUID << LL_ENDL;
+		releaseOggData();
 		return(FALSE);
 	}
+	mOpen = true;
 	
 	S32 sample_count = (S32)ov_pcm_total(&mVF, -1);
 	size_t size_guess = (size_t)sample_count;
@@ -261,8 +301,7 @@ BOOL LLVorbisDecodeState::initDecode()
 		{
 			LL_WARNS("AudioEngine") << "Bad asset encoded by: " << comment->vendor << LL_ENDL;
 		}
-		delete mInFilep;
-		mInFilep = NULL;
+		releaseOggData();
 		return FALSE;
 	}
 
@@ -274,8 +313,7 @@ BOOL LLVorbisDecodeState::initDecode()
 	catch (std::bad_alloc&)
 	{
 		LL_WARNS("AudioEngine") << "Out of memory when trying to alloc buffer: " << size_guess << LL_ENDL;
-		delete mInFilep;
-		mInFilep = NULL;
+		releaseOggData();
 		return FALSE;
 	}
 
@@ -368,9 +406,9 @@ BOOL LLVorbisDecodeState::initDecode()
 
 BOOL LLVorbisDecodeState::decodeSection()
 {
-	if (!mInFilep)
+	if (!mOpen)
 	{
-		LL_WARNS("AudioEngine") << "No VFS file to decode in vorbis!" << LL_ENDL;
+		LL_WARNS("AudioEngine") << "No vorbis stream to decode!" << LL_ENDL;
 		return TRUE;
 	}
 	if (mDone)
@@ -420,11 +458,8 @@ BOOL LLVorbisDecodeState::finishDecode()
 		return TRUE; // We've finished
 	}
 
-#if !defined(USE_WAV_VFILE)	
-	if (mFileHandle == LLLFSThread::nullHandle())
-#endif
 	{
-		ov_clear(&mVF);
+		releaseOggData();
   
 		// write "data" chunk length, in little-endian format
 		S32 data_length = mWAVBuffer.size() - WAV_HEADER_SIZE;
@@ -495,74 +530,165 @@ BOOL LLVorbisDecodeState::finishDecode()
 			mValid = FALSE;
 			return TRUE; // we've finished
 		}
-#if !defined(USE_WAV_VFILE)
-		mBytesRead = -1;
-		mFileHandle = LLLFSThread::sLocal->write(mOutFilename, &mWAVBuffer[0], 0, mWAVBuffer.size(),
-							 new WriteResponder(this));
-#endif
-	}
-
-	if (mFileHandle != LLLFSThread::nullHandle())
-	{
-		if (mBytesRead >= 0)
-		{
-			if (mBytesRead == 0)
-			{
-				LL_WARNS("AudioEngine") << "Unable to write file in LLVorbisDecodeState::finishDecode" << LL_ENDL;
-				mValid = FALSE;
-				return TRUE; // we've finished
-			}
-		}
-		else
-		{
-			return FALSE; // not done
-		}
 	}
 	
 	mDone = TRUE;
 
-#if defined(USE_WAV_VFILE)
-	// write the data.
-	LLVFile output(gVFS, mUUID, LLAssetType::AT_SOUND_WAV);
-	output.write(&mWAVBuffer[0], mWAVBuffer.size());
-#endif
 	LL_DEBUGS("AudioEngine") << "Finished decode for " << getUUID() << LL_ENDL;
 
 	return TRUE;
 }
 
+void LLVorbisDecodeState::writeFile(const std::string& filename)
+{
+	if (isValid() && !mWAVBuffer.empty())
+	{
+		mWriting = true;
+		LLLFSThread::sLocal->write(filename, &mWAVBuffer[0], 0, mWAVBuffer.size(), new WriteResponder(this));
+	}
+}
+
+void LLVorbisDecodeState::ioComplete(S32 bytes)
+{
+	mBytesWritten = bytes;
+	mWriting = false;
+}
+
 void LLVorbisDecodeState::flushBadFile()
 {
-	if (mInFilep)
+	if (mFromVFS)
 	{
 		LL_WARNS("AudioEngine") << "Flushing bad vorbis file from VFS for " << mUUID << LL_ENDL;
-		mInFilep->remove();
+		LLVFile file(gVFS, mUUID, LLAssetType::AT_SOUND);
+		file.remove();
 	}
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
+static std::string decoded_filename(const LLUUID& uuid)
+{
+	std::string uuid_str;
+	uuid.toString(uuid_str);
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, uuid_str) + ".dsf";
+}
+
 class LLAudioDecodeMgr::Impl
 {
 	friend class LLAudioDecodeMgr;
 public:
-	Impl() {};
+	Impl();
 	~Impl() {};
 
 	void processQueue(const F32 num_secs = 0.005);
 
 protected:
-	std::deque<LLUUID> mDecodeQueue;
-	LLPointer<LLVorbisDecodeState> mCurrentDecodep;
+	struct Request
+	{
+		LLUUID mUUID;
+		std::vector<U8> mOggData; // empty to read the sound from the VFS
+	};
+
+	typedef std::list<LLUUID> lru_list_t;
+	struct CacheEntry
+	{
+		LLPointer<LLVorbisDecodeState> mDecode;
+		lru_list_t::iterator mLRU;
+	};
+	typedef std::map<LLUUID, CacheEntry> cache_map_t;
+	typedef std::list<LLPointer<LLVorbisDecodeState> > decode_list_t;
+
+	void addRequest(const LLUUID &uuid, const std::vector<U8>* ogg_data);
+	// Takes the next request off the queue, NULL if it needs no decode
+	LLPointer<LLVorbisDecodeState> startDecode();
+	void finishDecode(LLVorbisDecodeState* decodep);
+	// Sets the audio data flags once a decode is complete
+	void setDecoded(const LLUUID& uuid, bool valid);
+
+	// Returns false if the sound is kept only on disk
+	bool addToCache(LLVorbisDecodeState* decodep);
+	void removeFromCache(cache_map_t::iterator iter);
+	void evict();
+
+protected:
+	std::deque<Request> mDecodeQueue;
+	std::set<LLUUID> mPending;	// queued or decoding
+	LLPointer<LLVorbisDecodeState> mCurrentDecodep; // decoding on the main thread, without a scheduler
+	decode_list_t mJobs;		// decoding on the scheduler
+	decode_list_t mWrites;		// only kept on disk, waiting for the .dsf write
+	LLJobScheduler* mJobScheduler;
+
+	// Decoded sounds in memory, most recently used first
+	cache_map_t mCache;
+	lru_list_t mLRU;
+	S64 mMemoryUsed;
+	S64 mMemoryBudget;
+	bool mDiskCache;
 };
 
+LLAudioDecodeMgr::Impl::Impl()
+:	mJobScheduler(LLJobScheduler::getDefault()),
+	mMemoryUsed(0),
+	mMemoryBudget(DEFAULT_MEMORY_BUDGET),
+	mDiskCache(false)
+{
+}
 
 void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
 {
-	LLUUID uuid;
-
 	LLTimer decode_timer;
 
+	// Sounds kept only on disk are not decoded until the file is whole
+	for (decode_list_t::iterator iter = mWrites.begin(); iter != mWrites.end(); )
+	{
+		if (!(*iter)->isWriting())
+		{
+			const LLUUID& uuid = (*iter)->getUUID();
+			if (!(*iter)->isWritten())
+			{
+				// Don't leave a partial file to be taken as decoded
+				LLFile::remove(decoded_filename(uuid), ENOENT);
+			}
+			setDecoded(uuid, (*iter)->isWritten());
+			iter = mWrites.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	// Pick up decodes finished on the workers
+	for (decode_list_t::iterator iter = mJobs.begin(); iter != mJobs.end(); )
+	{
+		if ((*iter)->isComplete())
+		{
+			finishDecode(*iter);
+			iter = mJobs.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	if (mJobScheduler)
+	{
+		// Enough decodes in flight to keep every worker busy, but not the
+		// whole queue, each one holds its Ogg and WAV data until done
+		const size_t max_jobs = llmax(mJobScheduler->getThreadCount(), (U32)1) * 2;
+		while (!mDecodeQueue.empty() && mJobs.size() < max_jobs && decode_timer.getElapsedTimeF32() < num_secs)
+		{
+			LLPointer<LLVorbisDecodeState> decodep = startDecode();
+			if (decodep)
+			{
+				mJobs.push_back(decodep);
+				mJobScheduler->submit(decodep.get());
+			}
+		}
+		return;
+	}
+
 	BOOL done = FALSE;
 	while (!done)
 	{
@@ -576,56 +702,19 @@ void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
 				// decodeSection does all of the work above
 			}
 
-			if (mCurrentDecodep->isDone() && !mCurrentDecodep->isValid())
-			{
-				// We had an error when decoding, abort.
-				LL_WARNS("AudioEngine") << mCurrentDecodep->getUUID() << " has invalid vorbis data, aborting decode" << LL_ENDL;
-				mCurrentDecodep->flushBadFile();
-
-				if (gAudiop)
-				{
-					LLAudioData *adp = gAudiop->getAudioData(mCurrentDecodep->getUUID());
-					adp->setHasValidData(false);
-					adp->setHasCompletedDecode(true);
-				}
-
-				mCurrentDecodep = NULL;
-				done = TRUE;
-			}
-
 			if (!res)
 			{
 				// We've used up out time slice, bail...
 				done = TRUE;
 			}
-			else if (mCurrentDecodep)
+			else
 			{
-				if (gAudiop && mCurrentDecodep->finishDecode())
+				if (mCurrentDecodep->isValid())
 				{
-					// We finished!
-					LLAudioData *adp = gAudiop->getAudioData(mCurrentDecodep->getUUID());
-					if (!adp)
-					{
-						LL_WARNS("AudioEngine") << "Missing LLAudioData for decode of " << mCurrentDecodep->getUUID() << LL_ENDL;
-					}
-					else if (mCurrentDecodep->isValid() && mCurrentDecodep->isDone())
-					{
-						adp->setHasCompletedDecode(true);
-						adp->setHasDecodedData(true);
-						adp->setHasValidData(true);
-
-						// At this point, we could see if anyone needs this sound immediately, but
-						// I'm not sure that there's a reason to - we need to poll all of the playing
-						// sounds anyway.
-						//LL_INFOS("AudioEngine") << "Finished the vorbis decode, now what?" << LL_ENDL;
-					}
-					else
-					{
-						adp->setHasCompletedDecode(true);
-						LL_INFOS("AudioEngine") << "Vorbis decode failed for " << mCurrentDecodep->getUUID() << LL_ENDL;
-					}
-					mCurrentDecodep = NULL;
+					mCurrentDecodep->finishDecode();
 				}
+				finishDecode(mCurrentDecodep);
+				mCurrentDecodep = NULL;
 				done = TRUE; // done for now
 			}
 		}
@@ -639,33 +728,157 @@ void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
 			}
 			else
 			{
-				LLUUID uuid;
-				uuid = mDecodeQueue.front();
-				mDecodeQueue.pop_front();
-				if (!gAudiop || gAudiop->hasDecodedFile(uuid))
+				mCurrentDecodep = startDecode();
+				if (mCurrentDecodep && !mCurrentDecodep->initDecode())
 				{
-					// This file has already been decoded, don't decode it again.
-					continue;
+					finishDecode(mCurrentDecodep);
+					mCurrentDecodep = NULL;
 				}
+			}
+		}
+	}
+}
 
-				LL_DEBUGS() << "Decoding " << uuid << " from audio queue!" << LL_ENDL;
+void LLAudioDecodeMgr::Impl::addRequest(const LLUUID &uuid, const std::vector<U8>* ogg_data)
+{
+	if (!mPending.insert(uuid).second)
+	{
+		// Already on its way
+		return;
+	}
 
-				std::string uuid_str;
-				std::string d_path;
+	mDecodeQueue.push_back(Request());
+	mDecodeQueue.back().mUUID = uuid;
+	if (ogg_data)
+	{
+		mDecodeQueue.back().mOggData = *ogg_data;
+	}
+}
 
-				LLTimer timer;
-				timer.reset();
+LLPointer<LLVorbisDecodeState> LLAudioDecodeMgr::Impl::startDecode()
+{
+	LLUUID uuid = mDecodeQueue.front().mUUID;
+	std::vector<U8> ogg_data;
+	ogg_data.swap(mDecodeQueue.front().mOggData);
+	mDecodeQueue.pop_front();
 
-				uuid.toString(uuid_str);
-				d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+	if (mCache.count(uuid) || (gAudiop && gAudiop->hasDecodedFile(uuid)))
+	{
+		// This file has already been decoded, don't decode it again.
+		mPending.erase(uuid);
+		return NULL;
+	}
 
-				mCurrentDecodep = new LLVorbisDecodeState(uuid, d_path);
-				if (!mCurrentDecodep->initDecode())
-				{
-					mCurrentDecodep = NULL;
-				}
+	bool from_vfs = ogg_data.empty();
+	if (from_vfs)
+	{
+		// The whole asset is read here, so the decode needs nothing from the VFS
+		LLVFile infile(gVFS, uuid, LLAssetType::AT_SOUND);
+		S32 size = infile.getSize();
+		if (size > 0)
+		{
+			ogg_data.resize(size);
+			if (infile.read(&ogg_data[0], size))	/*Flawfinder: ignore*/
+			{
+				ogg_data.resize(infile.getLastBytesRead());
+			}
+			else
+			{
+				ogg_data.clear();
 			}
 		}
+		if (ogg_data.empty())
+		{
+			LL_WARNS("AudioEngine") << "unable to read vorbis source vfile for " << uuid << LL_ENDL;
+		}
+	}
+
+	LL_DEBUGS("AudioEngine") << "Decoding " << uuid << " from audio queue!" << LL_ENDL;
+	return new LLVorbisDecodeState(uuid, ogg_data, from_vfs);
+}
+
+void LLAudioDecodeMgr::Impl::finishDecode(LLVorbisDecodeState* decodep)
+{
+	if (decodep->isValid() && decodep->isDone())
+	{
+		if (!addToCache(decodep))
+		{
+			// Still pending until the .dsf write completes
+			mWrites.push_back(decodep);
+			return;
+		}
+		setDecoded(decodep->getUUID(), true);
+	}
+	else
+	{
+		// We had an error when decoding, abort.
+		LL_WARNS("AudioEngine") << decodep->getUUID() << " has invalid vorbis data, aborting decode" << LL_ENDL;
+		decodep->flushBadFile();
+		setDecoded(decodep->getUUID(), false);
+	}
+}
+
+void LLAudioDecodeMgr::Impl::setDecoded(const LLUUID& uuid, bool valid)
+{
+	mPending.erase(uuid);
+
+	LLAudioData *adp = gAudiop ? gAudiop->getAudioData(uuid) : NULL;
+	if (gAudiop && !adp)
+	{
+		LL_WARNS("AudioEngine") << "Missing LLAudioData for decode of " << uuid << LL_ENDL;
+	}
+
+	if (adp)
+	{
+		adp->setHasCompletedDecode(true);
+		adp->setHasDecodedData(valid);
+		adp->setHasValidData(valid);
+	}
+}
+
+bool LLAudioDecodeMgr::Impl::addToCache(LLVorbisDecodeState* decodep)
+{
+	const LLUUID& uuid = decodep->getUUID();
+	const S64 size = decodep->getWAVBuffer().size();
+	const bool in_memory = size <= mMemoryBudget;
+
+	// Sounds too large for memory go to disk regardless
+	if (mDiskCache || !in_memory)
+	{
+		decodep->writeFile(decoded_filename(uuid));
+	}
+
+	if (in_memory)
+	{
+		cache_map_t::iterator iter = mCache.find(uuid);
+		if (iter != mCache.end())
+		{
+			removeFromCache(iter);
+		}
+
+		mLRU.push_front(uuid);
+		CacheEntry& entry = mCache[uuid];
+		entry.mDecode = decodep;
+		entry.mLRU = mLRU.begin();
+		mMemoryUsed += size;
+		evict();
+	}
+	return in_memory;
+}
+
+void LLAudioDecodeMgr::Impl::removeFromCache(cache_map_t::iterator iter)
+{
+	mMemoryUsed -= iter->second.mDecode->getWAVBuffer().size();
+	mLRU.erase(iter->second.mLRU);
+	mCache.erase(iter);
+}
+
+void LLAudioDecodeMgr::Impl::evict()
+{
+	while (mMemoryUsed > mMemoryBudget && !mLRU.empty())
+	{
+		LL_DEBUGS("AudioEngine") << "Dropping decoded sound " << mLRU.back() << " from memory" << LL_ENDL;
+		removeFromCache(mCache.find(mLRU.back()));
 	}
 }
 
@@ -699,10 +912,58 @@ BOOL LLAudioDecodeMgr::addDecodeRequest(const LLUUID &uuid)
 	{
 		// Just put it on the decode queue.
 		LL_DEBUGS("AudioEngine") << "addDecodeRequest for " << uuid << " has local asset file already" << LL_ENDL;
-		mImpl->mDecodeQueue.push_back(uuid);
+		mImpl->addRequest(uuid, NULL);
 		return TRUE;
 	}
 
 	LL_DEBUGS("AudioEngine") << "addDecodeRequest for " << uuid << " no file available" << LL_ENDL;
 	return FALSE;
 }
+
+void LLAudioDecodeMgr::addDecodeRequest(const LLUUID &uuid, const std::vector<U8>& ogg_data)
+{
+	mImpl->addRequest(uuid, &ogg_data);
+}
+
+const std::vector<U8>* LLAudioDecodeMgr::getDecodedData(const LLUUID &uuid)
+{
+	Impl::cache_map_t::iterator iter = mImpl->mCache.find(uuid);
+	if (iter == mImpl->mCache.end())
+	{
+		return NULL;
+	}
+
+	mImpl->mLRU.splice(mImpl->mLRU.begin(), mImpl->mLRU, iter->second.mLRU);
+	return &iter->second.mDecode->getWAVBuffer();
+}
+
+bool LLAudioDecodeMgr::hasDecodedData(const LLUUID &uuid) const
+{
+	return mImpl->mCache.count(uuid) > 0;
+}
+
+S32 LLAudioDecodeMgr::getPendingCount() const
+{
+	return mImpl->mPending.size();
+}
+
+void LLAudioDecodeMgr::setMemoryBudget(S64 bytes)
+{
+	mImpl->mMemoryBudget = bytes;
+	mImpl->evict();
+}
+
+S64 LLAudioDecodeMgr::getMemoryUsed() const
+{
+	return mImpl->mMemoryUsed;
+}
+
+void LLAudioDecodeMgr::setDiskCache(bool enable)
+{
+	mImpl->mDiskCache = enable;
+}
+
+void LLAudioDecodeMgr::setJobScheduler(LLJobScheduler* scheduler)
+{
+	mImpl->mJobScheduler = scheduler;
+}
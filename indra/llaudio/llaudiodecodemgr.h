@@ -28,14 +28,21 @@
 
 #include "stdtypes.h"
 
+#include <vector>
+
 #include "lluuid.h"
 
 #include "llassettype.h"
 #include "llframetimer.h"
 
+class LLJobScheduler;
 class LLVFS;
 class LLVorbisDecodeState;
 
+// Decodes Ogg Vorbis sounds into WAV images in memory, on the default job
+// scheduler when there is one. Decoded sounds are kept in memory within a
+// budget, least recently used first out, and optionally written to the cache
+// directory as .dsf files.
 class LLAudioDecodeMgr
 {
 public:
@@ -45,6 +52,21 @@ public:
 	void processQueue(const F32 num_secs = 0.005);
 	BOOL addDecodeRequest(const LLUUID &uuid);
 	void addAudioRequest(const LLUUID &uuid);
+
+	// Queues Ogg data already in memory, for a sound not in the VFS
+	void addDecodeRequest(const LLUUID &uuid, const std::vector<U8>& ogg_data);
+
+	// WAV image of a sound decoded in memory, or NULL. Valid until the next processQueue().
+	const std::vector<U8>* getDecodedData(const LLUUID &uuid);
+	bool hasDecodedData(const LLUUID &uuid) const;
+	S32 getPendingCount() const; // queued or decoding
+
+	void setMemoryBudget(S64 bytes);
+	S64 getMemoryUsed() const;
+	// Also write every decoded sound to the cache directory
+	void setDiskCache(bool enable);
+	// NULL to decode on the main thread, within processQueue()'s time slice
+	void setJobScheduler(LLJobScheduler* scheduler);
 	
 protected:
 	class Impl;
@@ -998,6 +998,11 @@ void LLAudioEngine::cleanupAudioSource(LLAudioSource *asp)
 
 bool LLAudioEngine::hasDecodedFile(const LLUUID &uuid)
 {
+	if (gAudioDecodeMgrp && gAudioDecodeMgrp->hasDecodedData(uuid))
+	{
+		return true;
+	}
+
 	std::string uuid_str;
 	uuid.toString(uuid_str);
 
@@ -1834,12 +1839,36 @@ bool LLAudioData::load()
 		return true;
 	}
 
-	std::string uuid_str;
-	std::string wav_path;
-	mID.toString(uuid_str);
-	wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+	bool loaded;
+	const std::vector<U8>* wav_data = gAudioDecodeMgrp ? gAudioDecodeMgrp->getDecodedData(mID) : NULL;
+	if (wav_data)
+	{
+		loaded = mBufferp->loadWAVData(&(*wav_data)[0], wav_data->size());
+	}
+	else
+	{
+		std::string uuid_str;
+		std::string wav_path;
+		mID.toString(uuid_str);
+		wav_path= gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+
+		if (!gDirUtilp->fileExists(wav_path))
+		{
+			// Dropped from memory and not on disk, decode it again.
+			gAudiop->cleanupBuffer(mBufferp);
+			mBufferp = NULL;
+			setHasDecodedData(false);
+			setHasCompletedDecode(false);
+			if (!gAudioDecodeMgrp || !gAudioDecodeMgrp->addDecodeRequest(mID))
+			{
+				setHasLocalData(false);
+			}
+			return true;
+		}
+		loaded = mBufferp->loadWAV(wav_path);
+	}
 
-	if (!mBufferp->loadWAV(wav_path))
+	if (!loaded)
 	{
 		// Hrm.  Right now, let's unset the buffer, since it's empty.
 		gAudiop->cleanupBuffer(mBufferp);
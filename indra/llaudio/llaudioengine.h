@@ -174,7 +174,7 @@ public:
 	LLAudioChannel *getFreeChannel(const F32 priority); // Get a free channel or flush an existing one if your priority is higher
 	void cleanupBuffer(LLAudioBuffer *bufferp);
 
-	bool hasDecodedFile(const LLUUID &uuid);
+	bool hasDecodedFile(const LLUUID &uuid); // in memory or on disk
 	bool hasLocalFile(const LLUUID &uuid);
 
 	bool updateBufferForData(LLAudioData *adp, const LLUUID &audio_uuid = LLUUID::null);
@@ -447,6 +447,7 @@ class LLAudioBuffer
 public:
 	virtual ~LLAudioBuffer() {};
 	virtual bool loadWAV(const std::string& filename) = 0;
+	virtual bool loadWAVData(const U8* data, U32 size) = 0; // a WAV image in memory
 	virtual U32 getLength() = 0;
 
 	friend class LLAudioEngine;
@@ -0,0 +1,372 @@
+/**
+ * @file llaudiodecodemgr_test.cpp
+ * @brief Tests and decode throughput benchmark for LLAudioDecodeMgr.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llaudiodecodemgr.h"
+
+#include "lldir.h"
+#include "llfile.h"
+#include "lljobscheduler.h"
+#include "lllfsthread.h"
+#include "llmath.h"
+#include "lltimer.h"
+#include "../llvorbisencode.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	const S32 SAMPLE_RATE = 44100;
+
+	void put_u32(std::vector<U8>& data, U32 value)
+	{
+		for (S32 i = 0; i < 4; ++i)
+		{
+			data.push_back((U8)(value >> (i * 8)));
+		}
+	}
+
+	void put_u16(std::vector<U8>& data, U16 value)
+	{
+		data.push_back((U8)value);
+		data.push_back((U8)(value >> 8));
+	}
+
+	// A sample sound asset as the uploader makes it: a mono 16 bit WAV,
+	// a couple of tones and some noise, encoded to Ogg Vorbis.
+	std::vector<U8> make_ogg(F32 seconds, S32 seed)
+	{
+		const U32 samples = (U32)(seconds * SAMPLE_RATE);
+		std::vector<U8> wav;
+		wav.reserve(44 + samples * 2);
+		wav.push_back('R'); wav.push_back('I'); wav.push_back('F'); wav.push_back('F');
+		put_u32(wav, 36 + samples * 2);
+		wav.push_back('W'); wav.push_back('A'); wav.push_back('V'); wav.push_back('E');
+		wav.push_back('f'); wav.push_back('m'); wav.push_back('t'); wav.push_back(' ');
+		put_u32(wav, 16);
+		put_u16(wav, 1);					// PCM
+		put_u16(wav, 1);					// mono
+		put_u32(wav, SAMPLE_RATE);
+		put_u32(wav, SAMPLE_RATE * 2);
+		put_u16(wav, 2);
+		put_u16(wav, 16);
+		wav.push_back('d'); wav.push_back('a'); wav.push_back('t'); wav.push_back('a');
+		put_u32(wav, samples * 2);
+
+		U32 noise = seed + 1;
+		const F32 freq = 220.f + 55.f * seed;
+		for (U32 i = 0; i < samples; ++i)
+		{
+			noise = noise * 1103515245 + 12345;
+			F32 t = (F32)i / SAMPLE_RATE;
+			F32 value = 9000.f * sinf(F_TWO_PI * freq * t) + 4000.f * sinf(F_TWO_PI * freq * 2.5f * t)
+				+ (F32)((S32)((noise >> 16) & 0x7ff) - 0x400);
+			put_u16(wav, (U16)(S16)value);
+		}
+
+		std::string base = std::string(LLFile::tmpdir()) + llformat("llaudiodecodemgr_test_%d", seed);
+		std::string wav_name = base + ".wav";
+		std::string ogg_name = base + ".ogg";
+
+		LLFILE* fp = LLFile::fopen(wav_name, "wb");
+		fwrite(&wav[0], 1, wav.size(), fp);
+		fclose(fp);
+
+		std::vector<U8> ogg;
+		if (LLVORBISENC_NOERR == encode_vorbis_file(wav_name, ogg_name))
+		{
+			fp = LLFile::fopen(ogg_name, "rb");
+			fseek(fp, 0, SEEK_END);
+			ogg.resize(ftell(fp));
+			fseek(fp, 0, SEEK_SET);
+			if (fread(&ogg[0], 1, ogg.size(), fp) != ogg.size())
+			{
+				ogg.clear();
+			}
+			fclose(fp);
+		}
+		LLFile::remove(wav_name);
+		LLFile::remove(ogg_name);
+		return ogg;
+	}
+
+	void decode_all(LLAudioDecodeMgr& mgr)
+	{
+		while (mgr.getPendingCount())
+		{
+			mgr.processQueue(1.f);
+			if (mgr.getPendingCount())
+			{
+				ms_sleep(1);
+			}
+		}
+	}
+}
+
+namespace tut
+{
+	struct audio_decode
+	{
+		audio_decode()
+		{
+			for (S32 i = 0; i < SOUNDS; ++i)
+			{
+				mIDs[i].generate();
+				mOggs[i] = make_ogg(2.f, i);
+			}
+		}
+
+		~audio_decode()
+		{
+			LLJobScheduler::cleanupClass();
+		}
+
+		static const S32 SOUNDS = 4;
+		LLUUID mIDs[SOUNDS];
+		std::vector<U8> mOggs[SOUNDS];
+	};
+
+	typedef test_group<audio_decode> audio_decode_test;
+	typedef audio_decode_test::object audio_decode_t;
+	audio_decode_test tut_audio_decode("LLAudioDecodeMgr");
+
+	// sounds decode to WAV images in memory, bad data does not
+	template<> template<>
+	void audio_decode_t::test<1>()
+	{
+		ensure("encoded", !mOggs[0].empty());
+
+		LLAudioDecodeMgr mgr;
+		mgr.setJobScheduler(NULL);
+		mgr.addDecodeRequest(mIDs[0], mOggs[0]);
+		mgr.addDecodeRequest(mIDs[0], mOggs[0]);
+		ensure_equals("queued once", mgr.getPendingCount(), 1);
+
+		std::vector<U8> garbage(mOggs[1].size(), 0x5a);
+		LLUUID bad_id;
+		bad_id.generate();
+		mgr.addDecodeRequest(bad_id, garbage);
+		decode_all(mgr);
+
+		const std::vector<U8>* wav = mgr.getDecodedData(mIDs[0]);
+		ensure("decoded", wav != NULL);
+		ensure("RIFF", !memcmp(&(*wav)[0], "RIFF", 4));
+		ensure("data", !memcmp(&(*wav)[36], "data", 4));
+		U32 data_length = (*wav)[40] | ((*wav)[41] << 8) | ((*wav)[42] << 16) | ((*wav)[43] << 24);
+		ensure_equals("data length", (S32)data_length, (S32)wav->size() - 44);
+		ensure("about 2 seconds", data_length > SAMPLE_RATE * 2 * 19 / 10 && data_length < SAMPLE_RATE * 2 * 21 / 10);
+		ensure_equals("memory used", mgr.getMemoryUsed(), (S64)wav->size());
+
+		ensure("bad data not decoded", !mgr.hasDecodedData(bad_id));
+	}
+
+	// decoding on the job scheduler gives the same sounds as on the main thread
+	template<> template<>
+	void audio_decode_t::test<2>()
+	{
+		LLAudioDecodeMgr serial;
+		serial.setJobScheduler(NULL);
+		for (S32 i = 0; i < SOUNDS; ++i)
+		{
+			serial.addDecodeRequest(mIDs[i], mOggs[i]);
+		}
+		decode_all(serial);
+
+		LLJobScheduler::initClass(3);
+		LLAudioDecodeMgr threaded;
+		threaded.setJobScheduler(LLJobScheduler::getDefault());
+		for (S32 i = 0; i < SOUNDS; ++i)
+		{
+			threaded.addDecodeRequest(mIDs[i], mOggs[i]);
+		}
+		decode_all(threaded);
+
+		for (S32 i = 0; i < SOUNDS; ++i)
+		{
+			const std::vector<U8>* expected = serial.getDecodedData(mIDs[i]);
+			const std::vector<U8>* wav = threaded.getDecodedData(mIDs[i]);
+			ensure("serial decoded", expected != NULL);
+			ensure("threaded decoded", wav != NULL);
+			ensure("same sound", *wav == *expected);
+		}
+	}
+
+	// the least recently used sounds are dropped past the memory budget
+	template<> template<>
+	void audio_decode_t::test<3>()
+	{
+		LLAudioDecodeMgr mgr;
+		mgr.setJobScheduler(NULL);
+		mgr.addDecodeRequest(mIDs[3], mOggs[3]);
+		decode_all(mgr);
+		const S64 sound_size = mgr.getMemoryUsed();
+		ensure("sound size", sound_size > 0);
+
+		// every sample sound decodes to the same length
+		mgr.setMemoryBudget(sound_size * 2);
+		ensure("still kept", mgr.hasDecodedData(mIDs[3]));
+		mgr.addDecodeRequest(mIDs[0], mOggs[0]);
+		mgr.addDecodeRequest(mIDs[1], mOggs[1]);
+		decode_all(mgr);
+
+		// 0 is used again, 1 is now the oldest
+		ensure("first", mgr.getDecodedData(mIDs[0]) != NULL);
+		mgr.addDecodeRequest(mIDs[2], mOggs[2]);
+		decode_all(mgr);
+
+		ensure("within budget", mgr.getMemoryUsed() <= sound_size * 2);
+		ensure("recently used kept", mgr.hasDecodedData(mIDs[0]));
+		ensure("oldest dropped", !mgr.hasDecodedData(mIDs[1]));
+		ensure("newest kept", mgr.hasDecodedData(mIDs[2]));
+
+		mgr.setMemoryBudget(sound_size);
+		ensure("shrunk", mgr.getMemoryUsed() <= sound_size);
+		ensure("shrunk keeps newest", mgr.hasDecodedData(mIDs[2]));
+	}
+
+	// a batch of sounds decodes the same on the main thread and on the scheduler
+	template<> template<>
+	void audio_decode_t::test<4>()
+	{
+		const S32 COUNT = 8;
+		std::vector<std::vector<U8> > oggs(COUNT);
+		std::vector<LLUUID> ids(COUNT);
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			oggs[i] = (i < SOUNDS) ? mOggs[i] : make_ogg(1.f + (i % 2), i);
+			ids[i].generate();
+		}
+
+		std::vector<std::vector<U8> > decoded(COUNT);
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			if (pass)
+			{
+				LLJobScheduler::initClass(2);
+			}
+
+			LLAudioDecodeMgr mgr;
+			mgr.setJobScheduler(LLJobScheduler::getDefault());
+			mgr.setMemoryBudget(256 * 1024 * 1024);
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				mgr.addDecodeRequest(ids[i], oggs[i]);
+			}
+			decode_all(mgr);
+
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				ensure("decoded", mgr.hasDecodedData(ids[i]));
+				if (pass)
+				{
+					ensure("same as on the main thread", *mgr.getDecodedData(ids[i]) == decoded[i]);
+				}
+				else
+				{
+					decoded[i] = *mgr.getDecodedData(ids[i]);
+				}
+			}
+		}
+	}
+
+	// a sound kept only on disk is not done until its file is written
+	template<> template<>
+	void audio_decode_t::test<5>()
+	{
+		const std::string cache_dir = std::string(LLFile::tmpdir()) + "llaudiodecodemgr_test_cache";
+		ensure("cache dir", gDirUtilp->setCacheDir(cache_dir));
+		LLLFSThread::initClass(true);
+
+		LLAudioDecodeMgr mgr;
+		mgr.setJobScheduler(NULL);
+		mgr.addDecodeRequest(mIDs[0], mOggs[0]);
+		decode_all(mgr);
+		const std::vector<U8> expected = *mgr.getDecodedData(mIDs[0]);
+
+		LLAudioDecodeMgr disk_only;
+		disk_only.setJobScheduler(NULL);
+		disk_only.setMemoryBudget(0);
+		disk_only.addDecodeRequest(mIDs[1], mOggs[0]);
+		decode_all(disk_only);
+		ensure("not in memory", !disk_only.hasDecodedData(mIDs[1]));
+
+		std::string uuid_str;
+		mIDs[1].toString(uuid_str);
+		const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, uuid_str) + ".dsf";
+		std::vector<U8> written(expected.size() + 1);
+		LLFILE* fp = LLFile::fopen(filename, "rb");
+		ensure("file written", fp != NULL);
+		written.resize(fread(&written[0], 1, written.size(), fp));
+		fclose(fp);
+		ensure("whole file", written == expected);
+
+		LLFile::remove(filename);
+		LLLFSThread::cleanupClass();
+		gDirUtilp->setCacheDir("");
+		LLFile::rmdir(cache_dir);
+	}
+
+	// a venue's worth of sounds, decoded on the main thread and on the scheduler
+	template<> template<>
+	void audio_decode_t::test<6>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 COUNT = 32;
+		std::vector<std::vector<U8> > oggs(COUNT);
+		std::vector<LLUUID> ids(COUNT);
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			oggs[i] = (i < SOUNDS) ? mOggs[i] : make_ogg(2.f + (i % 4), i);
+			ids[i].generate();
+		}
+
+		F64 times[2];
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			if (pass)
+			{
+				LLJobScheduler::initClass();
+			}
+
+			LLAudioDecodeMgr mgr;
+			mgr.setJobScheduler(LLJobScheduler::getDefault());
+			mgr.setMemoryBudget(256 * 1024 * 1024);
+			LLTimer timer;
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				mgr.addDecodeRequest(ids[i], oggs[i]);
+			}
+			decode_all(mgr);
+			times[pass] = timer.getElapsedTimeF64();
+		}
+
+		LL_INFOS() << llformat("LLAudioDecodeMgr: %d sounds, main thread %.1f ms (%.1f sounds/s), job scheduler %.1f ms (%.1f sounds/s)",
+							   COUNT, times[0] * 1000.0, COUNT / llmax(times[0], 0.000001),
+							   times[1] * 1000.0, COUNT / llmax(times[1], 0.000001)) << LL_ENDL;
+	}
+}
@@ -193,26 +193,51 @@ static LLTrace::BlockTimerStatHandle FTM_UPDATE_HIDDEN_ANIMATION("Update Hidden
 static LLTrace::BlockTimerStatHandle FTM_UPDATE_MOTIONS("Update Motions");
 
 void LLCharacter::updateMotions(e_update_t update_type)
+{
+	if (beginUpdateMotions(update_type))
+	{
+		evaluateMotions();
+	}
+	endUpdateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+bool LLCharacter::beginUpdateMotions(e_update_t update_type)
 {
 	if (update_type == HIDDEN_UPDATE)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_UPDATE_HIDDEN_ANIMATION);
 		mMotionController.updateMotionsMinimal();
+		return false;
 	}
-	else
+
+	LL_RECORD_BLOCK_TIME(FTM_UPDATE_ANIMATION);
+	// unpause if the number of outstanding pause requests has dropped to the initial one
+	if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
 	{
-		LL_RECORD_BLOCK_TIME(FTM_UPDATE_ANIMATION);
-		// unpause if the number of outstanding pause requests has dropped to the initial one
-		if (mMotionController.isPaused() && mPauseRequest->getNumRefs() == 1)
-		{
-			mMotionController.unpauseAllMotions();
-		}
-		bool force_update = (update_type == FORCE_UPDATE);
-		{
-			LL_RECORD_BLOCK_TIME(FTM_UPDATE_MOTIONS);
-			mMotionController.updateMotions(force_update);
-		}
+		mMotionController.unpauseAllMotions();
 	}
+	bool force_update = (update_type == FORCE_UPDATE);
+	return mMotionController.beginUpdateMotions(force_update);
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::evaluateMotions()
+{
+	LL_RECORD_BLOCK_TIME(FTM_UPDATE_MOTIONS);
+	mMotionController.evaluateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// endUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLCharacter::endUpdateMotions()
+{
+	mMotionController.endUpdateMotions();
 }
 
 
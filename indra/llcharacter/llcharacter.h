@@ -155,6 +155,13 @@ public:
 	enum e_update_t { NORMAL_UPDATE, HIDDEN_UPDATE, FORCE_UPDATE };
 	void updateMotions(e_update_t update_type);
 
+	// updateMotions() split as in LLMotionController. evaluateMotions() may
+	// run on a worker thread, if beginUpdateMotions() returned true, and
+	// endUpdateMotions() must always follow on the main thread.
+	bool beginUpdateMotions(e_update_t update_type);
+	void evaluateMotions();
+	void endUpdateMotions();
+
 	LLAnimPauseRequest requestPause();
 	BOOL areAnimationsPaused() const { return mMotionController.isPaused(); }
 	void setAnimTimeFactor(F32 factor) { mMotionController.setTimeFactor(factor); }
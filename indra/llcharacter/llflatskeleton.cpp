@@ -0,0 +1,290 @@
+/**
+ * @file llflatskeleton.cpp
+ * @brief Implementation of LLFlatSkeleton class.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+//-----------------------------------------------------------------------------
+// Header Files
+//-----------------------------------------------------------------------------
+#include "linden_common.h"
+
+#include "llflatskeleton.h"
+
+namespace
+{
+	// a * b, as operator*(const LLQuaternion&, const LLQuaternion&)
+	inline void quat_mul(const LLVector4a& a, const LLVector4a& b, LLVector4a& res)
+	{
+		static const LLVector4a NEG_W(1.f, 1.f, 1.f, -1.f);
+
+		LLVector4a bw;
+		bw.splat<3>(b);
+		res.setMul(bw, a);
+
+		LLVector4a t1 = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 2, 1, 0)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 3, 3, 3)));
+		LLVector4a t2 = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 0, 2)));
+		LLVector4a t3 = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 1, 0, 2)), _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 0, 2, 1)));
+		t1.add(t2);
+		t1.mul(NEG_W);
+		res.add(t1);
+		res.sub(t3);
+	}
+
+	// v * q, as operator*(const LLVector3&, const LLQuaternion&) for unit q
+	inline void quat_rotate(const LLVector4a& q, const LLVector4a& v, LLVector4a& res)
+	{
+		LLVector4a t;
+		t.setCross3(q, v);
+		t.add(t);
+		LLVector4a w;
+		w.splat<3>(q);
+		LLVector4a tw;
+		tw.setMul(t, w);
+		LLVector4a qt;
+		qt.setCross3(q, t);
+		res.setAdd(v, tw);
+		res.add(qt);
+	}
+
+	// LLMatrix4::initAll(scale, q, pos)
+	inline void init_all(const LLVector4a& scale, const LLVector4a& q, const LLVector4a& pos, LLMatrix4a& res)
+	{
+		static const LLVector4a ROW0_A(-1.f, 1.f, 1.f, 0.f);
+		static const LLVector4a ROW0_B(-1.f, 1.f, -1.f, 0.f);
+		static const LLVector4a ROW1_A(1.f, -1.f, 1.f, 0.f);
+		static const LLVector4a ROW1_B(-1.f, -1.f, 1.f, 0.f);
+		static const LLVector4a ROW2_A(1.f, 1.f, -1.f, 0.f);
+		static const LLVector4a ROW2_B(1.f, -1.f, -1.f, 0.f);
+		static const LLVector4a ROW0(1.f, 0.f, 0.f, 0.f);
+		static const LLVector4a ROW1(0.f, 1.f, 0.f, 0.f);
+		static const LLVector4a ROW2(0.f, 0.f, 1.f, 0.f);
+
+		LLVector4a q2;
+		q2.setAdd(q, q);
+
+		// row 0: 1 - 2(yy + zz), 2(xy + zw), 2(xz - yw)
+		LLVector4a a = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 0, 0, 1)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 2, 1, 1)));
+		LLVector4a b = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 1, 2, 2)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 3, 3, 2)));
+		a.mul(ROW0_A);
+		b.mul(ROW0_B);
+		res.mMatrix[0].setAdd(a, b);
+		res.mMatrix[0].add(ROW0);
+
+		// row 1: 2(xy - zw), 1 - 2(xx + zz), 2(yz + xw)
+		a = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 1, 0, 0)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 2, 0, 1)));
+		b = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 0, 2, 2)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 3, 2, 3)));
+		a.mul(ROW1_A);
+		b.mul(ROW1_B);
+		res.mMatrix[1].setAdd(a, b);
+		res.mMatrix[1].add(ROW1);
+
+		// row 2: 2(xz + yw), 2(yz - xw), 1 - 2(xx + yy)
+		a = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 0, 1, 0)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 0, 2, 2)));
+		b = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 1, 0, 1)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 1, 3, 3)));
+		a.mul(ROW2_A);
+		b.mul(ROW2_B);
+		res.mMatrix[2].setAdd(a, b);
+		res.mMatrix[2].add(ROW2);
+
+		LLVector4a s;
+		s.splat<0>(scale);
+		res.mMatrix[0].mul(s);
+		s.splat<1>(scale);
+		res.mMatrix[1].mul(s);
+		s.splat<2>(scale);
+		res.mMatrix[2].mul(s);
+
+		static const LLVector4a W(0.f, 0.f, 0.f, 1.f);
+		res.mMatrix[3] = _mm_shuffle_ps(pos, W, _MM_SHUFFLE(3, 3, 2, 1));
+		res.mMatrix[3] = _mm_shuffle_ps(pos, res.mMatrix[3], _MM_SHUFFLE(2, 1, 1, 0));
+	}
+
+	inline void store3(const LLVector4a& v, F32* dst)
+	{
+		const F32* src = v.getF32ptr();
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+	}
+}
+
+//-----------------------------------------------------------------------------
+// LLFlatSkeleton()
+//-----------------------------------------------------------------------------
+LLFlatSkeleton::LLFlatSkeleton()
+{
+}
+
+//-----------------------------------------------------------------------------
+// ~LLFlatSkeleton()
+//-----------------------------------------------------------------------------
+LLFlatSkeleton::~LLFlatSkeleton()
+{
+	invalidate();
+}
+
+//-----------------------------------------------------------------------------
+// invalidate()
+//-----------------------------------------------------------------------------
+void LLFlatSkeleton::invalidate()
+{
+	for (U32 i = 0; i < mJoints.size(); ++i)
+	{
+		if (mJoints[i]->mFlatSkeleton == this)
+		{
+			mJoints[i]->mFlatSkeleton = NULL;
+			mJoints[i]->mFlatIndex = -1;
+		}
+	}
+	mJoints.clear();
+	mParent.clear();
+	mScaleChildOffset.clear();
+	mSkip.clear();
+}
+
+//-----------------------------------------------------------------------------
+// addJoint()
+//-----------------------------------------------------------------------------
+void LLFlatSkeleton::addJoint(LLJoint* joint, S32 parent)
+{
+	// a joint belongs to one layout at a time
+	if (joint->mFlatSkeleton && joint->mFlatSkeleton != this)
+	{
+		joint->mFlatSkeleton->invalidate();
+	}
+
+	S32 index = (S32)mJoints.size();
+	joint->mFlatSkeleton = this;
+	joint->mFlatIndex = index;
+	mJoints.push_back(joint);
+	mParent.push_back(parent);
+	mScaleChildOffset.push_back(joint->getXform()->getScaleChildOffset() ? 1 : 0);
+
+	for (LLJoint::joints_t::iterator iter = joint->mChildren.begin();
+		 iter != joint->mChildren.end(); ++iter)
+	{
+		addJoint(*iter, index);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// build()
+//-----------------------------------------------------------------------------
+void LLFlatSkeleton::build(LLJoint* root)
+{
+	invalidate();
+	addJoint(root, -1);
+
+	const U32 count = mJoints.size();
+	mSkip.resize(count);
+	mLocalPosition.resize(count);
+	mLocalRotation.resize(count);
+	mLocalScale.resize(count);
+	mWorldPosition.resize(count);
+	mWorldRotation.resize(count);
+	mWorldMatrix.resize(count);
+	for (U32 i = 0; i < count; ++i)
+	{
+		storeJoint(i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// storeJoint()
+//-----------------------------------------------------------------------------
+void LLFlatSkeleton::storeJoint(S32 index)
+{
+	LLXformMatrix* xform = mJoints[index]->getXform();
+	mLocalPosition[index].load3(xform->getPosition().mV);
+	mLocalRotation[index].loadua(xform->getRotation().mQ);
+	mLocalScale[index].load3(xform->getScale().mV);
+	mWorldPosition[index].load3(xform->getWorldPosition().mV);
+	mWorldRotation[index].loadua(xform->getWorldRotation().mQ);
+	mWorldMatrix[index].loadu(xform->getWorldMatrix());
+}
+
+//-----------------------------------------------------------------------------
+// update()
+//-----------------------------------------------------------------------------
+void LLFlatSkeleton::update(LLJoint* root)
+{
+	if (mJoints.empty() || mJoints[0] != root)
+	{
+		build(root);
+	}
+
+	// the root may hang from an object, it keeps its own update
+	mSkip[0] = !root->mUpdateXform;
+	if (mSkip[0])
+	{
+		return;
+	}
+	root->updateWorldMatrix();
+
+	S32 updates = 0;
+	const S32 count = mJoints.size();
+	for (S32 i = 1; i < count; ++i)
+	{
+		LLJoint* joint = mJoints[i];
+		const S32 parent = mParent[i];
+		mSkip[i] = mSkip[parent] || !joint->mUpdateXform;
+		if (mSkip[i] || !(joint->mDirtyFlags & LLJoint::MATRIX_DIRTY))
+		{
+			continue;
+		}
+
+		LLXformMatrix* xform = joint->getXform();
+		mLocalPosition[i].load3(xform->getPosition().mV);
+		mLocalRotation[i].loadua(xform->getRotation().mQ);
+		mLocalScale[i].load3(xform->getScale().mV);
+
+		LLVector4a offset = mLocalPosition[i];
+		if (mScaleChildOffset[parent])
+		{
+			offset.mul(mLocalScale[parent]);
+		}
+		LLVector4a& world_pos = mWorldPosition[i];
+		quat_rotate(mWorldRotation[parent], offset, world_pos);
+		world_pos.add(mWorldPosition[parent]);
+		quat_mul(mLocalRotation[i], mWorldRotation[parent], mWorldRotation[i]);
+
+		LLMatrix4a& world_mat = mWorldMatrix[i];
+		init_all(mLocalScale[i], mWorldRotation[i], world_pos, world_mat);
+
+		LLVector3 pos;
+		LLQuaternion rot;
+		LLMatrix4 mat;
+		store3(world_pos, pos.mV);
+		_mm_storeu_ps(rot.mQ, mWorldRotation[i]);
+		for (S32 row = 0; row < 4; ++row)
+		{
+			_mm_storeu_ps(mat.mMatrix[row], world_mat.mMatrix[row]);
+		}
+		xform->setWorldTransform(pos, rot, mat);
+		joint->mDirtyFlags = 0x0;
+		++updates;
+	}
+
+	LLJoint::sNumUpdates += updates;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file llflatskeleton.h
+ * @brief Implementation of LLFlatSkeleton class.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFLATSKELETON_H
+#define LL_LLFLATSKELETON_H
+
+//-----------------------------------------------------------------------------
+// Header Files
+//-----------------------------------------------------------------------------
+#include "llalignedarray.h"
+#include "lljoint.h"
+#include "llmatrix4a.h"
+#include "llvector4a.h"
+
+//-----------------------------------------------------------------------------
+// class LLFlatSkeleton
+//
+// A joint tree laid out as arrays in parent before child order, so world
+// matrices are computed in one linear pass instead of a recursion through
+// the joints. Motions still set local transforms on the LLJoints; the pass
+// picks them up from the dirty joints and writes the world transforms back,
+// so the joints read as before. The world matrices are also kept aligned
+// here for the skinning palette.
+//
+// The layout is built from the root on the first update and dropped when
+// joints are added, removed or deleted, to be built again on the next one.
+//-----------------------------------------------------------------------------
+class LLFlatSkeleton
+{
+public:
+	LLFlatSkeleton();
+	~LLFlatSkeleton();
+
+	// updates the world matrices of root and all joints below it,
+	// like root->updateWorldMatrixChildren()
+	void update(LLJoint* root);
+
+	// forgets the layout, called when the joint tree changes
+	void invalidate();
+
+	// joints laid out, 0 until the first update
+	S32 getNumJoints() const { return (S32)mJoints.size(); }
+
+	// world matrix of a joint of this skeleton, NULL if it is not in the
+	// layout or is waiting for an update
+	const LLMatrix4a* getWorldMatrix(const LLJoint* joint) const
+	{
+		if (joint->mFlatSkeleton != this || (joint->mDirtyFlags & LLJoint::MATRIX_DIRTY))
+		{
+			return NULL;
+		}
+		return &mWorldMatrix[joint->mFlatIndex];
+	}
+
+	// copies the world transform of a joint updated on its own
+	void storeJoint(S32 index);
+
+private:
+	void build(LLJoint* root);
+	void addJoint(LLJoint* joint, S32 parent);
+
+	std::vector<LLJoint*>				mJoints;
+	std::vector<S32>					mParent;		// -1 for the root
+	std::vector<U8>						mScaleChildOffset;
+	std::vector<U8>						mSkip;			// not updated this pass
+
+	LLAlignedArray<LLVector4a, 64>		mLocalPosition;
+	LLAlignedArray<LLVector4a, 64>		mLocalRotation;	// x, y, z, w
+	LLAlignedArray<LLVector4a, 64>		mLocalScale;
+	LLAlignedArray<LLVector4a, 64>		mWorldPosition;
+	LLAlignedArray<LLVector4a, 64>		mWorldRotation;
+	LLAlignedArray<LLMatrix4a, 64>		mWorldMatrix;
+};
+
+#endif // LL_LLFLATSKELETON_H
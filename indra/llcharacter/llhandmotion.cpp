@@ -110,7 +110,7 @@ BOOL LLHandMotion::onActivate()
 			mCharacter->setVisualParamWeight(gHandPoseNames[i], 0.f);
 		}
 		mCharacter->setVisualParamWeight(gHandPoseNames[mCurrentPose], 1.f);
-		mCharacter->updateVisualParams();
+		mCharacter->getMotionController().requestVisualParamsUpdate();
 	}
 	return TRUE;
 }
@@ -152,7 +152,7 @@ BOOL LLHandMotion::onUpdate(F32 time, U8* joint_mask)
 			// Update visual params now if we won't blend
 			if (mCurrentPose == HAND_POSE_RELAXED)
 			{
-				mCharacter->updateVisualParams();
+				mCharacter->getMotionController().requestVisualParamsUpdate();
 			}
 		}
 		mNewPose = HAND_POSE_RELAXED;
@@ -185,7 +185,7 @@ BOOL LLHandMotion::onUpdate(F32 time, U8* joint_mask)
 				// Update visual params now if we won't blend
 				if (mCurrentPose == *requestedHandPose)
 				{
-					mCharacter->updateVisualParams();
+					mCharacter->getMotionController().requestVisualParamsUpdate();
 				}
 			}
 			mNewPose = *requestedHandPose;
@@ -224,7 +224,7 @@ BOOL LLHandMotion::onUpdate(F32 time, U8* joint_mask)
 			mCharacter->setVisualParamWeight(gHandPoseNames[mCurrentPose], outgoingWeight);
 		}
 
-		mCharacter->updateVisualParams();
+		mCharacter->getMotionController().requestVisualParamsUpdate();
 		
 		if (incomingWeight == 1.f && outgoingWeight == 0.f)
 		{
@@ -31,12 +31,14 @@
 
 #include "lljoint.h"
 
+#include "llflatskeleton.h"
+
 #include "llmath.h"
 #include "llcallstack.h"
 #include <boost/algorithm/string.hpp>
 
-S32 LLJoint::sNumUpdates = 0;
-S32 LLJoint::sNumTouches = 0;
+LLAtomicS32 LLJoint::sNumUpdates(0);
+LLAtomicS32 LLJoint::sNumTouches(0);
 
 template <class T> 
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -110,6 +112,8 @@ void LLJoint::init()
 	mXform.setScale(LLVector3(1.0f, 1.0f, 1.0f));
 	mDirtyFlags = MATRIX_DIRTY | ROTATION_DIRTY | POSITION_DIRTY;
 	mUpdateXform = TRUE;
+	mFlatSkeleton = NULL;
+	mFlatIndex = -1;
     mSupport = SUPPORT_BASE;
     mEnd = LLVector3(0.0f, 0.0f, 0.0f);
 }
@@ -152,6 +156,10 @@ LLJoint::LLJoint(const std::string &name, LLJoint *parent) :
 //-----------------------------------------------------------------------------
 LLJoint::~LLJoint()
 {
+	if (mFlatSkeleton)
+	{
+		mFlatSkeleton->invalidate();
+	}
 	if (mParent)
 	{
 		mParent->removeChild( this );
@@ -273,6 +281,14 @@ void LLJoint::addChild(LLJoint* joint)
 {
 	if (joint->mParent)
 		joint->mParent->removeChild(joint);
+	if (mFlatSkeleton)
+	{
+		mFlatSkeleton->invalidate();
+	}
+	if (joint->mFlatSkeleton)
+	{
+		joint->mFlatSkeleton->invalidate();
+	}
 
 	mChildren.push_back(joint);
 	joint->mXform.setParent(&mXform);
@@ -289,6 +305,10 @@ void LLJoint::removeChild(LLJoint* joint)
 	joints_t::iterator iter = std::find(mChildren.begin(), mChildren.end(), joint);
 	if (iter != mChildren.end())
 	{
+		if (mFlatSkeleton)
+		{
+			mFlatSkeleton->invalidate();
+		}
 		mChildren.erase(iter);
 	
 		joint->mXform.setParent(NULL);
@@ -303,6 +323,10 @@ void LLJoint::removeChild(LLJoint* joint)
 //--------------------------------------------------------------------
 void LLJoint::removeAllChildren()
 {
+	if (mFlatSkeleton && !mChildren.empty())
+	{
+		mFlatSkeleton->invalidate();
+	}
 	for (LLJoint* joint : mChildren)
 	{
 		if (joint)
@@ -1004,6 +1028,10 @@ void LLJoint::updateWorldMatrix()
 		sNumUpdates++;
 		mXform.updateMatrix(FALSE);
 		mDirtyFlags = 0x0;
+		if (mFlatSkeleton)
+		{
+			mFlatSkeleton->storeJoint(mFlatIndex);
+		}
 	}
 }
 
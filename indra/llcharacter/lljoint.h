@@ -38,6 +38,9 @@
 #include "m4math.h"
 #include "llquaternion.h"
 #include "xform.h"
+#include "llatomic.h"
+
+class LLFlatSkeleton;
 
 const S32 LL_CHARACTER_MAX_JOINTS_PER_MESH = 15;
 // Need to set this to count of animate-able joints,
@@ -138,13 +141,18 @@ public:
 
 	S32				mJointNum;
 
+	// flat layout this joint is part of, if any, see LLFlatSkeleton
+	LLFlatSkeleton*	mFlatSkeleton;
+	S32				mFlatIndex;
+
 	// child joints
 	typedef std::vector<LLJoint*> joints_t;
 	joints_t mChildren;
 
 	// debug statics
-	static S32		sNumTouches;
-	static S32		sNumUpdates;
+	// characters may be animated on several threads at once
+	static LLAtomicS32	sNumTouches;
+	static LLAtomicS32	sNumUpdates;
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
@@ -48,6 +48,7 @@
 //-----------------------------------------------------------------------------
 LLVFS*				LLKeyframeMotion::sVFS = NULL;
 LLKeyframeDataCache::keyframe_data_map_t	LLKeyframeDataCache::sKeyframeDataMap;
+LLMutex LLKeyframeDataCache::sMutex;
 
 //-----------------------------------------------------------------------------
 // Globals
@@ -666,10 +667,11 @@ BOOL LLKeyframeMotion::onActivate()
 	if( mJointMotionList->mEmoteName.length() > 0 )
 	{
 		LLUUID emote_anim_id = gAnimLibrary.stringToAnimState(mJointMotionList->mEmoteName);
-		// don't start emote if already active to avoid recursion
+		// don't start emote if already active to avoid recursion,
+		// the controller starts it once this update is over
 		if (!mCharacter->isMotionActive(emote_anim_id))
 		{
-			mCharacter->startMotion( emote_anim_id );
+			mCharacter->getMotionController().requestStartMotion(emote_anim_id);
 		}
 	}
 
@@ -2374,6 +2376,8 @@ void LLKeyframeDataCache::dumpDiagInfo()
 
 	char buf[1024];		/* Flawfinder: ignore */
 
+	LLMutexLock lock(&sMutex);
+
 	LL_INFOS() << "-----------------------------------------------------" << LL_ENDL;
 	LL_INFOS() << "       Global Motion Table (DEBUG only)" << LL_ENDL;
 	LL_INFOS() << "-----------------------------------------------------" << LL_ENDL;
@@ -2406,6 +2410,7 @@ void LLKeyframeDataCache::dumpDiagInfo()
 //--------------------------------------------------------------------
 void LLKeyframeDataCache::addKeyframeData(const LLUUID& id, LLKeyframeMotion::JointMotionList* joint_motion_listp)
 {
+	LLMutexLock lock(&sMutex);
 	sKeyframeDataMap[id] = joint_motion_listp;
 }
 
@@ -2414,6 +2419,7 @@ void LLKeyframeDataCache::addKeyframeData(const LLUUID& id, LLKeyframeMotion::Jo
 //--------------------------------------------------------------------
 void LLKeyframeDataCache::removeKeyframeData(const LLUUID& id)
 {
+	LLMutexLock lock(&sMutex);
 	keyframe_data_map_t::iterator found_data = sKeyframeDataMap.find(id);
 	if (found_data != sKeyframeDataMap.end())
 	{
@@ -2427,6 +2433,7 @@ void LLKeyframeDataCache::removeKeyframeData(const LLUUID& id)
 //--------------------------------------------------------------------
 LLKeyframeMotion::JointMotionList* LLKeyframeDataCache::getKeyframeData(const LLUUID& id)
 {
+	LLMutexLock lock(&sMutex);
 	keyframe_data_map_t::iterator found_data = sKeyframeDataMap.find(id);
 	if (found_data == sKeyframeDataMap.end())
 	{
@@ -2448,6 +2455,7 @@ LLKeyframeDataCache::~LLKeyframeDataCache()
 //-----------------------------------------------------------------------------
 void LLKeyframeDataCache::clear()
 {
+	LLMutexLock lock(&sMutex);
 	for_each(sKeyframeDataMap.begin(), sKeyframeDataMap.end(), DeletePairedPointer());
 	sKeyframeDataMap.clear();
 }
@@ -38,6 +38,7 @@
 #include "llhandmotion.h"
 #include "lljointstate.h"
 #include "llmotion.h"
+#include "llmutex.h"
 #include "llquaternion.h"
 #include "v3dmath.h"
 #include "v3math.h"
@@ -435,6 +436,8 @@ protected:
 	AssetStatus						mAssetStatus;
 };
 
+// Shared by every character, and safe to use from any thread. Keyframe data
+// is only ever added, or removed when no character plays the motion.
 class LLKeyframeDataCache
 {
 public:
@@ -453,6 +456,9 @@ public:
 	//print out diagnostic info
 	static void dumpDiagInfo();
 	static void clear();
+
+private:
+	static LLMutex sMutex;
 };
 
 #endif // LL_LLKEYFRAMEMOTION_H
@@ -140,6 +140,8 @@ LLMotionController::LLMotionController()
 	  mTimeStepCount(0),
 	  mLastInterp(0.f),
 	  mIsSelf(FALSE),
+	  mForceUpdate(FALSE),
+	  mVisualParamsUpdateRequested(FALSE),
 	  mLastCountAfterPurge(0)
 {
 }
@@ -522,7 +524,7 @@ void LLMotionController::updateIdleMotion(LLMotion* motionp)
 		// this will only be called when an animation stops itself (runs out of time)
 		if (mLastTime <= motionp->mSendStopTimestamp)
 		{
-			mCharacter->requestStopMotion( motionp );
+			requestStopMotion(motionp);
 			stopMotionInstance(motionp, FALSE);
 		}
 	}
@@ -624,7 +626,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// this will only be called when an animation stops itself (runs out of time)
 				if (mLastTime <= motionp->mSendStopTimestamp)
 				{
-					mCharacter->requestStopMotion( motionp );
+					requestStopMotion(motionp);
 					stopMotionInstance(motionp, FALSE);
 				}
 			}
@@ -705,7 +707,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// this will only be called when an animation stops itself (runs out of time)
 				if (mLastTime <= motionp->mSendStopTimestamp)
 				{
-					mCharacter->requestStopMotion( motionp );
+					requestStopMotion(motionp);
 					stopMotionInstance(motionp, FALSE);
 				}
 			}
@@ -752,7 +754,7 @@ void LLMotionController::updateMotionsByType(LLMotion::LLMotionBlendType anim_ty
 				// animation has stopped itself due to internal logic
 				// propagate this to the network
 				// as not all viewers are guaranteed to have access to the same logic
-				mCharacter->requestStopMotion( motionp );
+				requestStopMotion(motionp);
 				stopMotionInstance(motionp, FALSE);
 			}
 
@@ -814,6 +816,18 @@ void LLMotionController::updateLoadingMotions()
 // updateMotion()
 //-----------------------------------------------------------------------------
 void LLMotionController::updateMotions(bool force_update)
+{
+	if (beginUpdateMotions(force_update))
+	{
+		evaluateMotions();
+	}
+	endUpdateMotions();
+}
+
+//-----------------------------------------------------------------------------
+// beginUpdateMotions()
+//-----------------------------------------------------------------------------
+bool LLMotionController::beginUpdateMotions(bool force_update)
 {
     // SL-763: "Distant animated objects run at super fast speed"
     // The use_quantum optimization or possibly the associated code in setTimeStamp()
@@ -826,6 +840,7 @@ void LLMotionController::updateMotions(bool force_update)
 	F32 delta_time = cur_time - mPrevTimerElapsed;
 	mPrevTimerElapsed = cur_time;
 	mLastTime = mAnimTime;
+	mForceUpdate = force_update;
 
 	// Always cap the number of loaded motions
 	purgeExcessMotions();
@@ -852,7 +867,7 @@ void LLMotionController::updateMotions(bool force_update)
 
 				updateLoadingMotions();
 				
-				return;
+				return false;
 			}
 			
 			// is calculating a new keyframe pose, make sure the last one gets applied
@@ -870,10 +885,18 @@ void LLMotionController::updateMotions(bool force_update)
 	}
 
 	updateLoadingMotions();
-	
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::evaluateMotions()
+{
 	resetJointSignatures();
 
-	if (mPaused && !force_update)
+	if (mPaused && !mForceUpdate)
 	{
 		updateIdleActiveMotions();
 	}
@@ -887,7 +910,7 @@ void LLMotionController::updateMotions(bool force_update)
 		// update all regular motions
 		updateRegularMotions();
 		
-		if (use_quantum)
+		if (mTimeStep != 0.f)
 		{
 			mPoseBlender.blendAndCache(TRUE);
 		}
@@ -901,6 +924,50 @@ void LLMotionController::updateMotions(bool force_update)
 //	LL_INFOS() << "Motion controller time " << motionTimer.getElapsedTimeF32() << LL_ENDL;
 }
 
+//-----------------------------------------------------------------------------
+// endUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::endUpdateMotions()
+{
+	for (motion_list_t::iterator iter = mStopRequests.begin();
+		 iter != mStopRequests.end(); ++iter)
+	{
+		// deprecated motions may have been deleted since
+		if (mLoadedMotions.find(*iter) != mLoadedMotions.end())
+		{
+			mCharacter->requestStopMotion(*iter);
+		}
+	}
+	mStopRequests.clear();
+
+	// swap out first, starting a motion may request more starts
+	uuid_vec_t start_requests;
+	start_requests.swap(mStartRequests);
+	for (uuid_vec_t::iterator iter = start_requests.begin();
+		 iter != start_requests.end(); ++iter)
+	{
+		if (!mCharacter->isMotionActive(*iter))
+		{
+			mCharacter->startMotion(*iter);
+		}
+	}
+
+	if (mVisualParamsUpdateRequested)
+	{
+		mVisualParamsUpdateRequested = FALSE;
+		mCharacter->updateVisualParams();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// requestStopMotion()
+// the character hears about it in endUpdateMotions()
+//-----------------------------------------------------------------------------
+void LLMotionController::requestStopMotion(LLMotion* motion)
+{
+	mStopRequests.push_back(motion);
+}
+
 //-----------------------------------------------------------------------------
 // updateMotionsMinimal()
 // minimal update (e.g. while hidden)
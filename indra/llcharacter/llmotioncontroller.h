@@ -132,6 +132,27 @@ public:
 	// deactivates terminated motions`
 	void updateMotions(bool force_update = false);
 
+	// updateMotions() in three steps, so the motions of several characters
+	// can be evaluated at once on worker threads.
+	// beginUpdateMotions() advances time and loads motions on the main thread,
+	// it returns false when there is nothing to evaluate this frame.
+	// evaluateMotions() runs the motions and blends them into the skeleton,
+	// it touches nothing outside this character and may run on any thread.
+	// endUpdateMotions() passes the start and stop requests and visual params
+	// updates made during evaluation on to the character, on the main thread.
+	bool beginUpdateMotions(bool force_update = false);
+	void evaluateMotions();
+	void endUpdateMotions();
+
+	// for motions that drive visual params: LLCharacter::updateVisualParams()
+	// can start and stop motions and morph the meshes, so it is put off until
+	// endUpdateMotions()
+	void requestVisualParamsUpdate() { mVisualParamsUpdateRequested = TRUE; }
+
+	// for motions that trigger other motions, e.g. a keyframe motion and its
+	// emote: the motion is started in endUpdateMotions() if not already active
+	void requestStartMotion(const LLUUID& id) { mStartRequests.push_back(id); }
+
 	// minimal update (e.g. while hidden)
 	void updateMotionsMinimal();
 
@@ -191,6 +212,7 @@ protected:
 	void updateIdleActiveMotions();
 	void purgeExcessMotions();
 	void deactivateStoppedMotions();
+	void requestStopMotion(LLMotion* motion);
 
 protected:
 	F32					mTimeFactor;			// 1.f for normal speed
@@ -228,6 +250,11 @@ protected:
 	F32					mLastInterp;
 
 	U8					mJointSignature[2][LL_CHARACTER_MAX_ANIMATED_JOINTS];
+
+	BOOL				mForceUpdate;
+	motion_list_t		mStopRequests;			// made during evaluateMotions()
+	uuid_vec_t			mStartRequests;			// likewise
+	BOOL				mVisualParamsUpdateRequested;	// likewise
 private:
 	U32					mLastCountAfterPurge; //for logging and debugging purposes
 };
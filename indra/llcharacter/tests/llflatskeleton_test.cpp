@@ -0,0 +1,275 @@
+/**
+ * @file llflatskeleton_test.cpp
+ * @brief Flat skeleton world matrices against the joint recursion, and benchmark.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llflatskeleton.h"
+
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	// about the size of the bento skeleton with collision volumes and attachment points
+	const S32 JOINT_COUNT = 180;
+
+	F32 frand(U32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return (F32)((seed >> 8) & 0xffff) / 65535.f;
+	}
+
+	LLQuaternion random_rotation(U32& seed, F32 range)
+	{
+		LLVector3 axis(frand(seed) - 0.5f, frand(seed) - 0.5f, frand(seed) - 0.5f + 0.01f);
+		axis.normalize();
+		return LLQuaternion((frand(seed) - 0.5f) * range, axis);
+	}
+
+	// Skeletons built the same from the same seed: spines with limbs hanging off
+	// them, some scaled the way body shape sliders scale bones
+	struct Skeleton
+	{
+		Skeleton(U32 seed)
+		{
+			for (S32 i = 0; i < JOINT_COUNT; ++i)
+			{
+				LLJoint* joint = new LLJoint;
+				S32 parent = i ? (S32)(frand(seed) * i * 0.9f) : -1;
+				joint->setup(llformat("mJoint%d", i), parent < 0 ? NULL : mJoints[parent]);
+				joint->setPosition(LLVector3(frand(seed) * 0.2f, frand(seed) * 0.1f - 0.05f, frand(seed) * 0.3f));
+				joint->setRotation(random_rotation(seed, F_PI));
+				if (frand(seed) < 0.3f)
+				{
+					joint->setScale(LLVector3(0.8f + frand(seed) * 0.4f, 0.8f + frand(seed) * 0.4f, 0.8f + frand(seed) * 0.4f));
+				}
+				mJoints.push_back(joint);
+			}
+			mJoints[0]->setPosition(LLVector3(128.f, 64.f, 22.f));
+		}
+
+		~Skeleton()
+		{
+			for (S32 i = mJoints.size() - 1; i >= 0; --i)
+			{
+				delete mJoints[i];
+			}
+		}
+
+		// what motions do to a frame
+		void animate(U32 seed, F32 fraction)
+		{
+			for (U32 i = 1; i < mJoints.size(); ++i)
+			{
+				if (frand(seed) < fraction)
+				{
+					mJoints[i]->setRotation(random_rotation(seed, 1.f));
+				}
+			}
+		}
+
+		std::vector<LLJoint*> mJoints;
+	};
+
+	bool close_matrices(const LLMatrix4& a, const LLMatrix4& b)
+	{
+		for (S32 i = 0; i < 4; ++i)
+		{
+			for (S32 j = 0; j < 4; ++j)
+			{
+				if (fabsf(a.mMatrix[i][j] - b.mMatrix[i][j]) > 1.e-4f * llmax(1.f, fabsf(a.mMatrix[i][j])))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	bool same_pose(Skeleton& recursive, Skeleton& flat)
+	{
+		for (S32 i = 0; i < JOINT_COUNT; ++i)
+		{
+			LLXformMatrix* a = recursive.mJoints[i]->getXform();
+			LLXformMatrix* b = flat.mJoints[i]->getXform();
+			if (recursive.mJoints[i]->mDirtyFlags != flat.mJoints[i]->mDirtyFlags
+				|| !close_matrices(a->getWorldMatrix(), b->getWorldMatrix())
+				|| dist_vec(a->getWorldPosition(), b->getWorldPosition()) > 1.e-4f
+				|| dot(a->getWorldRotation(), b->getWorldRotation()) < 0.9999f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+namespace tut
+{
+	struct flat_skeleton
+	{
+	};
+
+	typedef test_group<flat_skeleton> flat_skeleton_test;
+	typedef flat_skeleton_test::object flat_skeleton_t;
+	flat_skeleton_test tut_flat_skeleton("LLFlatSkeleton");
+
+	// world transforms match updateWorldMatrixChildren frame after frame
+	template<> template<>
+	void flat_skeleton_t::test<1>()
+	{
+		Skeleton recursive(1);
+		Skeleton flat(1);
+		LLFlatSkeleton skeleton;
+
+		recursive.mJoints[0]->updateWorldMatrixChildren();
+		skeleton.update(flat.mJoints[0]);
+		ensure_equals("laid out", skeleton.getNumJoints(), JOINT_COUNT);
+		ensure("first frame", same_pose(recursive, flat));
+
+		for (U32 frame = 0; frame < 20; ++frame)
+		{
+			recursive.animate(frame, 0.5f);
+			flat.animate(frame, 0.5f);
+			if (frame == 10)
+			{
+				// a subtree that is not updated stays dirty in both
+				recursive.mJoints[5]->mUpdateXform = FALSE;
+				flat.mJoints[5]->mUpdateXform = FALSE;
+			}
+			recursive.mJoints[0]->updateWorldMatrixChildren();
+			skeleton.update(flat.mJoints[0]);
+			ensure(llformat("frame %d", frame), same_pose(recursive, flat));
+		}
+	}
+
+	// the aligned world matrices follow the joints, however they were updated
+	template<> template<>
+	void flat_skeleton_t::test<2>()
+	{
+		Skeleton flat(2);
+		LLFlatSkeleton skeleton;
+		skeleton.update(flat.mJoints[0]);
+
+		LLJoint* joint = flat.mJoints[JOINT_COUNT - 1];
+		const LLMatrix4a* world = skeleton.getWorldMatrix(joint);
+		ensure("laid out", world != NULL);
+		LLMatrix4a expected;
+		expected.loadu(joint->getWorldMatrix());
+		ensure("same matrix", !memcmp(world, &expected, sizeof(LLMatrix4a)));
+
+		joint->setRotation(LLQuaternion(0.5f, LLVector3::z_axis));
+		ensure("dirty", skeleton.getWorldMatrix(joint) == NULL);
+
+		// updated on its own, outside of the pass
+		expected.loadu(joint->getWorldMatrix());
+		world = skeleton.getWorldMatrix(joint);
+		ensure("clean again", world != NULL);
+		ensure("stored", !memcmp(world, &expected, sizeof(LLMatrix4a)));
+
+		LLJoint other;
+		ensure("not laid out", skeleton.getWorldMatrix(&other) == NULL);
+	}
+
+	// changes to the joint tree lay the skeleton out again
+	template<> template<>
+	void flat_skeleton_t::test<3>()
+	{
+		Skeleton flat(3);
+		LLFlatSkeleton skeleton;
+		skeleton.update(flat.mJoints[0]);
+
+		LLJoint* extra = new LLJoint;
+		flat.mJoints[7]->addChild(extra);
+		ensure_equals("dropped on add", skeleton.getNumJoints(), 0);
+		ensure("no stale index", extra->mFlatSkeleton == NULL && flat.mJoints[7]->mFlatSkeleton == NULL);
+
+		skeleton.update(flat.mJoints[0]);
+		ensure_equals("added", skeleton.getNumJoints(), JOINT_COUNT + 1);
+		ensure("extra updated", skeleton.getWorldMatrix(extra) != NULL);
+
+		delete extra;
+		ensure_equals("dropped on delete", skeleton.getNumJoints(), 0);
+		skeleton.update(flat.mJoints[0]);
+		ensure_equals("removed", skeleton.getNumJoints(), JOINT_COUNT);
+	}
+
+	// a crowd of skeletons, a third of the joints animated each frame
+	template<> template<>
+	void flat_skeleton_t::test<4>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 SKELETONS = 100;
+		const S32 FRAMES = 100;
+
+		F64 times[2];
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			std::vector<Skeleton*> crowd;
+			std::vector<LLFlatSkeleton*> flat;
+			for (S32 i = 0; i < SKELETONS; ++i)
+			{
+				crowd.push_back(new Skeleton(i + 1));
+				flat.push_back(new LLFlatSkeleton);
+			}
+
+			F64 elapsed = 0.0;
+			for (S32 frame = 0; frame < FRAMES; ++frame)
+			{
+				for (S32 i = 0; i < SKELETONS; ++i)
+				{
+					crowd[i]->animate(frame * SKELETONS + i, 0.33f);
+				}
+				LLTimer timer;
+				for (S32 i = 0; i < SKELETONS; ++i)
+				{
+					if (pass)
+					{
+						flat[i]->update(crowd[i]->mJoints[0]);
+					}
+					else
+					{
+						crowd[i]->mJoints[0]->updateWorldMatrixChildren();
+					}
+				}
+				elapsed += timer.getElapsedTimeF64();
+			}
+			times[pass] = elapsed;
+
+			for (S32 i = 0; i < SKELETONS; ++i)
+			{
+				delete crowd[i];
+				delete flat[i];
+			}
+		}
+
+		LL_INFOS() << llformat("LLFlatSkeleton: %d skeletons of %d joints, %.3f ms a frame recursive, %.3f ms flat (%.1fx)",
+							   SKELETONS, JOINT_COUNT, times[0] * 1000.0 / FRAMES, times[1] * 1000.0 / FRAMES,
+							   times[0] / llmax(times[1], 0.000001)) << LL_ENDL;
+	}
+}
@@ -0,0 +1,484 @@
+/**
+ * @file llmotioncontroller_test.cpp
+ * @brief Tests and headless crowd benchmark for split motion updates.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmotioncontroller.h"
+
+#include "lljobscheduler.h"
+#include "lltimer.h"
+#include "../llcharacter.h"
+#include "../lljointstate.h"
+#include "../llkeyframemotion.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	const LLUUID SWAY_ID("4a3e7ad0-6f32-4d6b-9c46-3f1b7e1c2a01");
+	const LLUUID NOD_ID("4a3e7ad0-6f32-4d6b-9c46-3f1b7e1c2a02");
+	const LLUUID PARAM_ID("4a3e7ad0-6f32-4d6b-9c46-3f1b7e1c2a03");
+	const LLUUID CUE_ID("4a3e7ad0-6f32-4d6b-9c46-3f1b7e1c2a04");
+	const S32 JOINT_COUNT = 100;
+
+	// Rotates every joint of the character a little, each at its own rate.
+	// Loops, like a stand or walk.
+	class LLSwayMotion : public LLMotion
+	{
+	public:
+		LLSwayMotion(const LLUUID& id) : LLMotion(id), mCharacter(NULL) { mName = "sway"; }
+		static LLMotion* create(const LLUUID& id) { return new LLSwayMotion(id); }
+
+		/*virtual*/ BOOL getLoop() { return TRUE; }
+		/*virtual*/ F32 getDuration() { return 0.f; }
+		/*virtual*/ F32 getEaseInDuration() { return 0.2f; }
+		/*virtual*/ F32 getEaseOutDuration() { return 0.2f; }
+		/*virtual*/ LLJoint::JointPriority getPriority() { return LLJoint::MEDIUM_PRIORITY; }
+		/*virtual*/ LLMotionBlendType getBlendType() { return NORMAL_BLEND; }
+		/*virtual*/ F32 getMinPixelArea() { return 0.f; }
+
+		/*virtual*/ LLMotionInitStatus onInitialize(LLCharacter* character)
+		{
+			mCharacter = character;
+			for (S32 i = 0; i < JOINT_COUNT; ++i)
+			{
+				LLPointer<LLJointState> state = new LLJointState(character->getCharacterJoint(i));
+				state->setUsage(LLJointState::ROT);
+				state->setPriority(getPriority());
+				addJointState(state);
+				mJointSignature[1][i] = 0xff;
+			}
+			return STATUS_SUCCESS;
+		}
+
+		/*virtual*/ BOOL onActivate() { return TRUE; }
+
+		/*virtual*/ BOOL onUpdate(F32 time, U8* joint_mask)
+		{
+			for (S32 i = 0; i < mPose.getNumJointStates(); ++i)
+			{
+				LLJointState* state = mPose.findJointState(mCharacter->getCharacterJoint(i));
+				F32 angle = 0.3f * sinf(time * (1.f + 0.05f * i) + 0.7f * i);
+				state->setRotation(LLQuaternion(angle, LLVector3(sinf(0.3f * i), cosf(0.3f * i), 0.5f)));
+			}
+			return TRUE;
+		}
+
+		/*virtual*/ void onDeactivate() {}
+
+	private:
+		LLCharacter* mCharacter;
+	};
+
+	// A short gesture on the first joints that runs out of time by itself
+	class LLNodMotion : public LLSwayMotion
+	{
+	public:
+		LLNodMotion(const LLUUID& id) : LLSwayMotion(id) { mName = "nod"; }
+		static LLMotion* create(const LLUUID& id) { return new LLNodMotion(id); }
+
+		/*virtual*/ BOOL getLoop() { return FALSE; }
+		/*virtual*/ F32 getDuration() { return 0.25f; }
+		/*virtual*/ F32 getEaseOutDuration() { return 0.f; }
+		/*virtual*/ LLJoint::JointPriority getPriority() { return LLJoint::HIGH_PRIORITY; }
+	};
+
+	// Drives visual params every update, like the avatar physics
+	class LLParamMotion : public LLSwayMotion
+	{
+	public:
+		LLParamMotion(const LLUUID& id) : LLSwayMotion(id), mCharacter(NULL) { mName = "param"; }
+		static LLMotion* create(const LLUUID& id) { return new LLParamMotion(id); }
+
+		/*virtual*/ LLMotionInitStatus onInitialize(LLCharacter* character)
+		{
+			mCharacter = character;
+			return LLSwayMotion::onInitialize(character);
+		}
+
+		/*virtual*/ BOOL onUpdate(F32 time, U8* joint_mask)
+		{
+			mCharacter->getMotionController().requestVisualParamsUpdate();
+			return LLSwayMotion::onUpdate(time, joint_mask);
+		}
+
+	private:
+		LLCharacter* mCharacter;
+	};
+
+	// Starts a nod along with itself, like a keyframe motion and its emote
+	class LLCueMotion : public LLSwayMotion
+	{
+	public:
+		LLCueMotion(const LLUUID& id) : LLSwayMotion(id), mCharacter(NULL) { mName = "cue"; }
+		static LLMotion* create(const LLUUID& id) { return new LLCueMotion(id); }
+
+		/*virtual*/ LLMotionInitStatus onInitialize(LLCharacter* character)
+		{
+			mCharacter = character;
+			return LLSwayMotion::onInitialize(character);
+		}
+
+		/*virtual*/ BOOL onActivate()
+		{
+			mCharacter->getMotionController().requestStartMotion(NOD_ID);
+			return TRUE;
+		}
+
+	private:
+		LLCharacter* mCharacter;
+	};
+
+	// A character with nothing but a skeleton, on flat ground
+	class LLTestCharacter : public LLCharacter
+	{
+	public:
+		LLTestCharacter() :
+			mVisualParamUpdates(0)
+		{
+			mID.generate();
+			for (S32 i = 0; i < JOINT_COUNT; ++i)
+			{
+				LLJoint* joint = new LLJoint;
+				joint->setup(llformat("mJoint%d", i), i ? mJoints[(i - 1) / 3] : NULL);
+				joint->setJointNum(i);
+				joint->setPosition(LLVector3(0.1f, 0.02f * (i % 3), 0.05f));
+				mJoints.push_back(joint);
+			}
+			registerMotion(SWAY_ID, LLSwayMotion::create);
+			registerMotion(NOD_ID, LLNodMotion::create);
+			registerMotion(PARAM_ID, LLParamMotion::create);
+			registerMotion(CUE_ID, LLCueMotion::create);
+		}
+
+		~LLTestCharacter()
+		{
+			flushAllMotions();
+			for (S32 i = JOINT_COUNT - 1; i >= 0; --i)
+			{
+				delete mJoints[i];
+			}
+		}
+
+		/*virtual*/ const char* getAnimationPrefix() { return "test"; }
+		/*virtual*/ LLJoint* getRootJoint() { return mJoints[0]; }
+		/*virtual*/ LLVector3 getCharacterPosition() { return mJoints[0]->getWorldPosition(); }
+		/*virtual*/ LLQuaternion getCharacterRotation() { return mJoints[0]->getWorldRotation(); }
+		/*virtual*/ LLVector3 getCharacterVelocity() { return LLVector3::zero; }
+		/*virtual*/ LLVector3 getCharacterAngularVelocity() { return LLVector3::zero; }
+		/*virtual*/ void getGround(const LLVector3& in_pos, LLVector3& out_pos, LLVector3& out_norm)
+		{
+			out_pos.setVec(in_pos.mV[VX], in_pos.mV[VY], 0.f);
+			out_norm.setVec(0.f, 0.f, 1.f);
+		}
+		/*virtual*/ LLJoint* getCharacterJoint(U32 i) { return i < mJoints.size() ? mJoints[i] : NULL; }
+		/*virtual*/ F32 getTimeDilation() { return 1.f; }
+		/*virtual*/ F32 getPixelArea() const { return 100000.f; }
+		/*virtual*/ LLPolyMesh* getHeadMesh() { return NULL; }
+		/*virtual*/ LLPolyMesh* getUpperBodyMesh() { return NULL; }
+		/*virtual*/ LLVector3d getPosGlobalFromAgent(const LLVector3& position) { return LLVector3d(position); }
+		/*virtual*/ LLVector3 getPosAgentFromGlobal(const LLVector3d& position) { return LLVector3(position); }
+		/*virtual*/ void addDebugText(const std::string& text) {}
+		/*virtual*/ const LLUUID& getID() const { return mID; }
+
+		/*virtual*/ void requestStopMotion(LLMotion* motion)
+		{
+			mStopRequests.push_back(motion->getID());
+		}
+
+		/*virtual*/ void updateVisualParams()
+		{
+			++mVisualParamUpdates;
+		}
+
+		LLUUID mID;
+		std::vector<LLJoint*> mJoints;
+		std::vector<LLUUID> mStopRequests;
+		S32 mVisualParamUpdates;
+	};
+
+	// Animation and world matrices of a whole crowd, one frame
+	void update_crowd(std::vector<LLTestCharacter*>& crowd, LLJobScheduler* scheduler, bool split)
+	{
+		if (!split)
+		{
+			for (U32 i = 0; i < crowd.size(); ++i)
+			{
+				crowd[i]->updateMotions(LLCharacter::NORMAL_UPDATE);
+				crowd[i]->getRootJoint()->updateWorldMatrixChildren();
+			}
+			return;
+		}
+
+		std::vector<bool> evaluate(crowd.size());
+		for (U32 i = 0; i < crowd.size(); ++i)
+		{
+			evaluate[i] = crowd[i]->beginUpdateMotions(LLCharacter::NORMAL_UPDATE);
+		}
+		ll_parallel_for(scheduler, crowd.size(), 1, [&](U32 begin, U32 end)
+		{
+			for (U32 i = begin; i < end; ++i)
+			{
+				if (evaluate[i])
+				{
+					crowd[i]->evaluateMotions();
+				}
+				crowd[i]->getRootJoint()->updateWorldMatrixChildren();
+			}
+		});
+		for (U32 i = 0; i < crowd.size(); ++i)
+		{
+			crowd[i]->endUpdateMotions();
+		}
+	}
+
+	std::vector<LLTestCharacter*> make_crowd(S32 count)
+	{
+		std::vector<LLTestCharacter*> crowd;
+		for (S32 i = 0; i < count; ++i)
+		{
+			crowd.push_back(new LLTestCharacter);
+			crowd.back()->startMotion(SWAY_ID);
+		}
+		return crowd;
+	}
+
+	void delete_crowd(std::vector<LLTestCharacter*>& crowd)
+	{
+		for (U32 i = 0; i < crowd.size(); ++i)
+		{
+			delete crowd[i];
+		}
+		crowd.clear();
+	}
+
+	bool same_pose(LLTestCharacter* a, LLTestCharacter* b)
+	{
+		for (S32 i = 0; i < JOINT_COUNT; ++i)
+		{
+			if (memcmp(a->mJoints[i]->getWorldMatrix().mMatrix, b->mJoints[i]->getWorldMatrix().mMatrix, sizeof(F32) * 16))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+namespace tut
+{
+	struct motion_controller
+	{
+		~motion_controller()
+		{
+			LLJobScheduler::cleanupClass();
+		}
+	};
+
+	typedef test_group<motion_controller> motion_controller_test;
+	typedef motion_controller_test::object motion_controller_t;
+	motion_controller_test tut_motion_controller("LLMotionController");
+
+	// a crowd evaluated across the job scheduler poses exactly as one updated serially
+	template<> template<>
+	void motion_controller_t::test<1>()
+	{
+		LLJobScheduler::initClass(3);
+		LLFrameTimer::updateFrameTime();
+		std::vector<LLTestCharacter*> serial = make_crowd(12);
+		std::vector<LLTestCharacter*> split = make_crowd(12);
+
+		for (S32 frame = 0; frame < 30; ++frame)
+		{
+			ms_sleep(2);
+			LLFrameTimer::updateFrameTime();
+			update_crowd(serial, NULL, false);
+			update_crowd(split, LLJobScheduler::getDefault(), true);
+		}
+
+		for (U32 i = 0; i < serial.size(); ++i)
+		{
+			ensure("animated", serial[i]->getMotionController().getAnimTime() > 0.f);
+			ensure(llformat("same pose %d", i), same_pose(serial[i], split[i]));
+		}
+		delete_crowd(serial);
+		delete_crowd(split);
+	}
+
+	// stop requests made during evaluation reach the character at the end of the update
+	template<> template<>
+	void motion_controller_t::test<2>()
+	{
+		LLFrameTimer::updateFrameTime();
+		LLTestCharacter character;
+		character.startMotion(NOD_ID);
+
+		bool requested = false;
+		for (S32 frame = 0; frame < 100 && !requested; ++frame)
+		{
+			ms_sleep(5);
+			LLFrameTimer::updateFrameTime();
+			if (character.beginUpdateMotions(LLCharacter::NORMAL_UPDATE))
+			{
+				character.evaluateMotions();
+			}
+			bool before_end = !character.mStopRequests.empty();
+			character.endUpdateMotions();
+			ensure("not during evaluation", !before_end);
+			requested = !character.mStopRequests.empty();
+		}
+		ensure("stop requested", requested);
+		ensure_equals("once", character.mStopRequests.size(), (size_t)1);
+		ensure_equals("nod", character.mStopRequests[0], NOD_ID);
+	}
+
+	// keyframe data is shared safely between threads
+	template<> template<>
+	void motion_controller_t::test<3>()
+	{
+		LLJobScheduler::initClass(3);
+		const U32 COUNT = 400;
+		std::vector<LLUUID> ids(COUNT);
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ids[i].generate();
+		}
+
+		LLAtomicS32 found(0);
+		ll_parallel_for(LLJobScheduler::getDefault(), COUNT, 10, [&](U32 begin, U32 end)
+		{
+			for (U32 i = begin; i < end; ++i)
+			{
+				LLKeyframeMotion::JointMotionList* list = new LLKeyframeMotion::JointMotionList;
+				list->mDuration = (F32)i;
+				LLKeyframeDataCache::addKeyframeData(ids[i], list);
+				LLKeyframeMotion::JointMotionList* cached = LLKeyframeDataCache::getKeyframeData(ids[i]);
+				if (cached && cached->mDuration == (F32)i)
+				{
+					found++;
+				}
+			}
+		});
+		ensure_equals("all found", (S32)found, (S32)COUNT);
+
+		LLKeyframeDataCache::removeKeyframeData(ids[0]);
+		ensure("removed", LLKeyframeDataCache::getKeyframeData(ids[0]) == NULL);
+		LLKeyframeDataCache::clear();
+		ensure("cleared", LLKeyframeDataCache::getKeyframeData(ids[1]) == NULL);
+	}
+
+	// visual params driven during evaluation are updated at the end of the update
+	template<> template<>
+	void motion_controller_t::test<4>()
+	{
+		LLFrameTimer::updateFrameTime();
+		LLTestCharacter character;
+		character.startMotion(PARAM_ID);
+
+		S32 updated_frames = 0;
+		for (S32 frame = 0; frame < 20; ++frame)
+		{
+			ms_sleep(2);
+			LLFrameTimer::updateFrameTime();
+			S32 before = character.mVisualParamUpdates;
+			if (character.beginUpdateMotions(LLCharacter::NORMAL_UPDATE))
+			{
+				character.evaluateMotions();
+			}
+			ensure_equals("not during evaluation", character.mVisualParamUpdates, before);
+			character.endUpdateMotions();
+			ensure("at most once an update", character.mVisualParamUpdates - before <= 1);
+			updated_frames += character.mVisualParamUpdates - before;
+		}
+		ensure("updated", updated_frames > 0);
+
+		// and with the serial update
+		S32 before = character.mVisualParamUpdates;
+		for (S32 frame = 0; frame < 20; ++frame)
+		{
+			ms_sleep(2);
+			LLFrameTimer::updateFrameTime();
+			character.updateMotions(LLCharacter::NORMAL_UPDATE);
+		}
+		ensure("serial", character.mVisualParamUpdates > before);
+		ensure("serial at most once an update", character.mVisualParamUpdates - before <= 20);
+	}
+
+	// 80 avatars of 100 joints for 60 frames, serial against split on the scheduler
+	template<> template<>
+	void motion_controller_t::test<5>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 AVATARS = 80;
+		const S32 FRAMES = 60;
+
+		F64 times[2];
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			if (pass)
+			{
+				LLJobScheduler::initClass();
+			}
+
+			LLFrameTimer::updateFrameTime();
+			std::vector<LLTestCharacter*> crowd = make_crowd(AVATARS);
+			LLTimer timer;
+			for (S32 frame = 0; frame < FRAMES; ++frame)
+			{
+				LLFrameTimer::updateFrameTime();
+				update_crowd(crowd, LLJobScheduler::getDefault(), pass != 0);
+			}
+			times[pass] = timer.getElapsedTimeF64();
+			delete_crowd(crowd);
+		}
+
+		LL_INFOS() << llformat("LLMotionController: %d avatars of %d joints, %.2f ms a frame serial, %.2f ms split across the job scheduler (%.1fx)",
+							   AVATARS, JOINT_COUNT, times[0] * 1000.0 / FRAMES, times[1] * 1000.0 / FRAMES,
+							   times[0] / llmax(times[1], 0.000001)) << LL_ENDL;
+	}
+
+	// motions started by other motions start at the end of the update
+	template<> template<>
+	void motion_controller_t::test<6>()
+	{
+		LLFrameTimer::updateFrameTime();
+		LLTestCharacter character;
+		character.startMotion(CUE_ID);
+		ensure("cue active", character.isMotionActive(CUE_ID));
+		ensure("not started with the cue", !character.isMotionActive(NOD_ID));
+
+		ms_sleep(2);
+		LLFrameTimer::updateFrameTime();
+		if (character.beginUpdateMotions(LLCharacter::NORMAL_UPDATE))
+		{
+			character.evaluateMotions();
+		}
+		ensure("not during evaluation", !character.isMotionActive(NOD_ID));
+		character.endUpdateMotions();
+		ensure("started", character.isMotionActive(NOD_ID));
+	}
+}
@@ -27,6 +27,7 @@
 #include "linden_common.h"
 
 #include "llcriticaldamp.h"
+#include "llthread.h"
 #include <algorithm>
 
 //-----------------------------------------------------------------------------
@@ -35,6 +36,7 @@
 LLFrameTimer LLSmoothInterpolation::sInternalTimer;
 std::vector<LLSmoothInterpolation::Interpolant> LLSmoothInterpolation::sInterpolants;
 F32 LLSmoothInterpolation::sTimeDelta;
+U32 LLSmoothInterpolation::sCacheThreadID = 0;
 
 // helper functors
 struct LLSmoothInterpolation::CompareTimeConstants
@@ -69,6 +71,7 @@ LLSmoothInterpolation::LLSmoothInterpolation()
 //-----------------------------------------------------------------------------
 void LLSmoothInterpolation::updateInterpolants()
 {
+	sCacheThreadID = LLThread::currentID();
 	sTimeDelta = sInternalTimer.getElapsedTimeAndResetF32();
 
 	for (S32 i = 0; i < sInterpolants.size(); i++)
@@ -88,7 +91,10 @@ F32 LLSmoothInterpolation::getInterpolant(F32SecondsImplicit time_constant, bool
 		return 1.f;
 	}
 
-	if (use_cache)
+	// Characters are also animated on worker threads.  They calculate the
+	// interpolant instead of sharing the cache, which gives the same value
+	// for the rest of the frame.
+	if (use_cache && LLThread::currentID() == sCacheThreadID)
 	{
 		interpolant_vec_t::iterator find_it = std::lower_bound(sInterpolants.begin(), sInterpolants.end(), time_constant.value(), CompareTimeConstants());
 		if (find_it != sInterpolants.end() && find_it->mTimeScale == time_constant) 
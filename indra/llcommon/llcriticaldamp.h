@@ -66,6 +66,7 @@ protected:
 	typedef std::vector<Interpolant> interpolant_vec_t;
 	static interpolant_vec_t 	sInterpolants;
 	static F32					sTimeDelta;
+	static U32					sCacheThreadID;	// the thread calling updateInterpolants()
 };
 
 typedef LLSmoothInterpolation LLCriticalDamp;
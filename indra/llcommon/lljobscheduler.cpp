@@ -0,0 +1,548 @@
+/**
+ * @file lljobscheduler.cpp
+ * @brief Work-stealing thread pool shared by viewer subsystems.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lljobscheduler.h"
+
+#include "llfasttimer.h"
+#include "lltimer.h"
+#include "lltrace.h"
+#include "lltracethreadrecorder.h"
+
+#include <algorithm>
+
+static LLTrace::BlockTimerStatHandle FTM_JOB_RUN("Job Run");
+static LLTrace::BlockTimerStatHandle FTM_JOB_FINISH("Job Main Thread Finish");
+static LLTrace::CountStatHandle<> sJobsRun("jobsrun", "Jobs run by LLJobScheduler workers");
+static LLTrace::CountStatHandle<> sJobsStolen("jobsstolen", "Jobs taken from another LLJobScheduler worker");
+
+// Trace data is pushed to the main thread after this many jobs, or when a worker goes idle
+const U32 JOBS_PER_TRACE_PUSH = 64;
+
+//static
+LLJobScheduler* LLJobScheduler::sDefault = NULL;
+
+//============================================================================
+
+LLJob::LLJob(EPriority priority, bool finish_on_main_thread) :
+	mStatus(STATUS_PENDING),
+	mUnfinishedDependencies(1),
+	mScheduler(NULL),
+	mPriority(priority),
+	mFinishOnMainThread(finish_on_main_thread)
+{
+}
+
+LLJob::~LLJob()
+{
+}
+
+void LLJob::addDependency(const ptr_t& job)
+{
+	llassert(getStatus() == STATUS_PENDING);
+	LLJob* dependency = job.get();
+	LLMutexLock lock(&dependency->mDependentsMutex);
+	if (!dependency->isComplete())
+	{
+		mUnfinishedDependencies++;
+		dependency->mDependents.push_back(this);
+	}
+}
+
+//============================================================================
+
+class LLJobScheduler::Worker : public LLThread
+{
+public:
+	Worker(LLJobScheduler* scheduler, const std::string& name, U32 index) :
+		LLThread(name),
+		mScheduler(scheduler),
+		mIndex(index)
+	{
+	}
+
+	/*virtual*/ void run();
+
+	LLJobScheduler* mScheduler;
+	U32 mIndex;
+	JobQueue mQueues[LLJob::PRIORITY_COUNT];
+
+	static LL_THREAD_LOCAL Worker* sCurrent;
+};
+
+LL_THREAD_LOCAL LLJobScheduler::Worker* LLJobScheduler::Worker::sCurrent = NULL;
+
+// virtual
+void LLJobScheduler::Worker::run()
+{
+	sCurrent = this;
+	U32 jobs_since_push = 0;
+	while (!mScheduler->mStopping && !isQuitting())
+	{
+		LLJob* job = mScheduler->findJob(this);
+		if (job)
+		{
+			mScheduler->runJob(job);
+			if (++jobs_since_push >= JOBS_PER_TRACE_PUSH)
+			{
+				LLTrace::get_thread_recorder()->pushToParent();
+				jobs_since_push = 0;
+			}
+			continue;
+		}
+
+		if (jobs_since_push)
+		{
+			LLTrace::get_thread_recorder()->pushToParent();
+			jobs_since_push = 0;
+		}
+		mScheduler->waitForWork();
+	}
+	LLTrace::get_thread_recorder()->pushToParent();
+	sCurrent = NULL;
+}
+
+//============================================================================
+
+// MAIN THREAD
+LLJobScheduler::LLJobScheduler(const std::string& name, U32 thread_count) :
+	mName(name),
+	mQueuedCount(0),
+	mStopping(false),
+	mSleepers(0),
+	mMainThreadCount(0),
+	mMainThreadID(LLThread::currentID())
+{
+	if (thread_count == 0)
+	{
+		U32 cores = std::thread::hardware_concurrency();
+		thread_count = llmax(cores, 2U) - 1;
+	}
+
+	for (U32 i = 0; i < thread_count; i++)
+	{
+		mWorkers.push_back(new Worker(this, llformat("%s %d", mName.c_str(), i), i));
+	}
+	// start only once every worker exists, they look at each other's queues
+	for (U32 i = 0; i < thread_count; i++)
+	{
+		mWorkers[i]->start();
+	}
+	LL_INFOS() << "LLJobScheduler " << mName << " started " << thread_count << " worker threads" << LL_ENDL;
+}
+
+// MAIN THREAD
+LLJobScheduler::~LLJobScheduler()
+{
+	stop();
+}
+
+// MAIN THREAD
+void LLJobScheduler::stop()
+{
+	if (mWorkers.empty())
+	{
+		return;
+	}
+
+	mStopping = true;
+	mIdleCondition.lock();
+	mIdleCondition.broadcast();
+	mIdleCondition.unlock();
+
+	for (U32 i = 0; i < mWorkers.size(); i++)
+	{
+		mWorkers[i]->shutdown();
+	}
+	for (U32 i = 0; i < mWorkers.size(); i++)
+	{
+		for (S32 p = 0; p < LLJob::PRIORITY_COUNT; p++)
+		{
+			releaseQueue(mWorkers[i]->mQueues[p]);
+		}
+		delete mWorkers[i];
+	}
+	mWorkers.clear();
+
+	for (S32 p = 0; p < LLJob::PRIORITY_COUNT; p++)
+	{
+		releaseQueue(mSharedQueues[p]);
+	}
+
+	std::lock_guard<std::mutex> lock(mMainThreadMutex);
+	for (std::deque<LLJob*>::iterator iter = mMainThreadJobs.begin(); iter != mMainThreadJobs.end(); ++iter)
+	{
+		cancelJob(*iter);
+		(*iter)->unref();
+	}
+	mMainThreadJobs.clear();
+	mMainThreadCount = 0;
+}
+
+// Cancels the jobs of queue, so that nobody waits for them forever
+void LLJobScheduler::releaseQueue(JobQueue& queue)
+{
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	for (std::deque<LLJob*>::iterator iter = queue.mJobs.begin(); iter != queue.mJobs.end(); ++iter)
+	{
+		cancelJob(*iter);
+		(*iter)->unref();
+		mQueuedCount--;
+	}
+	queue.mJobs.clear();
+	queue.mCount = 0;
+}
+
+LLJobScheduler::Worker* LLJobScheduler::getCurrentWorker() const
+{
+	Worker* worker = Worker::sCurrent;
+	return (worker && worker->mScheduler == this) ? worker : NULL;
+}
+
+//----------------------------------------------------------------------------
+
+// Any thread
+void LLJobScheduler::submit(const LLJob::ptr_t& job)
+{
+	LLJob* jobp = job.get();
+	llassert(jobp->getStatus() == LLJob::STATUS_PENDING);
+	jobp->mScheduler = this;
+	jobp->mStatus = LLJob::STATUS_WAITING;
+	if (--jobp->mUnfinishedDependencies == 0)
+	{
+		enqueue(jobp);
+	}
+}
+
+void LLJobScheduler::enqueue(LLJob* job)
+{
+	if (mStopping)
+	{
+		// No worker is left to run it, and finish() would never be called
+		job->mStatus = LLJob::STATUS_RUNNING;
+		job->run();
+		if (job->mFinishOnMainThread)
+		{
+			job->finish();
+		}
+		completeJob(job);
+		return;
+	}
+
+	job->ref(); // released once the job has run
+	job->mStatus = LLJob::STATUS_QUEUED;
+
+	Worker* worker = getCurrentWorker();
+	JobQueue& queue = worker ? worker->mQueues[job->mPriority] : mSharedQueues[job->mPriority];
+	{
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+		queue.mJobs.push_back(job);
+		queue.mCount++;
+	}
+	mQueuedCount++;
+
+	// A worker about to sleep either sees mQueuedCount or is counted in mSleepers
+	if (mSleepers > 0)
+	{
+		mIdleCondition.lock();
+		mIdleCondition.signal();
+		mIdleCondition.unlock();
+	}
+}
+
+bool LLJobScheduler::popBack(JobQueue& queue, LLJob*& job)
+{
+	if (queue.mCount <= 0)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	if (queue.mJobs.empty())
+	{
+		return false;
+	}
+	job = queue.mJobs.back();
+	queue.mJobs.pop_back();
+	queue.mCount--;
+	mQueuedCount--;
+	return true;
+}
+
+bool LLJobScheduler::popFront(JobQueue& queue, LLJob*& job)
+{
+	if (queue.mCount <= 0)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	if (queue.mJobs.empty())
+	{
+		return false;
+	}
+	job = queue.mJobs.front();
+	queue.mJobs.pop_front();
+	queue.mCount--;
+	mQueuedCount--;
+	return true;
+}
+
+bool LLJobScheduler::remove(JobQueue& queue, LLJob* job)
+{
+	if (queue.mCount <= 0)
+	{
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	std::deque<LLJob*>::iterator iter = std::find(queue.mJobs.begin(), queue.mJobs.end(), job);
+	if (iter == queue.mJobs.end())
+	{
+		return false;
+	}
+	queue.mJobs.erase(iter);
+	queue.mCount--;
+	mQueuedCount--;
+	return true;
+}
+
+// Takes job back from whichever queue holds it
+bool LLJobScheduler::takeJob(LLJob* job)
+{
+	if (remove(mSharedQueues[job->mPriority], job))
+	{
+		return true;
+	}
+	for (U32 i = 0; i < mWorkers.size(); i++)
+	{
+		if (remove(mWorkers[i]->mQueues[job->mPriority], job))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// MAIN THREAD
+bool LLJobScheduler::takeMainThreadJob(LLJob* job)
+{
+	std::lock_guard<std::mutex> lock(mMainThreadMutex);
+	std::deque<LLJob*>::iterator iter = std::find(mMainThreadJobs.begin(), mMainThreadJobs.end(), job);
+	if (iter == mMainThreadJobs.end())
+	{
+		return false;
+	}
+	mMainThreadJobs.erase(iter);
+	mMainThreadCount--;
+	return true;
+}
+
+// worker is NULL when called from a thread outside the pool
+LLJob* LLJobScheduler::findJob(Worker* worker)
+{
+	LLJob* job = NULL;
+	U32 count = mWorkers.size();
+	for (S32 p = 0; p < LLJob::PRIORITY_COUNT; p++)
+	{
+		// newest local job first, it is the most likely to still be in cache
+		if (worker && popBack(worker->mQueues[p], job))
+		{
+			return job;
+		}
+		if (popFront(mSharedQueues[p], job))
+		{
+			return job;
+		}
+		// steal the oldest job of another worker, starting with the next one along
+		U32 start = worker ? worker->mIndex + 1 : 0;
+		for (U32 i = 0; i < count; i++)
+		{
+			Worker* victim = mWorkers[(start + i) % count];
+			if (victim != worker && popFront(victim->mQueues[p], job))
+			{
+				add(sJobsStolen, 1);
+				return job;
+			}
+		}
+	}
+	return NULL;
+}
+
+void LLJobScheduler::waitForWork()
+{
+	mIdleCondition.lock();
+	mSleepers++;
+	if (mQueuedCount <= 0 && !mStopping)
+	{
+		mIdleCondition.wait();
+	}
+	mSleepers--;
+	mIdleCondition.unlock();
+}
+
+void LLJobScheduler::runJob(LLJob* job)
+{
+	job->mStatus = LLJob::STATUS_RUNNING;
+	{
+		LL_RECORD_BLOCK_TIME(FTM_JOB_RUN);
+		job->run();
+	}
+	add(sJobsRun, 1);
+
+	if (job->mFinishOnMainThread)
+	{
+		job->mStatus = LLJob::STATUS_FINISHING;
+		std::lock_guard<std::mutex> lock(mMainThreadMutex);
+		mMainThreadJobs.push_back(job); // keeps the reference taken in enqueue()
+		mMainThreadCount++;
+		return;
+	}
+
+	completeJob(job);
+	job->unref();
+}
+
+void LLJobScheduler::completeJob(LLJob* job)
+{
+	std::vector<LLJob::ptr_t> dependents;
+	{
+		LLMutexLock lock(&job->mDependentsMutex);
+		job->mStatus = LLJob::STATUS_COMPLETE;
+		dependents.swap(job->mDependents);
+	}
+	for (std::vector<LLJob::ptr_t>::iterator iter = dependents.begin(); iter != dependents.end(); ++iter)
+	{
+		LLJob* dependent = *iter;
+		if (--dependent->mUnfinishedDependencies == 0)
+		{
+			// dependencies are queued on the scheduler they were submitted to
+			dependent->mScheduler->enqueue(dependent);
+		}
+	}
+}
+
+void LLJobScheduler::cancelJob(LLJob* job)
+{
+	std::vector<LLJob::ptr_t> dependents;
+	{
+		LLMutexLock lock(&job->mDependentsMutex);
+		job->mStatus = LLJob::STATUS_CANCELLED;
+		dependents.swap(job->mDependents);
+	}
+	for (std::vector<LLJob::ptr_t>::iterator iter = dependents.begin(); iter != dependents.end(); ++iter)
+	{
+		// still waiting for this job, so it can never be queued
+		cancelJob(*iter);
+	}
+}
+
+// MAIN THREAD
+S32 LLJobScheduler::updateMainThread(F32 max_time_ms)
+{
+	if (mMainThreadCount <= 0)
+	{
+		return 0;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_JOB_FINISH);
+	LLTimer timer;
+	F32 max_time = max_time_ms * .001f;
+	while (1)
+	{
+		LLJob* job = NULL;
+		{
+			std::lock_guard<std::mutex> lock(mMainThreadMutex);
+			if (mMainThreadJobs.empty())
+			{
+				break;
+			}
+			job = mMainThreadJobs.front();
+			mMainThreadJobs.pop_front();
+			mMainThreadCount--;
+		}
+		job->finish();
+		completeJob(job);
+		job->unref();
+
+		if (max_time > 0.f && timer.getElapsedTimeF32() > max_time)
+		{
+			break;
+		}
+	}
+	return mMainThreadCount;
+}
+
+void LLJobScheduler::waitFor(const LLJob::ptr_t& job)
+{
+	// Helping with any other job could start a sound or mesh decode in the
+	// middle of a frame, so only the job waited for is run here
+	bool main_thread = LLThread::currentID() == mMainThreadID;
+	LLJob* jobp = job.get();
+	while (!jobp->isComplete() && !jobp->isCancelled())
+	{
+		LLJob::EStatus status = jobp->getStatus();
+		if (status == LLJob::STATUS_QUEUED && takeJob(jobp))
+		{
+			runJob(jobp);
+		}
+		else if (main_thread && status == LLJob::STATUS_FINISHING && takeMainThreadJob(jobp))
+		{
+			LL_RECORD_BLOCK_TIME(FTM_JOB_FINISH);
+			jobp->finish();
+			completeJob(jobp);
+			jobp->unref();
+		}
+		else
+		{
+			if (main_thread && status == LLJob::STATUS_WAITING)
+			{
+				// a dependency may be waiting for its finish()
+				updateMainThread();
+			}
+			LLThread::yield();
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+
+//static
+void LLJobScheduler::initClass(U32 thread_count)
+{
+	llassert(sDefault == NULL);
+	sDefault = new LLJobScheduler("Job Worker", thread_count);
+}
+
+//static
+void LLJobScheduler::cleanupClass()
+{
+	delete sDefault;
+	sDefault = NULL;
+}
+
+//static
+S32 LLJobScheduler::updateClass(F32 max_time_ms)
+{
+	return sDefault ? sDefault->updateMainThread(max_time_ms) : 0;
+}
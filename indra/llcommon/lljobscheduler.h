@@ -0,0 +1,265 @@
+/**
+ * @file lljobscheduler.h
+ * @brief Work-stealing thread pool shared by viewer subsystems.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLJOBSCHEDULER_H
+#define LL_LLJOBSCHEDULER_H
+
+#include <deque>
+#include <vector>
+
+#include "llatomic.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "llthread.h"
+
+class LLJobScheduler;
+
+//============================================================================
+// A unit of work for LLJobScheduler.
+//
+// run() is called on a worker thread. If the job was created with
+// finish_on_main_thread, finish() is then called from
+// LLJobScheduler::updateMainThread(). A job is complete once both have
+// returned, and only then are the jobs that depend on it queued.
+
+class LL_COMMON_API LLJob : public LLThreadSafeRefCount
+{
+	friend class LLJobScheduler;
+
+public:
+	typedef LLPointer<LLJob> ptr_t;
+
+	enum EPriority
+	{
+		PRIORITY_HIGH = 0,
+		PRIORITY_NORMAL,
+		PRIORITY_LOW,
+		PRIORITY_COUNT
+	};
+
+	enum EStatus
+	{
+		STATUS_PENDING = 0,	// not submitted yet
+		STATUS_WAITING,		// submitted, waiting for dependencies
+		STATUS_QUEUED,
+		STATUS_RUNNING,
+		STATUS_FINISHING,	// waiting for finish() on the main thread
+		STATUS_COMPLETE,
+		STATUS_CANCELLED	// dropped by LLJobScheduler::stop(), never completes
+	};
+
+	LLJob(EPriority priority = PRIORITY_NORMAL, bool finish_on_main_thread = false);
+
+	// This job will not start before job is complete.
+	// Must be called before this job is submitted.
+	void addDependency(const ptr_t& job);
+
+	EStatus getStatus() const { return (EStatus)mStatus.CurrentValue(); }
+	bool isComplete() const { return getStatus() == STATUS_COMPLETE; }
+	bool isCancelled() const { return getStatus() == STATUS_CANCELLED; }
+	EPriority getPriority() const { return mPriority; }
+
+protected:
+	virtual ~LLJob();
+
+	virtual void run() = 0;		// worker thread
+	virtual void finish() {}	// main thread, only if finish_on_main_thread
+
+private:
+	LLAtomicS32 mStatus;
+	LLAtomicS32 mUnfinishedDependencies; // holds one extra count until submitted
+	LLMutex mDependentsMutex;
+	std::vector<ptr_t> mDependents;
+	LLJobScheduler* mScheduler;
+	EPriority mPriority;
+	bool mFinishOnMainThread;
+};
+
+//============================================================================
+// Thread pool where each worker keeps its own job queues and steals from the
+// other workers when it runs dry. Jobs are picked highest priority first;
+// within a priority a worker runs its own newest job, and steals the oldest.
+//
+// Jobs submitted from a worker go to that worker's queues, everything else
+// goes to a shared queue that all workers pull from.
+
+class LL_COMMON_API LLJobScheduler
+{
+public:
+	LLJobScheduler(const std::string& name, U32 thread_count = 0); // 0: one per core, less the main thread
+	~LLJobScheduler();
+
+	void submit(const LLJob::ptr_t& job);
+
+	// Runs finish() for jobs waiting on the main thread. Returns the number left.
+	S32 updateMainThread(F32 max_time_ms = 0.f);
+
+	// Returns once job is complete or cancelled. A job still queued is taken
+	// back and run on the calling thread, and from the main thread so is its
+	// finish(). No other job is run here, so waiting never starts unrelated
+	// work. Only while job waits for dependencies does the main thread run
+	// the finish() continuations they may need.
+	void waitFor(const LLJob::ptr_t& job);
+
+	// Stops the workers. Jobs still queued or waiting for finish() are
+	// cancelled, and so are the jobs depending on them. Jobs submitted
+	// afterwards run at once on the submitting thread, finish() included.
+	void stop();
+
+	U32 getThreadCount() const { return mWorkers.size(); }
+	S32 getPending() const { return mQueuedCount.CurrentValue() + mMainThreadCount.CurrentValue(); }
+
+	// Default scheduler for the viewer
+	static void initClass(U32 thread_count = 0);
+	static void cleanupClass();
+	static S32 updateClass(F32 max_time_ms);
+	static LLJobScheduler* getDefault() { return sDefault; }
+
+private:
+	class Worker;
+
+	struct JobQueue
+	{
+		JobQueue() : mCount(0) {}
+
+		std::mutex mMutex;
+		std::deque<LLJob*> mJobs;
+		LLAtomicS32 mCount; // lets readers skip empty queues without locking
+	};
+
+	// No copy constructor or copy assignment
+	LLJobScheduler(const LLJobScheduler&);
+	LLJobScheduler& operator=(const LLJobScheduler&);
+
+	void enqueue(LLJob* job);
+	bool takeJob(LLJob* job);
+	bool takeMainThreadJob(LLJob* job);
+	LLJob* findJob(Worker* worker);
+	bool popBack(JobQueue& queue, LLJob*& job);
+	bool popFront(JobQueue& queue, LLJob*& job);
+	bool remove(JobQueue& queue, LLJob* job);
+	void runJob(LLJob* job);
+	void completeJob(LLJob* job);
+	void cancelJob(LLJob* job);
+	void waitForWork();
+	void releaseQueue(JobQueue& queue);
+	Worker* getCurrentWorker() const;
+
+private:
+	std::string mName;
+	std::vector<Worker*> mWorkers;
+	JobQueue mSharedQueues[LLJob::PRIORITY_COUNT];
+	LLAtomicS32 mQueuedCount;
+	LLAtomicBool mStopping;
+
+	LLCondition mIdleCondition;
+	LLAtomicS32 mSleepers;
+
+	std::mutex mMainThreadMutex;
+	std::deque<LLJob*> mMainThreadJobs;
+	LLAtomicS32 mMainThreadCount;
+	U32 mMainThreadID;
+
+	static LLJobScheduler* sDefault;
+};
+
+//============================================================================
+// Calls func(begin, end) over [0, count), split in up to one range per worker
+// plus one, none shorter than min_range. The calling thread runs the first
+// range and then waits for the others, so func may use the caller's stack.
+// Everything runs on the calling thread when scheduler is NULL or count is
+// too small to split, and so do the ranges cancelled by a scheduler stopping
+// meanwhile: every index is covered once ll_parallel_for returns.
+
+template<class FUNC>
+class LLRangeJob : public LLJob
+{
+public:
+	LLRangeJob(const FUNC& func, U32 begin, U32 end)
+	:	LLJob(PRIORITY_HIGH),
+		mFunc(func),
+		mBegin(begin),
+		mEnd(end)
+	{
+	}
+
+	U32 getBegin() const { return mBegin; }
+	U32 getEnd() const { return mEnd; }
+
+protected:
+	/*virtual*/ void run()
+	{
+		mFunc(mBegin, mEnd);
+	}
+
+private:
+	const FUNC& mFunc;
+	U32 mBegin;
+	U32 mEnd;
+};
+
+template<class FUNC>
+void ll_parallel_for(LLJobScheduler* scheduler, U32 count, U32 min_range, const FUNC& func)
+{
+	U32 range_count = 1;
+	if (scheduler && min_range > 0)
+	{
+		range_count = llmin(scheduler->getThreadCount() + 1, count / min_range);
+	}
+
+	if (range_count <= 1)
+	{
+		if (count > 0)
+		{
+			func(0, count);
+		}
+		return;
+	}
+
+	const U32 range = (count + range_count - 1) / range_count;
+	std::vector<LLPointer<LLRangeJob<FUNC> > > jobs;
+	jobs.reserve(range_count - 1);
+	for (U32 begin = range; begin < count; begin += range)
+	{
+		jobs.push_back(new LLRangeJob<FUNC>(func, begin, llmin(begin + range, count)));
+		scheduler->submit(jobs.back().get());
+	}
+
+	func(0, range);
+
+	for (U32 i = 0; i < jobs.size(); ++i)
+	{
+		LLJob::ptr_t job = jobs[i].get();
+		scheduler->waitFor(job);
+		if (job->isCancelled())
+		{
+			// never started, the caller reads the results as soon as we return
+			func(jobs[i]->getBegin(), jobs[i]->getEnd());
+		}
+	}
+}
+
+#endif // LL_LLJOBSCHEDULER_H
@@ -26,20 +26,57 @@
 #include "linden_common.h"
 #include "llqueuedthread.h"
 
+#include "lljobscheduler.h"
 #include "llstl.h"
 #include "lltimer.h"	// ms_sleep()
 #include "lltracethreadrecorder.h"
 
+// Longest a single PumpJob keeps a scheduler worker busy
+const F32 PUMP_TIME_SLICE = 0.005f;
+
+//============================================================================
+
+class LLQueuedThread::PumpJob : public LLJob
+{
+public:
+	PumpJob(LLQueuedThread* thread, EPriority priority) :
+		LLJob(priority),
+		mThread(thread)
+	{
+	}
+
+	/*virtual*/ void run()
+	{
+		mThread->pumpRequests();
+	}
+
+private:
+	LLQueuedThread* mThread;
+};
+
 //============================================================================
 
 // MAIN THREAD
 LLQueuedThread::LLQueuedThread(const std::string& name, bool threaded, bool should_pause) :
 	LLThread(name),
 	mThreaded(threaded),
+	mStarted(FALSE),
 	mIdleThread(TRUE),
-	mNextHandle(0),
-	mStarted(FALSE)
+	mPendingCount(0),
+	mCommandStub(Command::STUB, nullHandle()),
+	mCommandHead(&mCommandStub),
+	mCommandTail(&mCommandStub),
+	mSlotChunkCount(0),
+	mFreeSlots(SLOT_NONE),
+	mScheduler(NULL),
+	mPumpScheduled(false),
+	mPumpJobs(0)
 {
+	for (U32 i = 0; i < SLOT_MAX_CHUNKS; i++)
+	{
+		mSlotChunks[i] = NULL;
+	}
+
 	if (mThreaded)
 	{
 		if(should_pause)
@@ -59,6 +96,13 @@ LLQueuedThread::~LLQueuedThread()
 		endThread();
 	}
 	shutdown();
+
+	U32 chunk_count = mSlotChunkCount;
+	for (U32 i = 0; i < chunk_count; i++)
+	{
+		delete[] mSlotChunks[i].load();
+		mSlotChunks[i] = NULL;
+	}
 	// ~LLThread() will be called here
 }
 
@@ -86,18 +130,42 @@ void LLQueuedThread::shutdown()
 	}
 	else
 	{
+		if (mScheduler)
+		{
+			// a running pump aborts the remaining requests now that we are quitting
+			while (mPumpJobs > 0 && mScheduler->getThreadCount() > 0)
+			{
+				LLThread::yield();
+			}
+		}
 		mStatus = STOPPED;
 	}
 
-	QueuedRequest* req;
+	// Requests referenced by unconsumed commands are still in the handle table
+	Command* cmd;
+	while ( (cmd = popCommand()) )
+	{
+		delete cmd;
+	}
+	mRequestQueue.clear();
+	mPendingCount = 0;
+
 	S32 active_count = 0;
-	while ( (req = (QueuedRequest*)mRequestHash.pop_element()) )
+	U32 chunk_count = mSlotChunkCount;
+	for (U32 i = 0; i < chunk_count * SLOT_CHUNK_SIZE; i++)
 	{
+		RequestSlot* slot = getSlot(i);
+		QueuedRequest* req = releaseRequest(slot->mHandle);
+		if (!req)
+		{
+			continue;
+		}
 		if (req->getStatus() == STATUS_QUEUED || req->getStatus() == STATUS_INPROGRESS)
 		{
 			++active_count;
 			req->setStatus(STATUS_ABORTED); // avoid assert in deleteRequest
 		}
+		req->mQueueIndex = -1;
 		req->deleteRequest();
 	}
 	if (active_count)
@@ -138,6 +206,14 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 		unpause();
 	}
 	}
+	else if (mScheduler)
+	{
+		pending = getPending();
+		if (pending > 0)
+		{
+			schedulePump();
+		}
+	}
 	else
 	{
 		while (pending > 0)
@@ -153,7 +229,11 @@ S32 LLQueuedThread::updateQueue(F32 max_time_ms)
 void LLQueuedThread::incQueue()
 {
 	// Something has been added to the queue
-	if (!isPaused())
+	if (mScheduler)
+	{
+		schedulePump();
+	}
+	else if (!isPaused())
 	{
 		if (mThreaded)
 		{
@@ -166,11 +246,7 @@ void LLQueuedThread::incQueue()
 // May be called from any thread
 S32 LLQueuedThread::getPending()
 {
-	S32 res;
-	lockData();
-	res = mRequestQueue.size();
-	unlockData();
-	return res;
+	return mPendingCount;
 }
 
 // MAIN thread
@@ -195,48 +271,55 @@ void LLQueuedThread::waitOnPending()
 // MAIN thread
 void LLQueuedThread::printQueueStats()
 {
-	lockData();
-	if (!mRequestQueue.empty())
+	// The queue itself belongs to the worker, only the count is safe to read here
+	S32 pending = getPending();
+	if (pending > 0)
 	{
-		QueuedRequest *req = *mRequestQueue.begin();
-		LL_INFOS() << llformat("Pending Requests:%d Current status:%d", mRequestQueue.size(), req->getStatus()) << LL_ENDL;
+		LL_INFOS() << llformat("Pending Requests:%d Thread idle:%d", pending, mIdleThread ? 1 : 0) << LL_ENDL;
 	}
 	else
 	{
 		LL_INFOS() << "Queued Thread Idle" << LL_ENDL;
 	}
-	unlockData();
 }
 
-// MAIN thread
+// Any thread
 LLQueuedThread::handle_t LLQueuedThread::generateHandle()
 {
-	lockData();
-	while ((mNextHandle == nullHandle()) || (mRequestHash.find(mNextHandle)))
+	U32 index = allocSlot();
+	if (index == SLOT_NONE)
 	{
-		mNextHandle++;
+		LL_WARNS() << "LLQueuedThread (" << mName << ") out of request handles" << LL_ENDL;
+		return nullHandle();
 	}
-	const LLQueuedThread::handle_t res = mNextHandle++;
-	unlockData();
-	return res;
+	// The slot stays reserved, but not findable, until addRequest() publishes it
+	return (getSlot(index)->mGeneration << SLOT_INDEX_BITS) | index;
 }
 
-// MAIN thread
+// Any thread
 bool LLQueuedThread::addRequest(QueuedRequest* req)
 {
+	const handle_t handle = req->getHashKey();
+	RequestSlot* slot = getSlot(handle);
+	if (!slot)
+	{
+		return false;
+	}
 	if (mStatus == QUITTING)
 	{
+		// give back the slot reserved by generateHandle()
+		freeSlot(handle & SLOT_INDEX_MASK);
 		return false;
 	}
-	
-	lockData();
+
 	req->setStatus(STATUS_QUEUED);
-	mRequestQueue.insert(req);
-	mRequestHash.insert(req);
+	slot->mRequest = req;
+	slot->mHandle = handle;
+	mPendingCount++;
+	pushCommand(new Command(Command::ADD_REQUEST, handle, 0, req));
 #if _DEBUG
 // 	LL_INFOS() << llformat("LLQueuedThread::Added req [%08d]",handle) << LL_ENDL;
 #endif
-	unlockData();
 
 	incQueue();
 
@@ -253,25 +336,30 @@ bool LLQueuedThread::waitForResult(LLQueuedThread::handle_t handle, bool auto_co
 	while(!done)
 	{
 		update(0); // unpauses
-		lockData();
-		QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-		if (!req)
+		RequestSlot* slot = pinSlot(handle);
+		if (!slot)
 		{
 			done = true; // request does not exist
 		}
-		else if (req->getStatus() == STATUS_COMPLETE)
+		else
 		{
-			res = true;
-			if (auto_complete)
+			bool complete = slot->mRequest.load()->getStatus() == STATUS_COMPLETE;
+			unpinSlot(slot);
+			if (complete)
 			{
-				mRequestHash.erase(handle);
-				req->deleteRequest();
-// 				check();
+				res = true;
+				if (auto_complete)
+				{
+					QueuedRequest* req = releaseRequest(handle);
+					if (req)
+					{
+						req->deleteRequest();
+					}
+				}
+				done = true;
 			}
-			done = true;
 		}
-		unlockData();
-		
+
 		if (!done && mThreaded)
 		{
 			yield();
@@ -284,192 +372,501 @@ bool LLQueuedThread::waitForResult(LLQueuedThread::handle_t handle, bool auto_co
 	return res;
 }
 
-// MAIN thread
+// Any thread
+// The returned request may be deleted by the worker if FLAG_AUTO_COMPLETE is set.
 LLQueuedThread::QueuedRequest* LLQueuedThread::getRequest(handle_t handle)
 {
-	if (handle == nullHandle())
+	QueuedRequest* res = NULL;
+	RequestSlot* slot = pinSlot(handle);
+	if (slot)
 	{
-		return 0;
+		res = slot->mRequest;
+		unpinSlot(slot);
 	}
-	lockData();
-	QueuedRequest* res = (QueuedRequest*)mRequestHash.find(handle);
-	unlockData();
 	return res;
 }
 
 LLQueuedThread::status_t LLQueuedThread::getRequestStatus(handle_t handle)
 {
 	status_t res = STATUS_EXPIRED;
-	lockData();
-	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-	if (req)
+	RequestSlot* slot = pinSlot(handle);
+	if (slot)
 	{
-		res = req->getStatus();
+		res = slot->mRequest.load()->getStatus();
+		unpinSlot(slot);
 	}
-	unlockData();
 	return res;
 }
 
 void LLQueuedThread::abortRequest(handle_t handle, bool autocomplete)
 {
-	lockData();
-	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-	if (req)
+	RequestSlot* slot = pinSlot(handle);
+	if (slot)
 	{
-		req->setFlags(FLAG_ABORT | (autocomplete ? FLAG_AUTO_COMPLETE : 0));
+		slot->mRequest.load()->setFlags(FLAG_ABORT | (autocomplete ? FLAG_AUTO_COMPLETE : 0));
+		unpinSlot(slot);
 	}
-	unlockData();
 }
 
 // MAIN thread
 void LLQueuedThread::setFlags(handle_t handle, U32 flags)
 {
-	lockData();
-	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-	if (req)
+	RequestSlot* slot = pinSlot(handle);
+	if (slot)
 	{
-		req->setFlags(flags);
+		slot->mRequest.load()->setFlags(flags);
+		unpinSlot(slot);
 	}
-	unlockData();
 }
 
+// Any thread
+// The new priority takes effect when the worker next drains its commands.
 void LLQueuedThread::setPriority(handle_t handle, U32 priority)
 {
-	lockData();
-	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-	if (req)
+	RequestSlot* slot = getSlot(handle);
+	if (slot && handle != nullHandle() && slot->mHandle == handle)
 	{
-		if(req->getStatus() == STATUS_INPROGRESS)
-		{
-			// not in list
-			req->setPriority(priority);
-		}
-		else if(req->getStatus() == STATUS_QUEUED)
-		{
-			// remove from list then re-insert
-			llverify(mRequestQueue.erase(req) == 1);
-			req->setPriority(priority);
-			mRequestQueue.insert(req);
-		}
+		pushCommand(new Command(Command::SET_PRIORITY, handle, priority));
 	}
-	unlockData();
 }
 
 bool LLQueuedThread::completeRequest(handle_t handle)
 {
-	bool res = false;
-	lockData();
-	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
-	if (req)
+	RequestSlot* slot = pinSlot(handle);
+	if (!slot)
 	{
-		llassert_always(req->getStatus() != STATUS_QUEUED);
-		llassert_always(req->getStatus() != STATUS_INPROGRESS);
+		return false;
+	}
+	QueuedRequest* req = slot->mRequest;
+	llassert_always(req->getStatus() != STATUS_QUEUED);
+	llassert_always(req->getStatus() != STATUS_INPROGRESS);
+	unpinSlot(slot);
 #if _DEBUG
-// 		LL_INFOS() << llformat("LLQueuedThread::Completed req [%08d]",handle) << LL_ENDL;
+// 	LL_INFOS() << llformat("LLQueuedThread::Completed req [%08d]",handle) << LL_ENDL;
 #endif
-		mRequestHash.erase(handle);
-		req->deleteRequest();
-// 		check();
-		res = true;
+	// the worker may have auto-completed it in the meantime
+	req = releaseRequest(handle);
+	if (!req)
+	{
+		return false;
 	}
-	unlockData();
-	return res;
+	req->deleteRequest();
+	return true;
 }
 
+// WORKER thread only: validates the priority heap
 bool LLQueuedThread::check()
 {
-#if 0 // not a reliable check once mNextHandle wraps, just for quick and dirty debugging
-	for (int i=0; i<REQUEST_HASH_SIZE; i++)
+	for (S32 i = 0; i < (S32)mRequestQueue.size(); i++)
+	{
+		QueuedRequest* req = mRequestQueue[i];
+		if (req->mQueueIndex != i)
+		{
+			LL_ERRS() << "Queue index error" << LL_ENDL;
+			return false;
+		}
+		if (i > 0 && queued_request_less()(req, mRequestQueue[(i - 1) / 2]))
+		{
+			LL_ERRS() << "Queue order error" << LL_ENDL;
+			return false;
+		}
+	}
+	return true;
+}
+
+//============================================================================
+// Command list: intrusive multi-producer / single-consumer queue.
+// Producers only exchange mCommandHead; the worker owns mCommandTail.
+
+// Any thread
+void LLQueuedThread::pushCommand(Command* cmd)
+{
+	cmd->mNext = NULL;
+	Command* prev = mCommandHead.exchange(cmd);
+	prev->mNext = cmd;
+}
+
+// WORKER thread
+// Returns NULL when the list is empty, or when a producer is between the two
+// steps of pushCommand(); the command will be seen on the next call.
+LLQueuedThread::Command* LLQueuedThread::popCommand()
+{
+	Command* tail = mCommandTail;
+	Command* next = tail->mNext;
+	if (tail == &mCommandStub)
 	{
-		LLSimpleHashEntry<handle_t>* entry = mRequestHash.get_element_at_index(i);
-		while (entry)
+		if (!next)
 		{
-			if (entry->getHashKey() > mNextHandle)
+			return NULL;
+		}
+		mCommandTail = next;
+		tail = next;
+		next = next->mNext;
+	}
+	if (next)
+	{
+		mCommandTail = next;
+		return tail;
+	}
+	if (tail != mCommandHead.load())
+	{
+		return NULL;
+	}
+	pushCommand(&mCommandStub);
+	next = tail->mNext;
+	if (next)
+	{
+		mCommandTail = next;
+		return tail;
+	}
+	return NULL;
+}
+
+// WORKER thread
+void LLQueuedThread::processCommands()
+{
+	Command* cmd;
+	while ( (cmd = popCommand()) )
+	{
+		if (cmd->mType == Command::ADD_REQUEST)
+		{
+			queuePush(cmd->mRequest);
+		}
+		else if (cmd->mType == Command::SET_PRIORITY)
+		{
+			RequestSlot* slot = pinSlot(cmd->mHandle);
+			if (slot)
 			{
-				LL_ERRS() << "Hash Error" << LL_ENDL;
-				return false;
+				QueuedRequest* req = slot->mRequest;
+				if (req->mQueueIndex >= 0)
+				{
+					req->setPriority(cmd->mValue);
+					queueUpdate(req);
+				}
+				else if (req->getStatus() == STATUS_QUEUED)
+				{
+					// added from another thread, its ADD_REQUEST has not been consumed yet
+					req->setPriority(cmd->mValue);
+				}
+				unpinSlot(slot);
 			}
-			entry = entry->getNextEntry();
 		}
+		delete cmd;
 	}
-#endif
-	return true;
-}		
-	
+}
+
+//============================================================================
+// Priority heap, owned by the worker. Each request records its index so that
+// priority changes are O(log N).
+
+void LLQueuedThread::queueSet(S32 index, QueuedRequest* req)
+{
+	mRequestQueue[index] = req;
+	req->mQueueIndex = index;
+}
+
+void LLQueuedThread::queuePush(QueuedRequest* req)
+{
+	mRequestQueue.push_back(req);
+	queueSiftUp(mRequestQueue.size() - 1);
+}
+
+LLQueuedThread::QueuedRequest* LLQueuedThread::queuePop()
+{
+	if (mRequestQueue.empty())
+	{
+		return NULL;
+	}
+	QueuedRequest* req = mRequestQueue.front();
+	QueuedRequest* last = mRequestQueue.back();
+	mRequestQueue.pop_back();
+	if (!mRequestQueue.empty())
+	{
+		queueSet(0, last);
+		queueSiftDown(0);
+	}
+	req->mQueueIndex = -1;
+	return req;
+}
+
+void LLQueuedThread::queueUpdate(QueuedRequest* req)
+{
+	queueSiftUp(req->mQueueIndex);
+	queueSiftDown(req->mQueueIndex);
+}
+
+void LLQueuedThread::queueSiftUp(S32 index)
+{
+	QueuedRequest* req = mRequestQueue[index];
+	while (index > 0)
+	{
+		S32 parent = (index - 1) / 2;
+		if (!queued_request_less()(req, mRequestQueue[parent]))
+		{
+			break;
+		}
+		queueSet(index, mRequestQueue[parent]);
+		index = parent;
+	}
+	queueSet(index, req);
+}
+
+void LLQueuedThread::queueSiftDown(S32 index)
+{
+	QueuedRequest* req = mRequestQueue[index];
+	S32 count = mRequestQueue.size();
+	while (1)
+	{
+		S32 child = index * 2 + 1;
+		if (child >= count)
+		{
+			break;
+		}
+		if (child + 1 < count && queued_request_less()(mRequestQueue[child + 1], mRequestQueue[child]))
+		{
+			child++;
+		}
+		if (!queued_request_less()(mRequestQueue[child], req))
+		{
+			break;
+		}
+		queueSet(index, mRequestQueue[child]);
+		index = child;
+	}
+	queueSet(index, req);
+}
+
+//============================================================================
+// Handle table. Slots are allocated in chunks that are never freed before
+// the thread is destroyed, so a slot pointer is always safe to read; the
+// request it points to is only safe to use while the slot is pinned.
+
+LLQueuedThread::RequestSlot* LLQueuedThread::getSlot(handle_t handle) const
+{
+	U32 index = handle & SLOT_INDEX_MASK;
+	RequestSlot* chunk = mSlotChunks[index >> SLOT_CHUNK_BITS];
+	return chunk ? chunk + (index & (SLOT_CHUNK_SIZE - 1)) : NULL;
+}
+
+// Returns the slot with its pin count raised if handle is live, NULL otherwise.
+LLQueuedThread::RequestSlot* LLQueuedThread::pinSlot(handle_t handle) const
+{
+	RequestSlot* slot = getSlot(handle);
+	if (!slot || handle == nullHandle())
+	{
+		return NULL;
+	}
+	slot->mPins++;
+	if (slot->mHandle != handle)
+	{
+		slot->mPins--;
+		return NULL;
+	}
+	return slot;
+}
+
+void LLQueuedThread::unpinSlot(RequestSlot* slot) const
+{
+	slot->mPins--;
+}
+
+U32 LLQueuedThread::allocSlot()
+{
+	while (1)
+	{
+		U64 head = mFreeSlots;
+		U32 index = (U32)head;
+		if (index != SLOT_NONE)
+		{
+			// the tag in the upper half makes a stale mNextFree read fail the exchange
+			U64 next = (((head >> 32) + 1) << 32) | getSlot(index)->mNextFree;
+			if (mFreeSlots.compare_exchange_weak(head, next))
+			{
+				return index;
+			}
+			continue;
+		}
+
+		LLMutexLock lock(&mSlotGrowMutex);
+		if ((U32)mFreeSlots.load() != SLOT_NONE)
+		{
+			continue; // another thread grew the table
+		}
+		U32 chunk = mSlotChunkCount;
+		if (chunk >= SLOT_MAX_CHUNKS)
+		{
+			return SLOT_NONE;
+		}
+		mSlotChunks[chunk] = new RequestSlot[SLOT_CHUNK_SIZE];
+		mSlotChunkCount = chunk + 1;
+		// keep the first slot, hand the rest to the free list
+		index = chunk << SLOT_CHUNK_BITS;
+		for (U32 i = SLOT_CHUNK_SIZE - 1; i > 0; i--)
+		{
+			freeSlot(index + i);
+		}
+		return index;
+	}
+}
+
+void LLQueuedThread::freeSlot(U32 index)
+{
+	RequestSlot* slot = getSlot(index);
+	slot->mGeneration = (slot->mGeneration % SLOT_GENERATION_MASK) + 1; // never 0, so handles are never null
+	U64 head = mFreeSlots;
+	do
+	{
+		slot->mNextFree = (U32)head;
+	}
+	while (!mFreeSlots.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | index));
+}
+
+// Unpublishes handle and returns its request, or NULL if another thread got
+// there first. The caller owns the request afterwards.
+LLQueuedThread::QueuedRequest* LLQueuedThread::releaseRequest(handle_t handle)
+{
+	RequestSlot* slot = getSlot(handle);
+	handle_t expected = handle;
+	if (!slot || handle == nullHandle() || !slot->mHandle.compare_exchange_strong(expected, nullHandle()))
+	{
+		return NULL;
+	}
+	// wait for threads that validated the handle before it was cleared
+	while (slot->mPins != 0)
+	{
+		LLThread::yield();
+	}
+	QueuedRequest* req = slot->mRequest.exchange(NULL);
+	freeSlot(handle & SLOT_INDEX_MASK);
+	return req;
+}
+
+//============================================================================
+// Job scheduler support
+
+// MAIN thread
+void LLQueuedThread::runOnScheduler(LLJobScheduler* scheduler)
+{
+	llassert(!mThreaded);
+	llassert(getPending() == 0);
+	mScheduler = scheduler;
+	if (!mStarted)
+	{
+		startThread();
+		mStarted = TRUE;
+	}
+	// lets shutdown() move us to QUITTING so that queued requests get aborted
+	mStatus = RUNNING;
+}
+
+// Any thread
+void LLQueuedThread::schedulePump(bool requeue)
+{
+	if (!mPumpScheduled.exchange(true))
+	{
+		mPumpJobs++;
+		mScheduler->submit(new PumpJob(this, requeue ? LLJob::PRIORITY_LOW : LLJob::PRIORITY_NORMAL));
+	}
+}
+
+// Scheduler worker thread. Only one pump runs at a time, so the request
+// queue still has a single consumer.
+void LLQueuedThread::pumpRequests()
+{
+	// one pass over the queue at most, so incomplete requests do not spin here
+	S32 passes = mPendingCount;
+	LLTimer timer;
+	while (passes-- > 0 && timer.getElapsedTimeF32() < PUMP_TIME_SLICE)
+	{
+		if (processNextRequest() == 0)
+		{
+			break;
+		}
+	}
+
+	mPumpScheduled = false;
+	// requests added while the flag was set did not schedule a pump of their own
+	if (mPendingCount > 0 && !isQuitting())
+	{
+		schedulePump(true);
+	}
+	mPumpJobs--; // last access to this, shutdown() waits for it
+}
+
 //============================================================================
 // Runs on its OWN thread
 
+// Pins the slot so that completeRequest() on another thread waits for finishRequest().
+void LLQueuedThread::retireRequest(QueuedRequest* req, bool completed)
+{
+	const handle_t handle = req->getHashKey();
+	RequestSlot* slot = pinSlot(handle);
+	req->setStatus(completed ? STATUS_COMPLETE : STATUS_ABORTED);
+	req->finishRequest(completed);
+	bool auto_complete = (req->getFlags() & FLAG_AUTO_COMPLETE) != 0;
+	if (slot)
+	{
+		unpinSlot(slot);
+	}
+	if (auto_complete)
+	{
+		req = releaseRequest(handle);
+		if (req)
+		{
+			req->deleteRequest();
+		}
+	}
+}
+
 S32 LLQueuedThread::processNextRequest()
 {
+	processCommands();
+
 	QueuedRequest *req;
 	// Get next request from pool
-	lockData();
-	
 	while(1)
 	{
-		req = NULL;
-		if (mRequestQueue.empty())
+		req = queuePop();
+		if (!req)
 		{
 			break;
 		}
-		req = *mRequestQueue.begin();
-		mRequestQueue.erase(mRequestQueue.begin());
+		mPendingCount--;
 		if ((req->getFlags() & FLAG_ABORT) || (mStatus == QUITTING))
 		{
-			req->setStatus(STATUS_ABORTED);
-			req->finishRequest(false);
-			if (req->getFlags() & FLAG_AUTO_COMPLETE)
-			{
-				mRequestHash.erase(req);
-				req->deleteRequest();
-// 				check();
-			}
+			retireRequest(req, false);
 			continue;
 		}
 		llassert_always(req->getStatus() == STATUS_QUEUED);
 		break;
 	}
-	U32 start_priority = 0 ;
-	if (req)
-	{
-		req->setStatus(STATUS_INPROGRESS);
-		start_priority = req->getPriority();
-	}
-	unlockData();
 
 	// This is the only place we will call req->setStatus() after
 	// it has initially been seet to STATUS_QUEUED, so it is
 	// safe to access req.
 	if (req)
 	{
-		// process request		
+		req->setStatus(STATUS_INPROGRESS);
+		U32 start_priority = req->getPriority();
+
+		// process request
 		bool complete = req->processRequest();
 
 		if (complete)
 		{
-			lockData();
-			req->setStatus(STATUS_COMPLETE);
-			req->finishRequest(true);
-			if (req->getFlags() & FLAG_AUTO_COMPLETE)
-			{
-				mRequestHash.erase(req);
-				req->deleteRequest();
-// 				check();
-			}
-			unlockData();
+			retireRequest(req, true);
 		}
 		else
 		{
-			lockData();
 			req->setStatus(STATUS_QUEUED);
-			mRequestQueue.insert(req);
-			unlockData();
+			mPendingCount++;
+			queuePush(req);
 			if (mThreaded && start_priority < PRIORITY_NORMAL)
 			{
 				ms_sleep(1); // sleep the thread a little
 			}
 		}
-		
+
 		LLTrace::get_thread_recorder()->pushToParent();
 	}
 
@@ -481,7 +878,7 @@ S32 LLQueuedThread::processNextRequest()
 bool LLQueuedThread::runCondition()
 {
 	// mRunCondition must be locked here
-	if (mRequestQueue.empty() && mIdleThread)
+	if (mPendingCount == 0 && mIdleThread)
 		return false;
 	else
 		return true;
@@ -494,12 +891,12 @@ void LLQueuedThread::run()
 	checkPause();
 	startThread();
 	mStarted = TRUE;
-	
+
 	while (1)
 	{
 		// this will block on the condition until runCondition() returns true, the thread is unpaused, or the thread leaves the RUNNING state.
 		checkPause();
-		
+
 		if (isQuitting())
 		{
 			LLTrace::get_thread_recorder()->pushToParent();
@@ -510,7 +907,7 @@ void LLQueuedThread::run()
 		mIdleThread = FALSE;
 
 		threadedUpdate();
-		
+
 		int pending_work = processNextRequest();
 
 		if (pending_work == 0)
@@ -518,7 +915,7 @@ void LLQueuedThread::run()
 			mIdleThread = TRUE;
 			ms_sleep(1);
 		}
-		//LLThread::yield(); // thread should yield after each request		
+		//LLThread::yield(); // thread should yield after each request
 	}
 	LL_INFOS() << "LLQueuedThread " << mName << " EXITING." << LL_ENDL;
 }
@@ -544,7 +941,8 @@ LLQueuedThread::QueuedRequest::QueuedRequest(LLQueuedThread::handle_t handle, U3
 	LLSimpleHashEntry<LLQueuedThread::handle_t>(handle),
 	mStatus(STATUS_UNKNOWN),
 	mPriority(priority),
-	mFlags(flags)
+	mFlags(flags),
+	mQueueIndex(-1)
 {
 }
 
@@ -27,19 +27,26 @@
 #ifndef LL_LLQUEUEDTHREAD_H
 #define LL_LLQUEUEDTHREAD_H
 
-#include <queue>
 #include <string>
-#include <map>
-#include <set>
+#include <vector>
 
 #include "llatomic.h"
 
 #include "llthread.h"
 #include "llsimplehash.h"
 
+class LLJobScheduler;
+
 //============================================================================
 // Note: ~LLQueuedThread is O(N) N=# of queued threads, assumed to be small
 //   It is assumed that LLQueuedThreads are rarely created/destroyed.
+//
+// Request submission does not take mDataLock:
+//  * addRequest() and setPriority() push commands onto a lock-free
+//    multi-producer / single-consumer list that the worker drains.
+//  * Queued requests live in a binary heap owned by the worker.
+//  * Handles index a slot table whose entries are validated and pinned
+//    with atomics, so accessors never block on the worker.
 
 class LL_COMMON_API LLQueuedThread : public LLThread
 {
@@ -94,7 +101,7 @@ public:
 		}
 		U32 getFlags() const
 		{
-			return mFlags;
+			return mFlags.load();
 		}
 		bool higherPriority(const QueuedRequest& second) const
 		{
@@ -114,7 +121,7 @@ public:
 		void setFlags(U32 flags)
 		{
 			// NOTE: flags are |'d
-			mFlags |= flags;
+			mFlags.fetch_or(flags);
 		}
 		
 		virtual bool processRequest() = 0; // Return true when request has completed
@@ -130,7 +137,10 @@ public:
 	protected:
 		LLAtomicBase<status_t> mStatus;
 		U32 mPriority;
-		U32 mFlags;
+		std::atomic<U32> mFlags;
+
+	private:
+		S32 mQueueIndex; // position in mRequestQueue, -1 when not queued (worker only)
 	};
 
 protected:
@@ -138,10 +148,49 @@ protected:
 	{
 		bool operator()(const QueuedRequest* lhs, const QueuedRequest* rhs) const
 		{
-			return lhs->higherPriority(*rhs); // higher priority in front of queue (set)
+			return lhs->higherPriority(*rhs); // higher priority in front of queue
 		}
 	};
 
+	// Commands submitted by any thread, consumed by the worker
+	struct Command
+	{
+		enum { ADD_REQUEST, SET_PRIORITY, STUB };
+
+		Command(U32 type, handle_t handle, U32 value = 0, QueuedRequest* req = NULL)
+			: mNext(NULL), mType(type), mHandle(handle), mValue(value), mRequest(req) {}
+
+		std::atomic<Command*> mNext;
+		U32 mType;
+		handle_t mHandle;
+		U32 mValue;
+		QueuedRequest* mRequest;
+	};
+
+	// Handle table entry. A handle encodes its slot index and the slot
+	// generation, so stale handles fail validation once a slot is reused.
+	struct RequestSlot
+	{
+		RequestSlot() : mRequest(NULL), mHandle(0), mPins(0), mNextFree(0), mGeneration(1) {}
+
+		std::atomic<QueuedRequest*> mRequest;
+		std::atomic<handle_t> mHandle;	// 0 unless a live request is published here
+		std::atomic<U32> mPins;			// threads currently dereferencing mRequest
+		std::atomic<U32> mNextFree;
+		U32 mGeneration;				// only touched by the slot owner
+	};
+
+	enum
+	{
+		SLOT_INDEX_BITS = 20,
+		SLOT_INDEX_MASK = (1 << SLOT_INDEX_BITS) - 1,
+		SLOT_GENERATION_MASK = 0xFFF,
+		SLOT_CHUNK_BITS = 10,
+		SLOT_CHUNK_SIZE = 1 << SLOT_CHUNK_BITS,
+		SLOT_MAX_CHUNKS = 1 << (SLOT_INDEX_BITS - SLOT_CHUNK_BITS),
+		SLOT_NONE = 0xFFFFFFFF
+	};
+
 
 	//------------------------------------------------------------------------
 	
@@ -170,6 +219,35 @@ protected:
 	S32  processNextRequest(void);
 	void incQueue();
 
+private:
+	// Command list (any thread pushes, worker pops)
+	void pushCommand(Command* cmd);
+	Command* popCommand();
+	void processCommands();
+
+	// Priority heap (worker only)
+	void queuePush(QueuedRequest* req);
+	QueuedRequest* queuePop();
+	void queueUpdate(QueuedRequest* req);
+	void queueSiftUp(S32 index);
+	void queueSiftDown(S32 index);
+	void queueSet(S32 index, QueuedRequest* req);
+
+	// Handle table (any thread)
+	RequestSlot* getSlot(handle_t handle) const;
+	RequestSlot* pinSlot(handle_t handle) const;
+	void unpinSlot(RequestSlot* slot) const;
+	U32 allocSlot();
+	void freeSlot(U32 index);
+	QueuedRequest* releaseRequest(handle_t handle);
+	void retireRequest(QueuedRequest* req, bool completed);
+
+	// Job scheduler support
+	class PumpJob;
+	friend class PumpJob;
+	void schedulePump(bool requeue = false);
+	void pumpRequests();
+
 public:
 	bool waitForResult(handle_t handle, bool auto_complete = true);
 
@@ -182,6 +260,12 @@ public:
 	virtual S32 getPending();
 	bool getThreaded() { return mThreaded ? true : false; }
 
+	// Processes requests in jobs on scheduler instead of on a dedicated
+	// thread or in update(). Only for instances created with threaded = false,
+	// and must be called before any request is added. As with a threaded
+	// instance, call shutdown() before deleting it.
+	void runOnScheduler(LLJobScheduler* scheduler);
+
 	// Request accessors
 	status_t getRequestStatus(handle_t handle);
 	void abortRequest(handle_t handle, bool autocomplete);
@@ -200,14 +284,24 @@ protected:
 	BOOL mStarted;  // required when mThreaded is false to call startThread() from update()
 	LLAtomicBool mIdleThread; // request queue is empty (or we are quitting) and the thread is idle
 	
-	typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
-	request_queue_t mRequestQueue;
+	std::atomic<S32> mPendingCount; // submitted requests not yet completed, excluding the one in progress
+
+	typedef std::vector<QueuedRequest*> request_queue_t;
+	request_queue_t mRequestQueue; // binary heap ordered by queued_request_less, worker only
+
+private:
+	Command mCommandStub;
+	std::atomic<Command*> mCommandHead;
+	Command* mCommandTail; // worker only
 
-	enum { REQUEST_HASH_SIZE = 512 }; // must be power of 2
-	typedef LLSimpleHash<handle_t, REQUEST_HASH_SIZE> request_hash_t;
-	request_hash_t mRequestHash;
+	std::atomic<RequestSlot*> mSlotChunks[SLOT_MAX_CHUNKS];
+	std::atomic<U32> mSlotChunkCount;
+	std::atomic<U64> mFreeSlots; // free list head: ABA tag << 32 | slot index
+	LLMutex mSlotGrowMutex;
 
-	handle_t mNextHandle;
+	LLJobScheduler* mScheduler;
+	std::atomic<bool> mPumpScheduled;	// at most one PumpJob is queued or running
+	std::atomic<S32> mPumpJobs;			// PumpJobs that may still touch this
 };
 
 #endif // LL_LLQUEUEDTHREAD_H
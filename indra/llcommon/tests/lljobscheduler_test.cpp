@@ -0,0 +1,461 @@
+/**
+ * @file lljobscheduler_test.cpp
+ * @brief Tests and scaling benchmark for LLJobScheduler.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lljobscheduler.h"
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Records the order jobs ran in
+	class OrderJob : public LLJob
+	{
+	public:
+		OrderJob(S32 id, std::vector<S32>* order, LLMutex* mutex, EPriority priority = PRIORITY_NORMAL) :
+			LLJob(priority),
+			mID(id),
+			mOrder(order),
+			mMutex(mutex)
+		{
+		}
+
+		/*virtual*/ void run()
+		{
+			LLMutexLock lock(mMutex);
+			mOrder->push_back(mID);
+		}
+
+	private:
+		S32 mID;
+		std::vector<S32>* mOrder;
+		LLMutex* mMutex;
+	};
+
+	// Blocks its worker until released
+	class GateJob : public LLJob
+	{
+	public:
+		GateJob() : LLJob(PRIORITY_HIGH), mStarted(false), mOpen(false) {}
+
+		/*virtual*/ void run()
+		{
+			mStarted = true;
+			while (!mOpen)
+			{
+				LLThread::yield();
+			}
+		}
+
+		LLAtomicBool mStarted;
+		LLAtomicBool mOpen;
+	};
+
+	// run() on a worker, finish() on the thread calling updateMainThread()
+	class ContinuationJob : public LLJob
+	{
+	public:
+		ContinuationJob() : LLJob(PRIORITY_NORMAL, true), mRan(false), mFinished(false), mFinishThread(0) {}
+
+		/*virtual*/ void run() { mRan = true; }
+		/*virtual*/ void finish() { mFinished = true; mFinishThread = LLThread::currentID(); }
+
+		LLAtomicBool mRan;
+		LLAtomicBool mFinished;
+		U32 mFinishThread;
+	};
+
+	// Fixed amount of arithmetic, for the scaling benchmark
+	class SpinJob : public LLJob
+	{
+	public:
+		SpinJob(U32 iterations, LLAtomicU32* total) : mIterations(iterations), mResult(0), mTotal(total) {}
+
+		/*virtual*/ void run()
+		{
+			U32 value = 0;
+			for (U32 i = 0; i < mIterations; i++)
+			{
+				value = value * 1664525 + 1013904223;
+			}
+			mResult = value;
+			(*mTotal)++;
+		}
+
+	private:
+		U32 mIterations;
+		U32 mResult;
+		LLAtomicU32* mTotal;
+	};
+
+	// Non-threaded LLQueuedThread driven by the scheduler
+	class ScheduledQueue : public LLQueuedThread
+	{
+	public:
+		class Request : public QueuedRequest
+		{
+		public:
+			Request(handle_t handle, LLAtomicS32* done) :
+				QueuedRequest(handle, PRIORITY_NORMAL, FLAG_AUTO_COMPLETE),
+				mDone(done)
+			{
+			}
+
+			/*virtual*/ bool processRequest()
+			{
+				(*mDone)++;
+				return true;
+			}
+
+		private:
+			LLAtomicS32* mDone;
+		};
+
+		ScheduledQueue() : LLQueuedThread("scheduled", false) {}
+
+		void add(LLAtomicS32* done)
+		{
+			handle_t handle = generateHandle();
+			addRequest(new Request(handle, done));
+		}
+	};
+
+	void wait_until_idle(LLJobScheduler& scheduler)
+	{
+		while (scheduler.getPending() > 0)
+		{
+			scheduler.updateMainThread();
+			LLThread::yield();
+		}
+	}
+}
+
+namespace tut
+{
+	struct job_scheduler
+	{
+	};
+
+	typedef test_group<job_scheduler> job_scheduler_test;
+	typedef job_scheduler_test::object job_scheduler_t;
+	job_scheduler_test tut_job_scheduler("LLJobScheduler");
+
+	// every submitted job runs once
+	template<> template<>
+	void job_scheduler_t::test<1>()
+	{
+		LLJobScheduler scheduler("test", 4);
+		LLAtomicU32 total(0);
+		std::vector<LLJob::ptr_t> jobs;
+		for (S32 i = 0; i < 1000; i++)
+		{
+			jobs.push_back(new SpinJob(1, &total));
+			scheduler.submit(jobs.back());
+		}
+		for (S32 i = 0; i < 1000; i++)
+		{
+			scheduler.waitFor(jobs[i]);
+			ensure("job complete", jobs[i]->isComplete());
+		}
+		ensure_equals("all jobs ran", (U32)total, 1000U);
+	}
+
+	// dependencies run first, whichever worker picks them up
+	template<> template<>
+	void job_scheduler_t::test<2>()
+	{
+		LLJobScheduler scheduler("test", 4);
+		LLMutex mutex;
+		std::vector<S32> order;
+		LLJob::ptr_t first = new OrderJob(1, &order, &mutex);
+		LLJob::ptr_t left = new OrderJob(2, &order, &mutex);
+		LLJob::ptr_t right = new OrderJob(2, &order, &mutex);
+		LLJob::ptr_t last = new OrderJob(3, &order, &mutex);
+		left->addDependency(first);
+		right->addDependency(first);
+		last->addDependency(left);
+		last->addDependency(right);
+
+		// submit in reverse to show the order comes from the dependencies
+		scheduler.submit(last);
+		scheduler.submit(right);
+		scheduler.submit(left);
+		ensure_equals("waiting on dependencies", last->getStatus(), LLJob::STATUS_WAITING);
+		scheduler.submit(first);
+		scheduler.waitFor(last);
+
+		ensure_equals("all ran", (S32)order.size(), 4);
+		ensure_equals("first", order[0], 1);
+		ensure_equals("middle", order[1], 2);
+		ensure_equals("middle", order[2], 2);
+		ensure_equals("last", order[3], 3);
+	}
+
+	// higher priority jobs are picked first
+	template<> template<>
+	void job_scheduler_t::test<3>()
+	{
+		LLJobScheduler scheduler("test", 1);
+		LLMutex mutex;
+		std::vector<S32> order;
+		LLPointer<GateJob> gate = new GateJob();
+		scheduler.submit(gate.get());
+		while (!gate->mStarted)
+		{
+			LLThread::yield();
+		}
+
+		scheduler.submit(new OrderJob(3, &order, &mutex, LLJob::PRIORITY_LOW));
+		scheduler.submit(new OrderJob(2, &order, &mutex, LLJob::PRIORITY_NORMAL));
+		scheduler.submit(new OrderJob(1, &order, &mutex, LLJob::PRIORITY_HIGH));
+		gate->mOpen = true;
+		wait_until_idle(scheduler);
+		// the last job can still be running once nothing is queued
+		scheduler.stop();
+
+		ensure_equals("all ran", (S32)order.size(), 3);
+		ensure_equals("high first", order[0], 1);
+		ensure_equals("normal second", order[1], 2);
+		ensure_equals("low last", order[2], 3);
+	}
+
+	// finish() runs on the main thread, dependents wait for it
+	template<> template<>
+	void job_scheduler_t::test<4>()
+	{
+		LLJobScheduler scheduler("test", 2);
+		LLMutex mutex;
+		std::vector<S32> order;
+		LLPointer<ContinuationJob> job = new ContinuationJob();
+		LLJob::ptr_t dependent = new OrderJob(1, &order, &mutex);
+		dependent->addDependency(job.get());
+		scheduler.submit(job.get());
+		scheduler.submit(dependent);
+
+		while (!job->mRan || job->getStatus() != LLJob::STATUS_FINISHING)
+		{
+			LLThread::yield();
+		}
+		ensure("finish waits for the main thread", !job->mFinished);
+		ensure("dependent waits for finish", order.empty());
+
+		ensure_equals("one continuation ran", scheduler.updateMainThread(), 0);
+		ensure("finished", (bool)job->mFinished);
+		ensure_equals("finished on this thread", job->mFinishThread, LLThread::currentID());
+		ensure("complete", job->isComplete());
+		scheduler.waitFor(dependent);
+		ensure_equals("dependent ran", (S32)order.size(), 1);
+	}
+
+	// an LLQueuedThread created without its own thread can run on the scheduler
+	template<> template<>
+	void job_scheduler_t::test<5>()
+	{
+		LLJobScheduler scheduler("test", 4);
+		LLAtomicS32 done(0);
+		{
+			ScheduledQueue queue;
+			queue.runOnScheduler(&scheduler);
+			for (S32 i = 0; i < 2000; i++)
+			{
+				queue.add(&done);
+			}
+			while (queue.getPending() > 0)
+			{
+				LLThread::yield();
+			}
+			wait_until_idle(scheduler);
+			queue.shutdown();
+		}
+		ensure_equals("all requests processed", (S32)done, 2000);
+	}
+
+	// scaling benchmark, 1 to 16 workers
+	template<> template<>
+	void job_scheduler_t::test<6>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 JOBS = 4096;
+		const U32 ITERATIONS = 20000;
+		F64 single = 0.0;
+		for (U32 threads = 1; threads <= 16; threads *= 2)
+		{
+			LLJobScheduler scheduler("bench", threads);
+			LLAtomicU32 total(0);
+			LLTimer timer;
+			for (S32 i = 0; i < JOBS; i++)
+			{
+				scheduler.submit(new SpinJob(ITERATIONS, &total));
+			}
+			wait_until_idle(scheduler);
+			scheduler.stop();
+			F64 elapsed = timer.getElapsedTimeF64();
+			if (threads == 1)
+			{
+				single = elapsed;
+			}
+			LL_INFOS() << llformat("LLJobScheduler: %2d workers, %d jobs: %.1f ms (%.2fx)",
+								   threads, JOBS, elapsed * 1000.0, single / llmax(elapsed, 0.000001)) << LL_ENDL;
+			ensure_equals("all jobs ran", (U32)total, (U32)JOBS);
+		}
+	}
+
+	// ll_parallel_for covers every index once, serially without a scheduler
+	template<> template<>
+	void job_scheduler_t::test<7>()
+	{
+		const U32 COUNT = 1000;
+		std::vector<U32> hits(COUNT, 0);
+		LLAtomicU32 ranges(0);
+		auto mark = [&](U32 begin, U32 end)
+		{
+			for (U32 i = begin; i < end; ++i)
+			{
+				hits[i]++;
+			}
+			ranges++;
+		};
+
+		ll_parallel_for((LLJobScheduler*)NULL, COUNT, 10, mark);
+		ensure_equals("one range without scheduler", (U32)ranges, 1U);
+
+		LLJobScheduler scheduler("test", 3);
+		ranges = 0;
+		ll_parallel_for(&scheduler, COUNT, 10, mark);
+		ensure_equals("one range per worker and caller", (U32)ranges, 4U);
+
+		ranges = 0;
+		ll_parallel_for(&scheduler, COUNT, 400, mark);
+		ensure_equals("no range below the minimum", (U32)ranges, 2U);
+
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("each index once per call", hits[i], 3U);
+		}
+		scheduler.stop();
+	}
+
+	// waiting runs the job waited for, and no other
+	template<> template<>
+	void job_scheduler_t::test<8>()
+	{
+		LLJobScheduler scheduler("test", 1);
+		LLMutex mutex;
+		std::vector<S32> order;
+		LLPointer<GateJob> gate = new GateJob();
+		scheduler.submit(gate.get());
+		while (!gate->mStarted)
+		{
+			LLThread::yield();
+		}
+
+		LLJob::ptr_t other = new OrderJob(1, &order, &mutex);
+		LLJob::ptr_t mine = new OrderJob(2, &order, &mutex);
+		scheduler.submit(other);
+		scheduler.submit(mine);
+		scheduler.waitFor(mine);
+		ensure("waited for job ran", mine->isComplete());
+		ensure_equals("nothing else ran", (S32)order.size(), 1);
+		ensure_equals("only the waited for job", order[0], 2);
+
+		gate->mOpen = true;
+		scheduler.waitFor(other);
+		ensure_equals("other ran on the worker", (S32)order.size(), 2);
+	}
+
+	// stopping cancels what can no longer complete, later jobs run at once
+	template<> template<>
+	void job_scheduler_t::test<9>()
+	{
+		LLJobScheduler scheduler("test", 1);
+		LLMutex mutex;
+		std::vector<S32> order;
+		LLPointer<ContinuationJob> job = new ContinuationJob();
+		LLJob::ptr_t dependent = new OrderJob(1, &order, &mutex);
+		dependent->addDependency(job.get());
+		scheduler.submit(job.get());
+		scheduler.submit(dependent);
+		while (job->getStatus() != LLJob::STATUS_FINISHING)
+		{
+			LLThread::yield();
+		}
+
+		scheduler.stop();
+		ensure("continuation cancelled", job->isCancelled());
+		ensure("dependent cancelled", dependent->isCancelled());
+		scheduler.waitFor(dependent);
+		ensure("dependent never ran", order.empty());
+
+		LLPointer<ContinuationJob> late = new ContinuationJob();
+		scheduler.submit(late.get());
+		ensure("late job complete", late->isComplete());
+		ensure("late job finished", (bool)late->mFinished);
+	}
+
+	// ranges cancelled by stop() still run before ll_parallel_for returns
+	template<> template<>
+	void job_scheduler_t::test<10>()
+	{
+		LLJobScheduler scheduler("test", 1);
+		LLPointer<GateJob> gate = new GateJob();
+		scheduler.submit(gate.get());
+		while (!gate->mStarted)
+		{
+			LLThread::yield();
+		}
+
+		const U32 COUNT = 1000;
+		std::vector<U32> hits(COUNT, 0);
+		auto mark = [&](U32 begin, U32 end)
+		{
+			for (U32 i = begin; i < end; ++i)
+			{
+				hits[i]++;
+			}
+			if (begin == 0)
+			{
+				// the worker is still held by the gate, so the other range
+				// is queued when the scheduler stops
+				std::thread opener([&]() { ms_sleep(50); gate->mOpen = true; });
+				scheduler.stop();
+				opener.join();
+			}
+		};
+		ll_parallel_for(&scheduler, COUNT, 10, mark);
+
+		for (U32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("each index once", hits[i], 1U);
+		}
+	}
+}
@@ -0,0 +1,236 @@
+/**
+ * @file llqueuedthread_test.cpp
+ * @brief Tests and contention benchmark for LLQueuedThread request submission.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <thread>
+#include <vector>
+
+namespace
+{
+	std::atomic<S32> sFinished(0);
+
+	class TestQueuedThread : public LLQueuedThread
+	{
+	public:
+		class TestRequest : public QueuedRequest
+		{
+		public:
+			TestRequest(handle_t handle, U32 priority, U32 flags, S32 id, std::vector<S32>* order) :
+				QueuedRequest(handle, priority, flags),
+				mID(id),
+				mOrder(order)
+			{
+			}
+
+			/*virtual*/ bool processRequest()
+			{
+				if (mOrder)
+				{
+					mOrder->push_back(mID);
+				}
+				return true;
+			}
+
+			/*virtual*/ void finishRequest(bool completed)
+			{
+				sFinished++;
+			}
+
+			/*virtual*/ void deleteRequest()
+			{
+				QueuedRequest::deleteRequest();
+			}
+
+		private:
+			S32 mID;
+			std::vector<S32>* mOrder;
+		};
+
+		TestQueuedThread(bool threaded) :
+			LLQueuedThread("test", threaded)
+		{
+		}
+
+		handle_t add(U32 priority, U32 flags, S32 id = 0, std::vector<S32>* order = NULL)
+		{
+			handle_t handle = generateHandle();
+			TestRequest* req = new TestRequest(handle, priority, flags, id, order);
+			if (!addRequest(req))
+			{
+				req->deleteRequest();
+				return nullHandle();
+			}
+			return handle;
+		}
+	};
+
+	// Submits auto-completing requests as fast as possible
+	struct Producer
+	{
+		Producer(TestQueuedThread* thread, S32 count) : mThread(thread), mCount(count) {}
+
+		void operator()()
+		{
+			for (S32 i = 0; i < mCount; i++)
+			{
+				mThread->add(LLQueuedThread::PRIORITY_NORMAL + i, LLQueuedThread::FLAG_AUTO_COMPLETE);
+			}
+		}
+
+		TestQueuedThread* mThread;
+		S32 mCount;
+	};
+
+	// Runs producer threads against a threaded queue, returns elapsed seconds
+	F64 run_producers(S32 producers, S32 per_producer)
+	{
+		sFinished = 0;
+		TestQueuedThread thread(true);
+		LLTimer timer;
+		std::vector<std::thread*> threads;
+		for (S32 i = 0; i < producers; i++)
+		{
+			threads.push_back(new std::thread(Producer(&thread, per_producer)));
+		}
+		for (S32 i = 0; i < producers; i++)
+		{
+			threads[i]->join();
+			delete threads[i];
+		}
+		while (sFinished < producers * per_producer)
+		{
+			thread.update(0);
+			LLThread::yield();
+		}
+		return timer.getElapsedTimeF64();
+	}
+}
+
+namespace tut
+{
+	struct queued_thread
+	{
+		queued_thread()
+		{
+			sFinished = 0;
+		}
+	};
+
+	typedef test_group<queued_thread> queued_thread_test;
+	typedef queued_thread_test::object queued_thread_t;
+	queued_thread_test tut_queued_thread("LLQueuedThread");
+
+	// requests run in priority order and setPriority() reorders queued requests
+	template<> template<>
+	void queued_thread_t::test<1>()
+	{
+		std::vector<S32> order;
+		TestQueuedThread thread(false);
+		thread.add(LLQueuedThread::PRIORITY_LOW, LLQueuedThread::FLAG_AUTO_COMPLETE, 1, &order);
+		thread.add(LLQueuedThread::PRIORITY_HIGH, LLQueuedThread::FLAG_AUTO_COMPLETE, 2, &order);
+		LLQueuedThread::handle_t handle = thread.add(LLQueuedThread::PRIORITY_NORMAL, LLQueuedThread::FLAG_AUTO_COMPLETE, 3, &order);
+		thread.add(LLQueuedThread::PRIORITY_NORMAL, LLQueuedThread::FLAG_AUTO_COMPLETE, 4, &order);
+		thread.setPriority(handle, LLQueuedThread::PRIORITY_URGENT);
+
+		ensure_equals("pending before update", thread.getPending(), 4);
+		thread.update(0);
+		ensure_equals("pending after update", thread.getPending(), 0);
+		ensure_equals("all processed", (S32)order.size(), 4);
+		ensure_equals("urgent first", order[0], 3);
+		ensure_equals("high second", order[1], 2);
+		ensure_equals("normal third", order[2], 4);
+		ensure_equals("low last", order[3], 1);
+	}
+
+	// handles go stale once completed, even when their slot is reused
+	template<> template<>
+	void queued_thread_t::test<2>()
+	{
+		TestQueuedThread thread(false);
+		LLQueuedThread::handle_t first = thread.add(LLQueuedThread::PRIORITY_NORMAL, 0);
+		ensure("handle not null", first != LLQueuedThread::nullHandle());
+		ensure_equals("queued", thread.getRequestStatus(first), LLQueuedThread::STATUS_QUEUED);
+		ensure("request found", thread.getRequest(first) != NULL);
+
+		thread.update(0);
+		ensure_equals("complete", thread.getRequestStatus(first), LLQueuedThread::STATUS_COMPLETE);
+		ensure("completed", thread.completeRequest(first));
+		ensure_equals("expired", thread.getRequestStatus(first), LLQueuedThread::STATUS_EXPIRED);
+		ensure("second complete fails", !thread.completeRequest(first));
+
+		LLQueuedThread::handle_t second = thread.add(LLQueuedThread::PRIORITY_NORMAL, 0);
+		ensure("new handle differs", second != first);
+		ensure("stale handle not found", thread.getRequest(first) == NULL);
+		thread.update(0);
+		ensure("wait for result", thread.waitForResult(second));
+	}
+
+	// aborted requests are finished without being processed
+	template<> template<>
+	void queued_thread_t::test<3>()
+	{
+		std::vector<S32> order;
+		TestQueuedThread thread(false);
+		LLQueuedThread::handle_t handle = thread.add(LLQueuedThread::PRIORITY_NORMAL, 0, 1, &order);
+		thread.abortRequest(handle, false);
+		thread.update(0);
+		ensure("not processed", order.empty());
+		ensure_equals("finished", (S32)sFinished, 1);
+		ensure_equals("aborted", thread.getRequestStatus(handle), LLQueuedThread::STATUS_ABORTED);
+		ensure("completed", thread.completeRequest(handle));
+	}
+
+	// every request submitted from several threads is processed exactly once
+	template<> template<>
+	void queued_thread_t::test<4>()
+	{
+		const S32 PRODUCERS = 8;
+		const S32 PER_PRODUCER = 5000;
+		run_producers(PRODUCERS, PER_PRODUCER);
+		ensure_equals("all finished", (S32)sFinished, PRODUCERS * PER_PRODUCER);
+	}
+
+	// submission contention benchmark, 1 to 16 producers
+	template<> template<>
+	void queued_thread_t::test<5>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 REQUESTS = 64000;
+		for (S32 producers = 1; producers <= 16; producers *= 2)
+		{
+			F64 elapsed = run_producers(producers, REQUESTS / producers);
+			LL_INFOS() << llformat("LLQueuedThread: %2d producers, %d requests: %.1f ms (%.0f requests/s)",
+								   producers, REQUESTS, elapsed * 1000.0, REQUESTS / llmax(elapsed, 0.000001)) << LL_ENDL;
+		}
+	}
+}
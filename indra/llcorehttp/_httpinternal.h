@@ -87,7 +87,8 @@
 //   .  'The rest'
 // - Adapt texture cache, image decode and other image consumers to
 //   the BufferArray model to reduce data copying.  Alternatively,
-//   adapt this library to something else.
+//   adapt this library to something else.  [Texture and mesh fetches
+//   take over bodies of known size with BufferArray::detachData().]
 //
 // --------------------------------------------------------------------
 
@@ -159,11 +160,18 @@ const long HTTP_THROTTLE_RATE_DEFAULT = 0L;
 
 // Tuning parameters
 
-// Time worker thread sleeps after a pass through the
-// request, ready and active queues.
+// Longest time the worker thread waits after a pass through
+// the request, ready and active queues when the policy layer
+// has retries, throttled or stalled requests to get back to.
+// Otherwise it waits for socket, timer or request activity.
 const int HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS = 2;
 
-// Block allocation size (a tuning parameter) is found
+// Largest response body, by Content-Length or requested range,
+// given a single contiguous block before it arrives.  Larger
+// bodies are assembled from regular blocks.
+const size_t HTTP_REPLY_RESERVE_MAX = 32 * 1024 * 1024;
+
+// Block allocation sizes (tuning parameters) are found
 // in bufferarray.h.
 
 }  // end namespace LLCore
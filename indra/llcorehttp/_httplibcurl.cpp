@@ -32,6 +32,7 @@
 #include "_httppolicy.h"
 
 #include "llhttpconstants.h"
+#include "lltimer.h"
 
 namespace
 {
@@ -51,6 +52,9 @@ void check_curl_multi_setopt(CURLM* handle, CURLMoption option, ARG argument)
 
 static const char * const LOG_CORE("CoreHttp");
 
+// Deadline of a policy class with no libcurl timer set
+const LLCore::HttpTime TIMER_NONE(~LLCore::HttpTime(0));
+
 } // end anonymous namespace
 
 
@@ -64,7 +68,9 @@ HttpLibcurl::HttpLibcurl(HttpService * service)
 	  mPolicyCount(0),
 	  mMultiHandles(NULL),
 	  mActiveHandles(NULL),
-	  mDirtyPolicy(NULL)
+	  mDirtyPolicy(NULL),
+	  mCallbackData(NULL),
+	  mTimerDeadlines(NULL)
 {}
 
 
@@ -105,7 +111,16 @@ void HttpLibcurl::shutdown()
 
 		delete [] mDirtyPolicy;
 		mDirtyPolicy = NULL;
+
+		// Only after curl_multi_cleanup(), which may still call back
+		delete [] mCallbackData;
+		mCallbackData = NULL;
+
+		delete [] mTimerDeadlines;
+		mTimerDeadlines = NULL;
 	}
+	mSockets.clear();
+	mSocketEvents.clear();
 
 	mPolicyCount = 0;
 }
@@ -120,6 +135,8 @@ void HttpLibcurl::start(int policy_count)
 	mMultiHandles = new CURLM * [mPolicyCount];
 	mActiveHandles = new int [mPolicyCount];
 	mDirtyPolicy = new bool [mPolicyCount];
+	mCallbackData = new CallbackData [mPolicyCount];
+	mTimerDeadlines = new HttpTime [mPolicyCount];
 	
 	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
 	{
@@ -130,6 +147,17 @@ void HttpLibcurl::start(int policy_count)
 		}
 		mActiveHandles[policy_class] = 0;
 		mDirtyPolicy[policy_class] = false;
+		mCallbackData[policy_class].mTransport = this;
+		mCallbackData[policy_class].mPolicyClass = policy_class;
+		mTimerDeadlines[policy_class] = TIMER_NONE;
+
+		// Socket interface:  libcurl tells us what to wait on and we
+		// only call it for sockets that are ready or timers that are due.
+		CURLM * multi_handle(mMultiHandles[policy_class]);
+		check_curl_multi_setopt(multi_handle, CURLMOPT_SOCKETFUNCTION, socketCallback);
+		check_curl_multi_setopt(multi_handle, CURLMOPT_SOCKETDATA, &mCallbackData[policy_class]);
+		check_curl_multi_setopt(multi_handle, CURLMOPT_TIMERFUNCTION, timerCallback);
+		check_curl_multi_setopt(multi_handle, CURLMOPT_TIMERDATA, &mCallbackData[policy_class]);
 		policyUpdated(policy_class);
 	}
 }
@@ -137,15 +165,35 @@ void HttpLibcurl::start(int policy_count)
 
 // Give libcurl some cycles, invoke it's callbacks, process
 // completed requests finalizing or issuing retries as needed.
+// libcurl is only called for sockets the last wait found
+// ready and for timers that have come due.
 //
-// If active list goes empty *and* we didn't queue any
-// requests for retry, we return a request for a hard
-// sleep otherwise ask for a normal polling interval.
+// If anything completed, a connection may have been freed
+// so ask for an immediate pass through the policy layer,
+// otherwise the sockets and timers decide when we next run.
 HttpService::ELoopSpeed HttpLibcurl::processTransport()
 {
 	HttpService::ELoopSpeed	ret(HttpService::REQUEST_SLEEP);
 
-	// Give libcurl some cycles to do I/O & callbacks
+	// Hand ready sockets to libcurl.  Callbacks may drop sockets
+	// from the map as we go so each is looked up again.
+	for (socket_event_list_t::iterator it(mSocketEvents.begin()); mSocketEvents.end() != it; ++it)
+	{
+		socket_map_t::iterator sock(mSockets.find(it->first));
+		if (mSockets.end() == sock)
+		{
+			continue;
+		}
+
+		int running(0);
+		check_curl_multi_code(curl_multi_socket_action(mMultiHandles[sock->second.mPolicyClass],
+													   it->first,
+													   it->second,
+													   &running));
+	}
+	mSocketEvents.clear();
+
+	const HttpTime now(totalTime());
 	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
 	{
 		if (! mMultiHandles[policy_class])
@@ -153,6 +201,17 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 			// No handle, nothing to do.
 			continue;
 		}
+		if (mTimerDeadlines[policy_class] <= now)
+		{
+			// Cleared first, libcurl will usually set a new one
+			mTimerDeadlines[policy_class] = TIMER_NONE;
+
+			int running(0);
+			check_curl_multi_code(curl_multi_socket_action(mMultiHandles[policy_class],
+														   CURL_SOCKET_TIMEOUT,
+														   0,
+														   &running));
+		}
 		if (! mActiveHandles[policy_class])
 		{
 			// If we've gone quiet and there's a dirty update, apply it,
@@ -163,15 +222,6 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 			}
 			continue;
 		}
-		
-		int running(0);
-		CURLMcode status(CURLM_CALL_MULTI_PERFORM);
-		do
-		{
-			running = 0;
-			status = curl_multi_perform(mMultiHandles[policy_class], &running);
-		}
-		while (0 != running && CURLM_CALL_MULTI_PERFORM == status);
 
 		// Run completion on anything done
 		CURLMsg * msg(NULL);
@@ -185,7 +235,7 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 
 				completeRequest(mMultiHandles[policy_class], handle, result);
 				handle = NULL;					// No longer valid on return
-				ret = HttpService::NORMAL;		// If anything completes, we may have a free slot.
+				ret = HttpService::IMMEDIATE;	// If anything completes, we may have a free slot.
 												// Turning around quickly reduces connection gap by 7-10mS.
 			}
 			else if (CURLMSG_NONE == msg->msg)
@@ -203,11 +253,98 @@ HttpService::ELoopSpeed HttpLibcurl::processTransport()
 		}
 	}
 
-	if (! mActiveOps.empty())
+	return ret;
+}
+
+
+void HttpLibcurl::waitForActivity(HttpWakeup & wakeup, int max_wait_ms)
+{
+	int wait_ms(max_wait_ms);
+	const curl_socket_t wakeup_socket(wakeup.getSocket());
+	if (CURL_SOCKET_BAD == wakeup_socket)
+	{
+		// Nothing will tell us about new requests, poll for them
+		wait_ms = (wait_ms < 0
+				   ? HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS
+				   : (std::min)(wait_ms, HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS));
+	}
+
+	// No later than the first libcurl timer.  Rounded up so we
+	// don't wake just before it is due and spin.
+	const HttpTime now(totalTime());
+	for (int policy_class(0); policy_class < mPolicyCount; ++policy_class)
+	{
+		const HttpTime deadline(mTimerDeadlines[policy_class]);
+		if (TIMER_NONE == deadline)
+		{
+			continue;
+		}
+		const int timer_ms(deadline > now ? int((deadline - now + 999U) / 1000U) : 0);
+		wait_ms = wait_ms < 0 ? timer_ms : (std::min)(wait_ms, timer_ms);
+	}
+
+	mPollFds.clear();
+	if (CURL_SOCKET_BAD != wakeup_socket)
 	{
-		ret = HttpService::NORMAL;
+		pollfd pfd;
+		pfd.fd = wakeup_socket;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		mPollFds.push_back(pfd);
+	}
+	for (socket_map_t::const_iterator it(mSockets.begin()); mSockets.end() != it; ++it)
+	{
+		pollfd pfd;
+		pfd.fd = it->first;
+		pfd.events = ((it->second.mWhat & CURL_POLL_IN) ? POLLIN : 0)
+					 | ((it->second.mWhat & CURL_POLL_OUT) ? POLLOUT : 0);
+		pfd.revents = 0;
+		if (pfd.events)
+		{
+			mPollFds.push_back(pfd);
+		}
+	}
+
+	if (mPollFds.empty())
+	{
+		// Only without a wakeup socket, so wait_ms is bounded
+		ms_sleep(wait_ms);
+		return;
+	}
+
+	if (HttpWakeup::poll(&mPollFds[0], mPollFds.size(), wait_ms) <= 0)
+	{
+		// Timed out (timers are checked by processTransport()) or interrupted
+		return;
+	}
+
+	for (std::vector<pollfd>::const_iterator it(mPollFds.begin()); mPollFds.end() != it; ++it)
+	{
+		if (! it->revents)
+		{
+			continue;
+		}
+		if (it->fd == wakeup_socket)
+		{
+			wakeup.drain();
+			continue;
+		}
+
+		int events(0);
+		if (it->revents & (POLLIN | POLLHUP))
+		{
+			events |= CURL_CSELECT_IN;
+		}
+		if (it->revents & POLLOUT)
+		{
+			events |= CURL_CSELECT_OUT;
+		}
+		if (it->revents & (POLLERR | POLLNVAL))
+		{
+			events |= CURL_CSELECT_ERR;
+		}
+		mSocketEvents.push_back(std::make_pair(curl_socket_t(it->fd), events));
 	}
-	return ret;
 }
 
 
@@ -517,6 +654,41 @@ void HttpLibcurl::policyUpdated(int policy_class)
 	}
 }
 
+// static
+int HttpLibcurl::socketCallback(CURL * /* handle */, curl_socket_t sock, int what, void * userp, void * /* socketp */)
+{
+	CallbackData * data(static_cast<CallbackData *>(userp));
+	socket_map_t & sockets(data->mTransport->mSockets);
+
+	if (CURL_POLL_REMOVE == what)
+	{
+		socket_map_t::iterator it(sockets.find(sock));
+		if (sockets.end() != it && it->second.mPolicyClass == data->mPolicyClass)
+		{
+			sockets.erase(it);
+		}
+	}
+	else
+	{
+		SocketState & state(sockets[sock]);
+		state.mPolicyClass = data->mPolicyClass;
+		state.mWhat = what;
+	}
+	return 0;
+}
+
+
+// static
+int HttpLibcurl::timerCallback(CURLM * /* multi_handle */, long timeout_ms, void * userp)
+{
+	CallbackData * data(static_cast<CallbackData *>(userp));
+
+	data->mTransport->mTimerDeadlines[data->mPolicyClass] = (timeout_ms < 0L
+															 ? TIMER_NONE
+															 : HttpTime(totalTime()) + HttpTime(timeout_ms) * 1000U);
+	return 0;
+}
+
 // ---------------------------------------
 // HttpLibcurl::HandleCache
 // ---------------------------------------
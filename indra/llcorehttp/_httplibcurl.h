@@ -32,11 +32,14 @@
 #include <curl/curl.h>
 #include <curl/multi.h>
 
+#include <map>
 #include <set>
+#include <vector>
 
 #include "httprequest.h"
 #include "_httpservice.h"
 #include "_httpinternal.h"
+#include "_httpwakeup.h"
 
 
 namespace LLCore
@@ -67,7 +70,9 @@ private:
 public:
     typedef boost::shared_ptr<HttpOpRequest> opReqPtr_t;
 
-	/// Give cycles to libcurl to run active requests.  Completed
+	/// Give cycles to libcurl to run active requests.  Only the
+	/// sockets found ready by the last waitForActivity() call and
+	/// timers that have come due are serviced.  Completed
 	/// operations (successful or failed) will be retried or handed
 	/// over to the reply queue as final responses.
 	///
@@ -77,6 +82,14 @@ public:
 	/// Threading:  called by worker thread.
 	HttpService::ELoopSpeed processTransport();
 
+	/// Block until a socket of any policy class is ready, a libcurl
+	/// timer comes due, @wakeup is signalled or @max_wait_ms passes.
+	/// A negative @max_wait_ms waits without limit.  A signalled
+	/// @wakeup is drained before returning.
+	///
+	/// Threading:  called by worker thread.
+	void waitForActivity(HttpWakeup & wakeup, int max_wait_ms);
+
 	/// Add request to the active list.  Caller is expected to have
 	/// provided us with a reference count on the op to hold the
 	/// request.  (No additional references will be added.)
@@ -151,10 +164,34 @@ protected:
 	/// Invoked to cancel an active request, mainly during shutdown
 	/// and destroy.
     void cancelRequest(const opReqPtr_t &op);
+
+	/// libcurl callbacks (CURLMOPT_SOCKETFUNCTION and
+	/// CURLMOPT_TIMERFUNCTION) recording which sockets to watch
+	/// and when each multi handle next needs a timeout call.
+	static int socketCallback(CURL * handle, curl_socket_t sock, int what, void * userp, void * socketp);
+	static int timerCallback(CURLM * multi_handle, long timeout_ms, void * userp);
 	
 protected:
     typedef std::set<opReqPtr_t> active_set_t;
 
+	// Callback context, one per policy class
+	struct CallbackData
+	{
+		HttpLibcurl *	mTransport;
+		int				mPolicyClass;
+	};
+
+	// A socket libcurl wants watched and for what (CURL_POLL_*)
+	struct SocketState
+	{
+		int				mPolicyClass;
+		int				mWhat;
+	};
+	typedef std::map<curl_socket_t, SocketState> socket_map_t;
+
+	// Sockets found ready by a wait and their CURL_CSELECT_* events
+	typedef std::vector<std::pair<curl_socket_t, int> > socket_event_list_t;
+
 	/// Simple request handle cache for libcurl.
 	///
 	/// Handle creation is somewhat slow and chunky in libcurl and there's
@@ -215,6 +252,11 @@ protected:
 	CURLM **			mMultiHandles;		// One handle per policy class
 	int *				mActiveHandles;		// Active count per policy class
 	bool *				mDirtyPolicy;		// Dirty policy update waiting for stall (per pc)
+	CallbackData *		mCallbackData;		// libcurl callback context (per pc)
+	HttpTime *			mTimerDeadlines;	// When libcurl's timer comes due (per pc)
+	socket_map_t		mSockets;			// Sockets libcurl wants watched, all classes
+	socket_event_list_t	mSocketEvents;		// Ready sockets from the last wait
+	std::vector<pollfd>	mPollFds;			// Scratch for waitForActivity()
 	
 }; // end class HttpLibcurl
 
@@ -785,6 +785,27 @@ size_t HttpOpRequest::writeCallback(void * data, size_t size, size_t nmemb, void
 	if (! op->mReplyBody)
 	{
 		op->mReplyBody = new BufferArray();
+
+		// When the body size is known, have it arrive in one
+		// block that consumers can take over without a copy.
+		double content_length(-1.0);
+		size_t expected(0);
+		if (CURLE_OK == curl_easy_getinfo(op->mCurlHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &content_length)
+			&& content_length > 0.0)
+		{
+			expected = (content_length < double(HTTP_REPLY_RESERVE_MAX)
+						? size_t(content_length)
+						: HTTP_REPLY_RESERVE_MAX + 1);
+		}
+		else if (op->mReqLength)
+		{
+			// No Content-Length, assume we get the range we asked for
+			expected = op->mReqLength;
+		}
+		if (expected && expected <= HTTP_REPLY_RESERVE_MAX)
+		{
+			op->mReplyBody->reserve(expected);
+		}
 	}
 	const size_t req_size(size * nmemb);
 	const size_t write_size(op->mReplyBody->append(static_cast<char *>(data), req_size));
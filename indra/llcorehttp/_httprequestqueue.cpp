@@ -85,6 +85,7 @@ HttpStatus HttpRequestQueue::addOp(const HttpRequestQueue::opPtr_t &op)
 	if (wake)
 	{
 		mQueueCV.notify_all();
+		mWakeup.signal();
 	}
 	return HttpStatus();
 }
@@ -139,6 +140,7 @@ void HttpRequestQueue::fetchAll(bool wait, OpContainer & ops)
 void HttpRequestQueue::wakeAll()
 {
 	mQueueCV.notify_all();
+	mWakeup.signal();
 }
 
 
@@ -33,6 +33,7 @@
 #include "httpcommon.h"
 #include "_refcounted.h"
 #include "_mutex.h"
+#include "_httpwakeup.h"
 
 
 namespace LLCore
@@ -109,7 +110,8 @@ public:
 	/// Threading:  callable by any thread.
 	void fetchAll(bool wait, OpContainer & ops);
 
-	/// Wake any sleeping threads.  Normal queuing operations
+	/// Wake any sleeping threads, including a service thread
+	/// blocked on the wakeup channel.  Normal queuing operations
 	/// won't require this but it may be necessary for termination
 	/// requests.
 	///
@@ -125,6 +127,16 @@ public:
 	///
 	/// Threading:  callable by any thread.
 	void stopQueue();
+
+	/// Channel signalled whenever an operation lands on an empty
+	/// queue.  The service thread includes it in its wait on
+	/// libcurl's sockets.
+	///
+	/// Threading:  callable by any thread.
+	HttpWakeup & getWakeup()
+		{
+			return mWakeup;
+		}
 	
 protected:
 	static HttpRequestQueue *			sInstance;
@@ -134,6 +146,7 @@ protected:
 	LLCoreInt::HttpMutex				mQueueMutex;
 	LLCoreInt::HttpConditionVariable	mQueueCV;
 	bool								mQueueStopped;
+	HttpWakeup							mWakeup;
 	
 }; // end class HttpRequestQueue
 
@@ -284,21 +284,21 @@ void HttpService::shutdown()
 
 // Working thread loop-forever method.  Gives time to
 // each of the request queue, policy layer and transport
-// layer pieces and then either sleeps for a small time
-// or waits for a request to come in.  Repeats until
-// requested to stop.
+// layer pieces and then blocks until a request comes in,
+// one of libcurl's sockets or timers needs attention or,
+// if the policy layer asked for it, a short interval passes.
+// Repeats until requested to stop.
 void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 {
 	boost::this_thread::disable_interruption di;
 
 	LLThread::registerThreadID();
 	
-	ELoopSpeed loop(REQUEST_SLEEP);
 	while (! mExitRequested)
 	{
         try
         {
-		    loop = processRequestQueue(loop);
+		    ELoopSpeed loop = processRequestQueue();
 
 		    // Process ready queue issuing new requests as needed
 		    ELoopSpeed new_loop = mPolicy->processReadyQueue();
@@ -308,10 +308,11 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 		    new_loop = mTransport->processTransport();
 		    loop = (std::min)(loop, new_loop);
 		
-		    // Determine whether to spin, sleep briefly or sleep for next request
-		    if (REQUEST_SLEEP != loop)
+		    // Determine whether to spin, wait briefly or wait for next event
+		    if (IMMEDIATE != loop && ! mExitRequested)
 		    {
-			    ms_sleep(HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS);
+			    mTransport->waitForActivity(mRequestQueue->getWakeup(),
+											NORMAL == loop ? HTTP_SERVICE_LOOP_SLEEP_NORMAL_MS : -1);
 		    }
         }
         catch (const LLContinueError&)
@@ -338,12 +339,13 @@ void HttpService::threadRun(LLCoreInt::HttpThread * thread)
 }
 
 
-HttpService::ELoopSpeed HttpService::processRequestQueue(ELoopSpeed loop)
+HttpService::ELoopSpeed HttpService::processRequestQueue()
 {
 	HttpRequestQueue::OpContainer ops;
-	const bool wait_for_req(REQUEST_SLEEP == loop);
-	
-	mRequestQueue->fetchAll(wait_for_req, ops);
+
+	// Waiting happens in the transport, which also watches the
+	// request queue's wakeup channel.
+	mRequestQueue->fetchAll(false, ops);
 	while (! ops.empty())
 	{
 		HttpOperation::ptr_t op(ops.front());
@@ -372,7 +374,7 @@ HttpService::ELoopSpeed HttpService::processRequestQueue(ELoopSpeed loop)
         op.reset();
 	}
 
-	// Queue emptied, allow polling loop to sleep
+	// Queue emptied, allow polling loop to wait
 	return REQUEST_SLEEP;
 }
 
@@ -104,8 +104,9 @@ public:
 	// requests.
 	enum ELoopSpeed
 	{
-		NORMAL,					///< continuous polling of request, ready, active queues
-		REQUEST_SLEEP			///< can sleep indefinitely waiting for request queue write
+		IMMEDIATE,				///< go around again without waiting
+		NORMAL,					///< wait for requests or transport activity, polling at a short interval
+		REQUEST_SLEEP			///< can wait indefinitely for requests or transport activity
 	};
 
 	static void init(HttpRequestQueue *);
@@ -187,7 +188,7 @@ public:
 protected:
 	void threadRun(LLCoreInt::HttpThread * thread);
 	
-	ELoopSpeed processRequestQueue(ELoopSpeed loop);
+	ELoopSpeed processRequestQueue();
 
 protected:
 	friend class HttpOpSetGet;
@@ -0,0 +1,160 @@
+/**
+ * @file _httpwakeup.cpp
+ * @brief Internal definitions for the service thread wakeup channel
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "_httpwakeup.h"
+
+#if ! LL_WINDOWS
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+static const char * const LOG_CORE("CoreHttp");
+
+#if LL_WINDOWS
+typedef int socklen_t;
+
+void close_socket(curl_socket_t sock)
+{
+	closesocket(sock);
+}
+
+bool set_nonblocking(curl_socket_t sock)
+{
+	u_long mode(1);
+	return 0 == ioctlsocket(sock, FIONBIO, &mode);
+}
+#else
+void close_socket(curl_socket_t sock)
+{
+	close(sock);
+}
+
+bool set_nonblocking(curl_socket_t sock)
+{
+	int flags(fcntl(sock, F_GETFL, 0));
+	return flags != -1 && 0 == fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+}
+#endif
+
+} // end anonymous namespace
+
+
+namespace LLCore
+{
+
+
+HttpWakeup::HttpWakeup()
+	: mSocket(CURL_SOCKET_BAD),
+	  mSignaled(false)
+{
+	// A UDP socket connected to its own loopback address.  Anything
+	// we send to it comes straight back and nothing else gets in.
+	curl_socket_t sock(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+	if (CURL_SOCKET_BAD == sock)
+	{
+		LL_WARNS(LOG_CORE) << "Unable to create HTTP service wakeup socket, falling back to polling."
+						   << LL_ENDL;
+		return;
+	}
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addr_len(sizeof(addr));
+	if (bind(sock, (sockaddr *) &addr, sizeof(addr))
+		|| getsockname(sock, (sockaddr *) &addr, &addr_len)
+		|| connect(sock, (sockaddr *) &addr, sizeof(addr))
+		|| ! set_nonblocking(sock))
+	{
+		LL_WARNS(LOG_CORE) << "Unable to set up HTTP service wakeup socket, falling back to polling."
+						   << LL_ENDL;
+		close_socket(sock);
+		return;
+	}
+	mSocket = sock;
+}
+
+
+HttpWakeup::~HttpWakeup()
+{
+	if (CURL_SOCKET_BAD != mSocket)
+	{
+		close_socket(mSocket);
+		mSocket = CURL_SOCKET_BAD;
+	}
+}
+
+
+void HttpWakeup::signal()
+{
+	if (CURL_SOCKET_BAD != mSocket && ! mSignaled.exchange(true))
+	{
+		const char byte(0);
+		send(mSocket, &byte, 1, 0);
+	}
+}
+
+
+void HttpWakeup::drain()
+{
+	if (CURL_SOCKET_BAD == mSocket)
+	{
+		return;
+	}
+
+	char buffer[64];
+	while (recv(mSocket, buffer, sizeof(buffer), 0) > 0)
+		;
+
+	// Cleared after the reads.  A signal() collapsed into the
+	// datagrams just read was made after its caller queued its
+	// work, so the waiter will still see that work.
+	mSignaled = false;
+}
+
+
+// static
+int HttpWakeup::poll(pollfd * fds, size_t count, int timeout_ms)
+{
+#if LL_WINDOWS
+	return WSAPoll(fds, ULONG(count), timeout_ms);
+#else
+	return ::poll(fds, nfds_t(count), timeout_ms);
+#endif
+}
+
+
+}  // end namespace LLCore
@@ -0,0 +1,101 @@
+/**
+ * @file _httpwakeup.h
+ * @brief Internal declaration for the service thread wakeup channel
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef	_LLCORE_HTTP_WAKEUP_H_
+#define	_LLCORE_HTTP_WAKEUP_H_
+
+
+#include "linden_common.h"		// Modifies curl/curl.h interfaces
+
+#include <curl/curl.h>
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <poll.h>
+#endif
+
+#include <atomic>
+
+
+namespace LLCore
+{
+
+
+/// Loopback datagram socket used to interrupt the service thread
+/// while it is blocked waiting on libcurl's sockets.  Any thread
+/// may signal() it, the socket then polls readable until the
+/// waiting thread calls drain().
+///
+/// If the socket can't be created, getSocket() returns
+/// CURL_SOCKET_BAD and the waiter is expected to fall back to
+/// waking up periodically.
+
+class HttpWakeup
+{
+public:
+	HttpWakeup();
+	~HttpWakeup();
+
+private:
+	HttpWakeup(const HttpWakeup &);				// Not defined
+	void operator=(const HttpWakeup &);			// Not defined
+
+public:
+	/// Make the socket readable.  Repeated signals before the
+	/// next drain() are collapsed into one.
+	///
+	/// Threading:  callable by any thread.
+	void signal();
+
+	/// Consume pending signals.  Must be called before the
+	/// waiter looks at the state it was woken for.
+	///
+	/// Threading:  callable by the waiting thread.
+	void drain();
+
+	/// Threading:  callable by any thread.
+	curl_socket_t getSocket() const
+		{
+			return mSocket;
+		}
+
+	/// Portable poll(), WSAPoll() on Windows.
+	///
+	/// @return			Number of descriptors with events, 0
+	///					on timeout, negative on error.
+	static int poll(pollfd * fds, size_t count, int timeout_ms);
+
+protected:
+	curl_socket_t		mSocket;
+	std::atomic<bool>	mSignaled;
+
+}; // end class HttpWakeup
+
+}  // end namespace LLCore
+
+
+#endif	// _LLCORE_HTTP_WAKEUP_H_
@@ -28,11 +28,19 @@
 #include "llexception.h"
 #include "llmemory.h"
 
+#include "_mutex.h"
+
 
 // BufferArray is a list of chunks, each a BufferArray::Block, of contiguous
-// data presented as a single array.  Chunks are at least BufferArray::BLOCK_ALLOC_SIZE
-// in length and can be larger.  Any chunk may be partially filled or even
-// empty.
+// data presented as a single array.  Chunks created by append() are
+// BufferArray::SMALL_BLOCK_ALLOC_SIZE for the first and BufferArray::BLOCK_ALLOC_SIZE
+// after that.  Chunks created by reserve() are exactly the requested
+// size.  Any chunk may be partially filled or even empty.
+//
+// Chunk storage of the append() sizes is recycled through a small pool
+// as responses come and go at a high rate.  All storage comes from
+// ll_aligned_malloc_16() so that a chunk can be handed over to a
+// consumer by detachData().
 //
 // The BufferArray itself is sharable as a RefCounted entity.  As shared
 // reads don't work with the concept of a current position/seek value,
@@ -41,6 +49,51 @@
 // directly and any such attempts have to be serialized outside of this
 // implementation.
 
+namespace
+{
+
+// Free storage kept per size class.  Responses are built on the
+// service thread and released on whichever thread consumes them
+// so the lists are locked.  Free buffers are chained through their
+// first bytes, the pool itself never allocates.
+
+class BlockPool
+{
+public:
+	BlockPool();
+	~BlockPool();
+
+	char * get(size_t len);
+	void put(char * data, size_t len);
+
+	// Pool for the process.  Once it has been destroyed at
+	// exit, storage is simply freed.
+	static BlockPool * instance();
+
+protected:
+	int sizeClass(size_t len) const;
+
+protected:
+	struct FreeBuffer
+	{
+		FreeBuffer * mNext;
+	};
+
+	static const int CLASS_COUNT = 2;
+
+	// Most free buffers kept per size class
+	static const int CLASS_FREE_LIMIT = 32;
+
+	LLCoreInt::HttpMutex mMutex;
+	FreeBuffer * mFree[CLASS_COUNT];
+	int mFreeCount[CLASS_COUNT];
+};
+
+bool sPoolDestroyed(false);
+
+}  // end anonymous namespace
+
+
 namespace LLCore
 {
 
@@ -54,31 +107,25 @@ class BufferArray::Block
 public:
 	~Block();
 
-	void operator delete(void *);
-	void operator delete(void *, size_t len);
-
 protected:
-	Block(size_t len);
+	Block(char * data, size_t len);
 
 	Block(const Block &);						// Not defined
 	void operator=(const Block &);				// Not defined
 
-	// Allocate the block with the additional space for the
-	// buffered data at the end of the object.
-	void * operator new(size_t len, size_t addl_len);
-	
 public:
-	// Only public entry to get a block.
+	// Public entries to get a block.  alloc() sizes other than
+	// the append() sizes aren't pooled.  Both throw std::bad_alloc.
 	static Block * alloc(size_t len);
+	static Block * allocExact(size_t len);
+
+	// Gives up the block's storage to the caller
+	char * detach();
 
 public:
 	size_t mUsed;
 	size_t mAlloced;
-
-	// *NOTE:  Must be last member of the object.  We'll
-	// overallocate as requested via operator new and index
-	// into the array at will.
-	char mData[1];		
+	char * mData;
 };
 
 
@@ -89,6 +136,7 @@ public:
 
 #if	! LL_WINDOWS
 const size_t BufferArray::BLOCK_ALLOC_SIZE;
+const size_t BufferArray::SMALL_BLOCK_ALLOC_SIZE;
 #endif	// ! LL_WINDOWS
 
 BufferArray::BufferArray()
@@ -136,7 +184,8 @@ size_t BufferArray::append(const void * src, size_t len)
 	// Then get new blocks as needed
 	while (len)
 	{
-		const size_t copy_len((std::min)(len, BLOCK_ALLOC_SIZE));
+		const size_t alloc_len(mBlocks.empty() ? SMALL_BLOCK_ALLOC_SIZE : BLOCK_ALLOC_SIZE);
+		const size_t copy_len((std::min)(len, alloc_len));
 		
 		if (mBlocks.size() >= mBlocks.capacity())
 		{
@@ -145,7 +194,7 @@ size_t BufferArray::append(const void * src, size_t len)
         Block * block;
         try
         {
-            block = Block::alloc(BLOCK_ALLOC_SIZE);
+            block = Block::alloc(alloc_len);
         }
         catch (std::bad_alloc&)
         {
@@ -177,6 +226,7 @@ void * BufferArray::appendBufferAlloc(size_t len)
 		mBlocks.reserve(mBlocks.size() + 5);
 	}
 	Block * block = Block::alloc((std::max)(BLOCK_ALLOC_SIZE, len));
+	memset(block->mData, 0, len);
 	block->mUsed = len;
 	mBlocks.push_back(block);
 	mLen += len;
@@ -184,6 +234,77 @@ void * BufferArray::appendBufferAlloc(size_t len)
 }
 
 
+bool BufferArray::reserve(size_t len)
+{
+	if (! len)
+	{
+		return true;
+	}
+	if (! mBlocks.empty())
+	{
+		const Block & last(*mBlocks.back());
+		if (last.mAlloced - last.mUsed >= len)
+		{
+			// Already have it
+			return true;
+		}
+	}
+
+	if (mBlocks.size() >= mBlocks.capacity())
+	{
+		mBlocks.reserve(mBlocks.size() + 5);
+	}
+	try
+	{
+		mBlocks.push_back(Block::allocExact(len));
+	}
+	catch (std::bad_alloc &)
+	{
+		// Not fatal, append() will work without it
+		LL_WARNS() << "Unable to reserve " << len << " bytes in BufferArray" << LL_ENDL;
+		return false;
+	}
+	return true;
+}
+
+
+void * BufferArray::detachData(size_t * len)
+{
+	Block * data_block(NULL);
+	for (container_t::iterator it(mBlocks.begin());
+		 it != mBlocks.end();
+		 ++it)
+	{
+		if ((*it)->mUsed)
+		{
+			if (data_block)
+			{
+				// Data is spread out
+				return NULL;
+			}
+			data_block = *it;
+		}
+	}
+	if (! data_block || data_block->mUsed != data_block->mAlloced)
+	{
+		return NULL;
+	}
+
+	char * data(data_block->detach());
+	*len = mLen;
+	for (container_t::iterator it(mBlocks.begin());
+		 it != mBlocks.end();
+		 ++it)
+	{
+		delete *it;
+		*it = NULL;
+	}
+	mBlocks.clear();
+	mLen = 0;
+	return data;
+}
+
+
 size_t BufferArray::read(size_t pos, void * dst, size_t len)
 {
 	char * c_dst(static_cast<char *>(dst));
@@ -323,46 +444,185 @@ bool BufferArray::getBlockStartEnd(int block, const char ** start, const char **
 // ==================================
 
 
-BufferArray::Block::Block(size_t len)
+BufferArray::Block::Block(char * data, size_t len)
 	: mUsed(0),
-	  mAlloced(len)
-{
-	memset(mData, 0, len);
-}
+	  mAlloced(len),
+	  mData(data)
+{}
 			
 
 BufferArray::Block::~Block()
 {
+	if (mData)
+	{
+		BlockPool * pool(BlockPool::instance());
+		if (pool)
+		{
+			pool->put(mData, mAlloced);
+		}
+		else
+		{
+			ll_aligned_free_16(mData);
+		}
+		mData = NULL;
+	}
 	mUsed = 0;
 	mAlloced = 0;
 }
 
 
-void * BufferArray::Block::operator new(size_t len, size_t addl_len)
+BufferArray::Block * BufferArray::Block::alloc(size_t len)
 {
-	void * mem = new char[len + addl_len + sizeof(void *)];
-	return mem;
+	BlockPool * pool(BlockPool::instance());
+	char * data(pool
+				? pool->get(len)
+				: static_cast<char *>(ll_aligned_malloc_16(len)));
+	if (! data)
+	{
+		throw std::bad_alloc();
+	}
+
+	Block * block(NULL);
+	try
+	{
+		block = new Block(data, len);
+	}
+	catch (std::bad_alloc &)
+	{
+		ll_aligned_free_16(data);
+		throw;
+	}
+	return block;
 }
 
 
-void BufferArray::Block::operator delete(void * mem)
+BufferArray::Block * BufferArray::Block::allocExact(size_t len)
 {
-	char * cmem = static_cast<char *>(mem);
-	delete [] cmem;
+	char * data(static_cast<char *>(ll_aligned_malloc_16(len)));
+	if (! data)
+	{
+		throw std::bad_alloc();
+	}
+
+	Block * block(NULL);
+	try
+	{
+		block = new Block(data, len);
+	}
+	catch (std::bad_alloc &)
+	{
+		ll_aligned_free_16(data);
+		throw;
+	}
+	return block;
 }
 
 
-void BufferArray::Block::operator delete(void * mem, size_t)
+char * BufferArray::Block::detach()
 {
-	operator delete(mem);
+	char * data(mData);
+	mData = NULL;
+	return data;
 }
+	
 
+}  // end namespace LLCore
 
-BufferArray::Block * BufferArray::Block::alloc(size_t len)
+
+namespace
 {
-	Block * block = new (len) Block(len);
-	return block;
+
+
+// ==================================
+// BlockPool Definitions
+// ==================================
+
+
+BlockPool::BlockPool()
+{
+	for (int i(0); i < CLASS_COUNT; ++i)
+	{
+		mFree[i] = NULL;
+		mFreeCount[i] = 0;
+	}
 }
-	
 
-}  // end namespace LLCore
+
+BlockPool::~BlockPool()
+{
+	sPoolDestroyed = true;
+	for (int i(0); i < CLASS_COUNT; ++i)
+	{
+		while (mFree[i])
+		{
+			FreeBuffer * buffer(mFree[i]);
+			mFree[i] = buffer->mNext;
+			ll_aligned_free_16(buffer);
+		}
+		mFreeCount[i] = 0;
+	}
+}
+
+
+// static
+BlockPool * BlockPool::instance()
+{
+	static BlockPool pool;
+	return sPoolDestroyed ? NULL : &pool;
+}
+
+
+int BlockPool::sizeClass(size_t len) const
+{
+	if (LLCore::BufferArray::SMALL_BLOCK_ALLOC_SIZE == len)
+	{
+		return 0;
+	}
+	if (LLCore::BufferArray::BLOCK_ALLOC_SIZE == len)
+	{
+		return 1;
+	}
+	return -1;
+}
+
+
+char * BlockPool::get(size_t len)
+{
+	const int size_class(sizeClass(len));
+	if (size_class >= 0)
+	{
+		LLCoreInt::HttpScopedLock lock(mMutex);
+
+		FreeBuffer * buffer(mFree[size_class]);
+		if (buffer)
+		{
+			mFree[size_class] = buffer->mNext;
+			--mFreeCount[size_class];
+			return reinterpret_cast<char *>(buffer);
+		}
+	}
+	return static_cast<char *>(ll_aligned_malloc_16(len));
+}
+
+
+void BlockPool::put(char * data, size_t len)
+{
+	const int size_class(sizeClass(len));
+	if (size_class >= 0)
+	{
+		LLCoreInt::HttpScopedLock lock(mMutex);
+
+		if (mFreeCount[size_class] < CLASS_FREE_LIMIT)
+		{
+			FreeBuffer * buffer(reinterpret_cast<FreeBuffer *>(data));
+			buffer->mNext = mFree[size_class];
+			mFree[size_class] = buffer;
+			++mFreeCount[size_class];
+			return;
+		}
+	}
+	ll_aligned_free_16(data);
+}
+
+
+}  // end anonymous namespace
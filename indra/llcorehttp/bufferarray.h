@@ -86,6 +86,10 @@ private:
 public:
 	// Internal magic number, may be used by unit tests.
 	static const size_t BLOCK_ALLOC_SIZE = 65540;
+
+	// Size of the first block of an append()-built array.
+	// Most responses fit in it.
+	static const size_t SMALL_BLOCK_ALLOC_SIZE = 16384;
 	
 	/// Appends the indicated data to the BufferArray
 	/// modifying current position and total size.  New
@@ -104,6 +108,28 @@ public:
 	///					of BufferArray of 'len' size.
 	void * appendBufferAlloc(size_t len);
 
+	/// Makes room for 'len' bytes at the current end of the
+	/// BufferArray in a single contiguous block so that the
+	/// following append() calls fill it in place.  Size is
+	/// unchanged.  Intended for bodies whose final length is
+	/// known up front from Content-Length or a range request.
+	///
+	/// @return			True if the space is available.
+	bool reserve(size_t len);
+
+	/// Hands the BufferArray's data over to the caller without
+	/// a copy when it all lives in one block which is exactly
+	/// full, as it will be after a reserve() of the right size.
+	/// The BufferArray is left empty.  Caller must be the only
+	/// user of the instance.
+	///
+	/// @param len		Receives the length of the data.
+	/// @return			Data to be freed with ll_aligned_free_16()
+	///					or NULL if the data isn't in a suitable
+	///					block.  In that case nothing is changed
+	///					and read() should be used instead.
+	void * detachData(size_t * len);
+
 	/// Current count of bytes in BufferArray instance.
 	size_t size() const
 		{
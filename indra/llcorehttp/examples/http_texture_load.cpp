@@ -61,6 +61,7 @@ static int concurrency_limit(40);
 static int highwater(100);
 static int pipeline_depth(0);
 static int tracing(0);
+static int idle_seconds(0);
 static char url_format[1024] = "http://example.com/some/path?texture_id=%s.texture";
 
 #if defined(WIN32)
@@ -96,7 +97,7 @@ public:
 		int				mOffset;
 		int				mLength;
 	};
-	typedef std::set<LLCore::HttpHandle> handle_set_t;
+	typedef std::map<LLCore::HttpHandle, U64> handle_set_t;		// Handle to issue time
 	typedef std::vector<Spec> asset_list_t;
 	
 public:
@@ -121,6 +122,8 @@ public:
 	int							mRetriesHttp503;
 	int							mSuccesses;
 	long						mByteCount;
+	U64							mLatencyTotal;
+	U64							mLatencyMax;
 	LLCore::HttpHeaders::ptr_t	mHeaders;
 };
 
@@ -167,7 +170,7 @@ int main(int argc, char** argv)
 	bool do_verbose(false);
 	
 	int option(-1);
-	while (-1 != (option = getopt(argc, argv, "u:c:h?RwvH:p:t:")))
+	while (-1 != (option = getopt(argc, argv, "u:c:h?RwvH:p:t:i:")))
 	{
 		switch (option)
 		{
@@ -236,6 +239,21 @@ int main(int argc, char** argv)
 			}
 			break;
 
+		case 'i':
+		    {
+				unsigned long value;
+				char * end;
+
+				value = strtoul(optarg, &end, 10);
+				if (value > 3600 || *end != '\0')
+				{
+					usage(std::cerr);
+					return 1;
+				}
+				idle_seconds = value;
+			}
+			break;
+
 		case 'R':
 			do_random = true;
 			do_whole = false;
@@ -359,6 +377,26 @@ int main(int argc, char** argv)
 			  << " uS  Maximum VSZ: " << metrics.mMaxVSZ
 			  << " Bytes  Minimum VSZ: " << metrics.mMinVSZ << " Bytes"
 			  << std::endl;
+	const int completed(ws.mSuccesses + ws.mErrorsHttp + ws.mErrorsApi);
+	const U64 wall_time((std::max)(metrics.mEndWallTime - metrics.mStartWallTime, U64L(1)));
+	std::cout << "Requests/S: " << (completed * 1000000.0 / wall_time)
+			  << "  Mean Latency: " << (completed ? ws.mLatencyTotal / completed : U64L(0))
+			  << " uS  Maximum Latency: " << ws.mLatencyMax << " uS"
+			  << std::endl;
+
+	if (idle_seconds)
+	{
+		// Service thread is running with nothing to do.  Don't call
+		// update() so that only its own CPU use is measured.
+		Metrics idle_metrics;
+		idle_metrics.init();
+		ms_sleep(idle_seconds * 1000);
+		idle_metrics.term();
+		std::cout << "Idle User CPU: " << (idle_metrics.mEndUTime - idle_metrics.mStartUTime)
+				  << " uS  Idle System CPU: " << (idle_metrics.mEndSTime - idle_metrics.mStartSTime)
+				  << " uS  Idle Wall Time: " << (idle_metrics.mEndWallTime - idle_metrics.mStartWallTime)
+				  << " uS" << std::endl;
+	}
 
 	// Clean up
 	hr->requestStopThread(LLCore::HttpHandler::ptr_t());
@@ -398,6 +436,8 @@ void usage(std::ostream & out)
 		"                       depth on HTTP requests.  Default:  " << pipeline_depth << "\n"
 		" -t <level>            If <level> is positive ([1..3]), enables and sets HTTP\n"
 		"                       tracing on HTTP requests.  Default:  " << tracing << "\n"
+		" -i <seconds>          After the run, leave the service idle for <seconds> and\n"
+		"                       report the CPU it used.  Range:  [0..3600]  Default:  " << idle_seconds << "\n"
 		" -v                    Verbose mode.  Issue some chatter while running\n"
 		" -h                    print this help\n"
 		"\n"
@@ -422,7 +462,9 @@ WorkingSet::WorkingSet()
 	  mRetries(0),
 	  mRetriesHttp503(0),
 	  mSuccesses(0),
-	  mByteCount(0L)
+	  mByteCount(0L),
+	  mLatencyTotal(U64L(0)),
+	  mLatencyMax(U64L(0))
 {
 	mAssets.reserve(30000);
 
@@ -484,7 +526,7 @@ bool WorkingSet::reload(LLCore::HttpRequest * hr, LLCore::HttpOptions::ptr_t & o
 		}
 		else
 		{
-			mHandles.insert(handle);
+			mHandles[handle] = totalTime();
 		}
 		mAt++;
 		mRemaining--;
@@ -514,6 +556,10 @@ void WorkingSet::onCompleted(LLCore::HttpHandle handle, LLCore::HttpResponse * r
 	}
 	else
 	{
+		const U64 latency(totalTime() - it->second);
+		mLatencyTotal += latency;
+		mLatencyMax = (std::max)(mLatencyMax, latency);
+
 		LLCore::HttpStatus status(response->getStatus());
 		if (status)
 		{
@@ -888,6 +934,8 @@ public:
 					const int errnum(errno);
 					LL_ERRS("Main") << "Error opening proc fs:  " << strerror(errnum) << LL_ENDL;
 				}
+				// Unbuffered, fseek() may otherwise reuse stale contents
+				setvbuf(mProcFS, NULL, _IONBF, 0);
 			}
 
 			long ticks_per_sec(sysconf(_SC_CLK_TCK));
@@ -27,6 +27,7 @@
 #define TEST_LLCORE_BUFFER_ARRAY_H_
 
 #include "bufferarray.h"
+#include "llmemory.h"
 
 #include <iostream>
 
@@ -426,6 +427,106 @@ void BufferArrayTestObjectType::test<8>()
 	ensure("All memory released", mMemTotal == GetMemTotal());
 }
 
+template <> template <>
+void BufferArrayTestObjectType::test<9>()
+{
+	set_test_name("BufferArray reserve and detachData");
+
+	// record the total amount of dynamically allocated memory
+	mMemTotal = GetMemTotal();
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+
+	// reserve space for a body larger than any regular block
+	const size_t body_len(3 * BufferArray::BLOCK_ALLOC_SIZE + 17);
+	ensure("Reserve succeeded", ba->reserve(body_len));
+	ensure("Reserve doesn't change size", 0 == ba->size());
+
+	// deliver it in libcurl-sized pieces
+	char str1[16384];
+	for (size_t i(0); i < sizeof(str1); ++i)
+	{
+		str1[i] = char(i * 7);
+	}
+	size_t written(0);
+	while (written < body_len)
+	{
+		const size_t piece((std::min)(sizeof(str1), body_len - written));
+		ensure("Append complete", piece == ba->append(str1, piece));
+		written += piece;
+	}
+	ensure("Body length correct", body_len == ba->size());
+
+	// take the data over
+	size_t detached_len(0);
+	char * data(static_cast<char *>(ba->detachData(&detached_len)));
+	ensure("Data detached", NULL != data);
+	ensure("Detached length correct", body_len == detached_len);
+	ensure("BufferArray empty after detach", 0 == ba->size());
+	ensure("Detached content correct.1", 0 == memcmp(data, str1, sizeof(str1)));
+	ensure("Detached content correct.2", str1[(body_len - 1) % sizeof(str1)] == data[body_len - 1]);
+	ll_aligned_free_16(data);
+
+	// still usable
+	char str2[] = "abcdefghij";
+	size_t str2_len(strlen(str2));
+	ensure("Append after detach", str2_len == ba->append(str2, str2_len));
+	ensure("Size after detach", str2_len == ba->size());
+
+	// release the implicit reference, causing the object to be released
+	ba->release();
+
+	// make sure we didn't leak any memory
+	ensure("All memory released", mMemTotal == GetMemTotal());
+}
+
+template <> template <>
+void BufferArrayTestObjectType::test<10>()
+{
+	set_test_name("BufferArray detachData refuses scattered data");
+
+	// record the total amount of dynamically allocated memory
+	mMemTotal = GetMemTotal();
+
+	// create a new ref counted object with an implicit reference
+	BufferArray * ba = new BufferArray();
+
+	char str1[] = "abcdefghij";
+	size_t str1_len(strlen(str1));
+	char buffer[256];
+	size_t detached_len(0);
+
+	// partially filled block
+	ba->append(str1, str1_len);
+	ensure("Partial block not detached", NULL == ba->detachData(&detached_len));
+
+	// data split across a regular block and a reservation
+	ensure("Reserve succeeded", ba->reserve(BufferArray::BLOCK_ALLOC_SIZE));
+	ba->append(str1, str1_len);
+	ensure("Split data not detached", NULL == ba->detachData(&detached_len));
+
+	// contents untouched
+	memset(buffer, 'X', sizeof(buffer));
+	size_t len = ba->read(0, buffer, sizeof(buffer));
+	ensure("Length unchanged", 2 * str1_len == len);
+	ensure("Read content correct.1", 0 == strncmp(buffer, str1, str1_len));
+	ensure("Read content correct.2", 0 == strncmp(buffer + str1_len, str1, str1_len));
+
+	// reservation that fits in the last block adds nothing
+	ba->reserve(str1_len);
+	ba->append(str1, str1_len);
+	len = ba->read(0, buffer, sizeof(buffer));
+	ensure("Length after small reserve", 3 * str1_len == len);
+	ensure("Read content correct.3", 0 == strncmp(buffer + 2 * str1_len, str1, str1_len));
+
+	// release the implicit reference, causing the object to be released
+	ba->release();
+
+	// make sure we didn't leak any memory
+	ensure("All memory released", mMemTotal == GetMemTotal());
+}
+
 }  // end namespace tut
 
 
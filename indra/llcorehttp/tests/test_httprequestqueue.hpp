@@ -182,6 +182,57 @@ void HttpRequestqueueTestObjectType::test<4>()
 	ensure("All memory returned", mMemTotal == GetMemTotal());
 }
 
+template <> template <>
+void HttpRequestqueueTestObjectType::test<5>()
+{
+	set_test_name("HttpRequestQueue addOp signals wakeup");
+
+	// record the total amount of dynamically allocated memory
+	mMemTotal = GetMemTotal();
+
+	HttpRequestQueue::init();
+
+	HttpRequestQueue * rq = HttpRequestQueue::instanceOf();
+	HttpWakeup & wakeup(rq->getWakeup());
+	ensure("Wakeup socket created", CURL_SOCKET_BAD != wakeup.getSocket());
+
+	pollfd pfd;
+	pfd.fd = wakeup.getSocket();
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	ensure("Not signalled while empty", 0 == HttpWakeup::poll(&pfd, 1, 0));
+
+	HttpOperation::ptr_t op (new HttpOpNull());
+	rq->addOp(op);		// transfer my refcount
+	op.reset(new HttpOpNull());
+	rq->addOp(op);		// transfer my refcount
+	op.reset();
+
+	pfd.revents = 0;
+	ensure("Signalled by addOp", 1 == HttpWakeup::poll(&pfd, 1, 1000));
+	wakeup.drain();
+	pfd.revents = 0;
+	ensure("Drained", 0 == HttpWakeup::poll(&pfd, 1, 0));
+
+	{
+		HttpRequestQueue::OpContainer ops;
+		rq->fetchAll(false, ops);
+		ensure("Both ops queued", 2 == ops.size());
+	}
+
+	// Queue is empty again, next op signals again
+	op.reset(new HttpOpNull());
+	rq->addOp(op);		// transfer my refcount
+	op.reset();
+	pfd.revents = 0;
+	ensure("Signalled again", 1 == HttpWakeup::poll(&pfd, 1, 1000));
+
+	HttpRequestQueue::term();
+
+	// Should be clean
+	ensure("All memory returned", mMemTotal == GetMemTotal());
+}
+
 }  // end namespace tut
 
 
@@ -30,6 +30,7 @@
 #include "llimage.h"
 
 #include "llmath.h"
+#include "llsimdmath.h"
 #include "v4coloru.h"
 
 #include "llimagebmp.h"
@@ -38,6 +39,7 @@
 #include "llimagejpeg.h"
 #include "llimagepng.h"
 #include "llimagedxt.h"
+#include "lljobscheduler.h"
 #include "llmemory.h"
 
 #include <boost/preprocessor.hpp>
@@ -220,15 +222,13 @@ private:
 
 
 template<U8 ch>
-inline void bilinear_scale(
-	const U8 *src, U32 srcW, U32 srcH, U32 srcStride
-	, U8 *dst, U32 dstW, U32 dstH, U32 dstStride
+inline void bilinear_scale_rows(
+	const scale_info<ch> &info, U32 srcStride
+	, U8 *dst, U32 dstW, U32 dstStride, U32 yBegin, U32 yEnd
 	)
 {
 	typedef scale_info<ch> scale_info_t;
 
-	scale_info_t info(src, srcW, srcH, dstW, dstH, srcStride);
-
 	const U8 *sptr;
 	U8 *dptr;
 	U32 x, y;
@@ -239,7 +239,7 @@ inline void bilinear_scale(
 
 	if(3 == info.xup_yup)
 	{ //scale x/y - up
-		for(y = 0; y < dstH; ++y)
+		for(y = yBegin; y < yEnd; ++y)
 		{
 			dptr = dst + (y * dstStride);
 			sptr = info.ystrides[y];
@@ -328,7 +328,7 @@ inline void bilinear_scale(
 		S32 Cy, j;
 		S32 yap;
 
-		for(y = 0; y < dstH; y++)
+		for(y = yBegin; y < yEnd; y++)
 		{
 			Cy = info.yapoints[y] >> 16;
 			yap = info.yapoints[y] & 0xffff;
@@ -395,7 +395,7 @@ inline void bilinear_scale(
 		S32 Cx, j;
 		S32 xap;
 
-		for(y = 0; y < dstH; y++)
+		for(y = yBegin; y < yEnd; y++)
 		{
 			dptr = dst + (y * dstStride);
 
@@ -462,7 +462,7 @@ inline void bilinear_scale(
 		S32 Cx, Cy, i, j;
 		S32 xap, yap;
 
-		for(y = 0; y < dstH; y++)
+		for(y = yBegin; y < yEnd; y++)
 		{
 			Cy = info.yapoints[y] >> 16;
 			yap = info.yapoints[y] & 0xffff;
@@ -556,6 +556,199 @@ inline void bilinear_scale(
 	} //else
 }
 
+//..................................................................................
+// SSE2 versions of the scale-down and scale-up paths for 3 and 4 channel
+// images, one pixel per register. Same integer math as above, so the results
+// are identical.
+//..................................................................................
+
+// first ch bytes of pix, as 8 x S16
+template<U8 ch>
+inline __m128i scale_load_pixel(const U8 *pix)
+{
+	U32 bits = 0;
+	memcpy(&bits, pix, ch);
+	return _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), _mm_setzero_si128());
+}
+
+// pix * weight as 4 x S32, weight at most 1 << 14
+inline __m128i scale_mul_pixel(__m128i pix, S32 weight)
+{
+	return _mm_madd_epi16(_mm_unpacklo_epi16(pix, _mm_setzero_si128()), _mm_set1_epi32(weight));
+}
+
+// a * (256 - weight) + b * weight as 4 x S32
+inline __m128i scale_lerp_pixels(__m128i a, __m128i b, S32 weight)
+{
+	return _mm_madd_epi16(_mm_unpacklo_epi16(a, b), _mm_set1_epi32((weight << 16) | (256 - weight)));
+}
+
+// 4 x S32 * val, for products too large for the 16 bit multiplies
+inline __m128i scale_mul_s32(__m128i v, S32 val)
+{
+	const __m128i m = _mm_set1_epi32(val);
+	const __m128i even = _mm_mul_epu32(v, m);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), m);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+template<U8 ch>
+inline void scale_store_pixel(U8 *&dptr, __m128i comp)
+{
+	comp = _mm_and_si128(comp, _mm_set1_epi32(0xff));
+	comp = _mm_packs_epi32(comp, comp);
+	U32 bits = _mm_cvtsi128_si32(_mm_packus_epi16(comp, comp));
+	memcpy(dptr, &bits, ch);
+	dptr += ch;
+}
+
+// weighted sum of the source pixels under one destination pixel, along a row
+template<U8 ch>
+inline __m128i scale_sum_row(const U8 *pix, S32 Cx, S32 xap)
+{
+	__m128i cx = scale_mul_pixel(scale_load_pixel<ch>(pix), xap);
+	pix += ch;
+
+	S32 i;
+	for(i = (1 << 14) - xap; i > Cx; i -= Cx, pix += ch)
+	{
+		cx = _mm_add_epi32(cx, scale_mul_pixel(scale_load_pixel<ch>(pix), Cx));
+	}
+
+	if(i > 0)
+	{
+		cx = _mm_add_epi32(cx, scale_mul_pixel(scale_load_pixel<ch>(pix), i));
+	}
+	return _mm_srli_epi32(cx, 5);
+}
+
+template<U8 ch>
+void bilinear_scale_down_rows_sse(
+	const scale_info<ch> &info, U32 srcStride
+	, U8 *dst, U32 dstW, U32 dstStride, U32 yBegin, U32 yEnd
+	)
+{
+	for(U32 y = yBegin; y < yEnd; ++y)
+	{
+		const S32 Cy = info.yapoints[y] >> 16;
+		const S32 yap = info.yapoints[y] & 0xffff;
+
+		U8 *dptr = dst + (y * dstStride);
+		for(U32 x = 0; x < dstW; ++x)
+		{
+			const S32 Cx = info.xapoints[x] >> 16;
+			const S32 xap = info.xapoints[x] & 0xffff;
+
+			const U8 *sptr = info.ystrides[y] + info.xpoints[x] * ch;
+			__m128i comp = scale_mul_s32(scale_sum_row<ch>(sptr, Cx, xap), yap);
+			sptr += srcStride;
+
+			S32 j;
+			for(j = (1 << 14) - yap; j > Cy; j -= Cy, sptr += srcStride)
+			{
+				comp = _mm_add_epi32(comp, scale_mul_s32(scale_sum_row<ch>(sptr, Cx, xap), Cy));
+			}
+
+			if(j > 0)
+			{
+				comp = _mm_add_epi32(comp, scale_mul_s32(scale_sum_row<ch>(sptr, Cx, xap), j));
+			}
+
+			scale_store_pixel<ch>(dptr, _mm_srli_epi32(comp, 23));
+		}
+	}
+}
+
+template<U8 ch>
+void bilinear_scale_up_rows_sse(
+	const scale_info<ch> &info, U32 srcStride
+	, U8 *dst, U32 dstW, U32 dstStride, U32 yBegin, U32 yEnd
+	)
+{
+	for(U32 y = yBegin; y < yEnd; ++y)
+	{
+		const S32 yap = info.yapoints[y];
+		if(yap <= 0)
+		{ // rows on a source row are mostly copies
+			bilinear_scale_rows<ch>(info, srcStride, dst, dstW, dstStride, y, y + 1);
+			continue;
+		}
+
+		U8 *dptr = dst + (y * dstStride);
+		for(U32 x = 0; x < dstW; ++x)
+		{
+			const S32 xap = info.xapoints[x];
+			const U8 *pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+			__m128i comp;
+			if(xap > 0)
+			{
+				comp = scale_lerp_pixels(scale_load_pixel<ch>(pix), scale_load_pixel<ch>(pix + ch), xap);
+				pix += srcStride;
+				__m128i cx = scale_lerp_pixels(scale_load_pixel<ch>(pix), scale_load_pixel<ch>(pix + ch), xap);
+				comp = _mm_srli_epi32(_mm_add_epi32(scale_mul_s32(cx, yap), scale_mul_s32(comp, 256 - yap)), 16);
+			}
+			else
+			{
+				comp = _mm_srli_epi32(scale_lerp_pixels(scale_load_pixel<ch>(pix), scale_load_pixel<ch>(pix + srcStride), yap), 8);
+			}
+
+			scale_store_pixel<ch>(dptr, comp);
+		}
+	}
+}
+
+template<U8 ch>
+void bilinear_scale_band(
+	const scale_info<ch> &info, U32 srcStride
+	, U8 *dst, U32 dstW, U32 dstStride, U32 yBegin, U32 yEnd
+	)
+{
+	if(ch >= 3 && 0 == info.xup_yup)
+	{
+		bilinear_scale_down_rows_sse<ch>(info, srcStride, dst, dstW, dstStride, yBegin, yEnd);
+	}
+	else if(ch >= 3 && 3 == info.xup_yup)
+	{
+		bilinear_scale_up_rows_sse<ch>(info, srcStride, dst, dstW, dstStride, yBegin, yEnd);
+	}
+	else
+	{
+		bilinear_scale_rows<ch>(info, srcStride, dst, dstW, dstStride, yBegin, yEnd);
+	}
+}
+
+//..................................................................................
+// Row bands. Rows of a resampled image or mip are independent, so large ones
+// are split across the default job scheduler.
+//..................................................................................
+
+// Below this many output pixels handing bands to the scheduler costs more than it saves
+static const U32 ROW_BAND_MIN_PIXELS = 256 * 256;
+static const U32 ROW_BAND_MIN_ROWS = 32;
+
+// Calls band(begin, end) over rows [0, rows), on the calling thread for small images
+template<class BAND>
+void run_row_bands(U32 rows, U32 pixels, const BAND &band)
+{
+	LLJobScheduler *scheduler = pixels >= ROW_BAND_MIN_PIXELS ? LLJobScheduler::getDefault() : NULL;
+	ll_parallel_for(scheduler, rows, ROW_BAND_MIN_ROWS, band);
+}
+
+template<U8 ch>
+void bilinear_scale(
+	const U8 *src, U32 srcW, U32 srcH, U32 srcStride
+	, U8 *dst, U32 dstW, U32 dstH, U32 dstStride
+	)
+{
+	const scale_info<ch> info(src, srcW, srcH, dstW, dstH, srcStride);
+
+	run_row_bands(dstH, dstW * dstH, [&](U32 yBegin, U32 yEnd)
+	{
+		bilinear_scale_band<ch>(info, srcStride, dst, dstW, dstStride, yBegin, yEnd);
+	});
+}
+
 //wrapper
 static void bilinear_scale(const U8 *src, U32 srcW, U32 srcH, U32 srcCh, U32 srcStride, U8 *dst, U32 dstW, U32 dstH, U32 dstCh, U32 dstStride)
 {
@@ -2223,25 +2416,142 @@ S8 LLImageFormatted::getCodec() const
 
 //============================================================================
 
-static void avg4_colors4(const U8* a, const U8* b, const U8* c, const U8* d, U8* dst)
+// Sums of the pixels straight below each other in two rows of 16 bytes, as 2 x 8 U16
+inline void mip_sum_rows(const U8* in0, const U8* in1, __m128i& lo, __m128i& hi)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i a = _mm_loadu_si128((const __m128i*)in0);
+	const __m128i b = _mm_loadu_si128((const __m128i*)in1);
+	lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+	hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+}
+
+// Each generate_mip_row_sse() does as many output pixels of a row as it can
+// from whole 16 byte loads and returns the count, the caller does the rest.
+template<S32 nch>
+S32 generate_mip_row_sse(const U8* in0, const U8* in1, U8* out, S32 width)
+{
+	return 0;
+}
+
+// 16 input pixels to 8
+template<>
+S32 generate_mip_row_sse<1>(const U8* in0, const U8* in1, U8* out, S32 width)
+{
+	const __m128i one = _mm_set1_epi16(1);
+	S32 w = 0;
+	for (; w + 16 <= width; w += 16, in0 += 32, in1 += 32, out += 16)
+	{
+		__m128i lo, hi;
+		mip_sum_rows(in0, in1, lo, hi);
+		const __m128i first = _mm_srli_epi16(_mm_packs_epi32(_mm_madd_epi16(lo, one), _mm_madd_epi16(hi, one)), 2);
+		mip_sum_rows(in0 + 16, in1 + 16, lo, hi);
+		const __m128i second = _mm_srli_epi16(_mm_packs_epi32(_mm_madd_epi16(lo, one), _mm_madd_epi16(hi, one)), 2);
+		_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(first, second));
+	}
+	return w;
+}
+
+// 8 input pixels to 4, a pixel is one 32 bit lane of sums
+inline __m128i generate_mip_block2(const U8* in0, const U8* in1)
+{
+	__m128i lo, hi;
+	mip_sum_rows(in0, in1, lo, hi);
+	const __m128 l = _mm_castsi128_ps(lo);
+	const __m128 h = _mm_castsi128_ps(hi);
+	const __m128i even = _mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(2, 0, 2, 0)));
+	const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm_srli_epi16(_mm_add_epi16(even, odd), 2);
+}
+
+template<>
+S32 generate_mip_row_sse<2>(const U8* in0, const U8* in1, U8* out, S32 width)
+{
+	S32 w = 0;
+	for (; w + 8 <= width; w += 8, in0 += 32, in1 += 32, out += 16)
+	{
+		_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(generate_mip_block2(in0, in1), generate_mip_block2(in0 + 16, in1 + 16)));
+	}
+	return w;
+}
+
+// 8 input pixels (24 bytes) to 4. Sums each lane with the one three lanes
+// along, the output pixels are the sums at lanes 0, 6, 12 and 18.
+template<>
+S32 generate_mip_row_sse<3>(const U8* in0, const U8* in1, U8* out, S32 width)
 {
-	dst[0] = (U8)(((U32)(a[0]) + b[0] + c[0] + d[0])>>2);
-	dst[1] = (U8)(((U32)(a[1]) + b[1] + c[1] + d[1])>>2);
-	dst[2] = (U8)(((U32)(a[2]) + b[2] + c[2] + d[2])>>2);
-	dst[3] = (U8)(((U32)(a[3]) + b[3] + c[3] + d[3])>>2);
+	const __m128i zero = _mm_setzero_si128();
+	LL_ALIGN_16(U8 sums[32]);
+	S32 w = 0;
+	for (; w + 4 <= width; w += 4, in0 += 24, in1 += 24, out += 12)
+	{
+		__m128i l0, l1;
+		mip_sum_rows(in0, in1, l0, l1);
+		const __m128i l2 = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(in0 + 16)), zero),
+										 _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(in1 + 16)), zero));
+		const __m128i h0 = _mm_add_epi16(l0, _mm_or_si128(_mm_srli_si128(l0, 6), _mm_slli_si128(l1, 10)));
+		const __m128i h1 = _mm_add_epi16(l1, _mm_or_si128(_mm_srli_si128(l1, 6), _mm_slli_si128(l2, 10)));
+		const __m128i h2 = _mm_add_epi16(l2, _mm_srli_si128(l2, 6));
+		_mm_store_si128((__m128i*)sums, _mm_packus_epi16(_mm_srli_epi16(h0, 2), _mm_srli_epi16(h1, 2)));
+		_mm_store_si128((__m128i*)(sums + 16), _mm_packus_epi16(_mm_srli_epi16(h2, 2), zero));
+		memcpy(out, sums, 3);
+		memcpy(out + 3, sums + 6, 3);
+		memcpy(out + 6, sums + 12, 3);
+		memcpy(out + 9, sums + 18, 3);
+	}
+	return w;
+}
+
+// 4 input pixels to 2, a pixel is one 64 bit half of sums
+inline __m128i generate_mip_block4(const U8* in0, const U8* in1)
+{
+	__m128i lo, hi;
+	mip_sum_rows(in0, in1, lo, hi);
+	return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi)), 2);
+}
+
+template<>
+S32 generate_mip_row_sse<4>(const U8* in0, const U8* in1, U8* out, S32 width)
+{
+	S32 w = 0;
+	for (; w + 4 <= width; w += 4, in0 += 32, in1 += 32, out += 16)
+	{
+		_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(generate_mip_block4(in0, in1), generate_mip_block4(in0 + 16, in1 + 16)));
+	}
+	return w;
 }
 
-static void avg4_colors3(const U8* a, const U8* b, const U8* c, const U8* d, U8* dst)
+template<S32 nch>
+void generate_mip_rows(const U8* indata, U8* mipdata, S32 width, S32 row_begin, S32 row_end)
 {
-	dst[0] = (U8)(((U32)(a[0]) + b[0] + c[0] + d[0])>>2);
-	dst[1] = (U8)(((U32)(a[1]) + b[1] + c[1] + d[1])>>2);
-	dst[2] = (U8)(((U32)(a[2]) + b[2] + c[2] + d[2])>>2);
+	const S32 in_stride = width * 2 * nch;
+	for (S32 h = row_begin; h < row_end; h++)
+	{
+		const U8* in0 = indata + h * 2 * in_stride;
+		const U8* in1 = in0 + in_stride;
+		U8* out = mipdata + h * width * nch;
+
+		S32 w = generate_mip_row_sse<nch>(in0, in1, out, width);
+		in0 += w * 2 * nch;
+		in1 += w * 2 * nch;
+		out += w * nch;
+		for (; w < width; w++, in0 += 2 * nch, in1 += 2 * nch, out += nch)
+		{
+			for (S32 c = 0; c < nch; c++)
+			{
+				out[c] = (U8)(((U32)(in0[c]) + in0[c + nch] + in1[c] + in1[c + nch]) >> 2);
+			}
+		}
+	}
 }
 
-static void avg4_colors2(const U8* a, const U8* b, const U8* c, const U8* d, U8* dst)
+template<S32 nch>
+void generate_mip(const U8* indata, U8* mipdata, S32 width, S32 height)
 {
-	dst[0] = (U8)(((U32)(a[0]) + b[0] + c[0] + d[0])>>2);
-	dst[1] = (U8)(((U32)(a[1]) + b[1] + c[1] + d[1])>>2);
+	run_row_bands(height, width * height, [&](U32 row_begin, U32 row_end)
+	{
+		generate_mip_rows<nch>(indata, mipdata, width, row_begin, row_end);
+	});
 }
 
 void LLImageBase::setDataAndSize(U8 *data, S32 size)
@@ -2257,33 +2567,22 @@ void LLImageBase::setDataAndSize(U8 *data, S32 size)
 void LLImageBase::generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
 {
 	llassert(width > 0 && height > 0);
-	U8* data = mipdata;
-	S32 in_width = width*2;
-	for (S32 h=0; h<height; h++)
+	switch(nchannels)
 	{
-		for (S32 w=0; w<width; w++)
-		{
-			switch(nchannels)
-			{
-			  case 4:
-				avg4_colors4(indata, indata+4, indata+4*in_width, indata+4*in_width+4, data);
-				break;
-			  case 3:
-				avg4_colors3(indata, indata+3, indata+3*in_width, indata+3*in_width+3, data);
-				break;
-			  case 2:
-				avg4_colors2(indata, indata+2, indata+2*in_width, indata+2*in_width+2, data);
-				break;
-			  case 1:
-				*(U8*)data = (U8)(((U32)(indata[0]) + indata[1] + indata[in_width] + indata[in_width+1])>>2);
-				break;
-			  default:
-				LL_ERRS() << "generateMmip called with bad num channels" << LL_ENDL;
-			}
-			indata += nchannels*2;
-			data += nchannels;
-		}
-		indata += nchannels*in_width; // skip odd lines
+	  case 4:
+		generate_mip<4>(indata, mipdata, width, height);
+		break;
+	  case 3:
+		generate_mip<3>(indata, mipdata, width, height);
+		break;
+	  case 2:
+		generate_mip<2>(indata, mipdata, width, height);
+		break;
+	  case 1:
+		generate_mip<1>(indata, mipdata, width, height);
+		break;
+	  default:
+		LL_ERRS() << "generateMmip called with bad num channels" << LL_ENDL;
 	}
 }
 
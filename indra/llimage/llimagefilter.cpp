@@ -35,6 +35,8 @@
 #include "v3math.h"
 #include "llsdserialize.h"
 #include "llstring.h"
+#include "lljobscheduler.h"
+#include "llsimdmath.h"
 
 //---------------------------------------------------------------------------
 // LLImageFilter
@@ -46,12 +48,7 @@ LLImageFilter::LLImageFilter(const std::string& file_path) :
     mHistoRed(NULL),
     mHistoGreen(NULL),
     mHistoBlue(NULL),
-    mHistoBrightness(NULL),
-    mStencilBlendMode(STENCIL_BLEND_MODE_BLEND),
-    mStencilShape(STENCIL_SHAPE_UNIFORM),
-    mStencilGamma(1.0),
-    mStencilMin(0.0),
-    mStencilMax(1.0)
+    mHistoBrightness(NULL)
 {
     // Load filter description from file
 	llifstream filter_xml(file_path.c_str());
@@ -66,6 +63,10 @@ LLImageFilter::LLImageFilter(const std::string& file_path) :
 
 LLImageFilter::~LLImageFilter()
 {
+    for (S32 i = 0; i < mStages.size(); ++i)
+    {
+        delete mStages[i];
+    }
     mImage = NULL;
     ll_aligned_free_16(mHistoRed);
     ll_aligned_free_16(mHistoGreen);
@@ -269,16 +270,316 @@ void LLImageFilter::executeFilter(LLPointer<LLImageRaw> raw_image)
             LL_WARNS() << "Filter unknown, cannot execute filter command : " << filter_name << LL_ENDL;
         }
     }
+
+    executeStages();
+}
+
+//============================================================================
+// Fused Pipeline
+// Color corrections, color transforms and screens only look at one pixel, so
+// consecutive ones are queued as stages and run together, row by row, once
+// something needs the whole image: a convolution, a histogram or the end of
+// the filter. Each stage keeps the stencil it was queued with, and still
+// rounds to 8 bits like its own pass would, so the result is the same.
+//============================================================================
+
+// Below this many pixels handing bands to the scheduler costs more than it saves
+static const S32 FILTER_BAND_MIN_PIXELS = 256 * 256;
+static const U32 FILTER_BAND_MIN_ROWS = 16;
+
+static LLJobScheduler* get_band_scheduler(const LLImageRaw* image)
+{
+    return (image->getWidth() * image->getHeight() >= FILTER_BAND_MIN_PIXELS ? LLJobScheduler::getDefault() : NULL);
+}
+
+LLImageFilter::Stencil::Stencil() :
+    mBlendMode(STENCIL_BLEND_MODE_BLEND),
+    mShape(STENCIL_SHAPE_UNIFORM),
+    mMin(0.0),
+    mMax(1.0),
+    mCenterX(0),
+    mCenterY(0),
+    mWidth(0),
+    mGamma(1.0),
+    mWavelength(10.0),
+    mSine(0.0),
+    mCosine(1.0),
+    mStartX(0.0),
+    mStartY(0.0),
+    mGradX(0.0),
+    mGradY(0.0),
+    mGradN(1.0)
+{
+}
+
+struct LLImageFilter::Stage
+{
+    enum EType
+    {
+        LUT,
+        TRANSFORM,
+        SCREEN
+    };
+
+    Stage(EType type, const Stencil& stencil) :
+        mType(type),
+        mStencil(stencil),
+        mBlend(true),
+        mScreenMode(SCREEN_MODE_2DSINE),
+        mWaveLength(1.0),
+        mSine(0.0),
+        mCosine(1.0)
+    {
+    }
+
+    void apply(U8* dst_data, S32 j, S32 width, S32 components) const;
+
+    EType mType;
+    Stencil mStencil;
+    bool mBlend;            // false once a uniform stencil blend is folded in the LUTs
+    U8 mLUT[3][256];        // per channel for LUT, mLUT[0] is the gamma table for SCREEN
+    LLMatrix3 mTransform;
+    EScreenMode mScreenMode;
+    F32 mWaveLength;        // in pixels
+    F32 mSine;
+    F32 mCosine;
+};
+
+void LLImageFilter::Stage::apply(U8* dst_data, S32 j, S32 width, S32 components) const
+{
+    const bool uniform = mStencil.isUniform();
+    const F32 uniform_alpha = mStencil.getAlpha(0,0);
+
+    switch (mType)
+    {
+        case LUT:
+            if (!mBlend)
+            {
+                for (S32 i = 0; i < width; i++)
+                {
+                    dst_data[VRED]   = mLUT[VRED][dst_data[VRED]];
+                    dst_data[VGREEN] = mLUT[VGREEN][dst_data[VGREEN]];
+                    dst_data[VBLUE]  = mLUT[VBLUE][dst_data[VBLUE]];
+                    dst_data += components;
+                }
+                break;
+            }
+            for (S32 i = 0; i < width; i++)
+            {
+                mStencil.blend(uniform ? uniform_alpha : mStencil.getAlpha(i,j), dst_data,
+                               mLUT[VRED][dst_data[VRED]], mLUT[VGREEN][dst_data[VGREEN]], mLUT[VBLUE][dst_data[VBLUE]]);
+                dst_data += components;
+            }
+            break;
+        case TRANSFORM:
+            for (S32 i = 0; i < width; i++)
+            {
+                LLVector3 src((F32)(dst_data[VRED]),(F32)(dst_data[VGREEN]),(F32)(dst_data[VBLUE]));
+                LLVector3 dst = src * mTransform;
+                dst.clamp(0.0f,255.0f);
+                mStencil.blend(uniform ? uniform_alpha : mStencil.getAlpha(i,j), dst_data, dst.mV[VRED], dst.mV[VGREEN], dst.mV[VBLUE]);
+                dst_data += components;
+            }
+            break;
+        case SCREEN:
+            for (S32 i = 0; i < width; i++)
+            {
+                F32 value = 0.0;
+                F32 di = 0.0;
+                F32 dj = 0.0;
+                switch (mScreenMode)
+                {
+                    case SCREEN_MODE_2DSINE:
+                        di =  mCosine*i + mSine*j;
+                        dj = -mSine*i + mCosine*j;
+                        value = (sinf(2*F_PI*di/mWaveLength)*sinf(2*F_PI*dj/mWaveLength)+1.0)*255.0/2.0;
+                        break;
+                    case SCREEN_MODE_LINE:
+                        dj = mSine*i - mCosine*j;
+                        value = (sinf(2*F_PI*dj/mWaveLength)+1.0)*255.0/2.0;
+                        break;
+                }
+                U8 dst_value = (dst_data[VRED] >= (U8)(value) ? mLUT[0][dst_data[VRED] - (U8)(value)] : 0);
+                mStencil.blend(uniform ? uniform_alpha : mStencil.getAlpha(i,j), dst_data, dst_value, dst_value, dst_value);
+                dst_data += components;
+            }
+            break;
+    }
+}
+
+void LLImageFilter::addStage(Stage* stage)
+{
+    if ((stage->mType == Stage::LUT) && stage->mStencil.isUniform())
+    {
+        // With a uniform stencil the blend only depends on the channel value: fold it in the LUTs
+        F32 alpha = stage->mStencil.getAlpha(0,0);
+        for (S32 i = 0; i < 256; i++)
+        {
+            U8 pixel[3] = { (U8)(i), (U8)(i), (U8)(i) };
+            stage->mStencil.blend(alpha, pixel, stage->mLUT[VRED][i], stage->mLUT[VGREEN][i], stage->mLUT[VBLUE][i]);
+            stage->mLUT[VRED][i]   = pixel[VRED];
+            stage->mLUT[VGREEN][i] = pixel[VGREEN];
+            stage->mLUT[VBLUE][i]  = pixel[VBLUE];
+        }
+        stage->mBlend = false;
+
+        // and chain it onto a previous plain LUT
+        Stage* previous = (mStages.empty() ? NULL : mStages.back());
+        if (previous && (previous->mType == Stage::LUT) && !previous->mBlend)
+        {
+            for (S32 c = 0; c < 3; c++)
+            {
+                for (S32 i = 0; i < 256; i++)
+                {
+                    previous->mLUT[c][i] = stage->mLUT[c][previous->mLUT[c][i]];
+                }
+            }
+            delete stage;
+            return;
+        }
+    }
+    mStages.push_back(stage);
+}
+
+void LLImageFilter::executeStages()
+{
+    if (mStages.empty())
+    {
+        return;
+    }
+
+    const S32 components = mImage->getComponents();
+    llassert( components >= 1 && components <= 4 );
+
+    const S32 width = mImage->getWidth();
+    const S32 row_size = width * components;
+    U8* data = mImage->getData();
+    const std::vector<Stage*>& stages = mStages;
+    ll_parallel_for(get_band_scheduler(mImage), mImage->getHeight(), FILTER_BAND_MIN_ROWS, [&](U32 row_begin, U32 row_end)
+    {
+        for (S32 j = row_begin; j < row_end; j++)
+        {
+            for (S32 k = 0; k < stages.size(); k++)
+            {
+                stages[k]->apply(data + j * row_size, j, width, components);
+            }
+        }
+    });
+
+    for (S32 k = 0; k < mStages.size(); k++)
+    {
+        delete mStages[k];
+    }
+    mStages.clear();
+}
+
+// Same as the pass in convolve() for rows [row_begin, row_end) of dst_image, reading from src, a copy of it.
+// The three channels of a pixel are summed in SSE lanes, in the same order, so the result is the same.
+void LLImageFilter::convolveBand(const U8* src, U8* dst_image, const LLMatrix3 &kernel, bool normalize, bool abs_value,
+                                 F32 kernel_min, F32 kernel_range, S32 row_begin, S32 row_end) const
+{
+    const S32 components = mImage->getComponents();
+    const S32 width  = mImage->getWidth();
+    const S32 height = mImage->getHeight();
+    const S32 row_size = width * components;
+    const bool uniform = mStencil.isUniform();
+    const F32 uniform_alpha = mStencil.getAlpha(0,0);
+
+    __m128 k[NUM_VALUES_IN_MAT3 * NUM_VALUES_IN_MAT3];
+    for (S32 m = 0; m < NUM_VALUES_IN_MAT3; m++)
+    {
+        for (S32 n = 0; n < NUM_VALUES_IN_MAT3; n++)
+        {
+            k[m * NUM_VALUES_IN_MAT3 + n] = _mm_set1_ps(kernel.mMatrix[m][n]);
+        }
+    }
+    const __m128 k_min = _mm_set1_ps(kernel_min);
+    const __m128 k_range = _mm_set1_ps(kernel_range);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max = _mm_set1_ps(255.f);
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    // Source rows as one float pixel per register, row r in slot r % 3
+    __m128* rows = (__m128*) ll_aligned_malloc_16(3 * width * sizeof(__m128));
+    S32 loaded = row_begin - 2;
+
+    for (S32 j = row_begin; j < row_end; j++)
+    {
+        U8* dst_data = dst_image + j * row_size;
+        if ((j == 0) || (j == height - 1))
+        {
+            // First and last lines are set to 0, with the stencil of the first
+            for (S32 i = 0; i < width; i++)
+            {
+                mStencil.blend(uniform ? uniform_alpha : mStencil.getAlpha(i,0), dst_data, 0, 0, 0);
+                dst_data += components;
+            }
+            continue;
+        }
+
+        for (S32 r = llmax(j - 1, loaded + 1); r <= j + 1; r++)
+        {
+            const U8* src_data = src + r * row_size;
+            __m128* row = rows + (r % 3) * width;
+            for (S32 i = 0; i < width; i++)
+            {
+                U32 bits = 0;
+                memcpy(&bits, src_data, llmin(components, 4));
+                __m128i pixel = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bits), _mm_setzero_si128());
+                row[i] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixel, _mm_setzero_si128()));
+                src_data += components;
+            }
+        }
+        loaded = j + 1;
+
+        const __m128* north = rows + ((j - 1) % 3) * width;
+        const __m128* center = rows + (j % 3) * width;
+        const __m128* south = rows + ((j + 1) % 3) * width;
+
+        // First pixel : set to 0
+        mStencil.blend(mStencil.getAlpha(0,j), dst_data, 0, 0, 0);
+        dst_data += components;
+        for (S32 i = 1; i < (width-1); i++)
+        {
+            __m128 dst = _mm_mul_ps(k[0], north[i-1]);
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[1], north[i]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[2], north[i+1]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[3], center[i-1]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[4], center[i]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[5], center[i+1]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[6], south[i-1]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[7], south[i]));
+            dst = _mm_add_ps(dst, _mm_mul_ps(k[8], south[i+1]));
+            if (abs_value)
+            {
+                dst = _mm_and_ps(dst, abs_mask);
+            }
+            if (normalize)
+            {
+                dst = _mm_div_ps(_mm_sub_ps(dst, k_min), k_range);
+            }
+            dst = _mm_min_ps(_mm_max_ps(dst, zero), max);
+
+            LL_ALIGN_16(S32 value[4]);
+            _mm_store_si128((__m128i*)value, _mm_cvttps_epi32(dst));
+            mStencil.blend(uniform ? uniform_alpha : mStencil.getAlpha(i,j), dst_data, value[VRED], value[VGREEN], value[VBLUE]);
+            dst_data += components;
+        }
+        // Last pixel : set to 0
+        mStencil.blend(mStencil.getAlpha(width-1,j), dst_image + j * row_size + (width-1) * components, 0, 0, 0);
+    }
+
+    ll_aligned_free_16(rows);
 }
 
 //============================================================================
 // Filter Primitives
 //============================================================================
 
-void LLImageFilter::blendStencil(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue)
+void LLImageFilter::Stencil::blend(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue) const
 {
     F32 inv_alpha = 1.0 - alpha;
-    switch (mStencilBlendMode)
+    switch (mBlendMode)
     {
         case STENCIL_BLEND_MODE_BLEND:
             // Classic blend of incoming color with the background image
@@ -309,47 +610,18 @@ void LLImageFilter::blendStencil(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue
 
 void LLImageFilter::colorCorrect(const U8* lut_red, const U8* lut_green, const U8* lut_blue)
 {
-	const S32 components = mImage->getComponents();
-	llassert( components >= 1 && components <= 4 );
-    
-	S32 width  = mImage->getWidth();
-    S32 height = mImage->getHeight();
-    
-	U8* dst_data = mImage->getData();
-	for (S32 j = 0; j < height; j++)
-	{
-        for (S32 i = 0; i < width; i++)
-        {
-            // Blend LUT value
-            blendStencil(getStencilAlpha(i,j), dst_data, lut_red[dst_data[VRED]], lut_green[dst_data[VGREEN]], lut_blue[dst_data[VBLUE]]);
-            dst_data += components;
-        }
-	}
+    Stage* stage = new Stage(Stage::LUT, mStencil);
+    memcpy(stage->mLUT[VRED], lut_red, 256);
+    memcpy(stage->mLUT[VGREEN], lut_green, 256);
+    memcpy(stage->mLUT[VBLUE], lut_blue, 256);
+    addStage(stage);
 }
 
 void LLImageFilter::colorTransform(const LLMatrix3 &transform)
 {
-	const S32 components = mImage->getComponents();
-	llassert( components >= 1 && components <= 4 );
-    
-	S32 width  = mImage->getWidth();
-    S32 height = mImage->getHeight();
-    
-	U8* dst_data = mImage->getData();
-	for (S32 j = 0; j < height; j++)
-	{
-        for (S32 i = 0; i < width; i++)
-        {
-            // Compute transform
-            LLVector3 src((F32)(dst_data[VRED]),(F32)(dst_data[VGREEN]),(F32)(dst_data[VBLUE]));
-            LLVector3 dst = src * transform;
-            dst.clamp(0.0f,255.0f);
-            
-            // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, dst.mV[VRED], dst.mV[VGREEN], dst.mV[VBLUE]);
-            dst_data += components;
-        }
-	}
+    Stage* stage = new Stage(Stage::TRANSFORM, mStencil);
+    stage->mTransform = transform;
+    addStage(stage);
 }
 
 void LLImageFilter::convolve(const LLMatrix3 &kernel, bool normalize, bool abs_value)
@@ -378,125 +650,22 @@ void LLImageFilter::convolve(const LLMatrix3 &kernel, bool normalize, bool abs_v
         kernel_min = 0.0;
     }
     F32 kernel_range = kernel_max - kernel_min;
-    
-    // Allocate temporary buffers and initialize algorithm's data
-	S32 width  = mImage->getWidth();
-    S32 height = mImage->getHeight();
-    
-	U8* dst_data = mImage->getData();
 
-	S32 buffer_size = width * components;
-	llassert_always(buffer_size > 0);
-	std::vector<U8> even_buffer(buffer_size);
-	std::vector<U8> odd_buffer(buffer_size);
-	
-    U8* south_data = dst_data + buffer_size;
-    U8* east_west_data;
-    U8* north_data;
-    
-    // Line 0 : we set the line to 0 (debatable)
-    memcpy( &even_buffer[0], dst_data, buffer_size );	/* Flawfinder: ignore */
-    for (S32 i = 0; i < width; i++)
-    {
-        blendStencil(getStencilAlpha(i,0), dst_data, 0, 0, 0);
-        dst_data += components;
-    }
-    south_data += buffer_size;
-    
-    // All other lines
-    for (S32 j = 1; j < (height-1); j++)
-	{
-        // We need to buffer 2 lines. We flip north and east-west (current) to avoid moving too much memory around
-        if (j % 2)
-        {
-            memcpy( &odd_buffer[0], dst_data, buffer_size );	/* Flawfinder: ignore */
-            east_west_data = &odd_buffer[0];
-            north_data = &even_buffer[0];
-        }
-        else
-        {
-            memcpy( &even_buffer[0], dst_data, buffer_size );	/* Flawfinder: ignore */
-            east_west_data = &even_buffer[0];
-            north_data = &odd_buffer[0];
-        }
-        // First pixel : set to 0
-        blendStencil(getStencilAlpha(0,j), dst_data, 0, 0, 0);
-        dst_data += components;
-        // Set pointers to kernel
-        U8* NW = north_data;
-        U8* N = NW+components;
-        U8* NE = N+components;
-        U8* W = east_west_data;
-        U8* C = W+components;
-        U8* E = C+components;
-        U8* SW = south_data;
-        U8* S = SW+components;
-        U8* SE = S+components;
-        // All other pixels
-        for (S32 i = 1; i < (width-1); i++)
-        {
-            // Compute convolution
-            LLVector3 dst;
-            dst.mV[VRED] = (kernel.mMatrix[0][0]*NW[VRED] + kernel.mMatrix[0][1]*N[VRED] + kernel.mMatrix[0][2]*NE[VRED] +
-                            kernel.mMatrix[1][0]*W[VRED]  + kernel.mMatrix[1][1]*C[VRED] + kernel.mMatrix[1][2]*E[VRED] +
-                            kernel.mMatrix[2][0]*SW[VRED] + kernel.mMatrix[2][1]*S[VRED] + kernel.mMatrix[2][2]*SE[VRED]);
-            dst.mV[VGREEN] = (kernel.mMatrix[0][0]*NW[VGREEN] + kernel.mMatrix[0][1]*N[VGREEN] + kernel.mMatrix[0][2]*NE[VGREEN] +
-                              kernel.mMatrix[1][0]*W[VGREEN]  + kernel.mMatrix[1][1]*C[VGREEN] + kernel.mMatrix[1][2]*E[VGREEN] +
-                              kernel.mMatrix[2][0]*SW[VGREEN] + kernel.mMatrix[2][1]*S[VGREEN] + kernel.mMatrix[2][2]*SE[VGREEN]);
-            dst.mV[VBLUE] = (kernel.mMatrix[0][0]*NW[VBLUE] + kernel.mMatrix[0][1]*N[VBLUE] + kernel.mMatrix[0][2]*NE[VBLUE] +
-                             kernel.mMatrix[1][0]*W[VBLUE]  + kernel.mMatrix[1][1]*C[VBLUE] + kernel.mMatrix[1][2]*E[VBLUE] +
-                             kernel.mMatrix[2][0]*SW[VBLUE] + kernel.mMatrix[2][1]*S[VBLUE] + kernel.mMatrix[2][2]*SE[VBLUE]);
-            if (abs_value)
-            {
-                dst.mV[VRED]   = llabs(dst.mV[VRED]);
-                dst.mV[VGREEN] = llabs(dst.mV[VGREEN]);
-                dst.mV[VBLUE]  = llabs(dst.mV[VBLUE]);
-            }
-            if (normalize)
-            {
-                dst.mV[VRED]   = (dst.mV[VRED] - kernel_min)/kernel_range;
-                dst.mV[VGREEN] = (dst.mV[VGREEN] - kernel_min)/kernel_range;
-                dst.mV[VBLUE]  = (dst.mV[VBLUE] - kernel_min)/kernel_range;
-            }
-            dst.clamp(0.0f,255.0f);
-            
-            // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, dst.mV[VRED], dst.mV[VGREEN], dst.mV[VBLUE]);
-            
-            // Next pixel
-            dst_data += components;
-            NW += components;
-            N += components;
-            NE += components;
-            W += components;
-            C += components;
-            E += components;
-            SW += components;
-            S += components;
-            SE += components;
-        }
-        // Last pixel : set to 0
-        blendStencil(getStencilAlpha(width-1,j), dst_data, 0, 0, 0);
-        dst_data += components;
-        south_data += buffer_size;
-	}
-    
-    // Last line
-    for (S32 i = 0; i < width; i++)
+    executeStages();
+
+    // Bands read their neighbour rows from a copy of the image
+    U8* image_data = mImage->getData();
+    std::vector<U8> src(image_data, image_data + mImage->getWidth() * mImage->getHeight() * components);
+    ll_parallel_for(get_band_scheduler(mImage), mImage->getHeight(), FILTER_BAND_MIN_ROWS, [&](U32 row_begin, U32 row_end)
     {
-        blendStencil(getStencilAlpha(i,0), dst_data, 0, 0, 0);
-        dst_data += components;
-    }
+        convolveBand(&src[0], image_data, kernel, normalize, abs_value, kernel_min, kernel_range, row_begin, row_end);
+    });
 }
 
 void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const F32 angle)
 {
-	const S32 components = mImage->getComponents();
-	llassert( components >= 1 && components <= 4 );
-    
-	S32 width  = mImage->getWidth();
     S32 height = mImage->getHeight();
-    
+
     F32 wave_length_pixels = wave_length * (F32)(height) / 2.0;
     F32 sin = sinf(angle*DEG_TO_RAD);
     F32 cos = cosf(angle*DEG_TO_RAD);
@@ -508,35 +677,14 @@ void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const
         F32 gamma_i = llclampf((float)(powf((float)(i)/255.0,1.0/4.0)));
         gamma[i] = (U8)(255.0 * gamma_i);
     }
-    
-	U8* dst_data = mImage->getData();
-	for (S32 j = 0; j < height; j++)
-	{
-        for (S32 i = 0; i < width; i++)
-        {
-            // Compute screen value
-            F32 value = 0.0;
-            F32 di = 0.0;
-            F32 dj = 0.0;
-            switch (mode)
-            {
-                case SCREEN_MODE_2DSINE:
-                    di =  cos*i + sin*j;
-                    dj = -sin*i + cos*j;
-                    value = (sinf(2*F_PI*di/wave_length_pixels)*sinf(2*F_PI*dj/wave_length_pixels)+1.0)*255.0/2.0;
-                    break;
-                case SCREEN_MODE_LINE:
-                    dj = sin*i - cos*j;
-                    value = (sinf(2*F_PI*dj/wave_length_pixels)+1.0)*255.0/2.0;
-                    break;
-            }
-            U8 dst_value = (dst_data[VRED] >= (U8)(value) ? gamma[dst_data[VRED] - (U8)(value)] : 0);
-            
-            // Blend result
-            blendStencil(getStencilAlpha(i,j), dst_data, dst_value, dst_value, dst_value);
-            dst_data += components;
-        }
-	}
+
+    Stage* stage = new Stage(Stage::SCREEN, mStencil);
+    memcpy(stage->mLUT[0], gamma, 256);
+    stage->mScreenMode = mode;
+    stage->mWaveLength = wave_length_pixels;
+    stage->mSine = sin;
+    stage->mCosine = cos;
+    addStage(stage);
 }
 
 //============================================================================
@@ -544,55 +692,55 @@ void LLImageFilter::filterScreen(EScreenMode mode, const F32 wave_length, const
 //============================================================================
 void LLImageFilter::setStencil(EStencilShape shape, EStencilBlendMode mode, F32 min, F32 max, F32* params)
 {
-    mStencilShape = shape;
-    mStencilBlendMode = mode;
-    mStencilMin = llmin(llmax(min, -1.0f), 1.0f);
-    mStencilMax = llmin(llmax(max, -1.0f), 1.0f);
+    mStencil.mShape = shape;
+    mStencil.mBlendMode = mode;
+    mStencil.mMin = llmin(llmax(min, -1.0f), 1.0f);
+    mStencil.mMax = llmin(llmax(max, -1.0f), 1.0f);
     
     // Each shape will interpret the 4 params differenly.
     // We compute each systematically, though, clearly, values are meaningless when the shape doesn't correspond to the parameters
-    mStencilCenterX = (S32)(mImage->getWidth()  + params[0] * (F32)(mImage->getHeight()))/2;
-    mStencilCenterY = (S32)(mImage->getHeight() + params[1] * (F32)(mImage->getHeight()))/2;
-    mStencilWidth = (S32)(params[2] * (F32)(mImage->getHeight()))/2;
-    mStencilGamma = (params[3] <= 0.0 ? 1.0 : params[3]);
+    mStencil.mCenterX = (S32)(mImage->getWidth()  + params[0] * (F32)(mImage->getHeight()))/2;
+    mStencil.mCenterY = (S32)(mImage->getHeight() + params[1] * (F32)(mImage->getHeight()))/2;
+    mStencil.mWidth = (S32)(params[2] * (F32)(mImage->getHeight()))/2;
+    mStencil.mGamma = (params[3] <= 0.0 ? 1.0 : params[3]);
 
-    mStencilWavelength = (params[0] <= 0.0 ? 10.0 : params[0] * (F32)(mImage->getHeight()) / 2.0);
-    mStencilSine   = sinf(params[1]*DEG_TO_RAD);
-    mStencilCosine = cosf(params[1]*DEG_TO_RAD);
+    mStencil.mWavelength = (params[0] <= 0.0 ? 10.0 : params[0] * (F32)(mImage->getHeight()) / 2.0);
+    mStencil.mSine   = sinf(params[1]*DEG_TO_RAD);
+    mStencil.mCosine = cosf(params[1]*DEG_TO_RAD);
 
-    mStencilStartX = ((F32)(mImage->getWidth())  + params[0] * (F32)(mImage->getHeight()))/2.0;
-    mStencilStartY = ((F32)(mImage->getHeight()) + params[1] * (F32)(mImage->getHeight()))/2.0;
+    mStencil.mStartX = ((F32)(mImage->getWidth())  + params[0] * (F32)(mImage->getHeight()))/2.0;
+    mStencil.mStartY = ((F32)(mImage->getHeight()) + params[1] * (F32)(mImage->getHeight()))/2.0;
     F32 end_x      = ((F32)(mImage->getWidth())  + params[2] * (F32)(mImage->getHeight()))/2.0;
     F32 end_y      = ((F32)(mImage->getHeight()) + params[3] * (F32)(mImage->getHeight()))/2.0;
-    mStencilGradX  = end_x - mStencilStartX;
-    mStencilGradY  = end_y - mStencilStartY;
-    mStencilGradN  = mStencilGradX*mStencilGradX + mStencilGradY*mStencilGradY;
+    mStencil.mGradX  = end_x - mStencil.mStartX;
+    mStencil.mGradY  = end_y - mStencil.mStartY;
+    mStencil.mGradN  = mStencil.mGradX*mStencil.mGradX + mStencil.mGradY*mStencil.mGradY;
 }
 
-F32 LLImageFilter::getStencilAlpha(S32 i, S32 j)
+F32 LLImageFilter::Stencil::getAlpha(S32 i, S32 j) const
 {
     F32 alpha = 1.0;    // That init actually takes care of the STENCIL_SHAPE_UNIFORM case...
-    if (mStencilShape == STENCIL_SHAPE_VIGNETTE)
+    if (mShape == STENCIL_SHAPE_VIGNETTE)
     {
         // alpha is a modified gaussian value, with a center and fading in a circular pattern toward the edges
         // The gamma parameter controls the intensity of the drop down from alpha 1.0 (center) to 0.0
-        F32 d_center_square = (i - mStencilCenterX)*(i - mStencilCenterX) + (j - mStencilCenterY)*(j - mStencilCenterY);
-        alpha = powf(F_E, -(powf((d_center_square/(mStencilWidth*mStencilWidth)),mStencilGamma)/2.0f));
+        F32 d_center_square = (i - mCenterX)*(i - mCenterX) + (j - mCenterY)*(j - mCenterY);
+        alpha = powf(F_E, -(powf((d_center_square/(mWidth*mWidth)),mGamma)/2.0f));
     }
-    else if (mStencilShape == STENCIL_SHAPE_SCAN_LINES)
+    else if (mShape == STENCIL_SHAPE_SCAN_LINES)
     {
         // alpha varies according to a squared sine function.
-        F32 d = mStencilSine*i - mStencilCosine*j;
-        alpha = (sinf(2*F_PI*d/mStencilWavelength) > 0.0 ? 1.0 : 0.0);
+        F32 d = mSine*i - mCosine*j;
+        alpha = (sinf(2*F_PI*d/mWavelength) > 0.0 ? 1.0 : 0.0);
     }
-    else if (mStencilShape == STENCIL_SHAPE_GRADIENT)
+    else if (mShape == STENCIL_SHAPE_GRADIENT)
     {
-        alpha = (((F32)(i) - mStencilStartX)*mStencilGradX + ((F32)(j) - mStencilStartY)*mStencilGradY) / mStencilGradN;
+        alpha = (((F32)(i) - mStartX)*mGradX + ((F32)(j) - mStartY)*mGradY) / mGradN;
         alpha = llclampf(alpha);
     }
     
     // We rescale alpha between min and max
-    return (mStencilMin + alpha * (mStencilMax - mStencilMin));
+    return (mMin + alpha * (mMax - mMin));
 }
 
 //============================================================================
@@ -603,6 +751,7 @@ U32* LLImageFilter::getBrightnessHistogram()
 {
     if (!mHistoBrightness)
     {
+        executeStages();
         computeHistograms();
     }
     return mHistoBrightness;
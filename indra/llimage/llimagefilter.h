@@ -64,6 +64,8 @@ typedef enum e_screen_mode
 class LLImageFilter
 {
 public:
+    // Consecutive per pixel steps run together in one threaded pass over the image
+    // and convolutions are vectorized.
     LLImageFilter(const std::string& file_path);
     ~LLImageFilter();
     
@@ -91,12 +93,17 @@ private:
     void colorTransform(const LLMatrix3 &transform);
     void colorCorrect(const U8* lut_red, const U8* lut_green, const U8* lut_blue);
     void filterScreen(EScreenMode mode, const F32 wave_length, const F32 angle);
-    void blendStencil(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue);
     void convolve(const LLMatrix3 &kernel, bool normalize, bool abs_value);
 
     // Procedural Stencils
     void setStencil(EStencilShape shape, EStencilBlendMode mode, F32 min, F32 max, F32* params);
-    F32 getStencilAlpha(S32 i, S32 j);
+
+    // Fused pipeline
+    struct Stage;
+    void addStage(Stage* stage);
+    void executeStages();
+    void convolveBand(const U8* src, U8* dst_image, const LLMatrix3 &kernel, bool normalize, bool abs_value,
+                      F32 kernel_min, F32 kernel_range, S32 row_begin, S32 row_end) const;
 
     // Histograms
     U32* getBrightnessHistogram();
@@ -111,26 +118,38 @@ private:
     U32 *mHistoBlue;
     U32 *mHistoBrightness;
     
-    // Current Stencil Settings
-    EStencilBlendMode mStencilBlendMode;
-    EStencilShape mStencilShape;
-    F32 mStencilMin;
-    F32 mStencilMax;
-    
-    S32 mStencilCenterX;
-    S32 mStencilCenterY;
-    S32 mStencilWidth;
-    F32 mStencilGamma;
-    
-    F32 mStencilWavelength;
-    F32 mStencilSine;
-    F32 mStencilCosine;
-    
-    F32 mStencilStartX;
-    F32 mStencilStartY;
-    F32 mStencilGradX;
-    F32 mStencilGradY;
-    F32 mStencilGradN;
+    // Current Stencil Settings, copied into each fused stage
+    struct Stencil
+    {
+        Stencil();
+
+        F32 getAlpha(S32 i, S32 j) const;
+        void blend(F32 alpha, U8* pixel, U8 red, U8 green, U8 blue) const;
+        bool isUniform() const { return mShape == STENCIL_SHAPE_UNIFORM; }
+
+        EStencilBlendMode mBlendMode;
+        EStencilShape mShape;
+        F32 mMin;
+        F32 mMax;
+
+        S32 mCenterX;
+        S32 mCenterY;
+        S32 mWidth;
+        F32 mGamma;
+
+        F32 mWavelength;
+        F32 mSine;
+        F32 mCosine;
+
+        F32 mStartX;
+        F32 mStartY;
+        F32 mGradX;
+        F32 mGradY;
+        F32 mGradN;
+    };
+    Stencil mStencil;
+
+    std::vector<Stage*> mStages; // per pixel steps not applied yet
 };
 
 
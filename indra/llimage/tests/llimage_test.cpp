@@ -0,0 +1,246 @@
+/**
+ * @file llimage_test.cpp
+ * @brief Tests and benchmark for LLImageRaw resampling and mip generation.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llimage.h"
+
+#include "lljobscheduler.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	LLPointer<LLImageRaw> make_image(S32 width, S32 height, S32 components, U32 seed)
+	{
+		LLPointer<LLImageRaw> raw = new LLImageRaw(width, height, components);
+		U8* data = raw->getData();
+		for (S32 i = 0; i < raw->getDataSize(); ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			data[i] = (U8)(seed >> 16);
+		}
+		return raw;
+	}
+
+	bool same_image(const LLImageRaw* a, const LLImageRaw* b)
+	{
+		return a->getWidth() == b->getWidth()
+			&& a->getHeight() == b->getHeight()
+			&& a->getComponents() == b->getComponents()
+			&& 0 == memcmp(a->getData(), b->getData(), a->getDataSize());
+	}
+
+	// Single channel images take the plain integer path, channel by channel
+	// it does the same math the vectorized paths do for a whole pixel.
+	LLPointer<LLImageRaw> reference_scaled(LLImageRaw* src, S32 width, S32 height)
+	{
+		const S32 components = src->getComponents();
+		const S32 src_pixels = src->getWidth() * src->getHeight();
+		LLPointer<LLImageRaw> result = new LLImageRaw(width, height, components);
+		for (S32 c = 0; c < components; ++c)
+		{
+			LLPointer<LLImageRaw> plane = new LLImageRaw(src->getWidth(), src->getHeight(), 1);
+			for (S32 i = 0; i < src_pixels; ++i)
+			{
+				plane->getData()[i] = src->getData()[i * components + c];
+			}
+			plane->scale(width, height);
+			for (S32 i = 0; i < width * height; ++i)
+			{
+				result->getData()[i * components + c] = plane->getData()[i];
+			}
+		}
+		return result;
+	}
+
+	// generateMip() as it was, one pixel at a time
+	void reference_mip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
+	{
+		const S32 in_stride = width * 2 * nchannels;
+		for (S32 h = 0; h < height; ++h)
+		{
+			for (S32 w = 0; w < width; ++w)
+			{
+				for (S32 c = 0; c < nchannels; ++c)
+				{
+					*mipdata++ = (U8)(((U32)indata[c] + indata[c + nchannels] + indata[c + in_stride] + indata[c + in_stride + nchannels]) >> 2);
+				}
+				indata += nchannels * 2;
+			}
+			indata += in_stride;
+		}
+	}
+}
+
+namespace tut
+{
+	struct image_resample
+	{
+		image_resample()
+		{
+			if (!LLImage::instanceExists())
+			{
+				LLImage::initParamSingleton(false, 75);
+			}
+		}
+
+		~image_resample()
+		{
+			LLJobScheduler::cleanupClass();
+		}
+	};
+
+	typedef test_group<image_resample> image_resample_test;
+	typedef image_resample_test::object image_resample_t;
+	image_resample_test tut_image_resample("LLImageResample");
+
+	// scaling 3 and 4 channel images matches the per channel integer path
+	template<> template<>
+	void image_resample_t::test<1>()
+	{
+		const S32 CASES = 7;
+		const S32 sizes[CASES][4] = {
+			{ 256, 256, 128, 128 },		// down
+			{ 300, 200, 97, 61 },		// down, odd ratio
+			{ 64, 48, 256, 192 },		// up
+			{ 33, 17, 100, 51 },		// up, odd ratio
+			{ 256, 64, 100, 128 },		// down in x, up in y
+			{ 64, 256, 128, 100 },		// up in x, down in y
+			{ 5, 3, 2, 1 },
+		};
+
+		for (S32 components = 3; components <= 4; ++components)
+		{
+			for (S32 i = 0; i < CASES; ++i)
+			{
+				LLPointer<LLImageRaw> src = make_image(sizes[i][0], sizes[i][1], components, i);
+				LLPointer<LLImageRaw> expected = reference_scaled(src, sizes[i][2], sizes[i][3]);
+
+				std::string name = llformat("%d channels, %dx%d to %dx%d", components, sizes[i][0], sizes[i][1], sizes[i][2], sizes[i][3]);
+				LLPointer<LLImageRaw> scaled = src->scaled(sizes[i][2], sizes[i][3]);
+				ensure(name + " scaled", same_image(scaled, expected));
+
+				LLPointer<LLImageRaw> copied = new LLImageRaw(sizes[i][2], sizes[i][3], components);
+				copied->copyScaled(src);
+				ensure(name + " copyScaled", same_image(copied, expected));
+
+				ensure(name + " scale", src->scale(sizes[i][2], sizes[i][3]));
+				ensure(name + " scale in place", same_image(src, expected));
+			}
+		}
+	}
+
+	// mips of 1 to 4 channel images match the one pixel at a time version
+	template<> template<>
+	void image_resample_t::test<2>()
+	{
+		const S32 CASES = 4;
+		const S32 sizes[CASES][2] = { { 128, 64 }, { 37, 5 }, { 3, 9 }, { 1, 1 } };
+
+		for (S32 components = 1; components <= 4; ++components)
+		{
+			for (S32 i = 0; i < CASES; ++i)
+			{
+				const S32 width = sizes[i][0];
+				const S32 height = sizes[i][1];
+				LLPointer<LLImageRaw> src = make_image(width * 2, height * 2, components, i);
+				std::vector<U8> mip(width * height * components);
+				std::vector<U8> expected(mip.size());
+
+				LLImageBase::generateMip(src->getData(), &mip[0], width, height, components);
+				reference_mip(src->getData(), &expected[0], width, height, components);
+				ensure(llformat("%d channels, %dx%d", components, width, height), mip == expected);
+			}
+		}
+	}
+
+	// large images split in bands across the job scheduler come out the same
+	template<> template<>
+	void image_resample_t::test<3>()
+	{
+		LLPointer<LLImageRaw> src = make_image(1024, 1024, 4, 7);
+		LLPointer<LLImageRaw> serial_down = src->scaled(700, 300);
+		LLPointer<LLImageRaw> serial_up = src->scaled(1500, 1100);
+		std::vector<U8> serial_mip(512 * 512 * 4);
+		LLImageBase::generateMip(src->getData(), &serial_mip[0], 512, 512, 4);
+
+		LLJobScheduler::initClass(3);
+		ensure("scheduler", LLJobScheduler::getDefault() != NULL);
+		ensure("banded down", same_image(src->scaled(700, 300), serial_down));
+		ensure("banded up", same_image(src->scaled(1500, 1100), serial_up));
+		std::vector<U8> banded_mip(serial_mip.size());
+		LLImageBase::generateMip(src->getData(), &banded_mip[0], 512, 512, 4);
+		ensure("banded mip", banded_mip == serial_mip);
+	}
+
+	// resampling and mip times, 256 to 4096 pixels, without and with the scheduler
+	template<> template<>
+	void image_resample_t::test<4>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 SIZES = 5;
+		const S32 sizes[SIZES] = { 256, 512, 1024, 2048, 4096 };
+
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			if (pass)
+			{
+				LLJobScheduler::initClass();
+			}
+
+			for (S32 s = 0; s < SIZES; ++s)
+			{
+				const S32 size = sizes[s];
+				LLPointer<LLImageRaw> src = make_image(size, size, 4, s);
+				std::vector<U8> mip(size / 2 * size / 2 * 4);
+
+				LLTimer timer;
+				LLPointer<LLImageRaw> down = src->scaled(size / 2, size / 2);
+				F64 down_time = timer.getElapsedTimeF64();
+
+				timer.reset();
+				LLPointer<LLImageRaw> up = down->scaled(size, size);
+				F64 up_time = timer.getElapsedTimeF64();
+
+				timer.reset();
+				LLImageBase::generateMip(src->getData(), &mip[0], size / 2, size / 2, 4);
+				F64 mip_time = timer.getElapsedTimeF64();
+
+				timer.reset();
+				reference_mip(src->getData(), &mip[0], size / 2, size / 2, 4);
+				F64 reference_mip_time = timer.getElapsedTimeF64();
+
+				ensure("scaled", down.notNull() && up.notNull());
+				LL_INFOS() << llformat("LLImageRaw %s: %dx%d RGBA, scale down %.2f ms, scale up %.2f ms, mip %.2f ms (one pixel at a time %.2f ms)",
+									   pass ? "banded" : "serial", size, size, down_time * 1000.0, up_time * 1000.0,
+									   mip_time * 1000.0, reference_mip_time * 1000.0) << LL_ENDL;
+			}
+		}
+	}
+}
@@ -351,19 +351,41 @@ void* LLPluginMessage::getValuePointer(const std::string &key) const
 /**
  *	Flatten the message into a string.
  *
+ * @param[in] format Serialized form to use.  Binary messages may contain NUL bytes.
  * @return Message as a string.
  */
-std::string LLPluginMessage::generate(void) const
+std::string LLPluginMessage::generate(EFormat format) const
 {
 	std::ostringstream result;
 	
-	// Pretty XML may be slightly easier to deal with while debugging...
-//	LLSDSerialize::toXML(mMessage, result);
-	LLSDSerialize::toPrettyXML(mMessage, result);
+	if (format == FORMAT_BINARY)
+	{
+		LLSDSerialize::toBinary(mMessage, result);
+	}
+	else
+	{
+		// Pretty XML may be slightly easier to deal with while debugging...
+//		LLSDSerialize::toXML(mMessage, result);
+		LLSDSerialize::toPrettyXML(mMessage, result);
+	}
 	
 	return result.str();
 }
 
+/**
+ *	Find the format of a flattened message.
+ *
+ * @param[in] message Message as a string.
+ * @return Format of the message.
+ */
+// static
+LLPluginMessage::EFormat LLPluginMessage::getFormat(const std::string &message)
+{
+	// Messages are maps, in binary form they always start with '{'.
+	// XML starts with '<' or whitespace.
+	return (!message.empty() && message[0] == '{') ? FORMAT_BINARY : FORMAT_XML;
+}
+
 /**
  *	Parse an incoming message into component parts. Clears all existing state before starting the parse.
  *
@@ -376,7 +398,15 @@ int LLPluginMessage::parse(const std::string &message)
 
 	std::istringstream input(message);
 	
-	S32 parse_result = LLSDSerialize::fromXML(mMessage, input);
+	S32 parse_result;
+	if (getFormat(message) == FORMAT_BINARY)
+	{
+		parse_result = LLSDSerialize::fromBinary(mMessage, input, (S32)message.size());
+	}
+	else
+	{
+		parse_result = LLSDSerialize::fromXML(mMessage, input);
+	}
 	
 	return (int)parse_result;
 }
@@ -41,6 +41,14 @@ public:
 	LLPluginMessage(const LLPluginMessage &p);
 	LLPluginMessage(const std::string &message_class, const std::string &message_name);
 	~LLPluginMessage();
+
+	// Serialized forms of a message.  The plugin host and the viewer agree on
+	// the one used between them at startup, plugins themselves always use XML.
+	enum EFormat
+	{
+		FORMAT_XML = 0,
+		FORMAT_BINARY = 1
+	};
 	
 	// reset all internal state
 	void clear(void);
@@ -86,10 +94,14 @@ public:
 	void* getValuePointer(const std::string &key) const;
 
 	// Flatten the message into a string
-	std::string generate(void) const;
+	std::string generate(EFormat format = FORMAT_XML) const;
+
+	// Format of a flattened message
+	static EFormat getFormat(const std::string &message);
 
 	// Parse an incoming message into component parts
 	// (this clears out all existing state before starting the parse)
+	// Accepts either format.
 	// Returns -1 on failure, otherwise returns the number of key/value pairs in the message.
 	int parse(const std::string &message);
 	
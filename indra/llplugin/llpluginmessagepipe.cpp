@@ -35,6 +35,13 @@
 
 static const char MESSAGE_DELIMITER = '\0';
 
+// A message starting with this byte is followed by a 4 byte length (most significant byte first)
+// and that many bytes of message instead of a delimiter.  XML messages never start with it.
+static const char MESSAGE_FRAME_START = '\1';
+static const size_t MESSAGE_FRAME_HEADER_SIZE = 5;
+// Anything longer than this is a corrupt frame.  Bulk data goes through shared memory, not the pipe.
+static const U32 MESSAGE_FRAME_MAX_SIZE = 16 * 1024 * 1024;
+
 LLPluginMessagePipeOwner::LLPluginMessagePipeOwner() :
 	mMessagePipe(NULL),
 	mSocketError(APR_SUCCESS)
@@ -82,6 +89,22 @@ bool LLPluginMessagePipeOwner::writeMessageRaw(const std::string &message)
 	return result;
 }
 
+bool LLPluginMessagePipeOwner::writeMessageFramed(const std::string &message)
+{
+	bool result = true;
+	if(mMessagePipe != NULL)
+	{
+		result = mMessagePipe->addMessage(message, true);
+	}
+	else
+	{
+		LL_WARNS("Plugin") << "dropping message of " << message.size() << " bytes" << LL_ENDL;
+		result = false;
+	}
+	
+	return result;
+}
+
 void LLPluginMessagePipeOwner::killMessagePipe(void)
 {
 	if(mMessagePipe != NULL)
@@ -109,7 +132,7 @@ LLPluginMessagePipe::~LLPluginMessagePipe()
 	}
 }
 
-bool LLPluginMessagePipe::addMessage(const std::string &message)
+bool LLPluginMessagePipe::addMessage(const std::string &message, bool length_prefixed)
 {
 	// queue the message for later output
 	LLMutexLock lock(&mOutputMutex);
@@ -121,8 +144,25 @@ bool LLPluginMessagePipe::addMessage(const std::string &message)
 		mOutputStartIndex = 0;
 	}
 		
-	mOutput += message;
-	mOutput += MESSAGE_DELIMITER;	// message separator
+	if (length_prefixed)
+	{
+		if (message.size() > MESSAGE_FRAME_MAX_SIZE)
+		{
+			LL_WARNS("Plugin") << "dropping message of " << message.size() << " bytes, too large for a frame" << LL_ENDL;
+			return false;
+		}
+
+		U32 size = (U32)message.size();
+		char header[MESSAGE_FRAME_HEADER_SIZE] = { MESSAGE_FRAME_START,
+			(char)(size >> 24), (char)(size >> 16), (char)(size >> 8), (char)size };
+		mOutput.append(header, MESSAGE_FRAME_HEADER_SIZE);
+		mOutput += message;
+	}
+	else
+	{
+		mOutput += message;
+		mOutput += MESSAGE_DELIMITER;	// message separator
+	}
 	
 	return true;
 }
@@ -178,7 +218,8 @@ bool LLPluginMessagePipe::pumpOutput()
 		LLMutexLock lock(&mOutputMutex);
 
 		const char * output_data = &(mOutput.data()[mOutputStartIndex]);
-		if(*output_data != '\0')
+		// Framed messages may contain NUL bytes, don't look at the data to see if there's any
+		if(mOutputStartIndex < mOutput.size())
 		{
 			// write any outgoing messages
 			in_size = (apr_size_t) (mOutput.size() - mOutputStartIndex);
@@ -361,28 +402,72 @@ bool LLPluginMessagePipe::pumpInput(F64 timeout)
 				}
 			}
 			
-			processInput();
+			if(!processInput())
+			{
+				result = false;
+			}
 		}
 	}
 	
 	return result;	
 }
 
-void LLPluginMessagePipe::processInput(void)
+bool LLPluginMessagePipe::processInput(void)
 {
-	// Look for input delimiter(s) in the input buffer.
-	int delim;
+	// Look for complete messages in the input buffer.
 	mInputMutex.lock();
-	while((delim = mInput.find(MESSAGE_DELIMITER)) != std::string::npos)
+	while(!mInput.empty())
 	{	
+		std::string::size_type start, length, consumed;
+		if (mInput[0] == MESSAGE_FRAME_START)
+		{
+			if (mInput.size() < MESSAGE_FRAME_HEADER_SIZE)
+			{
+				break;
+			}
+			const U8 *header = (const U8 *)mInput.data();
+			U32 frame_length = ((U32)header[1] << 24) | ((U32)header[2] << 16) | ((U32)header[3] << 8) | (U32)header[4];
+			if (frame_length > MESSAGE_FRAME_MAX_SIZE)
+			{
+				// This also catches lengths that went negative on the sending side.
+				// There's no way to find the next message after a bad length, so treat it like a broken socket.
+				LL_WARNS("Plugin") << "bad message frame length " << frame_length << ", closing pipe" << LL_ENDL;
+				mInput.clear();
+				mInputMutex.unlock();
+				if (mOwner)
+				{
+					mOwner->socketError(APR_EGENERAL);
+				}
+				return false;
+			}
+			length = frame_length;
+			start = MESSAGE_FRAME_HEADER_SIZE;
+			consumed = start + length;
+			if (mInput.size() < consumed)
+			{
+				break;
+			}
+		}
+		else
+		{
+			std::string::size_type delim = mInput.find(MESSAGE_DELIMITER);
+			if (delim == std::string::npos)
+			{
+				break;
+			}
+			start = 0;
+			length = delim;
+			consumed = delim + 1;
+		}
+
 		// Let the owner process this message
 		if (mOwner)
 		{
 			// Pull the message out of the input buffer before calling receiveMessageRaw.
 			// It's now possible for this function to get called recursively (in the case where the plugin makes a blocking request)
 			// and this guarantees that the messages will get dequeued correctly.
-			std::string message(mInput, 0, delim);
-			mInput.erase(0, delim + 1);
+			std::string message(mInput, start, length);
+			mInput.erase(0, consumed);
 			mInputMutex.unlock();
 			mOwner->receiveMessageRaw(message);
 			mInputMutex.lock();
@@ -390,8 +475,11 @@ void LLPluginMessagePipe::processInput(void)
 		else
 		{
 			LL_WARNS("Plugin") << "!mOwner" << LL_ENDL;
+			break;
 		}
 	}
 	mInputMutex.unlock();
+
+	return true;
 }
 
@@ -55,6 +55,8 @@ protected:
 	bool canSendMessage(void);
 	// call this to send a message over the pipe
 	bool writeMessageRaw(const std::string &message);
+	// same, for messages that may contain NUL bytes.  The other end must understand length-prefixed frames.
+	bool writeMessageFramed(const std::string &message);
 	// call this to close the pipe
 	void killMessagePipe(void);
 	
@@ -69,7 +71,10 @@ public:
 	LLPluginMessagePipe(LLPluginMessagePipeOwner *owner, LLSocket::ptr_t socket);
 	virtual ~LLPluginMessagePipe();
 	
-	bool addMessage(const std::string &message);
+	// Queues a message for output.  Messages are normally NUL-terminated,
+	// length_prefixed sends it in a frame that can carry any bytes.
+	// Either kind is always accepted on input.
+	bool addMessage(const std::string &message, bool length_prefixed = false);
 	void clearOwner(void);
 	
 	bool pump(F64 timeout = 0.0f);
@@ -77,7 +82,8 @@ public:
 	bool pumpInput(F64 timeout = 0.0f);
 		
 protected:	
-	void processInput(void);
+	// returns false if the input can't be split into messages
+	bool processInput(void);
 
 	// used internally by pump()
 	void setSocketTimeout(apr_interval_time_t timeout_usec);
@@ -46,6 +46,7 @@ LLPluginProcessChild::LLPluginProcessChild()
 	mCPUElapsed = 0.0f;
 	mBlockingRequest = false;
 	mBlockingResponseReceived = false;
+	mMessageFormat = LLPluginMessage::FORMAT_XML;
 }
 
 LLPluginProcessChild::~LLPluginProcessChild()
@@ -137,7 +138,12 @@ void LLPluginProcessChild::idle(void)
 			break;
 
 		case STATE_CONNECTED:
-			sendMessageToParent(LLPluginMessage(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello"));
+			{
+				// Let the parent know the newest message format we can read
+				LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello");
+				message.setValueS32("message_format", LLPluginMessage::FORMAT_BINARY);
+				sendMessageToParent(message);
+			}
 			setState(STATE_PLUGIN_LOADING);
 			break;
 
@@ -323,23 +329,28 @@ void LLPluginProcessChild::sendMessageToPlugin(const LLPluginMessage &message)
 
 void LLPluginProcessChild::sendMessageToParent(const LLPluginMessage &message)
 {
-	std::string buffer = message.generate();
+	LL_DEBUGS("Plugin") << "Sending to parent: " << message.generate() << LL_ENDL;
 
-	LL_DEBUGS("Plugin") << "Sending to parent: " << buffer << LL_ENDL;
-
-	writeMessageRaw(buffer);
+	if (mMessageFormat == LLPluginMessage::FORMAT_BINARY)
+	{
+		writeMessageFramed(message.generate(LLPluginMessage::FORMAT_BINARY));
+	}
+	else
+	{
+		writeMessageRaw(message.generate());
+	}
 }
 
 void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 {
 	// Incoming message from the TCP Socket
 
-	LL_DEBUGS("Plugin") << "Received from parent: " << message << LL_ENDL;
-
 	// Decode this message
 	LLPluginMessage parsed;
 	parsed.parse(message);
 
+	LL_DEBUGS("Plugin") << "Received from parent: " << parsed.generate() << LL_ENDL;
+
 	if (mBlockingRequest)
 	{
 		// We're blocking the plugin waiting for a response.
@@ -372,6 +383,12 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 			{
 				mPluginFile = parsed.getValue("file");
 				mPluginDir = parsed.getValue("dir");
+
+				// Older parents don't send a format and only read XML
+				if (parsed.getValueS32("message_format") >= LLPluginMessage::FORMAT_BINARY)
+				{
+					mMessageFormat = LLPluginMessage::FORMAT_BINARY;
+				}
 			}
 			else if (message_name == "shutdown_plugin")
 			{
@@ -464,7 +481,15 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 	{
 		LLTimer elapsed;
 
-		mInstance->sendMessage(message);
+		// Plugins only read XML
+		if (LLPluginMessage::getFormat(message) == LLPluginMessage::FORMAT_XML)
+		{
+			mInstance->sendMessage(message);
+		}
+		else
+		{
+			mInstance->sendMessage(parsed.generate());
+		}
 
 		mCPUElapsed += elapsed.getElapsedTimeF64();
 	}
@@ -484,14 +509,14 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 	// Incoming message from the plugin instance
 	bool passMessage = true;
 
+	// Decode this message
+	LLPluginMessage parsed;
+	parsed.parse(message);
+
 	// FIXME: how should we handle queueing here?
 
 	// Intercept certain base messages (responses to ones sent by this class)
 	{
-		// Decode this message
-		LLPluginMessage parsed;
-		parsed.parse(message);
-
 		if (parsed.hasValue("blocking_request"))
 		{
 			mBlockingRequest = true;
@@ -557,7 +582,14 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 	if (passMessage)
 	{
 		LL_DEBUGS("Plugin") << "Passing through to parent: " << message << LL_ENDL;
-		writeMessageRaw(message);
+		if (mMessageFormat == LLPluginMessage::FORMAT_BINARY)
+		{
+			writeMessageFramed(parsed.generate(LLPluginMessage::FORMAT_BINARY));
+		}
+		else
+		{
+			writeMessageRaw(message);
+		}
 	}
 
 	while (mBlockingRequest)
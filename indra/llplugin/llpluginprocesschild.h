@@ -106,6 +106,7 @@ private:
     F64		mCPUElapsed;
 	bool	mBlockingRequest;
 	bool	mBlockingResponseReceived;
+	LLPluginMessage::EFormat mMessageFormat;	// format of messages sent to the parent, set by load_plugin
 	std::queue<std::string> mMessageQueue;
     LLTimer mWaitGoodbye;
 	void deliverQueuedMessages();
@@ -96,6 +96,7 @@ LLPluginProcessParent::LLPluginProcessParent(LLPluginProcessParentOwner *owner):
 	mDebug = false;
 	mBlocked = false;
 	mPolledInput = false;
+	mMessageFormat = LLPluginMessage::FORMAT_XML;
 	mPollFD.client_data = NULL;
 
 	mPluginLaunchTimeout = 60.0f;
@@ -282,6 +283,9 @@ bool LLPluginProcessParent::accept()
 		mSocket = LLSocket::create(new_socket, new_pool);
 		new LLPluginMessagePipe(this, mSocket);
 
+		// Until the plugin host says otherwise
+		mMessageFormat = LLPluginMessage::FORMAT_XML;
+
 		result = true;
 	}
 	else if(APR_STATUS_IS_EAGAIN(status))
@@ -534,6 +538,8 @@ void LLPluginProcessParent::idle(void)
 					LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "load_plugin");
 					message.setValue("file", mPluginFile);
 					message.setValue("dir", mPluginDir);
+					// Tell the plugin host which format to send its messages in
+					message.setValueS32("message_format", mMessageFormat);
 					sendMessage(message);
 				}
 
@@ -667,9 +673,15 @@ void LLPluginProcessParent::sendMessage(const LLPluginMessage &message)
 		mHeartbeat.setTimerExpirySec(mPluginLockupTimeout);
 	}
 	
-	std::string buffer = message.generate();
-	LL_DEBUGS("Plugin") << "Sending: " << buffer << LL_ENDL;	
-	writeMessageRaw(buffer);
+	LL_DEBUGS("Plugin") << "Sending: " << message.generate() << LL_ENDL;	
+	if (mMessageFormat == LLPluginMessage::FORMAT_BINARY)
+	{
+		writeMessageFramed(message.generate(LLPluginMessage::FORMAT_BINARY));
+	}
+	else
+	{
+		writeMessageRaw(message.generate());
+	}
 	
 	// Try to send message immediately.
 	if(mMessagePipe)
@@ -920,11 +932,11 @@ void LLPluginProcessParent::servicePoll()
 
 void LLPluginProcessParent::receiveMessageRaw(const std::string &message)
 {
-	LL_DEBUGS("Plugin") << "Received: " << message << LL_ENDL;
-	
 	LLPluginMessage parsed;
 	if(LLSDParser::PARSE_FAILURE != parsed.parse(message))
 	{
+		LL_DEBUGS("Plugin") << "Received: " << parsed.generate() << LL_ENDL;
+
 		if(parsed.hasValue("blocking_request"))
 		{
 			mBlocked = true;
@@ -982,6 +994,13 @@ void LLPluginProcessParent::receiveMessage(const LLPluginMessage &message)
 		{
 			if(mState == STATE_CONNECTED)
 			{
+				// Use binary messages if the plugin host can read them.  Older hosts don't send a format.
+				if (message.getValueS32("message_format") >= LLPluginMessage::FORMAT_BINARY)
+				{
+					mMessageFormat = LLPluginMessage::FORMAT_BINARY;
+				}
+				LL_INFOS("Plugin") << "plugin host message format: " << mMessageFormat << LL_ENDL;
+
 				// Plugin host has launched.  Tell it which plugin to load.
 				setState(STATE_HELLO);
 			}
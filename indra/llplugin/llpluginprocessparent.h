@@ -190,6 +190,9 @@ private:
 	bool mBlocked;
 	bool mPolledInput;
 
+	// Format of messages sent to the plugin host, chosen from what its hello message says it can read.
+	LLPluginMessage::EFormat mMessageFormat;
+
 	LLProcessPtr mDebugger;
 	
 	F32 mPluginLaunchTimeout;		// Somewhat longer timeout for initial launch.
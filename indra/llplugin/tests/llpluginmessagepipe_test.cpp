@@ -0,0 +1,221 @@
+/**
+ * @file llpluginmessagepipe_test.cpp
+ * @brief Tests for the message framing of LLPluginMessagePipe.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llpluginmessagepipe.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	class TestPipeOwner : public LLPluginMessagePipeOwner
+	{
+	public:
+		/*virtual*/ void receiveMessageRaw(const std::string &message)
+		{
+			mMessages.push_back(message);
+		}
+
+		apr_status_t getSocketError() const { return mSocketError; }
+
+		std::vector<std::string> mMessages;
+	};
+
+	// A pipe without a socket.  Output is taken from the queue and input is
+	// fed in directly, in whatever pieces the test likes.
+	class TestPipe : public LLPluginMessagePipe
+	{
+	public:
+		TestPipe(LLPluginMessagePipeOwner *owner) :
+			LLPluginMessagePipe(owner, LLSocket::ptr_t())
+		{
+		}
+
+		std::string takeOutput()
+		{
+			LLMutexLock lock(&mOutputMutex);
+			std::string output(mOutput, mOutputStartIndex);
+			mOutputStartIndex = mOutput.size();
+			return output;
+		}
+
+		bool receive(const std::string &data)
+		{
+			{
+				LLMutexLock lock(&mInputMutex);
+				mInput += data;
+			}
+			return processInput();
+		}
+
+		size_t pendingInput()
+		{
+			LLMutexLock lock(&mInputMutex);
+			return mInput.size();
+		}
+	};
+
+	std::string frame_header(U32 length)
+	{
+		std::string header;
+		header += '\1';
+		header += (char)(length >> 24);
+		header += (char)(length >> 16);
+		header += (char)(length >> 8);
+		header += (char)length;
+		return header;
+	}
+}
+
+namespace tut
+{
+	struct plugin_message_pipe
+	{
+		plugin_message_pipe()
+		{
+			// the owner deletes the pipe
+			mPipe = new TestPipe(&mOwner);
+		}
+
+		TestPipeOwner mOwner;
+		TestPipe *mPipe;
+	};
+
+	typedef test_group<plugin_message_pipe> plugin_message_pipe_test;
+	typedef plugin_message_pipe_test::object plugin_message_pipe_t;
+	plugin_message_pipe_test tut_plugin_message_pipe("LLPluginMessagePipe");
+
+	// framed and NUL-terminated messages come back out as they went in
+	template<> template<>
+	void plugin_message_pipe_t::test<1>()
+	{
+		std::string binary("{\0\0\0\x02k\x01\0\x7f}", 10);
+		std::string xml("<llsd><map><key>a</key><integer>1</integer></map></llsd>");
+		std::string empty;
+
+		ensure("binary", mPipe->addMessage(binary, true));
+		ensure("xml", mPipe->addMessage(xml));
+		ensure("empty", mPipe->addMessage(empty, true));
+		ensure("xml framed", mPipe->addMessage(xml, true));
+
+		std::string output = mPipe->takeOutput();
+		ensure_equals("frame size", output.size(), (size_t)(5 + binary.size() + xml.size() + 1 + 5 + 5 + xml.size()));
+		ensure("round trip", mPipe->receive(output));
+		ensure_equals("count", mOwner.mMessages.size(), (size_t)4);
+		ensure("binary kept its NULs", mOwner.mMessages[0] == binary);
+		ensure_equals("xml", mOwner.mMessages[1], xml);
+		ensure_equals("empty", mOwner.mMessages[2], empty);
+		ensure_equals("xml framed", mOwner.mMessages[3], xml);
+		ensure_equals("all consumed", mPipe->pendingInput(), (size_t)0);
+		ensure_equals("no error", mOwner.getSocketError(), APR_SUCCESS);
+	}
+
+	// messages split across reads at every possible point, including inside the length
+	template<> template<>
+	void plugin_message_pipe_t::test<2>()
+	{
+		std::string payload;
+		for (S32 i = 0; i < 300; ++i)
+		{
+			payload += (char)(i * 7);
+		}
+		mPipe->addMessage(payload, true);
+		mPipe->addMessage("old style");
+		mPipe->addMessage(payload, true);
+		std::string output = mPipe->takeOutput();
+
+		for (size_t split = 1; split < output.size(); ++split)
+		{
+			mOwner.mMessages.clear();
+			ensure("first part", mPipe->receive(output.substr(0, split)));
+			ensure("second part", mPipe->receive(output.substr(split)));
+			ensure_equals(llformat("count, split at %d", (S32)split), mOwner.mMessages.size(), (size_t)3);
+			ensure(llformat("first, split at %d", (S32)split), mOwner.mMessages[0] == payload);
+			ensure_equals(llformat("second, split at %d", (S32)split), mOwner.mMessages[1], std::string("old style"));
+			ensure(llformat("third, split at %d", (S32)split), mOwner.mMessages[2] == payload);
+		}
+
+		// one byte at a time
+		mOwner.mMessages.clear();
+		for (size_t i = 0; i < output.size(); ++i)
+		{
+			mPipe->receive(output.substr(i, 1));
+			ensure(llformat("nothing early at %d", (S32)i), mOwner.mMessages.size() < 3 || i == output.size() - 1);
+		}
+		ensure_equals("bytewise count", mOwner.mMessages.size(), (size_t)3);
+		ensure_equals("no error", mOwner.getSocketError(), APR_SUCCESS);
+	}
+
+	// a peer that only sends NUL-terminated messages still works
+	template<> template<>
+	void plugin_message_pipe_t::test<3>()
+	{
+		std::string old_peer("<llsd><string>one</string></llsd>");
+		old_peer += '\0';
+		old_peer += "<llsd><string>two</string></llsd>";
+		old_peer += '\0';
+		old_peer += "<llsd><string>thr";
+		ensure(mPipe->receive(old_peer));
+		ensure_equals("complete messages", mOwner.mMessages.size(), (size_t)2);
+		ensure(mPipe->receive(std::string("ee</string></llsd>\0", 19)));
+		ensure_equals("rest", mOwner.mMessages.size(), (size_t)3);
+		ensure_equals(mOwner.mMessages[2], std::string("<llsd><string>three</string></llsd>"));
+	}
+
+	// a length that is too large closes the pipe instead of buffering forever
+	template<> template<>
+	void plugin_message_pipe_t::test<4>()
+	{
+		ensure("oversized", !mPipe->receive(frame_header(64 * 1024 * 1024) + "abc"));
+		ensure("error reported", mOwner.getSocketError() != APR_SUCCESS);
+		ensure_equals("input dropped", mPipe->pendingInput(), (size_t)0);
+		ensure("nothing delivered", mOwner.mMessages.empty());
+	}
+
+	// a length with the top bit set, as a negative length would be sent
+	template<> template<>
+	void plugin_message_pipe_t::test<5>()
+	{
+		std::string good("fine");
+		good += '\0';
+		ensure("negative", !mPipe->receive(good + frame_header((U32)-5) + "abcdefgh"));
+		ensure_equals("earlier message delivered", mOwner.mMessages.size(), (size_t)1);
+		ensure_equals(mOwner.mMessages[0], std::string("fine"));
+		ensure("error reported", mOwner.getSocketError() != APR_SUCCESS);
+		ensure_equals("input dropped", mPipe->pendingInput(), (size_t)0);
+	}
+
+	// oversized messages are refused on the sending side too
+	template<> template<>
+	void plugin_message_pipe_t::test<6>()
+	{
+		std::string huge(16 * 1024 * 1024 + 1, 'x');
+		ensure("refused", !mPipe->addMessage(huge, true));
+		ensure("nothing queued", mPipe->takeOutput().empty());
+	}
+}
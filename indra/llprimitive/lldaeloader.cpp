@@ -57,7 +57,9 @@
 
 #include "lldaeloader.h"
 #include "llsdserialize.h"
+#include "lljobscheduler.h"
 #include "lljoint.h"
+#include "lltimer.h"
 
 #include "glh/glh_linear.h"
 #include "llmatrix4a.h"
@@ -83,6 +85,50 @@ static const std::string lod_suffix[LLModel::NUM_LODS] =
 
 const U32 LIMIT_MATERIALS_OUTPUT = 12;
 
+// Everything the face builders need from one <triangles>, <polylist> or
+// <polygons> element. References are resolved on the loader thread, after
+// which the faces can be built on any thread without touching the DOM.
+struct LLDomPrimitive
+{
+	enum EType
+	{
+		TRIANGLES = 0,
+		POLYLIST,
+		POLYGONS
+	};
+
+	LLDomPrimitive(EType type)
+	:	mType(type),
+		mStatus(LLModel::NO_ERRORS),
+		mPosOffset(-1),
+		mTCOffset(-1),
+		mNormOffset(-1),
+		mStride(0),
+		mPositions(NULL),
+		mTexCoords(NULL),
+		mNormals(NULL),
+		mIndices(NULL),
+		mVCount(NULL)
+	{
+	}
+
+	EType mType;
+	LLModel::EModelStatus mStatus;	// error found while resolving
+	std::string mMaterial;
+	S32 mPosOffset;
+	S32 mTCOffset;
+	S32 mNormOffset;
+	S32 mStride;
+	domListOfFloats* mPositions;
+	domListOfFloats* mTexCoords;
+	domListOfFloats* mNormals;
+	domListOfUInts* mIndices;		// triangles and polylist
+	domListOfUInts* mVCount;		// polylist
+	std::vector<domListOfUInts*> mPolygons;	// polygons, one list per polygon
+};
+
+typedef std::vector<LLDomPrimitive> dom_primitive_list_t;
+
 bool get_dom_sources(const domInputLocalOffset_Array& inputs, S32& pos_offset, S32& tc_offset, S32& norm_offset, S32 &idx_stride,
 	domSource* &pos_source, domSource* &tc_source, domSource* &norm_source)
 {
@@ -149,42 +195,66 @@ bool get_dom_sources(const domInputLocalOffset_Array& inputs, S32& pos_offset, S
 	return true;
 }
 
-LLModel::EModelStatus load_face_from_dom_triangles(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, domTrianglesRef& tri)
+void get_dom_triangles(domTrianglesRef& tri, LLDomPrimitive& prim)
 {
-	LLVolumeFace face;
-	std::vector<LLVolumeFace::VertexData> verts;
-	std::vector<U16> indices;
-	
 	const domInputLocalOffset_Array& inputs = tri->getInput_array();
 
-	S32 pos_offset = -1;
-	S32 tc_offset = -1;
-	S32 norm_offset = -1;
-
 	domSource* pos_source = NULL;
 	domSource* tc_source = NULL;
 	domSource* norm_source = NULL;
 
-	S32 idx_stride = 0;
-
-	if ( !get_dom_sources(inputs, pos_offset, tc_offset, norm_offset, idx_stride, pos_source, tc_source, norm_source))
+	if ( !get_dom_sources(inputs, prim.mPosOffset, prim.mTCOffset, prim.mNormOffset, prim.mStride, pos_source, tc_source, norm_source))
 	{
-		return LLModel::BAD_ELEMENT;
+		prim.mStatus = LLModel::BAD_ELEMENT;
+		return;
 	}
 
 	if (!pos_source || !pos_source->getFloat_array())
 	{
 		LL_WARNS() << "Unable to process mesh without position data; invalid model;  invalid model." << LL_ENDL;
-		return LLModel::BAD_ELEMENT;
+		prim.mStatus = LLModel::BAD_ELEMENT;
+		return;
 	}
 
 	domPRef p = tri->getP();
-	domListOfUInts& idx = p->getValue();
+	prim.mIndices = &p->getValue();
+
+	prim.mPositions = &pos_source->getFloat_array()->getValue();
+	prim.mTexCoords = tc_source ? &tc_source->getFloat_array()->getValue() : NULL;
+	prim.mNormals = norm_source ? &norm_source->getFloat_array()->getValue() : NULL;
+
+	if (tri->getMaterial())
+	{
+		prim.mMaterial = std::string(tri->getMaterial());
+	}
+}
+
+LLModel::EModelStatus load_face_from_dom_triangles(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, const LLDomPrimitive& prim)
+{
+	if (prim.mStatus != LLModel::NO_ERRORS)
+	{
+		return prim.mStatus;
+	}
+
+	LLVolumeFace face;
+	std::vector<LLVolumeFace::VertexData> verts;
+	std::vector<U16> indices;
+
+	const S32 pos_offset = prim.mPosOffset;
+	const S32 tc_offset = prim.mTCOffset;
+	const S32 norm_offset = prim.mNormOffset;
+	const S32 idx_stride = prim.mStride;
+
+	const bool pos_source = prim.mPositions != NULL;
+	const bool tc_source = prim.mTexCoords != NULL;
+	const bool norm_source = prim.mNormals != NULL;
+
+	domListOfUInts& idx = *prim.mIndices;
 	
 	domListOfFloats  dummy ;
-	domListOfFloats& v = pos_source ? pos_source->getFloat_array()->getValue() : dummy ;
-	domListOfFloats& tc = tc_source ? tc_source->getFloat_array()->getValue() : dummy ;
-	domListOfFloats& n = norm_source ? norm_source->getFloat_array()->getValue() : dummy ;
+	domListOfFloats& v = pos_source ? *prim.mPositions : dummy ;
+	domListOfFloats& tc = tc_source ? *prim.mTexCoords : dummy ;
+	domListOfFloats& n = norm_source ? *prim.mNormals : dummy ;
 
 	if (pos_source)
 	{
@@ -282,14 +352,7 @@ LLModel::EModelStatus load_face_from_dom_triangles(std::vector<LLVolumeFace>& fa
 
 		if (indices.size()%3 == 0 && verts.size() >= 65532)
 		{
-			std::string material;
-
-			if (tri->getMaterial())
-			{
-				material = std::string(tri->getMaterial());
-			}
-
-			materials.push_back(material);
+			materials.push_back(prim.mMaterial);
 			face_list.push_back(face);
 			face_list.rbegin()->fillFromLegacyData(verts, indices);
 			LLVolumeFace& new_face = *face_list.rbegin();
@@ -315,14 +378,7 @@ LLModel::EModelStatus load_face_from_dom_triangles(std::vector<LLVolumeFace>& fa
 
 	if (!verts.empty())
 	{
-		std::string material;
-
-		if (tri->getMaterial())
-		{
-			material = std::string(tri->getMaterial());
-		}
-		
-		materials.push_back(material);
+		materials.push_back(prim.mMaterial);
 		face_list.push_back(face);
 
 		face_list.rbegin()->fillFromLegacyData(verts, indices);
@@ -343,62 +399,93 @@ LLModel::EModelStatus load_face_from_dom_triangles(std::vector<LLVolumeFace>& fa
 	return LLModel::NO_ERRORS ;
 }
 
-LLModel::EModelStatus load_face_from_dom_polylist(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, domPolylistRef& poly)
+void get_dom_polylist(domPolylistRef& poly, LLDomPrimitive& prim)
 {
 	domPRef p = poly->getP();
-	domListOfUInts& idx = p->getValue();
+	prim.mIndices = &p->getValue();
 
-	if (idx.getCount() == 0)
+	if (prim.mIndices->getCount() == 0)
 	{
-		return LLModel::NO_ERRORS ;
+		return;
 	}
 
 	const domInputLocalOffset_Array& inputs = poly->getInput_array();
 
 
-	domListOfUInts& vcount = poly->getVcount()->getValue();
-	
-	S32 pos_offset = -1;
-	S32 tc_offset = -1;
-	S32 norm_offset = -1;
+	prim.mVCount = &poly->getVcount()->getValue();
 
 	domSource* pos_source = NULL;
 	domSource* tc_source = NULL;
 	domSource* norm_source = NULL;
 
-	S32 idx_stride = 0;
+	if (!get_dom_sources(inputs, prim.mPosOffset, prim.mTCOffset, prim.mNormOffset, prim.mStride, pos_source, tc_source, norm_source))
+	{
+		prim.mStatus = LLModel::BAD_ELEMENT;
+		return;
+	}
+
+	if (pos_source)
+	{
+		prim.mPositions = &pos_source->getFloat_array()->getValue();
+	}
+
+	if (tc_source)
+	{
+		prim.mTexCoords = &tc_source->getFloat_array()->getValue();
+	}
+
+	if (norm_source)
+	{
+		prim.mNormals = &norm_source->getFloat_array()->getValue();
+	}
 
-	if (!get_dom_sources(inputs, pos_offset, tc_offset, norm_offset, idx_stride, pos_source, tc_source, norm_source))
+	if (poly->getMaterial())
 	{
-		return LLModel::BAD_ELEMENT;
+		prim.mMaterial = std::string(poly->getMaterial());
 	}
+}
+
+LLModel::EModelStatus load_face_from_dom_polylist(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, const LLDomPrimitive& prim)
+{
+	domListOfUInts& idx = *prim.mIndices;
+
+	if (idx.getCount() == 0)
+	{
+		return LLModel::NO_ERRORS ;
+	}
+
+	if (prim.mStatus != LLModel::NO_ERRORS)
+	{
+		return prim.mStatus;
+	}
+
+	domListOfUInts& vcount = *prim.mVCount;
+	
+	const S32 pos_offset = prim.mPosOffset;
+	const S32 tc_offset = prim.mTCOffset;
+	const S32 norm_offset = prim.mNormOffset;
+	const S32 idx_stride = prim.mStride;
+
+	const bool pos_source = prim.mPositions != NULL;
+	const bool tc_source = prim.mTexCoords != NULL;
+	const bool norm_source = prim.mNormals != NULL;
 
 	LLVolumeFace face;
 
 	std::vector<U16> indices;
 	std::vector<LLVolumeFace::VertexData> verts;
 
-	domListOfFloats v;
-	domListOfFloats tc;
-	domListOfFloats n;
+	domListOfFloats dummy;
+	domListOfFloats& v = pos_source ? *prim.mPositions : dummy;
+	domListOfFloats& tc = tc_source ? *prim.mTexCoords : dummy;
+	domListOfFloats& n = norm_source ? *prim.mNormals : dummy;
 
 	if (pos_source)
 	{
-		v = pos_source->getFloat_array()->getValue();
 		// VFExtents change
 		face.mExtents[0].set(v[0], v[1], v[2]);
 		face.mExtents[1].set(v[0], v[1], v[2]);
 	}
-
-	if (tc_source)
-	{
-		tc = tc_source->getFloat_array()->getValue();
-	}
-
-	if (norm_source)
-	{
-		n = norm_source->getFloat_array()->getValue();
-	}
 	
 	LLVolumeFace::VertexMapData::PointMap point_map;
 
@@ -531,14 +618,7 @@ LLModel::EModelStatus load_face_from_dom_polylist(std::vector<LLVolumeFace>& fac
 
 			if (indices.size()%3 == 0 && indices.size() >= 65532)
 			{
-				std::string material;
-
-				if (poly->getMaterial())
-				{
-					material = std::string(poly->getMaterial());
-				}
-
-				materials.push_back(material);
+				materials.push_back(prim.mMaterial);
 				face_list.push_back(face);
 				face_list.rbegin()->fillFromLegacyData(verts, indices);
 				LLVolumeFace& new_face = *face_list.rbegin();
@@ -567,14 +647,7 @@ LLModel::EModelStatus load_face_from_dom_polylist(std::vector<LLVolumeFace>& fac
 
 	if (!verts.empty())
 	{
-		std::string material;
-
-		if (poly->getMaterial())
-		{
-			material = std::string(poly->getMaterial());
-		}
-	
-		materials.push_back(material);
+		materials.push_back(prim.mMaterial);
 		face_list.push_back(face);
 		face_list.rbegin()->fillFromLegacyData(verts, indices);
 
@@ -595,22 +668,10 @@ LLModel::EModelStatus load_face_from_dom_polylist(std::vector<LLVolumeFace>& fac
 	return LLModel::NO_ERRORS ;
 }
 
-LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, domPolygonsRef& poly)
+void get_dom_polygons(domPolygonsRef& poly, LLDomPrimitive& prim)
 {
-	LLVolumeFace face;
-	std::vector<U16> indices;
-	std::vector<LLVolumeFace::VertexData> verts;
-
 	const domInputLocalOffset_Array& inputs = poly->getInput_array();
 
-	S32 v_offset = -1;
-	S32 n_offset = -1;
-	S32 t_offset = -1;
-
-	domListOfFloats* v = NULL;
-	domListOfFloats* n = NULL;
-	domListOfFloats* t = NULL;
-	
 	U32 stride = 0;
 	for (U32 i = 0; i < inputs.getCount(); ++i)
 	{
@@ -618,14 +679,15 @@ LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& fac
 
 		if (strcmp(COMMON_PROFILE_INPUT_VERTEX, inputs[i]->getSemantic()) == 0)
 		{ //found vertex array
-			v_offset = inputs[i]->getOffset();
+			prim.mPosOffset = inputs[i]->getOffset();
 
 			const domURIFragmentType& uri = inputs[i]->getSource();
 			daeElementRef elem = uri.getElement();
 			domVertices* vertices = (domVertices*) elem.cast();
 			if (!vertices)
 			{
-				return LLModel::BAD_ELEMENT;
+				prim.mStatus = LLModel::BAD_ELEMENT;
+				return;
 			}
 			domInputLocal_Array& v_inp = vertices->getInput_array();
 
@@ -638,45 +700,81 @@ LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& fac
 					domSource* src = (domSource*) elem.cast();
 					if (!src)
 					{
-						return LLModel::BAD_ELEMENT;
+						prim.mStatus = LLModel::BAD_ELEMENT;
+						return;
 					}
-					v = &(src->getFloat_array()->getValue());
+					prim.mPositions = &(src->getFloat_array()->getValue());
 				}
 			}
 		}
 		else if (strcmp(COMMON_PROFILE_INPUT_NORMAL, inputs[i]->getSemantic()) == 0)
 		{
-			n_offset = inputs[i]->getOffset();
+			prim.mNormOffset = inputs[i]->getOffset();
 			//found normal array for this triangle list
 			const domURIFragmentType& uri = inputs[i]->getSource();
 			daeElementRef elem = uri.getElement();
 			domSource* src = (domSource*) elem.cast();
 			if (!src)
 			{
-				return LLModel::BAD_ELEMENT;
+				prim.mStatus = LLModel::BAD_ELEMENT;
+				return;
 			}
-			n = &(src->getFloat_array()->getValue());
+			prim.mNormals = &(src->getFloat_array()->getValue());
 		}
 		else if (strcmp(COMMON_PROFILE_INPUT_TEXCOORD, inputs[i]->getSemantic()) == 0 && inputs[i]->getSet() == 0)
 		{ //found texCoords
-			t_offset = inputs[i]->getOffset();
+			prim.mTCOffset = inputs[i]->getOffset();
 			const domURIFragmentType& uri = inputs[i]->getSource();
 			daeElementRef elem = uri.getElement();
 			domSource* src = (domSource*) elem.cast();
 			if (!src)
 			{
-				return LLModel::BAD_ELEMENT;
+				prim.mStatus = LLModel::BAD_ELEMENT;
+				return;
 			}
-			t = &(src->getFloat_array()->getValue());
+			prim.mTexCoords = &(src->getFloat_array()->getValue());
 		}
 	}
 
+	prim.mStride = stride;
+
 	domP_Array& ps = poly->getP_array();
+	for (U32 i = 0; i < ps.getCount(); ++i)
+	{
+		prim.mPolygons.push_back(&ps[i]->getValue());
+	}
+
+	if (poly->getMaterial())
+	{
+		prim.mMaterial = std::string(poly->getMaterial());
+	}
+}
+
+LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& face_list, std::vector<std::string>& materials, const LLDomPrimitive& prim)
+{
+	if (prim.mStatus != LLModel::NO_ERRORS)
+	{
+		return prim.mStatus;
+	}
+
+	LLVolumeFace face;
+	std::vector<U16> indices;
+	std::vector<LLVolumeFace::VertexData> verts;
+
+	const S32 v_offset = prim.mPosOffset;
+	const S32 n_offset = prim.mNormOffset;
+	const S32 t_offset = prim.mTCOffset;
+
+	domListOfFloats* v = prim.mPositions;
+	domListOfFloats* n = prim.mNormals;
+	domListOfFloats* t = prim.mTexCoords;
+	
+	const U32 stride = prim.mStride;
 
 	//make a triangle list in <verts>
-	for (U32 i = 0; i < ps.getCount(); ++i)
+	for (U32 i = 0; i < prim.mPolygons.size(); ++i)
 	{ //for each polygon
-		domListOfUInts& idx = ps[i]->getValue();
+		domListOfUInts& idx = *prim.mPolygons[i];
 		for (U32 j = 0; j < idx.getCount()/stride; ++j)
 		{ //for each vertex
 			if (j > 2)
@@ -785,14 +883,7 @@ LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& fac
 
     if (!new_verts.empty())
 	{
-		std::string material;
-
-		if (poly->getMaterial())
-		{
-			material = std::string(poly->getMaterial());
-		}
-
-		materials.push_back(material);
+		materials.push_back(prim.mMaterial);
 		face_list.push_back(face);
 		face_list.rbegin()->fillFromLegacyData(new_verts, indices);
 
@@ -813,6 +904,199 @@ LLModel::EModelStatus load_face_from_dom_polygons(std::vector<LLVolumeFace>& fac
 	return LLModel::NO_ERRORS ;
 }
 
+void get_dom_primitives(domMesh* mesh, dom_primitive_list_t& primitives)
+{
+	domTriangles_Array& tris = mesh->getTriangles_array();
+	for (U32 i = 0; i < tris.getCount(); ++i)
+	{
+		primitives.push_back(LLDomPrimitive(LLDomPrimitive::TRIANGLES));
+		get_dom_triangles(tris.get(i), primitives.back());
+	}
+
+	domPolylist_Array& polys = mesh->getPolylist_array();
+	for (U32 i = 0; i < polys.getCount(); ++i)
+	{
+		primitives.push_back(LLDomPrimitive(LLDomPrimitive::POLYLIST));
+		get_dom_polylist(polys.get(i), primitives.back());
+	}
+
+	domPolygons_Array& polygons = mesh->getPolygons_array();
+	for (U32 i = 0; i < polygons.getCount(); ++i)
+	{
+		primitives.push_back(LLDomPrimitive(LLDomPrimitive::POLYGONS));
+		get_dom_polygons(polygons.get(i), primitives.back());
+	}
+}
+
+bool load_faces_from_dom_primitives(LLModel* pModel, const dom_primitive_list_t& primitives)
+{
+	LLModel::EModelStatus status = LLModel::NO_ERRORS;
+
+	for (U32 i = 0; i < primitives.size(); ++i)
+	{
+		const LLDomPrimitive& prim = primitives[i];
+		switch (prim.mType)
+		{
+		case LLDomPrimitive::TRIANGLES:
+			status = load_face_from_dom_triangles(pModel->getVolumeFaces(), pModel->getMaterialList(), prim);
+			pModel->mStatus = status;
+			break;
+		case LLDomPrimitive::POLYLIST:
+			status = load_face_from_dom_polylist(pModel->getVolumeFaces(), pModel->getMaterialList(), prim);
+			break;
+		case LLDomPrimitive::POLYGONS:
+			status = load_face_from_dom_polygons(pModel->getVolumeFaces(), pModel->getMaterialList(), prim);
+			break;
+		}
+
+		if(status != LLModel::NO_ERRORS)
+		{
+			pModel->ClearFacesAndMaterials();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// LLDAELoader::MeshJob
+//-----------------------------------------------------------------------------
+
+// Converts one <mesh> into one or more models. The DOM is only read by the
+// constructor, on the loader thread, so any number of these can run at once.
+class LLDAELoader::MeshJob : public LLJob
+{
+public:
+	MeshJob(domMesh* mesh, const std::string& model_name, S32 lod, U32 submodel_limit, bool normalize, bool optimize)
+	:	mMesh(mesh),
+		mModelName(model_name),
+		mLod(lod),
+		mSubmodelLimit(submodel_limit),
+		mNormalize(normalize),
+		mOptimize(optimize)
+	{
+		get_dom_primitives(mesh, mPrimitives);
+	}
+
+	// Builds the models on the calling thread
+	void build();
+
+	domMesh* getMesh() const { return mMesh; }
+	std::vector<LLModel*>& getModels() { return mModels; }
+
+	// Frees the models from first on, which nothing else references yet
+	void releaseModels(U32 first);
+
+protected:
+	/*virtual*/ void run() { build(); }
+
+private:
+	domMesh* mMesh;
+	std::string mModelName;
+	S32 mLod;
+	U32 mSubmodelLimit;
+	bool mNormalize;
+	bool mOptimize;
+	dom_primitive_list_t mPrimitives;
+	std::vector<LLModel*> mModels;
+};
+
+void LLDAELoader::MeshJob::releaseModels(U32 first)
+{
+	for (U32 i = first; i < mModels.size(); ++i)
+	{
+		LLPointer<LLModel> release = mModels[i];
+	}
+	mModels.resize(llmin(first, (U32) mModels.size()));
+}
+
+// Breaks the mesh into one or more models as necessary to get around
+// volume face limitations while retaining >8 materials
+void LLDAELoader::MeshJob::build()
+{
+	LLVolumeParams volume_params;
+	volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+
+	mModels.clear();
+
+	LLModel* ret = new LLModel(volume_params, 0.f);
+
+	ret->mLabel = mModelName + lod_suffix[mLod];
+
+	llassert(!ret->mLabel.empty());
+
+	// Like a monkey, ready to be shot into space
+	//
+	ret->ClearFacesAndMaterials();
+
+	// Get the whole set of volume faces
+	//
+	load_faces_from_dom_primitives(ret, mPrimitives);
+
+	U32 volume_faces = ret->getNumVolumeFaces();
+
+	// Side-steps all manner of issues when splitting models
+	// and matching lower LOD materials to base models
+	//
+	ret->sortVolumeFacesByMaterialName();
+
+	bool normalized = false;
+
+    int submodelID = 0;
+
+	// remove all faces that definitely won't fit into one model and submodel limit
+	U32 face_limit = (mSubmodelLimit + 1) * LL_SCULPT_MESH_MAX_FACES;
+	if (face_limit < volume_faces)
+	{
+		ret->setNumVolumeFaces(face_limit);
+	}
+
+	LLVolume::face_list_t remainder;
+	do 
+	{
+		// Insure we do this once with the whole gang and not per-model
+		//
+		if (!normalized && mNormalize)
+		{			
+			normalized = true;
+			ret->normalizeVolumeFaces();
+		}
+
+		ret->trimVolumeFacesToSize(LL_SCULPT_MESH_MAX_FACES, &remainder);
+
+		if (mOptimize)
+		{
+			ret->optimizeVolumeFaces();
+		}
+
+		volume_faces = remainder.size();
+
+		mModels.push_back(ret);
+
+		// If we have left-over volume faces, create another model
+		// to absorb them...
+		//
+		if (volume_faces)
+		{
+			LLModel* next = new LLModel(volume_params, 0.f);
+			next->mSubmodelID = ++submodelID;
+			next->mLabel = mModelName + (char)((int)'a' + next->mSubmodelID) + lod_suffix[mLod];
+			next->getVolumeFaces() = remainder;
+			next->mNormalizedScale = ret->mNormalizedScale;
+			next->mNormalizedTranslation = ret->mNormalizedTranslation;
+			if ( ret->mMaterialList.size() > LL_SCULPT_MESH_MAX_FACES)
+			{
+				next->mMaterialList.assign(ret->mMaterialList.begin() + LL_SCULPT_MESH_MAX_FACES, ret->mMaterialList.end());
+			}
+			ret = next;
+		}
+
+		remainder.clear();
+
+	} while (volume_faces);	
+}
+
 //-----------------------------------------------------------------------------
 // LLDAELoader
 //-----------------------------------------------------------------------------
@@ -843,7 +1127,8 @@ LLDAELoader::LLDAELoader(
         jointAliasMap,
         maxJointsPerMesh),
   mGeneratedModelLimit(modelLimit),
-  mPreprocessDAE(preprocess)
+  mPreprocessDAE(preprocess),
+  mJobScheduler(LLJobScheduler::getDefault())
 {
 }
 
@@ -988,36 +1273,74 @@ bool LLDAELoader::OpenFile(const std::string& filename)
 	mTransform.condition();	
 
 	U32 submodel_limit = count > 0 ? mGeneratedModelLimit/count : 0;
+
+	// Everything each mesh needs is read out of the DOM here, then the
+	// meshes are converted in parallel. Results are still collected in
+	// document order, which the upload path depends on.
+	LLTimer convert_timer;
+	std::vector<LLPointer<MeshJob> > mesh_jobs;
+	mesh_jobs.reserve(count);
 	for (daeInt idx = 0; idx < count; ++idx)
-	{ //build map of domEntities to LLModel
+	{
 		domMesh* mesh = NULL;
 		db->getElement((daeElement**) &mesh, idx, NULL, COLLADA_TYPE_MESH);
 		
 		if (mesh)
 		{
+			mesh_jobs.push_back(new MeshJob(mesh, getLodlessLabel(mesh), mLod, submodel_limit, !mNoNormalize, !mNoOptimize));
+		}
+	}
 
-			std::vector<LLModel*> models;
+	if (mJobScheduler)
+	{
+		for (U32 i = 0; i < mesh_jobs.size(); ++i)
+		{
+			mJobScheduler->submit(mesh_jobs[i].get());
+		}
+		for (U32 i = 0; i < mesh_jobs.size(); ++i)
+		{
+			mJobScheduler->waitFor(mesh_jobs[i].get());
+		}
+	}
+	else
+	{
+		for (U32 i = 0; i < mesh_jobs.size(); ++i)
+		{
+			mesh_jobs[i]->build();
+		}
+	}
 
-			loadModelsFromDomMesh(mesh, models, submodel_limit);
+	LL_INFOS() << "Collada meshes converted: " << mesh_jobs.size() << " in "
+			   << convert_timer.getElapsedTimeF32() << " seconds" << LL_ENDL;
 
-			std::vector<LLModel*>::iterator i;
-			i = models.begin();
-			while (i != models.end())
+	for (U32 job_idx = 0; job_idx < mesh_jobs.size(); ++job_idx)
+	{ //build map of domEntities to LLModel
+		domMesh* mesh = mesh_jobs[job_idx]->getMesh();
+		std::vector<LLModel*>& models = mesh_jobs[job_idx]->getModels();
+
+		std::vector<LLModel*>::iterator i;
+		i = models.begin();
+		while (i != models.end())
+		{
+			LLModel* mdl = *i;
+			if(mdl->getStatus() != LLModel::NO_ERRORS)
 			{
-				LLModel* mdl = *i;
-				if(mdl->getStatus() != LLModel::NO_ERRORS)
+				setLoadState(ERROR_MODEL + mdl->getStatus()) ;
+				// this model and the ones after it were never handed over
+				mesh_jobs[job_idx]->releaseModels(i - models.begin());
+				for (U32 rest = job_idx + 1; rest < mesh_jobs.size(); ++rest)
 				{
-					setLoadState(ERROR_MODEL + mdl->getStatus()) ;
-					return false; //abort
+					mesh_jobs[rest]->releaseModels(0);
 				}
+				return false; //abort
+			}
 
-				if (mdl && validate_model(mdl))
-				{
-					mModelList.push_back(mdl);
-					mModelsMap[mesh].push_back(mdl);
-				}
-				i++;
+			if (mdl && validate_model(mdl))
+			{
+				mModelList.push_back(mdl);
+				mModelsMap[mesh].push_back(mdl);
 			}
+			i++;
 		}
 	}
 
@@ -2358,50 +2681,10 @@ LLColor4 LLDAELoader::getDaeColor(daeElement* element)
 
 bool LLDAELoader::addVolumeFacesFromDomMesh(LLModel* pModel,domMesh* mesh)
 {
-	LLModel::EModelStatus status = LLModel::NO_ERRORS;
-	domTriangles_Array& tris = mesh->getTriangles_array();
-
-	for (U32 i = 0; i < tris.getCount(); ++i)
-	{
-		domTrianglesRef& tri = tris.get(i);
-
-		status = load_face_from_dom_triangles(pModel->getVolumeFaces(), pModel->getMaterialList(), tri);
-		pModel->mStatus = status;
-		if(status != LLModel::NO_ERRORS)
-		{
-			pModel->ClearFacesAndMaterials();
-			return false;
-		}
-	}
-
-	domPolylist_Array& polys = mesh->getPolylist_array();
-	for (U32 i = 0; i < polys.getCount(); ++i)
-	{
-		domPolylistRef& poly = polys.get(i);
-		status = load_face_from_dom_polylist(pModel->getVolumeFaces(), pModel->getMaterialList(), poly);
+	dom_primitive_list_t primitives;
+	get_dom_primitives(mesh, primitives);
 
-		if(status != LLModel::NO_ERRORS)
-		{
-			pModel->ClearFacesAndMaterials();
-			return false;
-		}
-	}
-
-	domPolygons_Array& polygons = mesh->getPolygons_array();
-
-	for (U32 i = 0; i < polygons.getCount(); ++i)
-	{
-		domPolygonsRef& poly = polygons.get(i);
-		status = load_face_from_dom_polygons(pModel->getVolumeFaces(), pModel->getMaterialList(), poly);
-
-		if(status != LLModel::NO_ERRORS)
-		{
-			pModel->ClearFacesAndMaterials();
-			return false;
-		}
-	}
-
-	return (status == LLModel::NO_ERRORS);
+	return load_faces_from_dom_primitives(pModel, primitives);
 }
 
 //static 
@@ -2423,88 +2706,10 @@ LLModel* LLDAELoader::loadModelFromDomMesh(domMesh *mesh)
 //
 bool LLDAELoader::loadModelsFromDomMesh(domMesh* mesh, std::vector<LLModel*>& models_out, U32 submodel_limit)
 {
+	LLPointer<MeshJob> job = new MeshJob(mesh, getLodlessLabel(mesh), mLod, submodel_limit, !mNoNormalize, !mNoOptimize);
+	job->build();
 
-	LLVolumeParams volume_params;
-	volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
-
-	models_out.clear();
-
-	LLModel* ret = new LLModel(volume_params, 0.f);
-
-	std::string model_name = getLodlessLabel(mesh);
-	ret->mLabel = model_name + lod_suffix[mLod];
-
-	llassert(!ret->mLabel.empty());
-
-	// Like a monkey, ready to be shot into space
-	//
-	ret->ClearFacesAndMaterials();
-
-	// Get the whole set of volume faces
-	//
-	addVolumeFacesFromDomMesh(ret, mesh);
-
-	U32 volume_faces = ret->getNumVolumeFaces();
-
-	// Side-steps all manner of issues when splitting models
-	// and matching lower LOD materials to base models
-	//
-	ret->sortVolumeFacesByMaterialName();
-
-	bool normalized = false;
-
-    int submodelID = 0;
-
-	// remove all faces that definitely won't fit into one model and submodel limit
-	U32 face_limit = (submodel_limit + 1) * LL_SCULPT_MESH_MAX_FACES;
-	if (face_limit < volume_faces)
-	{
-		ret->setNumVolumeFaces(face_limit);
-	}
-
-	LLVolume::face_list_t remainder;
-	do 
-	{
-		// Insure we do this once with the whole gang and not per-model
-		//
-		if (!normalized && !mNoNormalize)
-		{			
-			normalized = true;
-			ret->normalizeVolumeFaces();
-		}
-
-		ret->trimVolumeFacesToSize(LL_SCULPT_MESH_MAX_FACES, &remainder);
-
-		if (!mNoOptimize)
-		{
-			ret->optimizeVolumeFaces();
-		}
-
-		volume_faces = remainder.size();
-
-		models_out.push_back(ret);
-
-		// If we have left-over volume faces, create another model
-		// to absorb them...
-		//
-		if (volume_faces)
-		{
-			LLModel* next = new LLModel(volume_params, 0.f);
-			next->mSubmodelID = ++submodelID;
-			next->mLabel = model_name + (char)((int)'a' + next->mSubmodelID) + lod_suffix[mLod];
-			next->getVolumeFaces() = remainder;
-			next->mNormalizedScale = ret->mNormalizedScale;
-			next->mNormalizedTranslation = ret->mNormalizedTranslation;
-			if ( ret->mMaterialList.size() > LL_SCULPT_MESH_MAX_FACES)
-			{
-				next->mMaterialList.assign(ret->mMaterialList.begin() + LL_SCULPT_MESH_MAX_FACES, ret->mMaterialList.end());
-			}
-			ret = next;
-		}
-
-		remainder.clear();
-
-	} while (volume_faces);	
+	models_out = job->getModels();
 
 	return true;
 }
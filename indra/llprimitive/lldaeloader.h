@@ -30,6 +30,7 @@
 #include "llmodelloader.h"
 
 class DAE;
+class LLJobScheduler;
 class daeElement;
 class domProfile_COMMON;
 class domInstance_geometry;
@@ -64,6 +65,11 @@ public:
 
 	virtual bool OpenFile(const std::string& filename);
 
+	// Meshes are converted as jobs on scheduler, or one after the
+	// other on the loader thread if it is NULL. Uses the default
+	// scheduler unless set.
+	void setJobScheduler(LLJobScheduler* scheduler) { mJobScheduler = scheduler; }
+
 protected:
 
 	void processElement(daeElement* element, bool& badElement, DAE* dae);
@@ -106,8 +112,11 @@ protected:
 	static std::string preprocessDAE(std::string filename);
 
 private:
+	class MeshJob;
+
 	U32 mGeneratedModelLimit; // Attempt to limit amount of generated submodels
 	bool mPreprocessDAE;
+	LLJobScheduler* mJobScheduler;
 
 };
 #endif  // LL_LLDAELLOADER_H
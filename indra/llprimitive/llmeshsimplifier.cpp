@@ -0,0 +1,958 @@
+/**
+ * @file llmeshsimplifier.cpp
+ * @brief Quadric error metric simplification of LLVolumeFace meshes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmeshsimplifier.h"
+
+#include "lljobscheduler.h"
+#include "llmodel.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Border and seam edges are held in place by planes through the edge,
+	// perpendicular to its triangle, weighted by this times the edge length
+	// squared so they count for more than the surface around them.
+	const F64 BOUNDARY_WEIGHT = 10.0;
+
+	// Gives up on faces that stop making progress
+	const S32 MAX_PASSES = 100;
+
+	// Passes look at no fewer than 1/n of the triangles' worth of
+	// candidates, or the last few collapses take a pass each
+	const U32 MIN_PASS_FRACTION = 32;
+
+	const U32 INVALID = 0xFFFFFFFF;
+
+	// Plane quadric, sum of w * (n.p + d)^2, with the triangle area it covers
+	struct Quadric
+	{
+		F64 a00, a01, a02, a11, a12, a22;
+		F64 b0, b1, b2;
+		F64 c;
+		F64 mArea;
+
+		Quadric()
+			: a00(0.0), a01(0.0), a02(0.0), a11(0.0), a12(0.0), a22(0.0),
+			  b0(0.0), b1(0.0), b2(0.0), c(0.0), mArea(0.0)
+		{
+		}
+
+		void addPlane(const F64* n, F64 d, F64 w)
+		{
+			a00 += w * n[0] * n[0];
+			a01 += w * n[0] * n[1];
+			a02 += w * n[0] * n[2];
+			a11 += w * n[1] * n[1];
+			a12 += w * n[1] * n[2];
+			a22 += w * n[2] * n[2];
+			b0 += w * n[0] * d;
+			b1 += w * n[1] * d;
+			b2 += w * n[2] * d;
+			c += w * d * d;
+		}
+
+		void add(const Quadric& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02;
+			a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			mArea += q.mArea;
+		}
+
+		F64 eval(const F64* p) const
+		{
+			F64 x = p[0], y = p[1], z = p[2];
+			F64 r = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z
+				+ a11 * y * y + 2.0 * a12 * y * z + a22 * z * z
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return llmax(r, 0.0);
+		}
+	};
+
+	struct Edge
+	{
+		U32 mLow;		// lower position
+		U32 mHigh;		// higher position
+		U32 mWedges[2];	// vertices at mLow and mHigh
+		U32 mTri;
+
+		bool operator<(const Edge& rhs) const
+		{
+			return mLow != rhs.mLow ? mLow < rhs.mLow : mHigh < rhs.mHigh;
+		}
+	};
+
+	struct Collapse
+	{
+		U32 mFrom;
+		U32 mTo;
+		F64 mCost;
+
+		bool operator<(const Collapse& rhs) const
+		{
+			return mCost < rhs.mCost;
+		}
+	};
+
+	inline void sub3(const F64* a, const F64* b, F64* r)
+	{
+		r[0] = a[0] - b[0];
+		r[1] = a[1] - b[1];
+		r[2] = a[2] - b[2];
+	}
+
+	inline void cross3(const F64* a, const F64* b, F64* r)
+	{
+		r[0] = a[1] * b[2] - a[2] * b[1];
+		r[1] = a[2] * b[0] - a[0] * b[2];
+		r[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	inline F64 dot3(const F64* a, const F64* b)
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	// Unnormalized normal, twice the area long
+	inline void tri_normal(const F64* a, const F64* b, const F64* c, F64* n)
+	{
+		F64 e0[3], e1[3];
+		sub3(b, a, e0);
+		sub3(c, a, e1);
+		cross3(e0, e1, n);
+	}
+
+	//========================================================================
+	// Simplification state for one face. Vertices (wedges) that share a
+	// position are collapsed together, positions are what gets simplified.
+
+	class Simplifier
+	{
+	public:
+		Simplifier(const LLVolumeFace& src, const LLMeshSimplifier::position_list_t* locked);
+
+		void simplify(U32 target_triangles, F64 max_error);
+		void output(LLVolumeFace& dst) const;
+
+	private:
+		void weld();
+		void buildAdjacency();
+		void classify(bool add_boundary_quadrics);
+		void classifyEdges(const std::vector<Edge>& edges, bool add_boundary_quadrics);
+		void gatherCandidates(std::vector<Collapse>& candidates);
+		bool tryCollapse(U32 from, U32 to);
+		U32 collapse(const std::vector<Collapse>& candidates, U32 target_triangles, U32 limit,
+					 F64 max_cost, F64 max_error);
+		void removeDeadTriangles();
+
+		F64 error(U32 from, U32 to, F64 cost) const
+		{
+			F64 area = mQuadrics[from].mArea + mQuadrics[to].mArea;
+			return area > 0.0 ? sqrt(cost / area) : sqrt(cost);
+		}
+
+		const LLVolumeFace& mSrc;
+		const LLMeshSimplifier::position_list_t* mLocked;
+
+		std::vector<U32> mIndices;			// live triangles, by vertex
+		std::vector<U32> mWedgePosition;	// vertex to position
+		std::vector<F64> mPositions;		// xyz per position
+		std::vector<Quadric> mQuadrics;		// per position
+		std::vector<U8> mPinned;			// locked by the caller
+
+		// per pass
+		std::vector<U32> mFanStart;			// position to range in mFans
+		std::vector<U32> mFans;				// triangles around each position
+		std::vector<U8> mBoundaryCount;		// border and seam edges per position
+		std::vector<U32> mBoundaryNeighbor;	// 2 per position, the other ends of those edges
+		std::vector<U8> mFixed;				// can't move this pass
+		std::vector<U8> mTouched;			// changed this pass
+		std::vector<U8> mDead;				// triangle collapsed this pass
+		std::vector<F64> mVertexError;		// quadric error where each position is now
+		U32 mTriangleCount;
+	};
+
+	Simplifier::Simplifier(const LLVolumeFace& src, const LLMeshSimplifier::position_list_t* locked)
+		: mSrc(src),
+		  mLocked(locked),
+		  mTriangleCount(0)
+	{
+		mIndices.resize(src.mNumIndices - src.mNumIndices % 3);
+		for (U32 i = 0; i < mIndices.size(); ++i)
+		{
+			mIndices[i] = src.mIndices[i];
+		}
+		mTriangleCount = mIndices.size() / 3;
+
+		weld();
+		mQuadrics.resize(mPositions.size() / 3);
+
+		// Area weighted plane of every triangle on its corners
+		for (U32 i = 0; i < mIndices.size(); i += 3)
+		{
+			const F64* a = &mPositions[mWedgePosition[mIndices[i]] * 3];
+			const F64* b = &mPositions[mWedgePosition[mIndices[i + 1]] * 3];
+			const F64* c = &mPositions[mWedgePosition[mIndices[i + 2]] * 3];
+			F64 n[3];
+			tri_normal(a, b, c, n);
+			F64 len = sqrt(dot3(n, n));
+			if (len <= 0.0)
+			{
+				continue;
+			}
+			n[0] /= len;
+			n[1] /= len;
+			n[2] /= len;
+			F64 area = len * 0.5;
+			F64 d = -dot3(n, a);
+			for (U32 j = 0; j < 3; ++j)
+			{
+				Quadric& q = mQuadrics[mWedgePosition[mIndices[i + j]]];
+				q.addPlane(n, d, area);
+				q.mArea += area;
+			}
+		}
+
+		buildAdjacency();
+		classify(true);
+	}
+
+	void Simplifier::weld()
+	{
+		U32 count = mSrc.mNumVertices;
+		std::vector<U32> order(count);
+		for (U32 i = 0; i < count; ++i)
+		{
+			order[i] = i;
+		}
+
+		const LLVector4a* pos = mSrc.mPositions;
+		struct ComparePosition
+		{
+			const LLVector4a* mPos;
+			bool operator()(U32 a, U32 b) const
+			{
+				const F32* pa = mPos[a].getF32ptr();
+				const F32* pb = mPos[b].getF32ptr();
+				if (pa[0] != pb[0]) return pa[0] < pb[0];
+				if (pa[1] != pb[1]) return pa[1] < pb[1];
+				return pa[2] < pb[2];
+			}
+		} compare = { pos };
+		std::sort(order.begin(), order.end(), compare);
+
+		mWedgePosition.resize(count);
+		mPositions.reserve(count * 3);
+		for (U32 i = 0; i < count; ++i)
+		{
+			if (i == 0 || compare(order[i - 1], order[i]))
+			{
+				const F32* p = pos[order[i]].getF32ptr();
+				mPositions.push_back(p[0]);
+				mPositions.push_back(p[1]);
+				mPositions.push_back(p[2]);
+			}
+			mWedgePosition[order[i]] = mPositions.size() / 3 - 1;
+		}
+
+		U32 position_count = mPositions.size() / 3;
+		mPinned.assign(position_count, false);
+		if (mLocked && !mLocked->empty())
+		{
+			LLVolumeFace::VertexMapData::ComparePosition less;
+			for (U32 i = 0; i < position_count; ++i)
+			{
+				LLVector3 p(mPositions[i * 3], mPositions[i * 3 + 1], mPositions[i * 3 + 2]);
+				mPinned[i] = std::binary_search(mLocked->begin(), mLocked->end(), p, less);
+			}
+		}
+	}
+
+	void Simplifier::buildAdjacency()
+	{
+		U32 position_count = mPositions.size() / 3;
+		mFanStart.assign(position_count + 1, 0);
+		for (U32 i = 0; i < mIndices.size(); ++i)
+		{
+			mFanStart[mWedgePosition[mIndices[i]] + 1]++;
+		}
+		for (U32 i = 0; i < position_count; ++i)
+		{
+			mFanStart[i + 1] += mFanStart[i];
+		}
+
+		mFans.resize(mIndices.size());
+		std::vector<U32> fill(mFanStart.begin(), mFanStart.end() - 1);
+		for (U32 i = 0; i < mIndices.size(); ++i)
+		{
+			mFans[fill[mWedgePosition[mIndices[i]]]++] = i / 3;
+		}
+
+		mDead.assign(mIndices.size() / 3, false);
+	}
+
+	// Finds the border and seam edges. A vertex on exactly two of them can
+	// slide along them, any other vertex on one is fixed.
+	void Simplifier::classify(bool add_boundary_quadrics)
+	{
+		U32 position_count = mPositions.size() / 3;
+
+		mBoundaryCount.assign(position_count, 0);
+		mBoundaryNeighbor.assign(position_count * 2, INVALID);
+		mFixed.assign(mPinned.begin(), mPinned.end());
+
+		std::vector<Edge> edges;
+		for (U32 p = 0; p < position_count; ++p)
+		{
+			// Each edge is looked at from its lower end, where every
+			// triangle on it is in the fan
+			edges.clear();
+			for (U32 f = mFanStart[p]; f < mFanStart[p + 1]; ++f)
+			{
+				const U32* tri = &mIndices[mFans[f] * 3];
+				for (U32 k = 0; k < 3; ++k)
+				{
+					if (mWedgePosition[tri[k]] != p)
+					{
+						continue;
+					}
+					for (U32 other = 1; other < 3; ++other)
+					{
+						U32 w = tri[(k + other) % 3];
+						if (mWedgePosition[w] > p)
+						{
+							Edge edge;
+							edge.mLow = p;
+							edge.mHigh = mWedgePosition[w];
+							edge.mWedges[0] = tri[k];
+							edge.mWedges[1] = w;
+							edge.mTri = mFans[f];
+							edges.push_back(edge);
+						}
+					}
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			classifyEdges(edges, add_boundary_quadrics);
+		}
+
+		for (U32 p = 0; p < position_count; ++p)
+		{
+			if (mBoundaryCount[p] != 0 && mBoundaryCount[p] != 2)
+			{
+				mFixed[p] = true;
+			}
+		}
+	}
+
+	// Edges from one position, sorted
+	void Simplifier::classifyEdges(const std::vector<Edge>& edges, bool add_boundary_quadrics)
+	{
+		for (U32 i = 0; i < edges.size(); )
+		{
+			U32 j = i + 1;
+			while (j < edges.size() && edges[j].mLow == edges[i].mLow && edges[j].mHigh == edges[i].mHigh)
+			{
+				++j;
+			}
+
+			const Edge& edge = edges[i];
+			U32 count = j - i;
+			if (count > 2)
+			{
+				// non-manifold
+				mFixed[edge.mLow] = true;
+				mFixed[edge.mHigh] = true;
+			}
+			else if (count == 1
+					 || edge.mWedges[0] != edges[i + 1].mWedges[0]
+					 || edge.mWedges[1] != edges[i + 1].mWedges[1])
+			{
+				// border, or a seam when the two sides use different vertices
+				U32 ends[2] = { edge.mLow, edge.mHigh };
+				for (U32 k = 0; k < 2; ++k)
+				{
+					U32 p = ends[k];
+					U8& boundary = mBoundaryCount[p];
+					if (boundary < 2)
+					{
+						mBoundaryNeighbor[p * 2 + boundary] = ends[1 - k];
+					}
+					if (boundary < 3)
+					{
+						++boundary;
+					}
+				}
+
+				if (add_boundary_quadrics)
+				{
+					for (U32 k = i; k < j; ++k)
+					{
+						const U32* tri = &mIndices[edges[k].mTri * 3];
+						F64 n[3];
+						tri_normal(&mPositions[mWedgePosition[tri[0]] * 3],
+								   &mPositions[mWedgePosition[tri[1]] * 3],
+								   &mPositions[mWedgePosition[tri[2]] * 3], n);
+						const F64* a = &mPositions[edge.mLow * 3];
+						F64 e[3], m[3];
+						sub3(&mPositions[edge.mHigh * 3], a, e);
+						cross3(e, n, m);
+						F64 len = sqrt(dot3(m, m));
+						if (len <= 0.0)
+						{
+							continue;
+						}
+						m[0] /= len;
+						m[1] /= len;
+						m[2] /= len;
+						F64 w = dot3(e, e) * BOUNDARY_WEIGHT;
+						F64 d = -dot3(m, a);
+						mQuadrics[edge.mLow].addPlane(m, d, w);
+						mQuadrics[edge.mHigh].addPlane(m, d, w);
+					}
+				}
+			}
+			i = j;
+		}
+	}
+
+	// Cheapest collapse for each position that can move
+	void Simplifier::gatherCandidates(std::vector<Collapse>& candidates)
+	{
+		candidates.clear();
+		U32 position_count = mPositions.size() / 3;
+		mVertexError.resize(position_count);
+		for (U32 p = 0; p < position_count; ++p)
+		{
+			mVertexError[p] = mQuadrics[p].eval(&mPositions[p * 3]);
+		}
+		for (U32 p = 0; p < position_count; ++p)
+		{
+			if (mFixed[p] || mFanStart[p] == mFanStart[p + 1])
+			{
+				continue;
+			}
+
+			bool boundary = mBoundaryCount[p] == 2;
+			Collapse best;
+			best.mFrom = p;
+			best.mTo = INVALID;
+			best.mCost = 0.0;
+			for (U32 f = mFanStart[p]; f < mFanStart[p + 1]; ++f)
+			{
+				const U32* tri = &mIndices[mFans[f] * 3];
+				for (U32 k = 0; k < 3; ++k)
+				{
+					U32 to = mWedgePosition[tri[k]];
+					if (to == p || to == best.mTo)
+					{
+						continue;
+					}
+					if (boundary && to != mBoundaryNeighbor[p * 2] && to != mBoundaryNeighbor[p * 2 + 1])
+					{
+						continue;
+					}
+					const F64* target = &mPositions[to * 3];
+					F64 cost = mQuadrics[p].eval(target) + mVertexError[to];
+					if (best.mTo == INVALID || cost < best.mCost)
+					{
+						best.mTo = to;
+						best.mCost = cost;
+					}
+				}
+			}
+
+			if (best.mTo != INVALID)
+			{
+				candidates.push_back(best);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+	}
+
+	bool Simplifier::tryCollapse(U32 from, U32 to)
+	{
+		const U32 fan_begin = mFanStart[from];
+		const U32 fan_end = mFanStart[from + 1];
+
+		// Every vertex at from needs a vertex at to to become, taken from
+		// the triangles on the collapsed edge. A vertex that isn't on the
+		// edge has nothing to become and blocks the collapse.
+		U32 remap_from[8], remap_to[8];
+		U32 remap_count = 0;
+		U32 edge_triangles = 0;
+		for (U32 f = fan_begin; f < fan_end; ++f)
+		{
+			const U32* tri = &mIndices[mFans[f] * 3];
+			U32 w_from = INVALID, w_to = INVALID;
+			for (U32 k = 0; k < 3; ++k)
+			{
+				U32 p = mWedgePosition[tri[k]];
+				if (p == from) w_from = tri[k];
+				else if (p == to) w_to = tri[k];
+			}
+			if (w_to == INVALID)
+			{
+				continue;
+			}
+			++edge_triangles;
+
+			U32 k = 0;
+			while (k < remap_count && remap_from[k] != w_from)
+			{
+				++k;
+			}
+			if (k == remap_count)
+			{
+				if (remap_count == 8)
+				{
+					return false;
+				}
+				remap_from[k] = w_from;
+				remap_to[k] = w_to;
+				++remap_count;
+			}
+			else if (remap_to[k] != w_to)
+			{
+				return false;
+			}
+		}
+		if (edge_triangles == 0)
+		{
+			return false;
+		}
+
+		// The ends of the collapsed edge may only share the neighbors
+		// opposite the edge, or the mesh folds onto itself
+		U32 shared = 0;
+		for (U32 f = fan_begin; f < fan_end; ++f)
+		{
+			const U32* tri = &mIndices[mFans[f] * 3];
+			for (U32 k = 0; k < 3; ++k)
+			{
+				U32 n = mWedgePosition[tri[k]];
+				if (n == from || n == to)
+				{
+					continue;
+				}
+				bool seen = false;
+				for (U32 g = fan_begin; g < f && !seen; ++g)
+				{
+					const U32* prev = &mIndices[mFans[g] * 3];
+					seen = mWedgePosition[prev[0]] == n || mWedgePosition[prev[1]] == n || mWedgePosition[prev[2]] == n;
+				}
+				if (seen)
+				{
+					continue;
+				}
+				for (U32 g = mFanStart[to]; g < mFanStart[to + 1]; ++g)
+				{
+					const U32* other = &mIndices[mFans[g] * 3];
+					if (mWedgePosition[other[0]] == n || mWedgePosition[other[1]] == n || mWedgePosition[other[2]] == n)
+					{
+						++shared;
+						break;
+					}
+				}
+			}
+		}
+		if (shared > edge_triangles)
+		{
+			return false;
+		}
+
+		// No triangle left around from may flip over
+		const F64* target = &mPositions[to * 3];
+		for (U32 f = fan_begin; f < fan_end; ++f)
+		{
+			const U32* tri = &mIndices[mFans[f] * 3];
+			const F64* p[3];
+			const F64* moved[3];
+			bool on_edge = false;
+			for (U32 k = 0; k < 3; ++k)
+			{
+				U32 pos = mWedgePosition[tri[k]];
+				on_edge = on_edge || pos == to;
+				p[k] = &mPositions[pos * 3];
+				moved[k] = pos == from ? target : p[k];
+			}
+			if (on_edge)
+			{
+				continue;
+			}
+			F64 before[3], after[3];
+			tri_normal(p[0], p[1], p[2], before);
+			tri_normal(moved[0], moved[1], moved[2], after);
+			if (dot3(before, after) <= 0.0)
+			{
+				return false;
+			}
+		}
+
+		// Apply
+		for (U32 f = fan_begin; f < fan_end; ++f)
+		{
+			U32 t = mFans[f];
+			U32* tri = &mIndices[t * 3];
+			bool on_edge = false;
+			for (U32 k = 0; k < 3; ++k)
+			{
+				U32 pos = mWedgePosition[tri[k]];
+				if (pos == to)
+				{
+					on_edge = true;
+				}
+				else if (pos == from)
+				{
+					for (U32 r = 0; r < remap_count; ++r)
+					{
+						if (remap_from[r] == tri[k])
+						{
+							tri[k] = remap_to[r];
+							break;
+						}
+					}
+				}
+			}
+			if (on_edge)
+			{
+				mDead[t] = true;
+				--mTriangleCount;
+			}
+			for (U32 k = 0; k < 3; ++k)
+			{
+				mTouched[mWedgePosition[tri[k]]] = true;
+			}
+		}
+		mTouched[from] = true;
+		mQuadrics[to].add(mQuadrics[from]);
+		return true;
+	}
+
+	void Simplifier::removeDeadTriangles()
+	{
+		U32 out = 0;
+		for (U32 t = 0; t < mDead.size(); ++t)
+		{
+			if (!mDead[t])
+			{
+				mIndices[out++] = mIndices[t * 3];
+				mIndices[out++] = mIndices[t * 3 + 1];
+				mIndices[out++] = mIndices[t * 3 + 2];
+			}
+		}
+		mIndices.resize(out);
+	}
+
+	U32 Simplifier::collapse(const std::vector<Collapse>& candidates, U32 target_triangles, U32 limit,
+							 F64 max_cost, F64 max_error)
+	{
+		mTouched.assign(mPositions.size() / 3, false);
+		U32 collapsed = 0;
+		for (U32 i = 0; i < candidates.size() && collapsed < limit && mTriangleCount > target_triangles; ++i)
+		{
+			const Collapse& candidate = candidates[i];
+			if (candidate.mCost > max_cost)
+			{
+				break;
+			}
+			if (mTouched[candidate.mFrom] || mTouched[candidate.mTo])
+			{
+				continue;
+			}
+			if (max_error >= 0.0 && error(candidate.mFrom, candidate.mTo, candidate.mCost) > max_error)
+			{
+				continue;
+			}
+			if (tryCollapse(candidate.mFrom, candidate.mTo))
+			{
+				++collapsed;
+			}
+		}
+		return collapsed;
+	}
+
+	void Simplifier::simplify(U32 target_triangles, F64 max_error)
+	{
+		std::vector<Collapse> candidates;
+		for (S32 pass = 0; pass < MAX_PASSES && mTriangleCount > target_triangles; ++pass)
+		{
+			if (pass > 0)
+			{
+				buildAdjacency();
+				classify(false);
+			}
+
+			gatherCandidates(candidates);
+			if (candidates.empty())
+			{
+				break;
+			}
+
+			// Most collapses remove two triangles. Each pass makes up to
+			// half of those still needed, costing no more than the
+			// candidate twice that far down the list, and leaves the rest
+			// to be costed again against the simplified mesh.
+			U32 limit = llmax((mTriangleCount - target_triangles + 3) / 4, mTriangleCount / MIN_PASS_FRACTION + 1);
+			F64 max_cost = candidates[llmin(limit * 2, (U32) candidates.size()) - 1].mCost;
+			U32 collapsed = collapse(candidates, target_triangles, limit, max_cost, max_error);
+			if (collapsed == 0)
+			{
+				// the cheapest were all blocked, take what's left
+				collapsed = collapse(candidates, target_triangles, limit, F64_MAX, max_error);
+			}
+
+			removeDeadTriangles();
+			if (collapsed == 0)
+			{
+				break;
+			}
+		}
+	}
+
+	void Simplifier::output(LLVolumeFace& dst) const
+	{
+		std::vector<U32> remap(mSrc.mNumVertices, INVALID);
+		U32 vertex_count = 0;
+		for (U32 i = 0; i < mIndices.size(); ++i)
+		{
+			if (remap[mIndices[i]] == INVALID)
+			{
+				remap[mIndices[i]] = vertex_count++;
+			}
+		}
+
+		dst.resizeVertices(vertex_count);
+		dst.resizeIndices(mIndices.size());
+		if (mSrc.mWeights && vertex_count)
+		{
+			dst.allocateWeights(vertex_count);
+		}
+		else
+		{
+			ll_aligned_free_16(dst.mWeights);
+			dst.mWeights = NULL;
+		}
+
+		LLVector4a zero;
+		zero.clear();
+		for (U32 v = 0; v < (U32) mSrc.mNumVertices; ++v)
+		{
+			U32 i = remap[v];
+			if (i == INVALID)
+			{
+				continue;
+			}
+			dst.mPositions[i] = mSrc.mPositions[v];
+			dst.mNormals[i] = mSrc.mNormals ? mSrc.mNormals[v] : zero;
+			dst.mTexCoords[i] = mSrc.mTexCoords ? mSrc.mTexCoords[v] : LLVector2(0.f, 0.f);
+			if (dst.mWeights)
+			{
+				dst.mWeights[i] = mSrc.mWeights[v];
+			}
+		}
+
+		for (U32 i = 0; i < mIndices.size(); ++i)
+		{
+			dst.mIndices[i] = (U16) remap[mIndices[i]];
+		}
+
+		if (vertex_count && dst.mExtents)
+		{
+			dst.mExtents[0] = dst.mPositions[0];
+			dst.mExtents[1] = dst.mPositions[0];
+			for (U32 i = 1; i < vertex_count; ++i)
+			{
+				update_min_max(dst.mExtents[0], dst.mExtents[1], dst.mPositions[i]);
+			}
+			dst.mCenter->setAdd(dst.mExtents[0], dst.mExtents[1]);
+			dst.mCenter->mul(0.5f);
+		}
+	}
+}
+
+//============================================================================
+
+class LLMeshSimplifier::FaceJob : public LLJob
+{
+public:
+	FaceJob(const LLVolumeFace& src, LLVolumeFace& dst, EMode mode, U32 max_triangles, F32 max_error,
+			const position_list_t* locked)
+		: mSrc(src),
+		  mDst(dst),
+		  mMode(mode),
+		  mMaxTriangles(max_triangles),
+		  mMaxError(max_error),
+		  mLocked(locked)
+	{
+	}
+
+	/*virtual*/ void run()
+	{
+		LLMeshSimplifier::simplify(mSrc, mDst, mMode, mMaxTriangles, mMaxError, mLocked);
+	}
+
+	S32 getSize() const { return mSrc.mNumIndices; }
+
+	static bool compareSize(const LLPointer<FaceJob>& a, const LLPointer<FaceJob>& b)
+	{
+		return a->getSize() > b->getSize();
+	}
+
+private:
+	const LLVolumeFace& mSrc;
+	LLVolumeFace& mDst;
+	EMode mMode;
+	U32 mMaxTriangles;
+	F32 mMaxError;
+	const position_list_t* mLocked;
+};
+
+LLMeshSimplifier::LLMeshSimplifier()
+{
+}
+
+LLMeshSimplifier::~LLMeshSimplifier()
+{
+	mJobs.clear();
+	for (U32 i = 0; i < mSharedPositions.size(); ++i)
+	{
+		delete mSharedPositions[i];
+	}
+	mSharedPositions.clear();
+}
+
+void LLMeshSimplifier::addFace(const LLVolumeFace& src, LLVolumeFace& dst, EMode mode, U32 max_triangles, F32 max_error,
+							   const position_list_t* locked)
+{
+	mJobs.push_back(new FaceJob(src, dst, mode, max_triangles, max_error, locked));
+}
+
+void LLMeshSimplifier::addModel(const LLModel* src, LLModel* dst, EMode mode, U32 max_triangles, F32 max_error)
+{
+	S32 face_count = src->getNumVolumeFaces();
+	dst->setNumVolumeFaces(face_count);
+
+	position_list_t* shared = NULL;
+	if (face_count > 1)
+	{
+		shared = new position_list_t;
+		getSharedPositions(src, *shared);
+		mSharedPositions.push_back(shared);
+	}
+
+	F64 total_triangles = llmax(src->getNumTriangles(), 1);
+	for (S32 i = 0; i < face_count; ++i)
+	{
+		const LLVolumeFace& face = src->getVolumeFace(i);
+		U32 face_triangles = (U32) ((F64) max_triangles * (face.mNumIndices / 3) / total_triangles);
+		addFace(face, dst->getVolumeFace(i), mode, face_triangles, max_error, shared);
+	}
+}
+
+void LLMeshSimplifier::run(LLJobScheduler* scheduler)
+{
+	if (scheduler)
+	{
+		// Biggest faces first so they aren't left running alone at the end
+		std::stable_sort(mJobs.begin(), mJobs.end(), FaceJob::compareSize);
+		for (U32 i = 0; i < mJobs.size(); ++i)
+		{
+			scheduler->submit(mJobs[i].get());
+		}
+		for (U32 i = 0; i < mJobs.size(); ++i)
+		{
+			scheduler->waitFor(mJobs[i].get());
+		}
+	}
+	else
+	{
+		for (U32 i = 0; i < mJobs.size(); ++i)
+		{
+			mJobs[i]->run();
+		}
+	}
+	mJobs.clear();
+}
+
+// static
+void LLMeshSimplifier::simplify(const LLVolumeFace& src, LLVolumeFace& dst, EMode mode, U32 max_triangles, F32 max_error,
+								const position_list_t* locked)
+{
+	Simplifier simplifier(src, locked);
+	if (mode == TRIANGLE_BUDGET)
+	{
+		simplifier.simplify(max_triangles, -1.0);
+	}
+	else
+	{
+		simplifier.simplify(0, max_error);
+	}
+	simplifier.output(dst);
+}
+
+// static
+void LLMeshSimplifier::getSharedPositions(const LLModel* model, position_list_t& shared)
+{
+	LLVolumeFace::VertexMapData::ComparePosition less;
+	std::vector<std::pair<LLVector3, S32> > positions;
+	for (S32 f = 0; f < model->getNumVolumeFaces(); ++f)
+	{
+		const LLVolumeFace& face = model->getVolumeFace(f);
+		for (S32 v = 0; v < face.mNumVertices; ++v)
+		{
+			positions.push_back(std::make_pair(LLVector3(face.mPositions[v].getF32ptr()), f));
+		}
+	}
+
+	struct ComparePair
+	{
+		LLVolumeFace::VertexMapData::ComparePosition mLess;
+		bool operator()(const std::pair<LLVector3, S32>& a, const std::pair<LLVector3, S32>& b) const
+		{
+			if (mLess(a.first, b.first)) return true;
+			if (mLess(b.first, a.first)) return false;
+			return a.second < b.second;
+		}
+	};
+	std::sort(positions.begin(), positions.end(), ComparePair());
+
+	shared.clear();
+	for (U32 i = 1; i < positions.size(); ++i)
+	{
+		const LLVector3& p = positions[i].first;
+		if (!less(positions[i - 1].first, p)
+			&& positions[i - 1].second != positions[i].second
+			&& (shared.empty() || less(shared.back(), p)))
+		{
+			shared.push_back(p);
+		}
+	}
+}
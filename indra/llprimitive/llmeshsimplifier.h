@@ -0,0 +1,99 @@
+/**
+ * @file llmeshsimplifier.h
+ * @brief Quadric error metric simplification of LLVolumeFace meshes
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMESHSIMPLIFIER_H
+#define LL_LLMESHSIMPLIFIER_H
+
+#include "llpointer.h"
+#include "llvolume.h"
+
+#include <vector>
+
+class LLJobScheduler;
+class LLModel;
+
+//============================================================================
+// Generates lower levels of detail for model uploads.
+//
+// Faces are simplified by collapsing edges onto one of their existing
+// vertices, cheapest first by quadric error, so normals, texture coordinates
+// and skin weights of the remaining vertices are kept as they are. Vertices
+// on a UV or normal seam, or on an open border, may only slide along that
+// seam or border. Vertices a face shares with another face of the same
+// model are never moved, which keeps material boundaries closed.
+//
+// Usage: queue any number of faces or models, possibly for several levels
+// of detail, then run() them. Each face is simplified by its own job.
+
+class LLMeshSimplifier
+{
+public:
+	enum EMode
+	{
+		TRIANGLE_BUDGET = 0,	// stop at a triangle count
+		ERROR_THRESHOLD			// stop before an object space error
+	};
+
+	// A position shared with other faces, which must not move
+	typedef std::vector<LLVector3> position_list_t;
+
+	LLMeshSimplifier();
+	~LLMeshSimplifier();
+
+	// Queues src to be simplified into dst, which is replaced. Up to
+	// max_triangles are kept in TRIANGLE_BUDGET mode, collapses are made
+	// until the error would pass max_error in ERROR_THRESHOLD mode.
+	// src and locked must stay valid until run() returns.
+	void addFace(const LLVolumeFace& src, LLVolumeFace& dst, EMode mode, U32 max_triangles, F32 max_error,
+				 const position_list_t* locked = NULL);
+
+	// Queues every face of src, dst gets as many faces. The triangle budget
+	// is split between faces by their share of the triangles of src.
+	void addModel(const LLModel* src, LLModel* dst, EMode mode, U32 max_triangles, F32 max_error);
+
+	// Simplifies everything queued and returns once it is done. Without a
+	// scheduler, everything runs on the calling thread.
+	void run(LLJobScheduler* scheduler);
+
+	// Synchronous version for a single face
+	static void simplify(const LLVolumeFace& src, LLVolumeFace& dst, EMode mode, U32 max_triangles, F32 max_error,
+						 const position_list_t* locked = NULL);
+
+	// Positions that appear in more than one face of model, sorted
+	static void getSharedPositions(const LLModel* model, position_list_t& shared);
+
+private:
+	class FaceJob;
+
+	// No copy constructor or copy assignment
+	LLMeshSimplifier(const LLMeshSimplifier&);
+	LLMeshSimplifier& operator=(const LLMeshSimplifier&);
+
+	std::vector<LLPointer<FaceJob> > mJobs;
+	std::vector<position_list_t*> mSharedPositions;
+};
+
+#endif // LL_LLMESHSIMPLIFIER_H
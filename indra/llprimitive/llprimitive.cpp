@@ -109,11 +109,6 @@ const BOOL FLEXIBLE_OBJECT_DEFAULT_RENDERING_COLLISION_SPHERE = FALSE;
 
 const char *SCULPT_DEFAULT_TEXTURE = "be293869-d0d9-0a69-5989-ad27f1946fd4"; // old inverted texture: "7595d345-a24c-e7ef-f0bd-78793792133e";
 
-// Texture rotations are sent over the wire as a S16.  This is used to scale the actual float
-// value to a S16.   Don't use 7FFF as it introduces some odd rounding with 180 since it 
-// can't be divided by 2.   See DEV-19108
-const F32	TEXTURE_ROTATION_PACK_FACTOR = ((F32) 0x08000);
-
 //static 
 // LEGACY: by default we use the LLVolumeMgr::gVolumeMgr global
 // TODO -- eliminate this global from the codebase!
@@ -1409,41 +1404,41 @@ S32 LLPrimitive::applyParsedTEMessage(LLTEContents& tec)
 
 S32 LLPrimitive::unpackTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num)
 {
-	LLTEContents tec;
-	S32 retval = parseTEMessage(mesgsys, block_name, block_num, tec);
-	if (!retval)
-		return retval;
-	return applyParsedTEMessage(tec);
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
+	S32 size;
+	if (block_num < 0)
+	{
+		size = mesgsys->getSizeFast(block_name, _PREHASH_TextureEntry);
+	}
+	else
+	{
+		size = mesgsys->getSizeFast(block_name, block_num, _PREHASH_TextureEntry);
+	}
+
+	if (size <= 0)
+	{
+		return 0;
+	}
+	size = llmin(size, (S32)LLTEContents::MAX_TE_BUFFER);
+
+	if (block_num < 0)
+	{
+		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, 0, LLTEContents::MAX_TE_BUFFER);
+	}
+	else
+	{
+		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, block_num, LLTEContents::MAX_TE_BUFFER);
+	}
+
+	return applyTEEntrySet(LLTextureEntrySet::intern(packed_buffer, size, getNumTEs()));
 }
 
 S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 {
 	// use a negative block_num to indicate a single-block read (a non-variable block)
 	S32 retval = 0;
-	const U32 MAX_TES = 45;
-
-	// Avoid construction of 32 UUIDs per call
-	static LLUUID image_ids[MAX_TES];
-	static LLMaterialID material_ids[MAX_TES];
-
-	U8     image_data[MAX_TES*16];
-	U8	   colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-	U8     material_data[MAX_TES*16];
-
-	const U32 MAX_TE_BUFFER = 4096;
-	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
-
+	U8 packed_buffer[LLTEContents::MAX_TE_BUFFER];
 	S32 size;
-	U32 face_count = 0;
 
 	if (!dp.unpackBinaryData(packed_buffer, size, "TextureEntry"))
 	{
@@ -1457,69 +1452,74 @@ S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 		return retval;
 	}
 
-	face_count = llmin((U32) getNumTEs(), MAX_TES);
-	U32 i;
-
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_data, 16, face_count, MVT_LLUUID);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)colors, 4, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_s, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_t, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_s, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_t, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_rot, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)bump, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)media_flags, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)glow, 1, face_count, MVT_U8);
-	if (cur_ptr < packed_buffer + size)
-	{
-		cur_ptr++;
-		cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)material_data, 16, face_count, MVT_LLUUID);
-	}
-	else
-	{
-		memset(material_data, 0, sizeof(material_data));
-	}
+	return applyTEEntrySet(LLTextureEntrySet::intern(packed_buffer, size, getNumTEs()));
+}
 
-	for (i = 0; i < face_count; i++)
+// Faces that already have the values of the set are skipped, and so is the
+// whole set when the entries were last set from it and have not changed
+// since. The setTE* methods are called for everything else, as if each face
+// had been unpacked by hand.
+S32 LLPrimitive::applyTEEntrySet(const LLTextureEntrySet* te_set)
+{
+	S32 retval = 0;
+	const bool unchanged = mTextureList.getEntrySet() == te_set;
+	const U32 face_count = llmin(te_set->getFaceCount(), (U32)getNumTEs());
+	for (U32 i = 0; i < face_count; i++)
 	{
-		memcpy(image_ids[i].mData,&image_data[i*16],16);	/* Flawfinder: ignore */ 	
-		material_ids[i].set(&material_data[i * 16]);
-	}
-	
-	LLColor4 color;
-	LLColor4U coloru;
-	for (i = 0; i < face_count; i++)
-	{
-		retval |= setTETexture(i, image_ids[i]);
-		retval |= setTEScale(i, scale_s[i], scale_t[i]);
-		retval |= setTEOffset(i, (F32)offset_s[i] / (F32)0x7FFF, (F32) offset_t[i] / (F32) 0x7FFF);
-		retval |= setTERotation(i, ((F32)image_rot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
-		retval |= setTEBumpShinyFullbright(i, bump[i]);
-		retval |= setTEMediaTexGen(i, media_flags[i]);
-		retval |= setTEGlow(i, (F32)glow[i] / (F32)0xFF);
-		retval |= setTEMaterialID(i, material_ids[i]);
-		coloru = LLColor4U(colors + 4*i);
+		const LLTextureEntrySet::Face& face = te_set->getFace(i);
+		const LLTextureEntry* tep = getTE(i);
 
-		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-		// as all zeros.  However, the subtraction and addition must be done in unsigned
-		// byte space, not in float space, otherwise off-by-one errors occur. JC
-		color.mV[VRED]		= F32(255 - coloru.mV[VRED])   / 255.f;
-		color.mV[VGREEN]	= F32(255 - coloru.mV[VGREEN]) / 255.f;
-		color.mV[VBLUE]		= F32(255 - coloru.mV[VBLUE])  / 255.f;
-		color.mV[VALPHA]	= F32(255 - coloru.mV[VALPHA]) / 255.f;
+		// a null texture is always set again, the viewer picks its image
+		// when it is
+		if (unchanged || !tep)
+		{
+			if (face.mID.isNull())
+			{
+				retval |= setTETexture(i, face.mID);
+			}
+			continue;
+		}
 
-		retval |= setTEColor(i, color);
+		if (face.mID != tep->getID() || face.mID.isNull())
+		{
+			retval |= setTETexture(i, face.mID);
+		}
+		if (face.mScaleS != tep->mScaleS || face.mScaleT != tep->mScaleT)
+		{
+			retval |= setTEScale(i, face.mScaleS, face.mScaleT);
+		}
+		if (face.mOffsetS != tep->mOffsetS || face.mOffsetT != tep->mOffsetT)
+		{
+			retval |= setTEOffset(i, face.mOffsetS, face.mOffsetT);
+		}
+		if (face.mRotation != tep->mRotation)
+		{
+			retval |= setTERotation(i, face.mRotation);
+		}
+		if (face.mBump != tep->getBumpShinyFullbright())
+		{
+			retval |= setTEBumpShinyFullbright(i, face.mBump);
+		}
+		if (face.mMediaFlags != tep->getMediaTexGen())
+		{
+			retval |= setTEMediaTexGen(i, face.mMediaFlags);
+		}
+		if (face.mGlow != tep->getGlow())
+		{
+			retval |= setTEGlow(i, face.mGlow);
+		}
+		if (face.mMaterialID != tep->getMaterialID())
+		{
+			retval |= setTEMaterialID(i, face.mMaterialID);
+		}
+		if (face.mColor != tep->getColor())
+		{
+			retval |= setTEColor(i, face.mColor);
+		}
 	}
 
+	// the setters above forget any set the entries came from
+	mTextureList.setEntrySet(te_set);
 	return retval;
 }
 
@@ -35,6 +35,7 @@
 #include "llvolume.h"
 #include "lltextureentry.h"
 #include "llprimtexturelist.h"
+#include "lltextureentryset.h"
 
 // Moved to stdtypes.h --JC
 // typedef U8 LLPCode;
@@ -430,6 +431,7 @@ public:
 	BOOL unpackTEMessage(LLDataPacker &dp);
 	S32 parseTEMessage(LLMessageSystem* mesgsys, char const* block_name, const S32 block_num, LLTEContents& tec);
 	S32 applyParsedTEMessage(LLTEContents& tec);
+	S32 applyTEEntrySet(const LLTextureEntrySet* te_set);
 	
 #ifdef CHECK_FOR_FINITE
 	inline void setPosition(const LLVector3& pos);
@@ -485,6 +487,8 @@ public:
 	// takes the contents of other_list and clears other_list
 	void takeTextureList(LLPrimTextureList& other_list);
 
+	const LLPrimTextureList& getTextureList() const { return mTextureList; }
+
 	inline BOOL	isAvatar() const;
 	inline BOOL	isSittingAvatar() const;
 	inline BOOL	isSittingAvatarOnGround() const;
@@ -74,6 +74,7 @@ void LLPrimTextureList::clear()
 		++itr;
 	}
 	mEntryList.clear();
+	mEntrySet = NULL;
 }
 
 
@@ -85,6 +86,7 @@ void LLPrimTextureList::copy(const LLPrimTextureList& other_list)
 	// compare the sizes
 	S32 this_size = mEntryList.size();
 	S32 other_size = other_list.mEntryList.size();
+	mEntrySet = other_list.mEntrySet;
 
 	if (this_size > other_size)
 	{
@@ -120,6 +122,8 @@ void LLPrimTextureList::take(LLPrimTextureList& other_list)
 	clear();
 	mEntryList = other_list.mEntryList;
 	other_list.mEntryList.clear();
+	mEntrySet = other_list.mEntrySet;
+	other_list.mEntrySet = NULL;
 }
 
 // virtual 
@@ -137,6 +141,7 @@ S32 LLPrimTextureList::copyTexture(const U8 index, const LLTextureEntry& te)
 		// we're changing an existing entry
 	llassert(mEntryList[index]);
 	delete (mEntryList[index]);
+	mEntrySet = NULL;
 	if  (&te)
 	{
 		mEntryList[index] = te.newCopy();
@@ -163,6 +168,7 @@ S32 LLPrimTextureList::takeTexture(const U8 index, LLTextureEntry* te)
 	llassert(mEntryList[index]);
 	delete (mEntryList[index]);
 	mEntryList[index] = te;
+	mEntrySet = NULL;
 	return TEM_CHANGE_TEXTURE;
 }
 
@@ -179,11 +185,20 @@ LLTextureEntry* LLPrimTextureList::getTexture(const U8 index) const
 //virtual 
 //S32 setTE(const U8 index, const LLTextureEntry& te) = 0;
 
+S32 LLPrimTextureList::entryChanged(S32 result)
+{
+	if (result != TEM_CHANGE_NONE)
+	{
+		mEntrySet = NULL;
+	}
+	return result;
+}
+
 S32 LLPrimTextureList::setID(const U8 index, const LLUUID& id)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setID(id);
+		return entryChanged(mEntryList[index]->setID(id));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -192,7 +207,7 @@ S32 LLPrimTextureList::setColor(const U8 index, const LLColor3& color)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setColor(color);
+		return entryChanged(mEntryList[index]->setColor(color));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -201,7 +216,7 @@ S32 LLPrimTextureList::setColor(const U8 index, const LLColor4& color)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setColor(color);
+		return entryChanged(mEntryList[index]->setColor(color));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -210,7 +225,7 @@ S32 LLPrimTextureList::setAlpha(const U8 index, const F32 alpha)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setAlpha(alpha);
+		return entryChanged(mEntryList[index]->setAlpha(alpha));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -219,7 +234,7 @@ S32 LLPrimTextureList::setScale(const U8 index, const F32 s, const F32 t)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setScale(s, t);
+		return entryChanged(mEntryList[index]->setScale(s, t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -228,7 +243,7 @@ S32 LLPrimTextureList::setScaleS(const U8 index, const F32 s)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setScaleS(s);
+		return entryChanged(mEntryList[index]->setScaleS(s));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -237,7 +252,7 @@ S32 LLPrimTextureList::setScaleT(const U8 index, const F32 t)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setScaleT(t);
+		return entryChanged(mEntryList[index]->setScaleT(t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -246,7 +261,7 @@ S32 LLPrimTextureList::setOffset(const U8 index, const F32 s, const F32 t)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffset(s, t);
+		return entryChanged(mEntryList[index]->setOffset(s, t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -255,7 +270,7 @@ S32 LLPrimTextureList::setOffsetS(const U8 index, const F32 s)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffsetS(s);
+		return entryChanged(mEntryList[index]->setOffsetS(s));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -264,7 +279,7 @@ S32 LLPrimTextureList::setOffsetT(const U8 index, const F32 t)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setOffsetT(t);
+		return entryChanged(mEntryList[index]->setOffsetT(t));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -273,7 +288,7 @@ S32 LLPrimTextureList::setRotation(const U8 index, const F32 r)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setRotation(r);
+		return entryChanged(mEntryList[index]->setRotation(r));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -282,7 +297,7 @@ S32 LLPrimTextureList::setBumpShinyFullbright(const U8 index, const U8 bump)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpShinyFullbright(bump);
+		return entryChanged(mEntryList[index]->setBumpShinyFullbright(bump));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -291,7 +306,7 @@ S32 LLPrimTextureList::setMediaTexGen(const U8 index, const U8 media)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setMediaTexGen(media);
+		return entryChanged(mEntryList[index]->setMediaTexGen(media));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -300,7 +315,7 @@ S32 LLPrimTextureList::setBumpMap(const U8 index, const U8 bump)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpmap(bump);
+		return entryChanged(mEntryList[index]->setBumpmap(bump));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -309,7 +324,7 @@ S32 LLPrimTextureList::setBumpShiny(const U8 index, const U8 bump_shiny)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setBumpShiny(bump_shiny);
+		return entryChanged(mEntryList[index]->setBumpShiny(bump_shiny));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -318,7 +333,7 @@ S32 LLPrimTextureList::setTexGen(const U8 index, const U8 texgen)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setTexGen(texgen);
+		return entryChanged(mEntryList[index]->setTexGen(texgen));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -327,7 +342,7 @@ S32 LLPrimTextureList::setShiny(const U8 index, const U8 shiny)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setShiny(shiny);
+		return entryChanged(mEntryList[index]->setShiny(shiny));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -336,7 +351,7 @@ S32 LLPrimTextureList::setFullbright(const U8 index, const U8 fullbright)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setFullbright(fullbright);
+		return entryChanged(mEntryList[index]->setFullbright(fullbright));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -345,7 +360,7 @@ S32 LLPrimTextureList::setMediaFlags(const U8 index, const U8 media_flags)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setMediaFlags(media_flags);
+		return entryChanged(mEntryList[index]->setMediaFlags(media_flags));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -354,7 +369,7 @@ S32 LLPrimTextureList::setGlow(const U8 index, const F32 glow)
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setGlow(glow);
+		return entryChanged(mEntryList[index]->setGlow(glow));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -363,7 +378,7 @@ S32 LLPrimTextureList::setMaterialID(const U8 index, const LLMaterialID& pMateri
 {
 	if (index < mEntryList.size())
 	{
-		return mEntryList[index]->setMaterialID(pMaterialID);
+		return entryChanged(mEntryList[index]->setMaterialID(pMaterialID));
 	}
 	return TEM_CHANGE_NONE;
 }
@@ -401,6 +416,10 @@ void LLPrimTextureList::setSize(S32 new_size)
 	}
 
 	S32 current_size = mEntryList.size();
+	if (new_size != current_size)
+	{
+		mEntrySet = NULL;
+	}
 
 	if (new_size > current_size)
 	{
@@ -434,6 +453,7 @@ void LLPrimTextureList::setSize(S32 new_size)
 
 void LLPrimTextureList::setAllIDs(const LLUUID& id)
 {
+	mEntrySet = NULL;
 	texture_list_t::iterator itr = mEntryList.begin();
 	while (itr != mEntryList.end())
 	{
@@ -32,6 +32,7 @@
 #include "v3color.h"
 #include "v4color.h"
 #include "llmaterial.h"
+#include "lltextureentryset.h"
 
 
 class LLTextureEntry;
@@ -115,8 +116,20 @@ public:
 	void setSize(S32 new_size);
 
 	void setAllIDs(const LLUUID& id);
+
+	// The shared set the entries were last set from, or NULL once any of
+	// them has changed. Changes made through getTexture() are not seen, so
+	// only selection and material params should be changed that way.
+	const LLTextureEntrySet* getEntrySet() const { return mEntrySet; }
+	void setEntrySet(const LLTextureEntrySet* entry_set) { mEntrySet = entry_set; }
+
+protected:
+	// Forgets the shared set when a setter reports a change
+	S32 entryChanged(S32 result);
+
 protected:
 	texture_list_t mEntryList;
+	LLPointer<const LLTextureEntrySet> mEntrySet;
 private:
 	LLPrimTextureList(const LLPrimTextureList& other_list)
 	{
@@ -0,0 +1,321 @@
+/**
+ * @file lltextureentryset.cpp
+ * @brief Decoded TextureEntry blobs, interned and shared between prims
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltextureentryset.h"
+
+#include "llmath.h"
+#include "message.h"
+
+#include <boost/functional/hash.hpp>
+
+// The table is not purged until it holds this many sets
+const U32 MIN_PURGE_COUNT = 1024;
+
+LLTextureEntrySet::table_t LLTextureEntrySet::sTable;
+U32 LLTextureEntrySet::sPurgeCount = MIN_PURGE_COUNT;
+
+namespace
+{
+	// Reads the fields of a TextureEntry blob, in the layout packTEField()
+	// writes them. A field is a value for every face followed by
+	// exceptions, each a bitfield of faces (7 bits to the byte, high bit set
+	// on all bytes but the last) and the value for those faces. A zero byte
+	// ends the field. Bytes past the end of the blob read as zero.
+	class TEFieldReader
+	{
+	public:
+		TEFieldReader(const U8* blob, S32 size)
+		:	mCur(blob),
+			mEnd(blob + size)
+		{
+		}
+
+		bool atEnd() const { return mCur >= mEnd; }
+
+		void readValue(U8* value, U8 data_size, EMsgVariableType type)
+		{
+			U8 buffer[MAX_TE_VALUE_SIZE];
+			S32 available = llclamp((S32)(mEnd - mCur), 0, (S32)data_size);
+			memcpy(buffer, mCur, available);	/* Flawfinder: ignore */
+			memset(buffer + available, 0, data_size - available);
+			htolememcpy(value, buffer, type, data_size);
+			mCur += data_size;
+		}
+
+		// Returns false at the end of the field
+		bool readExceptionFaces(U64& faces)
+		{
+			if (atEnd() || *mCur == 0)
+			{
+				return false;
+			}
+			faces = 0;
+			while (!atEnd() && (*mCur & 0x80))
+			{
+				faces |= ((*mCur++) & 0x7F);
+				faces = faces << 7;
+			}
+			if (!atEnd())
+			{
+				faces |= *mCur++;
+			}
+			return true;
+		}
+
+		void skipSeparator() { ++mCur; }
+
+		static const U8 MAX_TE_VALUE_SIZE = 16;
+
+	private:
+		const U8*	mCur;
+		const U8*	mEnd;
+	};
+
+	typedef LLTextureEntrySet::Face Face;
+
+	// Each stores a value of one field, as read from the blob, in a face
+	typedef void (*store_func_t)(Face& face, const U8* value);
+
+	void store_id(Face& face, const U8* value)
+	{
+		memcpy(face.mID.mData, value, UUID_BYTES);	/* Flawfinder: ignore */
+	}
+
+	void store_color(Face& face, const U8* value)
+	{
+		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
+		// as all zeros.  However, the subtraction and addition must be done in unsigned
+		// byte space, not in float space, otherwise off-by-one errors occur. JC
+		face.mColor.mV[VRED]	= F32(255 - value[VRED])   / 255.f;
+		face.mColor.mV[VGREEN]	= F32(255 - value[VGREEN]) / 255.f;
+		face.mColor.mV[VBLUE]	= F32(255 - value[VBLUE])  / 255.f;
+		face.mColor.mV[VALPHA]	= F32(255 - value[VALPHA]) / 255.f;
+	}
+
+	void store_scale_s(Face& face, const U8* value)
+	{
+		memcpy(&face.mScaleS, value, sizeof(F32));	/* Flawfinder: ignore */
+	}
+
+	void store_scale_t(Face& face, const U8* value)
+	{
+		memcpy(&face.mScaleT, value, sizeof(F32));	/* Flawfinder: ignore */
+	}
+
+	S16 read_s16(const U8* value)
+	{
+		S16 packed;
+		memcpy(&packed, value, sizeof(S16));	/* Flawfinder: ignore */
+		return packed;
+	}
+
+	void store_offset_s(Face& face, const U8* value)
+	{
+		face.mOffsetS = (F32)read_s16(value) / (F32)0x7FFF;
+	}
+
+	void store_offset_t(Face& face, const U8* value)
+	{
+		face.mOffsetT = (F32)read_s16(value) / (F32)0x7FFF;
+	}
+
+	void store_rotation(Face& face, const U8* value)
+	{
+		face.mRotation = ((F32)read_s16(value) / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI;
+	}
+
+	void store_bump(Face& face, const U8* value)
+	{
+		face.mBump = value[0];
+	}
+
+	void store_media_flags(Face& face, const U8* value)
+	{
+		face.mMediaFlags = value[0];
+	}
+
+	void store_glow(Face& face, const U8* value)
+	{
+		face.mGlow = (F32)value[0] / (F32)0xFF;
+	}
+
+	void store_material_id(Face& face, const U8* value)
+	{
+		face.mMaterialID.set(value);
+	}
+
+	void read_field(TEFieldReader& reader, U8 data_size, EMsgVariableType type, std::vector<Face>& faces, store_func_t store)
+	{
+		U8 value[TEFieldReader::MAX_TE_VALUE_SIZE];
+		reader.readValue(value, data_size, type);
+		for (U32 i = 0; i < faces.size(); ++i)
+		{
+			store(faces[i], value);
+		}
+
+		U64 exception_faces;
+		while (reader.readExceptionFaces(exception_faces))
+		{
+			reader.readValue(value, data_size, type);
+			for (U32 i = 0; i < faces.size(); ++i)
+			{
+				if (exception_faces & 0x01)
+				{
+					store(faces[i], value);
+				}
+				exception_faces = exception_faces >> 1;
+			}
+		}
+	}
+}
+
+LLTextureEntrySet::LLTextureEntrySet(const U8* blob, S32 size, U32 face_count)
+:	mBlob(blob, blob + llmax(size, 0))
+{
+	decode(llmin(face_count, MAX_TES));
+}
+
+LLTextureEntrySet::~LLTextureEntrySet()
+{
+}
+
+void LLTextureEntrySet::decode(U32 face_count)
+{
+	mFaces.resize(face_count);
+	if (mBlob.empty())
+	{
+		return;
+	}
+
+	TEFieldReader reader(&mBlob[0], mBlob.size());
+	read_field(reader, UUID_BYTES, MVT_LLUUID, mFaces, store_id);
+	reader.skipSeparator();
+	read_field(reader, 4, MVT_U8, mFaces, store_color);
+	reader.skipSeparator();
+	read_field(reader, 4, MVT_F32, mFaces, store_scale_s);
+	reader.skipSeparator();
+	read_field(reader, 4, MVT_F32, mFaces, store_scale_t);
+	reader.skipSeparator();
+	read_field(reader, 2, MVT_S16Array, mFaces, store_offset_s);
+	reader.skipSeparator();
+	read_field(reader, 2, MVT_S16Array, mFaces, store_offset_t);
+	reader.skipSeparator();
+	read_field(reader, 2, MVT_S16Array, mFaces, store_rotation);
+	reader.skipSeparator();
+	read_field(reader, 1, MVT_U8, mFaces, store_bump);
+	reader.skipSeparator();
+	read_field(reader, 1, MVT_U8, mFaces, store_media_flags);
+	reader.skipSeparator();
+	read_field(reader, 1, MVT_U8, mFaces, store_glow);
+
+	// material ids were added later, older blobs end here and the faces
+	// keep the null id they were made with
+	if (!reader.atEnd())
+	{
+		reader.skipSeparator();
+		read_field(reader, UUID_BYTES, MVT_LLUUID, mFaces, store_material_id);
+	}
+}
+
+bool LLTextureEntrySet::matches(const U8* blob, S32 size, U32 face_count) const
+{
+	return mFaces.size() == face_count
+		&& (S32)mBlob.size() == size
+		&& (size == 0 || !memcmp(&mBlob[0], blob, size));
+}
+
+//static
+size_t LLTextureEntrySet::hash(const U8* blob, S32 size, U32 face_count)
+{
+	size_t seed = boost::hash_range(blob, blob + size);
+	boost::hash_combine(seed, face_count);
+	return seed;
+}
+
+//static
+LLPointer<const LLTextureEntrySet> LLTextureEntrySet::intern(const U8* blob, S32 size, U32 face_count)
+{
+	size = llmax(size, 0);
+	face_count = llmin(face_count, MAX_TES);
+	size_t key = hash(blob, size, face_count);
+
+	std::pair<table_t::iterator, table_t::iterator> range = sTable.equal_range(key);
+	for (table_t::iterator iter = range.first; iter != range.second; ++iter)
+	{
+		if (iter->second->matches(blob, size, face_count))
+		{
+			return iter->second.get();
+		}
+	}
+
+	if (sTable.size() >= sPurgeCount)
+	{
+		purgeUnused();
+	}
+
+	LLTextureEntrySet* te_set = new LLTextureEntrySet(blob, size, face_count);
+	sTable.insert(table_t::value_type(key, te_set));
+	return te_set;
+}
+
+//static
+void LLTextureEntrySet::purgeUnused()
+{
+	table_t::iterator iter = sTable.begin();
+	while (iter != sTable.end())
+	{
+		if (iter->second->getNumRefs() == 1)
+		{
+			iter = sTable.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+	sPurgeCount = llmax(MIN_PURGE_COUNT, (U32)sTable.size() * 2);
+}
+
+//static
+U32 LLTextureEntrySet::getInternedCount()
+{
+	return sTable.size();
+}
+
+//static
+size_t LLTextureEntrySet::getInternedBytes()
+{
+	size_t bytes = sTable.bucket_count() * sizeof(void*);
+	for (table_t::const_iterator iter = sTable.begin(); iter != sTable.end(); ++iter)
+	{
+		const LLTextureEntrySet* te_set = iter->second;
+		bytes += sizeof(table_t::value_type) + sizeof(LLTextureEntrySet)
+			+ te_set->mBlob.capacity() + te_set->mFaces.capacity() * sizeof(Face);
+	}
+	return bytes;
+}
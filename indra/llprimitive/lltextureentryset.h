@@ -0,0 +1,109 @@
+/**
+ * @file lltextureentryset.h
+ * @brief Decoded TextureEntry blobs, interned and shared between prims
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREENTRYSET_H
+#define LL_LLTEXTUREENTRYSET_H
+
+#include "llmaterialid.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "lluuid.h"
+#include "v4color.h"
+
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+// Texture rotations are sent over the wire as a S16.  This is used to scale the actual float
+// value to a S16.   Don't use 7FFF as it introduces some odd rounding with 180 since it 
+// can't be divided by 2.   See DEV-19108
+const F32 TEXTURE_ROTATION_PACK_FACTOR = ((F32) 0x08000);
+
+// The per face values of a TextureEntry blob, decoded once and never
+// changed afterwards. Builds are mostly made of prims with the same
+// textures, so intern() hands every prim that receives the same blob the
+// same set, and a prim that is sent a set it already shows can skip it.
+// This saves decoding, not memory: every prim still keeps its own
+// LLTextureEntry for each face, and the sets come on top of those.
+class LLTextureEntrySet : public LLRefCount
+{
+public:
+	static const U32 MAX_TES = 45;
+
+	// What the setTE* methods are called with for one face
+	struct Face
+	{
+		LLUUID			mID;
+		LLColor4		mColor;
+		F32				mScaleS;
+		F32				mScaleT;
+		F32				mOffsetS;
+		F32				mOffsetT;
+		F32				mRotation;
+		U8				mBump;
+		U8				mMediaFlags;
+		F32				mGlow;
+		LLMaterialID	mMaterialID;
+	};
+
+	// Returns the set for the first face_count faces of the blob, decoding
+	// it only if no live set was made from the same bytes. Main thread only.
+	static LLPointer<const LLTextureEntrySet> intern(const U8* blob, S32 size, U32 face_count);
+
+	// Decodes the blob without interning it
+	LLTextureEntrySet(const U8* blob, S32 size, U32 face_count);
+
+	U32 getFaceCount() const { return mFaces.size(); }
+	const Face& getFace(U32 index) const { return mFaces[index]; }
+	S32 getBlobSize() const { return mBlob.size(); }
+
+	// Sets in the table and the memory they add
+	static U32 getInternedCount();
+	static size_t getInternedBytes();
+
+	// Drops the sets no prim holds any more. intern() does this as the
+	// table grows, so it only needs calling to get an exact count.
+	static void purgeUnused();
+
+protected:
+	~LLTextureEntrySet();
+
+private:
+	void decode(U32 face_count);
+	bool matches(const U8* blob, S32 size, U32 face_count) const;
+
+	static size_t hash(const U8* blob, S32 size, U32 face_count);
+
+	typedef boost::unordered_multimap<size_t, LLPointer<LLTextureEntrySet> > table_t;
+
+private:
+	std::vector<U8>		mBlob;
+	std::vector<Face>	mFaces;
+
+	static table_t		sTable;
+	static U32			sPurgeCount;	// table size that triggers the next purge
+};
+
+#endif // LL_LLTEXTUREENTRYSET_H
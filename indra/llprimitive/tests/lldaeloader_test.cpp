@@ -0,0 +1,319 @@
+/**
+ * @file lldaeloader_test.cpp
+ * @brief Tests and import benchmark for LLDAELoader.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldaeloader.h"
+
+#include "lljobscheduler.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+
+#include <sstream>
+
+namespace
+{
+	// Sample building kit: parts x parts pieces, each a rippled size x size
+	// grid. The first half of each grid is a <triangles> list using the
+	// "wall" material, the rest a <polylist> of quads using "trim".
+	std::string make_kit(S32 parts, S32 size)
+	{
+		std::ostringstream dae;
+		dae << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			<< "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n"
+			<< "<asset><created>2026-01-01T00:00:00</created><modified>2026-01-01T00:00:00</modified>"
+			<< "<unit name=\"meter\" meter=\"1\"/><up_axis>Z_UP</up_axis></asset>\n"
+			<< "<library_geometries>\n";
+
+		S32 row = size + 1;
+		S32 verts = row * row;
+		for (S32 part = 0; part < parts; ++part)
+		{
+			std::string id = llformat("part%d", part);
+			std::ostringstream positions, normals, uvs;
+			for (S32 j = 0; j < row; ++j)
+			{
+				for (S32 i = 0; i < row; ++i)
+				{
+					F32 x = (F32) i / size;
+					F32 y = (F32) j / size;
+					F32 phase = 0.37f * part;
+					F32 z = 0.05f * sinf(6.f * x + phase) * cosf(4.f * y + phase);
+					LLVector3 n(-0.3f * cosf(6.f * x + phase) * cosf(4.f * y + phase),
+								0.2f * sinf(6.f * x + phase) * sinf(4.f * y + phase),
+								1.f);
+					n.normalize();
+					positions << x << ' ' << y << ' ' << z << ' ';
+					normals << n.mV[0] << ' ' << n.mV[1] << ' ' << n.mV[2] << ' ';
+					uvs << x << ' ' << y << ' ';
+				}
+			}
+
+			std::ostringstream tris, quads, vcount;
+			S32 tri_count = 0;
+			S32 quad_count = 0;
+			for (S32 j = 0; j < size; ++j)
+			{
+				for (S32 i = 0; i < size; ++i)
+				{
+					S32 v = j * row + i;
+					if (j < size / 2)
+					{
+						tris << v << ' ' << v + 1 << ' ' << v + row + 1 << ' '
+							 << v << ' ' << v + row + 1 << ' ' << v + row << ' ';
+						tri_count += 2;
+					}
+					else
+					{
+						quads << v << ' ' << v + 1 << ' ' << v + row + 1 << ' ' << v + row << ' ';
+						vcount << "4 ";
+						++quad_count;
+					}
+				}
+			}
+
+			std::string inputs = "<input semantic=\"VERTEX\" source=\"#" + id + "-vertices\" offset=\"0\"/>"
+								 "<input semantic=\"NORMAL\" source=\"#" + id + "-normals\" offset=\"0\"/>"
+								 "<input semantic=\"TEXCOORD\" source=\"#" + id + "-uvs\" offset=\"0\" set=\"0\"/>";
+
+			dae << "<geometry id=\"" << id << "-mesh\" name=\"" << id << "\"><mesh>\n"
+				<< "<source id=\"" << id << "-positions\"><float_array id=\"" << id << "-positions-array\" count=\"" << verts * 3 << "\">"
+				<< positions.str() << "</float_array><technique_common><accessor source=\"#" << id << "-positions-array\" count=\""
+				<< verts << "\" stride=\"3\"><param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/>"
+				<< "<param name=\"Z\" type=\"float\"/></accessor></technique_common></source>\n"
+				<< "<source id=\"" << id << "-normals\"><float_array id=\"" << id << "-normals-array\" count=\"" << verts * 3 << "\">"
+				<< normals.str() << "</float_array><technique_common><accessor source=\"#" << id << "-normals-array\" count=\""
+				<< verts << "\" stride=\"3\"><param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/>"
+				<< "<param name=\"Z\" type=\"float\"/></accessor></technique_common></source>\n"
+				<< "<source id=\"" << id << "-uvs\"><float_array id=\"" << id << "-uvs-array\" count=\"" << verts * 2 << "\">"
+				<< uvs.str() << "</float_array><technique_common><accessor source=\"#" << id << "-uvs-array\" count=\""
+				<< verts << "\" stride=\"2\"><param name=\"S\" type=\"float\"/><param name=\"T\" type=\"float\"/>"
+				<< "</accessor></technique_common></source>\n"
+				<< "<vertices id=\"" << id << "-vertices\"><input semantic=\"POSITION\" source=\"#" << id << "-positions\"/></vertices>\n"
+				<< "<triangles material=\"wall\" count=\"" << tri_count << "\">" << inputs << "<p>" << tris.str() << "</p></triangles>\n"
+				<< "<polylist material=\"trim\" count=\"" << quad_count << "\">" << inputs
+				<< "<vcount>" << vcount.str() << "</vcount><p>" << quads.str() << "</p></polylist>\n"
+				<< "</mesh></geometry>\n";
+		}
+
+		dae << "</library_geometries>\n"
+			<< "<library_visual_scenes><visual_scene id=\"Scene\" name=\"Scene\">\n";
+		for (S32 part = 0; part < parts; ++part)
+		{
+			dae << llformat("<node id=\"node%d\" name=\"node%d\" type=\"NODE\"><translate>%d 0 0</translate>"
+							"<instance_geometry url=\"#part%d-mesh\"/></node>\n", part, part, 2 * part, part);
+		}
+		dae << "</visual_scene></library_visual_scenes>\n"
+			<< "<scene><instance_visual_scene url=\"#Scene\"/></scene>\n"
+			<< "</COLLADA>\n";
+		return dae.str();
+	}
+
+	void state_callback(U32 state, void* opaque)
+	{
+	}
+
+	// Loads filename with the given scheduler, NULL for the serial path
+	class TestLoader
+	{
+	public:
+		TestLoader(const std::string& filename, LLJobScheduler* scheduler)
+		:	mLoader(filename, LLModel::LOD_HIGH,
+					LLModelLoader::load_callback_t(),
+					LLModelLoader::joint_lookup_func_t(),
+					LLModelLoader::texture_load_func_t(),
+					state_callback,
+					NULL,
+					mJointTransforms,
+					mJointsFromNodes,
+					mJointAliases,
+					110,
+					768,
+					false)
+		{
+			mLoader.setJobScheduler(scheduler);
+			mResult = mLoader.OpenFile(filename);
+		}
+
+		JointTransformMap mJointTransforms;
+		JointNameSet mJointsFromNodes;
+		std::map<std::string, std::string> mJointAliases;
+		LLDAELoader mLoader;
+		bool mResult;
+	};
+
+	bool same_face(const LLVolumeFace& a, const LLVolumeFace& b)
+	{
+		if (a.mNumVertices != b.mNumVertices || a.mNumIndices != b.mNumIndices)
+		{
+			return false;
+		}
+		for (S32 i = 0; i < a.mNumVertices; ++i)
+		{
+			if (!a.mPositions[i].equals3(b.mPositions[i]) || !a.mNormals[i].equals3(b.mNormals[i]))
+			{
+				return false;
+			}
+		}
+		return 0 == memcmp(a.mIndices, b.mIndices, a.mNumIndices * sizeof(U16));
+	}
+}
+
+namespace tut
+{
+	struct dae_loader
+	{
+	};
+
+	typedef test_group<dae_loader> dae_loader_test;
+	typedef dae_loader_test::object dae_loader_t;
+	dae_loader_test tut_dae_loader("LLDAELoader");
+
+	// every part comes out as one model with a face per material, placed in the scene
+	template<> template<>
+	void dae_loader_t::test<1>()
+	{
+		NamedExtTempFile kit(".dae", make_kit(4, 8));
+		TestLoader load(kit.getName(), NULL);
+
+		ensure("loaded", load.mResult);
+		ensure_equals("models", (S32) load.mLoader.mModelList.size(), 4);
+		for (U32 i = 0; i < load.mLoader.mModelList.size(); ++i)
+		{
+			LLModel* model = load.mLoader.mModelList[i];
+			ensure_equals("label", model->mLabel, llformat("part%d", i));
+			ensure_equals("faces", model->getNumVolumeFaces(), 2);
+			ensure_equals("sorted materials", model->mMaterialList[0], std::string("trim"));
+			ensure_equals("sorted materials", model->mMaterialList[1], std::string("wall"));
+			ensure_equals("triangles", model->getNumTriangles(), 8 * 8 * 2);
+		}
+
+		S32 instances = 0;
+		for (LLModelLoader::scene::iterator iter = load.mLoader.mScene.begin(); iter != load.mLoader.mScene.end(); ++iter)
+		{
+			instances += iter->second.size();
+		}
+		ensure_equals("instances", instances, 4);
+	}
+
+	// converting on the scheduler gives the same models in the same order
+	template<> template<>
+	void dae_loader_t::test<2>()
+	{
+		NamedExtTempFile kit(".dae", make_kit(24, 16));
+		TestLoader serial(kit.getName(), NULL);
+
+		LLJobScheduler scheduler("dae loader", 4);
+		TestLoader parallel(kit.getName(), &scheduler);
+
+		ensure("loaded", serial.mResult && parallel.mResult);
+		ensure_equals("models", parallel.mLoader.mModelList.size(), serial.mLoader.mModelList.size());
+		for (U32 i = 0; i < serial.mLoader.mModelList.size(); ++i)
+		{
+			LLModel* a = serial.mLoader.mModelList[i];
+			LLModel* b = parallel.mLoader.mModelList[i];
+			ensure_equals("same order", b->mLabel, a->mLabel);
+			ensure("same materials", b->mMaterialList == a->mMaterialList);
+			ensure_equals("same faces", b->getNumVolumeFaces(), a->getNumVolumeFaces());
+			for (S32 f = 0; f < a->getNumVolumeFaces(); ++f)
+			{
+				ensure("same face", same_face(a->getVolumeFace(f), b->getVolumeFace(f)));
+			}
+		}
+	}
+
+	// many small parts and a few large ones load whole with any number of workers
+	template<> template<>
+	void dae_loader_t::test<3>()
+	{
+		const S32 KITS = 2;
+		const S32 kit_parts[KITS] = { 32, 2 };
+		const S32 kit_size[KITS] = { 4, 40 };
+
+		for (S32 k = 0; k < KITS; ++k)
+		{
+			NamedExtTempFile kit(".dae", make_kit(kit_parts[k], kit_size[k]));
+
+			for (U32 threads = 0; threads <= 4; threads = threads ? threads * 2 : 1)
+			{
+				LLJobScheduler* scheduler = threads ? new LLJobScheduler("dae loader", threads) : NULL;
+				{
+					TestLoader load(kit.getName(), scheduler);
+					ensure("loaded", load.mResult);
+					ensure_equals("models", (S32) load.mLoader.mModelList.size(), kit_parts[k]);
+					for (U32 i = 0; i < load.mLoader.mModelList.size(); ++i)
+					{
+						ensure_equals("triangles", load.mLoader.mModelList[i]->getNumTriangles(),
+									  kit_size[k] * kit_size[k] * 2);
+					}
+				}
+				delete scheduler;
+			}
+		}
+	}
+
+	// import benchmark over a set of sample kits: many small parts and a few large ones
+	template<> template<>
+	void dae_loader_t::test<4>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 KITS = 2;
+		const S32 kit_parts[KITS] = { 256, 8 };
+		const S32 kit_size[KITS] = { 16, 120 };
+
+		for (S32 k = 0; k < KITS; ++k)
+		{
+			NamedExtTempFile kit(".dae", make_kit(kit_parts[k], kit_size[k]));
+
+			F64 single = 0.0;
+			for (U32 threads = 0; threads <= 4; threads = threads ? threads * 2 : 1)
+			{
+				LLJobScheduler* scheduler = threads ? new LLJobScheduler("dae loader", threads) : NULL;
+				LLTimer timer;
+				S32 models = 0;
+				{
+					TestLoader load(kit.getName(), scheduler);
+					ensure("loaded", load.mResult);
+					models = load.mLoader.mModelList.size();
+				}
+				F64 elapsed = timer.getElapsedTimeF64();
+				delete scheduler;
+
+				if (!threads)
+				{
+					single = elapsed;
+				}
+				LL_INFOS() << llformat("LLDAELoader: %d parts of %d triangles, %d workers: %.1f ms (%.2fx)",
+									   models, kit_size[k] * kit_size[k] * 2, threads, elapsed * 1000.0,
+									   single / llmax(elapsed, 0.000001)) << LL_ENDL;
+				ensure_equals("models", models, kit_parts[k]);
+			}
+		}
+	}
+}
@@ -0,0 +1,345 @@
+/**
+ * @file llmeshsimplifier_test.cpp
+ * @brief Tests and timing benchmark for LLMeshSimplifier.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llmeshsimplifier.h"
+#include "../llmodel.h"
+
+#include "lljobscheduler.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+#include <map>
+
+namespace
+{
+	// Flat grid in the z = 0 plane, size x size quads, bottom left at (x, y)
+	void make_grid(LLVolumeFace& face, S32 size, F32 x = 0.f, F32 y = 0.f)
+	{
+		S32 row = size + 1;
+		face.resizeVertices(row * row);
+		face.resizeIndices(size * size * 6);
+		for (S32 j = 0; j < row; ++j)
+		{
+			for (S32 i = 0; i < row; ++i)
+			{
+				S32 v = j * row + i;
+				face.mPositions[v].set(x + (F32) i / size, y + (F32) j / size, 0.f);
+				face.mNormals[v].set(0.f, 0.f, 1.f);
+				face.mTexCoords[v].set((F32) i / size, (F32) j / size);
+			}
+		}
+		U16* idx = face.mIndices;
+		for (S32 j = 0; j < size; ++j)
+		{
+			for (S32 i = 0; i < size; ++i)
+			{
+				U16 v = j * row + i;
+				*idx++ = v; *idx++ = v + 1; *idx++ = v + row + 1;
+				*idx++ = v; *idx++ = v + row + 1; *idx++ = v + row;
+			}
+		}
+	}
+
+	// Closed torus with a ripple on it, centered on (x, 0, 0). The vertices
+	// along the wrap around in each direction are duplicated with their own
+	// texture coordinates, so the surface has two UV seams.
+	void make_torus(LLVolumeFace& face, S32 rings, S32 sides, F32 ripple, F32 x = 0.f)
+	{
+		S32 row = sides + 1;
+		face.resizeVertices((rings + 1) * row);
+		face.resizeIndices(rings * sides * 6);
+		for (S32 j = 0; j <= rings; ++j)
+		{
+			for (S32 i = 0; i <= sides; ++i)
+			{
+				S32 v = j * row + i;
+				if (i == sides || j == rings)
+				{
+					// same position as the start of the ring or side
+					S32 src = (j % rings) * row + (i % sides);
+					face.mPositions[v] = face.mPositions[src];
+					face.mNormals[v] = face.mNormals[src];
+				}
+				else
+				{
+					F32 u = F_TWO_PI * j / rings;
+					F32 w = F_TWO_PI * i / sides;
+					F32 r = 0.25f + ripple * sinf(u * 7.f) * sinf(w * 5.f);
+					F32 cx = cosf(u), cy = sinf(u);
+					face.mPositions[v].set(x + (1.f + r * cosf(w)) * cx, (1.f + r * cosf(w)) * cy, r * sinf(w));
+					face.mNormals[v].set(cosf(w) * cx, cosf(w) * cy, sinf(w));
+				}
+				face.mTexCoords[v].set((F32) i / sides, (F32) j / rings);
+			}
+		}
+		U16* idx = face.mIndices;
+		for (S32 j = 0; j < rings; ++j)
+		{
+			for (S32 i = 0; i < sides; ++i)
+			{
+				U16 v = j * row + i;
+				*idx++ = v; *idx++ = v + row; *idx++ = v + row + 1;
+				*idx++ = v; *idx++ = v + row + 1; *idx++ = v + 1;
+			}
+		}
+	}
+
+	struct CompareVertex
+	{
+		bool operator()(const std::pair<LLVector3, LLVector2>& a, const std::pair<LLVector3, LLVector2>& b) const
+		{
+			LLVolumeFace::VertexMapData::ComparePosition less;
+			if (less(a.first, b.first)) return true;
+			if (less(b.first, a.first)) return false;
+			if (a.second.mV[0] != b.second.mV[0]) return a.second.mV[0] < b.second.mV[0];
+			return a.second.mV[1] < b.second.mV[1];
+		}
+	};
+	typedef std::map<std::pair<LLVector3, LLVector2>, S32, CompareVertex> vertex_map_t;
+
+	void map_vertices(const LLVolumeFace& face, vertex_map_t& vertices)
+	{
+		for (S32 i = 0; i < face.mNumVertices; ++i)
+		{
+			vertices[std::make_pair(LLVector3(face.mPositions[i].getF32ptr()), face.mTexCoords[i])] = i;
+		}
+	}
+
+	bool has_position(const LLVolumeFace& face, const LLVector3& pos)
+	{
+		for (S32 i = 0; i < face.mNumVertices; ++i)
+		{
+			if (LLVector3(face.mPositions[i].getF32ptr()) == pos)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool same_face(const LLVolumeFace& a, const LLVolumeFace& b)
+	{
+		if (a.mNumVertices != b.mNumVertices || a.mNumIndices != b.mNumIndices)
+		{
+			return false;
+		}
+		for (S32 i = 0; i < a.mNumVertices; ++i)
+		{
+			if (!a.mPositions[i].equals3(b.mPositions[i]))
+			{
+				return false;
+			}
+		}
+		return 0 == memcmp(a.mIndices, b.mIndices, a.mNumIndices * sizeof(U16));
+	}
+
+	LLModel* make_model()
+	{
+		LLVolumeParams volume_params;
+		volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+		return new LLModel(volume_params, 0.f);
+	}
+}
+
+namespace tut
+{
+	struct mesh_simplifier
+	{
+	};
+
+	typedef test_group<mesh_simplifier> mesh_simplifier_test;
+	typedef mesh_simplifier_test::object mesh_simplifier_t;
+	mesh_simplifier_test tut_mesh_simplifier("LLMeshSimplifier");
+
+	// triangle budget on a flat grid, the outline stays where it was
+	template<> template<>
+	void mesh_simplifier_t::test<1>()
+	{
+		LLVolumeFace src, dst;
+		make_grid(src, 32);
+		LLMeshSimplifier::simplify(src, dst, LLMeshSimplifier::TRIANGLE_BUDGET, 200, 0.f);
+
+		ensure("within budget", dst.mNumIndices / 3 <= 200);
+		ensure("not emptied", dst.mNumIndices / 3 >= 100);
+		ensure("corner kept", has_position(dst, LLVector3(0.f, 0.f, 0.f)));
+		ensure("corner kept", has_position(dst, LLVector3(1.f, 1.f, 0.f)));
+		for (S32 i = 0; i < dst.mNumVertices; ++i)
+		{
+			const F32* p = dst.mPositions[i].getF32ptr();
+			ensure_equals("still flat", p[2], 0.f);
+		}
+		ensure("extents", dst.mExtents[0].equals3(LLVector4a(0.f, 0.f, 0.f)));
+		ensure("extents", dst.mExtents[1].equals3(LLVector4a(1.f, 1.f, 0.f)));
+	}
+
+	// every vertex left is one of the originals, attributes and all, and
+	// both seams still have their duplicated vertices
+	template<> template<>
+	void mesh_simplifier_t::test<2>()
+	{
+		LLVolumeFace src, dst;
+		make_torus(src, 96, 48, 0.02f);
+		LLMeshSimplifier::simplify(src, dst, LLMeshSimplifier::TRIANGLE_BUDGET, 1000, 0.f);
+
+		ensure("within budget", dst.mNumIndices / 3 <= 1000);
+		vertex_map_t original, simplified;
+		map_vertices(src, original);
+		map_vertices(dst, simplified);
+		S32 seam_vertices = 0;
+		for (S32 i = 0; i < dst.mNumVertices; ++i)
+		{
+			std::pair<LLVector3, LLVector2> v(LLVector3(dst.mPositions[i].getF32ptr()), dst.mTexCoords[i]);
+			vertex_map_t::iterator found = original.find(v);
+			ensure("original vertex", found != original.end());
+			ensure("original normal", dst.mNormals[i].equals3(src.mNormals[found->second]));
+			if (v.second.mV[0] == 1.f)
+			{
+				++seam_vertices;
+				ensure("seam partner kept", simplified.count(std::make_pair(v.first, LLVector2(0.f, v.second.mV[1]))) > 0);
+			}
+		}
+		ensure("seam kept", seam_vertices > 0);
+		for (S32 i = 0; i < dst.mNumIndices; ++i)
+		{
+			ensure("index in range", dst.mIndices[i] < dst.mNumVertices);
+		}
+	}
+
+	// a looser error threshold gives fewer triangles, a plane goes to almost nothing
+	template<> template<>
+	void mesh_simplifier_t::test<3>()
+	{
+		LLVolumeFace torus, fine, coarse;
+		make_torus(torus, 96, 48, 0.02f);
+		LLMeshSimplifier::simplify(torus, fine, LLMeshSimplifier::ERROR_THRESHOLD, 0, 0.0005f);
+		LLMeshSimplifier::simplify(torus, coarse, LLMeshSimplifier::ERROR_THRESHOLD, 0, 0.01f);
+		ensure("fine simplified", fine.mNumIndices < torus.mNumIndices);
+		ensure("coarse smaller than fine", coarse.mNumIndices < fine.mNumIndices);
+
+		LLVolumeFace grid, flat;
+		make_grid(grid, 32);
+		LLMeshSimplifier::simplify(grid, flat, LLMeshSimplifier::ERROR_THRESHOLD, 0, 0.0001f);
+		ensure("plane collapsed", flat.mNumIndices / 3 < 200);
+	}
+
+	// vertices on the boundary between two faces of a model stay put
+	template<> template<>
+	void mesh_simplifier_t::test<4>()
+	{
+		LLPointer<LLModel> base = make_model();
+		LLPointer<LLModel> lod = make_model();
+		base->setNumVolumeFaces(2);
+		make_grid(base->getVolumeFace(0), 24, 0.f, 0.f);
+		make_grid(base->getVolumeFace(1), 24, 1.f, 0.f);
+
+		LLMeshSimplifier::position_list_t shared;
+		LLMeshSimplifier::getSharedPositions(base, shared);
+		ensure_equals("shared edge", (S32) shared.size(), 25);
+
+		LLMeshSimplifier simplifier;
+		simplifier.addModel(base, lod, LLMeshSimplifier::TRIANGLE_BUDGET, 300, 0.f);
+		simplifier.run(NULL);
+
+		ensure_equals("faces", lod->getNumVolumeFaces(), 2);
+		ensure("within budget", lod->getNumTriangles() <= 300);
+		for (U32 i = 0; i < shared.size(); ++i)
+		{
+			ensure("left side kept", has_position(lod->getVolumeFace(0), shared[i]));
+			ensure("right side kept", has_position(lod->getVolumeFace(1), shared[i]));
+		}
+	}
+
+	// running on the scheduler gives the same result
+	template<> template<>
+	void mesh_simplifier_t::test<5>()
+	{
+		LLVolumeFace src;
+		make_torus(src, 64, 32, 0.05f);
+		LLVolumeFace serial[3], parallel[3];
+		LLJobScheduler scheduler("simplifier", 4);
+		LLMeshSimplifier simplifier;
+		for (S32 i = 0; i < 3; ++i)
+		{
+			U32 budget = 2000 >> i;
+			LLMeshSimplifier::simplify(src, serial[i], LLMeshSimplifier::TRIANGLE_BUDGET, budget, 0.f);
+			simplifier.addFace(src, parallel[i], LLMeshSimplifier::TRIANGLE_BUDGET, budget, 0.f);
+		}
+		simplifier.run(&scheduler);
+		for (S32 i = 0; i < 3; ++i)
+		{
+			ensure("same result", same_face(serial[i], parallel[i]));
+		}
+	}
+
+	// timing benchmark, four faces of about 50k triangles each, three levels of detail
+	template<> template<>
+	void mesh_simplifier_t::test<6>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 FACES = 4;
+		LLPointer<LLModel> base = make_model();
+		base->setNumVolumeFaces(FACES);
+		for (S32 f = 0; f < FACES; ++f)
+		{
+			make_torus(base->getVolumeFace(f), 200, 128, 0.01f * (f + 1), 3.f * f);
+		}
+		U32 triangles = base->getNumTriangles();
+
+		F64 single = 0.0;
+		for (U32 threads = 0; threads <= 4; threads = threads ? threads * 2 : 1)
+		{
+			LLPointer<LLModel> lods[3];
+			LLJobScheduler* scheduler = threads ? new LLJobScheduler("simplifier", threads) : NULL;
+			LLTimer timer;
+			LLMeshSimplifier simplifier;
+			for (S32 i = 0; i < 3; ++i)
+			{
+				lods[i] = make_model();
+				simplifier.addModel(base, lods[i], LLMeshSimplifier::TRIANGLE_BUDGET, triangles >> (2 * (i + 1)), 0.f);
+			}
+			simplifier.run(scheduler);
+			F64 elapsed = timer.getElapsedTimeF64();
+			delete scheduler;
+
+			if (!threads)
+			{
+				single = elapsed;
+			}
+			LL_INFOS() << llformat("LLMeshSimplifier: %d triangles to %d/%d/%d, %d workers: %.1f ms (%.2fx)",
+								   triangles, lods[0]->getNumTriangles(), lods[1]->getNumTriangles(),
+								   lods[2]->getNumTriangles(), threads, elapsed * 1000.0,
+								   single / llmax(elapsed, 0.000001)) << LL_ENDL;
+			for (S32 i = 0; i < 3; ++i)
+			{
+				ensure("within budget", lods[i]->getNumTriangles() <= (S32) (triangles >> (2 * (i + 1))));
+			}
+		}
+	}
+}
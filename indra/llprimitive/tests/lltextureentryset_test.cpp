@@ -0,0 +1,385 @@
+/**
+ * @file lltextureentryset_test.cpp
+ * @brief Interned TextureEntry sets against the per face unpacking they replace.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltextureentryset.h"
+#include "../llprimitive.h"
+
+#include "lldatapacker.h"
+#include "lltimer.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	U32 irand(U32& seed, U32 range)
+	{
+		seed = seed * 1103515245 + 12345;
+		return ((seed >> 8) & 0xffffff) % range;
+	}
+
+	LLUUID make_id(U32 n)
+	{
+		LLUUID id;
+		memcpy(id.mData, &n, sizeof(n));
+		return id;
+	}
+
+	// A prim with the faces of some build: most faces share their values,
+	// a few are textured differently
+	void make_prim(LLPrimitive& prim, U32& seed, U8 num_tes)
+	{
+		prim.setNumTEs(num_tes);
+		U32 texture = irand(seed, 20);
+		F32 repeats = (F32)(1 + irand(seed, 4));
+		for (U8 i = 0; i < num_tes; ++i)
+		{
+			bool odd = irand(seed, 4) == 0;
+			prim.setTETexture(i, make_id(odd ? 100 + irand(seed, 20) : texture));
+			prim.setTEColor(i, LLColor4(odd ? 0.5f : 1.f, 1.f, (F32)irand(seed, 3) * 0.5f, 1.f));
+			prim.setTEScale(i, repeats, odd ? 2.f * repeats : repeats);
+			prim.setTEOffset(i, odd ? 0.25f : 0.f, (F32)irand(seed, 5) * -0.1f);
+			prim.setTERotation(i, odd ? F_PI_BY_TWO : (F32)irand(seed, 3) * 0.3f);
+			prim.setTEBumpShinyFullbright(i, (U8)(odd ? irand(seed, 256) : 0));
+			prim.setTEMediaTexGen(i, (U8)(odd ? 0x20 : 0));
+			prim.setTEGlow(i, odd ? 0.2f : 0.f);
+			prim.setTEMaterialID(i, odd && irand(seed, 2) ? LLMaterialID(make_id(500 + i)) : LLMaterialID::null);
+		}
+	}
+
+	std::vector<U8> pack_blob(const LLPrimitive& prim)
+	{
+		U8 buffer[LLTEContents::MAX_TE_BUFFER + 16];
+		LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+		prim.packTEMessage(dp);
+		dp.reset();
+		U8 blob[LLTEContents::MAX_TE_BUFFER];
+		S32 size = 0;
+		dp.unpackBinaryData(blob, size, "TextureEntry");
+		return std::vector<U8>(blob, blob + size);
+	}
+
+	// What unpackTEMessage() did before the sets: every field of every face
+	// decoded by unpackTEField() and set one at a time
+	S32 unpack_each_face(LLPrimitive& prim, const std::vector<U8>& blob, LLTEContents& tec)
+	{
+		tec.size = blob.size();
+		memcpy(tec.packed_buffer, &blob[0], blob.size());
+		tec.face_count = llmin((U32)prim.getNumTEs(), (U32)LLTEContents::MAX_TES);
+		U8 material_data[LLTEContents::MAX_TES * 16];
+
+		U8* end = tec.packed_buffer + tec.size;
+		U8* cur_ptr = tec.packed_buffer;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.image_data, 16, tec.face_count, MVT_LLUUID);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.colors, 4, tec.face_count, MVT_U8);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.scale_s, 4, tec.face_count, MVT_F32);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.scale_t, 4, tec.face_count, MVT_F32);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.offset_s, 2, tec.face_count, MVT_S16Array);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.offset_t, 2, tec.face_count, MVT_S16Array);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.image_rot, 2, tec.face_count, MVT_S16Array);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.bump, 1, tec.face_count, MVT_U8);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.media_flags, 1, tec.face_count, MVT_U8);
+		cur_ptr++;
+		cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)tec.glow, 1, tec.face_count, MVT_U8);
+		memset(material_data, 0, sizeof(material_data));
+		if (cur_ptr < end)
+		{
+			cur_ptr++;
+			cur_ptr += prim.unpackTEField(cur_ptr, end, (U8*)material_data, 16, tec.face_count, MVT_LLUUID);
+		}
+		for (U32 i = 0; i < tec.face_count; i++)
+		{
+			tec.material_ids[i].set(&material_data[i * 16]);
+		}
+		return prim.applyParsedTEMessage(tec);
+	}
+
+	bool same_face(const LLTextureEntry* te, const LLTextureEntrySet::Face& face)
+	{
+		return te->getID() == face.mID
+			&& te->getColor() == face.mColor
+			&& te->mScaleS == face.mScaleS && te->mScaleT == face.mScaleT
+			&& te->mOffsetS == face.mOffsetS && te->mOffsetT == face.mOffsetT
+			&& te->mRotation == face.mRotation
+			&& te->getBumpShinyFullbright() == face.mBump
+			&& te->getMediaTexGen() == face.mMediaFlags
+			&& te->getGlow() == face.mGlow
+			&& te->getMaterialID() == face.mMaterialID;
+	}
+
+	bool same_faces(const LLPrimitive& a, const LLPrimitive& b)
+	{
+		if (a.getNumTEs() != b.getNumTEs())
+		{
+			return false;
+		}
+		for (U8 i = 0; i < a.getNumTEs(); ++i)
+		{
+			const LLTextureEntry* te = a.getTE(i);
+			const LLTextureEntry* other = b.getTE(i);
+			if (te->getID() != other->getID()
+				|| te->getColor() != other->getColor()
+				|| te->mScaleS != other->mScaleS || te->mScaleT != other->mScaleT
+				|| te->mOffsetS != other->mOffsetS || te->mOffsetT != other->mOffsetT
+				|| te->mRotation != other->mRotation
+				|| te->getBumpShinyFullbright() != other->getBumpShinyFullbright()
+				|| te->getMediaTexGen() != other->getMediaTexGen()
+				|| te->getGlow() != other->getGlow()
+				|| te->getMaterialID() != other->getMaterialID())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+namespace tut
+{
+	struct texture_entry_set
+	{
+		~texture_entry_set()
+		{
+			LLTextureEntrySet::purgeUnused();
+		}
+	};
+
+	typedef test_group<texture_entry_set> texture_entry_set_test;
+	typedef texture_entry_set_test::object texture_entry_set_t;
+	texture_entry_set_test tut_texture_entry_set("LLTextureEntrySet");
+
+	// decodes the same values as the per face unpacking, with and without
+	// material ids on the end
+	template<> template<>
+	void texture_entry_set_t::test<1>()
+	{
+		U32 seed = 1;
+		for (S32 n = 0; n < 200; ++n)
+		{
+			LLPrimitive source;
+			make_prim(source, seed, (U8)(1 + irand(seed, 9)));
+			std::vector<U8> blob = pack_blob(source);
+
+			LLPrimitive reference;
+			reference.setNumTEs(source.getNumTEs());
+			LLTEContents tec;
+			unpack_each_face(reference, blob, tec);
+
+			LLPointer<LLTextureEntrySet> te_set = new LLTextureEntrySet(&blob[0], blob.size(), source.getNumTEs());
+			ensure_equals("faces", te_set->getFaceCount(), (U32)source.getNumTEs());
+			for (U8 i = 0; i < source.getNumTEs(); ++i)
+			{
+				ensure(llformat("prim %d face %d", n, i), same_face(reference.getTE(i), te_set->getFace(i)));
+			}
+
+			LLPrimitive unpacked;
+			unpacked.setNumTEs(source.getNumTEs());
+			U8 buffer[LLTEContents::MAX_TE_BUFFER + 16];
+			LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+			source.packTEMessage(dp);
+			dp.reset();
+			unpacked.unpackTEMessage(dp);
+			ensure(llformat("prim %d unpacked", n), same_faces(unpacked, reference));
+		}
+
+		// a blob from before material ids: every face shares the null id,
+		// so the field is the separator and one id at the end
+		LLPrimitive source;
+		make_prim(source, seed, 6);
+		for (U8 i = 0; i < 6; ++i)
+		{
+			source.setTEMaterialID(i, LLMaterialID::null);
+		}
+		std::vector<U8> blob = pack_blob(source);
+		blob.resize(blob.size() - 1 - UUID_BYTES);
+		LLPointer<LLTextureEntrySet> old_set = new LLTextureEntrySet(&blob[0], blob.size(), 6);
+		for (U8 i = 0; i < 6; ++i)
+		{
+			ensure("no material", old_set->getFace(i).mMaterialID.isNull());
+			ensure_equals("glow", old_set->getFace(i).mGlow, source.getTE(i)->getGlow());
+		}
+
+		// truncated blobs read as zeros, not past the end
+		for (S32 size = 0; size < (S32)blob.size(); size += 3)
+		{
+			LLPointer<LLTextureEntrySet> truncated = new LLTextureEntrySet(&blob[0], size, 6);
+			ensure_equals("truncated", truncated->getFaceCount(), (U32)6);
+		}
+	}
+
+	// the same bytes give the same set while it is held
+	template<> template<>
+	void texture_entry_set_t::test<2>()
+	{
+		LLTextureEntrySet::purgeUnused();
+		U32 start = LLTextureEntrySet::getInternedCount();
+
+		U32 seed = 2;
+		LLPrimitive a;
+		make_prim(a, seed, 6);
+		LLPrimitive b;
+		make_prim(b, seed, 6);
+		std::vector<U8> blob_a = pack_blob(a);
+		std::vector<U8> blob_b = pack_blob(b);
+		ensure("different prims", blob_a != blob_b);
+
+		LLPointer<const LLTextureEntrySet> set_a = LLTextureEntrySet::intern(&blob_a[0], blob_a.size(), 6);
+		LLPointer<const LLTextureEntrySet> set_b = LLTextureEntrySet::intern(&blob_b[0], blob_b.size(), 6);
+		std::vector<U8> copy_a = blob_a;
+		ensure("shared", LLTextureEntrySet::intern(&copy_a[0], copy_a.size(), 6) == set_a);
+		ensure("not shared", set_a != set_b);
+		ensure("face count is part of the key", LLTextureEntrySet::intern(&blob_a[0], blob_a.size(), 5) != set_a);
+		ensure_equals("interned", LLTextureEntrySet::getInternedCount(), start + 3);
+
+		set_b = NULL;
+		LLTextureEntrySet::purgeUnused();
+		ensure_equals("purged", LLTextureEntrySet::getInternedCount(), start + 1);
+		ensure("kept", LLTextureEntrySet::intern(&blob_a[0], blob_a.size(), 6) == set_a);
+	}
+
+	// prims hold the set they were unpacked from until their entries change
+	template<> template<>
+	void texture_entry_set_t::test<3>()
+	{
+		U32 seed = 3;
+		LLPrimitive source;
+		make_prim(source, seed, 7);
+		std::vector<U8> blob = pack_blob(source);
+		LLPointer<const LLTextureEntrySet> te_set = LLTextureEntrySet::intern(&blob[0], blob.size(), 7);
+
+		LLPrimitive prim;
+		prim.setNumTEs(7);
+		ensure("first apply changes", prim.applyTEEntrySet(te_set) != 0);
+		ensure("holds set", prim.getTextureList().getEntrySet() == te_set);
+		ensure_equals("same set again", prim.applyTEEntrySet(te_set), 0);
+
+		LLColor4 color = prim.getTE(3)->getColor();
+		prim.setTEColor(3, LLColor4::red);
+		ensure("edit drops set", prim.getTextureList().getEntrySet() == NULL);
+		ensure_equals("edit undone", prim.applyTEEntrySet(te_set), TEM_CHANGE_COLOR);
+		ensure("color back", prim.getTE(3)->getColor() == color);
+		ensure("holds set again", prim.getTextureList().getEntrySet() == te_set);
+
+		prim.setTEColor(3, color);
+		ensure("no change keeps set", prim.getTextureList().getEntrySet() == te_set);
+
+		LLPrimitive copy;
+		copy.copyTextureList(prim.getTextureList());
+		ensure("copy holds set", copy.getTextureList().getEntrySet() == te_set);
+		ensure_equals("copy is up to date", copy.applyTEEntrySet(te_set), 0);
+
+		prim.setNumTEs(8);
+		ensure("resize drops set", prim.getTextureList().getEntrySet() == NULL);
+	}
+
+	// a region of 20k prims built from a few dozen textured builds, unpacked
+	// the old way and from interned sets, then sent again unchanged
+	template<> template<>
+	void texture_entry_set_t::test<4>()
+	{
+		skip_unless_benchmarking();
+
+		const S32 NUM_BUILDS = 48;
+		const S32 NUM_PRIMS = 20000;
+		LLTextureEntrySet::purgeUnused();
+
+		U32 seed = 4;
+		std::vector<std::vector<U8> > blobs;
+		std::vector<U8> face_counts;
+		for (S32 i = 0; i < NUM_BUILDS; ++i)
+		{
+			LLPrimitive build;
+			face_counts.push_back((U8)(3 + irand(seed, 6)));
+			make_prim(build, seed, face_counts.back());
+			blobs.push_back(pack_blob(build));
+		}
+
+		std::vector<S32> builds(NUM_PRIMS);
+		for (S32 i = 0; i < NUM_PRIMS; ++i)
+		{
+			// a few builds make up most of the region
+			builds[i] = (S32)llmin(irand(seed, NUM_BUILDS), irand(seed, NUM_BUILDS));
+		}
+
+		std::vector<LLPrimitive*> each_face(NUM_PRIMS);
+		std::vector<LLPrimitive*> interned(NUM_PRIMS);
+		for (S32 i = 0; i < NUM_PRIMS; ++i)
+		{
+			each_face[i] = new LLPrimitive;
+			each_face[i]->setNumTEs(face_counts[builds[i]]);
+			interned[i] = new LLPrimitive;
+			interned[i]->setNumTEs(face_counts[builds[i]]);
+		}
+
+		F32 each_face_ms[2];
+		F32 interned_ms[2];
+		LLTEContents* tec = new LLTEContents;
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			LLTimer timer;
+			for (S32 i = 0; i < NUM_PRIMS; ++i)
+			{
+				unpack_each_face(*each_face[i], blobs[builds[i]], *tec);
+			}
+			each_face_ms[pass] = timer.getElapsedTimeF32() * 1000.f;
+
+			timer.reset();
+			for (S32 i = 0; i < NUM_PRIMS; ++i)
+			{
+				const std::vector<U8>& blob = blobs[builds[i]];
+				interned[i]->applyTEEntrySet(LLTextureEntrySet::intern(&blob[0], blob.size(), interned[i]->getNumTEs()));
+			}
+			interned_ms[pass] = timer.getElapsedTimeF32() * 1000.f;
+		}
+		delete tec;
+
+		for (S32 i = 0; i < NUM_PRIMS; ++i)
+		{
+			ensure(llformat("prim %d", i), same_faces(*interned[i], *each_face[i]));
+		}
+
+		U32 sets = LLTextureEntrySet::getInternedCount();
+		ensure("one set per build", sets <= (U32)NUM_BUILDS);
+
+		for (S32 i = 0; i < NUM_PRIMS; ++i)
+		{
+			delete interned[i];
+			delete each_face[i];
+		}
+		LL_INFOS() << NUM_PRIMS << " prims: unpacked per face in " << each_face_ms[0] << " ms, again in " << each_face_ms[1]
+				   << " ms; from interned sets in " << interned_ms[0] << " ms, again in " << interned_ms[1] << " ms. "
+				   << sets << " sets add " << LLTextureEntrySet::getInternedBytes() << " bytes" << LL_ENDL;
+	}
+}
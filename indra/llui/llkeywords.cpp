@@ -28,6 +28,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 #include "llkeywords.h"
 #include "llsdserialize.h"
@@ -68,7 +69,9 @@ inline bool LLKeywordToken::isTail(const llwchar* s) const
 }
 
 LLKeywords::LLKeywords()
-:	mLoaded(false)
+:	mLoaded(false),
+	mWordIndexDirty(false),
+	mCachedLength(0)
 {
 }
 
@@ -100,6 +103,11 @@ void LLKeywords::addToken(LLKeywordToken::ETokenType type,
 
 	LLWString key = utf8str_to_wstring(key_in);
 	LLWString delimiter = utf8str_to_wstring(delimiter_in);
+
+	// token set changed, cached lookups and line states are stale
+	mWordIndexDirty = true;
+	clearLineCache();
+
 	switch(type)
 	{
 	case LLKeywordToken::TT_CONSTANT:
@@ -475,6 +483,135 @@ bool LLKeywords::WStringMapIndex::operator<(const LLKeywords::WStringMapIndex &o
 	return result;
 }
 
+namespace
+{
+	// FNV-1a over the characters of a word
+	U64 hash_word(const llwchar* start, S32 length)
+	{
+		U64 hash = 14695981039346656037ULL;
+		for (S32 i = 0; i < length; i++)
+		{
+			hash = (hash ^ (U64)start[i]) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	// remix a word hash with a bucket seed to pick its slot
+	inline U64 hash_seed(U64 hash, U32 seed)
+	{
+		hash ^= (U64)seed * 0x9E3779B97F4A7C15ULL;
+		hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+		return hash ^ (hash >> 31);
+	}
+
+	const U32 WORD_INDEX_MAX_SEED = 1 << 16;
+
+	typedef std::vector<std::pair<U64, LLKeywordToken*> > bucket_t;
+
+	struct larger_bucket
+	{
+		larger_bucket(const std::vector<bucket_t>& buckets) : mBuckets(buckets) {}
+		bool operator()(U32 a, U32 b) const { return mBuckets[a].size() > mBuckets[b].size(); }
+		const std::vector<bucket_t>& mBuckets;
+	};
+}
+
+void LLKeywords::buildWordIndex()
+{
+	mWordIndexDirty = false;
+	mWordIndexSlots.clear();
+	mWordIndexSeeds.clear();
+
+	const size_t num_words = mWordTokenMap.size();
+	if (!num_words)
+	{
+		return;
+	}
+
+	std::vector<bucket_t> buckets(num_words / 4 + 1);
+	for (word_token_map_t::const_iterator it = mWordTokenMap.begin(); it != mWordTokenMap.end(); ++it)
+	{
+		const LLWString& token = it->second->getToken();
+		U64 hash = hash_word(token.data(), token.size());
+		buckets[(hash >> 32) % buckets.size()].push_back(std::make_pair(hash, it->second));
+	}
+
+	// place the biggest buckets first while the table is still mostly empty
+	std::vector<U32> order(buckets.size());
+	for (U32 i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), larger_bucket(buckets));
+
+	const size_t num_slots = num_words + num_words / 8 + 1;
+	std::vector<LLKeywordToken*> slots(num_slots, (LLKeywordToken*)NULL);
+	std::vector<U32> seeds(buckets.size(), 0);
+	std::vector<size_t> bucket_slots;
+	for (std::vector<U32>::const_iterator it = order.begin(); it != order.end(); ++it)
+	{
+		const bucket_t& bucket = buckets[*it];
+		if (bucket.empty())
+		{
+			break;
+		}
+
+		U32 seed = 0;
+		for (; seed < WORD_INDEX_MAX_SEED; seed++)
+		{
+			bucket_slots.clear();
+			bool fits = true;
+			for (bucket_t::const_iterator word = bucket.begin(); fits && word != bucket.end(); ++word)
+			{
+				size_t slot = hash_seed(word->first, seed) % num_slots;
+				fits = !slots[slot] && std::find(bucket_slots.begin(), bucket_slots.end(), slot) == bucket_slots.end();
+				bucket_slots.push_back(slot);
+			}
+			if (fits)
+			{
+				break;
+			}
+		}
+
+		if (seed == WORD_INDEX_MAX_SEED)
+		{
+			// only possible with a full 64 bit hash collision, fall back to the token map
+			LL_WARNS("SyntaxLSL") << "Could not build keyword hash, using slower lookup." << LL_ENDL;
+			return;
+		}
+
+		seeds[*it] = seed;
+		for (U32 i = 0; i < bucket.size(); i++)
+		{
+			slots[bucket_slots[i]] = bucket[i].second;
+		}
+	}
+
+	mWordIndexSlots.swap(slots);
+	mWordIndexSeeds.swap(seeds);
+}
+
+LLKeywordToken* LLKeywords::findWordToken(const llwchar* start, S32 length) const
+{
+	if (mWordIndexSlots.empty())
+	{
+		word_token_map_t::const_iterator map_iter = mWordTokenMap.find(WStringMapIndex(start, length));
+		return map_iter != mWordTokenMap.end() ? map_iter->second : NULL;
+	}
+
+	U64 hash = hash_word(start, length);
+	U32 seed = mWordIndexSeeds[(hash >> 32) % mWordIndexSeeds.size()];
+	LLKeywordToken* token = mWordIndexSlots[hash_seed(hash, seed) % mWordIndexSlots.size()];
+	if (token
+		&& token->getLengthHead() == length
+		&& !memcmp(token->getToken().data(), start, length * sizeof(llwchar)))
+	{
+		return token;
+	}
+	return NULL;
+}
+
 LLTrace::BlockTimerStatHandle FTM_SYNTAX_COLORING("Syntax Coloring");
 
 // Walk through a string, applying the rules specified by the keyword token list and
@@ -483,218 +620,320 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 {
 	LL_RECORD_BLOCK_TIME(FTM_SYNTAX_COLORING);
 	seg_list->clear();
+	mLineStarts.clear();
+	mLineStates.clear();
+	mCachedLength = wtext.size();
 
 	if( wtext.empty() )
 	{
 		return;
 	}
 
+	if (mWordIndexDirty)
+	{
+		buildWordIndex();
+	}
+
 	S32 text_len = wtext.size() + 1;
 
 	seg_list->push_back( new LLNormalTextSegment( defaultColor, 0, text_len, editor ) );
 
-	const llwchar* base = wtext.c_str();
-	const llwchar* cur = base;
-	while( *cur )
+	S32 line_start = 0;
+	LLKeywordToken* open_delimiter = NULL;
+	while (line_start < text_len)
+	{
+		mLineStarts.push_back(line_start);
+		mLineStates.push_back(open_delimiter);
+		open_delimiter = findLineSegments(wtext, line_start, open_delimiter, *seg_list, text_len, defaultColor, editor, &line_start);
+	}
+}
+
+void LLKeywords::updateSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLWString& wtext, S32 change_start, S32 clean_tail, const LLColor4 &defaultColor, LLTextEditor& editor)
+{
+	if (mLineStarts.empty() || wtext.empty())
 	{
-		if( *cur == '\n' || cur == base )
+		// nothing cached, tokenize everything
+		findSegments(seg_list, wtext, defaultColor, editor);
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_SYNTAX_COLORING);
+	seg_list->clear();
+
+	if (mWordIndexDirty)
+	{
+		buildWordIndex();
+	}
+
+	const S32 text_len = wtext.size() + 1;
+	const S32 length_delta = (S32)wtext.size() - mCachedLength;
+	const S32 clean_tail_start = (S32)wtext.size() - clean_tail;
+
+	// lines starting at or before the first change keep their start and lexer state
+	change_start = llclamp(change_start, 0, llmin(mCachedLength, (S32)wtext.size()));
+	S32 first_line = (std::upper_bound(mLineStarts.begin(), mLineStarts.end(), change_start) - mLineStarts.begin()) - 1;
+
+	S32 line_start = mLineStarts[first_line];
+	LLKeywordToken* open_delimiter = mLineStates[first_line];
+	seg_list->push_back( new LLNormalTextSegment( defaultColor, line_start, text_len, editor ) );
+
+	std::vector<S32> new_starts;
+	std::vector<LLKeywordToken*> new_states;
+	S32 old_line = first_line + 1;
+	S32 old_end_line = mLineStarts.size();
+	while (line_start < text_len)
+	{
+		// once past the edit, stop at the first line that starts where an old line started,
+		// in the same lexer state, since everything after it tokenizes as it did before
+		if (!new_starts.empty() && line_start >= clean_tail_start)
 		{
-			if( *cur == '\n' )
+			S32 old_start = line_start - length_delta;
+			old_line = std::lower_bound(mLineStarts.begin() + old_line, mLineStarts.end(), old_start) - mLineStarts.begin();
+			if (old_line < (S32)mLineStarts.size()
+				&& mLineStarts[old_line] == old_start
+				&& mLineStates[old_line] == open_delimiter)
 			{
-				LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(cur-base);
-				text_segment->setToken( 0 );
-				insertSegment( *seg_list, text_segment, text_len, defaultColor, editor);
-				cur++;
-				if( !*cur || *cur == '\n' )
-				{
-					continue;
-				}
+				old_end_line = old_line;
+				break;
 			}
+		}
 
-			// Skip white space
-			while( *cur && iswspace(*cur) && (*cur != '\n')  )
+		new_starts.push_back(line_start);
+		new_states.push_back(open_delimiter);
+		open_delimiter = findLineSegments(wtext, line_start, open_delimiter, *seg_list, text_len, defaultColor, editor, &line_start);
+	}
+
+	// drop the trailing default segment past the re-tokenized lines
+	if (line_start < text_len)
+	{
+		LLTextSegmentPtr last = seg_list->back();
+		if (last->getStart() >= line_start)
+		{
+			seg_list->pop_back();
+		}
+		else
+		{
+			last->setEnd(line_start);
+		}
+	}
+
+	// splice the new lines into the cache and shift the reused ones
+	mLineStarts.erase(mLineStarts.begin() + first_line, mLineStarts.begin() + old_end_line);
+	mLineStates.erase(mLineStates.begin() + first_line, mLineStates.begin() + old_end_line);
+	mLineStarts.insert(mLineStarts.begin() + first_line, new_starts.begin(), new_starts.end());
+	mLineStates.insert(mLineStates.begin() + first_line, new_states.begin(), new_states.end());
+	for (S32 i = first_line + new_starts.size(); i < (S32)mLineStarts.size(); ++i)
+	{
+		mLineStarts[i] += length_delta;
+	}
+	mCachedLength = wtext.size();
+}
+
+void LLKeywords::clearLineCache()
+{
+	mLineStarts.clear();
+	mLineStates.clear();
+}
+
+// Scan a two sided or quoted delimiter for its tail.  Stops after the tail if found,
+// otherwise at the end of the line, since the delimiter carries on into the next line.
+bool LLKeywords::findDelimiterTail(LLKeywordToken* delimiter, const llwchar*& cur)
+{
+	LLKeywordToken::ETokenType type = delimiter->getType();
+	while( *cur && *cur != '\n' && !delimiter->isTail(cur))
+	{
+		// Check for an escape sequence.
+		if (type == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS && *cur == '\\')
+		{
+			// Skip over the backslashes.
+			S32 num_backslashes = 0;
+			while (*cur == '\\')
 			{
+				num_backslashes++;
 				cur++;
 			}
-			if( !*cur || *cur == '\n' )
-			{
-				continue;
-			}
-
-			// cur is now at the first non-whitespace character of a new line
-
-			// Line start tokens
+			// If the next character is the end delimiter?
+			if (delimiter->isTail(cur))
 			{
-				BOOL line_done = FALSE;
-				for (token_list_t::iterator iter = mLineTokenList.begin();
-					 iter != mLineTokenList.end(); ++iter)
+				// If there was an odd number of backslashes, then this delimiter
+				// does not end the sequence.
+				if (num_backslashes % 2 == 1)
 				{
-					LLKeywordToken* cur_token = *iter;
-					if( cur_token->isHead( cur ) )
-					{
-						S32 seg_start = cur - base;
-						while( *cur && *cur != '\n' )
-						{
-							// skip the rest of the line
-							cur++;
-						}
-						S32 seg_end = cur - base;
-
-						//create segments from seg_start to seg_end
-						insertSegments(wtext, *seg_list,cur_token, text_len, seg_start, seg_end, defaultColor, editor);
-						line_done = TRUE; // to break out of second loop.
-						break;
-					}
+					cur++;
 				}
-
-				if( line_done )
+				else
 				{
-					continue;
+					// This is an end delimiter.
+					break;
 				}
 			}
 		}
+		else
+		{
+			cur++;
+		}
+	}
+
+	if( *cur && *cur != '\n' )
+	{
+		cur += delimiter->getLengthTail();
+		return true;
+	}
+	return false;
+}
+
+// Create the color segments for one line of text, given the delimiter left open by the
+// previous lines.  Returns the delimiter still open at the end of the line and sets
+// next_line_start past the newline, or to text_len at the end of the text.
+LLKeywordToken* LLKeywords::findLineSegments(const LLWString& wtext, S32 line_start, LLKeywordToken* open_delimiter, std::vector<LLTextSegmentPtr>& seg_list, S32 text_len, const LLColor4 &defaultColor, LLTextEditor& editor, S32* next_line_start)
+{
+	const llwchar* base = wtext.c_str();
+	const llwchar* cur = base + line_start;
 
-		// Skip white space
+	if (open_delimiter)
+	{
+		// continuation of a delimited run from a previous line
+		S32 seg_start = cur - base;
+		if (findDelimiterTail(open_delimiter, cur))
+		{
+			insertSegments(wtext, seg_list, open_delimiter, text_len, seg_start, cur - base, defaultColor, editor);
+			open_delimiter = NULL;
+		}
+		else if (cur - base > seg_start)
+		{
+			insertSegments(wtext, seg_list, open_delimiter, text_len, seg_start, cur - base, defaultColor, editor);
+		}
+	}
+	else
+	{
+		// Skip white space first, so that indented line start tokens still match
 		while( *cur && iswspace(*cur) && (*cur != '\n')  )
 		{
 			cur++;
 		}
 
-		while( *cur && *cur != '\n' )
+		// Line start tokens
+		if( *cur && *cur != '\n' )
 		{
-			// Check against delimiters
+			for (token_list_t::iterator iter = mLineTokenList.begin();
+				 iter != mLineTokenList.end(); ++iter)
 			{
-				S32 seg_start = 0;
-				LLKeywordToken* cur_delimiter = NULL;
-				for (token_list_t::iterator iter = mDelimiterTokenList.begin();
-					 iter != mDelimiterTokenList.end(); ++iter)
+				LLKeywordToken* cur_token = *iter;
+				if( cur_token->isHead( cur ) )
 				{
-					LLKeywordToken* delimiter = *iter;
-					if( delimiter->isHead( cur ) )
+					S32 seg_start = cur - base;
+					while( *cur && *cur != '\n' )
 					{
-						cur_delimiter = delimiter;
-						break;
+						// skip the rest of the line
+						cur++;
 					}
+					S32 seg_end = cur - base;
+
+					//create segments from seg_start to seg_end
+					insertSegments(wtext, seg_list, cur_token, text_len, seg_start, seg_end, defaultColor, editor);
+					break;
 				}
+			}
+		}
+	}
+
+	// Skip white space
+	while( *cur && iswspace(*cur) && (*cur != '\n')  )
+	{
+		cur++;
+	}
 
-				if( cur_delimiter )
+	while( *cur && *cur != '\n' )
+	{
+		// Check against delimiters
+		{
+			LLKeywordToken* cur_delimiter = NULL;
+			for (token_list_t::iterator iter = mDelimiterTokenList.begin();
+				 iter != mDelimiterTokenList.end(); ++iter)
+			{
+				LLKeywordToken* delimiter = *iter;
+				if( delimiter->isHead( cur ) )
 				{
-					S32 between_delimiters = 0;
-					S32 seg_end = 0;
+					cur_delimiter = delimiter;
+					break;
+				}
+			}
 
-					seg_start = cur - base;
-					cur += cur_delimiter->getLengthHead();
+			if( cur_delimiter )
+			{
+				S32 seg_start = cur - base;
+				cur += cur_delimiter->getLengthHead();
 
-					LLKeywordToken::ETokenType type = cur_delimiter->getType();
-					if( type == LLKeywordToken::TT_TWO_SIDED_DELIMITER || type == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS )
+				LLKeywordToken::ETokenType type = cur_delimiter->getType();
+				if( type == LLKeywordToken::TT_TWO_SIDED_DELIMITER || type == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS )
+				{
+					if (!findDelimiterTail(cur_delimiter, cur))
 					{
-						while( *cur && !cur_delimiter->isTail(cur))
-						{
-							// Check for an escape sequence.
-							if (type == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS && *cur == '\\')
-							{
-								// Count the number of backslashes.
-								S32 num_backslashes = 0;
-								while (*cur == '\\')
-								{
-									num_backslashes++;
-									between_delimiters++;
-									cur++;
-								}
-								// If the next character is the end delimiter?
-								if (cur_delimiter->isTail(cur))
-								{
-									// If there was an odd number of backslashes, then this delimiter
-									// does not end the sequence.
-									if (num_backslashes % 2 == 1)
-									{
-										between_delimiters++;
-										cur++;
-									}
-									else
-									{
-										// This is an end delimiter.
-										break;
-									}
-								}
-							}
-							else
-							{
-								between_delimiters++;
-								cur++;
-							}
-						}
-
-						if( *cur )
-						{
-							cur += cur_delimiter->getLengthHead();
-							seg_end = seg_start + between_delimiters + cur_delimiter->getLengthHead() + cur_delimiter->getLengthTail();
-						}
-						else
-						{
-							// eof
-							seg_end = seg_start + between_delimiters + cur_delimiter->getLengthHead();
-						}
+						// runs on into the next line (or eof)
+						open_delimiter = cur_delimiter;
 					}
-					else
+				}
+				else
+				{
+					llassert( cur_delimiter->getType() == LLKeywordToken::TT_ONE_SIDED_DELIMITER );
+					// Left side is the delimiter.  Right side is eol or eof.
+					while( *cur && ('\n' != *cur) )
 					{
-						llassert( cur_delimiter->getType() == LLKeywordToken::TT_ONE_SIDED_DELIMITER );
-						// Left side is the delimiter.  Right side is eol or eof.
-						while( *cur && ('\n' != *cur) )
-						{
-							between_delimiters++;
-							cur++;
-						}
-						seg_end = seg_start + between_delimiters + cur_delimiter->getLengthHead();
+						cur++;
 					}
-
-					insertSegments(wtext, *seg_list,cur_delimiter, text_len, seg_start, seg_end, defaultColor, editor);
-					/*
-					LLTextSegmentPtr text_segment = new LLNormalTextSegment( cur_delimiter->getColor(), seg_start, seg_end, editor );
-					text_segment->setToken( cur_delimiter );
-					insertSegment( seg_list, text_segment, text_len, defaultColor, editor);
-					*/
-					// Note: we don't increment cur, since the end of one delimited seg may be immediately
-					// followed by the start of another one.
-					continue;
 				}
+
+				insertSegments(wtext, seg_list, cur_delimiter, text_len, seg_start, cur - base, defaultColor, editor);
+				// Note: we don't increment cur, since the end of one delimited seg may be immediately
+				// followed by the start of another one.
+				continue;
 			}
+		}
 
-			// check against words
-			llwchar prev = cur > base ? *(cur-1) : 0;
-			if( !iswalnum( prev ) && (prev != '_') )
+		// check against words
+		llwchar prev = cur > base ? *(cur-1) : 0;
+		if( !iswalnum( prev ) && (prev != '_') )
+		{
+			const llwchar* p = cur;
+			while( iswalnum( *p ) || (*p == '_') )
 			{
-				const llwchar* p = cur;
-				while( iswalnum( *p ) || (*p == '_') )
-				{
-					p++;
-				}
-				S32 seg_len = p - cur;
-				if( seg_len > 0 )
+				p++;
+			}
+			S32 seg_len = p - cur;
+			if( seg_len > 0 )
+			{
+				LLKeywordToken* cur_token = findWordToken(cur, seg_len);
+				if( cur_token )
 				{
-					WStringMapIndex word( cur, seg_len );
-					word_token_map_t::iterator map_iter = mWordTokenMap.find(word);
-					if( map_iter != mWordTokenMap.end() )
-					{
-						LLKeywordToken* cur_token = map_iter->second;
-						S32 seg_start = cur - base;
-						S32 seg_end = seg_start + seg_len;
-
-						// LL_INFOS("SyntaxLSL") << "Seg: [" << word.c_str() << "]" << LL_ENDL;
+					S32 seg_start = cur - base;
+					S32 seg_end = seg_start + seg_len;
 
-						insertSegments(wtext, *seg_list,cur_token, text_len, seg_start, seg_end, defaultColor, editor);
-					}
-					cur += seg_len;
-					continue;
+					insertSegments(wtext, seg_list, cur_token, text_len, seg_start, seg_end, defaultColor, editor);
 				}
+				cur += seg_len;
+				continue;
 			}
+		}
 
-			if( *cur && *cur != '\n' )
-			{
-				cur++;
-			}
+		if( *cur && *cur != '\n' )
+		{
+			cur++;
 		}
 	}
+
+	if( *cur == '\n' )
+	{
+		LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(cur-base);
+		text_segment->setToken( open_delimiter );
+		insertSegment( seg_list, text_segment, text_len, defaultColor, editor);
+		cur++;
+		*next_line_start = cur - base;
+	}
+	else
+	{
+		*next_line_start = text_len;
+	}
+	return open_delimiter;
 }
 
 void LLKeywords::insertSegments(const LLWString& wtext, std::vector<LLTextSegmentPtr>& seg_list, LLKeywordToken* cur_token, S32 text_len, S32 seg_start, S32 seg_end, const LLColor4 &defaultColor, LLTextEditor& editor )
@@ -117,6 +117,18 @@ public:
 							 const LLWString& text,
 							 const LLColor4 &defaultColor,
 							 class LLTextEditor& editor);
+	// Like findSegments(), but only re-tokenizes from the line containing change_start until
+	// the lexer state at a line start matches the state cached by the previous call.
+	// clean_tail is the number of characters at the end of text unchanged since that call.
+	// seg_list is filled with segments covering only the re-tokenized lines.
+	void		updateSegments(std::vector<LLTextSegmentPtr> *seg_list,
+							   const LLWString& text,
+							   S32 change_start,
+							   S32 clean_tail,
+							   const LLColor4 &defaultColor,
+							   class LLTextEditor& editor);
+	// forget cached line states, next updateSegments() will tokenize the whole text
+	void		clearLineCache();
 	void		initialize(LLSD SyntaxXML);
 	void		processTokens();
 
@@ -170,6 +182,17 @@ public:
 
 protected:
 	void		processTokensGroup(const LLSD& Tokens, const std::string& Group);
+	LLKeywordToken* findLineSegments(const LLWString& wtext,
+									 S32 line_start,
+									 LLKeywordToken* open_delimiter,
+									 std::vector<LLTextSegmentPtr>& seg_list,
+									 S32 text_len,
+									 const LLColor4 &defaultColor,
+									 LLTextEditor& editor,
+									 S32* next_line_start);
+	bool		findDelimiterTail(LLKeywordToken* delimiter, const llwchar*& cur);
+	void		buildWordIndex();
+	LLKeywordToken* findWordToken(const llwchar* start, S32 length) const;
 	void		insertSegment(std::vector<LLTextSegmentPtr>& seg_list,
 							  LLTextSegmentPtr new_segment,
 							  S32 text_len,
@@ -191,6 +214,18 @@ protected:
 	token_list_t mLineTokenList;
 	token_list_t mDelimiterTokenList;
 
+	// Perfect hash over mWordTokenMap (hash and displace): each bucket of words gets a seed
+	// that maps all its words to distinct slots, so a lookup is one hash of the word plus
+	// a single comparison.
+	std::vector<LLKeywordToken*> mWordIndexSlots;
+	std::vector<U32>	mWordIndexSeeds;
+	bool				mWordIndexDirty;
+
+	// lexer state cached by line for updateSegments()
+	std::vector<S32>	mLineStarts;		// offset of first character of each line
+	std::vector<LLKeywordToken*> mLineStates;	// delimiter still open at the start of each line
+	S32					mCachedLength;
+
 	typedef  std::map<std::string, std::string> element_attributes_t;
 	typedef element_attributes_t::const_iterator attribute_iterator_t;
 	element_attributes_t mAttributes;
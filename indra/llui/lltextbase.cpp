@@ -199,6 +199,9 @@ LLTextBase::LLTextBase(const LLTextBase::Params &p)
 	mTextSelectedColor(p.text_selected_color),
 	mSelectedBGColor(p.bg_selected_color),
 	mReflowIndex(S32_MAX),
+	mReflowCleanTail(0),
+	mReflowLength(0),
+	mReflowWidth(0.f),
 	mCursorPos( 0 ),
 	mScrollNeeded(FALSE),
 	mDesiredXPixel(-1),
@@ -813,6 +816,8 @@ S32 LLTextBase::insertStringNoUndo(S32 pos, const LLWString &wstr, LLTextBase::s
 	}
 
 	// insert new segments
+	// (they lie within the inserted text, so don't let them dirty the rest of the document)
+	S32 clean_tail = mReflowCleanTail;
 	if (segments)
 	{
 		if (default_segment.notNull())
@@ -828,6 +833,7 @@ S32 LLTextBase::insertStringNoUndo(S32 pos, const LLWString &wstr, LLTextBase::s
 			insertSegment(segmentp);
 		}
 	}
+	mReflowCleanTail = clean_tail;
 
 	getViewModel()->getEditableDisplay().insert(pos, wstr);
 
@@ -837,7 +843,7 @@ S32 LLTextBase::insertStringNoUndo(S32 pos, const LLWString &wstr, LLTextBase::s
 	}
 
 	onValueChange(pos, pos + insert_len);
-	needsReflow(pos);
+	needsReflowRange(pos, pos + insert_len);
 
 	return insert_len;
 }
@@ -897,7 +903,7 @@ S32 LLTextBase::removeStringNoUndo(S32 pos, S32 length)
 	createDefaultSegment();
 
 	onValueChange(pos, pos);
-	needsReflow(pos);
+	needsReflowRange(pos, pos);
 
 	return -length;	// This will be wrong if someone calls removeStringNoUndo with an excessive length
 }
@@ -913,7 +919,7 @@ S32 LLTextBase::overwriteCharNoUndo(S32 pos, llwchar wc)
 	getViewModel()->getEditableDisplay()[pos] = wc;
 
 	onValueChange(pos, pos + 1);
-	needsReflow(pos);
+	needsReflowRange(pos, pos + 1);
 
 	return 1;
 }
@@ -1506,6 +1512,13 @@ void LLTextBase::reflow()
 		S32 start_index = mReflowIndex;
 		mReflowIndex = S32_MAX;
 
+		// lines laid out last time that start inside the untouched tail of the document
+		// can be reused as-is once the new layout reaches one of their start positions
+		const S32 clean_tail_start = getLength() - mReflowCleanTail;
+		const S32 length_delta = getLength() - mReflowLength;
+		// nothing has been edited since this layout
+		mReflowCleanTail = S32_MAX;
+
 		// shrink document to minimum size (visible portion of text widget)
 		// to force inlined widgets with follows set to shrink
 		if (mWordWrap)
@@ -1523,6 +1536,7 @@ void LLTextBase::reflow()
 		S32 line_count = 0;
 
 		// find and erase line info structs starting at start_index and going to end of document
+		line_list_t old_lines;
 		if (!mLineInfoList.empty())
 		{
 			// find first element whose end comes after start_index
@@ -1531,14 +1545,37 @@ void LLTextBase::reflow()
 			line_count = iter->mLineNum;
 			cur_top = iter->mRect.mTop;
 			getSegmentAndOffset(iter->mDocIndexStart, &seg_iter, &seg_offset);
+			if (text_available_width == mReflowWidth && clean_tail_start < getLength())
+			{
+				old_lines.assign(iter, mLineInfoList.end());
+			}
 			mLineInfoList.erase(iter, mLineInfoList.end());
 		}
+		line_list_t::iterator old_line_iter = old_lines.begin();
 
 		S32 line_height = 0;
 		S32 seg_line_offset = line_count + 1;
 
 		while(seg_iter != mSegments.end())
 		{
+			// at the start of a new line inside the untouched tail, check whether the old layout
+			// had a line starting at the same place; if so, everything from there on is unchanged
+			if (line_height == 0
+				&& remaining_pixels == text_available_width
+				&& seg_offset + (*seg_iter)->getStart() == line_start_index
+				&& line_start_index >= clean_tail_start
+				&& old_line_iter != old_lines.end())
+			{
+				S32 old_start_index = line_start_index - length_delta;
+				old_line_iter = std::lower_bound(old_line_iter, old_lines.end(), old_start_index + 1, line_end_compare());
+				if (old_line_iter != old_lines.end()
+					&& old_line_iter->mDocIndexStart == old_start_index)
+				{
+					spliceLines(old_line_iter, old_lines.end(), length_delta, line_count - old_line_iter->mLineNum, cur_top - old_line_iter->mRect.mTop);
+					break;
+				}
+			}
+
 			LLTextSegmentPtr segment = *seg_iter;
 
 			// track maximum height of any segment on this line
@@ -1623,6 +1660,9 @@ void LLTextBase::reflow()
 			}
 		}
 
+		mReflowLength = getLength();
+		mReflowWidth = text_available_width;
+
 		// calculate visible region for diplaying text
 		updateRects();
 
@@ -1672,6 +1712,20 @@ void LLTextBase::reflow()
 	updateCursorXPos();
 }
 
+void LLTextBase::spliceLines(line_list_t::const_iterator begin, line_list_t::const_iterator end, S32 index_delta, S32 line_num_delta, S32 top_delta)
+{
+	mLineInfoList.reserve(mLineInfoList.size() + (end - begin));
+	for (line_list_t::const_iterator it = begin; it != end; ++it)
+	{
+		line_info line(*it);
+		line.mDocIndexStart += index_delta;
+		line.mDocIndexEnd += index_delta;
+		line.mLineNum += line_num_delta;
+		line.mRect.translate(0, top_delta);
+		mLineInfoList.push_back(line);
+	}
+}
+
 LLRect LLTextBase::getTextBoundingRect()
 {
 	reflow();
@@ -2226,6 +2280,16 @@ void LLTextBase::needsReflow(S32 index)
 {
 	LL_DEBUGS() << "reflow on object " << (void*)this << " index = " << mReflowIndex << ", new index = " << index << LL_ENDL;
 	mReflowIndex = llmin(mReflowIndex, index);
+	// layout of everything past index may have changed
+	mReflowCleanTail = 0;
+}
+
+void LLTextBase::needsReflowRange(S32 start, S32 end)
+{
+	LL_DEBUGS() << "reflow on object " << (void*)this << " index = " << mReflowIndex << ", new range = " << start << "-" << end << LL_ENDL;
+	mReflowIndex = llmin(mReflowIndex, start);
+	// text after end is unchanged, so its lines can be reused once layout converges
+	mReflowCleanTail = llmax(0, llmin(mReflowCleanTail, getLength() - end));
 }
 
 void LLTextBase::appendLineBreakSegment(const LLStyle::Params& style_params)
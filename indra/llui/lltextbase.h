@@ -429,6 +429,8 @@ public:
 
 	// force reflow of text
 	void					needsReflow(S32 index = 0);
+	// force reflow of text changed only in [start, end), lines past end can be reused
+	void					needsReflowRange(S32 start, S32 end);
 
 	S32						getLength() const { return getWText().length(); }
 	S32						getLineCount() const { return mLineInfoList.size(); }
@@ -599,6 +601,8 @@ protected:
 	std::pair<S32, S32>				getVisibleLines(bool fully_visible = false);
 	S32								getLeftOffset(S32 width);
 	void							reflow();
+	// append previously laid out lines, shifted to their new document position
+	void							spliceLines(line_list_t::const_iterator begin, line_list_t::const_iterator end, S32 index_delta, S32 line_num_delta, S32 top_delta);
 
 	// cursor
 	void							updateCursorXPos();
@@ -707,6 +711,9 @@ protected:
 
 	// transient state
 	S32							mReflowIndex;		// index at which to start reflow.  S32_MAX indicates no reflow needed.
+	S32							mReflowCleanTail;	// number of characters at end of document untouched since last reflow
+	S32							mReflowLength;		// document length at last reflow
+	F32							mReflowWidth;		// available text width at last reflow
 	bool						mScrollNeeded;		// need to change scroll region because of change to cursor position
 	S32							mScrollIndex;		// index of first character to keep visible in scroll region
 
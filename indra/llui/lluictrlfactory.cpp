@@ -36,6 +36,8 @@
 
 // other library includes
 #include "llcontrol.h"
+#include "llfile.h"
+#include "llmd5.h"
 #include "lldir.h"
 #include "v4color.h"
 #include "v3dmath.h"
@@ -160,13 +162,13 @@ void LLUICtrlFactory::createChildren(LLView* viewp, LLXMLNodePtr node, const wid
 }
 
 static LLTrace::BlockTimerStatHandle FTM_XML_PARSE("XML Reading/Parsing");
+static LLTrace::BlockTimerStatHandle FTM_XUI_CACHE_READ("XUI Cache Reading");
 //-----------------------------------------------------------------------------
 // getLayeredXMLNode()
 //-----------------------------------------------------------------------------
 bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root,
                                         LLDir::ESkinConstraint constraint)
 {
-	LL_RECORD_BLOCK_TIME(FTM_XML_PARSE);
 	std::vector<std::string> paths =
 		gDirUtilp->findSkinnedFilenames(LLDir::XUI, xui_filename, constraint);
 
@@ -176,7 +178,134 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		paths.push_back(xui_filename);
 	}
 
-	return LLXMLNode::getLayeredXMLNode(root, paths);
+	if (sXUICacheDir.empty())
+	{
+		LL_RECORD_BLOCK_TIME(FTM_XML_PARSE);
+		return LLXMLNode::getLayeredXMLNode(root, paths);
+	}
+
+	if (loadXUICache(paths, root))
+	{
+		return true;
+	}
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_XML_PARSE);
+		if (!LLXMLNode::getLayeredXMLNode(root, paths))
+		{
+			return false;
+		}
+	}
+
+	saveXUICache(paths, root);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// binary XUI cache
+//-----------------------------------------------------------------------------
+std::string LLUICtrlFactory::sXUICacheDir;
+
+// Bump whenever what gets cached changes meaning
+static const S32 XUI_CACHE_VERSION = 1;
+
+// Identifies the cached tree for a set of layered files (which already encode skin and language)
+static std::string xui_cache_filename(const std::string& cache_dir, const std::vector<std::string>& paths)
+{
+	LLMD5 md5;
+	for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+	{
+		md5.update(*it + "\n");
+	}
+	md5.finalize();
+	char digest[33];
+	md5.hex_digest(digest);
+	return cache_dir + gDirUtilp->getDirDelimiter() + digest + ".xuib";
+}
+
+// Modification time and size of every layer, a cached tree is only valid if these still match
+static std::string xui_cache_stamp(const std::vector<std::string>& paths)
+{
+	std::ostringstream stamp;
+	stamp << XUI_CACHE_VERSION;
+	for (std::vector<std::string>::const_iterator it = paths.begin(); it != paths.end(); ++it)
+	{
+		llstat stat_data;
+		stamp << '\n' << *it << '|';
+		if (!it->empty() && LLFile::stat(*it, &stat_data) == 0)
+		{
+			stamp << (S64)stat_data.st_mtime << '|' << (S64)stat_data.st_size;
+		}
+	}
+	return stamp.str();
+}
+
+//static
+void LLUICtrlFactory::setXUICacheDir(const std::string& dir)
+{
+	sXUICacheDir = dir;
+	if (!sXUICacheDir.empty())
+	{
+		LLFile::mkdir(sXUICacheDir);
+	}
+}
+
+//static
+bool LLUICtrlFactory::loadXUICache(const std::vector<std::string>& paths, LLXMLNodePtr& root)
+{
+	LL_RECORD_BLOCK_TIME(FTM_XUI_CACHE_READ);
+	llifstream input(xui_cache_filename(sXUICacheDir, paths).c_str(), std::ios::in | std::ios::binary);
+	if (!input.is_open())
+	{
+		return false;
+	}
+
+	// stamp node, followed by the cached tree
+	LLXMLNodePtr stamp_node;
+	if (!LLXMLNode::parseBinary(input, stamp_node)
+		|| stamp_node->getValue() != xui_cache_stamp(paths))
+	{
+		return false;
+	}
+
+	LLXMLNodePtr cached_root;
+	if (!LLXMLNode::parseBinary(input, cached_root))
+	{
+		LL_WARNS() << "Corrupt XUI cache entry for " << paths.front() << LL_ENDL;
+		return false;
+	}
+
+	root = cached_root;
+	return true;
+}
+
+//static
+void LLUICtrlFactory::saveXUICache(const std::vector<std::string>& paths, LLXMLNodePtr& root)
+{
+	std::string filename = xui_cache_filename(sXUICacheDir, paths);
+	std::string temp_filename = filename + ".tmp";
+	{
+		llofstream output(temp_filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!output.is_open())
+		{
+			return;
+		}
+
+		LLXMLNodePtr stamp_node = new LLXMLNode("xui_cache", FALSE);
+		stamp_node->setValue(xui_cache_stamp(paths));
+		stamp_node->writeBinary(output);
+		root->writeBinary(output);
+		if (!output.good())
+		{
+			output.close();
+			LLFile::remove(temp_filename);
+			return;
+		}
+	}
+
+	// replace any stale entry in one step so readers never see a partial file
+	LLFile::remove(filename, ENOENT);
+	LLFile::rename(temp_filename, filename);
 }
 
 
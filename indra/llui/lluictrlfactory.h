@@ -204,6 +204,11 @@ fail:
 	static bool getLayeredXMLNode(const std::string &filename, LLXMLNodePtr& root,
 								  LLDir::ESkinConstraint constraint=LLDir::CURRENT_SKIN);
 
+	// Keep binary copies of layered XUI trees in dir, so floaters and panels skip XML
+	// parsing and skin/language layering when their files haven't changed.
+	// An empty dir disables the cache.
+	static void setXUICacheDir(const std::string& dir);
+
 private:
 	//NOTE: both friend declarations are necessary to keep both gcc and msvc happy
 	template <typename T> friend class LLChildRegistry;
@@ -211,6 +216,11 @@ private:
 
 	static void copyName(LLXMLNodePtr src, LLXMLNodePtr dest);
 
+	static bool loadXUICache(const std::vector<std::string>& paths, LLXMLNodePtr& root);
+	static void saveXUICache(const std::vector<std::string>& paths, LLXMLNodePtr& root);
+
+	static std::string			sXUICacheDir;
+
 	// helper function for adding widget type info to various registries
 	static void registerWidget(const std::type_info* widget_type, const std::type_info* param_block_type, const std::string& tag);
 
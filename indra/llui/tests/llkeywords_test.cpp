@@ -0,0 +1,491 @@
+/**
+ * @file llkeywords_test.cpp
+ * @brief Tests for LLKeywords syntax highlighting segments.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../llkeywords.h"
+#include "../lltexteditor.h"
+#include "../lluicolortable.h"
+
+#include <set>
+
+#include "lltut.h"
+
+// link seams
+
+LLUIColor::LLUIColor(const LLColor4& color)
+:	mColorPtr(NULL),
+	mColor(color)
+{}
+
+LLUIColor::operator const LLColor4& () const
+{
+	return mColor;
+}
+
+LLUIColor LLUIColorTable::getColor(const std::string& name, const LLColor4& default_color) const
+{
+	return LLUIColor(default_color);
+}
+
+BOOL LLMouseHandler::handleAnyMouseClick(S32 x, S32 y, MASK mask, EClickType clicktype, BOOL down) { return FALSE; }
+
+LLTextSegment::~LLTextSegment() {}
+bool LLTextSegment::getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const { return false; }
+S32 LLTextSegment::getOffset(S32 segment_local_x_coord, S32 start_offset, S32 num_chars, bool round) const { return 0; }
+S32 LLTextSegment::getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const { return 0; }
+void LLTextSegment::updateLayout(const LLTextBase& editor) {}
+F32 LLTextSegment::draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect) { return 0.f; }
+bool LLTextSegment::canEdit() const { return false; }
+void LLTextSegment::unlinkFromDocument(LLTextBase* editor) {}
+void LLTextSegment::linkToDocument(LLTextBase* editor) {}
+const LLColor4& LLTextSegment::getColor() const { return LLColor4::white; }
+LLStyleConstSP LLTextSegment::getStyle() const { return LLStyleConstSP(); }
+void LLTextSegment::setStyle(LLStyleConstSP style) {}
+void LLTextSegment::setToken(LLKeywordToken* token) {}
+LLKeywordToken* LLTextSegment::getToken() const { return NULL; }
+void LLTextSegment::setToolTip(const std::string& tooltip) {}
+void LLTextSegment::dump() const {}
+BOOL LLTextSegment::handleMouseDown(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleMouseUp(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleMiddleMouseDown(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleMiddleMouseUp(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleRightMouseDown(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleRightMouseUp(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleDoubleClick(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleHover(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLTextSegment::handleScrollWheel(S32 x, S32 y, S32 clicks) { return FALSE; }
+BOOL LLTextSegment::handleScrollHWheel(S32 x, S32 y, S32 clicks) { return FALSE; }
+BOOL LLTextSegment::handleToolTip(S32 x, S32 y, MASK mask) { return FALSE; }
+const std::string& LLTextSegment::getName() const { return LLStringUtil::null; }
+void LLTextSegment::onMouseCaptureLost() {}
+void LLTextSegment::screenPointToLocal(S32 screen_x, S32 screen_y, S32* local_x, S32* local_y) const {}
+void LLTextSegment::localPointToScreen(S32 local_x, S32 local_y, S32* screen_x, S32* screen_y) const {}
+BOOL LLTextSegment::hasMouseCapture() { return FALSE; }
+
+LLNormalTextSegment::LLNormalTextSegment(const LLColor4& color, S32 start, S32 end, LLTextBase& editor, BOOL is_visible)
+:	LLTextSegment(start, end),
+	mEditor(editor),
+	mFontHeight(0),
+	mToken(NULL)
+{}
+LLNormalTextSegment::~LLNormalTextSegment() {}
+bool LLNormalTextSegment::getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const { return false; }
+S32 LLNormalTextSegment::getOffset(S32 segment_local_x_coord, S32 start_offset, S32 num_chars, bool round) const { return 0; }
+S32 LLNormalTextSegment::getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const { return 0; }
+F32 LLNormalTextSegment::draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect) { return 0.f; }
+BOOL LLNormalTextSegment::getToolTip(std::string& msg) const { return FALSE; }
+void LLNormalTextSegment::setToolTip(const std::string& tooltip) {}
+void LLNormalTextSegment::dump() const {}
+BOOL LLNormalTextSegment::handleHover(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLNormalTextSegment::handleRightMouseDown(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLNormalTextSegment::handleMouseDown(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLNormalTextSegment::handleMouseUp(S32 x, S32 y, MASK mask) { return FALSE; }
+BOOL LLNormalTextSegment::handleToolTip(S32 x, S32 y, MASK mask) { return FALSE; }
+const LLWString& LLNormalTextSegment::getWText() const { return LLWStringUtil::null; }
+const S32 LLNormalTextSegment::getLength() const { return 0; }
+
+LLLineBreakTextSegment::LLLineBreakTextSegment(S32 pos)
+:	LLTextSegment(pos, pos + 1),
+	mFontHeight(0)
+{}
+LLLineBreakTextSegment::~LLLineBreakTextSegment() {}
+bool LLLineBreakTextSegment::getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const { return false; }
+S32 LLLineBreakTextSegment::getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const { return 1; }
+F32 LLLineBreakTextSegment::draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect) { return 0.f; }
+
+namespace
+{
+	struct SampleToken
+	{
+		LLKeywordToken::ETokenType mType;
+		const char* mKey;
+		const char* mDelimiter;
+	};
+
+	const SampleToken SAMPLE_TOKENS[] =
+	{
+		{ LLKeywordToken::TT_LINE, "#", "" },
+		{ LLKeywordToken::TT_ONE_SIDED_DELIMITER, "//", "" },
+		{ LLKeywordToken::TT_TWO_SIDED_DELIMITER, "/*", "*/" },
+		{ LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS, "\"", "\"" },
+		{ LLKeywordToken::TT_TYPE, "integer", "" },
+		{ LLKeywordToken::TT_TYPE, "string", "" },
+		{ LLKeywordToken::TT_TYPE, "vector", "" },
+		{ LLKeywordToken::TT_CONTROL, "if", "" },
+		{ LLKeywordToken::TT_CONTROL, "else", "" },
+		{ LLKeywordToken::TT_CONTROL, "jump", "" },
+		{ LLKeywordToken::TT_CONTROL, "return", "" },
+		{ LLKeywordToken::TT_SECTION, "default", "" },
+		{ LLKeywordToken::TT_EVENT, "state_entry", "" },
+		{ LLKeywordToken::TT_EVENT, "touch_start", "" },
+		{ LLKeywordToken::TT_FUNCTION, "llSay", "" },
+		{ LLKeywordToken::TT_FUNCTION, "llOwnerSay", "" },
+		{ LLKeywordToken::TT_FUNCTION, "llDetectedKey", "" },
+		{ LLKeywordToken::TT_CONSTANT, "PI", "" },
+		{ LLKeywordToken::TT_CONSTANT, "ZERO_VECTOR", "" },
+	};
+
+	const char* SAMPLE_SCRIPTS[] =
+	{
+		"default\n{\n    state_entry()\n    {\n        llSay(0, \"Hello, Avatar!\");\n    }\n}\n",
+		// indented and unindented line start tokens
+		"#define X\n  #include \"a\"\n\t#if 1\n  x = 1; # not at line start\n#\n",
+		// block comments and strings running over several lines
+		"integer a; /* one\ntwo integer\n  three */ integer b;\nstring s = \"first\n  second\\\" still\n\"; PI\n",
+		// escapes, adjacent delimiters and comments at the end of the text
+		"string t = \"\\\\\"; string u = \"\\\\\\\"\";/**//**/llSay(0,\"\"); // done\n/* open to eof",
+		// words glued to other words are not keywords
+		"integerx _if if_ llSayllSay ZERO_VECTOR.x 2PI PI2 @label; jump label;\n\n\n   \n",
+		"default { touch_start(integer n) { if (n) llOwnerSay((string)llDetectedKey(0)); else return; } }",
+	};
+
+	LLWString to_wstring(const std::string& text)
+	{
+		return utf8str_to_wstring(text);
+	}
+
+	void add_sample_tokens(LLKeywords& keywords)
+	{
+		for (size_t i = 0; i < LL_ARRAY_SIZE(SAMPLE_TOKENS); ++i)
+		{
+			const SampleToken& token = SAMPLE_TOKENS[i];
+			keywords.addToken(token.mType, token.mKey, LLColor4::white, LLStringUtil::null, token.mDelimiter);
+		}
+	}
+
+	const SampleToken* find_head(const llwchar* cur, bool line_tokens, bool delimiters)
+	{
+		for (size_t i = 0; i < LL_ARRAY_SIZE(SAMPLE_TOKENS); ++i)
+		{
+			const SampleToken& token = SAMPLE_TOKENS[i];
+			bool is_line = token.mType == LLKeywordToken::TT_LINE;
+			bool is_delimiter = token.mType == LLKeywordToken::TT_ONE_SIDED_DELIMITER
+				|| token.mType == LLKeywordToken::TT_TWO_SIDED_DELIMITER
+				|| token.mType == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS;
+			if ((is_line && line_tokens) || (is_delimiter && delimiters))
+			{
+				const char* key = token.mKey;
+				S32 i = 0;
+				while (key[i] && cur[i] == (llwchar)key[i])
+				{
+					++i;
+				}
+				if (!key[i])
+				{
+					return &token;
+				}
+			}
+		}
+		return NULL;
+	}
+
+	bool is_tail(const SampleToken* token, const llwchar* cur)
+	{
+		const char* tail = token->mDelimiter;
+		S32 i = 0;
+		while (tail[i] && cur[i] == (llwchar)tail[i])
+		{
+			++i;
+		}
+		return !tail[i];
+	}
+
+	void set_label(std::vector<std::string>& labels, const LLWString& text, S32 start, S32 end, const std::string& label)
+	{
+		for (S32 i = start; i < end && i < (S32)text.size(); ++i)
+		{
+			if (text[i] != '\n')
+			{
+				labels[i] = label;
+			}
+		}
+	}
+
+	// The token highlighting each character, as the whole text walk
+	// LLKeywords::findSegments() used before it tokenized by line.
+	std::vector<std::string> old_labels(const LLWString& wtext)
+	{
+		std::set<std::string> words;
+		for (size_t i = 0; i < LL_ARRAY_SIZE(SAMPLE_TOKENS); ++i)
+		{
+			if (!find_head(to_wstring(SAMPLE_TOKENS[i].mKey).c_str(), true, true))
+			{
+				words.insert(SAMPLE_TOKENS[i].mKey);
+			}
+		}
+
+		std::vector<std::string> labels(wtext.size());
+		const llwchar* base = wtext.c_str();
+		const llwchar* cur = base;
+		while (*cur)
+		{
+			if (*cur == '\n' || cur == base)
+			{
+				if (*cur == '\n')
+				{
+					cur++;
+					if (!*cur || *cur == '\n')
+					{
+						continue;
+					}
+				}
+
+				while (*cur && iswspace(*cur) && *cur != '\n')
+				{
+					cur++;
+				}
+				if (!*cur || *cur == '\n')
+				{
+					continue;
+				}
+
+				const SampleToken* line_token = find_head(cur, true, false);
+				if (line_token)
+				{
+					S32 seg_start = cur - base;
+					while (*cur && *cur != '\n')
+					{
+						cur++;
+					}
+					set_label(labels, wtext, seg_start, cur - base, line_token->mKey);
+					continue;
+				}
+			}
+
+			while (*cur && iswspace(*cur) && *cur != '\n')
+			{
+				cur++;
+			}
+
+			while (*cur && *cur != '\n')
+			{
+				const SampleToken* delimiter = find_head(cur, false, true);
+				if (delimiter)
+				{
+					S32 seg_start = cur - base;
+					cur += strlen(delimiter->mKey);
+					if (delimiter->mType == LLKeywordToken::TT_ONE_SIDED_DELIMITER)
+					{
+						while (*cur && *cur != '\n')
+						{
+							cur++;
+						}
+					}
+					else
+					{
+						while (*cur && !is_tail(delimiter, cur))
+						{
+							if (delimiter->mType == LLKeywordToken::TT_DOUBLE_QUOTATION_MARKS && *cur == '\\')
+							{
+								S32 num_backslashes = 0;
+								while (*cur == '\\')
+								{
+									num_backslashes++;
+									cur++;
+								}
+								if (is_tail(delimiter, cur))
+								{
+									if (num_backslashes % 2 == 1)
+									{
+										cur++;
+									}
+									else
+									{
+										break;
+									}
+								}
+							}
+							else
+							{
+								cur++;
+							}
+						}
+						if (*cur)
+						{
+							cur += strlen(delimiter->mDelimiter);
+						}
+					}
+					set_label(labels, wtext, seg_start, cur - base, delimiter->mKey);
+					continue;
+				}
+
+				llwchar prev = cur > base ? *(cur - 1) : 0;
+				if (!iswalnum(prev) && prev != '_')
+				{
+					const llwchar* p = cur;
+					while (iswalnum(*p) || *p == '_')
+					{
+						p++;
+					}
+					if (p > cur)
+					{
+						std::string word = wstring_to_utf8str(LLWString(cur, p));
+						if (words.count(word))
+						{
+							set_label(labels, wtext, cur - base, p - base, word);
+						}
+						cur = p;
+						continue;
+					}
+				}
+
+				if (*cur && *cur != '\n')
+				{
+					cur++;
+				}
+			}
+		}
+		return labels;
+	}
+
+	// The token highlighting each character in a list of segments from start to end
+	std::vector<std::string> segment_labels(const std::vector<LLTextSegmentPtr>& segments, S32 start, S32 end)
+	{
+		std::vector<std::string> labels(end - start);
+		for (size_t i = 0; i < segments.size(); ++i)
+		{
+			LLKeywordToken* token = segments[i]->getToken();
+			for (S32 c = llmax(start, segments[i]->getStart()); c < llmin(end, segments[i]->getEnd()); ++c)
+			{
+				labels[c - start] = token ? wstring_to_utf8str(token->getToken()) : "";
+			}
+		}
+		return labels;
+	}
+
+	// segments must be in order, contiguous and cover start to end
+	bool contiguous(const std::vector<LLTextSegmentPtr>& segments, S32 start, S32 end)
+	{
+		S32 pos = start;
+		for (size_t i = 0; i < segments.size(); ++i)
+		{
+			if (segments[i]->getStart() != pos || segments[i]->getEnd() <= pos)
+			{
+				return false;
+			}
+			pos = segments[i]->getEnd();
+		}
+		return pos == end;
+	}
+
+	LLTextEditor& no_editor()
+	{
+		// the segment link seams never look at the editor
+		static U64 storage[(sizeof(LLTextEditor) + sizeof(U64) - 1) / sizeof(U64)];
+		return *reinterpret_cast<LLTextEditor*>(storage);
+	}
+}
+
+namespace tut
+{
+	struct keywords
+	{
+		keywords()
+		{
+			add_sample_tokens(mKeywords);
+		}
+
+		LLKeywords mKeywords;
+	};
+
+	typedef test_group<keywords> keywords_test;
+	typedef keywords_test::object keywords_t;
+	keywords_test tut_keywords("LLKeywords");
+
+	// the line by line tokenizer highlights the sample scripts as the whole text walk did
+	template<> template<>
+	void keywords_t::test<1>()
+	{
+		for (size_t i = 0; i < LL_ARRAY_SIZE(SAMPLE_SCRIPTS); ++i)
+		{
+			LLWString text = to_wstring(SAMPLE_SCRIPTS[i]);
+			std::vector<LLTextSegmentPtr> segments;
+			mKeywords.findSegments(&segments, text, LLColor4::black, no_editor());
+
+			ensure(llformat("script %d contiguous", (S32)i), contiguous(segments, 0, text.size() + 1));
+			std::vector<std::string> labels = segment_labels(segments, 0, text.size());
+			std::vector<std::string> expected = old_labels(text);
+			for (size_t c = 0; c < text.size(); ++c)
+			{
+				ensure_equals(llformat("script %d character %d", (S32)i, (S32)c), labels[c], expected[c]);
+			}
+		}
+	}
+
+	// indented line start tokens are highlighted
+	template<> template<>
+	void keywords_t::test<2>()
+	{
+		LLWString text = to_wstring("x;\n   # indented\n\t#tab\n");
+		std::vector<LLTextSegmentPtr> segments;
+		mKeywords.findSegments(&segments, text, LLColor4::black, no_editor());
+		std::vector<std::string> labels = segment_labels(segments, 0, text.size());
+		ensure_equals("leading white space", labels[3], std::string(""));
+		ensure_equals("spaces", labels[6], std::string("#"));
+		ensure_equals("spaces, rest of line", labels[15], std::string("#"));
+		ensure_equals("tab", labels[19], std::string("#"));
+	}
+
+	// re-tokenizing from an edit gives the same segments as tokenizing the whole text
+	template<> template<>
+	void keywords_t::test<3>()
+	{
+		const char* inserts[] = { "/*", "*/", "\"", "\n", "  # x\n", "integer ", "\\", "//", "if" };
+		U32 seed = 5;
+		for (size_t i = 0; i < LL_ARRAY_SIZE(SAMPLE_SCRIPTS); ++i)
+		{
+			LLWString text = to_wstring(SAMPLE_SCRIPTS[i]);
+			std::vector<LLTextSegmentPtr> segments;
+			mKeywords.findSegments(&segments, text, LLColor4::black, no_editor());
+			for (S32 edit = 0; edit < 50; ++edit)
+			{
+				seed = seed * 1103515245 + 12345;
+				S32 pos = (seed >> 8) % (text.size() + 1);
+				LLWString insert = to_wstring(inserts[(seed >> 20) % LL_ARRAY_SIZE(inserts)]);
+				text.insert(pos, insert);
+
+				std::vector<LLTextSegmentPtr> updated;
+				mKeywords.updateSegments(&updated, text, pos, text.size() - pos - insert.size(), LLColor4::black, no_editor());
+				ensure(llformat("script %d edit %d updated something", (S32)i, edit), !updated.empty());
+				S32 start = updated.front()->getStart();
+				S32 end = updated.back()->getEnd();
+				ensure(llformat("script %d edit %d contiguous", (S32)i, edit), contiguous(updated, start, end));
+				ensure(llformat("script %d edit %d covers the edit", (S32)i, edit), start <= pos && end >= pos + (S32)insert.size());
+
+				// updateSegments() kept its cache, tokenize the copy from scratch
+				LLKeywords whole;
+				add_sample_tokens(whole);
+				std::vector<LLTextSegmentPtr> full;
+				whole.findSegments(&full, text, LLColor4::black, no_editor());
+				std::vector<std::string> expected = segment_labels(full, start, llmin(end, (S32)text.size()));
+				std::vector<std::string> labels = segment_labels(updated, start, llmin(end, (S32)text.size()));
+				ensure(llformat("script %d edit %d", (S32)i, edit), labels == expected);
+			}
+		}
+	}
+}
@@ -876,6 +876,163 @@ bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
 	return true;
 }
 
+namespace
+{
+	const U32 XML_BINARY_MAGIC = 0x42584c4c; // "LLXB"
+	const U32 XML_BINARY_VERSION = 1;
+	const U32 XML_BINARY_MAX_STRING = 16 * 1024 * 1024;
+	const S32 XML_BINARY_MAX_DEPTH = 256;
+
+	template<typename T>
+	void write_binary(std::ostream& output_stream, const T& value)
+	{
+		output_stream.write((const char*)&value, sizeof(T));
+	}
+
+	template<typename T>
+	bool read_binary(std::istream& input_stream, T& value)
+	{
+		input_stream.read((char*)&value, sizeof(T));
+		return input_stream.good();
+	}
+
+	void write_binary_string(std::ostream& output_stream, const std::string& value)
+	{
+		write_binary(output_stream, (U32)value.size());
+		output_stream.write(value.data(), value.size());
+	}
+
+	bool read_binary_string(std::istream& input_stream, std::string& value)
+	{
+		U32 length = 0;
+		if (!read_binary(input_stream, length) || length > XML_BINARY_MAX_STRING)
+		{
+			return false;
+		}
+		value.resize(length);
+		if (length)
+		{
+			input_stream.read(&value[0], length);
+		}
+		return input_stream.good();
+	}
+}
+
+void LLXMLNode::writeBinary(std::ostream& output_stream)
+{
+	write_binary(output_stream, XML_BINARY_MAGIC);
+	write_binary(output_stream, XML_BINARY_VERSION);
+	writeBinaryNode(output_stream);
+}
+
+void LLXMLNode::writeBinaryNode(std::ostream& output_stream)
+{
+	write_binary_string(output_stream, mName ? std::string(mName->mString) : std::string());
+	write_binary_string(output_stream, mValue);
+	write_binary_string(output_stream, mID);
+	write_binary(output_stream, (U8)mIsAttribute);
+	write_binary(output_stream, (U8)mType);
+	write_binary(output_stream, (U8)mEncoding);
+	write_binary(output_stream, mVersionMajor);
+	write_binary(output_stream, mVersionMinor);
+	write_binary(output_stream, mLength);
+	write_binary(output_stream, mPrecision);
+	write_binary(output_stream, mLineNumber);
+
+	write_binary(output_stream, (U32)mAttributes.size());
+	for (LLXMLAttribList::iterator iter = mAttributes.begin(); iter != mAttributes.end(); ++iter)
+	{
+		iter->second->writeBinaryNode(output_stream);
+	}
+
+	// children in document order, not name order
+	U32 num_children = 0;
+	for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+	{
+		num_children++;
+	}
+	write_binary(output_stream, num_children);
+	for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+	{
+		child->writeBinaryNode(output_stream);
+	}
+}
+
+// static
+bool LLXMLNode::parseBinary(std::istream& input_stream, LLXMLNodePtr& node)
+{
+	node = NULL;
+
+	U32 magic = 0;
+	U32 version = 0;
+	if (!read_binary(input_stream, magic) || magic != XML_BINARY_MAGIC
+		|| !read_binary(input_stream, version) || version != XML_BINARY_VERSION)
+	{
+		return false;
+	}
+
+	node = readBinaryNode(input_stream, 0);
+	return node.notNull();
+}
+
+// static
+LLXMLNodePtr LLXMLNode::readBinaryNode(std::istream& input_stream, S32 depth)
+{
+	std::string name;
+	std::string value;
+	std::string id;
+	U8 is_attribute = 0;
+	U8 type = 0;
+	U8 encoding = 0;
+	if (depth > XML_BINARY_MAX_DEPTH
+		|| !read_binary_string(input_stream, name)
+		|| !read_binary_string(input_stream, value)
+		|| !read_binary_string(input_stream, id)
+		|| !read_binary(input_stream, is_attribute)
+		|| !read_binary(input_stream, type)
+		|| !read_binary(input_stream, encoding)
+		|| type > TYPE_NODEREF
+		|| encoding > ENCODING_HEX)
+	{
+		return NULL;
+	}
+
+	LLXMLNodePtr node = new LLXMLNode(name.c_str(), is_attribute);
+	node->mValue = value;
+	node->mID = id;
+	node->mType = (ValueType)type;
+	node->mEncoding = (Encoding)encoding;
+	if (!read_binary(input_stream, node->mVersionMajor)
+		|| !read_binary(input_stream, node->mVersionMinor)
+		|| !read_binary(input_stream, node->mLength)
+		|| !read_binary(input_stream, node->mPrecision)
+		|| !read_binary(input_stream, node->mLineNumber))
+	{
+		return NULL;
+	}
+
+	// attributes first, then children
+	for (S32 pass = 0; pass < 2; pass++)
+	{
+		U32 count = 0;
+		if (!read_binary(input_stream, count))
+		{
+			return NULL;
+		}
+		for (U32 i = 0; i < count; i++)
+		{
+			LLXMLNodePtr child = readBinaryNode(input_stream, depth + 1);
+			if (child.isNull())
+			{
+				return NULL;
+			}
+			node->addChild(child);
+		}
+	}
+
+	return node;
+}
+
 // static
 void LLXMLNode::writeHeaderToFile(LLFILE *out_file)
 {
@@ -148,6 +148,11 @@ public:
 		LLXMLNodePtr& update_node);
 	
 	static bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
+
+	// Compact binary form of an already parsed tree, much cheaper to read back than XML.
+	// Not a stable interchange format, only meant for local caches.
+	void writeBinary(std::ostream& output_stream);
+	static bool parseBinary(std::istream& input_stream, LLXMLNodePtr& node);
 	
 	
 	// Write standard XML file header:
@@ -294,6 +299,8 @@ public:
 
 protected:
 	BOOL removeChild(LLXMLNode* child);
+	void writeBinaryNode(std::ostream& output_stream);
+	static LLXMLNodePtr readBinaryNode(std::istream& input_stream, S32 depth);
 
 public:
 	std::string mID;				// The ID attribute of this node
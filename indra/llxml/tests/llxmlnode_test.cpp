@@ -0,0 +1,101 @@
+/** 
+ * @file llxmlnode_test.cpp
+ * @date   October 2026
+ * @brief LLXMLNode binary serialization tests
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llxmlnode.h"
+
+#include "../test/lltut.h"
+#include <sstream>
+
+namespace tut
+{
+	struct xml_node
+	{
+		LLXMLNodePtr parse(const std::string& xml)
+		{
+			LLXMLNodePtr node;
+			std::vector<U8> buffer(xml.begin(), xml.end());
+			ensure("xml parsed", LLXMLNode::parseBuffer(&buffer[0], buffer.size(), node, NULL));
+			return node;
+		}
+
+		std::string toXML(LLXMLNodePtr node)
+		{
+			std::ostringstream output;
+			node->writeToOstream(output);
+			return output.str();
+		}
+	};
+
+	typedef test_group<xml_node> xml_node_test;
+	typedef xml_node_test::object xml_node_t;
+	xml_node_test tut_xml_node("xml_node");
+
+	// binary round trip keeps names, values, attributes and child order
+	template<> template<>
+	void xml_node_t::test<1>()
+	{
+		LLXMLNodePtr node = parse(
+			"<floater name=\"test\" width=\"200\" height=\"100\">"
+			"<text name=\"z_label\" follows=\"left|top\">Hello &amp; goodbye</text>"
+			"<button name=\"a_button\" label=\"OK\"/>"
+			"<panel name=\"m_panel\"><check_box name=\"check\" initial_value=\"true\"/></panel>"
+			"</floater>");
+
+		std::stringstream binary;
+		node->writeBinary(binary);
+
+		LLXMLNodePtr copy;
+		ensure("binary parsed", LLXMLNode::parseBinary(binary, copy));
+		ensure_equals("same tree", toXML(copy), toXML(node));
+
+		LLXMLNodePtr first = copy->getFirstChild();
+		ensure("has children", first.notNull());
+		ensure("document order kept", first->hasName("text"));
+		ensure("second child", first->getNextSibling()->hasName("button"));
+		ensure_equals("text value", first->getTextContents(), std::string("Hello & goodbye"));
+	}
+
+	// truncated or foreign data is rejected
+	template<> template<>
+	void xml_node_t::test<2>()
+	{
+		LLXMLNodePtr node = parse("<panel name=\"p\"><button name=\"b\"/></panel>");
+
+		std::stringstream binary;
+		node->writeBinary(binary);
+		std::string data = binary.str();
+
+		std::istringstream truncated(data.substr(0, data.size() - 3));
+		LLXMLNodePtr copy;
+		ensure("truncated data rejected", !LLXMLNode::parseBinary(truncated, copy));
+
+		std::istringstream garbage("<panel name=\"p\"/>");
+		ensure("xml text rejected", !LLXMLNode::parseBinary(garbage, copy));
+	}
+}
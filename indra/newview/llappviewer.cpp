@@ -150,6 +150,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "llviewerkeyboard.h"
+#include "lljobscheduler.h"
 #include "lllfsthread.h"
 #include "llworkerthread.h"
 #include "lltexturecache.h"
@@ -577,9 +578,13 @@ static void settings_to_globals()
 	LLVOVolume::sLODFactor				= llclamp(gSavedSettings.getF32("RenderVolumeLODFactor"), 0.01f, MAX_LOD_FACTOR);
 	LLVOVolume::sDistanceFactor			= 1.f-LLVOVolume::sLODFactor * 0.1f;
 	LLVolumeImplFlexible::sUpdateFactor = gSavedSettings.getF32("RenderFlexTimeFactor");
+	LLVolumeImplFlexible::sBatchSimulation = gSavedSettings.getBOOL("RenderFlexBatchSimulation");
 	LLVOTree::sTreeFactor				= gSavedSettings.getF32("RenderTreeLODFactor");
 	LLVOAvatar::sLODFactor				= llclamp(gSavedSettings.getF32("RenderAvatarLODFactor"), 0.f, MAX_AVATAR_LOD_FACTOR);
 	LLVOAvatar::sPhysicsLODFactor		= llclamp(gSavedSettings.getF32("RenderAvatarPhysicsLODFactor"), 0.f, MAX_AVATAR_LOD_FACTOR);
+	LLVOAvatar::sUseFlatSkeleton		= gSavedSettings.getBOOL("AvatarFlatSkeleton");
+	LLPolyMesh::sBatchMorphs			= gSavedSettings.getBOOL("AvatarBatchedMorphs");
+	LLVOVolume::sCacheRenderCost		= gSavedSettings.getBOOL("AvatarIncrementalComplexity");
 	LLVOAvatar::updateImpostorRendering(gSavedSettings.getU32("RenderAvatarMaxNonImpostors"));
 	LLVOAvatar::sVisibleInFirstPerson	= gSavedSettings.getBOOL("FirstPersonAvatarVisible");
 	// clamp auto-open time to some minimum usable value
@@ -1552,6 +1557,7 @@ bool LLAppViewer::doFrame()
 				F32 max_time = llmin(gFrameIntervalSeconds.value() *10.f, 1.f);
 
 				work_pending += updateTextureThreads(max_time);
+				work_pending += LLJobScheduler::updateClass(max_time);
 
 				{
 					LL_RECORD_BLOCK_TIME(FTM_VFS);
@@ -2075,6 +2081,7 @@ bool LLAppViewer::cleanup()
 	// This should eventually be done in LLAppViewer
 	SUBSYSTEM_CLEANUP(LLVFSThread);
 	SUBSYSTEM_CLEANUP(LLLFSThread);
+	SUBSYSTEM_CLEANUP(LLJobScheduler);
 
 #ifndef LL_RELEASE_FOR_DOWNLOAD
 	LL_INFOS() << "Auditing VFS" << LL_ENDL;
@@ -2185,6 +2192,7 @@ bool LLAppViewer::initThreads()
 
 	LLVFSThread::initClass(enable_threads && false);
 	LLLFSThread::initClass(enable_threads && false);
+	LLJobScheduler::initClass(gSavedSettings.getU32("JobSchedulerThreads"));
 
 	// Image decoding
 	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
@@ -4227,6 +4235,11 @@ bool LLAppViewer::initCache()
 		purgeCache();
 	}
 
+	if (gSavedSettings.getBOOL("XUIBinaryCache") && !read_only)
+	{
+		LLUICtrlFactory::setXUICacheDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui"));
+	}
+
 	LLSplashScreen::update(LLTrans::getString("StartupInitializingTextureCache"));
 
 	// Init the texture cache
@@ -0,0 +1,176 @@
+/**
+ * @file llcomplexitytally.cpp
+ * @brief Running totals of the render complexity of an avatar's attachments
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llcomplexitytally.h"
+
+LLComplexityTally::Entry::Entry()
+:	mCost(0.f),
+	mTriangles(0),
+	mEstTriangles(0.f),
+	mSurfaceArea(0.f)
+{
+}
+
+LLComplexityTally::LLComplexityTally()
+:	mPass(0),
+	mMinCost(0.f),
+	mMaxCost(0.f),
+	mCost(0),
+	mTriangles(0),
+	mEstTriangles(0.f),
+	mSurfaceArea(0.f)
+{
+}
+
+U32 LLComplexityTally::clampCost(F32 cost) const
+{
+	return (U32)llclamp(cost, mMinCost, mMaxCost);
+}
+
+void LLComplexityTally::beginUpdate(F32 min_cost, F32 max_cost)
+{
+	++mPass;
+
+	if (min_cost != mMinCost || max_cost != mMaxCost)
+	{
+		mMinCost = min_cost;
+		mMaxCost = max_cost;
+
+		mCost = 0;
+		for (slot_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+		{
+			Slot& slot = iter->second;
+			slot.mClampedCost = clampCost(slot.mEntry.mCost);
+			mCost += slot.mClampedCost;
+		}
+	}
+}
+
+bool LLComplexityTally::needsUpdate(const LLUUID& id)
+{
+	slot_map_t::iterator iter = mEntries.find(id);
+	if (iter == mEntries.end())
+	{
+		Slot& slot = mEntries[id];
+		slot.mClampedCost = 0;
+		slot.mPass = mPass;
+		slot.mChanged = true;
+		return true;
+	}
+
+	iter->second.mPass = mPass;
+	return iter->second.mChanged;
+}
+
+void LLComplexityTally::update(const LLUUID& id, const Entry& entry)
+{
+	slot_map_t::iterator iter = mEntries.find(id);
+	llassert(iter != mEntries.end());
+	if (iter == mEntries.end())
+	{
+		return;
+	}
+
+	Slot& slot = iter->second;
+	mCost -= slot.mClampedCost;
+	mTriangles -= slot.mEntry.mTriangles;
+
+	slot.mEntry = entry;
+	slot.mClampedCost = clampCost(entry.mCost);
+	slot.mChanged = false;
+
+	mCost += slot.mClampedCost;
+	mTriangles += entry.mTriangles;
+}
+
+void LLComplexityTally::updateCost(const LLUUID& id, F32 cost)
+{
+	slot_map_t::iterator iter = mEntries.find(id);
+	llassert(iter != mEntries.end());
+	if (iter == mEntries.end())
+	{
+		return;
+	}
+
+	Slot& slot = iter->second;
+	mCost -= slot.mClampedCost;
+	slot.mEntry.mCost = cost;
+	slot.mClampedCost = clampCost(cost);
+	mCost += slot.mClampedCost;
+}
+
+void LLComplexityTally::endUpdate()
+{
+	// the float totals are summed again rather than adjusted, so that
+	// rounding errors do not build up over a session
+	mEstTriangles = 0.f;
+	mSurfaceArea = 0.f;
+
+	slot_map_t::iterator iter = mEntries.begin();
+	while (iter != mEntries.end())
+	{
+		Slot& slot = iter->second;
+		if (slot.mPass != mPass)
+		{
+			mCost -= slot.mClampedCost;
+			mTriangles -= slot.mEntry.mTriangles;
+			mEntries.erase(iter++);
+			continue;
+		}
+
+		mEstTriangles += slot.mEntry.mEstTriangles;
+		mSurfaceArea += slot.mEntry.mSurfaceArea;
+		++iter;
+	}
+}
+
+void LLComplexityTally::markChanged(const LLUUID& id)
+{
+	slot_map_t::iterator iter = mEntries.find(id);
+	if (iter != mEntries.end())
+	{
+		iter->second.mChanged = true;
+	}
+}
+
+void LLComplexityTally::markAllChanged()
+{
+	for (slot_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		iter->second.mChanged = true;
+	}
+}
+
+void LLComplexityTally::clear()
+{
+	mEntries.clear();
+	mCost = 0;
+	mTriangles = 0;
+	mEstTriangles = 0.f;
+	mSurfaceArea = 0.f;
+}
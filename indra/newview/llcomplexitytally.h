@@ -0,0 +1,105 @@
+/**
+ * @file llcomplexitytally.h
+ * @brief Running totals of the render complexity of an avatar's attachments
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLCOMPLEXITYTALLY_H
+#define LL_LLCOMPLEXITYTALLY_H
+
+#include "lluuid.h"
+
+#include <map>
+
+// Costs of the top level objects of an avatar, its attachments and the root
+// of an animated object, keyed by object id.
+//
+// Each complexity update is a pass over the objects: beginUpdate(), then
+// needsUpdate() for every object, update() for those that need it and
+// updateCost() for the others, and endUpdate(), which forgets the objects that
+// were not seen. Only objects that are new or were marked changed since their
+// last update are recomputed in full. The others are only costed again: their
+// prims cache their costs, but textures are priced by the size they have
+// loaded at and particle sources come and go without the object changing.
+// The clamped cost total is adjusted by the difference.
+class LLComplexityTally
+{
+public:
+	struct Entry
+	{
+		Entry();
+
+		F32		mCost;			// before clamping
+		U32		mTriangles;
+		F32		mEstTriangles;
+		F32		mSurfaceArea;
+	};
+
+	LLComplexityTally();
+
+	// Each cost counts within [min_cost, max_cost]
+	void beginUpdate(F32 min_cost, F32 max_cost);
+
+	// Returns true if the object id must be passed to update(), and records
+	// that it is still there
+	bool needsUpdate(const LLUUID& id);
+	void update(const LLUUID& id, const Entry& entry);
+	// For an object that did not need update(), keeping its other totals
+	void updateCost(const LLUUID& id, F32 cost);
+
+	void endUpdate();
+
+	// The object is recomputed in the next pass
+	void markChanged(const LLUUID& id);
+	void markAllChanged();
+	void clear();
+
+	U32 getCost() const { return mCost; }
+	U32 getTriangles() const { return mTriangles; }
+	F32 getEstTriangles() const { return mEstTriangles; }
+	F32 getSurfaceArea() const { return mSurfaceArea; }
+	S32 getCount() const { return (S32)mEntries.size(); }
+
+private:
+	U32 clampCost(F32 cost) const;
+
+	struct Slot
+	{
+		Entry	mEntry;
+		U32		mClampedCost;
+		U32		mPass;			// last pass the object was seen in
+		bool	mChanged;
+	};
+	typedef std::map<LLUUID, Slot> slot_map_t;
+
+	slot_map_t	mEntries;
+	U32			mPass;
+	F32			mMinCost;
+	F32			mMaxCost;
+	U32			mCost;
+	U32			mTriangles;
+	F32			mEstTriangles;
+	F32			mSurfaceArea;
+};
+
+#endif // LL_LLCOMPLEXITYTALLY_H
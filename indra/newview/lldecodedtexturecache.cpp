@@ -0,0 +1,506 @@
+/**
+ * @file lldecodedtexturecache.cpp
+ * @brief Second texture cache tier holding decoded images
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lldecodedtexturecache.h"
+
+#include "lldir.h"
+#include "llfile.h"
+#include "llimage.h"
+
+// Image file: header followed by width * height * components bytes
+// Index file: index header followed by an index record per entry
+const S32 DECODED_CACHE_VERSION = 1;
+const S32 DECODED_HEADER_SIZE = sizeof(S32) * 5; // version, w, h, c, discard
+const S32 DECODED_INDEX_HEADER_SIZE = sizeof(S32) * 3; // version, clock, count
+const S32 DECODED_INDEX_RECORD_SIZE = UUID_BYTES + sizeof(S32) * 3; // id, discard, size, last use
+// No single image may take more than this fraction of the budget
+const S32 DECODED_MAX_IMAGE_FRACTION = 8;
+
+const char* decoded_index_filename = "decoded.entries";
+
+LLDecodedTextureCache::LLDecodedTextureCache()
+	: mMutex(),
+	  mMaxSize(0),
+	  mSize(0),
+	  mClock(0),
+	  mHits(0),
+	  mMisses(0)
+{
+}
+
+LLDecodedTextureCache::~LLDecodedTextureCache()
+{
+	close();
+}
+
+S32 LLDecodedTextureCache::open(const std::string& dirname, S64 max_size)
+{
+	close();
+
+	if (max_size <= 0)
+	{
+		return 0;
+	}
+
+	// Nothing can use the tier before it is open, the files are read first
+	LLFile::mkdir(dirname);
+	std::string index_filename = dirname + gDirUtilp->getDirDelimiter() + decoded_index_filename;
+	entry_map_t entries;
+	lru_set_t lru;
+	S64 size = 0;
+	U32 clock = 0;
+	if (!readIndex(index_filename, entries, lru, size, clock))
+	{
+		// Unknown contents, the previous session did not close cleanly
+		gDirUtilp->deleteFilesInDir(dirname, "*.raw");
+		entries.clear();
+		lru.clear();
+		size = 0;
+	}
+	// Written again by close(), a crash in between leaves no stale index
+	LLFile::remove(index_filename, ENOENT);
+
+	S32 count;
+	file_list_t evicted;
+	{
+		LLMutexLock lock(&mMutex);
+		mDirName = dirname;
+		mMaxSize = max_size;
+		mEntries.swap(entries);
+		mLRU.swap(lru);
+		mSize = size;
+		mClock = clock;
+
+		evict(0, evicted);
+		count = (S32)mEntries.size();
+
+		LL_INFOS("TextureCache") << "Decoded texture cache: " << count << " images, "
+								 << mSize / (1024 * 1024) << " of " << mMaxSize / (1024 * 1024) << " MB" << LL_ENDL;
+	}
+	removeFiles(evicted);
+	return count;
+}
+
+void LLDecodedTextureCache::close()
+{
+	std::string index_filename;
+	entry_map_t entries;
+	U32 clock = 0;
+	{
+		LLMutexLock lock(&mMutex);
+		if (mMaxSize > 0)
+		{
+			index_filename = getIndexFileName();
+			entries.swap(mEntries);
+			clock = mClock;
+			LL_INFOS("TextureCache") << "Decoded texture cache closed. Hits: " << mHits << " Misses: " << mMisses << LL_ENDL;
+		}
+		mEntries.clear();
+		mLRU.clear();
+		mSize = 0;
+		mMaxSize = 0;
+	}
+
+	if (!index_filename.empty())
+	{
+		writeIndex(index_filename, entries, clock);
+	}
+}
+
+void LLDecodedTextureCache::purge()
+{
+	file_list_t removed;
+	{
+		LLMutexLock lock(&mMutex);
+		entry_map_t::iterator iter = mEntries.begin();
+		while (iter != mEntries.end())
+		{
+			removeEntry(iter, removed);
+		}
+	}
+	removeFiles(removed);
+}
+
+LLPointer<LLImageRaw> LLDecodedTextureCache::read(const LLUUID& id, S32 max_discard, S32& discard)
+{
+	std::string filename;
+	Entry entry;
+	{
+		LLMutexLock lock(&mMutex);
+		entry_map_t::iterator iter = mEntries.find(id);
+		if (iter == mEntries.end() || !iter->second.isReadable() || iter->second.mDiscard > max_discard)
+		{
+			++mMisses;
+			return NULL;
+		}
+		// Keeps the file until the read is done
+		++iter->second.mReaders;
+		entry = iter->second;
+		filename = getFileName(id);
+	}
+
+	LLPointer<LLImageRaw> raw;
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if (fp)
+	{
+		S32 head[DECODED_HEADER_SIZE / sizeof(S32)];
+		if (fread(head, 1, DECODED_HEADER_SIZE, fp) == DECODED_HEADER_SIZE
+			&& head[0] == DECODED_CACHE_VERSION
+			&& head[1] > 0 && head[1] <= MAX_IMAGE_SIZE
+			&& head[2] > 0 && head[2] <= MAX_IMAGE_SIZE
+			&& head[3] > 0 && head[3] <= 4
+			&& head[4] == entry.mDiscard
+			&& DECODED_HEADER_SIZE + head[1] * head[2] * head[3] == (S32)entry.mSize)
+		{
+			raw = new LLImageRaw(head[1], head[2], head[3]);
+			S32 data_size = raw->getDataSize();
+			if (raw->isBufferInvalid() || fread(raw->getData(), 1, data_size, fp) != (size_t)data_size)
+			{
+				raw = NULL;
+			}
+		}
+		LLFile::close(fp);
+	}
+
+	file_list_t removed;
+	{
+		LLMutexLock lock(&mMutex);
+		entry_map_t::iterator iter = mEntries.find(id);
+		if (iter != mEntries.end())
+		{
+			--iter->second.mReaders;
+			if (raw.isNull() || iter->second.mRemoved)
+			{
+				if (raw.isNull() && !iter->second.mRemoved)
+				{
+					LL_WARNS("TextureCache") << "Decoded cache file for " << id << " is missing or corrupt" << LL_ENDL;
+				}
+				removeEntry(iter, removed);
+			}
+			else
+			{
+				touch(iter);
+			}
+		}
+
+		if (raw.isNull())
+		{
+			++mMisses;
+		}
+		else
+		{
+			++mHits;
+		}
+	}
+	removeFiles(removed);
+
+	if (raw.notNull())
+	{
+		discard = entry.mDiscard;
+	}
+	return raw;
+}
+
+bool LLDecodedTextureCache::write(const LLUUID& id, const LLImageRaw* raw, S32 discard)
+{
+	if (!raw || raw->isBufferInvalid() || discard < 0)
+	{
+		return false;
+	}
+	S64 size = DECODED_HEADER_SIZE + (S64)raw->getDataSize();
+
+	std::string filename;
+	file_list_t removed;
+	{
+		LLMutexLock lock(&mMutex);
+		if (mMaxSize <= 0 || size > mMaxSize / DECODED_MAX_IMAGE_FRACTION)
+		{
+			return false;
+		}
+
+		entry_map_t::iterator iter = mEntries.find(id);
+		if (iter != mEntries.end())
+		{
+			if (iter->second.isBusy() || !iter->second.isReadable())
+			{
+				// The file is in use, a later decode can replace it
+				return false;
+			}
+			if (iter->second.mDiscard <= discard)
+			{
+				// Already as sharp, just count the use
+				touch(iter);
+				return false;
+			}
+			// The file is written over
+			mLRU.erase(std::make_pair(iter->second.mLastUse, id));
+			mSize -= iter->second.mSize;
+		}
+		evict(size, removed);
+
+		// Takes its share of the budget now, readable once written
+		Entry& entry = mEntries[id];
+		entry.mDiscard = discard;
+		entry.mSize = (U32)size;
+		entry.mLastUse = 0;
+		entry.mReaders = 0;
+		entry.mWriting = true;
+		entry.mRemoved = false;
+		entry.mDeleting = false;
+		mSize += size;
+		filename = getFileName(id);
+	}
+	removeFiles(removed);
+	removed.clear();
+
+	bool success = false;
+	LLFILE* fp = LLFile::fopen(filename, "wb");
+	if (fp)
+	{
+		S32 head[DECODED_HEADER_SIZE / sizeof(S32)] =
+			{ DECODED_CACHE_VERSION, raw->getWidth(), raw->getHeight(), raw->getComponents(), discard };
+		success = fwrite(head, 1, DECODED_HEADER_SIZE, fp) == DECODED_HEADER_SIZE
+				  && fwrite(raw->getData(), 1, raw->getDataSize(), fp) == (size_t)raw->getDataSize();
+		LLFile::close(fp);
+	}
+	if (!success)
+	{
+		LL_WARNS("TextureCache") << "Failed to write decoded cache file " << filename << LL_ENDL;
+	}
+
+	{
+		LLMutexLock lock(&mMutex);
+		entry_map_t::iterator iter = mEntries.find(id);
+		if (iter == mEntries.end() || !iter->second.mWriting)
+		{
+			// Closed while writing
+			removed.push_back(std::make_pair(id, filename));
+			success = false;
+		}
+		else
+		{
+			iter->second.mWriting = false;
+			if (!success || iter->second.mRemoved)
+			{
+				removeEntry(iter, removed);
+				success = false;
+			}
+			else
+			{
+				iter->second.mLastUse = ++mClock;
+				mLRU.insert(std::make_pair(iter->second.mLastUse, id));
+			}
+		}
+	}
+	removeFiles(removed);
+	return success;
+}
+
+void LLDecodedTextureCache::remove(const LLUUID& id)
+{
+	file_list_t removed;
+	{
+		LLMutexLock lock(&mMutex);
+		entry_map_t::iterator iter = mEntries.find(id);
+		if (iter != mEntries.end())
+		{
+			removeEntry(iter, removed);
+		}
+	}
+	removeFiles(removed);
+}
+
+S64 LLDecodedTextureCache::getSize() const
+{
+	LLMutexLock lock(&mMutex);
+	return mSize;
+}
+
+S32 LLDecodedTextureCache::getCount() const
+{
+	LLMutexLock lock(&mMutex);
+	return (S32)mLRU.size();
+}
+
+//----------------------------------------------------------------------------
+
+// static
+bool LLDecodedTextureCache::readIndex(const std::string& filename, entry_map_t& entries, lru_set_t& lru, S64& size, U32& clock)
+{
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+
+	bool success = false;
+	S32 head[DECODED_INDEX_HEADER_SIZE / sizeof(S32)];
+	if (fread(head, 1, DECODED_INDEX_HEADER_SIZE, fp) == DECODED_INDEX_HEADER_SIZE
+		&& head[0] == DECODED_CACHE_VERSION && head[2] >= 0)
+	{
+		clock = (U32)head[1];
+		success = true;
+		U8 record[DECODED_INDEX_RECORD_SIZE];
+		for (S32 i = 0; i < head[2]; ++i)
+		{
+			if (fread(record, 1, DECODED_INDEX_RECORD_SIZE, fp) != DECODED_INDEX_RECORD_SIZE)
+			{
+				success = false;
+				break;
+			}
+			LLUUID id;
+			Entry entry;
+			memcpy(id.mData, record, UUID_BYTES);
+			memcpy(&entry.mDiscard, record + UUID_BYTES, sizeof(S32));
+			memcpy(&entry.mSize, record + UUID_BYTES + sizeof(S32), sizeof(U32));
+			memcpy(&entry.mLastUse, record + UUID_BYTES + sizeof(S32) * 2, sizeof(U32));
+			entry.mReaders = 0;
+			entry.mWriting = false;
+			entry.mRemoved = false;
+			entry.mDeleting = false;
+			entries[id] = entry;
+			lru.insert(std::make_pair(entry.mLastUse, id));
+			size += entry.mSize;
+		}
+	}
+	LLFile::close(fp);
+	return success;
+}
+
+// static
+void LLDecodedTextureCache::writeIndex(const std::string& filename, const entry_map_t& entries, U32 clock)
+{
+	LLFILE* fp = LLFile::fopen(filename, "wb");
+	if (!fp)
+	{
+		LL_WARNS("TextureCache") << "Unable to write " << filename << LL_ENDL;
+		return;
+	}
+
+	S32 count = 0;
+	for (entry_map_t::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+	{
+		count += iter->second.isReadable() ? 1 : 0;
+	}
+
+	S32 head[DECODED_INDEX_HEADER_SIZE / sizeof(S32)] = { DECODED_CACHE_VERSION, (S32)clock, count };
+	bool success = fwrite(head, 1, DECODED_INDEX_HEADER_SIZE, fp) == DECODED_INDEX_HEADER_SIZE;
+	U8 record[DECODED_INDEX_RECORD_SIZE];
+	for (entry_map_t::const_iterator iter = entries.begin(); success && iter != entries.end(); ++iter)
+	{
+		if (!iter->second.isReadable())
+		{
+			continue;
+		}
+		memcpy(record, iter->first.mData, UUID_BYTES);
+		memcpy(record + UUID_BYTES, &iter->second.mDiscard, sizeof(S32));
+		memcpy(record + UUID_BYTES + sizeof(S32), &iter->second.mSize, sizeof(U32));
+		memcpy(record + UUID_BYTES + sizeof(S32) * 2, &iter->second.mLastUse, sizeof(U32));
+		success = fwrite(record, 1, DECODED_INDEX_RECORD_SIZE, fp) == DECODED_INDEX_RECORD_SIZE;
+	}
+	LLFile::close(fp);
+	if (!success)
+	{
+		LL_WARNS("TextureCache") << "Failed to write " << filename << LL_ENDL;
+		LLFile::remove(filename, ENOENT);
+	}
+}
+
+void LLDecodedTextureCache::removeFiles(const file_list_t& files)
+{
+	if (files.empty())
+	{
+		return;
+	}
+
+	for (file_list_t::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+	{
+		LLFile::remove(iter->second, ENOENT);
+	}
+
+	LLMutexLock lock(&mMutex);
+	for (file_list_t::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+	{
+		entry_map_t::iterator entry = mEntries.find(iter->first);
+		if (entry != mEntries.end() && entry->second.mDeleting)
+		{
+			mEntries.erase(entry);
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+// mMutex must be locked for the following functions!
+
+std::string LLDecodedTextureCache::getFileName(const LLUUID& id) const
+{
+	return mDirName + gDirUtilp->getDirDelimiter() + id.asString() + ".raw";
+}
+
+std::string LLDecodedTextureCache::getIndexFileName() const
+{
+	return mDirName + gDirUtilp->getDirDelimiter() + decoded_index_filename;
+}
+
+void LLDecodedTextureCache::touch(entry_map_t::iterator& iter)
+{
+	mLRU.erase(std::make_pair(iter->second.mLastUse, iter->first));
+	iter->second.mLastUse = ++mClock;
+	mLRU.insert(std::make_pair(iter->second.mLastUse, iter->first));
+}
+
+void LLDecodedTextureCache::removeEntry(entry_map_t::iterator& iter, file_list_t& files)
+{
+	if (!iter->second.mRemoved)
+	{
+		mLRU.erase(std::make_pair(iter->second.mLastUse, iter->first));
+		mSize -= iter->second.mSize;
+		iter->second.mRemoved = true;
+	}
+
+	if (!iter->second.isBusy() && !iter->second.mDeleting)
+	{
+		// Otherwise the last reader or the writer removes it
+		iter->second.mDeleting = true;
+		files.push_back(std::make_pair(iter->first, getFileName(iter->first)));
+	}
+	++iter;
+}
+
+void LLDecodedTextureCache::evict(S64 needed, file_list_t& files)
+{
+	lru_set_t::iterator lru = mLRU.begin();
+	while (lru != mLRU.end() && mSize + needed > mMaxSize)
+	{
+		entry_map_t::iterator iter = mEntries.find(lru->second);
+		llassert_always(iter != mEntries.end());
+		// removeEntry() erases the LRU record
+		++lru;
+		removeEntry(iter, files);
+	}
+}
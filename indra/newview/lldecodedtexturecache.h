@@ -0,0 +1,125 @@
+/**
+ * @file lldecodedtexturecache.h
+ * @brief Second texture cache tier holding decoded images
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDECODEDTEXTURECACHE_H
+#define LL_LLDECODEDTEXTURECACHE_H
+
+#include "llmutex.h"
+#include "llpointer.h"
+#include "lluuid.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+class LLImageRaw;
+
+// Optional tier next to the J2C texture cache. It keeps the raw image the
+// fetcher handed over after decoding, so that a texture seen again, after a
+// relog for instance, is ready for GL upload without another J2C decode.
+//
+// Each image is stored in its own file, "<uuid>.raw", and the index of
+// entries with their last use lives in "decoded.entries". The index is only
+// written on a clean close(); the tier starts empty after a crash.
+// Least recently used images are evicted to stay within the size budget.
+//
+// All functions are thread safe. Files are read and written outside the
+// lock; an entry removed while in use keeps its file until the last user is
+// done with it.
+class LLDecodedTextureCache
+{
+public:
+	LLDecodedTextureCache();
+	~LLDecodedTextureCache();
+
+	// Opens the tier in dirname with a budget of max_size bytes, a budget
+	// of 0 disables it. Returns the number of images found.
+	S32 open(const std::string& dirname, S64 max_size);
+	void close();
+	bool isOpen() const { return mMaxSize > 0; }
+
+	// Removes every stored image, the tier stays open.
+	void purge();
+
+	// Returns the stored image for id if it was decoded at max_discard or
+	// sharper, NULL otherwise. discard is set to the discard level of the
+	// returned image.
+	LLPointer<LLImageRaw> read(const LLUUID& id, S32 max_discard, S32& discard);
+
+	// Stores raw, decoded at discard, unless an image at least as sharp is
+	// already there. Returns true if the image was written.
+	bool write(const LLUUID& id, const LLImageRaw* raw, S32 discard);
+
+	void remove(const LLUUID& id);
+
+	S64 getSize() const;
+	S32 getCount() const;
+	U32 getHits() const { return mHits; }
+	U32 getMisses() const { return mMisses; }
+
+private:
+	struct Entry
+	{
+		S32 mDiscard;
+		U32 mSize;		// file size in bytes
+		U32 mLastUse;	// value of mClock when last read or written
+		S32 mReaders;	// reads of the file in progress
+		bool mWriting;	// file being written, not readable yet
+		bool mRemoved;	// removed, the file goes with the last user
+		bool mDeleting;	// file being deleted, the entry goes once it is
+
+		bool isBusy() const { return mReaders > 0 || mWriting; }
+		bool isReadable() const { return !mWriting && !mRemoved; }
+	};
+	typedef std::map<LLUUID, Entry> entry_map_t;
+	typedef std::set<std::pair<U32, LLUUID> > lru_set_t;
+	typedef std::vector<std::pair<LLUUID, std::string> > file_list_t;
+
+	std::string getFileName(const LLUUID& id) const;
+	std::string getIndexFileName() const;
+	// The index is only read and written by open() and close(), outside the lock
+	static bool readIndex(const std::string& filename, entry_map_t& entries, lru_set_t& lru, S64& size, U32& clock);
+	static void writeIndex(const std::string& filename, const entry_map_t& entries, U32 clock);
+	// Deletes the files outside the lock, then drops their entries
+	void removeFiles(const file_list_t& files);
+	void touch(entry_map_t::iterator& iter);
+	// Advances iter. Adds the file to files unless the entry is still in use,
+	// the entry stays until removeFiles() so that no new file takes its name.
+	void removeEntry(entry_map_t::iterator& iter, file_list_t& files);
+	void evict(S64 needed, file_list_t& files);
+
+	mutable LLMutex mMutex;
+	std::string mDirName;
+	S64 mMaxSize;
+	S64 mSize;
+	U32 mClock;
+	entry_map_t mEntries;
+	lru_set_t mLRU;		// (last use, id) of every readable entry, oldest first
+	U32 mHits;
+	U32 mMisses;
+};
+
+#endif // LL_LLDECODEDTEXTURECACHE_H
@@ -529,6 +529,12 @@ void LLDrawable::makeActive()
 	if (!isState(ACTIVE)) // && mGeneration > 0)
 	{
 		setState(ACTIVE);
+
+		if (isState(LIGHT))
+		{
+			// out of the light grid before it moves
+			gPipeline.updateLightIndex(this);
+		}
 		
 		//parent must be made active first
 		if (!isRoot() && !mParent->isActive())
@@ -874,43 +880,13 @@ void LLDrawable::updateDistance(LLCamera& camera, bool force_update)
 		LLVOVolume* volume = getVOVolume();
 		if (volume)
 		{
-			if (getGroup())
-			{
-				pos.set(getPositionGroup().getF32ptr());
-			}
-			else
-			{
-				pos = getPositionAgent();
-			}
-			
-			if (isState(LLDrawable::HAS_ALPHA))
-			{
-				for (S32 i = 0; i < getNumFaces(); i++)
-				{
-					LLFace* facep = getFace(i);
-					if (facep && 
-						(force_update || facep->getPoolType() == LLDrawPool::POOL_ALPHA))
-					{
-						LLVector4a box;
-						box.setSub(facep->mExtents[1], facep->mExtents[0]);
-						box.mul(0.25f);
-						LLVector3 v = (facep->mCenterLocal-camera.getOrigin());
-						const LLVector3& at = camera.getAtAxis();
-						for (U32 j = 0; j < 3; j++)
-						{
-							v.mV[j] -= box[j] * at.mV[j];
-						}
-						facep->mDistance = v * camera.getAtAxis();
-					}
-				}
-			}	
-
-
             // MAINT-7926 Handle volumes in an animated object as a special case
             // SL-937: add dynamic box handling for rigged mesh on regular avatars.
             //if (volume->getAvatar() && volume->getAvatar()->isControlAvatar())
             if (volume->getAvatar())
             {
+				updateFaceDistances(camera, force_update);
+
                 const LLVector3* av_box = volume->getAvatar()->getLastAnimExtents();
                 LLVector3d cam_pos = gAgent.getPosGlobalFromAgent(LLViewerCamera::getInstance()->getOrigin());
                 LLVector3 cam_region_pos = LLVector3(cam_pos - volume->getRegion()->getOriginGlobal());
@@ -918,7 +894,6 @@ void LLDrawable::updateDistance(LLCamera& camera, bool force_update)
                 LLVector3 cam_to_box_offset = point_to_box_offset(cam_region_pos, av_box);
                 mDistanceWRTCamera = llmax(0.01f, ll_round(cam_to_box_offset.magVec(), 0.01f));
                 LL_DEBUGS("DynamicBox") << volume->getAvatar()->getFullname() 
-                                        << " pos (ignored) " << pos
                                         << " cam pos " << cam_pos
                                         << " cam region pos " << cam_region_pos
                                         << " box " << av_box[0] << "," << av_box[1] 
@@ -927,19 +902,63 @@ void LLDrawable::updateDistance(LLCamera& camera, bool force_update)
                 mVObjp->updateLOD();
                 return;
             }
-            
+
+			mDistanceWRTCamera = updateVolumeDistance(camera, force_update);
 		}
 		else
 		{
 			pos = LLVector3(getPositionGroup().getF32ptr());
+			pos -= camera.getOrigin();	
+			mDistanceWRTCamera = ll_round(pos.magVec(), 0.01f);
 		}
 
-		pos -= camera.getOrigin();	
-		mDistanceWRTCamera = ll_round(pos.magVec(), 0.01f);
 		mVObjp->updateLOD();
 	}
 }
 
+F32 LLDrawable::updateVolumeDistance(LLCamera& camera, bool force_update)
+{
+	updateFaceDistances(camera, force_update);
+
+	LLVector3 pos;
+	if (getGroup())
+	{
+		pos.set(getPositionGroup().getF32ptr());
+	}
+	else
+	{
+		pos = getPositionAgent();
+	}
+
+	pos -= camera.getOrigin();	
+	return ll_round(pos.magVec(), 0.01f);
+}
+
+void LLDrawable::updateFaceDistances(LLCamera& camera, bool force_update)
+{
+	if (isState(LLDrawable::HAS_ALPHA))
+	{
+		for (S32 i = 0; i < getNumFaces(); i++)
+		{
+			LLFace* facep = getFace(i);
+			if (facep && 
+				(force_update || facep->getPoolType() == LLDrawPool::POOL_ALPHA))
+			{
+				LLVector4a box;
+				box.setSub(facep->mExtents[1], facep->mExtents[0]);
+				box.mul(0.25f);
+				LLVector3 v = (facep->mCenterLocal-camera.getOrigin());
+				const LLVector3& at = camera.getAtAxis();
+				for (U32 j = 0; j < 3; j++)
+				{
+					v.mV[j] -= box[j] * at.mV[j];
+				}
+				facep->mDistance = v * camera.getAtAxis();
+			}
+		}
+	}	
+}
+
 void LLDrawable::updateTexture()
 {
 	if (isDead())
@@ -161,6 +161,11 @@ public:
 	void updateTexture();
 	void updateMaterial();
 	virtual void updateDistance(LLCamera& camera, bool force_update);
+	// What updateDistance() sets mDistanceWRTCamera to for a volume that is
+	// not on an avatar. Only touches this drawable and its faces, so it can
+	// run on a worker while the main thread waits.
+	F32 updateVolumeDistance(LLCamera& camera, bool force_update);
+	void updateFaceDistances(LLCamera& camera, bool force_update);
 	BOOL updateGeometry(BOOL priority);
 	void updateFaceSize(S32 idx);
 		
@@ -354,6 +354,11 @@ void LLFace::notifyAboutCreatingTexture(LLViewerTexture *texture)
 			gPipeline.markTextured(drawablep);
 			gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_VOLUME);
 		}
+		if (vobj)
+		{
+			// textures are priced by their full size, known from now on
+			vobj->updateVisualComplexityCost();
+		}
 	}
 }
 
@@ -0,0 +1,651 @@
+/**
+ * @file llflexiblechainpool.cpp
+ * @brief Section chains of flexible objects, stepped four at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llflexiblechainpool.h"
+
+#include "lljobscheduler.h"
+#include "llmath.h"
+
+// Packs stepped by each job. A pack is four chains.
+const U32 MIN_PACKS_PER_JOB = 16;
+
+// The handle of a chain is its simulate res over its index in the bucket
+const U32 HANDLE_RES_SHIFT = 24;
+const U32 HANDLE_INDEX_MASK = (1 << HANDLE_RES_SHIFT) - 1;
+
+namespace
+{
+	// Vectors of a pack, the values of the chain first
+	enum
+	{
+		P_TENSION = 0,
+		P_MOMENTUM,
+		P_WIND_FACTOR,
+		P_GRAVITY,			// gravity * force factor
+		P_FORCE,			// user force * force factor, 3 vectors
+		P_SECTION_LENGTH = P_FORCE + 3,
+		P_COS_HALF_MAX,		// of max angle / 2
+		P_SIN_HALF_MAX,
+		P_END_ROTATION,		// 4 vectors
+		PACK_PARAM_COUNT = P_END_ROTATION + 4
+	};
+
+	// then the values of each section, the anchor first
+	enum
+	{
+		S_POSITION = 0,
+		S_VELOCITY = 3,
+		S_DIRECTION = 6,
+		S_ROTATION = 9,
+		S_WIND = 13,
+		SECTION_VECTOR_COUNT = 16
+	};
+
+	void set_lane(LLVector4a* dst, U32 lane, F32 value)
+	{
+		dst->getF32ptr()[lane] = value;
+	}
+
+	void set_lane(LLVector4a* dst, U32 lane, const LLVector3& value)
+	{
+		for (U32 i = 0; i < 3; ++i)
+		{
+			dst[i].getF32ptr()[lane] = value.mV[i];
+		}
+	}
+
+	void set_lane(LLVector4a* dst, U32 lane, const LLQuaternion& value)
+	{
+		for (U32 i = 0; i < 4; ++i)
+		{
+			dst[i].getF32ptr()[lane] = value.mQ[i];
+		}
+	}
+
+	LLVector3 get_lane3(const LLVector4a* src, U32 lane)
+	{
+		return LLVector3(src[0][lane], src[1][lane], src[2][lane]);
+	}
+
+	LLQuaternion get_lane4(const LLVector4a* src, U32 lane)
+	{
+		return LLQuaternion(src[0][lane], src[1][lane], src[2][lane], src[3][lane]);
+	}
+
+	inline LLVector4a lane_add(const LLVector4a& a, const LLVector4a& b)
+	{
+		LLVector4a r;
+		r.setAdd(a, b);
+		return r;
+	}
+
+	inline LLVector4a lane_sub(const LLVector4a& a, const LLVector4a& b)
+	{
+		LLVector4a r;
+		r.setSub(a, b);
+		return r;
+	}
+
+	inline LLVector4a lane_mul(const LLVector4a& a, const LLVector4a& b)
+	{
+		LLVector4a r;
+		r.setMul(a, b);
+		return r;
+	}
+
+	inline LLVector4a lane_div(const LLVector4a& a, const LLVector4a& b)
+	{
+		LLVector4a r;
+		r.setDiv(a, b);
+		return r;
+	}
+
+	inline LLVector4a lane_sqrt(const LLVector4a& a)
+	{
+		LLVector4a r;
+		r = _mm_sqrt_ps(a);
+		return r;
+	}
+
+	inline LLVector4a lane_select(const LLVector4Logical& mask, const LLVector4a& a, const LLVector4a& b)
+	{
+		LLVector4a r;
+		r.setSelectWithMask(mask, a, b);
+		return r;
+	}
+
+	inline LLVector4Logical lane_and(const LLVector4Logical& a, const LLVector4Logical& b)
+	{
+		return LLVector4Logical(_mm_and_ps(a, b));
+	}
+
+	// A vector for each of four chains, a component to an LLVector4a
+	struct LaneVector
+	{
+		LLVector4a x, y, z;
+
+		void load(const LLVector4a* src) { x = src[0]; y = src[1]; z = src[2]; }
+		void store(LLVector4a* dst) const { dst[0] = x; dst[1] = y; dst[2] = z; }
+
+		void add(const LaneVector& v) { x.add(v.x); y.add(v.y); z.add(v.z); }
+		void mulAdd(const LaneVector& v, const LLVector4a& s)
+		{
+			x.add(lane_mul(v.x, s));
+			y.add(lane_mul(v.y, s));
+			z.add(lane_mul(v.z, s));
+		}
+		void setSub(const LaneVector& a, const LaneVector& b)
+		{
+			x.setSub(a.x, b.x);
+			y.setSub(a.y, b.y);
+			z.setSub(a.z, b.z);
+		}
+		void setMul(const LaneVector& v, const LLVector4a& s)
+		{
+			x.setMul(v.x, s);
+			y.setMul(v.y, s);
+			z.setMul(v.z, s);
+		}
+		void setSelect(const LLVector4Logical& mask, const LaneVector& a, const LaneVector& b)
+		{
+			x.setSelectWithMask(mask, a.x, b.x);
+			y.setSelectWithMask(mask, a.y, b.y);
+			z.setSelectWithMask(mask, a.z, b.z);
+		}
+		LLVector4a dot(const LaneVector& v) const
+		{
+			return lane_add(lane_add(lane_mul(x, v.x), lane_mul(y, v.y)), lane_mul(z, v.z));
+		}
+		void setCross(const LaneVector& a, const LaneVector& b)
+		{
+			x = lane_sub(lane_mul(a.y, b.z), lane_mul(a.z, b.y));
+			y = lane_sub(lane_mul(a.z, b.x), lane_mul(a.x, b.z));
+			z = lane_sub(lane_mul(a.x, b.y), lane_mul(a.y, b.x));
+		}
+	};
+
+	// A quaternion for each of four chains
+	struct LaneQuat
+	{
+		LLVector4a x, y, z, w;
+
+		void load(const LLVector4a* src) { x = src[0]; y = src[1]; z = src[2]; w = src[3]; }
+		void store(LLVector4a* dst) const { dst[0] = x; dst[1] = y; dst[2] = z; dst[3] = w; }
+
+		void setIdentity()
+		{
+			x.clear();
+			y.clear();
+			z.clear();
+			w.splat(1.f);
+		}
+		void setSelect(const LLVector4Logical& mask, const LaneQuat& a, const LaneQuat& b)
+		{
+			x.setSelectWithMask(mask, a.x, b.x);
+			y.setSelectWithMask(mask, a.y, b.y);
+			z.setSelectWithMask(mask, a.z, b.z);
+			w.setSelectWithMask(mask, a.w, b.w);
+		}
+		// a * b, as LLQuaternion multiplies
+		void setMul(const LaneQuat& a, const LaneQuat& b)
+		{
+			x = lane_sub(lane_add(lane_add(lane_mul(b.w, a.x), lane_mul(b.x, a.w)), lane_mul(b.y, a.z)), lane_mul(b.z, a.y));
+			y = lane_sub(lane_add(lane_add(lane_mul(b.w, a.y), lane_mul(b.y, a.w)), lane_mul(b.z, a.x)), lane_mul(b.x, a.z));
+			z = lane_sub(lane_add(lane_add(lane_mul(b.w, a.z), lane_mul(b.z, a.w)), lane_mul(b.x, a.y)), lane_mul(b.y, a.x));
+			w = lane_sub(lane_sub(lane_sub(lane_mul(b.w, a.w), lane_mul(b.x, a.x)), lane_mul(b.y, a.y)), lane_mul(b.z, a.z));
+		}
+		// v * this, as LLVector3 is rotated by an LLQuaternion
+		void rotate(const LaneVector& v, LaneVector& out) const
+		{
+			LLVector4a rw = lane_sub(LLVector4a::getZero(), lane_add(lane_add(lane_mul(x, v.x), lane_mul(y, v.y)), lane_mul(z, v.z)));
+			LLVector4a rx = lane_sub(lane_add(lane_mul(w, v.x), lane_mul(y, v.z)), lane_mul(z, v.y));
+			LLVector4a ry = lane_sub(lane_add(lane_mul(w, v.y), lane_mul(z, v.x)), lane_mul(x, v.z));
+			LLVector4a rz = lane_sub(lane_add(lane_mul(w, v.z), lane_mul(x, v.y)), lane_mul(y, v.x));
+
+			out.x = lane_add(lane_sub(lane_sub(lane_mul(rx, w), lane_mul(rw, x)), lane_mul(ry, z)), lane_mul(rz, y));
+			out.y = lane_add(lane_sub(lane_sub(lane_mul(ry, w), lane_mul(rw, y)), lane_mul(rz, x)), lane_mul(rx, z));
+			out.z = lane_add(lane_sub(lane_sub(lane_mul(rz, w), lane_mul(rw, z)), lane_mul(rx, y)), lane_mul(ry, x));
+		}
+	};
+}
+
+LLFlexibleChainPool::LLFlexibleChainPool()
+{
+}
+
+U32 LLFlexibleChainPool::add(const LLFlexibleChainStep& step, const LLFlexibleObjectSection* sections, S32 simulate_res)
+{
+	llassert(simulate_res >= 0 && simulate_res <= FLEXIBLE_OBJECT_MAX_SECTIONS);
+	Bucket& bucket = mBuckets[simulate_res];
+	S32 num_sections = 1 << simulate_res;
+	bucket.mPackSize = PACK_PARAM_COUNT + (num_sections + 1) * SECTION_VECTOR_COUNT;
+
+	U32 index = bucket.mChainCount++;
+	U32 lane = index & 3;
+	if (lane == 0)
+	{
+		bucket.mPacks.append(bucket.mPackSize);
+	}
+	LLVector4a* pack = &bucket.mPacks[(index >> 2) * bucket.mPackSize];
+
+	F32 half_max_angle = step.mMaxAngle * 0.5f;
+
+	// A new pack is filled with its first chain, so that lanes no chain is
+	// added to still step a sensible one
+	U32 last_lane = lane == 0 ? 3 : lane;
+	for (U32 l = lane; l <= last_lane; ++l)
+	{
+		set_lane(pack + P_TENSION, l, step.mTensionFactor);
+		set_lane(pack + P_MOMENTUM, l, step.mMomentum);
+		set_lane(pack + P_WIND_FACTOR, l, step.mWindFactor);
+		set_lane(pack + P_GRAVITY, l, step.mGravity * step.mForceFactor);
+		set_lane(pack + P_FORCE, l, step.mUserForce * step.mForceFactor);
+		set_lane(pack + P_SECTION_LENGTH, l, step.mSectionLength);
+		set_lane(pack + P_COS_HALF_MAX, l, cosf(half_max_angle));
+		set_lane(pack + P_SIN_HALF_MAX, l, sinf(half_max_angle));
+		set_lane(pack + P_END_ROTATION, l, step.mAnchorRotation);
+
+		LLVector4a* anchor = pack + PACK_PARAM_COUNT;
+		set_lane(anchor + S_POSITION, l, step.mAnchorPosition);
+		set_lane(anchor + S_VELOCITY, l, sections[0].mVelocity);
+		set_lane(anchor + S_DIRECTION, l, step.mAnchorDirection);
+		set_lane(anchor + S_ROTATION, l, step.mAnchorRotation);
+		set_lane(anchor + S_WIND, l, step.mWind[0]);
+
+		for (S32 i = 1; i <= num_sections; ++i)
+		{
+			LLVector4a* section = anchor + i * SECTION_VECTOR_COUNT;
+			set_lane(section + S_POSITION, l, sections[i].mPosition);
+			set_lane(section + S_VELOCITY, l, sections[i].mVelocity);
+			set_lane(section + S_DIRECTION, l, sections[i].mDirection);
+			set_lane(section + S_ROTATION, l, sections[i].mRotation);
+			set_lane(section + S_WIND, l, step.mWind[i]);
+		}
+	}
+
+	return ((U32)simulate_res << HANDLE_RES_SHIFT) | index;
+}
+
+void LLFlexibleChainPool::simulate(LLJobScheduler* scheduler)
+{
+	for (S32 res = 0; res <= FLEXIBLE_OBJECT_MAX_SECTIONS; ++res)
+	{
+		Bucket& bucket = mBuckets[res];
+		U32 pack_count = (bucket.mChainCount + 3) >> 2;
+		S32 num_sections = 1 << res;
+		ll_parallel_for(scheduler, pack_count, MIN_PACKS_PER_JOB, [&](U32 begin, U32 end)
+		{
+			simulatePacks(bucket, num_sections, begin, end);
+		});
+	}
+}
+
+void LLFlexibleChainPool::get(U32 handle, LLFlexibleObjectSection* sections, LLQuaternion& end_rotation) const
+{
+	S32 simulate_res = handle >> HANDLE_RES_SHIFT;
+	U32 index = handle & HANDLE_INDEX_MASK;
+	const Bucket& bucket = mBuckets[simulate_res];
+	llassert(index < bucket.mChainCount);
+
+	U32 lane = index & 3;
+	const LLVector4a* pack = &bucket.mPacks[(index >> 2) * bucket.mPackSize];
+	end_rotation = get_lane4(pack + P_END_ROTATION, lane);
+
+	S32 num_sections = 1 << simulate_res;
+	for (S32 i = 0; i <= num_sections; ++i)
+	{
+		const LLVector4a* section = pack + PACK_PARAM_COUNT + i * SECTION_VECTOR_COUNT;
+		sections[i].mPosition = get_lane3(section + S_POSITION, lane);
+		sections[i].mVelocity = get_lane3(section + S_VELOCITY, lane);
+		sections[i].mDirection = get_lane3(section + S_DIRECTION, lane);
+		sections[i].mRotation = get_lane4(section + S_ROTATION, lane);
+	}
+}
+
+void LLFlexibleChainPool::clear()
+{
+	for (S32 res = 0; res <= FLEXIBLE_OBJECT_MAX_SECTIONS; ++res)
+	{
+		mBuckets[res].mPacks.resize(0);
+		mBuckets[res].mChainCount = 0;
+	}
+}
+
+U32 LLFlexibleChainPool::getChainCount() const
+{
+	U32 count = 0;
+	for (S32 res = 0; res <= FLEXIBLE_OBJECT_MAX_SECTIONS; ++res)
+	{
+		count += mBuckets[res].mChainCount;
+	}
+	return count;
+}
+
+// The step below, four chains at a time. The angle between a section and
+// its parent is never computed: a quaternion made by shortestArc() has
+// w = cos(angle / 2) >= 0, so the clamp and the half rotation handed to the
+// parent follow from w and the length of the axis.
+void LLFlexibleChainPool::simulatePacks(Bucket& bucket, S32 num_sections, U32 begin, U32 end) const
+{
+	LLVector4a zero;
+	zero.clear();
+	LLVector4a one;
+	one.splat(1.f);
+	LLVector4a half;
+	half.splat(0.5f);
+	LLVector4a two;
+	two.splat(2.f);
+	LLVector4a threshold;
+	threshold.splat(FP_MAG_THRESHOLD);
+
+	LaneQuat identity;
+	identity.setIdentity();
+
+	for (U32 p = begin; p < end; ++p)
+	{
+		LLVector4a* pack = &bucket.mPacks[p * bucket.mPackSize];
+		const LLVector4a& t_factor = pack[P_TENSION];
+		const LLVector4a& momentum = pack[P_MOMENTUM];
+		const LLVector4a& wind_factor = pack[P_WIND_FACTOR];
+		const LLVector4a& gravity = pack[P_GRAVITY];
+		const LLVector4a& section_length = pack[P_SECTION_LENGTH];
+		const LLVector4a& cos_half_max = pack[P_COS_HALF_MAX];
+		const LLVector4a& sin_half_max = pack[P_SIN_HALF_MAX];
+		LaneVector force;
+		force.load(pack + P_FORCE);
+
+		LLVector4a* anchor = pack + PACK_PARAM_COUNT;
+		LaneQuat parent_segment_rotation;
+		parent_segment_rotation.load(anchor + S_ROTATION);
+
+		for (S32 i = 1; i <= num_sections; ++i)
+		{
+			LLVector4a* section = anchor + i * SECTION_VECTOR_COUNT;
+			LLVector4a* parent = section - SECTION_VECTOR_COUNT;
+			const LLVector4a* parent_vector = i == 1 ? anchor + S_DIRECTION : parent - SECTION_VECTOR_COUNT + S_DIRECTION;
+
+			LaneVector position;
+			position.load(section + S_POSITION);
+			LaneVector last_position = position;
+
+			// gravity, wind and user force
+			position.z.sub(gravity);
+			LaneVector wind;
+			wind.load(section + S_WIND);
+			position.mulAdd(wind, wind_factor);
+			position.add(force);
+
+			// tension
+			LaneVector parent_position;
+			parent_position.load(parent + S_POSITION);
+			LaneVector parent_section_vector;
+			parent_section_vector.load(parent_vector);
+			LaneVector current_vector;
+			current_vector.setSub(position, parent_position);
+			LaneVector difference;
+			difference.setMul(parent_section_vector, section_length);
+			difference.setSub(difference, current_vector);
+			position.mulAdd(difference, t_factor);
+
+			// inertia
+			LaneVector velocity;
+			velocity.load(section + S_VELOCITY);
+			position.mulAdd(velocity, momentum);
+
+			// clamp length & rotation
+			LaneVector direction;
+			direction.setSub(position, parent_position);
+			LLVector4a length = lane_sqrt(direction.dot(direction));
+			LaneVector normalized;
+			normalized.setMul(direction, lane_div(one, length));
+			LaneVector null_direction;
+			null_direction.x = zero;
+			null_direction.y = zero;
+			null_direction.z = zero;
+			direction.setSelect(length.greaterThan(threshold), normalized, null_direction);
+
+			LaneVector parent_direction;
+			parent_direction.load(parent + S_DIRECTION);
+
+			// shortestArc(parent_direction, direction)
+			LLVector4a ab = parent_direction.dot(direction);
+			LaneVector c;
+			c.setCross(parent_direction, direction);
+			LLVector4a cc = c.dot(c);
+			LLVector4a s = lane_add(lane_sqrt(lane_add(lane_mul(ab, ab), cc)), ab);
+			LLVector4a m = lane_div(one, lane_sqrt(lane_add(cc, lane_mul(s, s))));
+			LaneQuat arc;
+			arc.x = lane_mul(c.x, m);
+			arc.y = lane_mul(c.y, m);
+			arc.z = lane_mul(c.z, m);
+			arc.w = lane_mul(s, m);
+
+			LaneVector back;
+			back.setSub(parent_direction, direction);
+			LLVector4a xy = lane_sqrt(lane_add(lane_mul(back.x, back.x), lane_mul(back.y, back.y)));
+			LaneQuat flip;
+			flip.x = lane_select(xy.greaterThan(threshold), lane_sub(zero, lane_div(back.y, xy)), one);
+			flip.y = lane_select(xy.greaterThan(threshold), lane_div(back.x, xy), zero);
+			flip.z = zero;
+			flip.w = zero;
+
+			LaneQuat delta_rotation;
+			delta_rotation.setSelect(ab.lessThan(zero), flip, identity);
+			delta_rotation.setSelect(cc.greaterThan(zero), arc, delta_rotation);
+
+			// getAngleAxis() of delta_rotation
+			LLVector4a v = lane_sqrt(lane_add(lane_add(lane_mul(delta_rotation.x, delta_rotation.x), lane_mul(delta_rotation.y, delta_rotation.y)),
+									 lane_mul(delta_rotation.z, delta_rotation.z)));
+			LLVector4Logical has_axis = v.greaterThan(threshold);
+			LLVector4a w;
+			w.setAbs(delta_rotation.w);
+			LLVector4a oomag = lane_div(one, v);
+			oomag = lane_select(delta_rotation.w.lessThan(zero), lane_sub(zero, oomag), oomag);
+			LaneVector axis;
+			axis.x = lane_mul(delta_rotation.x, oomag);
+			axis.y = lane_mul(delta_rotation.y, oomag);
+			axis.z = lane_mul(delta_rotation.z, oomag);
+
+			// the angle is over max_angle where cos(angle / 2) < cos(max_angle / 2)
+			LLVector4a n = lane_sqrt(lane_add(lane_mul(v, v), lane_mul(w, w)));
+			LLVector4Logical clamp = lane_and(has_axis, w.lessThan(lane_mul(cos_half_max, n)));
+			LaneQuat clamped;
+			clamped.x = lane_mul(axis.x, sin_half_max);
+			clamped.y = lane_mul(axis.y, sin_half_max);
+			clamped.z = lane_mul(axis.z, sin_half_max);
+			clamped.w = cos_half_max;
+			LaneQuat unclamped = delta_rotation;
+			delta_rotation.setSelect(clamp, clamped, unclamped);
+
+			// half the unclamped angle, about the same axis, for the parent
+			LLVector4a cos_half = lane_div(w, n);
+			LLVector4a sin_half = lane_div(v, n);
+			LLVector4a cos_quarter = lane_sqrt(lane_mul(lane_add(one, cos_half), half));
+			LLVector4a sin_quarter = lane_div(sin_half, lane_mul(two, cos_quarter));
+			LaneQuat half_delta_rotation;
+			half_delta_rotation.x = lane_mul(axis.x, sin_quarter);
+			half_delta_rotation.y = lane_mul(axis.y, sin_quarter);
+			half_delta_rotation.z = lane_mul(axis.z, sin_quarter);
+			half_delta_rotation.w = cos_quarter;
+			half_delta_rotation.setSelect(has_axis, half_delta_rotation, identity);
+
+			LaneQuat segment_rotation;
+			segment_rotation.setMul(parent_segment_rotation, delta_rotation);
+			parent_segment_rotation = segment_rotation;
+
+			delta_rotation.rotate(parent_direction, direction);
+			position = parent_position;
+			position.mulAdd(direction, section_length);
+			position.store(section + S_POSITION);
+			direction.store(section + S_DIRECTION);
+			segment_rotation.store(section + S_ROTATION);
+
+			if (i > 1)
+			{
+				// Propogate half the rotation up to the parent
+				LaneQuat parent_rotation;
+				parent_rotation.load(parent + S_ROTATION);
+				LaneQuat rotation;
+				rotation.setMul(parent_rotation, half_delta_rotation);
+				rotation.store(parent + S_ROTATION);
+			}
+
+			// calculate velocity
+			velocity.setSub(position, last_position);
+			LLVector4a speed_squared = velocity.dot(velocity);
+			LaneVector normalized_velocity;
+			normalized_velocity.setMul(velocity, lane_div(one, lane_sqrt(speed_squared)));
+			velocity.setSelect(speed_squared.greaterThan(one), normalized_velocity, velocity);
+			velocity.store(section + S_VELOCITY);
+		}
+
+		parent_segment_rotation.store(pack + P_END_ROTATION);
+	}
+}
+
+//static
+LLQuaternion LLFlexibleChainPool::step(const LLFlexibleChainStep& step, LLFlexibleObjectSection* sections, S32 num_sections)
+{
+	F32 section_length = step.mSectionLength;
+	F32 t_factor = step.mTensionFactor;
+	F32 momentum = step.mMomentum;
+	F32 wind_factor = step.mWindFactor;
+	F32 max_angle = step.mMaxAngle;
+	F32 force_factor = step.mForceFactor;
+
+	LLQuaternion parentSegmentRotation = step.mAnchorRotation;
+
+	sections[0].mPosition = step.mAnchorPosition;
+	sections[0].mDirection = step.mAnchorDirection;
+	sections[0].mRotation = step.mAnchorRotation;
+
+	LLQuaternion deltaRotation;
+
+	LLVector3 lastPosition;
+
+	// Update simulated sections
+	for (S32 i=1; i<=num_sections; ++i)
+	{
+		LLVector3 parentSectionVector;
+		LLVector3 parentSectionPosition;
+		LLVector3 parentDirection;
+
+		//---------------------------------------------------
+		// save value of position as lastPosition
+		//---------------------------------------------------
+		lastPosition = sections[i].mPosition;
+
+		//------------------------------------------------------------------------------------------
+		// gravity
+		//------------------------------------------------------------------------------------------
+		sections[i].mPosition.mV[2] -= step.mGravity * force_factor;
+
+		//------------------------------------------------------------------------------------------
+		// wind force
+		//------------------------------------------------------------------------------------------
+		sections[i].mPosition += step.mWind[i] * wind_factor;
+
+		//------------------------------------------------------------------------------------------
+		// user-defined force
+		//------------------------------------------------------------------------------------------
+		sections[i].mPosition += step.mUserForce * force_factor;
+
+		//---------------------------------------------------
+		// tension (rigidity, stiffness)
+		//---------------------------------------------------
+		parentSectionPosition = sections[i-1].mPosition;
+		parentDirection = sections[i-1].mDirection;
+
+		if ( i == 1 )
+		{
+			parentSectionVector = sections[0].mDirection;
+		}
+		else
+		{
+			parentSectionVector = sections[i-2].mDirection;
+		}
+
+		LLVector3 currentVector = sections[i].mPosition - parentSectionPosition;
+
+		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
+		LLVector3 tensionForce = difference * t_factor;
+
+		sections[i].mPosition += tensionForce;
+
+		//------------------------------------------------------------------------------------------
+		// inertia
+		//------------------------------------------------------------------------------------------
+		sections[i].mPosition += sections[i].mVelocity * momentum;
+
+		//------------------------------------------------------------------------------------------
+		// clamp length & rotation
+		//------------------------------------------------------------------------------------------
+		sections[i].mDirection = sections[i].mPosition - parentSectionPosition;
+		sections[i].mDirection.normVec();
+		deltaRotation.shortestArc( parentDirection, sections[i].mDirection );
+
+		F32 angle;
+		LLVector3 axis;
+		deltaRotation.getAngleAxis(&angle, axis);
+		if (angle > F_PI) angle -= 2.f*F_PI;
+		if (angle < -F_PI) angle += 2.f*F_PI;
+		if (angle > max_angle)
+		{
+			//angle = 0.5f*(angle+max_angle);
+			deltaRotation.setQuat(max_angle, axis);
+		} else if (angle < -max_angle)
+		{
+			//angle = 0.5f*(angle-max_angle);
+			deltaRotation.setQuat(-max_angle, axis);
+		}
+		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
+		parentSegmentRotation = segment_rotation;
+
+		sections[i].mDirection = (parentDirection * deltaRotation);
+		sections[i].mPosition = parentSectionPosition + sections[i].mDirection * section_length;
+		sections[i].mRotation = segment_rotation;
+
+		if (i > 1)
+		{
+			// Propogate half the rotation up to the parent
+			LLQuaternion halfDeltaRotation(angle/2, axis);
+			sections[i-1].mRotation = sections[i-1].mRotation * halfDeltaRotation;
+		}
+
+		//------------------------------------------------------------------------------------------
+		// calculate velocity
+		//------------------------------------------------------------------------------------------
+		sections[i].mVelocity = sections[i].mPosition - lastPosition;
+		if (sections[i].mVelocity.magVecSquared() > 1.f)
+		{
+			sections[i].mVelocity.normVec();
+		}
+	}
+
+	return parentSegmentRotation;
+}
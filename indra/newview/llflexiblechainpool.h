@@ -0,0 +1,124 @@
+/**
+ * @file llflexiblechainpool.h
+ * @brief Section chains of flexible objects, stepped four at a time
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFLEXIBLECHAINPOOL_H
+#define LL_LLFLEXIBLECHAINPOOL_H
+
+#include "llalignedarray.h"
+#include "llprimitive.h"
+#include "llquaternion.h"
+#include "llvector4a.h"
+#include "v2math.h"
+#include "v3math.h"
+
+class LLJobScheduler;
+
+const S32	FLEXIBLE_OBJECT_MAX_SECTION_COUNT = 1 << FLEXIBLE_OBJECT_MAX_SECTIONS;
+
+//-------------------------------------------------------------------
+
+struct LLFlexibleObjectSection
+{
+	// Input parameters
+	LLVector2		mScale;
+	LLQuaternion	mAxisRotation;
+	// Simulated state
+	LLVector3		mPosition;
+	LLVector3		mVelocity;
+	LLVector3		mDirection;
+	LLQuaternion	mRotation;
+	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
+	LLVector3		mdPosition;
+	//LLMatrix4		mRotScale;
+	//LLMatrix4		mdRotScale;
+};
+
+// What one step of a chain needs besides its sections, all in agent space
+struct LLFlexibleChainStep
+{
+	LLVector3		mAnchorPosition;
+	LLVector3		mAnchorDirection;
+	LLQuaternion	mAnchorRotation;
+	LLVector3		mUserForce;
+	F32				mGravity;
+	F32				mSectionLength;
+	F32				mTensionFactor;
+	F32				mMomentum;
+	F32				mWindFactor;
+	F32				mForceFactor;
+	F32				mMaxAngle;
+	// Wind velocity at each section once gravity has moved it, zero for
+	// chains that ignore the wind
+	LLVector3		mWind[FLEXIBLE_OBJECT_MAX_SECTION_COUNT + 1];
+};
+
+//-------------------------------------------------------------------
+// Chains that step in the same frame, copied in by add() and out again by
+// get(). Chains with the same number of sections are kept together, four
+// to a pack, each value of a pack in one LLVector4a with a lane per chain,
+// so that simulate() steps four chains with every instruction. Packs are
+// independent and are shared out over the job scheduler when there are
+// many of them.
+
+class LLFlexibleChainPool
+{
+public:
+	LLFlexibleChainPool();
+
+	// Copies the anchor and the 1 << simulate_res sections after it in, and
+	// returns the handle get() takes
+	U32 add(const LLFlexibleChainStep& step, const LLFlexibleObjectSection* sections, S32 simulate_res);
+
+	// Steps every chain added since clear()
+	void simulate(LLJobScheduler* scheduler);
+
+	// Copies a stepped chain back out, with the rotation of its last segment
+	void get(U32 handle, LLFlexibleObjectSection* sections, LLQuaternion& end_rotation) const;
+
+	void clear();
+	U32 getChainCount() const;
+
+	// Steps one chain of num_sections sections. This is the step simulate()
+	// reproduces. Returns the rotation of the last segment.
+	static LLQuaternion step(const LLFlexibleChainStep& step, LLFlexibleObjectSection* sections, S32 num_sections);
+
+private:
+	struct Bucket
+	{
+		Bucket() : mChainCount(0), mPackSize(0) {}
+
+		LLAlignedArray<LLVector4a, 64>	mPacks;
+		U32								mChainCount;
+		U32								mPackSize;	// vectors per pack
+	};
+
+	void simulatePacks(Bucket& bucket, S32 num_sections, U32 begin, U32 end) const;
+
+private:
+	Bucket	mBuckets[FLEXIBLE_OBJECT_MAX_SECTIONS + 1];	// by simulate res
+};
+
+#endif // LL_LLFLEXIBLECHAINPOOL_H
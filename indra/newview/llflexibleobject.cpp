@@ -31,6 +31,7 @@
 #include "llface.h"
 #include "llflexibleobject.h"
 #include "llglheaders.h"
+#include "lljobscheduler.h"
 #include "llrendersphere.h"
 #include "llviewerobject.h"
 #include "llagent.h"
@@ -45,10 +46,13 @@
 
 static const F32 SEC_PER_FLEXI_FRAME = 1.f / 60.f; // 60 flexi updates per second
 /*static*/ F32 LLVolumeImplFlexible::sUpdateFactor = 1.0f;
+/*static*/ BOOL LLVolumeImplFlexible::sBatchSimulation = TRUE;
 std::vector<LLVolumeImplFlexible*> LLVolumeImplFlexible::sInstanceList;
+static LLFlexibleChainPool sChainPool;
 
 static LLTrace::BlockTimerStatHandle FTM_FLEXIBLE_REBUILD("Rebuild");
 static LLTrace::BlockTimerStatHandle FTM_DO_FLEXIBLE_UPDATE("Flexible Update");
+static LLTrace::BlockTimerStatHandle FTM_FLEXIBLE_SIMULATE("Flexible Simulate");
 
 // LLFlexibleObjectData::pack/unpack now in llprimitive.cpp
 
@@ -65,6 +69,8 @@ LLVolumeImplFlexible::LLVolumeImplFlexible(LLViewerObject* vo, LLFlexibleObjectD
 	mID = seed++;
 	mInitialized = FALSE;
 	mUpdated = FALSE;
+	mPendingStep = FALSE;
+	mSteppedFrame = U32_MAX;
 	mInitializedRes = -1;
 	mSimulateRes = 0;
 	mCollisionSphereRadius = 0.f;
@@ -112,6 +118,67 @@ void LLVolumeImplFlexible::updateClass()
 	}
 }
 
+//static
+void LLVolumeImplFlexible::simulatePending()
+{
+	if (!sBatchSimulation)
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_FLEXIBLE_SIMULATE);
+
+	static std::vector<LLVolumeImplFlexible*> stepping;
+	static std::vector<U32> handles;
+	stepping.clear();
+	handles.clear();
+	sChainPool.clear();
+
+	for (std::vector<LLVolumeImplFlexible*>::iterator iter = sInstanceList.begin();
+			iter != sInstanceList.end();
+			++iter)
+	{
+		LLVolumeImplFlexible* flexi = *iter;
+		if (!flexi->mPendingStep)
+		{
+			continue;
+		}
+		flexi->mPendingStep = FALSE;
+
+		// Chains doFlexibleUpdate() would not step, or would first have to
+		// set up, are left to it
+		LLDrawable* drawablep = flexi->mVO->mDrawable;
+		if (!drawablep || drawablep->isDead()
+			|| !drawablep->isState(LLDrawable::IN_REBUILD_Q1 | LLDrawable::IN_REBUILD_Q2)
+			|| !flexi->mVO->getVolume()
+			|| !flexi->mInitialized || !flexi->mAttributes
+			|| flexi->mSimulateRes == 0 || flexi->mRenderRes < 0
+			|| flexi->isFrozenImpostorAttachment())
+		{
+			continue;
+		}
+
+		LLFlexibleChainStep step;
+		flexi->prepareStep(step);
+		handles.push_back(sChainPool.add(step, flexi->mSection, flexi->mSimulateRes));
+		stepping.push_back(flexi);
+	}
+
+	if (stepping.empty())
+	{
+		return;
+	}
+
+	sChainPool.simulate(LLJobScheduler::getDefault());
+
+	for (U32 i = 0; i < stepping.size(); ++i)
+	{
+		LLVolumeImplFlexible* flexi = stepping[i];
+		sChainPool.get(handles[i], flexi->mSection, flexi->mLastSegmentRotation);
+		flexi->mSteppedFrame = LLFrameTimer::getFrameCount();
+	}
+}
+
 LLVector3 LLVolumeImplFlexible::getFramePosition() const
 {
 	return mVO->getRenderPosition();
@@ -352,6 +419,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 			{
 				updateRenderRes();
 				gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+				mPendingStep = TRUE;
 			}
 			else
 			{
@@ -402,6 +470,7 @@ void LLVolumeImplFlexible::doIdleUpdate()
 							updateRenderRes();
 
 							gPipeline.markRebuild(drawablep, LLDrawable::REBUILD_POSITION, FALSE);
+							mPendingStep = TRUE;
 						}
 					}
 				}
@@ -460,180 +529,23 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 	
 	S32 num_sections = 1 << mSimulateRes;
 
-    F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
-	if (secondsThisFrame > 0.2f)
+	// simulatePending() may have stepped the chain already this frame.  The frame is
+	// compared since the rebuild it was stepped for doesn't always happen.
+	if (mSteppedFrame == LLFrameTimer::getFrameCount())
 	{
-		secondsThisFrame = 0.2f;
+		mSteppedFrame = U32_MAX;
 	}
-
-	LLVector3 BasePosition = getFramePosition();
-	LLQuaternion BaseRotation = getFrameRotation();
-	LLQuaternion parentSegmentRotation = BaseRotation;
-	LLVector3 anchorDirectionRotated = LLVector3::z_axis * parentSegmentRotation;
-	LLVector3 anchorScale = mVO->mDrawable->getScale();
-	
-	F32 section_length = anchorScale.mV[VZ] / (F32)num_sections;
-	F32 inv_section_length = 1.f / section_length;
-
-	S32 i;
-
-	// ANCHOR position is offset from BASE position (centroid) by half the length
-	LLVector3 AnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
-	
-	mSection[0].mPosition = AnchorPosition;
-	mSection[0].mDirection = anchorDirectionRotated;
-	mSection[0].mRotation = BaseRotation;
-
-	LLQuaternion deltaRotation;
-
-	LLVector3 lastPosition;
-
-	// Coefficients which are constant across sections
-	F32 t_factor = mAttributes->getTension() * 0.1f;
-	t_factor = t_factor*(1 - pow(0.85f, secondsThisFrame*30));
-	if ( t_factor > FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE )
+	else
 	{
-		t_factor = FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE;
+		LLFlexibleChainStep step;
+		prepareStep(step);
+		mLastSegmentRotation = LLFlexibleChainPool::step(step, mSection, num_sections);
 	}
 
-	F32 friction_coeff = (mAttributes->getAirFriction()*2+1);
-	friction_coeff = pow(10.f, friction_coeff*secondsThisFrame);
-	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
-	F32 momentum = 1.0f / friction_coeff;
-
-	F32 wind_factor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
-	F32 max_angle = atan(section_length*2.f);
-
-	F32 force_factor = section_length * secondsThisFrame;
-
-	// Update simulated sections
-	for (i=1; i<=num_sections; ++i)
-	{
-		LLVector3 parentSectionVector;
-		LLVector3 parentSectionPosition;
-		LLVector3 parentDirection;
-
-		//---------------------------------------------------
-		// save value of position as lastPosition
-		//---------------------------------------------------
-		lastPosition = mSection[i].mPosition;
-
-		//------------------------------------------------------------------------------------------
-		// gravity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition.mV[2] -= mAttributes->getGravity() * force_factor;
-
-		//------------------------------------------------------------------------------------------
-		// wind force
-		//------------------------------------------------------------------------------------------
-		if (mAttributes->getWindSensitivity() > 0.001f)
-		{
-			mSection[i].mPosition += gAgent.getRegion()->mWind.getVelocity( mSection[i].mPosition ) * wind_factor;
-		}
-
-		//------------------------------------------------------------------------------------------
-		// user-defined force
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mAttributes->getUserForce() * force_factor;
-
-		//---------------------------------------------------
-		// tension (rigidity, stiffness)
-		//---------------------------------------------------
-		parentSectionPosition = mSection[i-1].mPosition;
-		parentDirection = mSection[i-1].mDirection;
-
-		if ( i == 1 )
-		{
-			parentSectionVector = mSection[0].mDirection;
-		}
-		else
-		{
-			parentSectionVector = mSection[i-2].mDirection;
-		}
-
-		LLVector3 currentVector = mSection[i].mPosition - parentSectionPosition;
-
-		LLVector3 difference = (parentSectionVector*section_length) - currentVector;
-		LLVector3 tensionForce = difference * t_factor;
-
-		mSection[i].mPosition += tensionForce;
-
-		//------------------------------------------------------------------------------------------
-		// sphere collision, currently not used
-		//------------------------------------------------------------------------------------------
-		/*if ( mAttributes->mUsingCollisionSphere )
-		{
-			LLVector3 vectorToCenterOfCollisionSphere = mCollisionSpherePosition - mSection[i].mPosition;
-			if ( vectorToCenterOfCollisionSphere.magVecSquared() < mCollisionSphereRadius * mCollisionSphereRadius )
-			{
-				F32 distanceToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere.magVec();
-				F32 penetration = mCollisionSphereRadius - distanceToCenterOfCollisionSphere;
-
-				LLVector3 normalToCenterOfCollisionSphere;
-				
-				if ( distanceToCenterOfCollisionSphere > 0.0f )
-				{
-					normalToCenterOfCollisionSphere = vectorToCenterOfCollisionSphere / distanceToCenterOfCollisionSphere;
-				}
-				else // rare
-				{
-					normalToCenterOfCollisionSphere = LLVector3::x_axis; // arbitrary
-				}
-
-				// push the position out to the surface of the collision sphere
-				mSection[i].mPosition -= normalToCenterOfCollisionSphere * penetration;
-			}
-		}*/
-
-		//------------------------------------------------------------------------------------------
-		// inertia
-		//------------------------------------------------------------------------------------------
-		mSection[i].mPosition += mSection[i].mVelocity * momentum;
-
-		//------------------------------------------------------------------------------------------
-		// clamp length & rotation
-		//------------------------------------------------------------------------------------------
-		mSection[i].mDirection = mSection[i].mPosition - parentSectionPosition;
-		mSection[i].mDirection.normVec();
-		deltaRotation.shortestArc( parentDirection, mSection[i].mDirection );
-
-		F32 angle;
-		LLVector3 axis;
-		deltaRotation.getAngleAxis(&angle, axis);
-		if (angle > F_PI) angle -= 2.f*F_PI;
-		if (angle < -F_PI) angle += 2.f*F_PI;
-		if (angle > max_angle)
-		{
-			//angle = 0.5f*(angle+max_angle);
-			deltaRotation.setQuat(max_angle, axis);
-		} else if (angle < -max_angle)
-		{
-			//angle = 0.5f*(angle-max_angle);
-			deltaRotation.setQuat(-max_angle, axis);
-		}
-		LLQuaternion segment_rotation = parentSegmentRotation * deltaRotation;
-		parentSegmentRotation = segment_rotation;
-
-		mSection[i].mDirection = (parentDirection * deltaRotation);
-		mSection[i].mPosition = parentSectionPosition + mSection[i].mDirection * section_length;
-		mSection[i].mRotation = segment_rotation;
-
-		if (i > 1)
-		{
-			// Propogate half the rotation up to the parent
-			LLQuaternion halfDeltaRotation(angle/2, axis);
-			mSection[i-1].mRotation = mSection[i-1].mRotation * halfDeltaRotation;
-		}
+	F32 section_length = mVO->mDrawable->getScale().mV[VZ] / (F32)num_sections;
+	F32 inv_section_length = 1.f / section_length;
 
-		//------------------------------------------------------------------------------------------
-		// calculate velocity
-		//------------------------------------------------------------------------------------------
-		mSection[i].mVelocity = mSection[i].mPosition - lastPosition;
-		if (mSection[i].mVelocity.magVecSquared() > 1.f)
-		{
-			mSection[i].mVelocity.normVec();
-		}
-	}
+	S32 i;
 
 	// Calculate derivatives (not necessary until normals are automagically generated)
 	mSection[0].mdPosition = (mSection[1].mPosition - mSection[0].mPosition) * inv_section_length;
@@ -717,7 +629,68 @@ void LLVolumeImplFlexible::doFlexibleUpdate()
 		new_point->mTexT = ((F32)i)/(num_render_sections);
 	}
 	LL_CHECK_MEMORY
-	mLastSegmentRotation = parentSegmentRotation;
+}
+
+void LLVolumeImplFlexible::prepareStep(LLFlexibleChainStep& step)
+{
+	S32 num_sections = 1 << mSimulateRes;
+
+    F32 secondsThisFrame = mTimer.getElapsedTimeAndResetF32();
+	if (secondsThisFrame > 0.2f)
+	{
+		secondsThisFrame = 0.2f;
+	}
+
+	LLVector3 BasePosition = getFramePosition();
+	LLQuaternion BaseRotation = getFrameRotation();
+	LLVector3 anchorDirectionRotated = LLVector3::z_axis * BaseRotation;
+	LLVector3 anchorScale = mVO->mDrawable->getScale();
+	
+	F32 section_length = anchorScale.mV[VZ] / (F32)num_sections;
+
+	// ANCHOR position is offset from BASE position (centroid) by half the length
+	step.mAnchorPosition = BasePosition - (anchorScale.mV[VZ]/2 * anchorDirectionRotated);
+	step.mAnchorDirection = anchorDirectionRotated;
+	step.mAnchorRotation = BaseRotation;
+
+	// Coefficients which are constant across sections
+	F32 t_factor = mAttributes->getTension() * 0.1f;
+	t_factor = t_factor*(1 - pow(0.85f, secondsThisFrame*30));
+	if ( t_factor > FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE )
+	{
+		t_factor = FLEXIBLE_OBJECT_MAX_INTERNAL_TENSION_FORCE;
+	}
+
+	F32 friction_coeff = (mAttributes->getAirFriction()*2+1);
+	friction_coeff = pow(10.f, friction_coeff*secondsThisFrame);
+	friction_coeff = (friction_coeff > 1) ? friction_coeff : 1;
+
+	step.mSectionLength = section_length;
+	step.mTensionFactor = t_factor;
+	step.mMomentum = 1.0f / friction_coeff;
+	step.mWindFactor = (mAttributes->getWindSensitivity()*0.1f) * section_length * secondsThisFrame;
+	step.mMaxAngle = atan(section_length*2.f);
+	step.mForceFactor = section_length * secondsThisFrame;
+	step.mGravity = mAttributes->getGravity();
+	step.mUserForce = mAttributes->getUserForce();
+
+	// The wind is sampled where gravity has moved each section to, before
+	// the step moves it any further
+	LLViewerRegion* region = gAgent.getRegion();
+	bool windy = region && mAttributes->getWindSensitivity() > 0.001f;
+	for (S32 i = 0; i <= num_sections; ++i)
+	{
+		if (windy && i > 0)
+		{
+			LLVector3 position = mSection[i].mPosition;
+			position.mV[2] -= step.mGravity * step.mForceFactor;
+			step.mWind[i] = region->mWind.getVelocity(position);
+		}
+		else
+		{
+			step.mWind[i].clear();
+		}
+	}
 }
 
 static LLTrace::BlockTimerStatHandle FTM_FLEXI_PREBUILD("Flexi Prebuild");
@@ -750,10 +723,8 @@ void LLVolumeImplFlexible::onSetScale(const LLVector3& scale, BOOL damped)
 	setAttributesOfAllSections((LLVector3*) &scale);
 }
 
-BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
+bool LLVolumeImplFlexible::isFrozenImpostorAttachment() const
 {
-	LLVOVolume *volume = (LLVOVolume*)mVO;
-
 	if (mVO->isAttachment())
 	{	//don't update flexible attachments for impostored avatars unless the 
 		//impostor is being updated this frame (w00!)
@@ -768,10 +739,21 @@ BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
 			LLVOAvatar* avatar = (LLVOAvatar*) parent;
 			if (avatar->isImpostor() && !avatar->needsImpostorUpdate())
 			{
-				return TRUE;
+				return true;
 			}
 		}
 	}
+	return false;
+}
+
+BOOL LLVolumeImplFlexible::doUpdateGeometry(LLDrawable *drawable)
+{
+	LLVOVolume *volume = (LLVOVolume*)mVO;
+
+	if (isFrozenImpostorAttachment())
+	{
+		return TRUE;
+	}
 
 	if (volume->mDrawable.isNull())
 	{
@@ -37,6 +37,7 @@
 #ifndef LL_LLFLEXIBLEOBJECT_H
 #define LL_LLFLEXIBLEOBJECT_H
 
+#include "llflexiblechainpool.h"
 #include "llprimitive.h"
 #include "llvovolume.h"
 #include "llwind.h"
@@ -47,24 +48,6 @@ const U32	FLEXIBLE_OBJECT_MAX_LOD			= 10;
 
 // See llprimitive.h for LLFlexibleObjectData and DEFAULT/MIN/MAX values 
 
-//-------------------------------------------------------------------
-
-struct LLFlexibleObjectSection
-{
-	// Input parameters
-	LLVector2		mScale;
-	LLQuaternion	mAxisRotation;
-	// Simulated state
-	LLVector3		mPosition;
-	LLVector3		mVelocity;
-	LLVector3		mDirection;
-	LLQuaternion	mRotation;
-	// Derivatives (Not all currently used, will come back with LLVolume changes to automagically generate normals)
-	LLVector3		mdPosition;
-	//LLMatrix4		mRotScale;
-	//LLMatrix4		mdRotScale;
-};
-
 //---------------------------------------------------------
 // The LLVolumeImplFlexible class 
 //---------------------------------------------------------
@@ -77,6 +60,10 @@ private:
 	public:
 		static void updateClass();
 
+		// Steps the chains doIdleUpdate() queued for a rebuild all together,
+		// ahead of the geometry updates that use them
+		static void simulatePending();
+
 		LLVolumeImplFlexible(LLViewerObject* volume, LLFlexibleObjectData* attributes);
 		~LLVolumeImplFlexible();
 
@@ -127,6 +114,8 @@ private:
 		LLQuaternion				mLastSegmentRotation;
 		BOOL						mInitialized;
 		BOOL						mUpdated;
+		BOOL						mPendingStep;	// queued for a rebuild, not yet stepped
+		U32							mSteppedFrame;	// frame simulatePending() stepped the chain in
 		LLFlexibleObjectData*		mAttributes;
 		LLFlexibleObjectSection		mSection	[ (1<<FLEXIBLE_OBJECT_MAX_SECTIONS)+1 ];
 		S32							mInitializedRes;
@@ -143,12 +132,18 @@ private:
 		//--------------------------------------
 		void setAttributesOfAllSections	(LLVector3* inScale = NULL);
 
+		// Fills in what the next step of the chain needs and resets the timer
+		void prepareStep(LLFlexibleChainStep& step);
+		bool isFrozenImpostorAttachment() const;
+
 		void remapSections(LLFlexibleObjectSection *source, S32 source_sections,
 										 LLFlexibleObjectSection *dest, S32 dest_sections);
 		
 public:
 		// Global setting for update rate
 		static F32					sUpdateFactor;
+		// Step pending chains together in simulatePending()
+		static BOOL					sBatchSimulation;
 
 };// end of class definition
 
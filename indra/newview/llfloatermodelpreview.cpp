@@ -84,8 +84,9 @@
 #include "llanimationstates.h"
 #include "llviewernetwork.h"
 #include "llviewershadermgr.h"
+#include "lljobscheduler.h"
+#include "llmeshsimplifier.h"
 
-#include "glod/glod.h"
 #include <boost/algorithm/string.hpp>
 
 //static
@@ -176,17 +177,51 @@ std::string lod_label_name[NUM_LOD+1] =
 	"I went off the end of the lod_label_name array.  Me so smart."
 };
 
-BOOL stop_gloderror()
+// Regenerates the normals of one model on a job scheduler worker
+class LLGenerateNormalsJob : public LLJob
 {
-	GLuint error = glodGetError();
+public:
+	LLGenerateNormalsJob(LLModel* model, F32 angle_cutoff)
+	:	mModel(model),
+		mAngleCutoff(angle_cutoff)
+	{
+	}
 
-	if (error != GLOD_NO_ERROR)
+protected:
+	/*virtual*/ void run()
 	{
-		LL_WARNS() << "GLOD error detected, cannot generate LOD: " << std::hex << error << LL_ENDL;
-		return TRUE;
+		mModel->generateNormals(mAngleCutoff);
 	}
 
-	return FALSE;
+private:
+	LLModel* mModel; // not an LLPointer, the job may be released on a worker
+	F32 mAngleCutoff;
+};
+
+void generate_model_normals(LLModelLoader::model_list& models, F32 angle_cutoff)
+{
+	LLJobScheduler* scheduler = LLJobScheduler::getDefault();
+	if (!scheduler)
+	{
+		for (LLModelLoader::model_list::iterator it = models.begin(), itE = models.end(); it != itE; ++it)
+		{
+			(*it)->generateNormals(angle_cutoff);
+		}
+		return;
+	}
+
+	std::vector<LLJob::ptr_t> jobs;
+	jobs.reserve(models.size());
+	for (LLModelLoader::model_list::iterator it = models.begin(), itE = models.end(); it != itE; ++it)
+	{
+		jobs.push_back(new LLGenerateNormalsJob(*it, angle_cutoff));
+		scheduler->submit(jobs.back());
+	}
+
+	for (U32 i = 0; i < jobs.size(); ++i)
+	{
+		scheduler->waitFor(jobs[i]);
+	}
 }
 
 LLViewerFetchedTexture* bindMaterialDiffuseTexture(const LLImportMaterial& material)
@@ -1248,12 +1283,7 @@ LLModelPreview::LLModelPreview(S32 width, S32 height, LLFloater* fmp)
 	mGenLOD = false;
 	mLoading = false;
 	mLoadState = LLModelLoader::STARTING;
-	mGroup = 0;
 	mLODFrozen = false;
-	mBuildShareTolerance = 0.f;
-	mBuildQueueMode = GLOD_QUEUE_GREEDY;
-	mBuildBorderMode = GLOD_BORDER_UNLOCK;
-	mBuildOperator = GLOD_OPERATOR_EDGE_COLLAPSE;
 
 	for (U32 i = 0; i < LLModel::NUM_LODS; ++i)
 	{
@@ -1261,10 +1291,6 @@ LLModelPreview::LLModelPreview(S32 width, S32 height, LLFloater* fmp)
 		mRequestedCreaseAngle[i] = -1.f;
 		mRequestedLoDMode[i] = 0;
 		mRequestedErrorThreshold[i] = 0.f;
-		mRequestedBuildOperator[i] = 0;
-		mRequestedQueueMode[i] = 0;
-		mRequestedBorderMode[i] = 0;
-		mRequestedShareTolerance[i] = 0.f;
 	}
 
 	mViewOption["show_textures"] = false;
@@ -1273,24 +1299,12 @@ LLModelPreview::LLModelPreview(S32 width, S32 height, LLFloater* fmp)
 
 	mHasPivot = false;
 	mModelPivot = LLVector3( 0.0f, 0.0f, 0.0f );
-	
-	glodInit();
 
 	createPreviewAvatar();
 }
 
 LLModelPreview::~LLModelPreview()
 {
-	// glod apparently has internal mem alignment issues that are angering
-	// the heap-check code in windows, these should be hunted down in that
-	// TP code, if possible
-	//
-	// kernel32.dll!HeapFree()  + 0x14 bytes	
-	// msvcr100.dll!free(void * pBlock)  Line 51	C
-	// glod.dll!glodGetGroupParameteriv()  + 0x119 bytes	
-	// glod.dll!glodShutdown()  + 0x77 bytes	
-	//
-	//glodShutdown();
 	if(mModelLoader)
 	{
 		mModelLoader->shutdown();
@@ -1849,11 +1863,6 @@ void LLModelPreview::loadModel(std::string filename, S32 lod, bool force_disable
 	
 	mLODFile[lod] = filename;
 
-	if (lod == LLModel::LOD_HIGH)
-	{
-		clearGLODGroup();
-	}
-
     std::map<std::string, std::string> joint_alias_map;
     getJointAliases(joint_alias_map);
     
@@ -1954,7 +1963,6 @@ void LLModelPreview::clearIncompatible(S32 lod)
 				if (i == LLModel::LOD_HIGH)
 				{
 					mBaseModel = mModel[lod];
-					clearGLODGroup();
 					mBaseScene = mScene[lod];
 					mVertexBuffer[5].clear();
 				}
@@ -1963,23 +1971,6 @@ void LLModelPreview::clearIncompatible(S32 lod)
 	}
 }
 
-void LLModelPreview::clearGLODGroup()
-{
-	if (mGroup)
-	{
-		for (std::map<LLPointer<LLModel>, U32>::iterator iter = mObject.begin(); iter != mObject.end(); ++iter)
-		{
-			glodDeleteObject(iter->second);
-			stop_gloderror();
-		}
-		mObject.clear();
-
-		glodDeleteGroup(mGroup);
-		stop_gloderror();
-		mGroup = 0;
-	}
-}
-
 void LLModelPreview::loadModelCallback(S32 loaded_lod)
 {
 	assert_main_thread();
@@ -2125,7 +2116,6 @@ void LLModelPreview::loadModelCallback(S32 loaded_lod)
 			}
 
 			mBaseModel = mModel[loaded_lod];
-			clearGLODGroup();
 
 			mBaseScene = mScene[loaded_lod];
 			mVertexBuffer[5].clear();
@@ -2281,31 +2271,24 @@ void LLModelPreview::generateNormals()
 			}
 		}
 
-		for (LLModelLoader::model_list::iterator it = mBaseModel.begin(), itE = mBaseModel.end(); it != itE; ++it)
-		{
-			(*it)->generateNormals(angle_cutoff);
-		}
+		generate_model_normals(mBaseModel, angle_cutoff);
 
 		mVertexBuffer[5].clear();
 	}
 
-	bool perform_copy = mModelFacesCopy[which_lod].empty();
-	if(perform_copy) {
-		mModelFacesCopy[which_lod].reserve(mModel[which_lod].size());
-	}
-
-	for (LLModelLoader::model_list::iterator it = mModel[which_lod].begin(), itE = mModel[which_lod].end(); it != itE; ++it)
+	if(mModelFacesCopy[which_lod].empty())
 	{
-		if(perform_copy)
+		mModelFacesCopy[which_lod].reserve(mModel[which_lod].size());
+		for (LLModelLoader::model_list::iterator it = mModel[which_lod].begin(), itE = mModel[which_lod].end(); it != itE; ++it)
 		{
 			v_LLVolumeFace_t faces;
 			(*it)->copyFacesTo(faces);
 			mModelFacesCopy[which_lod].push_back(faces);
 		}
-
-		(*it)->generateNormals(angle_cutoff);
 	}
 
+	generate_model_normals(mModel[which_lod], angle_cutoff);
+
 	mVertexBuffer[which_lod].clear();
 	refresh();
 	updateStatusMessages();
@@ -2365,20 +2348,6 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 		return;
 	}
 
-	LLVertexBuffer::unbind();
-
-	bool no_ff = LLGLSLShader::sNoFixedFunction;
-	LLGLSLShader* shader = LLGLSLShader::sCurBoundShaderPtr;
-	LLGLSLShader::sNoFixedFunction = false;
-
-	if (shader)
-	{
-		shader->unbind();
-	}
-	
-	stop_gloderror();
-	static U32 cur_name = 1;
-
 	S32 limit = -1;
 
 	U32 triangle_count = 0;
@@ -2409,102 +2378,40 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 
 	U32 base_triangle_count = triangle_count;
 
-	U32 type_mask = LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_NORMAL | LLVertexBuffer::MAP_TEXCOORD0;
-
-	U32 lod_mode = 0;
+	LLMeshSimplifier::EMode lod_mode = LLMeshSimplifier::TRIANGLE_BUDGET;
 
 	F32 lod_error_threshold = 0;
 
 	// The LoD should be in range from Lowest to High
 	if (which_lod > -1 && which_lod < NUM_LOD)
 	{
+		U32 mode_index = 0;
 		LLCtrlSelectionInterface* iface = mFMP->childGetSelectionInterface("lod_mode_" + lod_name[which_lod]);
 		if (iface)
 		{
-			lod_mode = iface->getFirstSelectedIndex();
+			mode_index = iface->getFirstSelectedIndex();
 		}
 
-		lod_error_threshold = mFMP->childGetValue("lod_error_threshold_" + lod_name[which_lod]).asReal();
-	}
-
-	if (which_lod != -1)
-	{
-		mRequestedLoDMode[which_lod] = lod_mode;
-	}
-
-	if (lod_mode == 0)
-	{
-		lod_mode = GLOD_TRIANGLE_BUDGET;
+		mRequestedLoDMode[which_lod] = mode_index;
 
-		// The LoD should be in range from Lowest to High
-		if (which_lod > -1 && which_lod < NUM_LOD)
+		if (mode_index == 0)
 		{
 			limit = mFMP->childGetValue("lod_triangle_limit_" + lod_name[which_lod]).asInteger();
 			//convert from "scene wide" to "non-instanced" triangle limit
 			limit = (S32) ( (F32) limit*triangle_ratio );
 		}
-	}
-	else
-	{
-		lod_mode = GLOD_ERROR_THRESHOLD;
-	}
-
-	bool object_dirty = false;
+		else
+		{
+			lod_mode = LLMeshSimplifier::ERROR_THRESHOLD;
+		}
 
-	if (mGroup == 0)
-	{
-		object_dirty = true;
-		mGroup = cur_name++;
-		glodNewGroup(mGroup);
+		lod_error_threshold = mFMP->childGetValue("lod_error_threshold_" + lod_name[which_lod]).asReal();
 	}
-
-	if (object_dirty)
+	else if (which_lod != -1)
 	{
-		for (LLModelLoader::model_list::iterator iter = mBaseModel.begin(); iter != mBaseModel.end(); ++iter)
-		{ //build GLOD objects for each model in base model list
-			LLModel* mdl = *iter;
-
-			if (mObject[mdl] != 0)
-			{
-				glodDeleteObject(mObject[mdl]);
-			}
-
-			mObject[mdl] = cur_name++;
-
-			glodNewObject(mObject[mdl], mGroup, GLOD_DISCRETE);
-			stop_gloderror();
-
-			if (iter == mBaseModel.begin() && !mdl->mSkinWeights.empty())
-			{ //regenerate vertex buffer for skinned models to prevent animation feedback during LOD generation
-				mVertexBuffer[5].clear();
-			}
-
-			if (mVertexBuffer[5].empty())
-			{
-				genBuffers(5, false);
-			}
-
-			U32 tri_count = 0;
-			for (U32 i = 0; i < mVertexBuffer[5][mdl].size(); ++i)
-			{
-				LLVertexBuffer* buff = mVertexBuffer[5][mdl][i];
-				buff->setBuffer(type_mask & buff->getTypeMask());
-				
-				U32 num_indices = mVertexBuffer[5][mdl][i]->getNumIndices();
-				if (num_indices > 2)
-				{
-					glodInsertElements(mObject[mdl], i, GL_TRIANGLES, num_indices, GL_UNSIGNED_SHORT, (U8*) mVertexBuffer[5][mdl][i]->getIndicesPointer(), 0, 0.f);
-				}
-				tri_count += num_indices/3;
-				stop_gloderror();
-			}
-
-			glodBuildObject(mObject[mdl]);
-			stop_gloderror();
-		}
+		mRequestedLoDMode[which_lod] = 0;
 	}
 
-
 	S32 start = LLModel::LOD_HIGH;
 	S32 end = 0;
 
@@ -2515,6 +2422,10 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 
 	mMaxTriangleLimit = base_triangle_count;
 
+	// Queue every requested LoD of every model, then simplify all of
+	// their faces at once on the job scheduler
+	LLMeshSimplifier simplifier;
+
 	for (S32 lod = start; lod >= end; --lod)
 	{
 		if (which_lod == -1)
@@ -2543,44 +2454,13 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 		mModel[lod].resize(mBaseModel.size());
 		mVertexBuffer[lod].clear();
 
-		U32 actual_tris = 0;
-		U32 actual_verts = 0;
-		U32 submeshes = 0;
-
 		mRequestedTriangleCount[lod] = (S32) ( (F32) triangle_count / triangle_ratio );
 		mRequestedErrorThreshold[lod] = lod_error_threshold;
 
-		glodGroupParameteri(mGroup, GLOD_ADAPT_MODE, lod_mode);
-		stop_gloderror();
-
-		glodGroupParameteri(mGroup, GLOD_ERROR_MODE, GLOD_OBJECT_SPACE_ERROR);
-		stop_gloderror();
-
-		glodGroupParameterf(mGroup, GLOD_OBJECT_SPACE_ERROR_THRESHOLD, lod_error_threshold);
-		stop_gloderror();
-
-		if (lod_mode != GLOD_TRIANGLE_BUDGET)
-		{ 			
-			glodGroupParameteri(mGroup, GLOD_MAX_TRIANGLES, 0);
-		}
-		else
-		{
-			//SH-632: always add 1 to desired amount to avoid decimating below desired amount
-			glodGroupParameteri(mGroup, GLOD_MAX_TRIANGLES, triangle_count+1);
-		}
-			
-		stop_gloderror();
-		glodAdaptGroup(mGroup);
-		stop_gloderror();		
-
 		for (U32 mdl_idx = 0; mdl_idx < mBaseModel.size(); ++mdl_idx)
 		{
 			LLModel* base = mBaseModel[mdl_idx];
 
-			GLint patch_count = 0;
-			glodGetObjectParameteriv(mObject[base], GLOD_NUM_PATCHES, &patch_count);
-			stop_gloderror();
-
 			LLVolumeParams volume_params;
 			volume_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
 			mModel[lod][mdl_idx] = new LLModel(volume_params, 0.f);
@@ -2598,93 +2478,57 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 
             mModel[lod][mdl_idx]->mLabel = name;
 			mModel[lod][mdl_idx]->mSubmodelID = base->mSubmodelID;
-            
-			GLint* sizes = new GLint[patch_count*2];
-			glodGetObjectParameteriv(mObject[base], GLOD_PATCH_SIZES, sizes);
-			stop_gloderror();
-
-			GLint* names = new GLint[patch_count];
-			glodGetObjectParameteriv(mObject[base], GLOD_PATCH_NAMES, names);
-			stop_gloderror();
-
-			mModel[lod][mdl_idx]->setNumVolumeFaces(patch_count);
 
 			LLModel* target_model = mModel[lod][mdl_idx];
 
-			for (GLint i = 0; i < patch_count; ++i)
-			{
-				type_mask = mVertexBuffer[5][base][i]->getTypeMask();
-
-				LLPointer<LLVertexBuffer> buff = new LLVertexBuffer(type_mask, 0);
+			//SH-632: always add 1 to desired amount to avoid decimating below desired amount
+			U32 model_triangles = (U32) ((F64) (triangle_count + 1) * base->getNumTriangles() / llmax(base_triangle_count, 1U));
+			simplifier.addModel(base, target_model, lod_mode, model_triangles, lod_error_threshold);
 
-				if (sizes[i*2+1] > 0 && sizes[i*2] > 0)
-				{
-					if (!buff->allocateBuffer(sizes[i * 2 + 1], sizes[i * 2], true))
-					{
-						// Todo: find a way to stop preview in this case instead of crashing
-						LL_ERRS() << "Failed buffer allocation during preview LOD generation."
-							<< " Vertices: " << sizes[i * 2 + 1]
-							<< " Indices: " << sizes[i * 2] << LL_ENDL;
-					}
-					buff->setBuffer(type_mask);
-					glodFillElements(mObject[base], names[i], GL_UNSIGNED_SHORT, (U8*) buff->getIndicesPointer());
-					stop_gloderror();
-				}
-				else
-				{
-					// This face was eliminated or we failed to allocate buffer,
-					// attempt to create a dummy triangle (one vertex, 3 indices, all 0)
-					buff->allocateBuffer(1, 3, true);
-					memset((U8*) buff->getMappedData(), 0, buff->getSize());
-					memset((U8*) buff->getIndicesPointer(), 0, buff->getIndicesSize());
-				}
+			//blind copy skin weights and just take closest skin weight to point on
+			//decimated mesh for now (auto-generating LODs with skin weights is still a bit
+			//of an open problem).
+			target_model->mPosition = base->mPosition;
+			target_model->mSkinWeights = base->mSkinWeights;
+			target_model->mSkinInfo = base->mSkinInfo;
+			//copy material list
+			target_model->mMaterialList = base->mMaterialList;
+		}
+	}
 
-				buff->validateRange(0, buff->getNumVerts()-1, buff->getNumIndices(), 0);
+	simplifier.run(LLJobScheduler::getDefault());
 
-				LLStrider<LLVector3> pos;
-				LLStrider<LLVector3> norm;
-				LLStrider<LLVector2> tc;
-				LLStrider<U16> index;
+	for (S32 lod = start; lod >= end; --lod)
+	{
+		for (U32 mdl_idx = 0; mdl_idx < mBaseModel.size(); ++mdl_idx)
+		{
+			LLModel* target_model = mModel[lod][mdl_idx];
 
-				buff->getVertexStrider(pos);
-				if (type_mask & LLVertexBuffer::MAP_NORMAL)
-				{
-					buff->getNormalStrider(norm);
-				}
-				if (type_mask & LLVertexBuffer::MAP_TEXCOORD0)
+			for (S32 i = 0; i < target_model->getNumVolumeFaces(); ++i)
+			{
+				LLVolumeFace& face = target_model->getVolumeFace(i);
+				if (face.mNumIndices == 0)
 				{
-					buff->getTexCoord0Strider(tc);
+					// This face was eliminated, attempt to create
+					// a dummy triangle (one vertex, 3 indices, all 0)
+					face.resizeVertices(1);
+					face.resizeIndices(3);
+					face.mPositions[0].clear();
+					face.mNormals[0].clear();
+					face.mTexCoords[0].clear();
+					memset(face.mIndices, 0, sizeof(U16) * 3);
 				}
 
-				buff->getIndexStrider(index);
-
-				target_model->setVolumeFaceData(names[i], pos, norm, tc, index, buff->getNumVerts(), buff->getNumIndices());
-				actual_tris += buff->getNumIndices()/3;
-				actual_verts += buff->getNumVerts();
-				++submeshes;
-
-				if (!validate_face(target_model->getVolumeFace(names[i])))
+				if (!validate_face(face))
 				{
 					LL_ERRS() << "Invalid face generated during LOD generation." << LL_ENDL;
 				}
 			}
 
-			//blind copy skin weights and just take closest skin weight to point on
-			//decimated mesh for now (auto-generating LODs with skin weights is still a bit
-			//of an open problem).
-			target_model->mPosition = base->mPosition;
-			target_model->mSkinWeights = base->mSkinWeights;
-			target_model->mSkinInfo = base->mSkinInfo;
-			//copy material list
-			target_model->mMaterialList = base->mMaterialList;
-
 			if (!validate_model(target_model))
 			{
 				LL_ERRS() << "Invalid model generated when creating LODs" << LL_ENDL;
 			}
-
-			delete [] sizes;
-			delete [] names;
 		}
 
 		//rebuild scene based on mBaseScene
@@ -2712,13 +2556,6 @@ void LLModelPreview::genLODs(S32 which_lod, U32 decimation, bool enforce_tri_lim
 	}
 
 	mResourceCost = calcResourceCost();
-
-	LLVertexBuffer::unbind();
-	LLGLSLShader::sNoFixedFunction = no_ff;
-	if (shader)
-	{
-		shader->bind();
-	}
 }
 
 void LLModelPreview::updateStatusMessages()
@@ -284,7 +284,6 @@ public:
 	void clearIncompatible(S32 lod);
 	void updateStatusMessages();
 	void updateLodControls(S32 lod);
-	void clearGLODGroup();
 	void onLODParamCommit(S32 lod, bool enforce_tri_limit);
 	void addEmptyFace( LLModel* pTarget );
 	
@@ -363,19 +362,11 @@ private:
 
 	std::map<std::string, bool> mViewOption;
 
-	//GLOD object parameters (must rebuild object if these change)
+	//LOD generation parameters last requested for each LOD
 	bool mLODFrozen;
-	F32 mBuildShareTolerance;
-	U32 mBuildQueueMode;
-	U32 mBuildOperator;
-	U32 mBuildBorderMode;
 	U32 mRequestedLoDMode[LLModel::NUM_LODS];
 	S32 mRequestedTriangleCount[LLModel::NUM_LODS];
 	F32 mRequestedErrorThreshold[LLModel::NUM_LODS];
-	U32 mRequestedBuildOperator[LLModel::NUM_LODS];
-	U32 mRequestedQueueMode[LLModel::NUM_LODS];
-	U32 mRequestedBorderMode[LLModel::NUM_LODS];
-	F32 mRequestedShareTolerance[LLModel::NUM_LODS];
 	F32 mRequestedCreaseAngle[LLModel::NUM_LODS];
 
 	LLModelLoader* mModelLoader;
@@ -392,8 +383,6 @@ private:
 	vv_LLVolumeFace_t mModelFacesCopy[LLModel::NUM_LODS];
 	vv_LLVolumeFace_t mBaseModelFacesCopy;
 
-	U32 mGroup;
-	std::map<LLPointer<LLModel>, U32> mObject;
 	U32 mMaxTriangleLimit;
 	
 	LLMeshUploadThread::instance_list mUploadData;
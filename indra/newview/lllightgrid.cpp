@@ -0,0 +1,204 @@
+/**
+ * @file lllightgrid.cpp
+ * @brief Static lights bucketed by position for nearest light queries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lllightgrid.h"
+
+#include "llmath.h"
+
+#include <algorithm>
+
+LLLightGrid::LLLightGrid(F32 cell_size)
+:	mCellSize(llmax(cell_size, 1.f))
+{
+}
+
+S32 LLLightGrid::getCellIndex(F32 coord) const
+{
+	return llfloor(coord / mCellSize);
+}
+
+LLLightGrid::cell_key_t LLLightGrid::getCellKey(S32 x, S32 y) const
+{
+	return ((cell_key_t)(U32)x << 32) | (U32)y;
+}
+
+// Horizontal distance from position to the nearest point of the cell
+F32 LLLightGrid::getCellDistance(cell_key_t key, const LLVector3& position) const
+{
+	F32 min_x = (F32)(S32)(U32)(key >> 32) * mCellSize;
+	F32 min_y = (F32)(S32)(U32)(key & 0xffffffff) * mCellSize;
+	F32 dx = llmax(min_x - position.mV[VX], 0.f, position.mV[VX] - (min_x + mCellSize));
+	F32 dy = llmax(min_y - position.mV[VY], 0.f, position.mV[VY] - (min_y + mCellSize));
+	return sqrtf(dx * dx + dy * dy);
+}
+
+void LLLightGrid::update(LLDrawable* light, const LLVector3& position)
+{
+	cell_key_t key = getCellKey(getCellIndex(position.mV[VX]), getCellIndex(position.mV[VY]));
+
+	entry_map_t::iterator iter = mEntries.find(light);
+	if (iter != mEntries.end())
+	{
+		if (iter->second.mCell == key)
+		{
+			iter->second.mPosition = position;
+			return;
+		}
+		remove(light);
+	}
+
+	Entry& entry = mEntries[light];
+	entry.mCell = key;
+	entry.mPosition = position;
+	mCells[key].push_back(light);
+}
+
+void LLLightGrid::remove(LLDrawable* light)
+{
+	entry_map_t::iterator entry = mEntries.find(light);
+	if (entry == mEntries.end())
+	{
+		return;
+	}
+
+	cell_map_t::iterator cell = mCells.find(entry->second.mCell);
+	llassert(cell != mCells.end());
+	if (cell != mCells.end())
+	{
+		light_list_t& lights = cell->second;
+		light_list_t::iterator iter = std::find(lights.begin(), lights.end(), light);
+		if (iter != lights.end())
+		{
+			*iter = lights.back();
+			lights.pop_back();
+		}
+		if (lights.empty())
+		{
+			mCells.erase(cell);
+		}
+	}
+	mEntries.erase(entry);
+}
+
+bool LLLightGrid::contains(LLDrawable* light) const
+{
+	return mEntries.find(light) != mEntries.end();
+}
+
+void LLLightGrid::clear()
+{
+	mCells.clear();
+	mEntries.clear();
+}
+
+void LLLightGrid::shift(const LLVector3& offset)
+{
+	std::vector<std::pair<LLDrawable*, LLVector3> > lights;
+	lights.reserve(mEntries.size());
+	for (entry_map_t::const_iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		lights.push_back(std::make_pair(iter->first, iter->second.mPosition + offset));
+	}
+
+	clear();
+	for (U32 i = 0; i < lights.size(); ++i)
+	{
+		update(lights[i].first, lights[i].second);
+	}
+}
+
+void LLLightGrid::getCells(const LLVector3& position, F32 range, std::vector<CellDistance>& cells) const
+{
+	S32 min_x = getCellIndex(position.mV[VX] - range);
+	S32 max_x = getCellIndex(position.mV[VX] + range);
+	S32 min_y = getCellIndex(position.mV[VY] - range);
+	S32 max_y = getCellIndex(position.mV[VY] + range);
+
+	CellDistance cell;
+	if ((F64)(max_x - min_x + 1) * (F64)(max_y - min_y + 1) > (F64)mCells.size())
+	{
+		// fewer cells hold lights than the range covers
+		for (cell_map_t::const_iterator iter = mCells.begin(); iter != mCells.end(); ++iter)
+		{
+			cell.mDistance = getCellDistance(iter->first, position);
+			if (cell.mDistance <= range)
+			{
+				cell.mKey = iter->first;
+				cell.mLights = &iter->second;
+				cells.push_back(cell);
+			}
+		}
+		return;
+	}
+
+	for (S32 x = min_x; x <= max_x; ++x)
+	{
+		for (S32 y = min_y; y <= max_y; ++y)
+		{
+			cell.mKey = getCellKey(x, y);
+			cell_map_t::const_iterator iter = mCells.find(cell.mKey);
+			if (iter == mCells.end())
+			{
+				continue;
+			}
+			cell.mDistance = getCellDistance(cell.mKey, position);
+			if (cell.mDistance <= range)
+			{
+				cell.mLights = &iter->second;
+				cells.push_back(cell);
+			}
+		}
+	}
+}
+
+void LLLightGrid::visitNearest(const LLVector3& position, F32 range, Visitor& visitor) const
+{
+	std::vector<CellDistance> cells;
+	getCells(position, range, cells);
+	std::sort(cells.begin(), cells.end());
+
+	for (U32 i = 0; i < cells.size() && cells[i].mDistance <= range; ++i)
+	{
+		const light_list_t& lights = *cells[i].mLights;
+		for (U32 j = 0; j < lights.size(); ++j)
+		{
+			range = visitor.visit(lights[j], range);
+		}
+	}
+}
+
+void LLLightGrid::getLightsInRange(const LLVector3& position, F32 range, std::vector<LLDrawable*>& lights) const
+{
+	std::vector<CellDistance> cells;
+	getCells(position, range, cells);
+	for (U32 i = 0; i < cells.size(); ++i)
+	{
+		lights.insert(lights.end(), cells[i].mLights->begin(), cells[i].mLights->end());
+	}
+}
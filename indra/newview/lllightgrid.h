@@ -0,0 +1,115 @@
+/**
+ * @file lllightgrid.h
+ * @brief Static lights bucketed by position for nearest light queries
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLLIGHTGRID_H
+#define LL_LLLIGHTGRID_H
+
+#include "v3math.h"
+
+#include <boost/unordered_map.hpp>
+#include <vector>
+
+class LLDrawable;
+
+// Lights kept in columns of a horizontal grid by agent position, so that
+// the lights near the camera are found without looking at every light in
+// the scene. The grid only keeps pointers and positions, it never looks at
+// the drawables. Whoever adds a light updates it when the light moves and
+// removes it before the drawable goes away.
+class LLLightGrid
+{
+public:
+	// Handed the lights of each cell that reaches the query position,
+	// nearest cells first
+	class Visitor
+	{
+	public:
+		virtual ~Visitor() {}
+
+		// Returns how far from the query position lights are still wanted.
+		// Returning less than range stops the query sooner.
+		virtual F32 visit(LLDrawable* light, F32 range) = 0;
+	};
+
+	LLLightGrid(F32 cell_size = 32.f);
+
+	// Adds the light, or moves it if it is already in the grid
+	void update(LLDrawable* light, const LLVector3& position);
+	void remove(LLDrawable* light);
+	bool contains(LLDrawable* light) const;
+	void clear();
+
+	// Moves every light by offset, for region crossings
+	void shift(const LLVector3& offset);
+
+	U32 getLightCount() const { return mEntries.size(); }
+	U32 getCellCount() const { return mCells.size(); }
+
+	// Visits the lights of the cells within range of position, horizontally,
+	// until the nearest cell left is out of the range the visitor returns
+	void visitNearest(const LLVector3& position, F32 range, Visitor& visitor) const;
+
+	// Appends the lights of the cells within range of position. Lights of
+	// those cells that are out of range are appended too.
+	void getLightsInRange(const LLVector3& position, F32 range, std::vector<LLDrawable*>& lights) const;
+
+private:
+	typedef U64 cell_key_t;
+	typedef std::vector<LLDrawable*> light_list_t;
+
+	struct Entry
+	{
+		cell_key_t	mCell;
+		LLVector3	mPosition;
+	};
+
+	struct CellDistance
+	{
+		F32					mDistance;
+		cell_key_t			mKey;
+		const light_list_t*	mLights;
+
+		bool operator<(const CellDistance& other) const
+		{
+			return mDistance < other.mDistance || (mDistance == other.mDistance && mKey < other.mKey);
+		}
+	};
+
+	S32 getCellIndex(F32 coord) const;
+	cell_key_t getCellKey(S32 x, S32 y) const;
+	F32 getCellDistance(cell_key_t key, const LLVector3& position) const;
+	void getCells(const LLVector3& position, F32 range, std::vector<CellDistance>& cells) const;
+
+	typedef boost::unordered_map<cell_key_t, light_list_t> cell_map_t;
+	typedef boost::unordered_map<LLDrawable*, Entry> entry_map_t;
+
+	F32			mCellSize;
+	cell_map_t	mCells;
+	entry_map_t	mEntries;
+};
+
+#endif // LL_LLLIGHTGRID_H
@@ -3078,18 +3078,30 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 				goto common_exit;
 			}
 			
-			// *TODO: Try to get rid of data copying and add interfaces
-			// that support BufferArray directly.  Introduce a two-phase
-			// handler, optional first that takes a body, fallback second
-			// that requires a temporary allocation and data copy.
+			// Take the body over when it arrived in a single block
+			// and all of it is wanted.  Otherwise copy the part we
+			// need.
 			body_offset = mOffset - offset;
-			data = new(std::nothrow) U8[data_size - body_offset];
-			if (data)
+			if (! body_offset)
 			{
-				body->read(body_offset, (char *) data, data_size - body_offset);
-				LLMeshRepository::sBytesReceived += data_size;
+				size_t detached_size(0);
+				data = (U8 *) body->detachData(&detached_size);
+				if (data)
+				{
+					llassert_always(S32(detached_size) == data_size);
+					LLMeshRepository::sBytesReceived += data_size;
+				}
 			}
-			else
+			if (! data)
+			{
+				data = (U8 *) ll_aligned_malloc_16(data_size - body_offset);
+				if (data)
+				{
+					body->read(body_offset, (char *) data, data_size - body_offset);
+					LLMeshRepository::sBytesReceived += data_size;
+				}
+			}
+			if (! data)
 			{
 				LL_WARNS(LOG_MESH) << "Failed to allocate " << data_size - body_offset << " memory for mesh response" << LL_ENDL;
 				processFailure(LLCore::HttpStatus(LLCore::HttpStatus::LLCORE, LLCore::HE_BAD_ALLOC));
@@ -3098,7 +3110,7 @@ void LLMeshHandlerBase::onCompleted(LLCore::HttpHandle handle, LLCore::HttpRespo
 
 		processData(body, body_offset, data, data_size - body_offset);
 
-		delete [] data;
+		ll_aligned_free_16(data);
 	}
 
 	// Release handler
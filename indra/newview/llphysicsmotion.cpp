@@ -151,7 +151,7 @@ protected:
 				const controller_map_t::const_iterator& entry = mParamControllers.find(controller_key[param]);
                 if (entry == mParamControllers.end())
                 {
-                        return sDefaultController[controller_key[param]];
+                        return getDefaultValue(controller_key[param]);
                 }
                 const std::string& param_name = (*entry).second.c_str();
                 mParamCache[param] = mCharacter->getVisualParam(param_name.c_str());
@@ -163,10 +163,17 @@ protected:
 			}
 			else
 			{
-				return sDefaultController[controller_key[param]];
+				return getDefaultValue(controller_key[param]);
 			}
 		}
 
+
+		// avatars may be animated on several threads, so no inserting here
+		static F32 getDefaultValue(const std::string& key)
+		{
+			default_controller_map_t::const_iterator found = sDefaultController.find(key);
+			return found != sDefaultController.end() ? found->second : 0.f;
+		}
         
         void setParamValue(const LLViewerVisualParam *param,
                            const F32 new_value_local,
@@ -235,7 +242,8 @@ BOOL LLPhysicsMotion::initialize()
 
 LLPhysicsMotionController::LLPhysicsMotionController(const LLUUID &id) : 
         LLMotion(id),
-        mCharacter(NULL)
+        mCharacter(NULL),
+        mAvatarPhysics(gSavedSettings, "AvatarPhysics", true)
 {
         mName = "breast_motion";
 }
@@ -454,7 +462,7 @@ F32 LLPhysicsMotion::calculateAcceleration_local(const F32 velocity_local, const
 BOOL LLPhysicsMotionController::onUpdate(F32 time, U8* joint_mask)
 {
         // Skip if disabled globally.
-        if (!gSavedSettings.getBOOL("AvatarPhysics"))
+        if (!mAvatarPhysics)
         {
                 return TRUE;
         }
@@ -468,8 +476,9 @@ BOOL LLPhysicsMotionController::onUpdate(F32 time, U8* joint_mask)
                 update_visuals |= motion->onUpdate(time);
         }
                 
+        // onUpdate() may run on a worker thread, see LLMotionController::evaluateMotions()
         if (update_visuals)
-                mCharacter->updateVisualParams();
+                mCharacter->getMotionController().requestVisualParamsUpdate();
         
         return TRUE;
 }
@@ -163,18 +163,78 @@ void LLScriptEditor::updateSegments()
 		LL_RECORD_BLOCK_TIME(FTM_SYNTAX_HIGHLIGHTING);
 		// HACK:  No non-ascii keywords for now
 		segment_vec_t segment_list;
-		mKeywords.findSegments(&segment_list, getWText(), mDefaultColor.get(), *this);
+		mKeywords.updateSegments(&segment_list, getWText(), mReflowIndex, mReflowCleanTail, mDefaultColor.get(), *this);
 		
-		clearSegments();
-		for (segment_vec_t::iterator list_it = segment_list.begin(); list_it != segment_list.end(); ++list_it)
-		{
-			insertSegment(*list_it);
-		}
+		replaceSegments(segment_list);
+	}
+	else if (mReflowIndex < S32_MAX)
+	{
+		// text changed without being highlighted, cached lexer state is stale
+		mKeywords.clearLineCache();
 	}
 	
 	LLTextBase::updateSegments();
 }
 
+// Swap in the re-highlighted segments for the range of text they cover,
+// leaving segments outside that range alone.
+void LLScriptEditor::replaceSegments(const segment_vec_t& segment_list)
+{
+	if (segment_list.empty())
+	{
+		return;
+	}
+
+	S32 start = segment_list.front()->getStart();
+	S32 end = segment_list.back()->getEnd();
+
+	segment_set_t::iterator seg_iter = getSegIterContaining(start);
+	while (seg_iter != mSegments.end())
+	{
+		LLTextSegmentPtr segmentp = *seg_iter;
+		if (segmentp->getStart() >= end)
+		{
+			break;
+		}
+
+		if (segmentp->getStart() < start)
+		{
+			if (segmentp->getEnd() > end)
+			{
+				// old segment spans the whole range, keep its head and tail
+				LLTextSegmentPtr remainder_segment = new LLNormalTextSegment(segmentp->getStyle(), end, segmentp->getEnd(), *this);
+				segmentp->setEnd(start);
+				mSegments.insert(remainder_segment);
+				remainder_segment->linkToDocument(this);
+				break;
+			}
+			// truncate segment running into the range
+			segmentp->setEnd(start);
+			++seg_iter;
+		}
+		else if (segmentp->getEnd() > end)
+		{
+			// clip segment running out of the range
+			segmentp->setStart(end);
+			break;
+		}
+		else
+		{
+			segmentp->unlinkFromDocument(this);
+			mSegments.erase(seg_iter++);
+		}
+	}
+
+	for (segment_vec_t::const_iterator list_it = segment_list.begin(); list_it != segment_list.end(); ++list_it)
+	{
+		mSegments.insert(*list_it);
+		(*list_it)->linkToDocument(this);
+	}
+
+	// only the re-highlighted lines need to be laid out again
+	needsReflowRange(start, end);
+}
+
 void LLScriptEditor::clearSegments()
 {
 	if (!mSegments.empty())
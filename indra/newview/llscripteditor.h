@@ -59,6 +59,7 @@ protected:
 private:
 	void	drawLineNumbers();
 	/* virtual */ void	updateSegments();
+	void	replaceSegments(const segment_vec_t& segment_list);
 	/* virtual */ void	drawSelectionBackground();
 	void	loadKeywords(const std::string& filename_keywords,
 						 const std::string& filename_colors);
@@ -138,8 +138,17 @@ void LLSkinningUtil::initSkinningMatrixPalette(
 #ifdef MAT_USE_SSE
             LLMatrix4a bind, world, res;
             bind.loadu(skin->mInvBindMatrix[j]);
-            world.loadu(joint->getWorldMatrix());
-            matMul(bind,world,res);
+            // straight from the flat skeleton when the joint is laid out there
+            const LLMatrix4a* flat_world = avatar->getFlatSkeleton().getWorldMatrix(joint);
+            if (flat_world)
+            {
+                matMul(bind,*flat_world,res);
+            }
+            else
+            {
+                world.loadu(joint->getWorldMatrix());
+                matMul(bind,world,res);
+            }
             memcpy(mat[j].mMatrix,res.mMatrix,16*sizeof(float));
 #else
             mat[j] = skin->mInvBindMatrix[j];
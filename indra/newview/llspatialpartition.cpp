@@ -1175,6 +1175,37 @@ public:
 	}
 };
 
+// Shadow cull of one frustum of LLSpatialPartition::cullShadows(). Points
+// the pipeline at its camera and result before each group it looks at.
+class LLOctreeCullShadowFrustum : public LLOctreeCullShadow
+{
+public:
+	LLOctreeCullShadowFrustum(const LLCullFrustum& frustum)
+		: LLOctreeCullShadow(frustum.mCamera),
+		  mFrustum(frustum) { }
+
+	virtual bool earlyFail(LLViewerOctreeGroup* group)
+	{
+		select();
+		return LLOctreeCullShadow::earlyFail(group);
+	}
+
+	virtual void visit(const OctreeNode* branch)
+	{
+		select();
+		LLOctreeCullShadow::visit(branch);
+	}
+
+private:
+	void select()
+	{
+		gPipeline.grabReferences(*mFrustum.mResult);
+		LLViewerCamera::sCurCameraID = mFrustum.mCameraID;
+	}
+
+	LLCullFrustum mFrustum;
+};
+
 class LLOctreeCullVisExtents: public LLOctreeCullShadow
 {
 public:
@@ -1558,6 +1589,26 @@ S32 LLSpatialPartition::cull(LLCamera &camera, bool do_occlusion)
 	return 0;
 }
 
+void LLSpatialPartition::cullShadows(const std::vector<LLCullFrustum>& frustums)
+{
+	{
+		LL_RECORD_BLOCK_TIME(FTM_CULL_REBOUND);		
+		LLSpatialGroup* group = (LLSpatialGroup*) mOctree->getListener(0);
+		group->rebound();
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_FRUSTUM_CULL);
+	std::vector<LLOctreeCullShadowFrustum> cullers(frustums.begin(), frustums.end());
+	std::vector<LLViewerOctreeCull*> culler_ptrs;
+	for (U32 i = 0; i < cullers.size(); ++i)
+	{
+		culler_ptrs.push_back(&cullers[i]);
+	}
+
+	LLViewerOctreeMultiCull culler(culler_ptrs);
+	culler.traverse(mOctree);
+}
+
 void pushVerts(LLDrawInfo* params, U32 mask)
 {
 	LLRenderPass::applyModelMatrix(*params);
@@ -52,6 +52,16 @@ class LLSpatialGroup;
 class LLTextureAtlas;
 class LLTextureAtlasSlot;
 class LLViewerRegion;
+class LLCullResult;
+
+// A shadow camera culled along with others in one walk of the octree, and
+// the result its visible groups go to
+struct LLCullFrustum
+{
+	LLCamera*					mCamera;
+	LLCullResult*				mResult;
+	LLViewerCamera::eCameraID	mCameraID;
+};
 
 void pushVerts(LLFace* face, U32 mask);
 
@@ -410,6 +420,7 @@ public:
 	BOOL visibleObjectsInFrustum(LLCamera& camera);
 	/*virtual*/ S32 cull(LLCamera &camera, bool do_occlusion=false); // Cull on arbitrary frustum
 	S32 cull(LLCamera &camera, std::vector<LLDrawable *>* results, BOOL for_select); // Cull on arbitrary frustum
+	void cullShadows(const std::vector<LLCullFrustum>& frustums); // Shadow cull on several frustums at once
 	
 	BOOL isVisible(const LLVector3& v);
 	bool isHUDPartition() ;
@@ -38,6 +38,7 @@
 
 #include "llviewermedia_streamingaudio.h"
 #include "llaudioengine.h"
+#include "llaudiodecodemgr.h"
 
 #ifdef LL_FMODSTUDIO
 # include "llaudioengine_fmodstudio.h"
@@ -654,6 +655,8 @@ bool idle_startup()
 				if(init)
 				{
 					gAudiop->setMuted(TRUE);
+					gAudioDecodeMgrp->setMemoryBudget((S64)gSavedSettings.getU32("AudioDecodeMemoryMB") * 1024 * 1024);
+					gAudioDecodeMgrp->setDiskCache(gSavedSettings.getBOOL("AudioDecodeDiskCache"));
 				}
 				else
 				{
@@ -46,6 +46,8 @@
 //  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
 // cache/textures/[0-F]/UUID.texture
 //  Actual texture body files
+// cache/textures/decoded/UUID.raw
+//  Decoded images, when TextureDecodedCacheSize is not 0
 
 //note: there is no good to define 1024 for TEXTURE_CACHE_ENTRY_SIZE while FIRST_PACKET_SIZE is 600 on sim side.
 const S32 TEXTURE_CACHE_ENTRY_SIZE = FIRST_PACKET_SIZE;//1024;
@@ -315,6 +317,70 @@ private:
 };
 
 
+// Reads and writes the decoded tier, so that its file I/O stays on this
+// thread like the rest of the cache
+class LLTextureCacheDecodedWorker : public LLTextureCacheWorker
+{
+public:
+	LLTextureCacheDecodedWorker(LLTextureCache* cache, U32 priority, const LLUUID& id,
+								LLPointer<LLImageRaw> raw, S32 discardlevel,
+								LLTextureCache::Responder* responder)
+			: LLTextureCacheWorker(cache, priority, id, NULL, 0, 0, 0, responder),
+			mRawImage(raw),
+			mRawDiscardLevel(discardlevel),
+			mSuccess(false)
+	{
+	}
+
+	virtual bool doRead();
+	virtual bool doWrite();
+
+private:
+	virtual void finishWork(S32 param, bool completed);
+
+	LLPointer<LLImageRaw> mRawImage;
+	S32 mRawDiscardLevel;
+	bool mSuccess;
+};
+
+bool LLTextureCacheDecodedWorker::doRead()
+{
+	S32 discard = -1;
+	mRawImage = mCache->mDecodedCache.read(mID, mRawDiscardLevel, discard);
+	if (mRawImage.notNull() && discard < mRawDiscardLevel)
+	{
+		// Sharper than asked for, don't upload more than the decoder would have produced
+		S32 shift = mRawDiscardLevel - discard;
+		S32 width = llmax(mRawImage->getWidth() >> shift, 1);
+		S32 height = llmax(mRawImage->getHeight() >> shift, 1);
+		mRawImage->scale(width, height);
+	}
+	mSuccess = mRawImage.notNull();
+	return true;
+}
+
+bool LLTextureCacheDecodedWorker::doWrite()
+{
+	mSuccess = mCache->mDecodedCache.write(mID, mRawImage, mRawDiscardLevel);
+	return true;
+}
+
+//virtual (WORKER THREAD)
+void LLTextureCacheDecodedWorker::finishWork(S32 param, bool completed)
+{
+	if (mResponder.notNull())
+	{
+		bool success = completed && mSuccess;
+		if (param == 0 && success)
+		{
+			// read
+			((LLTextureCache::DecodedReadResponder*)mResponder.get())->setImage(mRawImage, mRawDiscardLevel);
+		}
+		mCache->addCompleted(mResponder, success);
+	}
+	mRawImage = NULL;
+}
+
 //virtual
 void LLTextureCacheWorker::startWork(S32 param)
 {
@@ -990,6 +1056,7 @@ const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
 const char* textures_dirname = "texturecache";
 const char* fast_cache_filename = "FastCache.cache";
+const char* decoded_dirname = "decoded";
 
 void LLTextureCache::setDirNames(ELLPath location)
 {
@@ -999,6 +1066,7 @@ void LLTextureCache::setDirNames(ELLPath location)
 	mHeaderDataFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, cache_filename);
 	mTexturesDirName = gDirUtilp->getExpandedFilename(location, textures_dirname);
 	mFastCacheFileName =  gDirUtilp->getExpandedFilename(location, textures_dirname, fast_cache_filename);
+	mDecodedCacheDirName = gDirUtilp->getExpandedFilename(location, textures_dirname, decoded_dirname);
 }
 
 void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
@@ -1087,6 +1155,13 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, BOOL texture_cache
 	llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
 	openFastCache(true);
 
+	if (!mReadOnly)
+	{
+		// The decoded tier has its own budget on top of the cache size
+		S64 decoded_size = (S64)gSavedSettings.getU32("TextureDecodedCacheSize") * 1024 * 1024;
+		mDecodedCache.open(mDecodedCacheDirName, decoded_size);
+	}
+
 	return max_size; // unused cache space
 }
 
@@ -1653,12 +1728,15 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
 				gDirUtilp->deleteFilesInDir(dirname, mask);
 			}
 		}
+		gDirUtilp->deleteFilesInDir(mDecodedCacheDirName, mask); // decoded images and their index
 		gDirUtilp->deleteFilesInDir(mTexturesDirName, mask); // headers, fast cache
 		if (purge_directories)
 		{
+			LLFile::rmdir(mDecodedCacheDirName);
 			LLFile::rmdir(mTexturesDirName);
 		}
 	}
+	mDecodedCache.purge();
 	mHeaderIDMap.clear();
 	mTexturesSizeMap.clear();
 	mTexturesSizeTotal = 0;
@@ -2087,6 +2165,34 @@ LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& d
 	return raw;
 }
 
+//called in the texture fetch thread
+LLTextureCache::handle_t LLTextureCache::readFromDecodedCache(const LLUUID& id, U32 priority, S32 discardlevel,
+															  DecodedReadResponder* responder)
+{
+	LLMutexLock lock(&mWorkersMutex);
+	LLTextureCacheWorker* worker = new LLTextureCacheDecodedWorker(this, priority, id, NULL, discardlevel, responder);
+	handle_t handle = worker->read();
+	mReaders[handle] = worker;
+	return handle;
+}
+
+//called in the texture fetch thread
+LLTextureCache::handle_t LLTextureCache::writeToDecodedCache(const LLUUID& id, U32 priority,
+															 LLPointer<LLImageRaw> raw, S32 discardlevel,
+															 WriteResponder* responder)
+{
+	if (mReadOnly)
+	{
+		delete responder;
+		return LLWorkerThread::nullHandle();
+	}
+	LLMutexLock lock(&mWorkersMutex);
+	LLTextureCacheWorker* worker = new LLTextureCacheDecodedWorker(this, priority, id, raw, discardlevel, responder);
+	handle_t handle = worker->write();
+	mWriters[handle] = worker;
+	return handle;
+}
+
 #if LL_WINDOWS
 
 static const U32 STATUS_MSC_EXCEPTION = 0xE06D7363; // compiler specific
@@ -2379,6 +2485,8 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
 		}
 
 		unlockHeaders() ;
+
+		mDecodedCache.remove(id);
 	}
 	return ret ;
 }
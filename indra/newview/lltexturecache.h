@@ -34,6 +34,8 @@
 
 #include "llworkerthread.h"
 
+#include "lldecodedtexturecache.h"
+
 class LLImageFormatted;
 class LLTextureCacheWorker;
 class LLImageRaw;
@@ -43,6 +45,7 @@ class LLTextureCache : public LLWorkerThread
 	friend class LLTextureCacheWorker;
 	friend class LLTextureCacheRemoteWorker;
 	friend class LLTextureCacheLocalFileWorker;
+	friend class LLTextureCacheDecodedWorker;
 
 private:
 
@@ -109,6 +112,20 @@ public:
 			// not used
 		}
 	};
+
+	class DecodedReadResponder : public Responder
+	{
+	public:
+		DecodedReadResponder() : mDiscardLevel(-1) {}
+		void setData(U8* data, S32 datasize, S32 imagesize, S32 imageformat, BOOL imagelocal)
+		{
+			// not used
+		}
+		void setImage(LLImageRaw* raw, S32 discardlevel) { mRawImage = raw; mDiscardLevel = discardlevel; }
+	protected:
+		LLPointer<LLImageRaw> mRawImage;
+		S32 mDiscardLevel;
+	};
 	
 	LLTextureCache(bool threaded);
 	~LLTextureCache();
@@ -128,6 +145,14 @@ public:
 	handle_t writeToCache(const LLUUID& id, U32 priority, U8* data, S32 datasize, S32 imagesize, LLPointer<LLImageRaw> rawimage, S32 discardlevel,
 						  WriteResponder* responder);
 	LLPointer<LLImageRaw> readFromFastCache(const LLUUID& id, S32& discardlevel);
+	// Decoded tier. Reads only find images decoded at discardlevel or sharper, and
+	// scale those down to discardlevel. Complete them with readComplete() and
+	// writeComplete(), raw must not change until the write is complete.
+	handle_t readFromDecodedCache(const LLUUID& id, U32 priority, S32 discardlevel,
+								  DecodedReadResponder* responder);
+	handle_t writeToDecodedCache(const LLUUID& id, U32 priority, LLPointer<LLImageRaw> raw, S32 discardlevel,
+								 WriteResponder* responder);
+	bool useDecodedCache() const { return mDecodedCache.isOpen(); }
 	bool writeComplete(handle_t handle, bool abort = false);
 	void prioritizeWrite(handle_t handle);
 
@@ -230,6 +255,10 @@ private:
 	LLFrameTimer mFastCacheTimer;
 	U8*          mFastCachePadBuffer;
 
+	// DECODED (raw images ready for upload, see LLDecodedTextureCache)
+	std::string mDecodedCacheDirName;
+	LLDecodedTextureCache mDecodedCache;
+
 	// BODIES (TEXTURES minus headers)
 	std::string mTexturesDirName;
 	typedef std::map<LLUUID,S32> size_map_t;
@@ -66,6 +66,7 @@ bool LLTextureFetchDebugger::sDebuggerEnabled = false ;
 
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheHit("texture_cache_hit");
 LLTrace::CountStatHandle<F64> LLTextureFetch::sCacheAttempt("texture_cache_attempt");
+LLTrace::CountStatHandle<F64> LLTextureFetch::sDecodedCacheHit("texture_decoded_cache_hit");
 LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > LLTextureFetch::sCacheHitRate("texture_cache_hits");
 
 LLTrace::SampleStatHandle<F32Seconds> LLTextureFetch::sCacheReadLatency("texture_cache_read_latency");
@@ -349,6 +350,54 @@ private:
 		LLUUID mID;
 	};
 	
+	class DecodedCacheReadResponder : public LLTextureCache::DecodedReadResponder
+	{
+	public:
+
+		// Threads:  Ttf
+		DecodedCacheReadResponder(LLTextureFetch* fetcher, const LLUUID& id)
+			: mFetcher(fetcher), mID(id)
+		{
+		}
+
+		// Threads:  Ttc
+		virtual void completed(bool success)
+		{
+			LLTextureFetchWorker* worker = mFetcher->getWorker(mID);
+			if (worker)
+			{
+				worker->callbackDecodedCacheRead(success, mRawImage, mDiscardLevel);
+			}
+		}
+	private:
+		LLTextureFetch* mFetcher;
+		LLUUID mID;
+	};
+
+	class DecodedCacheWriteResponder : public LLTextureCache::WriteResponder
+	{
+	public:
+
+		// Threads:  Ttf
+		DecodedCacheWriteResponder(LLTextureFetch* fetcher, const LLUUID& id)
+			: mFetcher(fetcher), mID(id)
+		{
+		}
+
+		// Threads:  Ttc
+		virtual void completed(bool success)
+		{
+			LLTextureFetchWorker* worker = mFetcher->getWorker(mID);
+			if (worker)
+			{
+				worker->callbackDecodedCacheWrite(success);
+			}
+		}
+	private:
+		LLTextureFetch* mFetcher;
+		LLUUID mID;
+	};
+
 	class DecodeResponder : public LLImageDecodeThread::Responder
 	{
 	public:
@@ -415,6 +464,12 @@ public:
 	// Threads:  Ttc
 	void callbackCacheWrite(bool success);
 
+	// Threads:  Ttc
+	void callbackDecodedCacheRead(bool success, LLImageRaw* raw, S32 discardlevel);
+
+	// Threads:  Ttc
+	void callbackDecodedCacheWrite(bool success);
+
 	// Threads:  Tid
 	void callbackDecoded(bool success, LLImageRaw* raw, LLImageRaw* aux);
 	
@@ -482,6 +537,11 @@ private:
 
 	// Threads:  Ttf
 	bool writeToCacheComplete();
+
+	// Threads:  Ttf
+	// Locks:  Mw
+	bool canUseDecodedCache() const;
+	void useDecodedCacheImage();
 	
 	// Threads:  Ttf
 	void recordTextureStart(bool is_http);
@@ -584,7 +644,8 @@ private:
     F32 mDecodeTime;    // time for decode only
     F32 mFetchTime;     // total time from req to finished fetch
 	LLTextureCache::handle_t    mCacheReadHandle,
-								mCacheWriteHandle;
+								mCacheWriteHandle,
+								mDecodedCacheWriteHandle;
 	S32                         mRequestedSize,
 								mRequestedOffset,
 								mDesiredSize,
@@ -595,6 +656,8 @@ private:
 	BOOL mLoaded;
 	BOOL mDecoded;
 	BOOL mWritten;
+	BOOL mDecodedCacheChecked;		// decoded tier looked up during this fetch
+	BOOL mReadingDecodedCache;		// mCacheReadHandle reads the decoded tier
 	BOOL mNeedsAux;
 	BOOL mHaveAllData;
 	BOOL mInLocalCache;
@@ -920,6 +983,7 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
       mFetchTime(0.f),
 	  mCacheReadHandle(LLTextureCache::nullHandle()),
 	  mCacheWriteHandle(LLTextureCache::nullHandle()),
+	  mDecodedCacheWriteHandle(LLTextureCache::nullHandle()),
 	  mRequestedSize(0),
 	  mRequestedOffset(0),
 	  mDesiredSize(TEXTURE_CACHE_ENTRY_SIZE),
@@ -930,6 +994,8 @@ LLTextureFetchWorker::LLTextureFetchWorker(LLTextureFetch* fetcher,
 	  mDecodeHandle(0),
 	  mDecoded(FALSE),
 	  mWritten(FALSE),
+	  mDecodedCacheChecked(FALSE),
+	  mReadingDecodedCache(FALSE),
 	  mNeedsAux(FALSE),
 	  mHaveAllData(FALSE),
 	  mInLocalCache(FALSE),
@@ -997,6 +1063,10 @@ LLTextureFetchWorker::~LLTextureFetchWorker()
 	{
 		mFetcher->mTextureCache->writeComplete(mCacheWriteHandle, true);
 	}
+	if (mDecodedCacheWriteHandle != LLTextureCache::nullHandle() && mFetcher->mTextureCache)
+	{
+		mFetcher->mTextureCache->writeComplete(mDecodedCacheWriteHandle, true);
+	}
 	mFormattedImage = NULL;
 	clearPackets();
 	if (mHttpBufferArray)
@@ -1196,6 +1266,8 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		mSentRequest = UNSENT;
 		mDecoded  = FALSE;
 		mWritten  = FALSE;
+		mDecodedCacheChecked = FALSE;
+		mReadingDecodedCache = FALSE;
 		if (mHttpBufferArray)
 		{
 			mHttpBufferArray->release();
@@ -1207,6 +1279,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		clearPackets(); // TODO: Shouldn't be necessary
 		mCacheReadHandle = LLTextureCache::nullHandle();
 		mCacheWriteHandle = LLTextureCache::nullHandle();
+		mDecodedCacheWriteHandle = LLTextureCache::nullHandle();
 		setState(LOAD_FROM_TEXTURE_CACHE);
 		mInCache = FALSE;
 		mDesiredSize = llmax(mDesiredSize, TEXTURE_CACHE_ENTRY_SIZE); // min desired size is TEXTURE_CACHE_ENTRY_SIZE
@@ -1250,9 +1323,21 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				setPriority(LLWorkerThread::PRIORITY_LOW | mWorkPriority); // Set priority first since Responder may change it
 
 				++mCacheReadCount;
-				CacheReadResponder* responder = new CacheReadResponder(mFetcher, mID, mFormattedImage);
-				mCacheReadHandle = mFetcher->mTextureCache->readFromCache(mID, cache_priority,
-																		  offset, size, responder);
+				if (offset == 0 && !mDecodedCacheChecked && mDesiredDiscard >= 0 && canUseDecodedCache())
+				{
+					// Look for an image ready for upload first, the J2C is read if there is none
+					mDecodedCacheChecked = TRUE;
+					mReadingDecodedCache = TRUE;
+					DecodedCacheReadResponder* responder = new DecodedCacheReadResponder(mFetcher, mID);
+					mCacheReadHandle = mFetcher->mTextureCache->readFromDecodedCache(mID, cache_priority,
+																					 mDesiredDiscard, responder);
+				}
+				else
+				{
+					CacheReadResponder* responder = new CacheReadResponder(mFetcher, mID, mFormattedImage);
+					mCacheReadHandle = mFetcher->mTextureCache->readFromCache(mID, cache_priority,
+																			  offset, size, responder);
+				}
 				mCacheReadTimer.reset();
 			}
 			else if(!mUrl.empty() && mCanUseHTTP)
@@ -1273,6 +1358,20 @@ bool LLTextureFetchWorker::doWork(S32 param)
 			if (mFetcher->mTextureCache->readComplete(mCacheReadHandle, false))
 			{
 				mCacheReadHandle = LLTextureCache::nullHandle();
+				if (mReadingDecodedCache)
+				{
+					mReadingDecodedCache = FALSE;
+					mLoaded = FALSE;
+					setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
+					if (mRawImage.notNull())
+					{
+						// Ready for upload, skip the J2C read and decode
+						useDecodedCacheImage();
+						setState(DONE);
+					}
+					// else read the J2C on the next pass
+					return false;
+				}
 				setState(CACHE_POST);
                 add(LLTextureFetch::sCacheHit, 1.0);
 				// fall through
@@ -1775,7 +1874,24 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mRequestedOffset += src_offset;
 			}
 
-			U8 * buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			U8 * buffer(NULL);
+			bool body_detached(false);
+			if (! cur_size && ! src_offset)
+			{
+				// Nothing to merge, take the body over if it arrived
+				// in a single block.
+				size_t detached_size(0);
+				buffer = (U8 *) mHttpBufferArray->detachData(&detached_size);
+				if (buffer)
+				{
+					llassert_always(S32(detached_size) == total_size);
+					body_detached = true;
+				}
+			}
+			if (! buffer)
+			{
+				buffer = (U8 *)ll_aligned_malloc_16(total_size);
+			}
 			if (!buffer)
 			{
 				// abort. If we have no space for packet, we have not enough space to decode image
@@ -1805,12 +1921,15 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mFileSize = total_size + 1 ; //flag the file is not fully loaded.
 			}
 
-			if (cur_size > 0)
+			if (! body_detached)
 			{
-				// Copy previously collected data into buffer
-				memcpy(buffer, mFormattedImage->getData(), cur_size);
+				if (cur_size > 0)
+				{
+					// Copy previously collected data into buffer
+					memcpy(buffer, mFormattedImage->getData(), cur_size);
+				}
+				mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
 			}
-			mHttpBufferArray->read(src_offset, (char *) buffer + cur_size, append_size);
 
 			// NOTE: setData releases current data and owns new data (buffer)
 			mFormattedImage->setData(buffer, total_size);
@@ -1938,6 +2057,15 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				llassert_always(mRawImage.notNull());
 				LL_DEBUGS(LOG_TXT) << mID << ": Decoded. Discard: " << mDecodedDiscard
 								   << " Raw Image: " << llformat("%dx%d",mRawImage->getWidth(),mRawImage->getHeight()) << LL_ENDL;
+				if (mDecodedDiscard <= mDesiredDiscard && canUseDecodedCache())
+				{
+					// Sharp enough for what was asked, keep it for the next visit.
+					// WAIT_ON_WRITE holds the image back until the write is done.
+					DecodedCacheWriteResponder* responder = new DecodedCacheWriteResponder(mFetcher, mID);
+					mDecodedCacheWriteHandle = mFetcher->mTextureCache->writeToDecodedCache(mID, mWorkPriority,
+																							mRawImage, mDecodedDiscard,
+																							responder);
+				}
 				setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
 				setState(WRITE_TO_CACHE);
 			}
@@ -1955,7 +2083,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		{
 			// If we're in a local cache or we didn't actually receive any new data,
 			// or we failed to load anything, skip
-			setState(DONE);
+			setState(mDecodedCacheWriteHandle != LLTextureCache::nullHandle() ? WAIT_ON_WRITE : DONE);
 			return false;
 		}
 		S32 datasize = mFormattedImage->getDataSize();
@@ -1992,7 +2120,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		}
 		else
 		{
-			if (mDesiredDiscard < mDecodedDiscard)
+			if (mDesiredDiscard < mDecodedDiscard && mCacheWriteHandle != LLTextureCache::nullHandle())
 			{
 				// We're waiting for this write to complete before we can receive more data
 				// (we can't touch mFormattedImage until the write completes)
@@ -2165,6 +2293,11 @@ void LLTextureFetchWorker::finishWork(S32 param, bool completed)
 		mFetcher->mTextureCache->writeComplete(mCacheWriteHandle, true);
 		mCacheWriteHandle = LLTextureCache::nullHandle();
 	}
+	if (mDecodedCacheWriteHandle != LLTextureCache::nullHandle())
+	{
+		mFetcher->mTextureCache->writeComplete(mDecodedCacheWriteHandle, true);
+		mDecodedCacheWriteHandle = LLTextureCache::nullHandle();
+	}
 }
 
 // LLQueuedThread's update() method is asking if it's okay to
@@ -2221,6 +2354,17 @@ bool LLTextureFetchWorker::deleteOK()
 			delete_ok = false;
 		}
 	}
+	if (mDecodedCacheWriteHandle != LLTextureCache::nullHandle())
+	{
+		if (mFetcher->mTextureCache->writeComplete(mDecodedCacheWriteHandle))
+		{
+			mDecodedCacheWriteHandle = LLTextureCache::nullHandle();
+		}
+		else
+		{
+			delete_ok = false;
+		}
+	}
 
 	if ((haveWork() &&
 		 // not ok to delete from these states
@@ -2335,9 +2479,8 @@ S32 LLTextureFetchWorker::callbackHttpGet(LLCore::HttpResponse * response,
 		if (data_size > 0)
 		{
 			LLViewerStatsRecorder::instance().textureFetch(data_size);
-			// *TODO: set the formatted image data here directly to avoid the copy
 
-			// Hold on to body for later copy
+			// Hold on to body, it's taken over or copied later
 			llassert_always(NULL == mHttpBufferArray);
 			body->addRef();
 			mHttpBufferArray = body;
@@ -2458,6 +2601,34 @@ void LLTextureFetchWorker::callbackCacheWrite(bool success)
 	setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
 }																		// -Mw
 
+// Threads:  Ttc
+void LLTextureFetchWorker::callbackDecodedCacheRead(bool success, LLImageRaw* raw, S32 discardlevel)
+{
+	LLMutexLock lock(&mWorkMutex);										// +Mw
+	if (mState != LOAD_FROM_TEXTURE_CACHE || !mReadingDecodedCache)
+	{
+		return;
+	}
+	if (success)
+	{
+		mRawImage = raw;
+		mDecodedDiscard = discardlevel;
+	}
+	mLoaded = TRUE;
+	setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
+}																		// -Mw
+
+// Threads:  Ttc
+void LLTextureFetchWorker::callbackDecodedCacheWrite(bool success)
+{
+	LLMutexLock lock(&mWorkMutex);										// +Mw
+	if (mState != WAIT_ON_WRITE)
+	{
+		return;
+	}
+	setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
+}																		// -Mw
+
 //////////////////////////////////////////////////////////////////////////////
 
 // Threads:  Tid
@@ -2519,9 +2690,47 @@ bool LLTextureFetchWorker::writeToCacheComplete()
 			return false;
 		}
 	}
+	if (mDecodedCacheWriteHandle != LLTextureCache::nullHandle())
+	{
+		if (mFetcher->mTextureCache->writeComplete(mDecodedCacheWriteHandle))
+		{
+			mDecodedCacheWriteHandle = LLTextureCache::nullHandle();
+		}
+		else
+		{
+			return false;
+		}
+	}
 	return true;
 }
 
+// Threads:  Ttf
+// Locks:  Mw
+bool LLTextureFetchWorker::canUseDecodedCache() const
+{
+	// Aux channels are not stored and local files are decoded every time
+	return !mNeedsAux && !mInLocalCache
+		&& (mFTType == FTT_DEFAULT || mFTType == FTT_SERVER_BAKE)
+		&& mUrl.compare(0, 7, "file://") != 0
+		&& mFetcher->mTextureCache->useDecodedCache();
+}
+
+// Threads:  Ttf
+// Locks:  Mw
+void LLTextureFetchWorker::useDecodedCacheImage()
+{
+	LL_DEBUGS(LOG_TXT) << mID << ": Loaded from decoded cache. Discard: " << mDecodedDiscard
+					   << " Raw Image: " << llformat("%dx%d", mRawImage->getWidth(), mRawImage->getHeight()) << LL_ENDL;
+	mAuxImage = NULL;
+	mLoadedDiscard = mDecodedDiscard;
+	mDecoded = TRUE;
+	mInCache = TRUE;
+	mWriteToCacheState = NOT_WRITE;
+	mDecodeTime = 0.f;
+	mCacheReadTime = mCacheReadTimer.getElapsedTimeF32();
+	add(LLTextureFetch::sDecodedCacheHit, 1.0);
+}
+
 
 // Threads:  Ttf
 void LLTextureFetchWorker::recordTextureStart(bool is_http)
@@ -3032,7 +3241,7 @@ S32 LLTextureFetch::getPending()
     {
         LLMutexLock lock(&mQueueMutex);									// +Mfq
         
-        res = mRequestQueue.size();
+        res = LLQueuedThread::getPending();
         res += mCommands.size();
     }																	// -Mfq
 	unlockData();														// -Ct
@@ -3060,7 +3269,7 @@ bool LLTextureFetch::runCondition()
 	}																	// -Mfq
 	
 	return ! (have_no_commands
-			  && (mRequestQueue.empty() && mIdleThread));		// From base class
+			  && (LLQueuedThread::getPending() == 0 && mIdleThread));		// From base class
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -3665,18 +3874,20 @@ S32 LLTextureFetch::getFetchState(const LLUUID& id, F32& data_progress_p, F32& r
 
 void LLTextureFetch::dump()
 {
+	// The request queue belongs to the worker thread, walk the fetch map instead
 	LL_INFOS(LOG_TXT) << "LLTextureFetch REQUESTS:" << LL_ENDL;
-	for (request_queue_t::iterator iter = mRequestQueue.begin();
-		 iter != mRequestQueue.end(); ++iter)
 	{
-		LLQueuedThread::QueuedRequest* qreq = *iter;
-		LLWorkerThread::WorkRequest* wreq = (LLWorkerThread::WorkRequest*)qreq;
-		LLTextureFetchWorker* worker = (LLTextureFetchWorker*)wreq->getWorkerClass();
-		LL_INFOS(LOG_TXT) << " ID: " << worker->mID
-						  << " PRI: " << llformat("0x%08x",wreq->getPriority())
-						  << " STATE: " << worker->sStateDescs[worker->mState]
-						  << LL_ENDL;
-	}
+		LLMutexLock lock(&mQueueMutex);									// +Mfq
+		for (map_t::iterator iter = mRequestMap.begin();
+			 iter != mRequestMap.end(); ++iter)
+		{
+			LLTextureFetchWorker* worker = iter->second;
+			LL_INFOS(LOG_TXT) << " ID: " << worker->mID
+							  << " PRI: " << llformat("0x%08x",worker->getPriority())
+							  << " STATE: " << worker->sStateDescs[worker->mState]
+							  << LL_ENDL;
+		}
+	}																	// -Mfq
 
 	LL_INFOS(LOG_TXT) << "LLTextureFetch ACTIVE_HTTP:" << LL_ENDL;
 	for (queue_t::const_iterator iter(mHTTPTextureQueue.begin());
@@ -309,6 +309,7 @@ public:
 	
     static LLTrace::CountStatHandle<F64>        sCacheHit;
     static LLTrace::CountStatHandle<F64>        sCacheAttempt;
+    static LLTrace::CountStatHandle<F64>        sDecodedCacheHit;
     static LLTrace::SampleStatHandle<F32Seconds> sCacheReadLatency;
     static LLTrace::SampleStatHandle<F32Seconds> sTexDecodeLatency;
     static LLTrace::SampleStatHandle<F32Seconds> sTexFetchLatency;
@@ -345,8 +346,8 @@ private:
 
 	// Out-of-band cross-thread command queue.  This command queue
 	// is logically tied to LLQueuedThread's list of
-	// QueuedRequest instances and so must be covered by the
-	// same locks.
+	// QueuedRequest instances and is counted along with it
+	// in getPending() and runCondition().
 	typedef std::vector<TFRequest *> command_queue_t;
 	command_queue_t mCommands;											// Mfq
 
@@ -49,6 +49,7 @@
 #include "llviewertexturelist.h"
 #include "llviewerthrottle.h"
 #include "llviewerwindow.h"
+#include "llpolymesh.h"
 #include "llvoavatarself.h"
 #include "llvoiceclient.h"
 #include "llvosky.h"
@@ -250,6 +251,24 @@ static bool handleAvatarPhysicsLODChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleAvatarFlatSkeletonChanged(const LLSD& newvalue)
+{
+	LLVOAvatar::sUseFlatSkeleton = newvalue.asBoolean();
+	return true;
+}
+
+static bool handleAvatarBatchedMorphsChanged(const LLSD& newvalue)
+{
+	LLPolyMesh::sBatchMorphs = newvalue.asBoolean();
+	return true;
+}
+
+static bool handleAvatarIncrementalComplexityChanged(const LLSD& newvalue)
+{
+	LLVOVolume::sCacheRenderCost = newvalue.asBoolean();
+	return true;
+}
+
 static bool handleTerrainLODChanged(const LLSD& newvalue)
 {
 		LLVOSurfacePatch::sLODFactor = (F32)newvalue.asReal();
@@ -272,6 +291,12 @@ static bool handleFlexLODChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleFlexBatchSimulationChanged(const LLSD& newvalue)
+{
+	LLVolumeImplFlexible::sBatchSimulation = newvalue.asBoolean();
+	return true;
+}
+
 static bool handleGammaChanged(const LLSD& newvalue)
 {
 	F32 gamma = (F32) newvalue.asReal();
@@ -639,9 +664,13 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderVolumeLODFactor")->getSignal()->connect(boost::bind(&handleVolumeLODChanged, _2));
 	gSavedSettings.getControl("RenderAvatarLODFactor")->getSignal()->connect(boost::bind(&handleAvatarLODChanged, _2));
 	gSavedSettings.getControl("RenderAvatarPhysicsLODFactor")->getSignal()->connect(boost::bind(&handleAvatarPhysicsLODChanged, _2));
+	gSavedSettings.getControl("AvatarFlatSkeleton")->getSignal()->connect(boost::bind(&handleAvatarFlatSkeletonChanged, _2));
+	gSavedSettings.getControl("AvatarBatchedMorphs")->getSignal()->connect(boost::bind(&handleAvatarBatchedMorphsChanged, _2));
+	gSavedSettings.getControl("AvatarIncrementalComplexity")->getSignal()->connect(boost::bind(&handleAvatarIncrementalComplexityChanged, _2));
 	gSavedSettings.getControl("RenderTerrainLODFactor")->getSignal()->connect(boost::bind(&handleTerrainLODChanged, _2));
 	gSavedSettings.getControl("RenderTreeLODFactor")->getSignal()->connect(boost::bind(&handleTreeLODChanged, _2));
 	gSavedSettings.getControl("RenderFlexTimeFactor")->getSignal()->connect(boost::bind(&handleFlexLODChanged, _2));
+	gSavedSettings.getControl("RenderFlexBatchSimulation")->getSignal()->connect(boost::bind(&handleFlexBatchSimulationChanged, _2));
 	gSavedSettings.getControl("RenderGamma")->getSignal()->connect(boost::bind(&handleGammaChanged, _2));
 	gSavedSettings.getControl("RenderFogRatio")->getSignal()->connect(boost::bind(&handleFogRatioChanged, _2));
 	gSavedSettings.getControl("RenderMaxPartCount")->getSignal()->connect(boost::bind(&handleMaxPartCountChanged, _2));
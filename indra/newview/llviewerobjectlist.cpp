@@ -939,6 +939,8 @@ void LLViewerObjectList::update(LLAgent &agent)
 				objectp->idleUpdate(agent, frame_time);
 			}
 		}
+
+		LLVOAvatar::updateQueuedAnimations();
 	}
 	else
 	{
@@ -950,6 +952,9 @@ void LLViewerObjectList::update(LLAgent &agent)
                 objectp->idleUpdate(agent, frame_time);
 		}
 
+		// animate the avatars queued by their idle updates
+		LLVOAvatar::updateQueuedAnimations();
+
 		//update flexible objects
 		LLVolumeImplFlexible::updateClass();
 
@@ -1517,6 +1517,82 @@ void LLViewerOctreeCull::visit(const OctreeNode* branch)
 	}
 }
 
+//-----------------------------------------------------------------------------------
+//class LLViewerOctreeMultiCull definitions
+//-----------------------------------------------------------------------------------
+LLViewerOctreeMultiCull::LLViewerOctreeMultiCull(const std::vector<LLViewerOctreeCull*>& cullers)
+	: mCullers(cullers)
+{
+	llassert(mCullers.size() <= MAX_CULLERS);
+	if (mCullers.size() > MAX_CULLERS)
+	{
+		mCullers.resize(MAX_CULLERS);
+	}
+	mInMask = mCullers.size() == MAX_CULLERS ? 0xffffffff : ((U32)1 << mCullers.size()) - 1;
+}
+
+//virtual 
+void LLViewerOctreeMultiCull::traverse(const OctreeNode* n)
+{
+	LLViewerOctreeGroup* group = (LLViewerOctreeGroup*) n->getListener(0);
+
+	//same steps as LLViewerOctreeCull::traverse() for each culler
+	U32 parent_mask = mInMask;
+	U32 in_mask = 0;
+	U32 checked_mask = 0;
+	for (U32 i = 0; i < mCullers.size(); ++i)
+	{
+		U32 bit = (U32)1 << i;
+		LLViewerOctreeCull* culler = mCullers[i];
+		if (!(parent_mask & bit) || culler->earlyFail(group))
+		{
+			continue;
+		}
+
+		if (culler->mRes == 2 || 
+			(culler->mRes && group->hasState(LLViewerOctreeGroup::SKIP_FRUSTUM_CHECK)))
+		{	//fully in
+			in_mask |= bit;
+		}
+		else
+		{
+			culler->mRes = culler->frustumCheck(group);
+			checked_mask |= bit;
+			if (culler->mRes)
+			{
+				in_mask |= bit;
+			}
+		}
+	}
+
+	if (in_mask)
+	{ //at least partially in one frustum, run on down
+		mInMask = in_mask;
+		OctreeTraveler::traverse(n);
+		mInMask = parent_mask;
+	}
+
+	for (U32 i = 0; i < mCullers.size(); ++i)
+	{
+		if (checked_mask & ((U32)1 << i))
+		{
+			mCullers[i]->mRes = 0;
+		}
+	}
+}
+
+//virtual 
+void LLViewerOctreeMultiCull::visit(const OctreeNode* branch)
+{
+	for (U32 i = 0; i < mCullers.size(); ++i)
+	{
+		if (mInMask & ((U32)1 << i))
+		{
+			mCullers[i]->visit(branch);
+		}
+	}
+}
+
 //--------------------------------------------------------------
 //class LLViewerOctreeDebug
 //virtual 
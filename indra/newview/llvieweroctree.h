@@ -363,6 +363,7 @@ public:
 
 class LLViewerOctreeCull : public OctreeTraveler
 {
+	friend class LLViewerOctreeMultiCull;
 public:
 	LLViewerOctreeCull(LLCamera* camera)
 		: mCamera(camera), mRes(0) { }
@@ -406,6 +407,24 @@ protected:
 	S32 mRes;
 };
 
+//runs several cullers in one walk of the octree. a node is tested against
+//the cullers its parent is in, and each culler visits the nodes it would
+//have visited walking the octree on its own, in the same order.
+class LLViewerOctreeMultiCull : public OctreeTraveler
+{
+public:
+	static const U32 MAX_CULLERS = 32;
+
+	LLViewerOctreeMultiCull(const std::vector<LLViewerOctreeCull*>& cullers);
+
+	virtual void traverse(const OctreeNode* n);
+	virtual void visit(const OctreeNode* branch);
+
+private:
+	std::vector<LLViewerOctreeCull*> mCullers;
+	U32 mInMask; //cullers the current node is in
+};
+
 //scan the octree, output the info of each node for debug use.
 class LLViewerOctreeDebug : public OctreeTraveler
 {
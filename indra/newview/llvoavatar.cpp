@@ -63,6 +63,7 @@
 #include "llhudtext.h"				// for mText/mDebugText
 #include "llimview.h"
 #include "llinitparam.h"
+#include "lljobscheduler.h"
 #include "llkeyframefallmotion.h"
 #include "llkeyframestandmotion.h"
 #include "llkeyframewalkmotion.h"
@@ -608,6 +609,7 @@ F32 LLVOAvatar::sUnbakedTime = 0.f;
 F32 LLVOAvatar::sUnbakedUpdateTime = 0.f;
 F32 LLVOAvatar::sGreyTime = 0.f;
 F32 LLVOAvatar::sGreyUpdateTime = 0.f;
+std::vector<LLPointer<LLVOAvatar> > LLVOAvatar::sAnimationQueue;
 
 //-----------------------------------------------------------------------------
 // Helper functions
@@ -630,6 +632,9 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mTurning(FALSE),
 	mLastSkeletonSerialNum( 0 ),
 	mIsSitting(FALSE),
+	mEvaluatingOnWorker(false),
+	mEvaluateMotions(FALSE),
+	mWasSitGroundConstrained(false),
 	mTimeVisible(),
 	mTyping(FALSE),
 	mMeshValid(FALSE),
@@ -2537,8 +2542,28 @@ void LLVOAvatar::idleUpdate(LLAgent &agent, const F64 &time)
 	// animate the character
 	// store off last frame's root position to be consistent with camera position
 	mLastRootPos = mRoot->getWorldPosition();
-	BOOL detailed_update = updateCharacter(agent);
 
+	// other avatars are evaluated together once every object had its update
+	static LLCachedControl<bool> parallel_animation(gSavedSettings, "AvatarParallelAnimation", true);
+	if (parallel_animation && !isSelf() && !isUIAvatar() && !mSpecialRenderMode)
+	{
+		if (prepareCharacter(agent))
+		{
+			resolveGroundSamples();
+			sAnimationQueue.push_back(this);
+		}
+		else
+		{
+			idleUpdateAfterAnimation(FALSE);
+		}
+		return;
+	}
+
+	idleUpdateAfterAnimation(updateCharacter(agent));
+}
+
+void LLVOAvatar::idleUpdateAfterAnimation(BOOL detailed_update)
+{
 	static LLUICachedControl<bool> visualizers_in_calls("ShowVoiceVisualizersInCalls", false);
 	bool voice_enabled = (visualizers_in_calls || LLVoiceClient::getInstance()->inProximalChannel()) &&
 						 LLVoiceClient::getInstance()->getVoiceEnabled(mID);
@@ -2837,6 +2862,7 @@ void LLVOAvatar::idleUpdateAppearanceAnimation()
 			{
 				param->apply(avatar_sex);
 			}
+			applyQueuedMorphs();
 
 			mLastAppearanceBlendTime = appearance_anim_time;
 		}
@@ -3493,7 +3519,7 @@ void LLVOAvatar::slamPosition()
 	{
 		gPipeline.updateMoveNormalAsync(mDrawable);
 	}
-	mRoot->updateWorldMatrixChildren();
+	updateWorldMatrices();
 }
 
 bool LLVOAvatar::isVisuallyMuted()
@@ -4253,7 +4279,23 @@ void LLVOAvatar::updateRootPositionAndRotation(LLAgent& agent, F32 speed, bool w
 //
 //------------------------------------------------------------------------
 BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
-{	
+{
+	if (!prepareCharacter(agent))
+	{
+		return FALSE;
+	}
+
+	evaluateCharacter();
+	finishCharacter();
+
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// prepareCharacter()
+//-----------------------------------------------------------------------------
+BOOL LLVOAvatar::prepareCharacter(LLAgent &agent)
+{
 	updateDebugText();
 	
 	if (!mIsBuilt)
@@ -4341,19 +4383,33 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 	//-------------------------------------------------------------------------
 	// store data relevant to motions
 	mSpeed = speed;
+	mWasSitGroundConstrained = was_sit_ground_constrained;
 
 	// update animations
 	if (mSpecialRenderMode == 1) // Animation Preview
 	{
-		updateMotions(LLCharacter::FORCE_UPDATE);
+		mEvaluateMotions = beginUpdateMotions(LLCharacter::FORCE_UPDATE);
 	}
 	else
 	{
-		updateMotions(LLCharacter::NORMAL_UPDATE);
+		mEvaluateMotions = beginUpdateMotions(LLCharacter::NORMAL_UPDATE);
+	}
+
+	return TRUE;
+}
+
+//-----------------------------------------------------------------------------
+// evaluateCharacter()
+//-----------------------------------------------------------------------------
+void LLVOAvatar::evaluateCharacter()
+{
+	if (mEvaluateMotions)
+	{
+		evaluateMotions();
 	}
 
 	// Special handling for sitting on ground.
-	if (!getParent() && (isSitting() || was_sit_ground_constrained))
+	if (!getParent() && (isSitting() || mWasSitGroundConstrained))
 	{
 		
 		F32 off_z = LLVector3d(getHoverOffset()).mdV[VZ];
@@ -4367,19 +4423,116 @@ BOOL LLVOAvatar::updateCharacter(LLAgent &agent)
 		}
 	}
 
+	// Update child joints as needed.
+	updateWorldMatrices();
+}
+
+//-----------------------------------------------------------------------------
+// finishCharacter()
+//-----------------------------------------------------------------------------
+void LLVOAvatar::finishCharacter()
+{
+	endUpdateMotions();
+
 	// update head position
 	updateHeadOffset();
 
 	// Generate footstep sounds when feet hit the ground
     updateFootstepSounds();
 
-	// Update child joints as needed.
-	mRoot->updateWorldMatrixChildren();
-
 	// System avatar mesh vertices need to be reskinned.
 	mNeedsSkin = TRUE;
+}
 
-	return TRUE;
+//-----------------------------------------------------------------------------
+// updateQueuedAnimations()
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Evaluates queued avatars, taking the next one until none are left
+	void evaluate_avatars(const std::vector<LLVOAvatar*>& avatars, LLAtomicS32& next)
+	{
+		for (S32 i = next++; i < (S32)avatars.size(); i = next++)
+		{
+			avatars[i]->evaluateCharacter();
+		}
+	}
+
+	class LLAvatarAnimationJob : public LLJob
+	{
+	public:
+		LLAvatarAnimationJob(const std::vector<LLVOAvatar*>& avatars, LLAtomicS32& next)
+		:	LLJob(PRIORITY_HIGH),
+			mAvatars(avatars),
+			mNext(next)
+		{
+		}
+
+	protected:
+		/*virtual*/ void run()
+		{
+			evaluate_avatars(mAvatars, mNext);
+		}
+
+	private:
+		const std::vector<LLVOAvatar*>& mAvatars;
+		LLAtomicS32& mNext;
+	};
+}
+
+static LLTrace::BlockTimerStatHandle FTM_QUEUED_ANIMATIONS("Avatar Animation Jobs");
+
+//static
+void LLVOAvatar::updateQueuedAnimations()
+{
+	if (sAnimationQueue.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_QUEUED_ANIMATIONS);
+
+	// sAnimationQueue holds the references, workers only get the pointers
+	std::vector<LLVOAvatar*> avatars;
+	avatars.reserve(sAnimationQueue.size());
+	for (U32 i = 0; i < sAnimationQueue.size(); ++i)
+	{
+		LLVOAvatar* avatarp = sAnimationQueue[i];
+		if (!avatarp->isDead())
+		{
+			avatarp->mEvaluatingOnWorker = true;
+			avatars.push_back(avatarp);
+		}
+	}
+
+	// the main thread takes avatars too, so there is no more than one job per worker
+	LLJobScheduler* scheduler = LLJobScheduler::getDefault();
+	std::vector<LLJob::ptr_t> jobs;
+	LLAtomicS32 next(0);
+	if (scheduler && avatars.size() > 1)
+	{
+		U32 job_count = llmin(scheduler->getThreadCount(), (U32)avatars.size() - 1);
+		for (U32 i = 0; i < job_count; ++i)
+		{
+			jobs.push_back(new LLAvatarAnimationJob(avatars, next));
+			scheduler->submit(jobs.back());
+		}
+	}
+	evaluate_avatars(avatars, next);
+	for (U32 i = 0; i < jobs.size(); ++i)
+	{
+		scheduler->waitFor(jobs[i]);
+	}
+
+	for (U32 i = 0; i < avatars.size(); ++i)
+	{
+		LLVOAvatar* avatarp = avatars[i];
+		avatarp->mEvaluatingOnWorker = false;
+		avatarp->finishCharacter();
+		avatarp->idleUpdateAfterAnimation(TRUE);
+	}
+
+	sAnimationQueue.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -4479,7 +4632,7 @@ void LLVOAvatar::debugBodySize() const
 //------------------------------------------------------------------------
 void LLVOAvatar::postPelvisSetRecalc()
 {		
-	mRoot->updateWorldMatrixChildren();			
+	updateWorldMatrices();			
 	computeBodySize();
 	dirtyMesh(2);
 }
@@ -6519,16 +6672,31 @@ LLVector3 LLVOAvatar::getCharacterAngularVelocity()
 //-----------------------------------------------------------------------------
 void LLVOAvatar::getGround(const LLVector3 &in_pos_agent, LLVector3 &out_pos_agent, LLVector3 &outNorm)
 {
-	LLVector3d z_vec(0.0f, 0.0f, 1.0f);
-	LLVector3d p0_global, p1_global;
-
 	if (isUIAvatar())
 	{
-		outNorm.setVec(z_vec);
+		outNorm.setVec(0.f, 0.f, 1.f);
 		out_pos_agent = in_pos_agent;
 		return;
 	}
-	
+
+	if (mEvaluatingOnWorker)
+	{
+		// no raycasts off the main thread
+		sampleGround(in_pos_agent, out_pos_agent, outNorm);
+		return;
+	}
+
+	resolveGround(in_pos_agent, out_pos_agent, outNorm);
+}
+
+//-----------------------------------------------------------------------------
+// LLVOAvatar::resolveGround()
+//-----------------------------------------------------------------------------
+void LLVOAvatar::resolveGround(const LLVector3 &in_pos_agent, LLVector3 &out_pos_agent, LLVector3 &outNorm)
+{
+	LLVector3d z_vec(0.0f, 0.0f, 1.0f);
+	LLVector3d p0_global, p1_global;
+
 	p0_global = gAgent.getPosGlobalFromAgent(in_pos_agent) + z_vec;
 	p1_global = gAgent.getPosGlobalFromAgent(in_pos_agent) - z_vec;
 	LLViewerObject *obj;
@@ -6537,6 +6705,82 @@ void LLVOAvatar::getGround(const LLVector3 &in_pos_agent, LLVector3 &out_pos_age
 	out_pos_agent = gAgent.getPosAgentFromGlobal(out_pos_global);
 }
 
+//-----------------------------------------------------------------------------
+// LLVOAvatar::resolveGroundSamples()
+// Main thread, before the avatar is queued for evaluation
+//-----------------------------------------------------------------------------
+void LLVOAvatar::resolveGroundSamples()
+{
+	mGroundSamples.resize(mGroundQueries.size() + 1);
+	mGroundSamples[0].mQueryPos = mRoot->getWorldPosition();
+	for (U32 i = 0; i < mGroundQueries.size(); ++i)
+	{
+		mGroundSamples[i + 1].mQueryPos = mGroundQueries[i];
+	}
+	mGroundQueries.clear();
+
+	for (U32 i = 0; i < mGroundSamples.size(); ++i)
+	{
+		LLGroundSample& sample = mGroundSamples[i];
+		resolveGround(sample.mQueryPos, sample.mGroundPos, sample.mNormal);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// LLVOAvatar::sampleGround()
+// Answers from the plane of the nearest sample, feet are asked about where
+// they were a frame ago. The query is kept to be resolved for the next frame.
+//-----------------------------------------------------------------------------
+const U32 MAX_GROUND_QUERIES = 8;
+const F32 GROUND_QUERY_MERGE_DIST_SQUARED = 0.1f * 0.1f;
+
+void LLVOAvatar::sampleGround(const LLVector3 &in_pos_agent, LLVector3 &out_pos_agent, LLVector3 &outNorm)
+{
+	U32 query = 0;
+	while (query < mGroundQueries.size()
+		   && dist_vec_squared(mGroundQueries[query], in_pos_agent) > GROUND_QUERY_MERGE_DIST_SQUARED)
+	{
+		++query;
+	}
+	if (query < mGroundQueries.size())
+	{
+		mGroundQueries[query] = in_pos_agent;
+	}
+	else if (mGroundQueries.size() < MAX_GROUND_QUERIES)
+	{
+		mGroundQueries.push_back(in_pos_agent);
+	}
+
+	if (mGroundSamples.empty())
+	{
+		outNorm.setVec(0.f, 0.f, 1.f);
+		out_pos_agent = in_pos_agent;
+		return;
+	}
+
+	const LLGroundSample* nearest = &mGroundSamples[0];
+	F32 nearest_dist = dist_vec_squared2D(nearest->mQueryPos, in_pos_agent);
+	for (U32 i = 1; i < mGroundSamples.size(); ++i)
+	{
+		F32 dist = dist_vec_squared2D(mGroundSamples[i].mQueryPos, in_pos_agent);
+		if (dist < nearest_dist)
+		{
+			nearest = &mGroundSamples[i];
+			nearest_dist = dist;
+		}
+	}
+
+	outNorm = nearest->mNormal;
+	out_pos_agent = in_pos_agent;
+	out_pos_agent.mV[VZ] = nearest->mGroundPos.mV[VZ];
+	if (outNorm.mV[VZ] > 0.1f)
+	{
+		// z on the plane through the sample
+		out_pos_agent.mV[VZ] -= (outNorm.mV[VX] * (in_pos_agent.mV[VX] - nearest->mGroundPos.mV[VX])
+								 + outNorm.mV[VY] * (in_pos_agent.mV[VY] - nearest->mGroundPos.mV[VY])) / outNorm.mV[VZ];
+	}
+}
+
 //-----------------------------------------------------------------------------
 // LLVOAvatar::getTimeDilation()
 //-----------------------------------------------------------------------------
@@ -6719,12 +6963,15 @@ void LLVOAvatar::updateVisualParams()
 	}
 
 	LLCharacter::updateVisualParams();
+	// motions only request this update, it runs from endUpdateMotions() on
+	// the main thread, so the morphs the params queued go in here in one pass
+	applyQueuedMorphs();
 
 	if (mLastSkeletonSerialNum != mSkeletonSerialNum)
 	{
 		computeBodySize();
 		mLastSkeletonSerialNum = mSkeletonSerialNum;
-		mRoot->updateWorldMatrixChildren();
+		updateWorldMatrices();
 	}
 
 	dirtyMesh();
@@ -7053,7 +7300,7 @@ const LLViewerJointAttachment *LLVOAvatar::attachObject(LLViewerObject *viewer_o
         updateAttachmentOverrides();
     }
 
-	updateVisualComplexity();
+	updateVisualComplexity(viewer_object);
 
 	if (viewer_object->isSelected())
 	{
@@ -7262,7 +7509,7 @@ BOOL LLVOAvatar::detachObject(LLViewerObject *viewer_object)
 		
 		if (attachment->isObjectAttached(viewer_object))
 		{
-            updateVisualComplexity();
+            updateVisualComplexity(viewer_object);
             bool is_animated_object = viewer_object->isAnimatedObject();
 			cleanupAttachedMesh(viewer_object);
 
@@ -7370,7 +7617,7 @@ void LLVOAvatar::sitOnObject(LLViewerObject *sit_object)
 	mRoot->getXform()->setParent(&sit_object->mDrawable->mXform); // LLVOAvatar::sitOnObject
 	// SL-315
 	mRoot->setPosition(getPosition());
-	mRoot->updateWorldMatrixChildren();
+	updateWorldMatrices();
 
 	stopMotion(ANIM_AGENT_BODY_NOISE);
 	
@@ -7672,6 +7919,8 @@ void LLVOAvatar::updateRezzedStatusTimers(S32 rez_status)
 				selfStopPhase("wear_inventory_category", false);
 				selfStopPhase("process_initial_wearables_update", false);
 
+                // textures have loaded, their costs are known now
+                mComplexityTally.markAllChanged();
                 updateVisualComplexity();
 			}
 		}
@@ -10229,133 +10478,210 @@ void LLVOAvatar::updateVisualComplexity()
 	mVisualComplexityStale = true;
 }
 
+void LLVOAvatar::updateVisualComplexity(const LLViewerObject* changed_object)
+{
+	mComplexityTally.markChanged(changed_object->getRootEdit()->getID());
+	updateVisualComplexity();
+}
+
 // Account for the complexity of a single top-level object associated
 // with an avatar. This will be either an attached object or an animated
 // object.
 void LLVOAvatar::accountRenderComplexityForObject(
     const LLViewerObject *attached_object,
-    const F32 max_attachment_complexity,
     LLVOVolume::texture_cost_t& textures,
-    U32& cost,
-    hud_complexity_list_t& hud_complexity_list)
+    LLComplexityTally::Entry& entry)
 {
-    if (attached_object && !attached_object->isHUDAttachment())
-		{
-        mAttachmentVisibleTriangleCount += attached_object->recursiveGetTriangleCount();
-        mAttachmentEstTriangleCount += attached_object->recursiveGetEstTrianglesMax();
-        mAttachmentSurfaceArea += attached_object->recursiveGetScaledSurfaceArea();
+    entry.mTriangles = attached_object->recursiveGetTriangleCount();
+    entry.mEstTriangles = attached_object->recursiveGetEstTrianglesMax();
+    entry.mSurfaceArea = attached_object->recursiveGetScaledSurfaceArea();
+    // Limited by the tally to avoid signed integer flipping of the wearer's ACI
+    entry.mCost = accountRenderCostForObject(attached_object, textures);
+}
 
-					textures.clear();
-					const LLDrawable* drawable = attached_object->mDrawable;
-					if (drawable)
-					{
-						const LLVOVolume* volume = drawable->getVOVolume();
-						if (volume)
-						{
-                            F32 attachment_total_cost = 0;
-                            F32 attachment_volume_cost = 0;
-                            F32 attachment_texture_cost = 0;
-                            F32 attachment_children_cost = 0;
-                const F32 animated_object_attachment_surcharge = 1000;
+// The render cost of a top-level object and its children. The prims cache
+// the costs of their faces, so this is cheap enough to do on every complexity
+// update, which picks up textures that loaded and particle sources that
+// started or stopped since the object was last changed.
+F32 LLVOAvatar::accountRenderCostForObject(
+    const LLViewerObject *attached_object,
+    LLVOVolume::texture_cost_t& textures)
+{
+    F32 attachment_total_cost = 0;
+    textures.clear();
+    const LLDrawable* drawable = attached_object->mDrawable;
+    if (drawable)
+    {
+        const LLVOVolume* volume = drawable->getVOVolume();
+        if (volume)
+        {
+            F32 attachment_volume_cost = 0;
+            F32 attachment_texture_cost = 0;
+            F32 attachment_children_cost = 0;
+            const F32 animated_object_attachment_surcharge = 1000;
+
+            if (attached_object->isAnimatedObject())
+            {
+                attachment_volume_cost += animated_object_attachment_surcharge;
+            }
+            attachment_volume_cost += volume->getRenderCost(textures);
 
-                if (attached_object->isAnimatedObject())
+            const_child_list_t children = volume->getChildren();
+            for (const_child_list_t::const_iterator child_iter = children.begin();
+                 child_iter != children.end();
+                 ++child_iter)
+            {
+                LLViewerObject* child_obj = *child_iter;
+                LLVOVolume *child = dynamic_cast<LLVOVolume*>( child_obj );
+                if (child)
                 {
-                    attachment_volume_cost += animated_object_attachment_surcharge;
+                    attachment_children_cost += child->getRenderCost(textures);
                 }
-							attachment_volume_cost += volume->getRenderCost(textures);
+            }
 
-							const_child_list_t children = volume->getChildren();
-							for (const_child_list_t::const_iterator child_iter = children.begin();
-								  child_iter != children.end();
-								  ++child_iter)
-							{
-								LLViewerObject* child_obj = *child_iter;
-								LLVOVolume *child = dynamic_cast<LLVOVolume*>( child_obj );
-								if (child)
-								{
-									attachment_children_cost += child->getRenderCost(textures);
-								}
-							}
+            for (LLVOVolume::texture_cost_t::iterator volume_texture = textures.begin();
+                 volume_texture != textures.end();
+                 ++volume_texture)
+            {
+                // add the cost of each individual texture in the linkset
+                attachment_texture_cost += volume_texture->second;
+            }
+            attachment_total_cost = attachment_volume_cost + attachment_texture_cost + attachment_children_cost;
+            LL_DEBUGS("ARCdetail") << "Attachment costs " << attached_object->getAttachmentItemID()
+                                   << " total: " << attachment_total_cost
+                                   << ", volume: " << attachment_volume_cost
+                                   << ", textures: " << attachment_texture_cost
+                                   << ", " << volume->numChildren()
+                                   << " children: " << attachment_children_cost
+                                   << LL_ENDL;
+        }
+    }
+    return attachment_total_cost;
+}
 
-							for (LLVOVolume::texture_cost_t::iterator volume_texture = textures.begin();
-								 volume_texture != textures.end();
-								 ++volume_texture)
-							{
-								// add the cost of each individual texture in the linkset
-								attachment_texture_cost += volume_texture->second;
-							}
-                            attachment_total_cost = attachment_volume_cost + attachment_texture_cost + attachment_children_cost;
-                            LL_DEBUGS("ARCdetail") << "Attachment costs " << attached_object->getAttachmentItemID()
-                                                   << " total: " << attachment_total_cost
-                                                   << ", volume: " << attachment_volume_cost
-                                                   << ", textures: " << attachment_texture_cost
-                                                   << ", " << volume->numChildren()
-                                                   << " children: " << attachment_children_cost
-                                                   << LL_ENDL;
-                            // Limit attachment complexity to avoid signed integer flipping of the wearer's ACI
-                            cost += (U32)llclamp(attachment_total_cost, MIN_ATTACHMENT_COMPLEXITY, max_attachment_complexity);
-						}
-					}
-				}
-                if (isSelf()
-                    && attached_object
-                    && attached_object->isHUDAttachment()
-                    && !attached_object->isTempAttachment()
-                    && attached_object->mDrawable)
-                {
-                    textures.clear();
+// Adds a HUD attachment of our own avatar to the HUD complexity list and
+// returns its surface area. HUDs do not count towards the avatar complexity.
+F32 LLVOAvatar::accountHUDComplexityForObject(
+    const LLViewerObject *attached_object,
+    LLVOVolume::texture_cost_t& textures,
+    hud_complexity_list_t& hud_complexity_list)
+{
+    textures.clear();
 
-        mAttachmentSurfaceArea += attached_object->recursiveGetScaledSurfaceArea();
+    F32 surface_area = attached_object->recursiveGetScaledSurfaceArea();
 
-                    const LLVOVolume* volume = attached_object->mDrawable->getVOVolume();
-                    if (volume)
-                    {
-                        LLHUDComplexity hud_object_complexity;
-                        hud_object_complexity.objectName = attached_object->getAttachmentItemName();
-                        hud_object_complexity.objectId = attached_object->getAttachmentItemID();
-                        std::string joint_name;
-                        gAgentAvatarp->getAttachedPointName(attached_object->getAttachmentItemID(), joint_name);
-                        hud_object_complexity.jointName = joint_name;
-                        // get cost and individual textures
-                        hud_object_complexity.objectsCost += volume->getRenderCost(textures);
-                        hud_object_complexity.objectsCount++;
-
-                        LLViewerObject::const_child_list_t& child_list = attached_object->getChildren();
-                        for (LLViewerObject::child_list_t::const_iterator iter = child_list.begin();
-                            iter != child_list.end(); ++iter)
-                        {
-                            LLViewerObject* childp = *iter;
-                            const LLVOVolume* chld_volume = dynamic_cast<LLVOVolume*>(childp);
-                            if (chld_volume)
-                            {
-                                // get cost and individual textures
-                                hud_object_complexity.objectsCost += chld_volume->getRenderCost(textures);
-                                hud_object_complexity.objectsCount++;
-                            }
-                        }
+    const LLVOVolume* volume = attached_object->mDrawable->getVOVolume();
+    if (volume)
+    {
+        LLHUDComplexity hud_object_complexity;
+        hud_object_complexity.objectName = attached_object->getAttachmentItemName();
+        hud_object_complexity.objectId = attached_object->getAttachmentItemID();
+        std::string joint_name;
+        gAgentAvatarp->getAttachedPointName(attached_object->getAttachmentItemID(), joint_name);
+        hud_object_complexity.jointName = joint_name;
+        // get cost and individual textures
+        hud_object_complexity.objectsCost += volume->getRenderCost(textures);
+        hud_object_complexity.objectsCount++;
+
+        LLViewerObject::const_child_list_t& child_list = attached_object->getChildren();
+        for (LLViewerObject::child_list_t::const_iterator iter = child_list.begin();
+            iter != child_list.end(); ++iter)
+        {
+            LLViewerObject* childp = *iter;
+            const LLVOVolume* chld_volume = dynamic_cast<LLVOVolume*>(childp);
+            if (chld_volume)
+            {
+                // get cost and individual textures
+                hud_object_complexity.objectsCost += chld_volume->getRenderCost(textures);
+                hud_object_complexity.objectsCount++;
+            }
+        }
 
-                        hud_object_complexity.texturesCount += textures.size();
+        hud_object_complexity.texturesCount += textures.size();
 
-                        for (LLVOVolume::texture_cost_t::iterator volume_texture = textures.begin();
-                            volume_texture != textures.end();
-                            ++volume_texture)
-                        {
-                            // add the cost of each individual texture (ignores duplicates)
-                            hud_object_complexity.texturesCost += volume_texture->second;
-                            LLViewerFetchedTexture *tex = LLViewerTextureManager::getFetchedTexture(volume_texture->first);
-                            if (tex)
-                            {
-                                // Note: Texture memory might be incorect since texture might be still loading.
-                                hud_object_complexity.texturesMemoryTotal += tex->getTextureMemory();
-                                if (tex->getOriginalHeight() * tex->getOriginalWidth() >= HUD_OVERSIZED_TEXTURE_DATA_SIZE)
-                                {
-                                    hud_object_complexity.largeTexturesCount++;
-                                }
-                            }
-                        }
-                        hud_complexity_list.push_back(hud_object_complexity);
-                    }
+        for (LLVOVolume::texture_cost_t::iterator volume_texture = textures.begin();
+            volume_texture != textures.end();
+            ++volume_texture)
+        {
+            // add the cost of each individual texture (ignores duplicates)
+            hud_object_complexity.texturesCost += volume_texture->second;
+            LLViewerFetchedTexture *tex = LLViewerTextureManager::getFetchedTexture(volume_texture->first);
+            if (tex)
+            {
+                // Note: Texture memory might be incorect since texture might be still loading.
+                hud_object_complexity.texturesMemoryTotal += tex->getTextureMemory();
+                if (tex->getOriginalHeight() * tex->getOriginalWidth() >= HUD_OVERSIZED_TEXTURE_DATA_SIZE)
+                {
+                    hud_object_complexity.largeTexturesCount++;
+                }
+            }
+        }
+        hud_complexity_list.push_back(hud_object_complexity);
+    }
+    return surface_area;
+}
+
+// Brings the tally up to date with the objects of this avatar. Only the
+// objects that are new, or were marked changed by updateVisualComplexity()
+// since their last update, are counted again in full, the others only have
+// their render cost summed again from their prims.
+void LLVOAvatar::accountAttachmentsComplexity(
+    LLComplexityTally& tally,
+    const F32 max_attachment_complexity,
+    LLVOVolume::texture_cost_t& textures)
+{
+    tally.beginUpdate(MIN_ATTACHMENT_COMPLEXITY, max_attachment_complexity);
+
+    // A standalone animated object needs to be accounted for
+    // using its associated volume. Attached animated objects
+    // will be covered by the subsequent loop over attachments.
+    LLControlAvatar *control_av = dynamic_cast<LLControlAvatar*>(this);
+    if (control_av)
+    {
+        LLVOVolume *volp = control_av->mRootVolp;
+        if (volp && !volp->isAttachment())
+        {
+            if (tally.needsUpdate(volp->getID()))
+            {
+                LLComplexityTally::Entry entry;
+                accountRenderComplexityForObject(volp, textures, entry);
+                tally.update(volp->getID(), entry);
+            }
+            else
+            {
+                tally.updateCost(volp->getID(), accountRenderCostForObject(volp, textures));
+            }
+        }
+    }
+
+    // Account for complexity of all attachments.
+    for (attachment_map_t::const_iterator attachment_point = mAttachmentPoints.begin(); 
+         attachment_point != mAttachmentPoints.end();
+         ++attachment_point)
+    {
+        LLViewerJointAttachment* attachment = attachment_point->second;
+        for (LLViewerJointAttachment::attachedobjs_vec_t::iterator attachment_iter = attachment->mAttachedObjects.begin();
+             attachment_iter != attachment->mAttachedObjects.end();
+             ++attachment_iter)
+        {
+            const LLViewerObject* attached_object = attachment_iter->get();
+            if (attached_object && !attached_object->isHUDAttachment())
+            {
+                if (tally.needsUpdate(attached_object->getID()))
+                {
+                    LLComplexityTally::Entry entry;
+                    accountRenderComplexityForObject(attached_object, textures, entry);
+                    tally.update(attached_object->getID(), entry);
+                }
+                else
+                {
+                    tally.updateCost(attached_object->getID(), accountRenderCostForObject(attached_object, textures));
                 }
+            }
+        }
+    }
+
+    tally.endUpdate();
 }
 
 // Calculations for mVisualComplexity value
@@ -10396,39 +10722,64 @@ void LLVOAvatar::calculateUpdateRenderComplexity()
 		}
         LL_DEBUGS("ARCdetail") << "Avatar body parts complexity: " << cost << LL_ENDL;
 
-        mAttachmentVisibleTriangleCount = 0;
-        mAttachmentEstTriangleCount = 0.f;
-        mAttachmentSurfaceArea = 0.f;
-        
-        // A standalone animated object needs to be accounted for
-        // using its associated volume. Attached animated objects
-        // will be covered by the subsequent loop over attachments.
-        LLControlAvatar *control_av = dynamic_cast<LLControlAvatar*>(this);
-        if (control_av)
+        // Objects that did not change since the last update keep their
+        // costs in the tally
+        if (!LLVOVolume::sCacheRenderCost)
+        {
+            mComplexityTally.markAllChanged();
+        }
+        accountAttachmentsComplexity(mComplexityTally, max_attachment_complexity, textures);
+        cost += mComplexityTally.getCost();
+
+        mAttachmentVisibleTriangleCount = mComplexityTally.getTriangles();
+        mAttachmentEstTriangleCount = mComplexityTally.getEstTriangles();
+        mAttachmentSurfaceArea = mComplexityTally.getSurfaceArea();
+
+        if (isSelf())
         {
-            LLVOVolume *volp = control_av->mRootVolp;
-            if (volp && !volp->isAttachment())
+            for (attachment_map_t::const_iterator attachment_point = mAttachmentPoints.begin(); 
+                 attachment_point != mAttachmentPoints.end();
+                 ++attachment_point)
             {
-                accountRenderComplexityForObject(volp, max_attachment_complexity,
-                                                 textures, cost, hud_complexity_list);
+                LLViewerJointAttachment* attachment = attachment_point->second;
+                for (LLViewerJointAttachment::attachedobjs_vec_t::iterator attachment_iter = attachment->mAttachedObjects.begin();
+                     attachment_iter != attachment->mAttachedObjects.end();
+                     ++attachment_iter)
+                {
+                    const LLViewerObject* attached_object = attachment_iter->get();
+                    if (attached_object
+                        && attached_object->isHUDAttachment()
+                        && !attached_object->isTempAttachment()
+                        && attached_object->mDrawable)
+                    {
+                        mAttachmentSurfaceArea += accountHUDComplexityForObject(attached_object, textures, hud_complexity_list);
+                    }
+                }
             }
         }
 
-        // Account for complexity of all attachments.
-		for (attachment_map_t::const_iterator attachment_point = mAttachmentPoints.begin(); 
-			 attachment_point != mAttachmentPoints.end();
-			 ++attachment_point)
-		{
-			LLViewerJointAttachment* attachment = attachment_point->second;
-			for (LLViewerJointAttachment::attachedobjs_vec_t::iterator attachment_iter = attachment->mAttachedObjects.begin();
-				 attachment_iter != attachment->mAttachedObjects.end();
-				 ++attachment_iter)
-			{
-                const LLViewerObject* attached_object = attachment_iter->get();
-                accountRenderComplexityForObject(attached_object, max_attachment_complexity,
-                                                 textures, cost, hud_complexity_list);
-			}
-		}
+        static LLCachedControl<bool> check_complexity(gSavedSettings, "DebugAvatarComplexityCheck", false);
+        if (check_complexity)
+        {
+            // cost every object again, bypassing the caches
+            LLComplexityTally full_tally;
+            LLVOVolume::texture_cost_t full_textures;
+            BOOL cache_render_cost = LLVOVolume::sCacheRenderCost;
+            LLVOVolume::sCacheRenderCost = FALSE;
+            accountAttachmentsComplexity(full_tally, max_attachment_complexity, full_textures);
+            LLVOVolume::sCacheRenderCost = cache_render_cost;
+
+            if (full_tally.getCost() != mComplexityTally.getCost()
+                || full_tally.getTriangles() != mComplexityTally.getTriangles())
+            {
+                LL_WARNS("AvatarRender") << "Avatar " << getID()
+                                         << " attachment complexity " << mComplexityTally.getCost()
+                                         << " triangles " << mComplexityTally.getTriangles()
+                                         << " but recomputed " << full_tally.getCost()
+                                         << " triangles " << full_tally.getTriangles()
+                                         << LL_ENDL;
+            }
+        }
 
 		// Diagnostic output to identify all avatar-related textures.
 		// Does not affect rendering cost calculation.
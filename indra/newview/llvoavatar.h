@@ -53,6 +53,7 @@
 #include "llviewerstats.h"
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
+#include "llcomplexitytally.h"
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -232,6 +233,7 @@ public:
 	/*virtual*/ void			addDebugText(const std::string& text);
 	/*virtual*/ F32				getTimeDilation();
 	/*virtual*/ void			getGround(const LLVector3 &inPos, LLVector3 &outPos, LLVector3 &outNorm);
+	void						resolveGround(const LLVector3 &inPos, LLVector3 &outPos, LLVector3 &outNorm);
 	/*virtual*/ F32				getPixelArea() const;
 	/*virtual*/ LLVector3d		getPosGlobalFromAgent(const LLVector3 &position);
 	/*virtual*/ LLVector3		getPosAgentFromGlobal(const LLVector3d &position);
@@ -263,6 +265,17 @@ public:
 	void 			updateAnimationDebugText();
 	virtual void	updateDebugText();
 	virtual BOOL 	updateCharacter(LLAgent &agent);
+
+	// updateCharacter() in steps, so the animation of other avatars can be
+	// evaluated on the job scheduler. prepareCharacter() and finishCharacter()
+	// run on the main thread, evaluateCharacter() only touches this avatar.
+	// prepareCharacter() returns FALSE when the avatar is not animated this frame.
+	BOOL			prepareCharacter(LLAgent &agent);
+	void			evaluateCharacter();
+	void			finishCharacter();
+	void			idleUpdateAfterAnimation(BOOL detailed_update);
+	// Evaluates the avatars queued by idleUpdate(), once all objects had theirs
+	static void		updateQueuedAnimations();
     void			updateFootstepSounds();
     void			computeUpdatePeriod();
     void			updateOrientation(LLAgent &agent, F32 speed, F32 delta_time);
@@ -287,13 +300,21 @@ public:
 	void			addNameTagLine(const std::string& line, const LLColor4& color, S32 style, const LLFontGL* font);
 	void 			idleUpdateRenderComplexity();
     void 			accountRenderComplexityForObject(const LLViewerObject *attached_object,
-                                                     const F32 max_attachment_complexity,
                                                      LLVOVolume::texture_cost_t& textures,
-                                                     U32& cost,
-                                                     hud_complexity_list_t& hud_complexity_list);
+                                                     LLComplexityTally::Entry& entry);
+    F32 			accountRenderCostForObject(const LLViewerObject *attached_object,
+                                               LLVOVolume::texture_cost_t& textures);
+    F32 			accountHUDComplexityForObject(const LLViewerObject *attached_object,
+                                                  LLVOVolume::texture_cost_t& textures,
+                                                  hud_complexity_list_t& hud_complexity_list);
+    void 			accountAttachmentsComplexity(LLComplexityTally& tally,
+                                                 const F32 max_attachment_complexity,
+                                                 LLVOVolume::texture_cost_t& textures);
 	void			calculateUpdateRenderComplexity();
 	static const U32 VISUAL_COMPLEXITY_UNKNOWN;
 	void			updateVisualComplexity();
+	// the complexity of one attached object, or of the root of an animated object, changed
+	void			updateVisualComplexity(const LLViewerObject* changed_object);
 	
 	U32				getVisualComplexity()			{ return mVisualComplexity;				};		// Numbers calculated here by rendering AV
 	F32				getAttachmentSurfaceArea()		{ return mAttachmentSurfaceArea;		};		// estimated surface area of attachments
@@ -454,6 +475,7 @@ public:
 	F32			mAttachmentSurfaceArea; //estimated surface area of attachments
     U32			mAttachmentVisibleTriangleCount;
     F32			mAttachmentEstTriangleCount;
+	LLComplexityTally mComplexityTally; // per attachment costs, see calculateUpdateRenderComplexity()
 	bool		shouldAlphaMask();
 
 	BOOL 		mNeedsSkin; // avatar has been animated and verts have not been updated
@@ -946,6 +968,29 @@ private:
 	// position backup in case of missing data
 	LLVector3		mLastRootPos;
 
+	//--------------------------------------------------------------------
+	// Animation on the job scheduler
+	//--------------------------------------------------------------------
+private:
+	void			resolveGroundSamples();
+	void			sampleGround(const LLVector3 &inPos, LLVector3 &outPos, LLVector3 &outNorm);
+
+	// Ground resolved on the main thread before the avatar is evaluated on a
+	// worker: under the avatar, and wherever its motions asked the last time.
+	struct LLGroundSample
+	{
+		LLVector3	mQueryPos;
+		LLVector3	mGroundPos;
+		LLVector3	mNormal;
+	};
+	std::vector<LLGroundSample> mGroundSamples;
+	std::vector<LLVector3> mGroundQueries;
+	bool			mEvaluatingOnWorker;
+	BOOL			mEvaluateMotions;
+	bool			mWasSitGroundConstrained;
+
+	static std::vector<LLPointer<LLVOAvatar> > sAnimationQueue;
+
 /**                    Hierarchy
  **                                                                            **
  *******************************************************************************/
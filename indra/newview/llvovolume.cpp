@@ -97,6 +97,7 @@ BOOL gAnimateTextures = TRUE;
 F32 LLVOVolume::sLODFactor = 1.f;
 F32	LLVOVolume::sLODSlopDistanceFactor = 0.5f; //Changing this to zero, effectively disables the LOD transition slop 
 F32 LLVOVolume::sDistanceFactor = 1.0f;
+BOOL LLVOVolume::sCacheRenderCost = TRUE;
 S32 LLVOVolume::sNumLODChanges = 0;
 S32 LLVOVolume::mRenderComplexity_last = 0;
 S32 LLVOVolume::mRenderComplexity_current = 0;
@@ -230,6 +231,10 @@ LLVOVolume::LLVOVolume(const LLUUID &id, const LLPCode pcode, LLViewerRegion *re
 	mLODChanged = FALSE;
 	mSculptChanged = FALSE;
 	mSpotLightPriority = 0.f;
+	mRenderCostDirty = TRUE;
+	mRenderCostFree = false;
+	mRenderCostShame = 0.f;
+	mRenderCostMediaFaces = 0;
 
 	mMediaImplList.resize(getNumTEs());
 	mLastFetchedMediaVersion = -1;
@@ -325,6 +330,8 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 	LLColor4U color;
 	const S32 teDirtyBits = (TEM_CHANGE_TEXTURE|TEM_CHANGE_COLOR|TEM_CHANGE_MEDIA);
 
+	F32 particle_cost = getParticleRenderCost();
+
 	// Do base class updates...
 	U32 retval = LLViewerObject::processUpdateMessage(mesgsys, user_data, block_num, update_type, dp);
 
@@ -523,6 +530,11 @@ U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 	// ...and clean up any media impls
 	cleanUpMediaImpls();
 
+	if (getParticleRenderCost() != particle_cost)
+	{
+		updateVisualComplexityCost();
+	}
+
 	return retval;
 }
 
@@ -902,6 +914,7 @@ void LLVOVolume::setScale(const LLVector3 &scale, BOOL damped)
 	{
 		// store local radius
 		LLViewerObject::setScale(scale);
+		updateVisualComplexity();
 
 		if (mVolumeImpl)
 		{
@@ -1122,6 +1135,21 @@ void LLVOVolume::updateSculptTexture()
 }
 
 void LLVOVolume::updateVisualComplexity()
+{
+    markRenderCostDirty();
+    LLVOAvatar* avatar = getAvatarAncestor();
+    if (avatar)
+    {
+        avatar->updateVisualComplexity(this);
+    }
+    LLVOAvatar* rigged_avatar = getAvatar();
+    if(rigged_avatar && (rigged_avatar != avatar))
+    {
+        rigged_avatar->updateVisualComplexity(this);
+    }
+}
+
+void LLVOVolume::updateVisualComplexityCost()
 {
     LLVOAvatar* avatar = getAvatarAncestor();
     if (avatar)
@@ -1257,7 +1285,7 @@ void LLVOVolume::sculpt()
 	}
 }
 
-S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius, F32 lod_factor)
+S32	LLVOVolume::computeLODDetail(F32 distance, F32 radius, F32 lod_factor) const
 {
 	S32	cur_detail;
 	if (LLPipeline::sDynamicLOD)
@@ -1324,7 +1352,6 @@ BOOL LLVOVolume::calcLOD()
 	
 	F32 radius;
 	F32 distance;
-	F32 lod_factor = LLVOVolume::sLODFactor;
 
 	if (mDrawable->isState(LLDrawable::RIGGED))
 	{
@@ -1367,7 +1394,7 @@ BOOL LLVOVolume::calcLOD()
 	else
 	{
 		distance = mDrawable->mDistanceWRTCamera;
-		radius = getVolume() ? getVolume()->mLODScaleBias.scaledVec(getScale()).length() : getScale().length();
+		radius = getLODRadius();
         if (distance <= 0.f || radius <= 0.f)
         {
             LL_DEBUGS("DynamicBox","CalcLOD") << "non-avatar distance/radius uninitialized, skipping" << LL_ENDL;
@@ -1391,26 +1418,8 @@ BOOL LLVOVolume::calcLOD()
         }
     }
 
-    distance *= sDistanceFactor;
-
-	F32 rampDist = LLVOVolume::sLODFactor * 2;
-	
-	if (distance < rampDist)
-	{
-		// Boost LOD when you're REALLY close
-		distance *= 1.0f/rampDist;
-		distance *= distance;
-		distance *= rampDist;
-	}
-	
-
-	distance *= F_PI/3.f;
-
-	static LLCachedControl<bool> ignore_fov_zoom(gSavedSettings,"IgnoreFOVZoomForLODs");
-	if(!ignore_fov_zoom)
-	{
-		lod_factor *= DEFAULT_FIELD_OF_VIEW / LLViewerCamera::getInstance()->getDefaultFOV();
-	}
+    distance = adjustLODDistance(distance);
+	F32 lod_factor = getLODFactor();
 
     mLODAdjustedDistance = distance;
 
@@ -1440,10 +1449,15 @@ BOOL LLVOVolume::calcLOD()
         setDebugText(llformat("%d", cur_detail));
 	}
 
+	return setLODDetail(cur_detail);
+}
+
+BOOL LLVOVolume::setLODDetail(S32 cur_detail)
+{
 	if (cur_detail != mLOD)
 	{
         LL_DEBUGS("DynamicBox","CalcLOD") << "new LOD " << cur_detail << " change from " << mLOD 
-                             << " distance " << distance << " radius " << radius << " rampDist " << rampDist
+                             << " distance " << mLODAdjustedDistance << " radius " << mLODRadius << " rampDist " << LLVOVolume::sLODFactor * 2
                              << " drawable rigged? " << (mDrawable ? (S32) mDrawable->isState(LLDrawable::RIGGED) : (S32) -1)
 							 << " mRiggedVolume " << (void*)getRiggedVolume()
                              << " distanceWRTCamera " << (mDrawable ? mDrawable->mDistanceWRTCamera : -1.f)
@@ -1458,6 +1472,80 @@ BOOL LLVOVolume::calcLOD()
 	return FALSE;
 }
 
+F32 LLVOVolume::getLODRadius() const
+{
+	return getVolume() ? getVolume()->mLODScaleBias.scaledVec(getScale()).length() : getScale().length();
+}
+
+//static
+F32 LLVOVolume::adjustLODDistance(F32 distance)
+{
+    distance *= sDistanceFactor;
+
+	F32 rampDist = LLVOVolume::sLODFactor * 2;
+	
+	if (distance < rampDist)
+	{
+		// Boost LOD when you're REALLY close
+		distance *= 1.0f/rampDist;
+		distance *= distance;
+		distance *= rampDist;
+	}
+	
+
+	distance *= F_PI/3.f;
+	return distance;
+}
+
+//static
+F32 LLVOVolume::getLODFactor()
+{
+	F32 lod_factor = LLVOVolume::sLODFactor;
+
+	static LLCachedControl<bool> ignore_fov_zoom(gSavedSettings,"IgnoreFOVZoomForLODs");
+	if(!ignore_fov_zoom)
+	{
+		lod_factor *= DEFAULT_FIELD_OF_VIEW / LLViewerCamera::getInstance()->getDefaultFOV();
+	}
+	return lod_factor;
+}
+
+bool LLVOVolume::estimateLOD(F32 distance, F32 lod_factor, LODEstimate& estimate) const
+{
+	if (mDrawable.isNull()
+		|| mDrawable->isState(LLDrawable::RIGGED)
+		|| isHUDAttachment())
+	{
+		return false;
+	}
+
+	F32 radius = getLODRadius();
+	if (distance <= 0.f || radius <= 0.f)
+	{
+		return false;
+	}
+
+	estimate.mDistance = distance;
+	estimate.mRadius = radius;
+	estimate.mAdjustedDistance = adjustLODDistance(distance);
+	estimate.mDetail = computeLODDetail(ll_round(estimate.mAdjustedDistance, 0.01f), ll_round(radius, 0.01f), lod_factor);
+	return true;
+}
+
+BOOL LLVOVolume::applyLODEstimate(const LODEstimate& estimate)
+{
+	if (mDrawable.isNull()
+		|| LLSculptIDSize::instance().isUnloaded(getVolume()->getParams().getSculptID()))
+	{
+		return FALSE;
+	}
+
+	mLODDistance = estimate.mDistance;
+	mLODRadius = estimate.mRadius;
+	mLODAdjustedDistance = estimate.mAdjustedDistance;
+	return finishUpdateLOD(setLODDetail(estimate.mDetail));
+}
+
 BOOL LLVOVolume::updateLOD()
 {
 	if (mDrawable.isNull())
@@ -1476,6 +1564,11 @@ BOOL LLVOVolume::updateLOD()
 		return FALSE;
 	}
 
+	return finishUpdateLOD(lod_changed);
+}
+
+BOOL LLVOVolume::finishUpdateLOD(BOOL lod_changed)
+{
 	if (lod_changed)
 	{
         if (debugLoggingEnabled("AnimatedObjectsLinkset"))
@@ -1910,6 +2003,12 @@ BOOL LLVOVolume::updateGeometry(LLDrawable *drawable)
 {
 	LL_RECORD_BLOCK_TIME(FTM_UPDATE_PRIMITIVES);
 	
+	if (mVolumeChanged || mFaceMappingChanged || mLODChanged || mSculptChanged)
+	{
+		// the triangle count changes with the LOD
+		updateVisualComplexity();
+	}
+
 	if (mDrawable->isState(LLDrawable::REBUILD_RIGGED))
 	{
 		{
@@ -2089,6 +2188,7 @@ void LLVOVolume::changeTEImage(S32 index, LLViewerTexture* imagep)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 }
 
@@ -2100,6 +2200,7 @@ void LLVOVolume::setTEImage(const U8 te, LLViewerTexture *imagep)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 }
 
@@ -2110,6 +2211,7 @@ S32 LLVOVolume::setTETexture(const U8 te, const LLUUID &uuid)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return res;
 }
@@ -2156,6 +2258,7 @@ S32 LLVOVolume::setTEBumpmap(const U8 te, const U8 bumpmap)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2167,6 +2270,7 @@ S32 LLVOVolume::setTETexGen(const U8 te, const U8 texgen)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2178,6 +2282,7 @@ S32 LLVOVolume::setTEMediaTexGen(const U8 te, const U8 media)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2189,6 +2294,7 @@ S32 LLVOVolume::setTEShiny(const U8 te, const U8 shiny)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2200,6 +2306,7 @@ S32 LLVOVolume::setTEFullbright(const U8 te, const U8 fullbright)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2211,6 +2318,7 @@ S32 LLVOVolume::setTEBumpShinyFullbright(const U8 te, const U8 bump)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return res;
 }
@@ -2222,6 +2330,7 @@ S32 LLVOVolume::setTEMediaFlags(const U8 te, const U8 media_flags)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -2233,6 +2342,7 @@ S32 LLVOVolume::setTEGlow(const U8 te, const F32 glow)
 	{
 		gPipeline.markTextured(mDrawable);
 		mFaceMappingChanged = TRUE;
+		updateVisualComplexity();
 	}
 	return  res;
 }
@@ -3818,6 +3928,16 @@ const LLMatrix4 LLVOVolume::getRenderMatrix() const
 	return mDrawable->getWorldMatrix();
 }
 
+namespace
+{
+	const U32 ARC_TEXTURE_COST = 16; // multiplier for texture resolution - performance tested
+
+	S32 get_texture_render_cost(const LLViewerTexture* texture)
+	{
+		return 256 + (S32)(ARC_TEXTURE_COST * (texture->getFullHeight() / 128.f + texture->getFullWidth() / 128.f));
+	}
+}
+
 // Returns a base cost and adds textures to passed in set.
 // total cost is returned value + 5 * size of the resulting set.
 // Cannot include cost of textures, as they may be re-used in linked
@@ -3831,6 +3951,90 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
      * the official viewer for consideration.
      *****************************************************************/
 
+	// per-prim costs
+	static const U32 ARC_LIGHT_COST = 500; // static cost for light-producing prims 
+	static const U32 ARC_MEDIA_FACE_COST = 1500; // static cost per media-enabled face 
+
+	if (mRenderCostDirty || !sCacheRenderCost)
+	{
+		updateRenderCostCache();
+	}
+
+	if (mRenderCostFree)
+	{
+		// something went wrong - user should know their content isn't render-free
+		return 0;
+	}
+
+	// textures are priced here rather than cached, their size is only
+	// known once they have loaded
+	for (std::vector<LLPointer<const LLViewerTexture> >::const_iterator iter = mRenderCostTextures.begin();
+		 iter != mRenderCostTextures.end(); ++iter)
+	{
+		const LLViewerTexture* texture = *iter;
+		if (textures.find(texture->getID()) == textures.end())
+		{
+			textures.insert(texture_cost_t::value_type(texture->getID(), get_texture_render_cost(texture)));
+		}
+	}
+
+	F32 shame = mRenderCostShame;
+
+	// add additional costs
+	shame += getParticleRenderCost();
+
+	if (getIsLight())
+	{
+		shame += ARC_LIGHT_COST;
+	}
+
+	if (mRenderCostMediaFaces)
+	{
+		shame += mRenderCostMediaFaces * ARC_MEDIA_FACE_COST;
+	}
+
+    // Streaming cost for animated objects includes a fixed cost
+    // per linkset. Add a corresponding charge here translated into
+    // triangles, but not weighted by any graphics properties.
+    if (isAnimatedObject() && isRootEdit())
+    {
+        shame += (ANIMATED_OBJECT_BASE_COST/0.06) * 5.0f;
+    }
+
+	if (shame > mRenderComplexity_current)
+	{
+		mRenderComplexity_current = (S32)shame;
+	}
+
+	return (U32)shame;
+}
+
+// The part of getRenderCost() for the particle source, which the object
+// updates can change or remove, and which stops by itself when it expires
+F32 LLVOVolume::getParticleRenderCost() const
+{
+	static const U32 ARC_PARTICLE_COST = 1; // determined experimentally
+	static const U32 ARC_PARTICLE_MAX = 2048; // default values
+
+	if (!isParticleSource())
+	{
+		return 0.f;
+	}
+
+	const LLPartSysData *part_sys_data = &(mPartSourcep->mPartSysData);
+	const LLPartData *part_data = &(part_sys_data->mPartData);
+	U32 num_particles = (U32)(part_sys_data->mBurstPartCount * llceil( part_data->mMaxAge / part_sys_data->mBurstRate));
+	num_particles = num_particles > ARC_PARTICLE_MAX ? ARC_PARTICLE_MAX : num_particles;
+	F32 part_size = (llmax(part_data->mStartScale[0], part_data->mEndScale[0]) + llmax(part_data->mStartScale[1], part_data->mEndScale[1])) / 2.f;
+	return num_particles * part_size * ARC_PARTICLE_COST;
+}
+
+// The part of getRenderCost() that walks the faces: the triangle based cost
+// with its per-face multipliers, the number of media faces and the textures
+// used. These only change with the TEs, the volume, the scale or the LOD,
+// which call markRenderCostDirty().
+void LLVOVolume::updateRenderCostCache() const
+{
 	// Get access to params we'll need at various points.  
 	// Skip if this is object doesn't have a volume (e.g. is an avatar).
 	BOOL has_volume = (getVolume() != NULL);
@@ -3840,14 +4044,6 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 
 	U32 num_triangles = 0;
 
-	// per-prim costs
-	static const U32 ARC_PARTICLE_COST = 1; // determined experimentally
-	static const U32 ARC_PARTICLE_MAX = 2048; // default values
-	static const U32 ARC_TEXTURE_COST = 16; // multiplier for texture resolution - performance tested
-	static const U32 ARC_LIGHT_COST = 500; // static cost for light-producing prims 
-	static const U32 ARC_MEDIA_FACE_COST = 1500; // static cost per media-enabled face 
-
-
 	// per-prim multipliers
 	static const F32 ARC_GLOW_MULT = 1.5f; // tested based on performance
 	static const F32 ARC_BUMP_MULT = 1.25f; // tested based on performance
@@ -3868,13 +4064,17 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 	U32 alpha = 0;
 	U32 flexi = 0;
 	U32 animtex = 0;
-	U32 particles = 0;
 	U32 bump = 0;
 	U32 planar = 0;
 	U32 weighted_mesh = 0;
-	U32 produces_light = 0;
 	U32 media_faces = 0;
 
+	mRenderCostDirty = FALSE;
+	mRenderCostFree = false;
+	mRenderCostShame = 0.f;
+	mRenderCostMediaFaces = 0;
+	mRenderCostTextures.clear();
+
 	const LLDrawable* drawablep = mDrawable;
 	U32 num_faces = drawablep->getNumFaces();
 
@@ -3924,22 +4124,18 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 			}
 			else
 			{
-				// something went wrong - user should know their content isn't render-free
-				return 0;
+				mRenderCostFree = true;
+				return;
 			}
 		}
 		else
 		{
 			const LLSculptParams *sculpt_params = (LLSculptParams *) getParameterEntry(LLNetworkData::PARAMS_SCULPT);
 			LLUUID sculpt_id = sculpt_params->getSculptTexture();
-			if (textures.find(sculpt_id) == textures.end())
+			LLViewerFetchedTexture *texture = LLViewerTextureManager::getFetchedTexture(sculpt_id);
+			if (texture)
 			{
-				LLViewerFetchedTexture *texture = LLViewerTextureManager::getFetchedTexture(sculpt_id);
-				if (texture)
-				{
-					S32 texture_cost = 256 + (S32)(ARC_TEXTURE_COST * (texture->getFullHeight() / 128.f + texture->getFullWidth() / 128.f));
-					textures.insert(texture_cost_t::value_type(sculpt_id, texture_cost));
-				}
+				mRenderCostTextures.push_back(texture);
 			}
 		}
 	}
@@ -3948,16 +4144,6 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 	{
 		flexi = 1;
 	}
-	if (isParticleSource())
-	{
-		particles = 1;
-	}
-
-	if (getIsLight())
-	{
-		produces_light = 1;
-	}
-
 	for (S32 i = 0; i < num_faces; ++i)
 	{
 		const LLFace* face = drawablep->getFace(i);
@@ -3965,13 +4151,9 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 		const LLTextureEntry* te = face->getTextureEntry();
 		const LLViewerTexture* img = face->getTexture();
 
-		if (img)
+		if (img && std::find(mRenderCostTextures.begin(), mRenderCostTextures.end(), img) == mRenderCostTextures.end())
 		{
-			if (textures.find(img->getID()) == textures.end())
-			{
-				S32 texture_cost = 256 + (S32)(ARC_TEXTURE_COST * (img->getFullHeight() / 128.f + img->getFullWidth() / 128.f));
-				textures.insert(texture_cost_t::value_type(img->getID(), texture_cost));
-			}
+			mRenderCostTextures.push_back(img);
 		}
 
 		if (face->getPoolType() == LLDrawPool::POOL_ALPHA)
@@ -4067,42 +4249,8 @@ U32 LLVOVolume::getRenderCost(texture_cost_t &textures) const
 		shame *= flexi * ARC_FLEXI_MULT;
 	}
 
-
-	// add additional costs
-	if (particles)
-	{
-		const LLPartSysData *part_sys_data = &(mPartSourcep->mPartSysData);
-		const LLPartData *part_data = &(part_sys_data->mPartData);
-		U32 num_particles = (U32)(part_sys_data->mBurstPartCount * llceil( part_data->mMaxAge / part_sys_data->mBurstRate));
-		num_particles = num_particles > ARC_PARTICLE_MAX ? ARC_PARTICLE_MAX : num_particles;
-		F32 part_size = (llmax(part_data->mStartScale[0], part_data->mEndScale[0]) + llmax(part_data->mStartScale[1], part_data->mEndScale[1])) / 2.f;
-		shame += num_particles * part_size * ARC_PARTICLE_COST;
-	}
-
-	if (produces_light)
-	{
-		shame += ARC_LIGHT_COST;
-	}
-
-	if (media_faces)
-	{
-		shame += media_faces * ARC_MEDIA_FACE_COST;
-	}
-
-    // Streaming cost for animated objects includes a fixed cost
-    // per linkset. Add a corresponding charge here translated into
-    // triangles, but not weighted by any graphics properties.
-    if (isAnimatedObject() && isRootEdit())
-    {
-        shame += (ANIMATED_OBJECT_BASE_COST/0.06) * 5.0f;
-    }
-
-	if (shame > mRenderComplexity_current)
-	{
-		mRenderComplexity_current = (S32)shame;
-	}
-
-	return (U32)shame;
+	mRenderCostShame = shame;
+	mRenderCostMediaFaces = media_faces;
 }
 
 F32 LLVOVolume::getEstTrianglesMax() const
@@ -4244,6 +4392,8 @@ void LLVOVolume::parameterChanged(U16 param_type, bool local_origin)
 void LLVOVolume::parameterChanged(U16 param_type, LLNetworkData* data, BOOL in_use, bool local_origin)
 {
 	LLViewerObject::parameterChanged(param_type, data, in_use, local_origin);
+	// light, particle, flexible and other parameters all count
+	updateVisualComplexity();
 	if (mVolumeImpl)
 	{
 		mVolumeImpl->onParameterChanged(param_type, data, in_use, local_origin);
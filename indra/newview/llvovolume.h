@@ -140,6 +140,8 @@ public:
 	/*virtual*/	const LLMatrix4	getRenderMatrix() const;
 				typedef std::map<LLUUID, S32> texture_cost_t;
 				U32 	getRenderCost(texture_cost_t &textures) const;
+				// Flags the face based part of the render cost for recomputation
+				void	markRenderCostDirty()					{ mRenderCostDirty = TRUE; }
     /*virtual*/	F32		getEstTrianglesMax() const;
     /*virtual*/	F32		getEstTrianglesStreamingCost() const;
     /* virtual*/ F32	getStreamingCost() const;
@@ -228,6 +230,23 @@ public:
 	/*virtual*/ void	updateFaceSize(S32 idx);
 	/*virtual*/ BOOL	updateLOD();
 				void	updateRadius();
+
+	// What calcLOD() works out for the volume at some distance from the
+	// camera. estimateLOD() only reads the volume, so it can run on a worker
+	// while the main thread waits; applyLODEstimate() does the rest of
+	// updateLOD() with it on the main thread.
+	struct LODEstimate
+	{
+		F32		mDistance;			// to the camera, as in mDistanceWRTCamera
+		F32		mRadius;
+		F32		mAdjustedDistance;
+		S32		mDetail;
+	};
+				// Returns false for rigged and HUD volumes, which need calcLOD()
+				bool	estimateLOD(F32 distance, F32 lod_factor, LODEstimate& estimate) const;
+				BOOL	applyLODEstimate(const LODEstimate& estimate);
+				// sLODFactor, corrected for the camera field of view. Main thread only.
+	static		F32		getLODFactor();
 	/*virtual*/ void	updateTextures();
 				void	updateTextureVirtualSize(bool forced = false);
 
@@ -346,6 +365,9 @@ public:
 
     // Flag any corresponding avatars as needing update.
     void updateVisualComplexity();
+    // Likewise when only the price of a texture or of the particles changed,
+    // the avatars cost their attachments again without recounting them.
+    void updateVisualComplexityCost();
     
 	void notifyMeshLoaded();
 	
@@ -375,8 +397,12 @@ public:
 	void clearRiggedVolume();
 
 protected:
-	S32	computeLODDetail(F32 distance, F32 radius, F32 lod_factor);
+	S32	computeLODDetail(F32 distance, F32 radius, F32 lod_factor) const;
 	BOOL calcLOD();
+	BOOL setLODDetail(S32 cur_detail);
+	BOOL finishUpdateLOD(BOOL lod_changed);
+	F32 getLODRadius() const;
+	static F32 adjustLODDistance(F32 distance);
 	LLFace* addFace(S32 face_index);
 	void updateTEData();
 
@@ -426,11 +452,21 @@ private:
 
 	LLPointer<LLRiggedVolume> mRiggedVolume;
 
+	// face based part of getRenderCost(), see updateRenderCostCache()
+	void updateRenderCostCache() const;
+	F32 getParticleRenderCost() const;
+	mutable BOOL	mRenderCostDirty;
+	mutable bool	mRenderCostFree;	// mesh not loaded, costs nothing yet
+	mutable F32		mRenderCostShame;
+	mutable U32		mRenderCostMediaFaces;
+	mutable std::vector<LLPointer<const LLViewerTexture> > mRenderCostTextures;
+
 	// statics
 public:
 	static F32 sLODSlopDistanceFactor;// Changing this to zero, effectively disables the LOD transition slop
 	static F32 sLODFactor;				// LOD scale factor
 	static F32 sDistanceFactor;			// LOD distance factor
+	static BOOL sCacheRenderCost;		// keep the face based render cost between changes
 
 	static LLPointer<LLObjectMediaDataClient> sObjectMediaClient;
 	static LLPointer<LLObjectMediaNavigateClient> sObjectMediaNavigateClient;
@@ -34,6 +34,7 @@
 #include "llviewercontrol.h"
 #include "llfasttimer.h"
 #include "llfontgl.h"
+#include "lljobscheduler.h"
 #include "llnamevalue.h"
 #include "llpointer.h"
 #include "llprimitive.h"
@@ -61,6 +62,7 @@
 #include "lldrawpoolwater.h"
 #include "llface.h"
 #include "llfeaturemanager.h"
+#include "llflexibleobject.h"
 #include "llfloatertelehub.h"
 #include "llfloaterreg.h"
 #include "llgldbg.h"
@@ -264,6 +266,8 @@ LLTrace::BlockTimerStatHandle FTM_RENDER_UI_SCENE_MON("Scene Mon");
 
 static LLTrace::BlockTimerStatHandle FTM_STATESORT_DRAWABLE("Sort Drawables");
 static LLTrace::BlockTimerStatHandle FTM_STATESORT_POSTSORT("Post Sort");
+static LLTrace::BlockTimerStatHandle FTM_STATESORT_CLASSIFY("Classify Drawables");
+static LLTrace::BlockTimerStatHandle FTM_STATESORT_APPLY("Apply Drawable Sort");
 
 static LLStaticHashedString sTint("tint");
 static LLStaticHashedString sAmbiance("ambiance");
@@ -326,6 +330,8 @@ LLRender::eTexIndex LLPipeline::sRenderHighlightTextureChannel = LLRender::DIFFU
 bool	LLPipeline::sForceOldBakedUpload = false;
 S32		LLPipeline::sUseOcclusion = 0;
 bool	LLPipeline::sDelayVBUpdate = true;
+bool	LLPipeline::sParallelStateSort = true;
+bool	LLPipeline::sShadowMultiCull = true;
 bool	LLPipeline::sAutoMaskAlphaDeferred = true;
 bool	LLPipeline::sAutoMaskAlphaNonDeferred = false;
 bool	LLPipeline::sDisableShaders = false;
@@ -530,6 +536,8 @@ void LLPipeline::init()
 	connectRefreshCachedSettingsSafe("RenderUseFarClip");
 	connectRefreshCachedSettingsSafe("RenderAvatarMaxNonImpostors");
 	connectRefreshCachedSettingsSafe("RenderDelayVBUpdate");
+	connectRefreshCachedSettingsSafe("RenderParallelStateSort");
+	connectRefreshCachedSettingsSafe("RenderShadowMultiCull");
 	connectRefreshCachedSettingsSafe("UseOcclusion");
 	connectRefreshCachedSettingsSafe("RenderAvatarVP");
 	connectRefreshCachedSettingsSafe("WindLightUseAtmosShaders");
@@ -1076,6 +1084,8 @@ void LLPipeline::refreshCachedSettings()
 	LLVOAvatar::sMaxNonImpostors = gSavedSettings.getU32("RenderAvatarMaxNonImpostors");
 	LLVOAvatar::updateImpostorRendering(LLVOAvatar::sMaxNonImpostors);
 	LLPipeline::sDelayVBUpdate = gSavedSettings.getBOOL("RenderDelayVBUpdate");
+	LLPipeline::sParallelStateSort = gSavedSettings.getBOOL("RenderParallelStateSort");
+	LLPipeline::sShadowMultiCull = gSavedSettings.getBOOL("RenderShadowMultiCull");
 
 	LLPipeline::sUseOcclusion = 
 			(!gUseWireframe
@@ -1776,6 +1786,8 @@ void LLPipeline::unlinkDrawable(LLDrawable *drawable)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_REMOVE_FROM_LIGHT_SET);
 		mLights.erase(drawablep);
+		mActiveLights.erase(drawablep);
+		mLightGrid.remove(drawablep);
 
 		for (light_set_t::iterator iter = mNearbyLights.begin();
 					iter != mNearbyLights.end(); iter++)
@@ -1825,6 +1837,8 @@ void LLPipeline::removeMutedAVsLights(LLVOAvatar* muted_avatar)
 		if (iter->drawable->getVObj()->isAttachment() && iter->drawable->getVObj()->getAvatar() == muted_avatar)
 		{
 			gPipeline.mLights.erase(iter->drawable);
+			gPipeline.mActiveLights.erase(iter->drawable);
+			gPipeline.mLightGrid.remove(iter->drawable);
 			gPipeline.mNearbyLights.erase(iter);
 		}
 	}
@@ -2482,6 +2496,99 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 		gOcclusionCubeProgram.unbind();
 	}
 
+	cullSkyAndWater(camera);
+	
+	gGL.matrixMode(LLRender::MM_PROJECTION);
+	gGL.popMatrix();
+	gGL.matrixMode(LLRender::MM_MODELVIEW);
+	gGL.popMatrix();
+
+	if (sUseOcclusion > 1)
+	{
+		gGL.setColorMask(true, false);
+	}
+
+	if (to_texture)
+	{
+		if (LLPipeline::sRenderDeferred && can_use_occlusion)
+		{
+			mOcclusionDepth.flush();
+		}
+		else
+		{
+			mScreen.flush();
+		}
+	}
+}
+
+// Culls for several shadow cameras in one walk of each partition. Each
+// result gets what updateCull() would have put in it for its camera.
+void LLPipeline::updateShadowCull(const std::vector<LLCullFrustum>& frustums)
+{
+	if (frustums.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_CULL);
+
+	LLViewerCamera::eCameraID saved_camera_id = LLViewerCamera::sCurCameraID;
+	S32 occlude = LLPipeline::sUseOcclusion;
+	LLPipeline::sUseOcclusion = 0;
+	LLPipeline::sShadowRender = true;
+
+	for (U32 i = 0; i < frustums.size(); ++i)
+	{
+		frustums[i].mResult->clear();
+		if (!sReflectionRender)
+		{
+			frustums[i].mCamera->disableUserClipPlane();
+		}
+	}
+
+	LLViewerCamera::sCurCameraID = frustums[0].mCameraID;
+	grabReferences(*frustums[0].mResult);
+
+	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+
+		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+		{
+			LLSpatialPartition* part = region->getSpatialPartition(i);
+			if (part)
+			{
+				if (hasRenderType(part->mDrawableType))
+				{
+					part->cullShadows(frustums);
+				}
+			}
+		}
+
+		//the VO Cache tree is only rebounded for shadow cameras
+		LLVOCachePartition* vo_part = region->getVOCachePartition();
+		if(vo_part)
+		{
+			LLViewerCamera::sCurCameraID = frustums[0].mCameraID;
+			vo_part->cull(*frustums[0].mCamera, false);
+		}
+	}
+
+	for (U32 i = 0; i < frustums.size(); ++i)
+	{
+		LLViewerCamera::sCurCameraID = frustums[i].mCameraID;
+		grabReferences(*frustums[i].mResult);
+		cullSkyAndWater(*frustums[i].mCamera);
+	}
+
+	LLViewerCamera::sCurCameraID = saved_camera_id;
+	LLPipeline::sUseOcclusion = occlude;
+	LLPipeline::sShadowRender = false;
+}
+
+void LLPipeline::cullSkyAndWater(LLCamera& camera)
+{
 	if (hasRenderType(LLPipeline::RENDER_TYPE_SKY) && 
 		gSky.mVOSkyp.notNull() && 
 		gSky.mVOSkyp->mDrawable.notNull())
@@ -2518,28 +2625,6 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
     {
         LLWorld::getInstance()->precullWaterObjects(camera, sCull, render_water);
     }
-	
-	gGL.matrixMode(LLRender::MM_PROJECTION);
-	gGL.popMatrix();
-	gGL.matrixMode(LLRender::MM_MODELVIEW);
-	gGL.popMatrix();
-
-	if (sUseOcclusion > 1)
-	{
-		gGL.setColorMask(true, false);
-	}
-
-	if (to_texture)
-	{
-		if (LLPipeline::sRenderDeferred && can_use_occlusion)
-		{
-			mOcclusionDepth.flush();
-		}
-		else
-		{
-			mScreen.flush();
-		}
-	}
 }
 
 void LLPipeline::markNotCulled(LLSpatialGroup* group, LLCamera& camera)
@@ -2977,6 +3062,9 @@ void LLPipeline::updateGeom(F32 max_dtime)
 	// for now, only LLVOVolume does this to throttle LOD changes
 	LLVOVolume::preUpdateGeom();
 
+	// step the flexible objects queued below all at once
+	LLVolumeImplFlexible::simulatePending();
+
 	// Iterate through all drawables on the priority build queue,
 	for (LLDrawable::drawable_list_t::iterator iter = mBuildQ1.begin();
 		 iter != mBuildQ1.end();)
@@ -3199,6 +3287,7 @@ void LLPipeline::shiftObjects(const LLVector3 &offset)
 			drawablep->clearState(LLDrawable::ON_SHIFT_LIST);
 		}
 		mShiftList.resize(0);
+		mLightGrid.shift(offset);
 	}
 
 	
@@ -3462,13 +3551,16 @@ void LLPipeline::stateSort(LLCamera& camera, LLCullResult &result)
 	
 	{
 		LL_RECORD_BLOCK_TIME(FTM_STATESORT_DRAWABLE);
-		for (LLCullResult::drawable_iterator iter = sCull->beginVisibleList();
-			 iter != sCull->endVisibleList(); ++iter)
+		if (!stateSortParallel(camera))
 		{
-			LLDrawable *drawablep = *iter;
-			if (!drawablep->isDead())
+			for (LLCullResult::drawable_iterator iter = sCull->beginVisibleList();
+				 iter != sCull->endVisibleList(); ++iter)
 			{
-				stateSort(drawablep, camera);
+				LLDrawable *drawablep = *iter;
+				if (!drawablep->isDead())
+				{
+					stateSort(drawablep, camera);
+				}
 			}
 		}
 	}
@@ -3476,6 +3568,207 @@ void LLPipeline::stateSort(LLCamera& camera, LLCullResult &result)
 	postSort(camera);	
 }
 
+namespace
+{
+	// Drawables a job classifies at a time
+	const S32 STATE_SORT_CHUNK_SIZE = 64;
+	// Fewer visible drawables than this are sorted on the main thread
+	const S32 MIN_PARALLEL_STATE_SORT = 512;
+
+	// What classifying found out about a drawable of the visible list
+	struct LLDrawableSortResult
+	{
+		enum EAction
+		{
+			SKIP = 0,	// not drawn
+			SORT,		// needs the whole of stateSort() on the main thread
+			VISIBLE,	// drawn, no distance update
+			ESTIMATED	// drawn, with the distance and LOD in mEstimate
+		};
+
+		U8							mAction;
+		LLVOVolume::LODEstimate		mEstimate;
+	};
+
+	// Filled on the main thread, then read by the jobs. The results are
+	// kept by list index, so they are applied in the order of the list
+	// whichever thread classified them.
+	struct LLStateSortContext
+	{
+		LLStateSortContext() : mNextChunk(0) {}
+
+		std::vector<LLDrawable*>			mDrawables;
+		std::vector<LLDrawableSortResult>	mResults;
+		LLCamera*							mCamera;
+		F32									mLODFactor;
+		bool								mDistanceUpdate;	// world camera and not a shift frame
+		bool								mEstimateLOD;		// no LOD debug display wants calcLOD()
+		bool								mHideSelected;
+		LLAtomicS32							mNextChunk;
+	};
+
+	// The checks at the top of LLPipeline::stateSort(LLDrawable*), and for
+	// static volumes the distance and LOD that updateDistance() would find.
+	// Only reads shared state and writes the drawable's own face distances.
+	void classify_drawable(LLStateSortContext& context, S32 index)
+	{
+		LLDrawable* drawablep = context.mDrawables[index];
+		LLDrawableSortResult& result = context.mResults[index];
+
+		if (drawablep->isDead())
+		{
+			result.mAction = LLDrawableSortResult::SKIP;
+			return;
+		}
+
+		if (drawablep->isAvatar() || drawablep->isSpatialBridge())
+		{
+			// avatars update their visibility as they are sorted
+			result.mAction = LLDrawableSortResult::SORT;
+			return;
+		}
+
+		if (!gPipeline.hasRenderType(drawablep->getRenderType())
+			|| (LLPipeline::RenderSpotLight && drawablep == LLPipeline::RenderSpotLight)
+			|| (context.mHideSelected && drawablep->getVObj().notNull() && drawablep->getVObj()->isSelected()))
+		{
+			result.mAction = LLDrawableSortResult::SKIP;
+			return;
+		}
+
+		result.mAction = LLDrawableSortResult::VISIBLE;
+		if (context.mDistanceUpdate && !drawablep->isActive())
+		{
+			LLVOVolume* volume = drawablep->getVOVolume();
+			if (context.mEstimateLOD && volume && !volume->getAvatar()
+				&& volume->estimateLOD(drawablep->updateVolumeDistance(*context.mCamera, false), context.mLODFactor, result.mEstimate))
+			{
+				result.mAction = LLDrawableSortResult::ESTIMATED;
+			}
+			else
+			{
+				result.mAction = LLDrawableSortResult::SORT;
+			}
+		}
+	}
+
+	// Classifies chunks of drawables until none are left
+	void classify_drawables(LLStateSortContext& context)
+	{
+		const S32 count = context.mDrawables.size();
+		for (S32 begin = context.mNextChunk++ * STATE_SORT_CHUNK_SIZE; begin < count;
+			 begin = context.mNextChunk++ * STATE_SORT_CHUNK_SIZE)
+		{
+			S32 end = llmin(begin + STATE_SORT_CHUNK_SIZE, count);
+			for (S32 i = begin; i < end; ++i)
+			{
+				classify_drawable(context, i);
+			}
+		}
+	}
+
+	class LLStateSortJob : public LLJob
+	{
+	public:
+		LLStateSortJob(LLStateSortContext& context)
+		:	LLJob(PRIORITY_HIGH),
+			mContext(context)
+		{
+		}
+
+	protected:
+		/*virtual*/ void run()
+		{
+			classify_drawables(mContext);
+		}
+
+	private:
+		LLStateSortContext& mContext;
+	};
+
+	LLStateSortContext sStateSortContext;
+}
+
+// Classifies the visible list on the job scheduler, then sorts it in order
+// on the main thread. Returns false if the list is to be sorted serially.
+bool LLPipeline::stateSortParallel(LLCamera& camera)
+{
+	LLJobScheduler* scheduler = LLJobScheduler::getDefault();
+	S32 count = sCull->getVisibleListSize();
+	if (!sParallelStateSort || !scheduler || count < MIN_PARALLEL_STATE_SORT)
+	{
+		return false;
+	}
+
+	static LLCachedControl<bool> debug_lods(gSavedSettings, "DebugObjectLODs", false);
+
+	LLStateSortContext& context = sStateSortContext;
+	context.mDrawables.assign(sCull->beginVisibleList(), sCull->endVisibleList());
+	context.mResults.resize(count);
+	context.mCamera = &camera;
+	context.mDistanceUpdate = LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD && !gShiftFrame;
+	context.mLODFactor = LLVOVolume::getLODFactor();
+	context.mEstimateLOD = !debug_lods
+		&& !hasRenderDebugMask(RENDER_DEBUG_TRIANGLE_COUNT)
+		&& !hasRenderDebugMask(RENDER_DEBUG_LOD_INFO);
+	context.mHideSelected = LLSelectMgr::getInstance()->mHideSelectedObjects;
+	context.mNextChunk = 0;
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_STATESORT_CLASSIFY);
+		// the main thread classifies too, so there is no more than one job per worker
+		std::vector<LLJob::ptr_t> jobs;
+		S32 chunks = (count + STATE_SORT_CHUNK_SIZE - 1) / STATE_SORT_CHUNK_SIZE;
+		U32 job_count = llmin(scheduler->getThreadCount(), (U32)chunks - 1);
+		for (U32 i = 0; i < job_count; ++i)
+		{
+			jobs.push_back(new LLStateSortJob(context));
+			scheduler->submit(jobs.back());
+		}
+		classify_drawables(context);
+		for (U32 i = 0; i < jobs.size(); ++i)
+		{
+			scheduler->waitFor(jobs[i]);
+		}
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_STATESORT_APPLY);
+	assertInitialized();
+	for (S32 i = 0; i < count; ++i)
+	{
+		LLDrawable* drawablep = context.mDrawables[i];
+		const LLDrawableSortResult& result = context.mResults[i];
+		switch (result.mAction)
+		{
+		case LLDrawableSortResult::SORT:
+			if (!drawablep->isDead())
+			{
+				stateSort(drawablep, camera);
+			}
+			break;
+		case LLDrawableSortResult::VISIBLE:
+		case LLDrawableSortResult::ESTIMATED:
+			if (!drawablep->isState(LLDrawable::INVISIBLE|LLDrawable::FORCE_INVISIBLE))
+			{
+				drawablep->setVisible(camera, NULL, FALSE);
+			}
+			if (result.mAction == LLDrawableSortResult::ESTIMATED)
+			{
+				drawablep->mDistanceWRTCamera = result.mEstimate.mDistance;
+				drawablep->getVOVolume()->applyLODEstimate(result.mEstimate);
+			}
+			stateSortFaces(drawablep);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// the list holds references, the copy does not
+	context.mDrawables.clear();
+	return true;
+}
+
 void LLPipeline::stateSort(LLSpatialGroup* group, LLCamera& camera)
 {
 	if (group->changeLOD())
@@ -3571,6 +3864,11 @@ void LLPipeline::stateSort(LLDrawable* drawablep, LLCamera& camera)
 		}
 	}
 
+	stateSortFaces(drawablep);
+}
+
+void LLPipeline::stateSortFaces(LLDrawable* drawablep)
+{
 	if (!drawablep->getVOVolume())
 	{
 		for (LLDrawable::face_list_t::iterator iter = drawablep->mFaces.begin();
@@ -6103,6 +6401,21 @@ void LLPipeline::calcNearbyLights(LLCamera& camera)
 
 		F32 max_dist = LIGHT_MAX_RADIUS * 4.f; // ignore enitrely lights > 4 * max light rad
 		
+		// PLACE LIGHTS THAT STOPPED MOVING IN THE GRID
+		LLDrawable::drawable_vector_t settled_lights;
+		for (LLDrawable::drawable_set_t::iterator iter = mActiveLights.begin();
+			 iter != mActiveLights.end(); ++iter)
+		{
+			if (!(*iter)->isActive())
+			{
+				settled_lights.push_back(*iter);
+			}
+		}
+		for (U32 i = 0; i < settled_lights.size(); ++i)
+		{
+			updateLightIndex(settled_lights[i]);
+		}
+
 		// UPDATE THE EXISTING NEARBY LIGHTS
 		light_set_t cur_nearby_lights;
 		for (light_set_t::iterator iter = mNearbyLights.begin();
@@ -6142,40 +6455,79 @@ void LLPipeline::calcNearbyLights(LLCamera& camera)
 		mNearbyLights = cur_nearby_lights;
 				
 		// FIND NEW LIGHTS THAT ARE IN RANGE
-		light_set_t new_nearby_lights;
-		for (LLDrawable::drawable_set_t::iterator iter = mLights.begin();
-			 iter != mLights.end(); ++iter)
+		class LightCollector : public LLLightGrid::Visitor
 		{
-			LLDrawable* drawable = *iter;
-			LLVOVolume* light = drawable->getVOVolume();
-			if (!light || drawable->isState(LLDrawable::NEARBY_LIGHT))
-			{
-				continue;
-			}
-			if (light->isHUDAttachment())
+		public:
+			LightCollector(const LLVector3& cam_pos, F32 max_dist)
+			:	mCamPos(cam_pos),
+				mMaxDist(max_dist)
 			{
-				continue; // no lighting from HUD objects
 			}
-			F32 dist = calc_light_dist(light, cam_pos, max_dist);
-			if (dist >= max_dist)
+
+			void add(LLDrawable* drawable)
 			{
-				continue;
+				LLVOVolume* light = drawable->getVOVolume();
+				if (!light || drawable->isState(LLDrawable::NEARBY_LIGHT))
+				{
+					return;
+				}
+				if (light->isHUDAttachment())
+				{
+					return; // no lighting from HUD objects
+				}
+				F32 dist = calc_light_dist(light, mCamPos, mMaxDist);
+				if (dist >= mMaxDist)
+				{
+					return;
+				}
+				if (!sRenderAttachedLights && light && light->isAttachment())
+				{
+					return;
+				}
+				mLights.insert(Light(drawable, dist, 0.f));
+				if (mLights.size() > (U32)MAX_LOCAL_LIGHTS)
+				{
+					mLights.erase(--mLights.end());
+					const Light& last = *mLights.rbegin();
+					mMaxDist = last.dist;
+				}
 			}
-			if (!sRenderAttachedLights && light && light->isAttachment())
+
+			// a light is only near if it is within max_dist plus its radius
+			/*virtual*/ F32 visit(LLDrawable* light, F32 range)
 			{
-				continue;
+				add(light);
+				return mMaxDist + LIGHT_MAX_RADIUS;
 			}
-			new_nearby_lights.insert(Light(drawable, dist, 0.f));
-			if (new_nearby_lights.size() > (U32)MAX_LOCAL_LIGHTS)
+
+			const LLVector3 mCamPos;
+			F32 mMaxDist;
+			light_set_t mLights;
+		};
+
+		LightCollector collector(cam_pos, max_dist);
+		for (LLDrawable::drawable_set_t::iterator iter = mActiveLights.begin();
+			 iter != mActiveLights.end(); ++iter)
+		{
+			collector.add(*iter);
+		}
+
+		// selected lights come first wherever they are
+		LLObjectSelectionHandle selection = LLSelectMgr::getInstance()->getSelection();
+		for (LLObjectSelection::iterator iter = selection->begin(); iter != selection->end(); ++iter)
+		{
+			LLViewerObject* object = (*iter)->getObject();
+			if (object && object->mDrawable.notNull() && mLightGrid.contains(object->mDrawable))
 			{
-				new_nearby_lights.erase(--new_nearby_lights.end());
-				const Light& last = *new_nearby_lights.rbegin();
-				max_dist = last.dist;
+				collector.add(object->mDrawable);
 			}
 		}
 
+		mLightGrid.visitNearest(cam_pos, collector.mMaxDist + LIGHT_MAX_RADIUS, collector);
+		const light_set_t& new_nearby_lights = collector.mLights;
+
 		// INSERT ANY NEW LIGHTS
-		for (light_set_t::iterator iter = new_nearby_lights.begin();
+		for (light_set_t::const_iterator iter = new_nearby_lights.begin();
 			 iter != new_nearby_lights.end(); iter++)
 		{
 			const Light* light = &(*iter);
@@ -6824,15 +7176,40 @@ void LLPipeline::setLight(LLDrawable *drawablep, bool is_light)
 		{
 			mLights.insert(drawablep);
 			drawablep->setState(LLDrawable::LIGHT);
+			// placed in the grid by calcNearbyLights() once it has its position
+			mLightGrid.remove(drawablep);
+			mActiveLights.insert(drawablep);
 		}
 		else
 		{
 			drawablep->clearState(LLDrawable::LIGHT);
 			mLights.erase(drawablep);
+			updateLightIndex(drawablep);
 		}
 	}
 }
 
+void LLPipeline::updateLightIndex(LLDrawable* drawablep)
+{
+	if (drawablep->isDead() || !drawablep->isState(LLDrawable::LIGHT))
+	{
+		mActiveLights.erase(drawablep);
+		mLightGrid.remove(drawablep);
+	}
+	else if (drawablep->isActive())
+	{
+		mLightGrid.remove(drawablep);
+		mActiveLights.insert(drawablep);
+	}
+	else
+	{
+		// static drawables become active before they move, so the
+		// position stays good until then
+		mActiveLights.erase(drawablep);
+		mLightGrid.update(drawablep, drawablep->getPositionAgent());
+	}
+}
+
 //static
 void LLPipeline::toggleRenderType(U32 type)
 {
@@ -8722,7 +9099,15 @@ void LLPipeline::renderDeferredLighting(LLRenderTarget* screen_target)
 				mCubeVB->setBuffer(LLVertexBuffer::MAP_VERTEX);
 				
 				LLGLDepthTest depth(GL_TRUE, GL_FALSE);
-				for (LLDrawable::drawable_set_t::iterator iter = mLights.begin(); iter != mLights.end(); ++iter)
+
+				// static lights past the far clip are left out by cell, the
+				// rest are checked one by one below. Sorted, they are drawn
+				// in the same order as mLights.
+				std::vector<LLDrawable*> lights(mActiveLights.begin(), mActiveLights.end());
+				mLightGrid.getLightsInRange(LLViewerCamera::getInstance()->getOrigin(), RenderFarClip + LIGHT_MAX_RADIUS, lights);
+				std::sort(lights.begin(), lights.end());
+
+				for (std::vector<LLDrawable*>::iterator iter = lights.begin(); iter != lights.end(); ++iter)
 				{
 					LLDrawable* drawablep = *iter;
 					
@@ -9620,7 +10005,7 @@ static LLTrace::BlockTimerStatHandle FTM_SHADOW_ALPHA_TREE("Alpha Tree");
 static LLTrace::BlockTimerStatHandle FTM_SHADOW_ALPHA_GRASS("Alpha Grass");
 static LLTrace::BlockTimerStatHandle FTM_SHADOW_FULLBRIGHT_ALPHA_MASKED("Fullbright Alpha Masked");
 
-void LLPipeline::renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera& shadow_cam, LLCullResult &result, bool use_shader, bool use_occlusion, U32 target_width)
+void LLPipeline::renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera& shadow_cam, LLCullResult &result, bool use_shader, bool use_occlusion, U32 target_width, bool culled)
 {
 	LL_RECORD_BLOCK_TIME(FTM_SHADOW_RENDER);
 
@@ -9660,9 +10045,12 @@ void LLPipeline::renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera
 
 	LLRenderTarget& occlusion_target = mShadowOcclusion[LLViewerCamera::sCurCameraID-1];
 
-	occlusion_target.bindTarget();
-	updateCull(shadow_cam, result);
-	occlusion_target.flush();
+	if (!culled)
+	{
+		occlusion_target.bindTarget();
+		updateCull(shadow_cam, result);
+		occlusion_target.flush();
+	}
 
 	stateSort(shadow_cam, result);
 	
@@ -10304,6 +10692,13 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 	}
 	else
 	{
+		// the cameras of all splits are worked out before any is rendered,
+		// so that they can be culled in one walk of the octree
+		LLCamera shadow_cams[4];
+		glh::matrix4f last_shadow_view[4];
+		glh::matrix4f last_shadow_proj[4];
+		bool has_receivers[4] = { false, false, false, false };
+
 		for (S32 j = 0; j < 4; j++)
 		{
 			if (!hasRenderDebugMask(RENDER_DEBUG_SHADOW_FRUSTA))
@@ -10320,7 +10715,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 			LLVector3 eye = camera.getOrigin();
 
 			//camera used for shadow cull/render
-			LLCamera shadow_cam;
+			LLCamera& shadow_cam = shadow_cams[j];
 		
 			//create world space camera frustum for this split
 			shadow_cam = camera;
@@ -10642,14 +11037,8 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 							0.f, 0.f, 0.5f, 0.5f,
 							0.f, 0.f, 0.f, 1.f);
 
-			set_current_modelview(view[j]);
-			set_current_projection(proj[j]);
-
-			for (U32 i = 0; i < 16; i++)
-			{
-				gGLLastModelView[i] = mShadowModelview[j].m[i];
-				gGLLastProjection[i] = mShadowProjection[j].m[i];
-			}
+			last_shadow_view[j] = mShadowModelview[j];
+			last_shadow_proj[j] = mShadowProjection[j];
 
 			mShadowModelview[j] = view[j];
 			mShadowProjection[j] = proj[j];
@@ -10657,22 +11046,57 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
 		
 			stop_glerror();
 
+			has_receivers[j] = true;
+		}
+
+		static LLCullResult result[4];
+		bool culled = false;
+		if (sShadowMultiCull)
+		{
+			std::vector<LLCullFrustum> frustums;
+			for (S32 j = 0; j < 4; j++)
+			{
+				if (has_receivers[j])
+				{
+					LLCullFrustum frustum = { &shadow_cams[j], &result[j], (LLViewerCamera::eCameraID)(LLViewerCamera::CAMERA_SHADOW0+j) };
+					frustums.push_back(frustum);
+				}
+			}
+			updateShadowCull(frustums);
+			culled = true;
+		}
+
+		for (S32 j = 0; j < 4; j++)
+		{
+			if (!has_receivers[j])
+			{
+				continue;
+			}
+
+			LLViewerCamera::sCurCameraID = (LLViewerCamera::eCameraID)(LLViewerCamera::CAMERA_SHADOW0+j);
+
+			set_current_modelview(view[j]);
+			set_current_projection(proj[j]);
+
+			for (U32 i = 0; i < 16; i++)
+			{
+				gGLLastModelView[i] = last_shadow_view[j].m[i];
+				gGLLastProjection[i] = last_shadow_proj[j].m[i];
+			}
+
 			mShadow[j].bindTarget();
 			mShadow[j].getViewport(gGLViewport);
 			mShadow[j].clear();
 		
 			U32 target_width = mShadow[j].getWidth();
 
-			{
-				static LLCullResult result[4];
-				renderShadow(view[j], proj[j], shadow_cam, result[j], TRUE, FALSE, target_width);
-			}
+			renderShadow(view[j], proj[j], shadow_cams[j], result[j], TRUE, FALSE, target_width, culled);
 
 			mShadow[j].flush();
  
 			if (!gPipeline.hasRenderDebugMask(LLPipeline::RENDER_DEBUG_SHADOW_FRUSTA))
 			{
-				mShadowCamera[j+4] = shadow_cam;
+				mShadowCamera[j+4] = shadow_cams[j];
 			}
 		}
 	}
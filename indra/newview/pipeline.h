@@ -37,6 +37,7 @@
 #include "lldrawpoolmaterials.h"
 #include "llgl.h"
 #include "lldrawable.h"
+#include "lllightgrid.h"
 #include "llrendertarget.h"
 
 #include <stack>
@@ -246,6 +247,8 @@ public:
 	bool getVisibleExtents(LLCamera& camera, LLVector3 &min, LLVector3& max);
 	bool getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir = LLVector3(0,0,0));
 	void updateCull(LLCamera& camera, LLCullResult& result, S32 water_clip = 0, LLPlane* plane = NULL);  //if water_clip is 0, ignore water plane, 1, cull to above plane, -1, cull to below plane
+	void updateShadowCull(const std::vector<LLCullFrustum>& frustums);
+	void cullSkyAndWater(LLCamera& camera);
 	void createObjects(F32 max_dtime);
 	void createObject(LLViewerObject* vobj);
 	void processPartitionQ();
@@ -264,6 +267,8 @@ public:
 	void stateSort(LLSpatialGroup* group, LLCamera& camera);
 	void stateSort(LLSpatialBridge* bridge, LLCamera& camera, BOOL fov_changed = FALSE);
 	void stateSort(LLDrawable* drawablep, LLCamera& camera);
+	bool stateSortParallel(LLCamera& camera);
+	void stateSortFaces(LLDrawable* drawablep);
 	void postSort(LLCamera& camera);
 	void forAllVisibleDrawables(void (*func)(LLDrawable*));
 
@@ -303,7 +308,7 @@ public:
 	void setHighlightObject(LLDrawable* obj) { mHighlightObject = obj; }
 
 
-	void renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera& camera, LLCullResult& result, bool use_shader, bool use_occlusion, U32 target_width);
+	void renderShadow(glh::matrix4f& view, glh::matrix4f& proj, LLCamera& camera, LLCullResult& result, bool use_shader, bool use_occlusion, U32 target_width, bool culled = false); // culled: result already holds the cull of camera
 	void renderHighlights();
 	void renderDebug();
 	void renderPhysicsDisplay();
@@ -330,6 +335,9 @@ public:
 	void shiftObjects(const LLVector3 &offset);
 
 	void setLight(LLDrawable *drawablep, bool is_light);
+	// Files a light under mLightGrid or mActiveLights, or removes it from
+	// both if it is no longer a light
+	void updateLightIndex(LLDrawable* drawablep);
 	
 	bool hasRenderBatches(const U32 type) const;
 	LLCullResult::drawinfo_iterator beginRenderMap(U32 type);
@@ -574,6 +582,8 @@ public:
 	static bool				sForceOldBakedUpload; // If true will not use capabilities to upload baked textures.
 	static S32				sUseOcclusion;  // 0 = no occlusion, 1 = read only, 2 = read/write
 	static bool				sDelayVBUpdate;
+	static bool				sParallelStateSort;
+	static bool				sShadowMultiCull;
 	static bool				sAutoMaskAlphaDeferred;
 	static bool				sAutoMaskAlphaNonDeferred;
 	static bool				sDisableShaders; // if true, rendering will be done without shaders
@@ -729,6 +739,10 @@ protected:
 	
 	LLDrawable::drawable_set_t		mLights;
 	light_set_t						mNearbyLights; // lights near camera
+	// Every light in mLights is in one of these: static lights in the grid
+	// at their position, lights that move or were not placed yet in the set
+	LLLightGrid						mLightGrid;
+	LLDrawable::drawable_set_t		mActiveLights;
 	LLColor4						mHWLightColors[8];
 	
 	/////////////////////////////////////////////
@@ -0,0 +1,297 @@
+/**
+ * @file llcomplexitytally_test.cpp
+ * @brief Running attachment complexity totals against a full recount.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llcomplexitytally.h"
+
+#include "llmath.h"
+
+#include <map>
+#include <vector>
+
+namespace
+{
+	U32 irand(U32& seed, U32 range)
+	{
+		seed = seed * 1103515245 + 12345;
+		return ((seed >> 8) & 0xffffff) % range;
+	}
+
+	LLUUID make_id(U32 n)
+	{
+		LLUUID id;
+		memcpy(id.mData, &n, sizeof(n));
+		return id;
+	}
+
+	// The objects an avatar is wearing, and what the old code summed over
+	// all of them on every update
+	struct Outfit
+	{
+		LLComplexityTally::Entry random_entry(U32& seed)
+		{
+			LLComplexityTally::Entry entry;
+			// some beyond the clamp, some free while their mesh loads
+			entry.mCost = irand(seed, 10) ? (F32)irand(seed, 60000) * 0.75f : (F32)(irand(seed, 2) * 2000000);
+			entry.mTriangles = irand(seed, 100000);
+			entry.mEstTriangles = (F32)irand(seed, 200000) * 0.5f;
+			entry.mSurfaceArea = (F32)irand(seed, 1000) * 0.01f;
+			return entry;
+		}
+
+		void update(LLComplexityTally& tally, F32 min_cost, F32 max_cost, S32& recomputed)
+		{
+			tally.beginUpdate(min_cost, max_cost);
+			for (std::map<U32, LLComplexityTally::Entry>::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
+			{
+				LLUUID id = make_id(iter->first);
+				if (tally.needsUpdate(id))
+				{
+					tally.update(id, iter->second);
+					++recomputed;
+				}
+				else
+				{
+					tally.updateCost(id, iter->second.mCost);
+				}
+			}
+			tally.endUpdate();
+		}
+
+		bool same_totals(const LLComplexityTally& tally, F32 min_cost, F32 max_cost)
+		{
+			U32 cost = 0;
+			U32 triangles = 0;
+			F32 est_triangles = 0.f;
+			F32 area = 0.f;
+			for (std::map<U32, LLComplexityTally::Entry>::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
+			{
+				const LLComplexityTally::Entry& entry = iter->second;
+				cost += (U32)llclamp(entry.mCost, min_cost, max_cost);
+				triangles += entry.mTriangles;
+				est_triangles += entry.mEstTriangles;
+				area += entry.mSurfaceArea;
+			}
+			return tally.getCount() == (S32)mObjects.size()
+				&& tally.getCost() == cost
+				&& tally.getTriangles() == triangles
+				&& fabsf(tally.getEstTriangles() - est_triangles) <= 1.e-4f * llmax(1.f, est_triangles)
+				&& fabsf(tally.getSurfaceArea() - area) <= 1.e-4f * llmax(1.f, area);
+		}
+
+		std::map<U32, LLComplexityTally::Entry> mObjects;
+	};
+}
+
+namespace tut
+{
+	struct complexity_tally
+	{
+	};
+
+	typedef test_group<complexity_tally> complexity_tally_test;
+	typedef complexity_tally_test::object complexity_tally_t;
+	complexity_tally_test tut_complexity_tally("LLComplexityTally");
+
+	// only new and changed objects are costed again
+	template<> template<>
+	void complexity_tally_t::test<1>()
+	{
+		U32 seed = 1;
+		Outfit outfit;
+		LLComplexityTally tally;
+		for (U32 i = 0; i < 300; ++i)
+		{
+			outfit.mObjects[i] = outfit.random_entry(seed);
+		}
+
+		S32 recomputed = 0;
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure_equals("all new", recomputed, 300);
+		ensure("first update", outfit.same_totals(tally, 0.f, 1.0e6f));
+
+		recomputed = 0;
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure_equals("nothing changed", recomputed, 0);
+
+		outfit.mObjects[7] = outfit.random_entry(seed);
+		tally.markChanged(make_id(7));
+		tally.markChanged(make_id(1000));
+		recomputed = 0;
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure_equals("one changed", recomputed, 1);
+		ensure("changed", outfit.same_totals(tally, 0.f, 1.0e6f));
+
+		tally.markAllChanged();
+		recomputed = 0;
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure_equals("all changed", recomputed, 300);
+
+		outfit.mObjects.clear();
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure("all removed", outfit.same_totals(tally, 0.f, 1.0e6f) && tally.getCost() == 0);
+	}
+
+	// random attaches, detaches, edits and clamp changes, compared to
+	// summing every object after each update
+	template<> template<>
+	void complexity_tally_t::test<2>()
+	{
+		U32 seed = 2;
+		Outfit outfit;
+		LLComplexityTally tally;
+		F32 max_cost = 1.0e6f;
+		U32 next_id = 0;
+		S32 recomputed = 0;
+
+		for (S32 update = 0; update < 2000; ++update)
+		{
+			S32 changes = irand(seed, 8);
+			for (S32 i = 0; i < changes; ++i)
+			{
+				U32 op = irand(seed, 10);
+				if (op < 4 || outfit.mObjects.empty())
+				{
+					// attach, sometimes one that was worn before
+					U32 id = irand(seed, 4) ? next_id++ : irand(seed, next_id + 1);
+					outfit.mObjects[id] = outfit.random_entry(seed);
+					tally.markChanged(make_id(id));
+				}
+				else
+				{
+					std::map<U32, LLComplexityTally::Entry>::iterator iter = outfit.mObjects.begin();
+					std::advance(iter, irand(seed, outfit.mObjects.size()));
+					if (op < 6)
+					{
+						// detach
+						tally.markChanged(make_id(iter->first));
+						outfit.mObjects.erase(iter);
+					}
+					else
+					{
+						// texture, volume or LOD change
+						iter->second = outfit.random_entry(seed);
+						tally.markChanged(make_id(iter->first));
+					}
+				}
+			}
+
+			if (!irand(seed, 100))
+			{
+				max_cost = irand(seed, 2) ? 1.0e6f : (F32)(20000 + irand(seed, 50000));
+			}
+
+			outfit.update(tally, 0.f, max_cost, recomputed);
+			ensure(llformat("update %d", update), outfit.same_totals(tally, 0.f, max_cost));
+		}
+
+		ensure("work saved", recomputed < 2000 * 8);
+	}
+
+	// an edit to a child prim is costed again through its root, the way
+	// LLVOAvatar::updateVisualComplexity(changed_object) marks it
+	template<> template<>
+	void complexity_tally_t::test<3>()
+	{
+		U32 seed = 3;
+		Outfit outfit;
+		LLComplexityTally tally;
+		const U32 LINKSETS = 20;
+		const U32 CHILDREN = 5;
+		std::map<U32, std::vector<LLComplexityTally::Entry> > prims;
+		for (U32 root = 0; root < LINKSETS; ++root)
+		{
+			for (U32 child = 0; child < CHILDREN; ++child)
+			{
+				prims[root].push_back(outfit.random_entry(seed));
+			}
+		}
+
+		// the entry of a root covers all of its prims, as
+		// accountRenderComplexityForObject() sums them
+		for (S32 edit = 0; edit < 200; ++edit)
+		{
+			for (U32 root = 0; root < LINKSETS; ++root)
+			{
+				LLComplexityTally::Entry& entry = outfit.mObjects[root];
+				entry = LLComplexityTally::Entry();
+				for (U32 child = 0; child < CHILDREN; ++child)
+				{
+					const LLComplexityTally::Entry& prim = prims[root][child];
+					entry.mCost += prim.mCost;
+					entry.mTriangles += prim.mTriangles;
+					entry.mEstTriangles += prim.mEstTriangles;
+					entry.mSurfaceArea += prim.mSurfaceArea;
+				}
+			}
+
+			S32 recomputed = 0;
+			outfit.update(tally, 0.f, 1.0e7f, recomputed);
+			ensure(llformat("edit %d", edit), outfit.same_totals(tally, 0.f, 1.0e7f));
+			ensure(llformat("edit %d recomputed", edit), edit == 0 ? recomputed == (S32)LINKSETS : recomputed <= 1);
+
+			// a scale, parameter or LOD change to one child prim
+			U32 root = irand(seed, LINKSETS);
+			prims[root][1 + irand(seed, CHILDREN - 1)] = outfit.random_entry(seed);
+			tally.markChanged(make_id(root));
+		}
+	}
+
+	// textures that load at their full size and particle sources that start
+	// or stop change the cost of an object without marking it changed
+	template<> template<>
+	void complexity_tally_t::test<4>()
+	{
+		U32 seed = 4;
+		Outfit outfit;
+		LLComplexityTally tally;
+		for (U32 i = 0; i < 50; ++i)
+		{
+			outfit.mObjects[i] = outfit.random_entry(seed);
+		}
+
+		S32 recomputed = 0;
+		outfit.update(tally, 0.f, 1.0e6f, recomputed);
+		ensure("first update", outfit.same_totals(tally, 0.f, 1.0e6f));
+
+		for (S32 update = 0; update < 100; ++update)
+		{
+			for (S32 i = irand(seed, 4); i > 0; --i)
+			{
+				LLComplexityTally::Entry& entry = outfit.mObjects[irand(seed, 50)];
+				entry.mCost = irand(seed, 10) ? entry.mCost + (F32)irand(seed, 600) : (F32)irand(seed, 2000000);
+			}
+
+			recomputed = 0;
+			outfit.update(tally, 0.f, 60000.f, recomputed);
+			ensure_equals(llformat("update %d recomputed", update), recomputed, 0);
+			ensure(llformat("update %d", update), outfit.same_totals(tally, 0.f, 60000.f));
+		}
+	}
+}
@@ -0,0 +1,347 @@
+/**
+ * @file lldecodedtexturecache_test.cpp
+ * @brief Tests and revisit benchmark for LLDecodedTextureCache.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../lldecodedtexturecache.h"
+
+#include "lldir.h"
+#include "llfile.h"
+#include "llimage.h"
+#include "llimagej2c.h"
+#include "lltimer.h"
+
+#include <thread>
+
+namespace
+{
+	// Smooth pattern with some detail, compresses like a real texture
+	LLPointer<LLImageRaw> make_image(S32 width, S32 height, S32 components, S32 seed)
+	{
+		LLPointer<LLImageRaw> raw = new LLImageRaw(width, height, components);
+		U8* data = raw->getData();
+		for (S32 y = 0; y < height; ++y)
+		{
+			for (S32 x = 0; x < width; ++x)
+			{
+				for (S32 c = 0; c < components; ++c)
+				{
+					*data++ = (U8)(x * (c + 1) + y * 3 + seed * 17 + ((x ^ y) & 7));
+				}
+			}
+		}
+		return raw;
+	}
+
+	bool same_image(const LLImageRaw* a, const LLImageRaw* b)
+	{
+		return a->getWidth() == b->getWidth()
+			&& a->getHeight() == b->getHeight()
+			&& a->getComponents() == b->getComponents()
+			&& 0 == memcmp(a->getData(), b->getData(), a->getDataSize());
+	}
+
+	// One of several fetch workers sharing a few ids: writes at various
+	// discard levels, reads and removes, counting reads that do not come
+	// back as written.
+	struct CacheUser
+	{
+		CacheUser(LLDecodedTextureCache* cache, const std::vector<LLUUID>* ids, S32 seed, S32* bad)
+			: mCache(cache), mIDs(ids), mSeed(seed), mBad(bad)
+		{
+		}
+
+		void operator()()
+		{
+			for (S32 i = 0; i < 400; ++i)
+			{
+				S32 index = (i * 7 + mSeed) % (S32)mIDs->size();
+				const LLUUID& id = (*mIDs)[index];
+				S32 discard = (i + mSeed) % 3;
+				switch ((i + mSeed) % 5)
+				{
+				case 0:
+				case 1:
+					mCache->write(id, make_image(64 >> discard, 64 >> discard, 4, index), discard);
+					break;
+				case 4:
+					mCache->remove(id);
+					break;
+				default:
+				{
+					S32 found_discard;
+					LLPointer<LLImageRaw> found = mCache->read(id, 2, found_discard);
+					if (found.notNull()
+						&& !same_image(found, make_image(64 >> found_discard, 64 >> found_discard, 4, index)))
+					{
+						++*mBad;
+					}
+				}
+				}
+			}
+		}
+
+		LLDecodedTextureCache* mCache;
+		const std::vector<LLUUID>* mIDs;
+		S32 mSeed;
+		S32* mBad;
+	};
+}
+
+namespace tut
+{
+	struct decoded_cache
+	{
+		decoded_cache()
+		{
+			LLUUID id;
+			id.generate();
+			mDirName = std::string(LLFile::tmpdir()) + "decoded_cache_test_" + id.asString();
+		}
+
+		~decoded_cache()
+		{
+			gDirUtilp->deleteFilesInDir(mDirName, "*");
+			LLFile::rmdir(mDirName);
+		}
+
+		std::string mDirName;
+	};
+
+	typedef test_group<decoded_cache> decoded_cache_test;
+	typedef decoded_cache_test::object decoded_cache_t;
+	decoded_cache_test tut_decoded_cache("LLDecodedTextureCache");
+
+	// images come back as written, and only when sharp enough
+	template<> template<>
+	void decoded_cache_t::test<1>()
+	{
+		LLDecodedTextureCache cache;
+		ensure_equals("empty", cache.open(mDirName, 16 * 1024 * 1024), 0);
+
+		LLUUID id;
+		id.generate();
+		LLPointer<LLImageRaw> raw = make_image(64, 32, 3, 1);
+		ensure("written", cache.write(id, raw, 2));
+
+		S32 discard = -1;
+		LLPointer<LLImageRaw> found = cache.read(id, 2, discard);
+		ensure("found", found.notNull());
+		ensure_equals("discard", discard, 2);
+		ensure("same pixels", same_image(raw, found));
+
+		ensure("sharper than stored", cache.read(id, 1, discard).isNull());
+		ensure("unknown id", cache.read(LLUUID::generateNewID(), 5, discard).isNull());
+		ensure_equals("hits", cache.getHits(), 1U);
+		ensure_equals("misses", cache.getMisses(), 2U);
+
+		// only a sharper image replaces the stored one
+		ensure("not sharper", !cache.write(id, make_image(32, 16, 3, 2), 3));
+		LLPointer<LLImageRaw> sharper = make_image(128, 64, 3, 3);
+		ensure("sharper", cache.write(id, sharper, 1));
+		found = cache.read(id, 2, discard);
+		ensure_equals("sharper discard", discard, 1);
+		ensure("sharper pixels", same_image(sharper, found));
+		ensure_equals("one entry", cache.getCount(), 1);
+
+		cache.remove(id);
+		ensure("removed", cache.read(id, 5, discard).isNull());
+		ensure_equals("size", cache.getSize(), (S64)0);
+	}
+
+	// least recently used images go first when over budget
+	template<> template<>
+	void decoded_cache_t::test<2>()
+	{
+		LLPointer<LLImageRaw> raw = make_image(32, 32, 4, 0);
+		S64 image_size = raw->getDataSize() + sizeof(S32) * 5;
+
+		LLDecodedTextureCache cache;
+		cache.open(mDirName, image_size * 8);
+
+		std::vector<LLUUID> ids(12);
+		for (S32 i = 0; i < 8; ++i)
+		{
+			ids[i].generate();
+			ensure("written", cache.write(ids[i], raw, 0));
+		}
+		ensure_equals("full", cache.getCount(), 8);
+
+		// 0 is used again, 1 is now the oldest
+		S32 discard;
+		ensure("read", cache.read(ids[0], 0, discard).notNull());
+		for (S32 i = 8; i < 12; ++i)
+		{
+			ids[i].generate();
+			ensure("written", cache.write(ids[i], raw, 0));
+		}
+		ensure_equals("still full", cache.getCount(), 8);
+		ensure("within budget", cache.getSize() <= image_size * 8);
+		ensure("recently used kept", cache.read(ids[0], 0, discard).notNull());
+		for (S32 i = 1; i < 5; ++i)
+		{
+			ensure("oldest evicted", cache.read(ids[i], 0, discard).isNull());
+		}
+		ensure("newest kept", cache.read(ids[11], 0, discard).notNull());
+
+		// larger than an eighth of the budget
+		ensure("too large", !cache.write(LLUUID::generateNewID(), make_image(64, 64, 4, 0), 0));
+	}
+
+	// the index survives a clean close, an unclean one wipes the tier
+	template<> template<>
+	void decoded_cache_t::test<3>()
+	{
+		LLUUID id;
+		id.generate();
+		LLPointer<LLImageRaw> raw = make_image(64, 64, 4, 4);
+		S32 discard;
+		{
+			LLDecodedTextureCache cache;
+			cache.open(mDirName, 16 * 1024 * 1024);
+			cache.write(id, raw, 0);
+		}
+		{
+			LLDecodedTextureCache cache;
+			ensure_equals("reopened", cache.open(mDirName, 16 * 1024 * 1024), 1);
+			LLPointer<LLImageRaw> found = cache.read(id, 0, discard);
+			ensure("found after reopen", found.notNull() && same_image(raw, found));
+
+			// no index while open, as after a crash
+			LLDecodedTextureCache crashed;
+			ensure_equals("wiped", crashed.open(mDirName, 16 * 1024 * 1024), 0);
+			crashed.close();
+
+			// the wiped file is noticed
+			ensure("file gone", cache.read(id, 0, discard).isNull());
+			ensure_equals("entry dropped", cache.getCount(), 0);
+		}
+	}
+
+	// revisit benchmark: J2C decode against a decoded tier read
+	template<> template<>
+	void decoded_cache_t::test<4>()
+	{
+		skip_unless_benchmarking();
+
+		if (!LLImage::instanceExists())
+		{
+			LLImage::initParamSingleton(false, 75);
+		}
+
+		const S32 SIZES = 3;
+		const S32 sizes[SIZES] = { 128, 512, 1024 };
+		const S32 REPEATS = 4;
+
+		LLDecodedTextureCache cache;
+		cache.open(mDirName, 256 * 1024 * 1024);
+
+		for (S32 s = 0; s < SIZES; ++s)
+		{
+			LLPointer<LLImageRaw> raw = make_image(sizes[s], sizes[s], 3, s);
+			LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+			ensure("encoded", j2c->encode(raw, 0.0f));
+
+			LLUUID id;
+			id.generate();
+			F64 decode_time = 0.0;
+			F64 read_time = 0.0;
+			for (S32 i = 0; i < REPEATS; ++i)
+			{
+				LLTimer timer;
+				LLPointer<LLImageRaw> decoded = new LLImageRaw;
+				j2c->setDiscardLevel(0);
+				ensure("decoded", j2c->decode(decoded, 0.0f));
+				decode_time += timer.getElapsedTimeF64();
+				if (!i)
+				{
+					cache.write(id, decoded, 0);
+				}
+
+				timer.reset();
+				S32 discard;
+				LLPointer<LLImageRaw> found = cache.read(id, 0, discard);
+				read_time += timer.getElapsedTimeF64();
+				ensure("found", found.notNull());
+				ensure("same as decoded", same_image(decoded, found));
+			}
+
+			LL_INFOS() << llformat("LLDecodedTextureCache: %dx%d revisit, J2C decode %.2f ms, decoded tier %.2f ms (%.1fx)",
+								   sizes[s], sizes[s], decode_time * 1000.0 / REPEATS, read_time * 1000.0 / REPEATS,
+								   decode_time / llmax(read_time, 0.000001)) << LL_ENDL;
+		}
+	}
+
+	// fetch workers reading, writing and removing the same images at once
+	template<> template<>
+	void decoded_cache_t::test<5>()
+	{
+		const S64 image_size = 64 * 64 * 4 + sizeof(S32) * 5;
+		const S32 THREADS = 4;
+
+		LLDecodedTextureCache cache;
+		cache.open(mDirName, image_size * 8);
+
+		std::vector<LLUUID> ids(12);
+		for (S32 i = 0; i < (S32)ids.size(); ++i)
+		{
+			ids[i].generate();
+		}
+
+		std::vector<S32> bad(THREADS, 0);
+		std::vector<std::thread*> threads;
+		for (S32 i = 0; i < THREADS; ++i)
+		{
+			threads.push_back(new std::thread(CacheUser(&cache, &ids, i, &bad[i])));
+		}
+		for (S32 i = 0; i < THREADS; ++i)
+		{
+			threads[i]->join();
+			delete threads[i];
+			ensure_equals("images read as written", bad[i], 0);
+		}
+
+		// every image left is whole and counted once
+		S32 count = 0;
+		S64 size = 0;
+		for (S32 i = 0; i < (S32)ids.size(); ++i)
+		{
+			S32 discard;
+			LLPointer<LLImageRaw> found = cache.read(ids[i], 2, discard);
+			if (found.notNull())
+			{
+				ensure("whole", same_image(found, make_image(64 >> discard, 64 >> discard, 4, i)));
+				++count;
+				size += found->getDataSize() + sizeof(S32) * 5;
+			}
+		}
+		ensure_equals("count", cache.getCount(), count);
+		ensure_equals("size", cache.getSize(), size);
+		ensure("within budget", size <= image_size * 8);
+	}
+}
@@ -0,0 +1,281 @@
+/**
+ * @file llflexiblechainpool_test.cpp
+ * @brief Chains stepped in the pool match chains stepped one at a time.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llflexiblechainpool.h"
+
+#include "lljobscheduler.h"
+#include "llmath.h"
+
+namespace
+{
+	const F32 SECONDS_PER_STEP = 1.f / 45.f;
+	// Sections are in agent space, where a float is good to about 1e-5 m,
+	// and a short section turns that into a larger error in its direction
+	const F32 TOLERANCE = 1.e-3f;
+	// Stepped on their own, chains that started the same drift a little apart
+	const F32 DRIFT_TOLERANCE = 1.e-2f;
+
+	F32 frand(U32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return (F32)((seed >> 8) & 0xffff) / 65535.f;
+	}
+
+	// A flexible prim with its sections and the values it steps with,
+	// made up the way LLVolumeImplFlexible makes them
+	struct Chain
+	{
+		Chain(U32& seed, S32 simulate_res)
+		:	mSimulateRes(simulate_res),
+			mPhase(frand(seed) * F_TWO_PI),
+			mWindSensitivity(frand(seed) < 0.3f ? 0.f : frand(seed) * 10.f)
+		{
+			mBase.setVec(frand(seed) * 256.f, frand(seed) * 256.f, 20.f + frand(seed) * 10.f);
+			mLength = 0.2f + frand(seed) * 4.f;
+			mTension = frand(seed) * 10.f;
+			mAirFriction = frand(seed) * 10.f;
+			mGravity = frand(seed) * 20.f - 10.f;
+			mUserForce.setVec(frand(seed) * 2.f - 1.f, frand(seed) * 2.f - 1.f, frand(seed) * 2.f - 1.f);
+
+			S32 num_sections = 1 << mSimulateRes;
+			F32 section_length = mLength / num_sections;
+			for (S32 i = 0; i <= num_sections; ++i)
+			{
+				mSections[i].mPosition = mBase + LLVector3::z_axis * (section_length * i - mLength * 0.5f);
+				mSections[i].mDirection = LLVector3::z_axis;
+				mSections[i].mVelocity.clear();
+			}
+		}
+
+		// The anchor sways and turns, the wind depends on where sections are
+		void makeStep(S32 frame, LLFlexibleChainStep& step) const
+		{
+			S32 num_sections = 1 << mSimulateRes;
+			F32 t = frame * SECONDS_PER_STEP + mPhase;
+			LLQuaternion rotation(sinf(t * 3.f) * 1.2f, LLVector3(cosf(t), sinf(t), 0.3f));
+			LLVector3 direction = LLVector3::z_axis * rotation;
+			LLVector3 base = mBase + LLVector3(sinf(t * 2.f), cosf(t * 5.f), 0.f) * 0.5f;
+
+			step.mAnchorRotation = rotation;
+			step.mAnchorDirection = direction;
+			step.mAnchorPosition = base - (mLength / 2 * direction);
+			step.mUserForce = mUserForce;
+			step.mGravity = mGravity;
+			step.mSectionLength = mLength / num_sections;
+			step.mTensionFactor = llmin(mTension * 0.1f * (1 - powf(0.85f, SECONDS_PER_STEP * 30)), 0.99f);
+			step.mMomentum = 1.f / llmax(powf(10.f, (mAirFriction * 2 + 1) * SECONDS_PER_STEP), 1.f);
+			step.mWindFactor = mWindSensitivity * 0.1f * step.mSectionLength * SECONDS_PER_STEP;
+			step.mForceFactor = step.mSectionLength * SECONDS_PER_STEP;
+			step.mMaxAngle = atanf(step.mSectionLength * 2.f);
+			for (S32 i = 0; i <= num_sections; ++i)
+			{
+				const LLVector3& p = mSections[i].mPosition;
+				step.mWind[i] = mWindSensitivity > 0.001f
+					? LLVector3(sinf(p.mV[VY] * 0.3f + t) * 8.f, cosf(p.mV[VX] * 0.2f) * 6.f, sinf(t * 0.7f))
+					: LLVector3::zero;
+			}
+		}
+
+		S32							mSimulateRes;
+		F32							mPhase;
+		F32							mWindSensitivity;
+		LLVector3					mBase;
+		F32							mLength;
+		F32							mTension;
+		F32							mAirFriction;
+		F32							mGravity;
+		LLVector3					mUserForce;
+		LLFlexibleObjectSection		mSections[FLEXIBLE_OBJECT_MAX_SECTION_COUNT + 1];
+		LLQuaternion				mEndRotation;
+	};
+
+	F32 quat_difference(const LLQuaternion& a, const LLQuaternion& b)
+	{
+		F32 difference = 0.f;
+		for (S32 i = 0; i < 4; ++i)
+		{
+			difference = llmax(difference, fabsf(a.mQ[i] - b.mQ[i]));
+		}
+		return difference;
+	}
+
+	// Largest difference between the two chains, state and end rotation
+	F32 chain_difference(const Chain& a, const Chain& b)
+	{
+		F32 difference = quat_difference(a.mEndRotation, b.mEndRotation);
+		for (S32 i = 0; i <= (1 << a.mSimulateRes); ++i)
+		{
+			const LLFlexibleObjectSection& sa = a.mSections[i];
+			const LLFlexibleObjectSection& sb = b.mSections[i];
+			difference = llmax(difference, dist_vec(sa.mPosition, sb.mPosition));
+			difference = llmax(difference, dist_vec(sa.mVelocity, sb.mVelocity));
+			difference = llmax(difference, dist_vec(sa.mDirection, sb.mDirection));
+			difference = llmax(difference, quat_difference(sa.mRotation, sb.mRotation));
+		}
+		return difference;
+	}
+
+	void step_pool(LLFlexibleChainPool& pool, std::vector<Chain>& chains, S32 frame, LLJobScheduler* scheduler)
+	{
+		pool.clear();
+		std::vector<U32> handles;
+		for (U32 c = 0; c < chains.size(); ++c)
+		{
+			LLFlexibleChainStep step;
+			chains[c].makeStep(frame, step);
+			handles.push_back(pool.add(step, chains[c].mSections, chains[c].mSimulateRes));
+		}
+		pool.simulate(scheduler);
+		for (U32 c = 0; c < chains.size(); ++c)
+		{
+			pool.get(handles[c], chains[c].mSections, chains[c].mEndRotation);
+		}
+	}
+
+	void step_each(std::vector<Chain>& chains, S32 frame)
+	{
+		for (U32 c = 0; c < chains.size(); ++c)
+		{
+			LLFlexibleChainStep step;
+			chains[c].makeStep(frame, step);
+			chains[c].mEndRotation = LLFlexibleChainPool::step(step, chains[c].mSections, 1 << chains[c].mSimulateRes);
+		}
+	}
+
+	std::vector<Chain> make_chains(U32 count)
+	{
+		U32 seed = 7;
+		std::vector<Chain> chains;
+		for (U32 c = 0; c < count; ++c)
+		{
+			chains.push_back(Chain(seed, c % (FLEXIBLE_OBJECT_MAX_SECTIONS + 1)));
+		}
+		return chains;
+	}
+}
+
+namespace tut
+{
+	struct flexible_chain_pool
+	{
+	};
+
+	typedef test_group<flexible_chain_pool> flexible_chain_pool_test;
+	typedef flexible_chain_pool_test::object flexible_chain_pool_t;
+	flexible_chain_pool_test tut_flexible_chain_pool("LLFlexibleChainPool");
+
+	// chains of every length, some packs not full, stepped together and one
+	// at a time from the same state stay within tolerance, step after step
+	template<> template<>
+	void flexible_chain_pool_t::test<1>()
+	{
+		std::vector<Chain> batched = make_chains(23);
+		std::vector<Chain> scalar = batched;
+		std::vector<Chain> drifting = batched;
+
+		LLFlexibleChainPool pool;
+		LLFlexibleChainPool drifting_pool;
+		F32 worst = 0.f;
+		F32 worst_drift = 0.f;
+		for (S32 frame = 0; frame < 600; ++frame)
+		{
+			batched = scalar;
+			step_pool(pool, batched, frame, NULL);
+			step_pool(drifting_pool, drifting, frame, NULL);
+			step_each(scalar, frame);
+			ensure_equals("chains", pool.getChainCount(), (U32)batched.size());
+			for (U32 c = 0; c < batched.size(); ++c)
+			{
+				worst = llmax(worst, chain_difference(batched[c], scalar[c]));
+				worst_drift = llmax(worst_drift, chain_difference(drifting[c], scalar[c]));
+			}
+		}
+		ensure("within tolerance", worst < TOLERANCE);
+		ensure("drift within tolerance", worst_drift < DRIFT_TOLERANCE);
+	}
+
+	// a section on top of its parent, and one pointing back at it
+	template<> template<>
+	void flexible_chain_pool_t::test<2>()
+	{
+		U32 seed = 3;
+		std::vector<Chain> batched;
+		batched.push_back(Chain(seed, 1));
+		batched.push_back(Chain(seed, 1));
+		for (U32 c = 0; c < batched.size(); ++c)
+		{
+			Chain& chain = batched[c];
+			chain.mTension = 0.f;
+			chain.mGravity = 0.f;
+			chain.mUserForce.clear();
+			chain.mWindSensitivity = 0.f;
+			chain.mPhase = 0.f;
+		}
+
+		LLFlexibleChainStep step;
+		batched[0].makeStep(0, step);
+		batched[0].mSections[1].mPosition = step.mAnchorPosition;
+		batched[1].makeStep(0, step);
+		batched[1].mSections[1].mPosition = step.mAnchorPosition - step.mAnchorDirection * step.mSectionLength;
+		std::vector<Chain> scalar = batched;
+
+		LLFlexibleChainPool pool;
+		step_pool(pool, batched, 0, NULL);
+		step_each(scalar, 0);
+		for (U32 c = 0; c < batched.size(); ++c)
+		{
+			ensure("within tolerance", chain_difference(batched[c], scalar[c]) < TOLERANCE);
+			ensure("finite", batched[c].mSections[2].mPosition.isFinite());
+		}
+	}
+
+	// shared out over the scheduler, chains step exactly as on one thread
+	template<> template<>
+	void flexible_chain_pool_t::test<3>()
+	{
+		LLJobScheduler::initClass(3);
+
+		std::vector<Chain> threaded = make_chains(1000);
+		std::vector<Chain> single = threaded;
+
+		LLFlexibleChainPool pool;
+		for (S32 frame = 0; frame < 20; ++frame)
+		{
+			step_pool(pool, threaded, frame, LLJobScheduler::getDefault());
+			step_pool(pool, single, frame, NULL);
+		}
+		for (U32 c = 0; c < threaded.size(); ++c)
+		{
+			ensure_equals("same", chain_difference(threaded[c], single[c]), 0.f);
+		}
+
+		LLJobScheduler::cleanupClass();
+	}
+}
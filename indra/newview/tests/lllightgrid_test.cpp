@@ -0,0 +1,231 @@
+/**
+ * @file lllightgrid_test.cpp
+ * @brief Lights found through the grid match a scan of all of them.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../lllightgrid.h"
+
+#include "llmath.h"
+
+#include <algorithm>
+#include <map>
+
+namespace
+{
+	U32 irand(U32& seed, U32 range)
+	{
+		seed = seed * 1103515245 + 12345;
+		return ((seed >> 8) & 0xffffff) % range;
+	}
+
+	// the grid never looks at the drawables
+	LLDrawable* make_light(U32 n)
+	{
+		return reinterpret_cast<LLDrawable*>((uintptr_t)(n + 1) * 16);
+	}
+
+	typedef std::map<LLDrawable*, LLVector3> light_map_t;
+
+	// Keeps the count nearest lights, like calcNearbyLights() does
+	struct NearestVisitor : public LLLightGrid::Visitor
+	{
+		NearestVisitor(const light_map_t& lights, const LLVector3& center, U32 count)
+		:	mLights(lights),
+			mCenter(center),
+			mCount(count),
+			mVisited(0)
+		{
+		}
+
+		/*virtual*/ F32 visit(LLDrawable* light, F32 range)
+		{
+			++mVisited;
+			F32 dist = dist_vec(mLights.find(light)->second, mCenter);
+			if (dist < range)
+			{
+				mNearest.push_back(std::make_pair(dist, light));
+				std::sort(mNearest.begin(), mNearest.end());
+				if (mNearest.size() > mCount)
+				{
+					mNearest.pop_back();
+				}
+			}
+			return mNearest.size() == mCount ? mNearest.back().first : range;
+		}
+
+		const light_map_t&	mLights;
+		LLVector3			mCenter;
+		U32					mCount;
+		U32					mVisited;
+		std::vector<std::pair<F32, LLDrawable*> > mNearest;
+	};
+
+	std::vector<std::pair<F32, LLDrawable*> > scan_nearest(const light_map_t& lights, const LLVector3& center, F32 range, U32 count)
+	{
+		std::vector<std::pair<F32, LLDrawable*> > nearest;
+		for (light_map_t::const_iterator iter = lights.begin(); iter != lights.end(); ++iter)
+		{
+			F32 dist = dist_vec(iter->second, center);
+			if (dist < range)
+			{
+				nearest.push_back(std::make_pair(dist, iter->first));
+			}
+		}
+		std::sort(nearest.begin(), nearest.end());
+		if (nearest.size() > count)
+		{
+			nearest.resize(count);
+		}
+		return nearest;
+	}
+
+	LLVector3 random_position(U32& seed)
+	{
+		return LLVector3((F32)irand(seed, 2560) * 0.1f, (F32)irand(seed, 2560) * 0.1f, (F32)irand(seed, 1000) * 0.1f);
+	}
+}
+
+namespace tut
+{
+	struct light_grid
+	{
+	};
+
+	typedef test_group<light_grid> light_grid_test;
+	typedef light_grid_test::object light_grid_t;
+	light_grid_test tut_light_grid("LLLightGrid");
+
+	// lights are added, moved between cells and removed
+	template<> template<>
+	void light_grid_t::test<1>()
+	{
+		LLLightGrid grid(10.f);
+		grid.update(make_light(0), LLVector3(5.f, 5.f, 20.f));
+		grid.update(make_light(1), LLVector3(6.f, 4.f, 30.f));
+		grid.update(make_light(2), LLVector3(-5.f, 5.f, 20.f));
+		ensure_equals("lights", grid.getLightCount(), (U32)3);
+		ensure_equals("cells", grid.getCellCount(), (U32)2);
+
+		// same cell, then another one
+		grid.update(make_light(1), LLVector3(7.f, 4.f, 30.f));
+		ensure_equals("moved in cell", grid.getCellCount(), (U32)2);
+		grid.update(make_light(1), LLVector3(25.f, 4.f, 30.f));
+		ensure_equals("moved out", grid.getCellCount(), (U32)3);
+		ensure_equals("still three", grid.getLightCount(), (U32)3);
+
+		grid.remove(make_light(2));
+		grid.remove(make_light(2));
+		ensure("removed", !grid.contains(make_light(2)));
+		ensure("kept", grid.contains(make_light(0)) && grid.contains(make_light(1)));
+		ensure_equals("empty cell dropped", grid.getCellCount(), (U32)2);
+
+		std::vector<LLDrawable*> lights;
+		grid.getLightsInRange(LLVector3(0.f, 0.f, 0.f), 4.f, lights);
+		ensure("near cell", lights.size() == 1 && lights[0] == make_light(0));
+
+		grid.clear();
+		ensure("cleared", grid.getLightCount() == 0 && grid.getCellCount() == 0);
+	}
+
+	// the nearest lights are the ones a scan of every light finds, and far
+	// cells are not visited
+	template<> template<>
+	void light_grid_t::test<2>()
+	{
+		U32 seed = 7;
+		LLLightGrid grid;
+		light_map_t lights;
+		for (U32 i = 0; i < 5000; ++i)
+		{
+			lights[make_light(i)] = random_position(seed);
+			grid.update(make_light(i), lights[make_light(i)]);
+		}
+		// move some, drop some
+		for (U32 i = 0; i < 500; ++i)
+		{
+			LLDrawable* light = make_light(irand(seed, 5000));
+			if (i & 1)
+			{
+				lights[light] = random_position(seed);
+				grid.update(light, lights[light]);
+			}
+			else
+			{
+				lights.erase(light);
+				grid.remove(light);
+			}
+		}
+		ensure_equals("count", grid.getLightCount(), (U32)lights.size());
+
+		for (U32 i = 0; i < 50; ++i)
+		{
+			LLVector3 center = random_position(seed);
+			NearestVisitor visitor(lights, center, 6);
+			grid.visitNearest(center, 100.f, visitor);
+			ensure("nearest", visitor.mNearest == scan_nearest(lights, center, 100.f, 6));
+			ensure("fewer visited", visitor.mVisited < lights.size() / 4);
+		}
+	}
+
+	// a region crossing moves every light
+	template<> template<>
+	void light_grid_t::test<3>()
+	{
+		U32 seed = 11;
+		LLLightGrid grid(16.f);
+		light_map_t lights;
+		for (U32 i = 0; i < 1000; ++i)
+		{
+			lights[make_light(i)] = random_position(seed);
+			grid.update(make_light(i), lights[make_light(i)]);
+		}
+
+		LLVector3 offset(-256.f, 0.f, 0.f);
+		grid.shift(offset);
+		for (light_map_t::iterator iter = lights.begin(); iter != lights.end(); ++iter)
+		{
+			iter->second += offset;
+		}
+		ensure_equals("count", grid.getLightCount(), (U32)lights.size());
+
+		LLVector3 center(-128.f, 128.f, 20.f);
+		std::vector<LLDrawable*> in_range;
+		grid.getLightsInRange(center, 40.f, in_range);
+		std::sort(in_range.begin(), in_range.end());
+		for (light_map_t::iterator iter = lights.begin(); iter != lights.end(); ++iter)
+		{
+			LLVector3 delta = iter->second - center;
+			if (delta.mV[VX] * delta.mV[VX] + delta.mV[VY] * delta.mV[VY] <= 40.f * 40.f)
+			{
+				ensure("in range", std::binary_search(in_range.begin(), in_range.end(), iter->first));
+			}
+		}
+		ensure("not all", in_range.size() < lights.size() / 2);
+	}
+}
@@ -30,6 +30,7 @@
 #define LL_LLTUT_H
 
 #include "is_approx_equal_fraction.h" // instead of llmath.h
+#include <cstdlib>
 #include <cstring>
 
 class LLDate;
@@ -87,6 +88,16 @@ namespace tut
 // The functions BELOW this point actually consume tut.hpp functionality.
 namespace tut
 {
+	// Timing benchmarks are skipped unless LL_TEST_BENCHMARKS is set in the
+	// environment, the unit tests run with every build.
+	inline void skip_unless_benchmarking()
+	{
+		if (!getenv("LL_TEST_BENCHMARKS"))
+		{
+			skip("timing benchmark, set LL_TEST_BENCHMARKS to run it");
+		}
+	}
+
 	inline void ensure_approximately_equals(const char* msg, F64 actual, F64 expected, U32 frac_bits)
 	{
 		if(!is_approx_equal_fraction(actual, expected, frac_bits))
@@ -476,7 +476,9 @@ void stream_usage(std::ostream& s, const char* app)
 	  << "where 'level' is one of ALL, DEBUG, INFO, WARN, ERROR, NONE.\n"
 	  << "--debug is like LOGTEST=DEBUG, but --debug overrides LOGTEST.\n"
 	  << "Setting LOGFAIL overrides both LOGTEST and --debug: the only log\n"
-	  << "messages you will see will be for failed tests.\n\n";
+	  << "messages you will see will be for failed tests.\n"
+	  << "LL_TEST_BENCHMARKS=1 : also run the timing benchmarks, LOGTEST=INFO shows\n"
+	  << "their results.\n\n";
 
 	s << "Examples:" << std::endl;
 	s << "  " << app << " --verbose" << std::endl;